@@ -162,6 +162,7 @@
 
 #include "storage/MediaManager.h"
 #include "utils/SaveFileStateJob.h"
+#include "utils/StartupProfiler.h"
 #include "utils/AlarmClock.h"
 #include "utils/StringUtils.h"
 #include "DatabaseManager.h"
@@ -192,6 +193,7 @@
 #include "cores/FFmpeg.h"
 #include "utils/CharsetConverter.h"
 #include "pictures/GUIWindowSlideShow.h"
+#include "pictures/PictureInfoScanner.h"
 #include "addons/AddonSystemSettings.h"
 #include "FileItem.h"
 
@@ -357,6 +359,8 @@ void CApplication::Preflight()
 
 bool CApplication::Create(const CAppParamParser &params)
 {
+  CStartupProfiler::CScope profilerScope("CApplication::Create");
+
   // Grab a handle to our thread to be used later in identifying the render thread.
   m_threadID = CThread::GetCurrentThreadId();
 
@@ -533,8 +537,11 @@ bool CApplication::Create(const CAppParamParser &params)
   av_log_set_callback(ff_avutil_log);
 
   CLog::Log(LOGINFO, "loading settings");
-  if (!m_pSettingsComponent->Load())
-    return false;
+  {
+    CStartupProfiler::CScope scope("settings");
+    if (!m_pSettingsComponent->Load())
+      return false;
+  }
 
   CLog::Log(LOGINFO, "creating subdirectories");
   const std::shared_ptr<CProfileManager> profileManager = m_pSettingsComponent->GetProfileManager();
@@ -565,9 +572,12 @@ bool CApplication::Create(const CAppParamParser &params)
     return false;
   }
 
-  m_pActiveAE.reset(new ActiveAE::CActiveAE());
-  m_pActiveAE->Start();
-  CServiceBroker::RegisterAE(m_pActiveAE.get());
+  {
+    CStartupProfiler::CScope scope("audioengine");
+    m_pActiveAE.reset(new ActiveAE::CActiveAE());
+    m_pActiveAE->Start();
+    CServiceBroker::RegisterAE(m_pActiveAE.get());
+  }
 
   // restore AE's previous volume state
   SetHardwareVolume(m_volumeLevel);
@@ -602,6 +612,8 @@ bool CApplication::Create(const CAppParamParser &params)
 
 bool CApplication::CreateGUI()
 {
+  CStartupProfiler::CScope profilerScope("CApplication::CreateGUI");
+
   m_frameMoveGuard.lock();
 
   m_renderGUI = true;
@@ -714,9 +726,14 @@ bool CApplication::Initialize()
   cdio_loglevel_default = CDIO_LOG_ERROR;
 #endif
 
+  CStartupProfiler::CScope profilerScope("CApplication::Initialize");
+
   // load the language and its translated strings
-  if (!LoadLanguage(false))
-    return false;
+  {
+    CStartupProfiler::CScope scope("language");
+    if (!LoadLanguage(false))
+      return false;
+  }
 
   const std::shared_ptr<CProfileManager> profileManager = CServiceBroker::GetSettingsComponent()->GetProfileManager();
 
@@ -725,13 +742,17 @@ bool CApplication::Initialize()
     StringUtils::Format(g_localizeStrings.Get(178).c_str(), g_sysinfo.GetAppName().c_str()),
     "special://xbmc/media/icon256x256.png", EventLevel::Basic)));
 
-  m_ServiceManager->GetNetwork().WaitForNet();
+  {
+    CStartupProfiler::CScope scope("network");
+    m_ServiceManager->GetNetwork().WaitForNet();
+  }
 
   // initialize (and update as needed) our databases
   CDatabaseManager &databaseManager = m_ServiceManager->GetDatabaseManager();
 
   CEvent event(true);
   CJobManager::GetInstance().Submit([&databaseManager, &event]() {
+    CStartupProfiler::CScope scope("databases");
     databaseManager.Initialize();
     event.Set();
   });
@@ -750,7 +771,10 @@ bool CApplication::Initialize()
   }
   CServiceBroker::GetRenderSystem()->ShowSplash("");
 
-  StartServices();
+  {
+    CStartupProfiler::CScope scope("StartServices");
+    StartServices();
+  }
 
   // GUI depends on seek handler
   m_appPlayer.GetSeekHandler().Configure();
@@ -769,6 +793,7 @@ bool CApplication::Initialize()
     event.Reset();
     std::atomic<bool> isMigratingAddons(false);
     CJobManager::GetInstance().Submit([&event, &incompatibleAddons, &isMigratingAddons]() {
+        CStartupProfiler::CScope scope("addonmigration");
         incompatibleAddons = CAddonSystemSettings::GetInstance().MigrateAddons([&isMigratingAddons]() {
           isMigratingAddons = true;
         });
@@ -867,6 +892,10 @@ bool CApplication::Initialize()
 
   CLog::Log(LOGNOTICE, "initialize done");
 
+  // the trace has to include this step as a whole
+  profilerScope.End();
+  CStartupProfiler::GetInstance().Finish("special://temp/startuptrace.json");
+
   CheckOSScreenSaverInhibitionSetting();
   // reset our screensaver (starts timers etc.)
   ResetScreenSaver();
@@ -1192,6 +1221,8 @@ bool CApplication::Save(TiXmlNode *settings) const
 
 bool CApplication::LoadSkin(const std::string& skinID)
 {
+  CStartupProfiler::CScope profilerScope("CApplication::LoadSkin");
+
   SkinPtr skin;
   {
     AddonPtr addon;
@@ -2575,6 +2606,12 @@ void CApplication::Stop(int exitCode)
     if (CVideoLibraryQueue::GetInstance().IsRunning())
       CVideoLibraryQueue::GetInstance().CancelAllJobs();
 
+    if (m_pictureInfoScanner)
+    {
+      m_pictureInfoScanner->Stop(true);
+      m_pictureInfoScanner.reset();
+    }
+
     CApplicationMessenger::GetInstance().Cleanup();
 
     StopServices();
@@ -4639,6 +4676,17 @@ void CApplication::StopMusicScan()
   CMusicLibraryQueue::GetInstance().StopLibraryScanning();
 }
 
+bool CApplication::IsPictureScanning() const
+{
+  return m_pictureInfoScanner && m_pictureInfoScanner->IsScanning();
+}
+
+void CApplication::StopPictureScan()
+{
+  if (m_pictureInfoScanner)
+    m_pictureInfoScanner->Stop();
+}
+
 void CApplication::StartVideoCleanup(bool userInitiated /* = true */,
                                      const std::string& content /* = "" */)
 {
@@ -4730,6 +4778,18 @@ void CApplication::StartMusicArtistScan(const std::string& strDirectory,
   CMusicLibraryQueue::GetInstance().StartArtistScan(strDirectory, refresh);
 }
 
+void CApplication::StartPictureScan(const std::string& strDirectory, bool userInitiated /* = true */)
+{
+  if (IsPictureScanning())
+    return;
+
+  if (!m_pictureInfoScanner)
+    m_pictureInfoScanner.reset(new CPictureInfoScanner());
+
+  m_pictureInfoScanner->ShowDialog(userInitiated);
+  m_pictureInfoScanner->Start(strDirectory);
+}
+
 bool CApplication::ProcessAndStartPlaylist(const std::string& strPlayList, CPlayList& playlist, int iPlaylist, int track)
 {
   CLog::Log(LOGDEBUG,"CApplication::ProcessAndStartPlaylist(%s, %i)",strPlayList.c_str(), iPlaylist);
@@ -53,6 +53,7 @@ class CBookmark;
 class IActionListener;
 class CGUIComponent;
 class CAppInboundProtocol;
+class CPictureInfoScanner;
 class CSettingsComponent;
 
 namespace ADDON
@@ -251,8 +252,10 @@ public:
 
   void StopVideoScan();
   void StopMusicScan();
+  void StopPictureScan();
   bool IsMusicScanning() const;
   bool IsVideoScanning() const;
+  bool IsPictureScanning() const;
 
   /*!
    \brief Starts a video library cleanup.
@@ -285,6 +288,13 @@ public:
   void StartMusicAlbumScan(const std::string& strDirectory, bool refresh = false);
   void StartMusicArtistScan(const std::string& strDirectory, bool refresh = false);
 
+  /*!
+   \brief Starts indexing the pictures into the picture database.
+   \param path The path to scan or "" (empty string) for all picture sources.
+   \param userInitiated Whether the action was initiated by the user (either via GUI or any other method) or not.  It is meant to hide or show dialogs.
+   */
+  void StartPictureScan(const std::string &path, bool userInitiated = true);
+
   void UpdateLibraries();
 
   void UpdateCurrentPlayArt();
@@ -445,6 +455,7 @@ protected:
   bool m_bSystemScreenSaverEnable = false;
 
   std::unique_ptr<MUSIC_INFO::CMusicInfoScanner> m_musicInfoScanner;
+  std::unique_ptr<CPictureInfoScanner> m_pictureInfoScanner;
 
   bool m_muted = false;
   float m_volumeLevel = VOLUME_MAXIMUM;
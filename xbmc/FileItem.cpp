@@ -116,6 +116,13 @@ CFileItem::CFileItem(const CVideoInfoTag& movie)
 
 namespace
 {
+  // guards the deferred filling of the music tags of radio channel items
+  CCriticalSection& PVRMusicInfoTagSection()
+  {
+    static CCriticalSection section;
+    return section;
+  }
+
   std::string GetEpgTagTitle(const std::shared_ptr<CPVREpgInfoTag>& epgTag)
   {
     if (CServiceBroker::GetPVRManager().IsParentalLocked(epgTag))
@@ -130,9 +137,10 @@ namespace
 
 void CFileItem::FillMusicInfoTag(const std::shared_ptr<CPVRChannel>& channel, const std::shared_ptr<CPVREpgInfoTag>& tag)
 {
-  if (channel && channel->IsRadio() && !HasMusicInfoTag())
+  // not through HasMusicInfoTag()/GetMusicInfoTag(), they fill the deferred music tag themselves
+  if (channel && channel->IsRadio() && !m_musicInfoTag)
   {
-    CMusicInfoTag* musictag = GetMusicInfoTag(); // create (!) the music tag.
+    CMusicInfoTag* musictag = m_musicInfoTag = new CMusicInfoTag;
 
     if (tag)
     {
@@ -153,6 +161,44 @@ void CFileItem::FillMusicInfoTag(const std::shared_ptr<CPVRChannel>& channel, co
   }
 }
 
+void CFileItem::FillPVRMusicInfoTag() const
+{
+  // look up the tags without holding the lock, they're not used if another thread filled the music tag meanwhile.
+  // a channel item shows the channel's current epg tag, an epg item the channel of its epg tag.
+  std::shared_ptr<CPVRChannel> channel = m_pvrChannelInfoTag;
+  std::shared_ptr<CPVREpgInfoTag> epgTag = m_epgInfoTag;
+  if (channel)
+    epgTag = channel->GetEPGNow();
+  else if (epgTag)
+    channel = CServiceBroker::GetPVRManager().ChannelGroups()->GetChannelForEpgTag(epgTag);
+
+  CSingleLock lock(PVRMusicInfoTagSection());
+  if (!m_bFillPVRMusicInfoTag)
+    return;
+
+  const_cast<CFileItem*>(this)->FillMusicInfoTag(channel, epgTag);
+
+  // set only once the tag is complete, readers not taking the lock rely on that
+  m_bFillPVRMusicInfoTag = false;
+}
+
+void CFileItem::AssignMusicInfoTag(const CFileItem& item)
+{
+  if (item.m_musicInfoTag)
+  {
+    if (m_musicInfoTag)
+      *m_musicInfoTag = *item.m_musicInfoTag;
+    else
+      m_musicInfoTag = new MUSIC_INFO::CMusicInfoTag(*item.m_musicInfoTag);
+  }
+  else
+  {
+    delete m_musicInfoTag;
+    m_musicInfoTag = NULL;
+  }
+  m_bFillPVRMusicInfoTag = item.m_bFillPVRMusicInfoTag.load();
+}
+
 CFileItem::CFileItem(const std::shared_ptr<CPVREpgInfoTag>& tag)
 {
   Initialize();
@@ -173,7 +219,8 @@ CFileItem::CFileItem(const std::shared_ptr<CPVREpgInfoTag>& tag)
       if (!channel->IconPath().empty())
         SetArt("icon", channel->IconPath());
 
-      FillMusicInfoTag(channel, tag);
+      // the music tag of a radio channel's epg tag is filled once it's requested
+      m_bFillPVRMusicInfoTag = channel->IsRadio();
     }
   }
 
@@ -184,8 +231,6 @@ CFileItem::CFileItem(const std::shared_ptr<CPVRChannel>& channel)
 {
   Initialize();
 
-  std::shared_ptr<CPVREpgInfoTag> epgNow(channel->GetEPGNow());
-
   m_strPath = channel->Path();
   m_bIsFolder = false;
   m_pvrChannelInfoTag = channel;
@@ -202,7 +247,8 @@ CFileItem::CFileItem(const std::shared_ptr<CPVRChannel>& channel)
   SetProperty("path", channel->Path());
   SetArt("thumb", channel->IconPath());
 
-  FillMusicInfoTag(channel, epgNow);
+  // the music tag needs the current epg tag, look it up only once the tag is requested
+  m_bFillPVRMusicInfoTag = channel->IsRadio();
   FillInMimeType(false);
 }
 
@@ -271,6 +317,7 @@ CFileItem::CFileItem(const CGenre& genre)
 
 CFileItem::CFileItem(const CFileItem& item)
 : m_musicInfoTag(NULL),
+  m_bFillPVRMusicInfoTag(false),
   m_videoInfoTag(NULL),
   m_pictureInfoTag(NULL),
   m_gameInfoTag(NULL)
@@ -394,18 +441,14 @@ CFileItem& CFileItem::operator=(const CFileItem& item)
   m_dateTime = item.m_dateTime;
   m_dwSize = item.m_dwSize;
 
-  if (item.m_musicInfoTag)
+  if (item.m_bFillPVRMusicInfoTag)
   {
-    if (m_musicInfoTag)
-      *m_musicInfoTag = *item.m_musicInfoTag;
-    else
-      m_musicInfoTag = new MUSIC_INFO::CMusicInfoTag(*item.m_musicInfoTag);
+    // the deferred music tag of the item may be filled by another thread meanwhile
+    CSingleLock lock(PVRMusicInfoTagSection());
+    AssignMusicInfoTag(item);
   }
   else
-  {
-    delete m_musicInfoTag;
-    m_musicInfoTag = NULL;
-  }
+    AssignMusicInfoTag(item);
 
   if (item.m_videoInfoTag)
   {
@@ -476,6 +519,7 @@ CFileItem& CFileItem::operator=(const CFileItem& item)
 void CFileItem::Initialize()
 {
   m_musicInfoTag = NULL;
+  m_bFillPVRMusicInfoTag = false;
   m_videoInfoTag = NULL;
   m_pictureInfoTag = NULL;
   m_gameInfoTag = NULL;
@@ -517,6 +561,7 @@ void CFileItem::Reset()
   m_mimetype.clear();
   delete m_musicInfoTag;
   m_musicInfoTag=NULL;
+  m_bFillPVRMusicInfoTag = false;
   delete m_videoInfoTag;
   m_videoInfoTag=NULL;
   m_epgInfoTag.reset();
@@ -566,7 +611,7 @@ void CFileItem::Archive(CArchive& ar)
     ar << m_specialSort;
     ar << m_doContentLookup;
 
-    if (m_musicInfoTag)
+    if (HasMusicInfoTag())
     {
       ar << 1;
       ar << *m_musicInfoTag;
@@ -655,7 +700,7 @@ void CFileItem::Serialize(CVariant& value) const
   value["mimetype"] = m_mimetype;
   value["extrainfo"] = m_extrainfo;
 
-  if (m_musicInfoTag)
+  if (HasMusicInfoTag())
     (*m_musicInfoTag).Serialize(value["musicInfoTag"]);
 
   if (m_videoInfoTag)
@@ -3509,6 +3554,9 @@ CPictureInfoTag* CFileItem::GetPictureInfoTag()
 
 MUSIC_INFO::CMusicInfoTag* CFileItem::GetMusicInfoTag()
 {
+  if (m_bFillPVRMusicInfoTag)
+    FillPVRMusicInfoTag();
+
   if (!m_musicInfoTag)
     m_musicInfoTag = new MUSIC_INFO::CMusicInfoTag;
 
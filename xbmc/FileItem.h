@@ -23,6 +23,7 @@
 #include "utils/ISortable.h"
 #include "utils/SortUtils.h"
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <string>
@@ -74,6 +75,8 @@ class CMediaSource;
 
 class CBookmark;
 
+class TestPVRFileItem;
+
 enum EFileFolderType {
   EFILEFOLDER_TYPE_ALWAYS     = 1<<0,
   EFILEFOLDER_TYPE_ONCLICK    = 1<<1,
@@ -263,6 +266,8 @@ public:
 
   inline bool HasMusicInfoTag() const
   {
+    if (m_bFillPVRMusicInfoTag)
+      FillPVRMusicInfoTag();
     return m_musicInfoTag != NULL;
   }
 
@@ -270,6 +275,8 @@ public:
 
   inline const MUSIC_INFO::CMusicInfoTag* GetMusicInfoTag() const
   {
+    if (m_bFillPVRMusicInfoTag)
+      FillPVRMusicInfoTag();
     return m_musicInfoTag;
   }
 
@@ -542,6 +549,8 @@ public:
   bool HasCueDocument() const;
   bool LoadTracksFromCueDocument(CFileItemList& scannedItems);
 private:
+  friend class ::TestPVRFileItem;
+
   /*! \brief initialize all members of this class (not CGUIListItem members) to default values.
    Called from constructors, and from Reset()
    \sa Reset, CGUIListItem
@@ -559,6 +568,20 @@ private:
    */
   void FillMusicInfoTag(const std::shared_ptr<PVR::CPVRChannel>& channel, const std::shared_ptr<PVR::CPVREpgInfoTag>& tag);
 
+  /*!
+   \brief Fill the music tag of a radio channel item from the channel's current epg tag, or the
+   one of a radio epg item from its epg tag and channel.
+   Looking up the tags is deferred until the music tag is first requested, listings of many
+   channels or epg tags don't pay for it for items never shown. The const accessors of an item
+   may be called from several threads, so the tag is filled under a lock.
+   */
+  void FillPVRMusicInfoTag() const;
+
+  /*!
+   \brief Copy the music tag of the given item, including whether it still has to be filled.
+   */
+  void AssignMusicInfoTag(const CFileItem& item);
+
   std::string m_strPath;            ///< complete path to item
   std::string m_strDynPath;
 
@@ -570,6 +593,7 @@ private:
   std::string m_extrainfo;
   bool m_doContentLookup;
   MUSIC_INFO::CMusicInfoTag* m_musicInfoTag;
+  mutable std::atomic<bool> m_bFillPVRMusicInfoTag;
   CVideoInfoTag* m_videoInfoTag;
   std::shared_ptr<PVR::CPVREpgInfoTag> m_epgInfoTag;
   std::shared_ptr<PVR::CPVRChannel> m_pvrChannelInfoTag;
@@ -29,12 +29,28 @@
 #include "powermanagement/PowerManager.h"
 #include "profiles/ProfileManager.h"
 #include "pvr/PVRManager.h"
+#include "utils/CPUInfo.h"
 #include "utils/FileExtensionProvider.h"
+#include "utils/InitGraph.h"
+#include "utils/StartupProfiler.h"
 #include "utils/log.h"
 #include "weather/WeatherManager.h"
 
+#include <algorithm>
+
 using namespace KODI;
 
+namespace
+{
+// most services wait for disk or for the add-on manager, a few threads are enough
+const unsigned int MAX_INIT_WORKERS = 4;
+
+unsigned int GetInitWorkers()
+{
+  return std::min(MAX_INIT_WORKERS, static_cast<unsigned int>(std::max(1, g_cpuInfo.getCPUCount() - 1)));
+}
+}
+
 CServiceManager::CServiceManager() = default;
 
 CServiceManager::~CServiceManager()
@@ -86,6 +102,8 @@ void CServiceManager::DeinitTesting()
 
 bool CServiceManager::InitStageOne()
 {
+  CStartupProfiler::CScope scope("CServiceManager::InitStageOne");
+
 #ifdef HAS_PYTHON
   m_XBPython.reset(new XBPython());
   CScriptInvocationManager::GetInstance().RegisterLanguageInvocationHandler(m_XBPython.get(), ".py");
@@ -101,86 +119,193 @@ bool CServiceManager::InitStageOne()
 
 bool CServiceManager::InitStageTwo(const CAppParamParser &params, const std::string& profilesUserDataFolder)
 {
-  // Initialize the addon database (must be before the addon manager is init'd)
-  m_databaseManager.reset(new CDatabaseManager);
-
-  m_Platform.reset(CPlatform::CreateInstance());
-  m_Platform->Init();
-
-  m_binaryAddonManager.reset(new ADDON::CBinaryAddonManager()); /* Need to constructed before, GetRunningInstance() of binary CAddonDll need to call them */
-  m_addonMgr.reset(new ADDON::CAddonMgr());
-  if (!m_addonMgr->Init())
-  {
-    CLog::Log(LOGFATAL, "CServiceManager::%s: Unable to start CAddonMgr", __FUNCTION__);
+  CInitGraph graph("CServiceManager::InitStageTwo");
+  AddStageTwoSteps(graph, params, profilesUserDataFolder);
+  if (!graph.Run(GetInitWorkers()))
     return false;
-  }
-
-  if (!m_binaryAddonManager->Init())
-  {
-    CLog::Log(LOGFATAL, "CServiceManager::%s: Unable to initialize CBinaryAddonManager", __FUNCTION__);
-    return false;
-  }
-
-  m_repositoryUpdater.reset(new ADDON::CRepositoryUpdater(*m_addonMgr));
-
-  m_vfsAddonCache.reset(new ADDON::CVFSAddonCache());
-  m_vfsAddonCache->Init();
-
-  m_PVRManager.reset(new PVR::CPVRManager());
-
-  m_dataCacheCore.reset(new CDataCacheCore());
-
-  m_binaryAddonCache.reset( new ADDON::CBinaryAddonCache());
-  m_binaryAddonCache->Init();
-
-  m_favouritesService.reset(new CFavouritesService(profilesUserDataFolder));
-
-  m_serviceAddons.reset(new ADDON::CServiceAddonManager(*m_addonMgr));
-
-  m_contextMenuManager.reset(new CContextMenuManager(*m_addonMgr));
-
-  m_gameControllerManager.reset(new GAME::CControllerManager);
-  m_inputManager.reset(new CInputManager(params));
-  m_inputManager->InitializeInputs();
-
-  m_peripherals.reset(new PERIPHERALS::CPeripherals(*m_inputManager,
-                                                    *m_gameControllerManager));
-
-  m_gameRenderManager.reset(new RETRO::CGUIGameRenderManager);
-
-  m_fileExtensionProvider.reset(new CFileExtensionProvider(*m_addonMgr,
-                                                           *m_binaryAddonManager));
-
-  m_powerManager.reset(new CPowerManager());
-  m_powerManager->Initialize();
-  m_powerManager->SetDefaults();
-
-  m_weatherManager.reset(new CWeatherManager());
 
   init_level = 2;
   return true;
 }
 
-// stage 3 is called after successful initialization of WindowManager
-bool CServiceManager::InitStageThree(const std::shared_ptr<CProfileManager>& profileManager)
+void CServiceManager::AddStageTwoSteps(CInitGraph& graph, const CAppParamParser &params, const std::string& profilesUserDataFolder)
 {
-  // Peripherals depends on strings being loaded before stage 3
-  m_peripherals->Initialise();
-
-  m_gameServices.reset(new GAME::CGameServices(*m_gameControllerManager,
-    *m_gameRenderManager,
-    *m_peripherals,
-    *profileManager));
+  // Services are brought up concurrently where their dependencies allow it. Everything
+  // touching the platform, input or power management stays on the main thread. The
+  // platform sets up the environment, so it comes before anything else.
+  graph.Add("platform", {}, [this]() {
+    m_Platform.reset(CPlatform::CreateInstance());
+    m_Platform->Init();
+    return true;
+  }, CInitGraph::MAIN_THREAD);
 
-  m_contextMenuManager->Init();
-  m_PVRManager->Init();
+  // Initialize the addon database (must be before the addon manager is init'd)
+  graph.Add("databasemanager", {"platform"}, [this]() {
+    m_databaseManager.reset(new CDatabaseManager);
+    return true;
+  });
+
+  /* Need to constructed before, GetRunningInstance() of binary CAddonDll need to call them */
+  graph.Add("binaryaddonmanager", {"platform"}, [this]() {
+    m_binaryAddonManager.reset(new ADDON::CBinaryAddonManager());
+    return true;
+  });
+
+  graph.Add("addonmanager", {"databasemanager", "binaryaddonmanager"}, [this]() {
+    m_addonMgr.reset(new ADDON::CAddonMgr());
+    if (!m_addonMgr->Init())
+    {
+      CLog::Log(LOGFATAL, "CServiceManager::%s: Unable to start CAddonMgr", __FUNCTION__);
+      return false;
+    }
+    return true;
+  });
+
+  graph.Add("binaryaddonmanager.init", {"addonmanager"}, [this]() {
+    if (!m_binaryAddonManager->Init())
+    {
+      CLog::Log(LOGFATAL, "CServiceManager::%s: Unable to initialize CBinaryAddonManager", __FUNCTION__);
+      return false;
+    }
+    return true;
+  });
+
+  graph.Add("repositoryupdater", {"addonmanager"}, [this]() {
+    m_repositoryUpdater.reset(new ADDON::CRepositoryUpdater(*m_addonMgr));
+    return true;
+  });
+
+  graph.Add("vfsaddoncache", {"binaryaddonmanager.init"}, [this]() {
+    m_vfsAddonCache.reset(new ADDON::CVFSAddonCache());
+    m_vfsAddonCache->Init();
+    return true;
+  });
+
+  // CPVRClients looks up the PVR add-ons on construction. Registers action
+  // listeners with the application, which isn't thread safe.
+  graph.Add("pvrmanager", {"addonmanager", "binaryaddonmanager", "vfsaddoncache"}, [this]() {
+    m_PVRManager.reset(new PVR::CPVRManager());
+    return true;
+  }, CInitGraph::MAIN_THREAD);
+
+  // plain data, no other services involved
+  graph.Add("datacachecore", {"platform"}, [this]() {
+    m_dataCacheCore.reset(new CDataCacheCore());
+    return true;
+  });
+
+  graph.Add("binaryaddoncache", {"binaryaddonmanager.init"}, [this]() {
+    m_binaryAddonCache.reset( new ADDON::CBinaryAddonCache());
+    m_binaryAddonCache->Init();
+    return true;
+  });
+
+  // only reads the favourites files, vfs add-ons aren't used before stage two is done
+  graph.Add("favouritesservice", {"platform"}, [this, &profilesUserDataFolder]() {
+    m_favouritesService.reset(new CFavouritesService(profilesUserDataFolder));
+    return true;
+  });
+
+  graph.Add("serviceaddons", {"addonmanager"}, [this]() {
+    m_serviceAddons.reset(new ADDON::CServiceAddonManager(*m_addonMgr));
+    return true;
+  });
+
+  graph.Add("contextmenumanager", {"addonmanager"}, [this]() {
+    m_contextMenuManager.reset(new CContextMenuManager(*m_addonMgr));
+    return true;
+  });
+
+  graph.Add("gamecontrollermanager", {"platform"}, [this]() {
+    m_gameControllerManager.reset(new GAME::CControllerManager);
+    return true;
+  });
+
+  graph.Add("inputmanager", {"platform"}, [this, &params]() {
+    m_inputManager.reset(new CInputManager(params));
+    m_inputManager->InitializeInputs();
+    return true;
+  }, CInitGraph::MAIN_THREAD);
+
+  graph.Add("peripherals", {"inputmanager", "gamecontrollermanager"}, [this]() {
+    m_peripherals.reset(new PERIPHERALS::CPeripherals(*m_inputManager,
+                                                      *m_gameControllerManager));
+    return true;
+  }, CInitGraph::MAIN_THREAD);
+
+  graph.Add("gamerendermanager", {"platform"}, [this]() {
+    m_gameRenderManager.reset(new RETRO::CGUIGameRenderManager);
+    return true;
+  });
+
+  graph.Add("fileextensionprovider", {"binaryaddonmanager.init"}, [this]() {
+    m_fileExtensionProvider.reset(new CFileExtensionProvider(*m_addonMgr,
+                                                             *m_binaryAddonManager));
+    return true;
+  });
+
+  graph.Add("powermanager", {"platform"}, [this]() {
+    m_powerManager.reset(new CPowerManager());
+    m_powerManager->Initialize();
+    m_powerManager->SetDefaults();
+    return true;
+  }, CInitGraph::MAIN_THREAD);
+
+  // registers a settings callback, the settings manager is locked
+  graph.Add("weathermanager", {"platform"}, [this]() {
+    m_weatherManager.reset(new CWeatherManager());
+    return true;
+  });
+}
 
-  m_playerCoreFactory.reset(new CPlayerCoreFactory(*profileManager));
+// stage 3 is called after successful initialization of WindowManager
+bool CServiceManager::InitStageThree(const std::shared_ptr<CProfileManager>& profileManager)
+{
+  CInitGraph graph("CServiceManager::InitStageThree");
+  AddStageThreeSteps(graph, profileManager);
+  if (!graph.Run(GetInitWorkers()))
+    return false;
 
   init_level = 3;
   return true;
 }
 
+void CServiceManager::AddStageThreeSteps(CInitGraph& graph, const std::shared_ptr<CProfileManager>& profileManager)
+{
+  // Peripherals, game services, context menus and PVR are initialized one after another
+  // on the main thread as before, none of them is safe to initialize concurrently.
+
+  // Peripherals depends on strings being loaded before stage 3
+  graph.Add("peripherals.init", {}, [this]() {
+    m_peripherals->Initialise();
+    return true;
+  }, CInitGraph::MAIN_THREAD);
+
+  graph.Add("gameservices", {"peripherals.init"}, [this, &profileManager]() {
+    m_gameServices.reset(new GAME::CGameServices(*m_gameControllerManager,
+      *m_gameRenderManager,
+      *m_peripherals,
+      *profileManager));
+    return true;
+  }, CInitGraph::MAIN_THREAD);
+
+  graph.Add("contextmenumanager.init", {"gameservices"}, [this]() {
+    m_contextMenuManager->Init();
+    return true;
+  }, CInitGraph::MAIN_THREAD);
+
+  graph.Add("pvrmanager.init", {"contextmenumanager.init"}, [this]() {
+    m_PVRManager->Init();
+    return true;
+  }, CInitGraph::MAIN_THREAD);
+
+  // only parses the player configuration files
+  graph.Add("playercorefactory", {}, [this, &profileManager]() {
+    m_playerCoreFactory.reset(new CPlayerCoreFactory(*profileManager));
+    return true;
+  });
+}
+
 void CServiceManager::DeinitStageThree()
 {
   init_level = 2;
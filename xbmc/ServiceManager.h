@@ -13,6 +13,7 @@
 #include <memory>
 
 class CAppParamParser;
+class CInitGraph;
 
 namespace ADDON
 {
@@ -81,6 +82,13 @@ public:
   bool InitStageOne();
   bool InitStageTwo(const CAppParamParser &params, const std::string& profilesUserDataFolder);
   bool InitStageThree(const std::shared_ptr<CProfileManager>& profileManager);
+
+  /*!
+   * \brief Declare the services of stage two or three with their dependencies, without
+   * running them. Used by the Init functions and by the tests checking their order.
+   */
+  void AddStageTwoSteps(CInitGraph& graph, const CAppParamParser &params, const std::string& profilesUserDataFolder);
+  void AddStageThreeSteps(CInitGraph& graph, const std::shared_ptr<CProfileManager>& profileManager);
   void DeinitTesting();
   void DeinitStageThree();
   void DeinitStageTwo();
@@ -25,6 +25,22 @@
 
 using namespace ADDON;
 
+const char* const CURL::VIRTUAL_PROTOCOLS[] = {"stack", "virtualpath", "multipath", "special", "resource", nullptr};
+
+const char* const CURL::QUERY_OPTIONS_PROTOCOLS[] = {"rss", "rsss", "rar", "apk", "xbt", "zip", "addons", "image",
+                                                     "videodb", "musicdb", "androidapp", "pvr", nullptr};
+
+const char* const CURL::OPTIONS_PROTOCOLS[] = {"http", "https", "plugin", "addons", "rtsp", nullptr};
+
+const char* const CURL::FTP_OPTIONS_PROTOCOLS[] = {"ftp", "ftps", nullptr};
+
+// iso9960 doesnt have an hostname;-)
+const char* const CURL::HOSTNAME_IN_FILENAME_PROTOCOLS[] = {"iso9660", "musicdb", "videodb", "sources", "pvr", nullptr};
+
+const char* const CURL::HTTP_PROTOCOLS[] = {"shout", "dav", "rss", nullptr};
+
+const char* const CURL::HTTPS_PROTOCOLS[] = {"davs", "rsss", nullptr};
+
 CURL::~CURL() = default;
 
 void CURL::Reset()
@@ -124,13 +140,7 @@ void CURL::Parse(const std::string& strURL1)
   // ones that come to mind are iso9660, cdda, musicdb, etc.
   // they are all local protocols and have no server part, port number, special options, etc.
   // this removes the need for special handling below.
-  if (
-    IsProtocol("stack") ||
-    IsProtocol("virtualpath") ||
-    IsProtocol("multipath") ||
-    IsProtocol("special") ||
-    IsProtocol("resource")
-    )
+  if (IsProtocolIn(VIRTUAL_PROTOCOLS))
   {
     SetFileName(strURL.substr(iPos));
     return;
@@ -159,28 +169,11 @@ void CURL::Parse(const std::string& strURL1)
 
   //! @todo fix all Addon paths
   std::string strProtocol2 = GetTranslatedProtocol();
-  if(IsProtocol("rss") ||
-     IsProtocol("rsss") ||
-     IsProtocol("rar") ||
-     IsProtocol("apk") ||
-     IsProtocol("xbt") ||
-     IsProtocol("zip") ||
-     IsProtocol("addons") ||
-     IsProtocol("image") ||
-     IsProtocol("videodb") ||
-     IsProtocol("musicdb") ||
-     IsProtocol("androidapp") ||
-     IsProtocol("pvr"))
+  if (IsProtocolIn(QUERY_OPTIONS_PROTOCOLS))
     sep = "?";
-  else
-  if(  IsProtocolEqual(strProtocol2, "http")
-    || IsProtocolEqual(strProtocol2, "https")
-    || IsProtocolEqual(strProtocol2, "plugin")
-    || IsProtocolEqual(strProtocol2, "addons")
-    || IsProtocolEqual(strProtocol2, "rtsp"))
+  else if (IsProtocolIn(strProtocol2, OPTIONS_PROTOCOLS))
     sep = "?;#|";
-  else if(IsProtocolEqual(strProtocol2, "ftp")
-       || IsProtocolEqual(strProtocol2, "ftps"))
+  else if (IsProtocolIn(strProtocol2, FTP_OPTIONS_PROTOCOLS))
     sep = "?;|";
 
   if(sep)
@@ -278,12 +271,7 @@ void CURL::Parse(const std::string& strURL1)
       m_strFileName = strURL.substr(iPos, iEnd - iPos);
   }
 
-  // iso9960 doesnt have an hostname;-)
-  if (IsProtocol("iso9660")
-   || IsProtocol("musicdb")
-   || IsProtocol("videodb")
-   || IsProtocol("sources")
-   || IsProtocol("pvr"))
+  if (IsProtocolIn(HOSTNAME_IN_FILENAME_PROTOCOLS))
   {
     if (m_strHostName != "" && m_strFileName != "")
     {
@@ -378,13 +366,10 @@ void CURL::SetProtocolOptions(const std::string& strOptions)
 
 const std::string CURL::GetTranslatedProtocol() const
 {
-  if (IsProtocol("shout")
-   || IsProtocol("dav")
-   || IsProtocol("rss"))
+  if (IsProtocolIn(HTTP_PROTOCOLS))
     return "http";
 
-  if (IsProtocol("davs")
-   || IsProtocol("rsss"))
+  if (IsProtocolIn(HTTPS_PROTOCOLS))
     return "https";
 
   return GetProtocol();
@@ -722,6 +707,16 @@ bool CURL::IsProtocolEqual(const std::string &protocol, const char *type)
   return false;
 }
 
+bool CURL::IsProtocolIn(const std::string& protocol, const char* const* types)
+{
+  for (; *types; ++types)
+  {
+    if (protocol == *types)
+      return true;
+  }
+  return false;
+}
+
 void CURL::GetOptions(std::map<std::string, std::string> &options) const
 {
   CUrlOptions::UrlOptions optionsMap = m_options.GetOptions();
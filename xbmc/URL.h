@@ -160,6 +160,34 @@ public:
    */
   static bool IsProtocolEqual(const std::string& protocol, const char *type);
 
+  /*! \brief Check whether a URL is one of the given URL schemes.
+   \param types lower-case scheme names, terminated by nullptr, e.g. VIRTUAL_PROTOCOLS.
+   \return true if the url is of one of the given schemes, false otherwise.
+   */
+  bool IsProtocolIn(const char* const* types) const
+  {
+    return IsProtocolIn(m_strProtocol, types);
+  }
+
+  /*! \brief Check whether a lower-case URL protocol is one of the given URL schemes.
+   \sa IsProtocolEqual
+   */
+  static bool IsProtocolIn(const std::string& protocol, const char* const* types);
+
+  /*! \name Protocols Parse() treats specially
+   Lists of lower-case scheme names terminated by nullptr, shared with CURLView
+   which has to parse URLs the same way.
+   */
+  ///@{
+  static const char* const VIRTUAL_PROTOCOLS[]; ///< the rest of the url is the file name
+  static const char* const QUERY_OPTIONS_PROTOCOLS[]; ///< options start at '?'
+  static const char* const OPTIONS_PROTOCOLS[]; ///< translated protocols with options starting at '?', ';', '#' or '|'
+  static const char* const FTP_OPTIONS_PROTOCOLS[]; ///< translated protocols with options starting at '?', ';' or '|'
+  static const char* const HOSTNAME_IN_FILENAME_PROTOCOLS[]; ///< the first folder is parsed as the host name
+  static const char* const HTTP_PROTOCOLS[]; ///< protocols translated to http
+  static const char* const HTTPS_PROTOCOLS[]; ///< protocols translated to https
+  ///@}
+
   /*! \brief Check whether a URL is a given filetype.
    Comparison is effectively case-insensitive as both the parameter
    and m_strFileType are lower-case.
@@ -0,0 +1,418 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "URLView.h"
+
+#include "ServiceBroker.h"
+#include "URL.h"
+#include "network/Network.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+#include <ctype.h>
+#include <string.h>
+
+namespace
+{
+bool EqualsNoCase(const CURLView::Part& part, const char* lowerCase)
+{
+  if (!lowerCase)
+    return false;
+
+  size_t i = 0;
+  for (; i < part.size; i++)
+  {
+    if (lowerCase[i] == '\0' || tolower(static_cast<unsigned char>(part.data[i])) != lowerCase[i])
+      return false;
+  }
+  return lowerCase[i] == '\0';
+}
+
+std::string ToLower(const CURLView::Part& part)
+{
+  std::string str = part.str();
+  StringUtils::ToLower(str);
+  return str;
+}
+
+// same as atoi() on the range
+int ParsePort(const char* data, size_t size)
+{
+  size_t i = 0;
+  while (i < size && isspace(static_cast<unsigned char>(data[i])))
+    i++;
+
+  bool negative = false;
+  if (i < size && (data[i] == '+' || data[i] == '-'))
+    negative = data[i++] == '-';
+
+  int port = 0;
+  for (; i < size && isdigit(static_cast<unsigned char>(data[i])); i++)
+    port = port * 10 + (data[i] - '0');
+
+  return negative ? -port : port;
+}
+}
+
+CURLView::CURLView(const std::string& url) : m_url(url)
+{
+  if (!Parse())
+    m_parsed.reset(new CURL(m_url));
+}
+
+CURLView::CURLView(std::string&& url) : m_ownedURL(std::move(url)), m_url(m_ownedURL)
+{
+  if (!Parse())
+    m_parsed.reset(new CURL(m_url));
+}
+
+CURLView::~CURLView() = default;
+
+CURLView::Part CURLView::MakePart(size_t pos, size_t size) const
+{
+  Part part;
+  part.data = m_url.data() + pos;
+  part.size = size;
+  return part;
+}
+
+bool CURLView::Parse()
+{
+  // follows CURL::Parse, see there for the formats
+  const std::string& url = m_url;
+  if (url.empty() || url == "?")
+    return true;
+
+  // CUtil::ValidatePath turns backslashes into slashes
+  if (url.find('\\') != std::string::npos)
+    return false;
+
+  size_t pos = url.find("://");
+  if (pos == std::string::npos)
+  {
+    // local paths into zip and apk files are turned into zip:// and apk:// urls
+    if (url.find(".zip/") != std::string::npos || url.find(".apk/") != std::string::npos)
+      return false;
+
+#ifdef TARGET_WINDOWS
+    // CUtil::ValidatePath turns the slashes of dos paths into backslashes
+    if (url.find('/') != std::string::npos)
+      return false;
+#endif
+
+    SetFileName(0, url.size());
+    return true;
+  }
+
+  m_protocol = MakePart(0, pos);
+  pos += 3;
+
+  // virtual protocols
+  if (IsProtocolIn(CURL::VIRTUAL_PROTOCOLS))
+  {
+    SetFileName(pos, url.size() - pos);
+    return true;
+  }
+
+  // iso paths inside udf urls get rewritten
+  if (IsProtocol("udf"))
+    return false;
+
+  size_t end = url.size();
+  const char* sep = nullptr;
+
+  if (IsProtocolIn(CURL::QUERY_OPTIONS_PROTOCOLS))
+    sep = "?";
+  else if (IsTranslatedProtocolIn(CURL::OPTIONS_PROTOCOLS))
+    sep = "?;#|";
+  else if (IsTranslatedProtocolIn(CURL::FTP_OPTIONS_PROTOCOLS))
+    sep = "?;|";
+
+  if (sep)
+  {
+    const size_t options = url.find_first_of(sep, pos);
+    if (options != std::string::npos)
+    {
+      const size_t protocolOptions = url.find('|', options);
+      const size_t optionsEnd = protocolOptions == std::string::npos ? url.size() : protocolOptions;
+
+      // CURL::SetOptions drops options it doesn't know
+      const size_t xml = url.find("xml", options);
+      if (url[options] == '?' || url[options] == '#' || url[options] == ';' ||
+          (xml != std::string::npos && xml + 3 <= optionsEnd))
+        m_options = MakePart(options, optionsEnd - options);
+
+      end = options;
+    }
+  }
+
+  size_t slash = url.find('/', pos);
+  if (slash >= end)
+    slash = std::string::npos;
+
+  const bool hostInFileName = IsProtocolIn(CURL::HOSTNAME_IN_FILENAME_PROTOCOLS);
+
+  if (!IsProtocol("iso9660"))
+  {
+    const size_t at = url.find('@', pos);
+    if (at != std::string::npos && at < end && (slash == std::string::npos || at < slash))
+    {
+      if (hostInFileName)
+        return false;
+
+      // skip username and password
+      pos = at + 1;
+      slash = url.find('/', at);
+      if (slash >= end)
+        slash = std::string::npos;
+    }
+  }
+
+  const size_t hostEnd = slash == std::string::npos ? end : slash;
+
+  if (hostInFileName)
+  {
+    // the host name is the first folder of the file name, so the file name is
+    // the rest of the url unless there is a port or no host name at all
+    if (pos < end && url[pos] == '/')
+      return false;
+    for (size_t i = pos; i < hostEnd; i++)
+    {
+      if (url[i] == ':' || url[i] == '[')
+        return false;
+    }
+
+    SetFileName(pos, end - pos);
+    return true;
+  }
+
+  // [IPv6] host name
+  size_t portPos = pos;
+  if (hostEnd > pos && url[pos] == '[')
+  {
+    const size_t bracket = url.rfind(']', hostEnd - 1);
+    if (bracket != std::string::npos && bracket > pos)
+    {
+      if (bracket == pos + 1)
+        return false;
+
+      m_hostName = MakePart(pos + 1, bracket - pos - 1);
+      portPos = bracket + 1;
+    }
+  }
+
+  // hostname:port or just :port after an IPv6 address
+  size_t colon = std::string::npos;
+  size_t colons = 0;
+  for (size_t i = portPos; i < hostEnd; i++)
+  {
+    if (url[i] == ':')
+    {
+      colon = i;
+      colons++;
+    }
+  }
+
+  if (colons == 1)
+  {
+    if (m_hostName.empty())
+      m_hostName = MakePart(portPos, colon - portPos);
+    m_port = ParsePort(url.data() + colon + 1, hostEnd - colon - 1);
+  }
+
+  if (m_hostName.empty())
+    m_hostName = MakePart(portPos, hostEnd - portPos);
+
+  if (slash != std::string::npos)
+  {
+    pos = slash + 1;
+    if (end > pos)
+      SetFileName(pos, end - pos);
+  }
+
+  return true;
+}
+
+void CURLView::SetFileName(size_t pos, size_t size)
+{
+  m_fileName = MakePart(pos, size);
+  m_fileType = Part();
+
+#ifndef TARGET_POSIX
+  const char separator = m_protocol.empty() ? '\\' : '/';
+#else
+  const char separator = '/';
+#endif
+
+  for (size_t i = size; i > 0; i--)
+  {
+    const char c = m_fileName.data[i - 1];
+    if (c == separator)
+      break;
+    if (c == '.')
+    {
+      m_fileType = MakePart(pos + i, size - i);
+      break;
+    }
+  }
+
+  // CURL trims the file type
+  while (!m_fileType.empty() && isspace(static_cast<unsigned char>(m_fileType.data[0])))
+  {
+    m_fileType.data++;
+    m_fileType.size--;
+  }
+  while (!m_fileType.empty() && isspace(static_cast<unsigned char>(m_fileType.data[m_fileType.size - 1])))
+    m_fileType.size--;
+}
+
+bool CURLView::IsProtocol(const char* type) const
+{
+  if (m_parsed)
+    return m_parsed->IsProtocol(type);
+
+  return EqualsNoCase(m_protocol, type);
+}
+
+bool CURLView::HasProtocol() const
+{
+  if (m_parsed)
+    return !m_parsed->GetProtocol().empty();
+
+  return !m_protocol.empty();
+}
+
+std::string CURLView::GetProtocol() const
+{
+  if (m_parsed)
+    return m_parsed->GetProtocol();
+
+  return ToLower(m_protocol);
+}
+
+std::string CURLView::GetTranslatedProtocol() const
+{
+  const char* translated = TranslateProtocol();
+  return translated ? translated : GetProtocol();
+}
+
+const char* CURLView::TranslateProtocol() const
+{
+  if (IsProtocolIn(CURL::HTTP_PROTOCOLS))
+    return "http";
+
+  if (IsProtocolIn(CURL::HTTPS_PROTOCOLS))
+    return "https";
+
+  return nullptr;
+}
+
+bool CURLView::IsProtocolIn(const char* const* types) const
+{
+  if (m_parsed)
+    return m_parsed->IsProtocolIn(types);
+
+  for (; *types; ++types)
+  {
+    if (EqualsNoCase(m_protocol, *types))
+      return true;
+  }
+  return false;
+}
+
+bool CURLView::IsTranslatedProtocolIn(const char* const* types) const
+{
+  const char* translated = TranslateProtocol();
+  if (!translated)
+    return IsProtocolIn(types);
+
+  for (; *types; ++types)
+  {
+    if (strcmp(translated, *types) == 0)
+      return true;
+  }
+  return false;
+}
+
+std::string CURLView::GetHostName() const
+{
+  if (m_parsed)
+    return m_parsed->GetHostName();
+
+  if (URIUtils::HasEncodedHostname(*this))
+    return CURL::Decode(m_hostName.str());
+
+  return m_hostName.str();
+}
+
+bool CURLView::HasHostName() const
+{
+  if (m_parsed)
+    return !m_parsed->GetHostName().empty();
+
+  return !m_hostName.empty();
+}
+
+int CURLView::GetPort() const
+{
+  if (m_parsed)
+    return m_parsed->GetPort();
+
+  return m_port;
+}
+
+CURLView::Part CURLView::GetFileName() const
+{
+  if (m_parsed)
+  {
+    Part part;
+    part.data = m_parsed->GetFileName().data();
+    part.size = m_parsed->GetFileName().size();
+    return part;
+  }
+
+  return m_fileName;
+}
+
+bool CURLView::IsFileType(const char* type) const
+{
+  if (m_parsed)
+    return m_parsed->IsFileType(type);
+
+  return EqualsNoCase(m_fileType, type);
+}
+
+std::string CURLView::GetFileType() const
+{
+  if (m_parsed)
+    return m_parsed->GetFileType();
+
+  return ToLower(m_fileType);
+}
+
+CURLView::Part CURLView::GetOptions() const
+{
+  if (m_parsed)
+  {
+    Part part;
+    part.data = m_parsed->GetOptions().data();
+    part.size = m_parsed->GetOptions().size();
+    return part;
+  }
+
+  return m_options;
+}
+
+bool CURLView::IsLocal() const
+{
+  if (m_parsed)
+    return m_parsed->IsLocal();
+
+  return !HasProtocol() || IsProtocol("win-lib") ||
+         CServiceBroker::GetNetwork().IsLocalHost(GetHostName());
+}
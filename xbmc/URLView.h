@@ -0,0 +1,110 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+class CURL;
+
+/*!
+ \brief Read-only view of a parsed URL.
+
+ Unlike CURL, which copies every component of the URL into a string of its
+ own, the view only records where the components are in the URL. Checking the
+ protocol, the file type or whether there is a file name doesn't allocate.
+ Components that may need decoding, like the host name, are decoded when they
+ are asked for.
+
+ The view follows the rules of CURL::Parse. URLs that CURL rewrites while
+ parsing, e.g. local paths into zip files or paths with backslashes, are
+ parsed by a CURL the view then forwards to.
+
+ A view constructed from an lvalue refers to that string, which has to outlive
+ the view. A view constructed from an rvalue takes ownership of the string.
+
+ \code
+ CURLView url(path);
+ if (url.IsProtocol("zip") && !url.GetFileName().empty())
+   ...
+ \endcode
+ */
+class CURLView
+{
+public:
+  /*!
+   \brief Part of the URL string, valid as long as the view.
+   */
+  struct Part
+  {
+    const char* data = nullptr;
+    size_t size = 0;
+
+    bool empty() const { return size == 0; }
+    std::string str() const { return std::string(data, size); }
+  };
+
+  explicit CURLView(const std::string& url);
+  explicit CURLView(std::string&& url);
+  ~CURLView();
+
+  /*! \brief Check whether the URL is of a given lower-case scheme, case-insensitively. */
+  bool IsProtocol(const char* type) const;
+  /*! \brief Check whether the URL is of one of the given schemes, e.g. CURL::VIRTUAL_PROTOCOLS. */
+  bool IsProtocolIn(const char* const* types) const;
+  /*! \brief Check whether the URL is handled as one of the given schemes, like CURL::GetTranslatedProtocol. */
+  bool IsTranslatedProtocolIn(const char* const* types) const;
+  bool HasProtocol() const;
+  std::string GetProtocol() const;
+  std::string GetTranslatedProtocol() const;
+
+  /*! \brief The host name, decoded for protocols that encode it. */
+  std::string GetHostName() const;
+  bool HasHostName() const;
+  int GetPort() const;
+
+  Part GetFileName() const;
+
+  /*! \brief Check whether the URL is of a given lower-case file type, case-insensitively. */
+  bool IsFileType(const char* type) const;
+  std::string GetFileType() const;
+
+  Part GetOptions() const;
+
+  bool IsLocal() const;
+
+private:
+  CURLView(const CURLView&) = delete;
+  CURLView& operator=(const CURLView&) = delete;
+
+  /*!
+   \brief Find the components.
+   \return false if the URL has to be parsed by CURL.
+   */
+  bool Parse();
+  void SetFileName(size_t pos, size_t size);
+  Part MakePart(size_t pos, size_t size) const;
+
+  /*!
+   \brief The protocol a protocol is handled as, like CURL::GetTranslatedProtocol.
+   \return nullptr if it is handled as itself.
+   */
+  const char* TranslateProtocol() const;
+
+  std::string m_ownedURL;
+  const std::string& m_url;
+  std::unique_ptr<CURL> m_parsed;
+
+  Part m_protocol;
+  Part m_hostName;
+  Part m_fileName;
+  Part m_fileType;
+  Part m_options;
+  int m_port = 0;
+};
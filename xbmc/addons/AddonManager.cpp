@@ -399,9 +399,16 @@ bool CAddonMgr::FindAddons()
 {
   ADDON_INFO_LIST installedAddons;
 
-  FindAddons(installedAddons, "special://xbmcbin/addons");
-  FindAddons(installedAddons, "special://xbmc/addons");
-  FindAddons(installedAddons, "special://home/addons");
+  {
+    CSingleLock lock(m_manifestCacheSection);
+    m_manifestCache.Load();
+
+    FindAddons(installedAddons, "special://xbmcbin/addons");
+    FindAddons(installedAddons, "special://xbmc/addons");
+    FindAddons(installedAddons, "special://home/addons");
+
+    m_manifestCache.Save();
+  }
 
   std::set<std::string> installed;
   for (const auto& addon : installedAddons)
@@ -805,33 +812,30 @@ const AddonInfoPtr CAddonMgr::GetAddonInfo(const std::string& id, TYPE type /*=
 void CAddonMgr::FindAddons(ADDON_INFO_LIST& addonmap, const std::string& path)
 {
   CFileItemList items;
-  if (XFILE::CDirectory::GetDirectory(path, items, "", XFILE::DIR_FLAG_NO_FILE_DIRS))
+  if (!XFILE::CDirectory::GetDirectory(path, items, "", XFILE::DIR_FLAG_NO_FILE_DIRS))
+    return;
+
+  std::vector<std::string> addonPaths;
+  addonPaths.reserve(items.Size());
+  for (int i = 0; i < items.Size(); ++i)
+    addonPaths.emplace_back(items[i]->GetPath());
+
+  for (const auto& addonInfo : m_manifestCache.GetManifests(addonPaths))
   {
-    for (int i = 0; i < items.Size(); ++i)
+    const auto& it = addonmap.find(addonInfo->ID());
+    if (it != addonmap.end())
     {
-      std::string path = items[i]->GetPath();
-      if (XFILE::CFile::Exists(path + "addon.xml"))
+      if (it->second->Version() > addonInfo->Version())
       {
-        AddonInfoPtr addonInfo = CAddonInfoBuilder::Generate(path);
-        if (addonInfo)
-        {
-          const auto& it = addonmap.find(addonInfo->ID());
-          if (it != addonmap.end())
-          {
-            if (it->second->Version() > addonInfo->Version())
-            {
-              CLog::Log(LOGWARNING, "CAddonMgr::{}: Addon '{}' already present with higher version {} at '{}' - other version {} at '{}' will be ignored",
-                           __FUNCTION__, addonInfo->ID(), it->second->Version().asString(), it->second->Path(), addonInfo->Version().asString(), addonInfo->Path());
-              continue;
-            }
-            CLog::Log(LOGDEBUG, "CAddonMgr::{}: Addon '{}' already present with version {} at '{}' replaced with version {} at '{}'",
-                         __FUNCTION__, addonInfo->ID(), it->second->Version().asString(), it->second->Path(), addonInfo->Version().asString(), addonInfo->Path());
-          }
-
-          addonmap[addonInfo->ID()] = addonInfo;
-        }
+        CLog::Log(LOGWARNING, "CAddonMgr::{}: Addon '{}' already present with higher version {} at '{}' - other version {} at '{}' will be ignored",
+                     __FUNCTION__, addonInfo->ID(), it->second->Version().asString(), it->second->Path(), addonInfo->Version().asString(), addonInfo->Path());
+        continue;
       }
+      CLog::Log(LOGDEBUG, "CAddonMgr::{}: Addon '{}' already present with version {} at '{}' replaced with version {} at '{}'",
+                   __FUNCTION__, addonInfo->ID(), it->second->Version().asString(), it->second->Path(), addonInfo->Version().asString(), addonInfo->Path());
     }
+
+    addonmap[addonInfo->ID()] = addonInfo;
   }
 }
 
@@ -11,6 +11,7 @@
 #include "Addon.h"
 #include "AddonDatabase.h"
 #include "Repository.h"
+#include "addons/addoninfo/AddonManifestCache.h"
 #include "threads/CriticalSection.h"
 #include "utils/EventStream.h"
 
@@ -258,6 +259,8 @@ namespace ADDON
     std::set<std::string> m_systemAddons;
     std::set<std::string> m_optionalAddons;
     ADDON_INFO_LIST m_installedAddons;
+    CCriticalSection m_manifestCacheSection;
+    CAddonManifestCache m_manifestCache{"special://temp/addonmanifests.cache"};
   };
 
 }; /* namespace ADDON */
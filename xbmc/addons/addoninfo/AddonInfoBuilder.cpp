@@ -9,6 +9,7 @@
 #include "AddonInfoBuilder.h"
 
 #include "LangInfo.h"
+#include "addons/addoninfo/AddonManifestCache.h"
 #include "addons/addoninfo/AddonType.h"
 #include "filesystem/File.h"
 #include "filesystem/SpecialProtocol.h"
@@ -27,6 +28,46 @@ namespace
 {
 // Note that all of these characters are url-safe
 const std::string VALID_ADDON_IDENTIFIER_CHARACTERS = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789.-_@!$";
+
+// extension elements nest only a few levels in practice, anything deeper is damaged data
+const unsigned int MAX_EXTENSION_DEPTH = 32;
+
+template<class MAP>
+void WriteMap(ADDON::CManifestWriter& writer, const MAP& values)
+{
+  writer.Write(static_cast<uint32_t>(values.size()));
+  for (const auto& value : values)
+  {
+    writer.Write(value.first);
+    writer.Write(value.second);
+  }
+}
+
+template<class MAP>
+void ReadMap(ADDON::CManifestReader& reader, MAP& values)
+{
+  const uint32_t count = reader.ReadCount(8);
+  for (uint32_t i = 0; i < count; i++)
+  {
+    std::string key = reader.ReadString();
+    values.emplace(std::move(key), reader.ReadString());
+  }
+}
+
+void WriteList(ADDON::CManifestWriter& writer, const std::vector<std::string>& values)
+{
+  writer.Write(static_cast<uint32_t>(values.size()));
+  for (const std::string& value : values)
+    writer.Write(value);
+}
+
+void ReadList(ADDON::CManifestReader& reader, std::vector<std::string>& values)
+{
+  const uint32_t count = reader.ReadCount(4);
+  values.reserve(count);
+  for (uint32_t i = 0; i < count; i++)
+    values.emplace_back(reader.ReadString());
+}
 }
 
 namespace ADDON
@@ -622,4 +663,173 @@ bool CAddonInfoBuilder::PlatformSupportsAddon(const AddonInfoPtr& addon)
       supportedPlatforms.begin(), supportedPlatforms.end()) != addon->m_platforms.end();
 }
 
+void CAddonInfoBuilder::Serialize(const CAddonInfo& addon, CManifestWriter& writer)
+{
+  writer.Write(addon.m_id);
+  writer.Write(static_cast<uint32_t>(addon.m_mainType));
+
+  writer.Write(static_cast<uint32_t>(addon.m_types.size()));
+  for (const CAddonType& type : addon.m_types)
+  {
+    writer.Write(static_cast<uint32_t>(type.m_type));
+    writer.Write(type.m_path);
+    writer.Write(type.m_libname);
+    writer.Write(static_cast<uint32_t>(type.m_providedSubContent.size()));
+    for (TYPE content : type.m_providedSubContent)
+      writer.Write(static_cast<uint32_t>(content));
+    SerializeExtensions(type, writer);
+  }
+
+  writer.Write(addon.m_version.asString());
+  writer.Write(addon.m_minversion.asString());
+  writer.Write(addon.m_name);
+  writer.Write(addon.m_license);
+  WriteMap(writer, addon.m_summary);
+  WriteMap(writer, addon.m_description);
+  writer.Write(addon.m_author);
+  writer.Write(addon.m_source);
+  writer.Write(addon.m_website);
+  writer.Write(addon.m_forum);
+  writer.Write(addon.m_email);
+  writer.Write(addon.m_path);
+  WriteMap(writer, addon.m_changelog);
+  writer.Write(addon.m_icon);
+  WriteMap(writer, addon.m_art);
+  WriteList(writer, addon.m_screenshots);
+  WriteMap(writer, addon.m_disclaimer);
+
+  writer.Write(static_cast<uint32_t>(addon.m_dependencies.size()));
+  for (const DependencyInfo& dependency : addon.m_dependencies)
+  {
+    writer.Write(dependency.id);
+    writer.Write(dependency.versionMin.asString());
+    writer.Write(dependency.version.asString());
+    writer.Write(static_cast<uint32_t>(dependency.optional));
+  }
+
+  writer.Write(addon.m_broken);
+  writer.Write(addon.m_packageSize);
+  writer.Write(addon.m_libname);
+  WriteMap(writer, addon.m_extrainfo);
+  WriteList(writer, addon.m_platforms);
+}
+
+AddonInfoPtr CAddonInfoBuilder::Deserialize(CManifestReader& reader)
+{
+  AddonInfoPtr addon = std::make_shared<CAddonInfo>();
+  addon->m_id = reader.ReadString();
+  addon->m_mainType = static_cast<TYPE>(reader.ReadUInt32());
+
+  const uint32_t types = reader.ReadCount(16);
+  for (uint32_t i = 0; i < types; i++)
+  {
+    CAddonType type(static_cast<TYPE>(reader.ReadUInt32()));
+    type.m_path = reader.ReadString();
+    type.m_libname = reader.ReadString();
+    const uint32_t contents = reader.ReadCount(4);
+    for (uint32_t j = 0; j < contents; j++)
+      type.m_providedSubContent.insert(static_cast<TYPE>(reader.ReadUInt32()));
+    if (!DeserializeExtensions(type, reader, 0))
+      return nullptr;
+    addon->m_types.push_back(std::move(type));
+  }
+
+  addon->m_version = AddonVersion(reader.ReadString());
+  addon->m_minversion = AddonVersion(reader.ReadString());
+  addon->m_name = reader.ReadString();
+  addon->m_license = reader.ReadString();
+  ReadMap(reader, addon->m_summary);
+  ReadMap(reader, addon->m_description);
+  addon->m_author = reader.ReadString();
+  addon->m_source = reader.ReadString();
+  addon->m_website = reader.ReadString();
+  addon->m_forum = reader.ReadString();
+  addon->m_email = reader.ReadString();
+  addon->m_path = reader.ReadString();
+  ReadMap(reader, addon->m_changelog);
+  addon->m_icon = reader.ReadString();
+  ReadMap(reader, addon->m_art);
+  ReadList(reader, addon->m_screenshots);
+  ReadMap(reader, addon->m_disclaimer);
+
+  const uint32_t dependencies = reader.ReadCount(16);
+  for (uint32_t i = 0; i < dependencies; i++)
+  {
+    std::string id = reader.ReadString();
+    std::string versionMin = reader.ReadString();
+    std::string version = reader.ReadString();
+    const bool optional = reader.ReadUInt32() != 0;
+    addon->m_dependencies.emplace_back(std::move(id), AddonVersion(versionMin), AddonVersion(version), optional);
+  }
+
+  addon->m_broken = reader.ReadString();
+  addon->m_packageSize = reader.ReadUInt64();
+  addon->m_libname = reader.ReadString();
+  ReadMap(reader, addon->m_extrainfo);
+  ReadList(reader, addon->m_platforms);
+
+  if (reader.Failed() || !reader.AtEnd() || addon->m_id.empty() || addon->m_types.empty())
+    return nullptr;
+
+  return addon;
+}
+
+void CAddonInfoBuilder::SerializeExtensions(const CAddonExtensions& extensions, CManifestWriter& writer)
+{
+  writer.Write(extensions.m_point);
+
+  writer.Write(static_cast<uint32_t>(extensions.m_values.size()));
+  for (const auto& values : extensions.m_values)
+  {
+    writer.Write(values.first);
+    writer.Write(static_cast<uint32_t>(values.second.size()));
+    for (const auto& value : values.second)
+    {
+      writer.Write(value.first);
+      writer.Write(value.second.str);
+    }
+  }
+
+  writer.Write(static_cast<uint32_t>(extensions.m_children.size()));
+  for (const auto& child : extensions.m_children)
+  {
+    writer.Write(child.first);
+    SerializeExtensions(child.second, writer);
+  }
+}
+
+bool CAddonInfoBuilder::DeserializeExtensions(CAddonExtensions& extensions, CManifestReader& reader, unsigned int depth)
+{
+  if (depth > MAX_EXTENSION_DEPTH)
+    return false;
+
+  extensions.m_point = reader.ReadString();
+
+  const uint32_t valueLists = reader.ReadCount(8);
+  for (uint32_t i = 0; i < valueLists; i++)
+  {
+    std::string name = reader.ReadString();
+    EXT_VALUE values;
+    const uint32_t count = reader.ReadCount(8);
+    for (uint32_t j = 0; j < count; j++)
+    {
+      std::string key = reader.ReadString();
+      values.emplace_back(std::move(key), SExtValue(reader.ReadString()));
+    }
+    extensions.m_values.emplace_back(std::move(name), CExtValues(values));
+  }
+
+  const uint32_t children = reader.ReadCount(16);
+  for (uint32_t i = 0; i < children; i++)
+  {
+    std::string name = reader.ReadString();
+    CAddonExtensions child;
+    if (!DeserializeExtensions(child, reader, depth + 1))
+      return false;
+    extensions.m_children.emplace_back(std::move(name), std::move(child));
+  }
+
+  return !reader.Failed();
+}
+
 }
@@ -16,6 +16,9 @@ class TiXmlElement;
 namespace ADDON
 {
 
+class CManifestReader;
+class CManifestWriter;
+
 class CAddonInfoBuilder
 {
 public:
@@ -83,13 +86,26 @@ public:
                              const CDateTime& lastUpdated, const CDateTime& lastUsed, const std::string& origin);
   //@}
 
+  /*!
+    * @brief Parts used from CAddonManifestCache
+    *
+    * Only the values parsed from addon.xml are stored, install data comes from
+    * the database.
+    */
+  //@{
+  static void Serialize(const CAddonInfo& addon, CManifestWriter& writer);
+  static AddonInfoPtr Deserialize(CManifestReader& reader);
+  static bool PlatformSupportsAddon(const AddonInfoPtr& addon);
+  //@}
+
 private:
   static bool ParseXML(const AddonInfoPtr& addon, const TiXmlElement* element, const std::string& addonPath, const CRepository::DirInfo& repo = {});
   static bool ParseXMLTypes(CAddonType& addonType, AddonInfoPtr info, const TiXmlElement* child);
   static bool ParseXMLExtension(CAddonExtensions& addonExt, const TiXmlElement* element);
   static bool GetTextList(const TiXmlElement* element, const std::string& tag, std::unordered_map<std::string, std::string>& translatedValues);
   static const char* GetPlatformLibraryName(const TiXmlElement* element);
-  static bool PlatformSupportsAddon(const AddonInfoPtr& addon);
+  static void SerializeExtensions(const CAddonExtensions& extensions, CManifestWriter& writer);
+  static bool DeserializeExtensions(CAddonExtensions& extensions, CManifestReader& reader, unsigned int depth);
 };
 
 }
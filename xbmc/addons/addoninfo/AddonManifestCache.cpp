@@ -0,0 +1,360 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "AddonManifestCache.h"
+
+#include "CompileInfo.h"
+#include "addons/addoninfo/AddonInfoBuilder.h"
+#include "filesystem/File.h"
+#include "threads/Thread.h"
+#include "utils/CPUInfo.h"
+#include "utils/URIUtils.h"
+#include "utils/auto_buffer.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <memory>
+#include <string.h>
+
+namespace
+{
+const uint32_t CACHE_MAGIC = 0x4B414D43; // "KAMC"
+// bump whenever the layout of the file or of the serialized CAddonInfo changes
+const uint32_t CACHE_VERSION = 1;
+
+// path, stamp and data of an entry
+const size_t MIN_ENTRY_SIZE = 4 + 8 + 8 + 4;
+
+// parsing is mostly file access and allocation, more threads don't pay off
+const unsigned int MAX_PARSE_WORKERS = 4;
+// a thread isn't worth starting for fewer manifests
+const size_t MIN_MANIFESTS_PER_WORKER = 16;
+}
+
+namespace ADDON
+{
+
+void CManifestWriter::Write(uint32_t value)
+{
+  m_data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void CManifestWriter::Write(uint64_t value)
+{
+  m_data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void CManifestWriter::Write(const std::string& value)
+{
+  Write(static_cast<uint32_t>(value.size()));
+  m_data.append(value);
+}
+
+bool CManifestReader::Take(size_t size)
+{
+  if (m_failed || static_cast<size_t>(m_end - m_pos) < size)
+  {
+    m_failed = true;
+    return false;
+  }
+  return true;
+}
+
+uint32_t CManifestReader::ReadUInt32()
+{
+  uint32_t value = 0;
+  if (Take(sizeof(value)))
+  {
+    memcpy(&value, m_pos, sizeof(value));
+    m_pos += sizeof(value);
+  }
+  return value;
+}
+
+uint64_t CManifestReader::ReadUInt64()
+{
+  uint64_t value = 0;
+  if (Take(sizeof(value)))
+  {
+    memcpy(&value, m_pos, sizeof(value));
+    m_pos += sizeof(value);
+  }
+  return value;
+}
+
+std::string CManifestReader::ReadString()
+{
+  const uint32_t size = ReadUInt32();
+  if (!Take(size))
+    return std::string();
+
+  std::string value(m_pos, size);
+  m_pos += size;
+  return value;
+}
+
+uint32_t CManifestReader::ReadCount(size_t minSize /* = 1 */)
+{
+  const uint32_t count = ReadUInt32();
+  // reject counts that can't possibly fit instead of allocating for them
+  if (m_failed || static_cast<size_t>(m_end - m_pos) / std::max<size_t>(minSize, 1) < count)
+  {
+    m_failed = true;
+    return 0;
+  }
+  return count;
+}
+
+CAddonManifestCache::CAddonManifestCache(std::string cacheFile) : m_cacheFile(std::move(cacheFile))
+{
+}
+
+bool CAddonManifestCache::GetStamp(const std::string& addonPath, Stamp& stamp)
+{
+  struct __stat64 st;
+  if (XFILE::CFile::Stat(URIUtils::AddFileToFolder(addonPath, "addon.xml"), &st) != 0)
+    return false;
+
+  stamp.mtime = static_cast<uint64_t>(st.st_mtime);
+  stamp.size = static_cast<uint64_t>(st.st_size);
+  return true;
+}
+
+void CAddonManifestCache::Load()
+{
+  if (m_loaded)
+    return;
+  m_loaded = true;
+
+  // the whole cache is read at once, it is validated against the manifests on use
+  XFILE::CFile file;
+  XUTILS::auto_buffer buffer;
+  if (file.LoadFile(m_cacheFile, buffer) <= 0)
+    return;
+
+  if (!Parse(buffer.get(), buffer.size()))
+  {
+    CLog::Log(LOGDEBUG, "CAddonManifestCache::{}: discarding outdated or damaged cache '{}'",
+              __FUNCTION__, m_cacheFile);
+    m_entries.clear();
+    m_changed = true;
+    return;
+  }
+
+  CLog::Log(LOGDEBUG, "CAddonManifestCache::{}: loaded {} manifests", __FUNCTION__,
+            m_entries.size());
+}
+
+bool CAddonManifestCache::Parse(const char* data, size_t size)
+{
+  CManifestReader reader(data, size);
+  if (reader.ReadUInt32() != CACHE_MAGIC || reader.ReadUInt32() != CACHE_VERSION ||
+      reader.ReadString() != CCompileInfo::GetSCMID())
+    return false;
+
+  const uint32_t count = reader.ReadCount(MIN_ENTRY_SIZE);
+  m_entries.reserve(count);
+  for (uint32_t i = 0; i < count; i++)
+  {
+    std::string path = reader.ReadString();
+    Entry entry;
+    entry.stamp.mtime = reader.ReadUInt64();
+    entry.stamp.size = reader.ReadUInt64();
+    entry.data = reader.ReadString();
+    if (reader.Failed())
+      return false;
+
+    m_entries.emplace(std::move(path), std::move(entry));
+  }
+
+  return !reader.Failed() && reader.AtEnd();
+}
+
+bool CAddonManifestCache::Save()
+{
+  for (auto it = m_entries.begin(); it != m_entries.end();)
+  {
+    if (!it->second.used)
+    {
+      it = m_entries.erase(it);
+      m_changed = true;
+    }
+    else
+    {
+      it->second.used = false;
+      ++it;
+    }
+  }
+
+  if (!m_changed)
+    return true;
+
+  CManifestWriter writer;
+  writer.Write(CACHE_MAGIC);
+  writer.Write(CACHE_VERSION);
+  writer.Write(std::string(CCompileInfo::GetSCMID()));
+  writer.Write(static_cast<uint32_t>(m_entries.size()));
+  for (const auto& entry : m_entries)
+  {
+    writer.Write(entry.first);
+    writer.Write(entry.second.stamp.mtime);
+    writer.Write(entry.second.stamp.size);
+    writer.Write(entry.second.data);
+  }
+
+  // write to a temporary file first, a crash mustn't leave a truncated cache behind
+  const std::string tempFile = m_cacheFile + ".tmp";
+  XFILE::CFile file;
+  if (!file.OpenForWrite(tempFile, true))
+  {
+    CLog::Log(LOGERROR, "CAddonManifestCache::{}: unable to write '{}'", __FUNCTION__, tempFile);
+    return false;
+  }
+
+  const std::string& data = writer.Data();
+  const bool written = file.Write(data.data(), data.size()) == static_cast<ssize_t>(data.size());
+  file.Close();
+
+  if (!written || !(XFILE::CFile::Rename(tempFile, m_cacheFile) ||
+                    (XFILE::CFile::Delete(m_cacheFile) && XFILE::CFile::Rename(tempFile, m_cacheFile))))
+  {
+    CLog::Log(LOGERROR, "CAddonManifestCache::{}: unable to write '{}'", __FUNCTION__, m_cacheFile);
+    XFILE::CFile::Delete(tempFile);
+    return false;
+  }
+
+  m_changed = false;
+  return true;
+}
+
+bool CAddonManifestCache::Get(const std::string& addonPath, const Stamp& stamp, AddonInfoPtr& addon)
+{
+  auto it = m_entries.find(addonPath);
+  if (it == m_entries.end() || it->second.stamp != stamp)
+    return false;
+
+  if (it->second.data.empty())
+  {
+    addon.reset();
+  }
+  else
+  {
+    CManifestReader reader(it->second.data.data(), it->second.data.size());
+    addon = CAddonInfoBuilder::Deserialize(reader);
+    if (!addon)
+    {
+      m_entries.erase(it);
+      m_changed = true;
+      return false;
+    }
+  }
+
+  it->second.used = true;
+  return true;
+}
+
+void CAddonManifestCache::Put(const std::string& addonPath, const Stamp& stamp, const AddonInfoPtr& addon)
+{
+  Entry& entry = m_entries[addonPath];
+  entry.stamp = stamp;
+  entry.data.clear();
+  entry.used = true;
+
+  if (addon)
+  {
+    CManifestWriter writer;
+    CAddonInfoBuilder::Serialize(*addon, writer);
+    entry.data = writer.Data();
+  }
+
+  m_changed = true;
+}
+
+std::vector<AddonInfoPtr> CAddonManifestCache::GetManifests(const std::vector<std::string>& addonPaths)
+{
+  std::vector<CManifestParser::Manifest> manifests;
+  manifests.reserve(addonPaths.size());
+  for (const std::string& addonPath : addonPaths)
+  {
+    CManifestParser::Manifest manifest;
+    manifest.path = addonPath;
+    if (!GetStamp(manifest.path, manifest.stamp))
+      continue;
+
+    manifest.parse = !Get(manifest.path, manifest.stamp, manifest.addonInfo);
+    manifests.emplace_back(std::move(manifest));
+  }
+
+  CManifestParser parser(manifests);
+  if (parser.Size() > 0)
+  {
+    CLog::Log(LOGDEBUG, "CAddonManifestCache::{}: parsing {} of {} manifests", __FUNCTION__,
+              parser.Size(), manifests.size());
+    parser.Parse();
+  }
+
+  std::vector<AddonInfoPtr> addons;
+  addons.reserve(manifests.size());
+  for (const auto& manifest : manifests)
+  {
+    // manifests that failed to parse are parsed again next time
+    if (manifest.parse && (manifest.addonInfo || manifest.unsupported))
+      Put(manifest.path, manifest.stamp, manifest.addonInfo);
+
+    if (manifest.addonInfo)
+      addons.push_back(manifest.addonInfo);
+  }
+  return addons;
+}
+
+CManifestParser::CManifestParser(std::vector<Manifest>& manifests)
+{
+  for (Manifest& manifest : manifests)
+  {
+    if (manifest.parse)
+      m_manifests.push_back(&manifest);
+  }
+}
+
+void CManifestParser::Parse()
+{
+  Parse(static_cast<unsigned int>(std::min<size_t>(
+      {MAX_PARSE_WORKERS, static_cast<size_t>(std::max(0, g_cpuInfo.getCPUCount() - 1)),
+       m_manifests.size() / MIN_MANIFESTS_PER_WORKER})));
+}
+
+void CManifestParser::Parse(unsigned int workers)
+{
+  std::vector<std::unique_ptr<CThread>> threads;
+  for (unsigned int i = 0; i < workers; i++)
+  {
+    threads.emplace_back(new CThread(this, "AddonManifestParser"));
+    threads.back()->Create();
+  }
+
+  Run();
+
+  for (auto& thread : threads)
+    thread->StopThread(true);
+}
+
+void CManifestParser::Run()
+{
+  for (size_t i = m_next++; i < m_manifests.size(); i = m_next++)
+  {
+    Manifest& manifest = *m_manifests[i];
+    manifest.addonInfo = CAddonInfoBuilder::Generate(manifest.path, false);
+    if (manifest.addonInfo && !CAddonInfoBuilder::PlatformSupportsAddon(manifest.addonInfo))
+    {
+      manifest.addonInfo.reset();
+      manifest.unsupported = true;
+    }
+  }
+}
+
+} /* namespace ADDON */
@@ -0,0 +1,195 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "addons/addoninfo/AddonInfo.h"
+#include "threads/IRunnable.h"
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ADDON
+{
+
+/*!
+ * @brief Appends values in the binary format of the manifest cache.
+ */
+class CManifestWriter
+{
+public:
+  void Write(uint32_t value);
+  void Write(uint64_t value);
+  void Write(const std::string& value);
+
+  const std::string& Data() const { return m_data; }
+
+private:
+  std::string m_data;
+};
+
+/*!
+ * @brief Reads values written by CManifestWriter.
+ *
+ * Reading beyond the end of the data or a length that doesn't fit into the
+ * remaining data marks the reader as failed and yields empty values, so
+ * truncated or corrupted files are detected once after reading a record.
+ */
+class CManifestReader
+{
+public:
+  CManifestReader(const char* data, size_t size) : m_pos(data), m_end(data + size) {}
+
+  uint32_t ReadUInt32();
+  uint64_t ReadUInt64();
+  std::string ReadString();
+
+  /*!
+   * @brief Read the number of elements of a container, every element takes
+   * at least minSize bytes.
+   */
+  uint32_t ReadCount(size_t minSize = 1);
+
+  bool Failed() const { return m_failed; }
+  bool AtEnd() const { return m_pos == m_end; }
+
+private:
+  bool Take(size_t size);
+
+  const char* m_pos;
+  const char* m_end;
+  bool m_failed = false;
+};
+
+/*!
+ * @brief Persistent cache of parsed addon.xml manifests.
+ *
+ * Entries are keyed by the add-on directory and stamped with modification time
+ * and size of its addon.xml. A manifest is parsed again only if its stamp
+ * changed. Manifests that aren't supported on this platform are cached as
+ * well, so they don't cost a parse on every start either. Manifests that
+ * failed to parse aren't cached, they may have been read while being written
+ * and are parsed again on every start until they load.
+ *
+ * The cache is bound to the build that wrote it, a different build discards it.
+ *
+ * The cache isn't thread safe, callers have to serialize access.
+ */
+class CAddonManifestCache
+{
+public:
+  struct Stamp
+  {
+    uint64_t mtime = 0;
+    uint64_t size = 0;
+
+    bool operator==(const Stamp& rhs) const { return mtime == rhs.mtime && size == rhs.size; }
+    bool operator!=(const Stamp& rhs) const { return !(*this == rhs); }
+  };
+
+  explicit CAddonManifestCache(std::string cacheFile);
+
+  /*!
+   * @brief Get the stamp of the addon.xml in an add-on directory.
+   * @return false if there is no addon.xml.
+   */
+  static bool GetStamp(const std::string& addonPath, Stamp& stamp);
+
+  /*!
+   * @brief Read the cache file, done once on first use.
+   */
+  void Load();
+
+  /*!
+   * @brief Write the cache file if anything changed. Entries that weren't used
+   * since the last Save() belong to add-ons that are gone and are dropped.
+   */
+  bool Save();
+
+  /*!
+   * @brief Look up the manifest of an add-on directory.
+   * @param[out] addon the cached manifest, nullptr if it isn't supported on this platform.
+   * @return false if there is no entry or it is outdated.
+   */
+  bool Get(const std::string& addonPath, const Stamp& stamp, AddonInfoPtr& addon);
+
+  /*!
+   * @brief Store a freshly parsed manifest, nullptr for manifests that aren't
+   * supported on this platform.
+   */
+  void Put(const std::string& addonPath, const Stamp& stamp, const AddonInfoPtr& addon);
+
+  /*!
+   * @brief Get the manifests of add-on directories, parsing and caching the ones
+   * that aren't cached or are outdated.
+   * @return the manifests supported on this platform, in the order of the directories.
+   */
+  std::vector<AddonInfoPtr> GetManifests(const std::vector<std::string>& addonPaths);
+
+  size_t Size() const { return m_entries.size(); }
+
+private:
+  struct Entry
+  {
+    Stamp stamp;
+    std::string data; // serialized CAddonInfo, empty for unsupported manifests
+    bool used = false;
+  };
+
+  bool Parse(const char* data, size_t size);
+
+  const std::string m_cacheFile;
+  std::unordered_map<std::string, Entry> m_entries;
+  bool m_loaded = false;
+  bool m_changed = false;
+};
+
+/*!
+ * @brief Parses the addon.xml files missing from the manifest cache, on the
+ * calling thread and additional worker threads if there are many of them.
+ */
+class CManifestParser : private IRunnable
+{
+public:
+  struct Manifest
+  {
+    std::string path;
+    CAddonManifestCache::Stamp stamp;
+    AddonInfoPtr addonInfo;
+    bool parse = false;
+    bool unsupported = false; // parsed, but not supported on this platform
+  };
+
+  /*!
+   * @brief Parse the manifests marked with parse.
+   */
+  explicit CManifestParser(std::vector<Manifest>& manifests);
+
+  size_t Size() const { return m_manifests.size(); }
+
+  /*!
+   * @brief Parse with as many workers as the number of manifests and CPUs make worthwhile.
+   */
+  void Parse();
+
+  /*!
+   * @brief Parse with the calling thread and the given number of worker threads.
+   */
+  void Parse(unsigned int workers);
+
+private:
+  void Run() override;
+
+  std::vector<Manifest*> m_manifests;
+  std::atomic<size_t> m_next{0};
+};
+
+} /* namespace ADDON */
@@ -7,6 +7,8 @@
  */
 
 #include "addons/addoninfo/AddonInfoBuilder.h"
+#include "addons/addoninfo/AddonManifestCache.h"
+#include "utils/XBMCTinyXML.h"
 
 #include <set>
 
@@ -172,3 +174,63 @@ TEST_F(TestAddonInfoBuilder, TestGenerate_DBEntry)
   ASSERT_NE(info, addon->ExtraInfo().end());
   EXPECT_EQ(info->second, "marsian");
 }
+
+TEST_F(TestAddonInfoBuilder, TestSerialize_RoundTrip)
+{
+  CXBMCTinyXML doc;
+  EXPECT_TRUE(doc.Parse(addonXML));
+  ASSERT_NE(nullptr, doc.RootElement());
+
+  CRepository::DirInfo repo;
+  AddonInfoPtr addon = CAddonInfoBuilder::Generate(doc.RootElement(), repo);
+  ASSERT_NE(nullptr, addon);
+
+  CManifestWriter writer;
+  CAddonInfoBuilder::Serialize(*addon, writer);
+  CManifestReader reader(writer.Data().data(), writer.Data().size());
+  AddonInfoPtr cached = CAddonInfoBuilder::Deserialize(reader);
+  ASSERT_NE(nullptr, cached);
+
+  EXPECT_EQ(cached->ID(), addon->ID());
+  EXPECT_EQ(cached->MainType(), addon->MainType());
+  EXPECT_EQ(cached->Types().size(), addon->Types().size());
+  EXPECT_EQ(cached->Type(ADDON_SCRAPER_MOVIES)->LibName(), "blablabla.xml");
+  EXPECT_EQ(cached->Type(ADDON_SCRAPER_MOVIES)->GetValue("@language").asString(), "en");
+  EXPECT_EQ(cached->Type(ADDON_SCRIPT_MODULE)->LibName(), "lib.so");
+  EXPECT_EQ(cached->Version(), addon->Version());
+  EXPECT_EQ(cached->Name(), addon->Name());
+  EXPECT_EQ(cached->Author(), addon->Author());
+  EXPECT_EQ(cached->Summary(), addon->Summary());
+  EXPECT_EQ(cached->Description(), addon->Description());
+  EXPECT_EQ(cached->Disclaimer(), addon->Disclaimer());
+  EXPECT_EQ(cached->License(), addon->License());
+  EXPECT_EQ(cached->Path(), addon->Path());
+  EXPECT_EQ(cached->Icon(), addon->Icon());
+  EXPECT_EQ(cached->Art(), addon->Art());
+  EXPECT_EQ(cached->GetDependencies(), addon->GetDependencies());
+  EXPECT_EQ(cached->ExtraInfo(), addon->ExtraInfo());
+}
+
+TEST_F(TestAddonInfoBuilder, TestSerialize_Truncated)
+{
+  CXBMCTinyXML doc;
+  EXPECT_TRUE(doc.Parse(addonXML));
+  ASSERT_NE(nullptr, doc.RootElement());
+
+  CRepository::DirInfo repo;
+  AddonInfoPtr addon = CAddonInfoBuilder::Generate(doc.RootElement(), repo);
+  ASSERT_NE(nullptr, addon);
+
+  CManifestWriter writer;
+  CAddonInfoBuilder::Serialize(*addon, writer);
+  const std::string& data = writer.Data();
+
+  CManifestReader complete(data.data(), data.size());
+  EXPECT_NE(nullptr, CAddonInfoBuilder::Deserialize(complete));
+
+  for (size_t size = 0; size < data.size(); size++)
+  {
+    CManifestReader reader(data.data(), size);
+    EXPECT_EQ(nullptr, CAddonInfoBuilder::Deserialize(reader)) << size;
+  }
+}
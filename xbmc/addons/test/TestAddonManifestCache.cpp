@@ -0,0 +1,301 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "addons/addoninfo/AddonInfoBuilder.h"
+#include "addons/addoninfo/AddonManifestCache.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+#include "utils/auto_buffer.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace ADDON;
+using namespace XFILE;
+
+namespace
+{
+const std::string ADDONS = "special://temp/manifestcache/";
+const std::string CACHE_FILE = "special://temp/manifestcache.test";
+const int PARSE_ADDONS = 64;
+
+enum class Manifest
+{
+  VALID,
+  UNSUPPORTED, // not supported on any platform
+  BROKEN // not even xml
+};
+
+bool WriteFile(const std::string& path, const std::string& data)
+{
+  CFile file;
+  if (!file.OpenForWrite(path, true))
+    return false;
+  const bool written = file.Write(data.data(), data.size()) == static_cast<ssize_t>(data.size());
+  file.Close();
+  return written;
+}
+
+std::string ReadFile(const std::string& path)
+{
+  CFile file;
+  XUTILS::auto_buffer buffer;
+  if (file.LoadFile(path, buffer) <= 0)
+    return "";
+  return std::string(buffer.get(), buffer.size());
+}
+
+std::string GetAddonPath(int i)
+{
+  return URIUtils::AddFileToFolder(ADDONS, StringUtils::Format("script.test.%i", i));
+}
+
+// write the addon.xml of an add-on, returns the add-on directory
+std::string WriteAddon(int i, Manifest manifest = Manifest::VALID, const std::string& version = "1.0.0")
+{
+  const std::string path = GetAddonPath(i);
+  std::string xml;
+  if (manifest == Manifest::BROKEN)
+    xml = "<addon id=\"broken\"";
+  else
+    xml = StringUtils::Format("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                              "<addon id=\"script.test.%i\" name=\"Test %i\" version=\"%s\" provider-name=\"Team Kodi\">\n"
+                              "  <extension point=\"xbmc.python.script\" library=\"default.py\"/>\n"
+                              "  <extension point=\"kodi.addon.metadata\">\n"
+                              "    <summary lang=\"en_GB\">Summary of test %i</summary>\n"
+                              "    <platform>%s</platform>\n"
+                              "  </extension>\n"
+                              "</addon>\n",
+                              i, i, version.c_str(), i, manifest == Manifest::UNSUPPORTED ? "nowhere" : "all");
+
+  if (!CDirectory::Create(path) || !WriteFile(URIUtils::AddFileToFolder(path, "addon.xml"), xml))
+    return "";
+  return path;
+}
+
+std::vector<CManifestParser::Manifest> GetManifestsToParse()
+{
+  std::vector<CManifestParser::Manifest> manifests;
+  for (int i = 0; i < PARSE_ADDONS; i++)
+  {
+    CManifestParser::Manifest manifest;
+    manifest.path = GetAddonPath(i);
+    manifest.parse = i % 10 != 9; // not all of them have to be parsed
+    manifests.emplace_back(manifest);
+  }
+  return manifests;
+}
+} // unnamed namespace
+
+class TestAddonManifestCache : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    CDirectory::RemoveRecursive(ADDONS);
+    CFile::Delete(CACHE_FILE);
+    ASSERT_TRUE(CDirectory::Create(ADDONS));
+  }
+
+  void TearDown() override
+  {
+    CDirectory::RemoveRecursive(ADDONS);
+    CFile::Delete(CACHE_FILE);
+  }
+
+  // stamp the manifest of an add-on and cache what was parsed of it
+  CAddonManifestCache::Stamp Put(CAddonManifestCache& cache, const std::string& path)
+  {
+    CAddonManifestCache::Stamp stamp;
+    EXPECT_TRUE(CAddonManifestCache::GetStamp(path, stamp));
+    cache.Put(path, stamp, CAddonInfoBuilder::Generate(path));
+    return stamp;
+  }
+};
+
+TEST_F(TestAddonManifestCache, SaveAndLoad)
+{
+  const std::string first = WriteAddon(1);
+  const std::string second = WriteAddon(2, Manifest::VALID, "2.3.4");
+  const std::string unsupported = WriteAddon(3, Manifest::UNSUPPORTED);
+  ASSERT_FALSE(first.empty());
+  ASSERT_FALSE(second.empty());
+  ASSERT_FALSE(unsupported.empty());
+
+  CAddonManifestCache::Stamp firstStamp, secondStamp, unsupportedStamp;
+  {
+    CAddonManifestCache cache(CACHE_FILE);
+    cache.Load();
+    EXPECT_EQ(0u, cache.Size());
+    firstStamp = Put(cache, first);
+    secondStamp = Put(cache, second);
+    unsupportedStamp = Put(cache, unsupported);
+    ASSERT_TRUE(cache.Save());
+  }
+  ASSERT_TRUE(CFile::Exists(CACHE_FILE));
+
+  CAddonManifestCache cache(CACHE_FILE);
+  cache.Load();
+  EXPECT_EQ(3u, cache.Size());
+
+  AddonInfoPtr addon;
+  ASSERT_TRUE(cache.Get(second, secondStamp, addon));
+  ASSERT_NE(nullptr, addon);
+  EXPECT_EQ("script.test.2", addon->ID());
+  EXPECT_EQ("Test 2", addon->Name());
+  EXPECT_EQ("2.3.4", addon->Version().asString());
+  EXPECT_EQ("Summary of test 2", addon->Summary());
+  EXPECT_EQ(ADDON_SCRIPT, addon->MainType());
+
+  // unsupported manifests are cached as well
+  ASSERT_TRUE(cache.Get(unsupported, unsupportedStamp, addon));
+  EXPECT_EQ(nullptr, addon);
+
+  EXPECT_FALSE(cache.Get(GetAddonPath(4), firstStamp, addon));
+
+  // entries that weren't used are gone after the next save
+  ASSERT_TRUE(cache.Save());
+  CAddonManifestCache saved(CACHE_FILE);
+  saved.Load();
+  EXPECT_EQ(2u, saved.Size());
+  EXPECT_FALSE(saved.Get(first, firstStamp, addon));
+  EXPECT_TRUE(saved.Get(second, secondStamp, addon));
+}
+
+TEST_F(TestAddonManifestCache, DamagedCacheIsDiscarded)
+{
+  const std::string path = WriteAddon(1);
+  CAddonManifestCache::Stamp stamp;
+  {
+    CAddonManifestCache cache(CACHE_FILE);
+    cache.Load();
+    stamp = Put(cache, path);
+    ASSERT_TRUE(cache.Save());
+  }
+
+  const std::string data = ReadFile(CACHE_FILE);
+  ASSERT_FALSE(data.empty());
+  for (const std::string& damaged : {data.substr(0, data.size() - 1), data + "x", "KAMC" + data.substr(4)})
+  {
+    ASSERT_TRUE(WriteFile(CACHE_FILE, damaged));
+    CAddonManifestCache cache(CACHE_FILE);
+    cache.Load();
+    EXPECT_EQ(0u, cache.Size());
+
+    AddonInfoPtr addon;
+    EXPECT_FALSE(cache.Get(path, stamp, addon));
+  }
+}
+
+TEST_F(TestAddonManifestCache, ChangedManifestIsParsedAgain)
+{
+  const std::string path = WriteAddon(1);
+  CAddonManifestCache cache(CACHE_FILE);
+  cache.Load();
+  const CAddonManifestCache::Stamp stamp = Put(cache, path);
+
+  AddonInfoPtr addon;
+  ASSERT_TRUE(cache.Get(path, stamp, addon));
+
+  // the size of the manifest changes with the version
+  ASSERT_FALSE(WriteAddon(1, Manifest::VALID, "1.0.10").empty());
+  CAddonManifestCache::Stamp changed;
+  ASSERT_TRUE(CAddonManifestCache::GetStamp(path, changed));
+  EXPECT_NE(stamp, changed);
+  EXPECT_FALSE(cache.Get(path, changed, addon));
+
+  std::vector<AddonInfoPtr> addons = cache.GetManifests({path});
+  ASSERT_EQ(1u, addons.size());
+  EXPECT_EQ("1.0.10", addons[0]->Version().asString());
+  ASSERT_TRUE(cache.Get(path, changed, addon));
+  EXPECT_EQ("1.0.10", addon->Version().asString());
+
+  // a directory without a manifest has no stamp and isn't an add-on
+  ASSERT_TRUE(CDirectory::Create(GetAddonPath(2)));
+  EXPECT_FALSE(CAddonManifestCache::GetStamp(GetAddonPath(2), changed));
+  EXPECT_EQ(1u, cache.GetManifests({GetAddonPath(2), path}).size());
+}
+
+TEST_F(TestAddonManifestCache, BrokenManifestIsParsedAgain)
+{
+  const std::string valid = WriteAddon(1);
+  const std::string unsupported = WriteAddon(2, Manifest::UNSUPPORTED);
+  const std::string broken = WriteAddon(3, Manifest::BROKEN);
+
+  CAddonManifestCache cache(CACHE_FILE);
+  cache.Load();
+  std::vector<AddonInfoPtr> addons = cache.GetManifests({valid, unsupported, broken});
+  ASSERT_EQ(1u, addons.size());
+  EXPECT_EQ("script.test.1", addons[0]->ID());
+
+  // the unsupported manifest is cached, the broken one isn't
+  CAddonManifestCache::Stamp stamp;
+  AddonInfoPtr addon;
+  ASSERT_TRUE(CAddonManifestCache::GetStamp(unsupported, stamp));
+  EXPECT_TRUE(cache.Get(unsupported, stamp, addon));
+  EXPECT_EQ(nullptr, addon);
+  ASSERT_TRUE(CAddonManifestCache::GetStamp(broken, stamp));
+  EXPECT_FALSE(cache.Get(broken, stamp, addon));
+  EXPECT_EQ(2u, cache.Size());
+
+  ASSERT_TRUE(cache.Save());
+  CAddonManifestCache saved(CACHE_FILE);
+  saved.Load();
+  EXPECT_EQ(2u, saved.Size());
+}
+
+TEST_F(TestAddonManifestCache, ParallelParseMatchesSerialParse)
+{
+  for (int i = 0; i < PARSE_ADDONS; i++)
+  {
+    const Manifest manifest = i % 8 == 3 ? Manifest::BROKEN : i % 8 == 5 ? Manifest::UNSUPPORTED : Manifest::VALID;
+    ASSERT_FALSE(WriteAddon(i, manifest, StringUtils::Format("1.0.%i", i)).empty());
+  }
+
+  std::vector<CManifestParser::Manifest> serial = GetManifestsToParse();
+  CManifestParser serialParser(serial);
+  serialParser.Parse(0);
+
+  std::vector<CManifestParser::Manifest> parallel = GetManifestsToParse();
+  CManifestParser parallelParser(parallel);
+  EXPECT_EQ(serialParser.Size(), parallelParser.Size());
+  parallelParser.Parse(4);
+
+  int parsed = 0;
+  for (int i = 0; i < PARSE_ADDONS; i++)
+  {
+    const CManifestParser::Manifest& expected = serial[i];
+    const CManifestParser::Manifest& manifest = parallel[i];
+    EXPECT_EQ(expected.unsupported, manifest.unsupported) << manifest.path;
+    ASSERT_EQ(expected.addonInfo == nullptr, manifest.addonInfo == nullptr) << manifest.path;
+
+    if (!expected.parse)
+    {
+      EXPECT_EQ(nullptr, manifest.addonInfo);
+      continue;
+    }
+    EXPECT_EQ(i % 8 == 5, manifest.unsupported) << manifest.path;
+    EXPECT_EQ(i % 8 == 3 || i % 8 == 5, manifest.addonInfo == nullptr) << manifest.path;
+    if (!manifest.addonInfo)
+      continue;
+
+    parsed++;
+    EXPECT_EQ(expected.addonInfo->ID(), manifest.addonInfo->ID());
+    EXPECT_EQ(StringUtils::Format("script.test.%i", i), manifest.addonInfo->ID());
+    EXPECT_EQ(expected.addonInfo->Version(), manifest.addonInfo->Version());
+    EXPECT_EQ(expected.addonInfo->Name(), manifest.addonInfo->Name());
+    EXPECT_EQ(expected.addonInfo->Summary(), manifest.addonInfo->Summary());
+    EXPECT_EQ(expected.addonInfo->Path(), manifest.addonInfo->Path());
+    EXPECT_EQ(expected.addonInfo->MainType(), manifest.addonInfo->MainType());
+  }
+  EXPECT_GT(parsed, PARSE_ADDONS / 2);
+}
@@ -187,6 +187,44 @@ float CDataCacheCore::GetVideoDAR()
   return m_playerVideoInfo.dar;
 }
 
+void CDataCacheCore::SetVideoBufferStats(uint64_t allocatedBytes, uint64_t usedBytes, uint64_t allocations, uint64_t reuses)
+{
+  CSingleLock lock(m_videoPlayerSection);
+
+  m_playerVideoInfo.bufferAllocatedBytes = allocatedBytes;
+  m_playerVideoInfo.bufferUsedBytes = usedBytes;
+  m_playerVideoInfo.bufferAllocations = allocations;
+  m_playerVideoInfo.bufferReuses = reuses;
+}
+
+uint64_t CDataCacheCore::GetVideoBufferAllocatedBytes()
+{
+  CSingleLock lock(m_videoPlayerSection);
+
+  return m_playerVideoInfo.bufferAllocatedBytes;
+}
+
+uint64_t CDataCacheCore::GetVideoBufferUsedBytes()
+{
+  CSingleLock lock(m_videoPlayerSection);
+
+  return m_playerVideoInfo.bufferUsedBytes;
+}
+
+uint64_t CDataCacheCore::GetVideoBufferAllocations()
+{
+  CSingleLock lock(m_videoPlayerSection);
+
+  return m_playerVideoInfo.bufferAllocations;
+}
+
+uint64_t CDataCacheCore::GetVideoBufferReuses()
+{
+  CSingleLock lock(m_videoPlayerSection);
+
+  return m_playerVideoInfo.bufferReuses;
+}
+
 // player audio info
 void CDataCacheCore::SetAudioDecoderName(std::string name)
 {
@@ -48,6 +48,11 @@ public:
   float GetVideoFps();
   void SetVideoDAR(float dar);
   float GetVideoDAR();
+  void SetVideoBufferStats(uint64_t allocatedBytes, uint64_t usedBytes, uint64_t allocations, uint64_t reuses);
+  uint64_t GetVideoBufferAllocatedBytes();
+  uint64_t GetVideoBufferUsedBytes();
+  uint64_t GetVideoBufferAllocations();
+  uint64_t GetVideoBufferReuses();
 
   // player audio info
   void SetAudioDecoderName(std::string name);
@@ -141,6 +146,10 @@ protected:
     int height;
     float fps;
     float dar;
+    uint64_t bufferAllocatedBytes;
+    uint64_t bufferUsedBytes;
+    uint64_t bufferAllocations;
+    uint64_t bufferReuses;
   } m_playerVideoInfo;
 
   CCriticalSection m_audioPlayerSection;
@@ -11,7 +11,7 @@
 #include "ServiceBroker.h"
 #include "cores/RetroPlayer/savestates/ISavestate.h"
 #include "cores/RetroPlayer/savestates/SavestateDatabase.h"
-#include "cores/RetroPlayer/streams/memory/DeltaPairMemoryStream.h"
+#include "cores/RetroPlayer/streams/memory/CompressedMemoryStream.h"
 #include "games/GameServices.h"
 #include "games/GameSettings.h"
 #include "games/addons/GameClient.h"
@@ -301,7 +301,7 @@ void CReversiblePlayback::UpdateMemoryStream()
 
     if (!m_memoryStream)
     {
-      m_memoryStream.reset(new CDeltaPairMemoryStream);
+      m_memoryStream.reset(new CCompressedMemoryStream);
       m_memoryStream->Init(m_gameClient->SerializeSize(), frameCount);
     }
 
@@ -0,0 +1,304 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "CompressedMemoryStream.h"
+
+#include "utils/log.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+
+#include <lzo/lzo1x.h>
+
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace KODI;
+using namespace RETRO;
+
+// Pad forward to nearest boundary of bytes
+#define PAD_TO_CEIL(x, bytes)  ((((x) + (bytes) - 1) / (bytes)) * (bytes))
+
+namespace
+{
+  // Runs are split at this many unchanged words, XORing a shorter gap is
+  // cheaper than the two words needed to start a new run
+  const size_t MIN_RUN_GAP = 3;
+
+  // Return the index of the first word from i on that differs
+  size_t FindChange(const uint32_t* a, const uint32_t* b, size_t i, size_t words)
+  {
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+    for (; i + 4 <= words; i += 4)
+    {
+      const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+      const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi32(va, vb)) != 0xFFFF)
+        break;
+    }
+#else
+    for (; i + 2 <= words; i += 2)
+    {
+      uint64_t va;
+      uint64_t vb;
+      std::memcpy(&va, a + i, sizeof(va));
+      std::memcpy(&vb, b + i, sizeof(vb));
+      if (va != vb)
+        break;
+    }
+#endif
+    while (i < words && a[i] == b[i])
+      i++;
+    return i;
+  }
+
+  // out[i] = a[i] ^ b[i], out may be a
+  void XorWords(const uint32_t* a, const uint32_t* b, uint32_t* out, size_t words)
+  {
+    size_t i = 0;
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+    for (; i + 4 <= words; i += 4)
+    {
+      const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+      const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_xor_si128(va, vb));
+    }
+#endif
+    for (; i < words; i++)
+      out[i] = a[i] ^ b[i];
+  }
+}
+
+const size_t CCompressedMemoryStream::DEFAULT_MAX_ARENA_SIZE;
+
+CCompressedMemoryStream::CCompressedMemoryStream(size_t maxArenaSize /* = DEFAULT_MAX_ARENA_SIZE */) :
+  m_maxArenaSize(maxArenaSize)
+{
+  lzo_init();
+}
+
+void CCompressedMemoryStream::Init(size_t frameSize, uint64_t maxFrameCount)
+{
+  CLinearMemoryStream::Init(frameSize, maxFrameCount);
+
+  // Worst case is a run of one word every MIN_RUN_GAP + 1 words
+  const size_t words = m_paddedFrameSize / sizeof(uint32_t);
+  m_delta.resize(words + 2 * (words / (MIN_RUN_GAP + 1) + 1));
+
+  const size_t deltaSize = m_delta.size() * sizeof(uint32_t);
+  m_compressed.resize(deltaSize + deltaSize / 16 + 64 + 3);
+
+  // Room for the deltas of maxFrameCount frames if they don't compress,
+  // small states with a short history don't need the max arena size
+  const size_t frameReservedSize = PAD_TO_CEIL(m_paddedFrameSize + 1, sizeof(uint64_t));
+  const uint64_t frameCount = std::max<uint64_t>(maxFrameCount, 1);
+  if (frameCount > m_maxArenaSize / frameReservedSize)
+    m_arenaSize = m_maxArenaSize;
+  else
+    m_arenaSize = static_cast<size_t>(frameCount) * frameReservedSize;
+
+  m_arena.reset(new uint8_t[m_arenaSize]);
+  m_workMemory.reset(new uint8_t[LZO1X_1_MEM_COMPRESS]);
+}
+
+void CCompressedMemoryStream::Reset()
+{
+  CLinearMemoryStream::Reset();
+
+  m_rewindBuffer.clear();
+  m_arena.reset();
+  m_arenaSize = 0;
+  m_delta.clear();
+  m_compressed.clear();
+  m_workMemory.reset();
+}
+
+void CCompressedMemoryStream::SubmitFrameInternal()
+{
+  const size_t deltaSize = EncodeDelta() * sizeof(uint32_t);
+  const uint8_t* delta = reinterpret_cast<const uint8_t*>(m_delta.data());
+
+  MemoryFrame frame;
+  frame.deltaSize = deltaSize;
+  frame.frameHistoryCount = m_currentFrameHistory++;
+
+  // Store the delta as is if it doesn't compress
+  lzo_uint compressedSize = m_compressed.size();
+  frame.bCompressed = deltaSize > 0 &&
+                      lzo1x_1_compress(delta, deltaSize, m_compressed.data(), &compressedSize, m_workMemory.get()) == LZO_E_OK &&
+                      compressedSize < deltaSize;
+  frame.size = frame.bCompressed ? compressedSize : deltaSize;
+  frame.reservedSize = PAD_TO_CEIL(frame.size + 1, sizeof(uint64_t));
+
+  if (Allocate(frame.reservedSize, frame.offset))
+  {
+    if (frame.size > 0)
+      std::memcpy(m_arena.get() + frame.offset, frame.bCompressed ? m_compressed.data() : delta, frame.size);
+    m_rewindBuffer.push_back(frame);
+  }
+
+  // Delta is generated, bring the new frame forward (m_nextFrame is now disposable)
+  std::swap(m_currentFrame, m_nextFrame);
+
+  m_bHasNextFrame = false;
+
+  if (PastFramesAvailable() + 1 > MaxFrameCount())
+    CullPastFrames(1);
+}
+
+size_t CCompressedMemoryStream::EncodeDelta()
+{
+  const size_t words = m_paddedFrameSize / sizeof(uint32_t);
+  const uint32_t* currentFrame = m_currentFrame.get();
+  const uint32_t* nextFrame = m_nextFrame.get();
+  uint32_t* delta = m_delta.data();
+
+  size_t deltaWords = 0;
+  size_t runEnd = 0;
+  size_t i = FindChange(currentFrame, nextFrame, 0, words);
+  while (i < words)
+  {
+    // Extend the run until MIN_RUN_GAP unchanged words
+    size_t end = i + 1;
+    size_t gap = 0;
+    for (; end < words && gap < MIN_RUN_GAP; end++)
+      gap = currentFrame[end] == nextFrame[end] ? gap + 1 : 0;
+    end -= gap;
+
+    delta[deltaWords++] = static_cast<uint32_t>(i - runEnd);
+    delta[deltaWords++] = static_cast<uint32_t>(end - i);
+    XorWords(currentFrame + i, nextFrame + i, delta + deltaWords, end - i);
+    deltaWords += end - i;
+
+    runEnd = end;
+    i = FindChange(currentFrame, nextFrame, end, words);
+  }
+
+  return deltaWords;
+}
+
+void CCompressedMemoryStream::ApplyDelta(const uint32_t* delta, size_t deltaWords)
+{
+  uint32_t* currentFrame = m_currentFrame.get();
+  const size_t words = m_paddedFrameSize / sizeof(uint32_t);
+
+  size_t pos = 0;
+  for (size_t i = 0; i + 2 <= deltaWords;)
+  {
+    pos += delta[i++];
+    const size_t runWords = delta[i++];
+    if (pos + runWords > words || i + runWords > deltaWords)
+      break;
+
+    XorWords(currentFrame + pos, delta + i, currentFrame + pos, runWords);
+    pos += runWords;
+    i += runWords;
+  }
+}
+
+bool CCompressedMemoryStream::Allocate(size_t size, size_t& offset)
+{
+  if (size > m_arenaSize)
+  {
+    CLog::Log(LOGDEBUG, "CCompressedMemoryStream: Frame delta of %u bytes exceeds the arena, dropping history", static_cast<unsigned int>(size));
+    m_rewindBuffer.clear();
+    return false;
+  }
+
+  // Frames are laid out in the order they are submitted, so the oldest
+  // frames follow the newest one
+  offset = 0;
+  if (!m_rewindBuffer.empty())
+  {
+    const MemoryFrame& newest = m_rewindBuffer.back();
+    offset = newest.offset + newest.reservedSize;
+    if (offset + size > m_arenaSize)
+    {
+      // Wrap around, the frames past the newest one are the oldest
+      while (!m_rewindBuffer.empty() && m_rewindBuffer.front().offset >= offset)
+        m_rewindBuffer.pop_front();
+      offset = 0;
+    }
+  }
+
+  while (!m_rewindBuffer.empty())
+  {
+    const MemoryFrame& oldest = m_rewindBuffer.front();
+    if (oldest.offset >= offset + size || oldest.offset + oldest.reservedSize <= offset)
+      break;
+    m_rewindBuffer.pop_front();
+  }
+
+  return true;
+}
+
+uint64_t CCompressedMemoryStream::PastFramesAvailable() const
+{
+  return static_cast<uint64_t>(m_rewindBuffer.size());
+}
+
+uint64_t CCompressedMemoryStream::RewindFrames(uint64_t frameCount)
+{
+  uint64_t rewound;
+
+  for (rewound = 0; rewound < frameCount; rewound++)
+  {
+    if (m_rewindBuffer.empty())
+      break;
+
+    const MemoryFrame& frame = m_rewindBuffer.back();
+    const uint8_t* delta = m_arena.get() + frame.offset;
+
+    if (frame.bCompressed)
+    {
+      uint8_t* buffer = reinterpret_cast<uint8_t*>(m_delta.data());
+      lzo_uint deltaSize = m_delta.size() * sizeof(uint32_t);
+      if (lzo1x_decompress_safe(delta, frame.size, buffer, &deltaSize, nullptr) != LZO_E_OK ||
+          deltaSize != frame.deltaSize)
+      {
+        CLog::Log(LOGERROR, "CCompressedMemoryStream: Failed to decompress frame delta");
+        m_rewindBuffer.clear();
+        break;
+      }
+      delta = buffer;
+    }
+
+    // The arena keeps uncompressed deltas aligned for 32 bit access
+    ApplyDelta(reinterpret_cast<const uint32_t*>(delta), frame.deltaSize / sizeof(uint32_t));
+
+    // Restore frame history
+    m_currentFrameHistory = frame.frameHistoryCount;
+
+    m_rewindBuffer.pop_back();
+  }
+
+  return rewound;
+}
+
+void CCompressedMemoryStream::CullPastFrames(uint64_t frameCount)
+{
+  for (uint64_t removedCount = 0; removedCount < frameCount; removedCount++)
+  {
+    if (m_rewindBuffer.empty())
+    {
+      CLog::Log(LOGDEBUG, "CCompressedMemoryStream: Tried to cull %" PRIu64 " frames too many. Check your math!", frameCount - removedCount);
+      break;
+    }
+    m_rewindBuffer.pop_front();
+  }
+}
+
+size_t CCompressedMemoryStream::ArenaUsed() const
+{
+  size_t used = 0;
+  for (const auto& frame : m_rewindBuffer)
+    used += frame.reservedSize;
+  return used;
+}
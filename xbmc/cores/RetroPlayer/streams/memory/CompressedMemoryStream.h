@@ -0,0 +1,91 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "LinearMemoryStream.h"
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace KODI
+{
+namespace RETRO
+{
+  /*!
+   * \brief Implementation of a linear memory stream using compressed XOR deltas
+   *
+   * Like CDeltaPairMemoryStream, rewinding applies the XOR deltas of the parts
+   * of the save state which have changed. Here a delta is encoded as runs of
+   * changed words, and compressed with LZO into an arena which is allocated
+   * once by Init(). The arena holds max frame count deltas as large as a
+   * frame, up to the max arena size. When the arena is full, the oldest
+   * frames are dropped, so the rewind window is limited by the arena size as
+   * well as the max frame count.
+   */
+  class CCompressedMemoryStream : public CLinearMemoryStream
+  {
+  public:
+    static const size_t DEFAULT_MAX_ARENA_SIZE = 64 * 1024 * 1024;
+
+    explicit CCompressedMemoryStream(size_t maxArenaSize = DEFAULT_MAX_ARENA_SIZE);
+
+    ~CCompressedMemoryStream() override = default;
+
+    // implementation of IMemoryStream via CLinearMemoryStream
+    void Init(size_t frameSize, uint64_t maxFrameCount) override;
+    void Reset() override;
+    uint64_t PastFramesAvailable() const override;
+    uint64_t RewindFrames(uint64_t frameCount) override;
+
+    /*!
+     * \brief Return the number of arena bytes held by past frames
+     */
+    size_t ArenaUsed() const;
+
+    /*!
+     * \brief Return the size of the arena allocated by Init()
+     */
+    size_t ArenaSize() const { return m_arenaSize; }
+
+  protected:
+    // implementation of CLinearMemoryStream
+    void SubmitFrameInternal() override;
+    void CullPastFrames(uint64_t frameCount) override;
+
+  private:
+    /*!
+     * A delta is a sequence of runs, each made of the number of unchanged
+     * words since the previous run, the number of changed words and the XOR
+     * of these words.
+     */
+    struct MemoryFrame
+    {
+      size_t offset; // in the arena
+      size_t size; // stored size
+      size_t reservedSize; // arena bytes taken, padded for alignment
+      size_t deltaSize; // uncompressed size
+      bool bCompressed;
+      uint64_t frameHistoryCount;
+    };
+
+    size_t EncodeDelta();
+    void ApplyDelta(const uint32_t* delta, size_t deltaWords);
+    bool Allocate(size_t size, size_t& offset);
+
+    const size_t m_maxArenaSize;
+    size_t m_arenaSize = 0;
+    std::unique_ptr<uint8_t[]> m_arena;
+    std::deque<MemoryFrame> m_rewindBuffer;
+    std::vector<uint32_t> m_delta; // uncompressed delta of a frame
+    std::vector<uint8_t> m_compressed; // compressed delta of a frame
+    std::unique_ptr<uint8_t[]> m_workMemory; // for the compressor
+  };
+}
+}
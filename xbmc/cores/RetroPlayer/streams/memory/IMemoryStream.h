@@ -32,7 +32,8 @@ namespace RETRO
    *   - Linear memory stream: can grow in one direction. It is possible to
    *         rewind, but not fast-forward.
    *
-   *         \sa CLinearMemoryStream
+   *         \sa CLinearMemoryStream, CDeltaPairMemoryStream,
+   *             CCompressedMemoryStream
    *
    *   - Nonlinear memory stream: can have frames both ahead of and behind
    *         the current frame. If a stream is rewound, it is possible to
@@ -0,0 +1,197 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/RetroPlayer/streams/memory/CompressedMemoryStream.h"
+#include "cores/RetroPlayer/streams/memory/DeltaPairMemoryStream.h"
+#include "test/TestUtils.h"
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace KODI;
+using namespace RETRO;
+
+namespace
+{
+// A game client's state, changed a little from frame to frame
+class CSavestateTrace
+{
+public:
+  /*!
+   * \param frameSize The size of the state
+   * \param changesPerFrame The number of bytes changed per frame
+   * \param clusterSize The number of bytes in a row a change touches
+   */
+  CSavestateTrace(size_t frameSize, unsigned int changesPerFrame, size_t clusterSize) :
+    m_state(frameSize),
+    m_changesPerFrame(changesPerFrame),
+    m_clusterSize(clusterSize)
+  {
+    for (auto& byte : m_state)
+      byte = static_cast<uint8_t>(m_random());
+  }
+
+  const std::vector<uint8_t>& NextFrame()
+  {
+    // Work RAM changes in a few hot areas, like the stack and sprite tables
+    std::uniform_int_distribution<size_t> hotArea(0, 15);
+    for (unsigned int i = 0; i < m_changesPerFrame; i += m_clusterSize)
+    {
+      const size_t pos = (hotArea(m_random) * m_state.size() / 16 + m_random() % 4096) % m_state.size();
+      for (size_t j = pos; j < pos + m_clusterSize && j < m_state.size(); j++)
+        m_state[j] += static_cast<uint8_t>(m_random() | 1);
+    }
+    return m_state;
+  }
+
+private:
+  std::vector<uint8_t> m_state;
+  const unsigned int m_changesPerFrame;
+  const size_t m_clusterSize;
+  std::mt19937 m_random{1};
+};
+
+void SubmitFrame(IMemoryStream& stream, const std::vector<uint8_t>& state)
+{
+  std::memcpy(stream.BeginFrame(), state.data(), state.size());
+  stream.SubmitFrame();
+}
+} // unnamed namespace
+
+TEST(TestCompressedMemoryStream, Rewind)
+{
+  const size_t frameSize = 64 * 1024 + 3;
+  CSavestateTrace trace(frameSize, 256, 8);
+
+  CCompressedMemoryStream stream;
+  stream.Init(frameSize, 100);
+
+  std::vector<std::vector<uint8_t>> states;
+  for (unsigned int i = 0; i < 150; i++)
+  {
+    states.push_back(trace.NextFrame());
+    SubmitFrame(stream, states.back());
+  }
+  ASSERT_EQ(99u, stream.PastFramesAvailable());
+  EXPECT_EQ(0, std::memcmp(states.back().data(), stream.CurrentFrame(), frameSize));
+
+  EXPECT_EQ(10u, stream.RewindFrames(10));
+  EXPECT_EQ(0, std::memcmp(states[139].data(), stream.CurrentFrame(), frameSize));
+  EXPECT_EQ(139u, stream.GetFrameCounter());
+
+  EXPECT_EQ(89u, stream.RewindFrames(100));
+  EXPECT_EQ(0, std::memcmp(states[50].data(), stream.CurrentFrame(), frameSize));
+  EXPECT_EQ(0u, stream.PastFramesAvailable());
+
+  // Unchanged frames can be rewound too
+  SubmitFrame(stream, states[50]);
+  SubmitFrame(stream, states[51]);
+  EXPECT_EQ(2u, stream.RewindFrames(2));
+  EXPECT_EQ(0, std::memcmp(states[50].data(), stream.CurrentFrame(), frameSize));
+}
+
+TEST(TestCompressedMemoryStream, ArenaFull)
+{
+  const size_t frameSize = 16 * 1024;
+  CSavestateTrace trace(frameSize, 512, 16);
+
+  // Room for a few dozen frames only
+  CCompressedMemoryStream stream(32 * 1024);
+  stream.Init(frameSize, 1000);
+
+  std::vector<std::vector<uint8_t>> states;
+  for (unsigned int i = 0; i < 500; i++)
+  {
+    states.push_back(trace.NextFrame());
+    SubmitFrame(stream, states.back());
+    ASSERT_LE(stream.ArenaUsed(), 32u * 1024);
+  }
+
+  // The oldest frames are dropped, the remaining ones rewind correctly
+  const uint64_t pastFrames = stream.PastFramesAvailable();
+  EXPECT_GT(pastFrames, 0u);
+  EXPECT_LT(pastFrames, 499u);
+  EXPECT_EQ(pastFrames, stream.RewindFrames(pastFrames));
+  EXPECT_EQ(0, std::memcmp(states[states.size() - 1 - pastFrames].data(), stream.CurrentFrame(), frameSize));
+}
+
+TEST(TestCompressedMemoryStream, ArenaSize)
+{
+  // A frame delta as large as the state, padded to 64 bit, for each frame
+  CCompressedMemoryStream stream;
+  stream.Init(16 * 1024, 100);
+  EXPECT_EQ(100u * (16 * 1024 + 8), stream.ArenaSize());
+
+  stream.Reset();
+  EXPECT_EQ(0u, stream.ArenaSize());
+
+  // Long histories of large states are capped
+  stream.Init(4 * 1024 * 1024, 60 * 60);
+  EXPECT_EQ(CCompressedMemoryStream::DEFAULT_MAX_ARENA_SIZE, stream.ArenaSize());
+
+  CCompressedMemoryStream smallStream(1024 * 1024);
+  smallStream.Init(16 * 1024, 100);
+  EXPECT_EQ(1024u * 1024, smallStream.ArenaSize());
+}
+
+TEST(TestCompressedMemoryStream, Benchmark)
+{
+  // 1-4 MB states of cores for later consoles, changing sparsely or in bulk
+  struct Trace
+  {
+    std::string name;
+    size_t frameSize;
+    unsigned int changesPerFrame;
+    size_t clusterSize;
+  };
+  const std::vector<Trace> traces = {
+    {"sparse_1mb", 1024 * 1024, 2000, 4},
+    {"clustered_2mb", 2 * 1024 * 1024, 32 * 1024, 256},
+    {"bulk_4mb", 4 * 1024 * 1024, 256 * 1024, 4096},
+  };
+  const unsigned int frames = 120;
+
+  for (const auto& trace : traces)
+  {
+    CSavestateTrace deltaPairTrace(trace.frameSize, trace.changesPerFrame, trace.clusterSize);
+    CDeltaPairMemoryStream deltaPairStream;
+    deltaPairStream.Init(trace.frameSize, frames + 1);
+    CTestStopwatch stopwatch;
+    for (unsigned int i = 0; i < frames; i++)
+      SubmitFrame(deltaPairStream, deltaPairTrace.NextFrame());
+    const int64_t deltaPairTime = stopwatch.Lap();
+
+    CSavestateTrace compressedTrace(trace.frameSize, trace.changesPerFrame, trace.clusterSize);
+    CCompressedMemoryStream compressedStream(256 * 1024 * 1024);
+    compressedStream.Init(trace.frameSize, frames + 1);
+    stopwatch.Lap();
+    for (unsigned int i = 0; i < frames; i++)
+      SubmitFrame(compressedStream, compressedTrace.NextFrame());
+    const int64_t compressedTime = stopwatch.Lap();
+    ASSERT_EQ(frames - 1, compressedStream.PastFramesAvailable());
+    const size_t compressedSize = compressedStream.ArenaUsed();
+
+    stopwatch.Lap();
+    EXPECT_EQ(frames - 1, compressedStream.RewindFrames(frames - 1));
+    const int64_t rewindTime = stopwatch.Lap();
+
+    // The time to generate the trace is the same for both streams
+    RecordProperty(trace.name + "_deltapair_ns_per_frame",
+                   static_cast<int>(deltaPairTime * 1000 / frames));
+    RecordProperty(trace.name + "_compressed_ns_per_frame",
+                   static_cast<int>(compressedTime * 1000 / frames));
+    RecordProperty(trace.name + "_compressed_rewind_ns_per_frame",
+                   static_cast<int>(rewindTime * 1000 / (frames - 1)));
+    RecordProperty(trace.name + "_compressed_bytes_per_frame",
+                   static_cast<int>(compressedSize / (frames - 1)));
+  }
+}
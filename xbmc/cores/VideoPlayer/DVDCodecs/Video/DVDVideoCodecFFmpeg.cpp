@@ -20,6 +20,7 @@
 #include "cores/VideoSettings.h"
 #include "utils/log.h"
 #include "cores/VideoPlayer/VideoRenderers/RenderManager.h"
+#include "cores/VideoPlayer/Process/VideoBuffer.h"
 #include "utils/StringUtils.h"
 #include <memory>
 
@@ -30,6 +31,7 @@ extern "C" {
 #include <libavfilter/buffersink.h>
 #include <libavfilter/buffersrc.h>
 #include <libavutil/pixdesc.h>
+#include <libavutil/imgutils.h>
 }
 
 #ifndef TARGET_POSIX
@@ -266,7 +268,7 @@ enum AVPixelFormat CDVDVideoCodecFFmpeg::GetFormat(struct AVCodecContext * avctx
   if (ctx->HasHardware())
   {
     ctx->SetHardware(nullptr);
-    avctx->get_buffer2 = avcodec_default_get_buffer2;
+    avctx->get_buffer2 = GetBuffer;
     avctx->slice_flags = 0;
     av_buffer_unref(&avctx->hw_frames_ctx);
   }
@@ -353,6 +355,7 @@ bool CDVDVideoCodecFFmpeg::Open(CDVDStreamInfo &hints, CDVDCodecOptions &options
   m_pCodecContext->debug = 0;
   m_pCodecContext->workaround_bugs = FF_BUG_AUTODETECT;
   m_pCodecContext->get_format = GetFormat;
+  m_pCodecContext->get_buffer2 = GetBuffer;
   m_pCodecContext->codec_tag = hints.codec_tag;
 
   // setup threading model
@@ -1056,6 +1059,67 @@ bool CDVDVideoCodecFFmpeg::GetPictureCommon(VideoPicture* pVideoPicture)
   return true;
 }
 
+namespace
+{
+void ReleaseBuffer(void* opaque, uint8_t* data)
+{
+  CVideoBufferSlabAllocator::GetInstance().Release(data);
+}
+}
+
+int CDVDVideoCodecFFmpeg::GetBuffer(struct AVCodecContext* avctx, AVFrame* frame, int flags)
+{
+  // hardware frames and decoders not able to use our buffers are left to ffmpeg
+  const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(frame->format));
+  if (!desc || (desc->flags & AV_PIX_FMT_FLAG_HWACCEL) || avctx->hw_frames_ctx ||
+      !(avctx->codec->capabilities & AV_CODEC_CAP_DR1))
+    return avcodec_default_get_buffer2(avctx, frame, flags);
+
+  const AVPixelFormat format = static_cast<AVPixelFormat>(frame->format);
+  int width = frame->width;
+  int height = frame->height;
+  int linesizeAlign[AV_NUM_DATA_POINTERS];
+  avcodec_align_dimensions2(avctx, &width, &height, linesizeAlign);
+
+  // widen the lines until every plane meets the stride alignment of the decoder, like ffmpeg does
+  int linesize[4];
+  bool unaligned;
+  do
+  {
+    if (av_image_fill_linesizes(linesize, format, width) < 0)
+      return avcodec_default_get_buffer2(avctx, frame, flags);
+    width += width & ~(width - 1);
+
+    unaligned = false;
+    for (int i = 0; i < 4; i++)
+      unaligned |= (linesize[i] % linesizeAlign[i]) != 0;
+  } while (unaligned);
+
+  const int size = av_image_fill_pointers(frame->data, format, height, nullptr, linesize);
+  if (size < 0)
+    return avcodec_default_get_buffer2(avctx, frame, flags);
+
+  // the decoder may read up to 16 bytes plus its simd width past the last line
+  const int bufferSize = size + 16 + static_cast<int>(CVideoBufferSlabAllocator::ALIGNMENT) - 1;
+  uint8_t* data = CVideoBufferSlabAllocator::GetInstance().Acquire(bufferSize);
+  if (!data)
+    return AVERROR(ENOMEM);
+
+  frame->buf[0] = av_buffer_create(data, bufferSize, ReleaseBuffer, nullptr, 0);
+  if (!frame->buf[0])
+  {
+    CVideoBufferSlabAllocator::GetInstance().Release(data);
+    return AVERROR(ENOMEM);
+  }
+
+  av_image_fill_pointers(frame->data, format, height, data, linesize);
+  for (int i = 0; i < 4; i++)
+    frame->linesize[i] = linesize[i];
+  frame->extended_data = frame->data;
+
+  return 0;
+}
+
 int CDVDVideoCodecFFmpeg::FilterOpen(const std::string& filters, bool scale)
 {
   int result;
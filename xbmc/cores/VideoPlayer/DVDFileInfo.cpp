@@ -16,6 +16,7 @@
 #include "video/VideoInfoTag.h"
 #include "filesystem/StackDirectory.h"
 #include "utils/log.h"
+#include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
 
 #include "DVDStreamInfo.h"
@@ -41,6 +42,7 @@
 #include "Util.h"
 #include "utils/LangCodeExpander.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <memory>
 
@@ -86,10 +88,169 @@ int DegreeToOrientation(int degrees)
   }
 }
 
+CDVDThumbDecoderCache::CDVDThumbDecoderCache() = default;
+
+CDVDThumbDecoderCache::~CDVDThumbDecoderCache()
+{
+  Clear();
+}
+
+CDVDVideoCodec* CDVDThumbDecoderCache::Acquire(CDVDStreamInfo& hint)
+{
+  if (m_codec && m_hint->Equal(hint, true))
+  {
+    m_codec->Reset();
+    m_reuseCount++;
+    return m_codec.get();
+  }
+
+  Clear();
+
+  m_processInfo.reset(CProcessInfo::CreateInstance());
+  std::vector<AVPixelFormat> pixFmts;
+  pixFmts.push_back(AV_PIX_FMT_YUV420P);
+  m_processInfo->SetPixFormats(pixFmts);
+
+  m_codec.reset(CDVDFactoryCodec::CreateVideoCodec(hint, *m_processInfo));
+  if (!m_codec)
+  {
+    m_processInfo.reset();
+    return nullptr;
+  }
+
+  m_hint.reset(new CDVDStreamInfo(hint));
+  return m_codec.get();
+}
+
+void CDVDThumbDecoderCache::Clear()
+{
+  // the decoder references the process info, so it has to go first
+  m_codec.reset();
+  m_hint.reset();
+  m_processInfo.reset();
+}
+
+namespace
+{
+
+/*!
+ \brief Read and decode packets of the given stream until a picture is available.
+ \return true if picture holds a decoded picture.
+ */
+bool DecodeThumbPicture(CDVDDemux* pDemuxer, CDVDVideoCodec* pVideoCodec, int nVideoStream, VideoPicture& picture, int& packetsTried)
+{
+  CDVDVideoCodec::VCReturn iDecoderState = CDVDVideoCodec::VC_NONE;
+
+  // num streams * 160 frames, should get a valid frame, if not abort.
+  int abort_index = pDemuxer->GetNrOfStreams() * 160;
+  do
+  {
+    DemuxPacket* pPacket = pDemuxer->Read();
+    packetsTried++;
+
+    if (!pPacket)
+      break;
+
+    if (pPacket->iStreamId != nVideoStream)
+    {
+      CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+      continue;
+    }
+
+    pVideoCodec->AddData(*pPacket);
+    CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+
+    iDecoderState = CDVDVideoCodec::VC_NONE;
+    while (iDecoderState == CDVDVideoCodec::VC_NONE)
+    {
+      iDecoderState = pVideoCodec->GetPicture(&picture);
+    }
+
+    if (iDecoderState == CDVDVideoCodec::VC_PICTURE)
+    {
+      if(!(picture.iFlags & DVP_FLAG_DROPPED))
+        break;
+    }
+
+  } while (abort_index--);
+
+  return iDecoderState == CDVDVideoCodec::VC_PICTURE && !(picture.iFlags & DVP_FLAG_DROPPED);
+}
+
+/*!
+ \brief Scale a decoded picture to the configured image resolution and write it to the texture cache.
+ */
+bool CacheThumbPicture(const VideoPicture& picture, const CDVDStreamInfo& hint, CDVDThumbTarget& target)
+{
+  bool bOk = false;
+
+  unsigned int nWidth = std::min(picture.iDisplayWidth, CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_imageRes);
+  double aspect = (double)picture.iDisplayWidth / (double)picture.iDisplayHeight;
+  if(hint.forced_aspect && hint.aspect != 0)
+    aspect = hint.aspect;
+  unsigned int nHeight = (unsigned int)((double)nWidth / aspect);
+
+  uint8_t *pOutBuf = (uint8_t*)av_malloc(nWidth * nHeight * 4);
+  struct SwsContext *context = sws_getContext(picture.iWidth, picture.iHeight,
+        AV_PIX_FMT_YUV420P, nWidth, nHeight, AV_PIX_FMT_BGRA, SWS_FAST_BILINEAR, NULL, NULL, NULL);
+
+  if (context)
+  {
+    uint8_t *planes[YuvImage::MAX_PLANES];
+    int stride[YuvImage::MAX_PLANES];
+    picture.videoBuffer->GetPlanes(planes);
+    picture.videoBuffer->GetStrides(stride);
+    uint8_t *src[4]= { planes[0], planes[1], planes[2], 0 };
+    int srcStride[] = { stride[0], stride[1], stride[2], 0 };
+    uint8_t *dst[] = { pOutBuf, 0, 0, 0 };
+    int dstStride[] = { (int)nWidth*4, 0, 0, 0 };
+    int orientation = DegreeToOrientation(hint.orientation);
+    sws_scale(context, src, srcStride, 0, picture.iHeight, dst, dstStride);
+    sws_freeContext(context);
+
+    target.width = nWidth;
+    target.height = nHeight;
+    bOk = CPicture::CacheTexture(pOutBuf, nWidth, nHeight, nWidth * 4, orientation, nWidth, nHeight, CTextureCache::GetCachedPath(target.cacheFile));
+  }
+  av_free(pOutBuf);
+
+  return bOk;
+}
+
+} // unnamed namespace
+
+std::string CDVDFileInfo::GetChapterThumbURL(const std::string& path, int chapter)
+{
+  return StringUtils::Format("chapter://%s/%i", path.c_str(), chapter);
+}
+
+std::string CDVDFileInfo::GetStripThumbURL(const std::string& path, unsigned int index)
+{
+  return StringUtils::Format("thumbstrip://%s/%u", path.c_str(), index);
+}
+
 bool CDVDFileInfo::ExtractThumb(const CFileItem& fileItem,
                                 CTextureDetails &details,
                                 CStreamDetails *pStreamDetails,
                                 int64_t pos)
+{
+  std::vector<CDVDThumbTarget> targets(1);
+  targets[0].cacheFile = details.file;
+  targets[0].pos = pos;
+
+  if (!ExtractThumbs(fileItem, targets, pStreamDetails))
+    return false;
+
+  details.width = targets[0].width;
+  details.height = targets[0].height;
+  return true;
+}
+
+bool CDVDFileInfo::ExtractThumbs(const CFileItem& fileItem,
+                                 std::vector<CDVDThumbTarget>& targets,
+                                 CStreamDetails* pStreamDetails,
+                                 CDVDThumbDecoderCache* decoderCache,
+                                 bool addChapters)
 {
   const std::string redactPath = CURL::GetRedacted(fileItem.GetPath());
   unsigned int nTime = XbmcThreads::SystemClockMillis();
@@ -164,6 +325,18 @@ bool CDVDFileInfo::ExtractThumb(const CFileItem& fileItem,
     }
   }
 
+  if (addChapters)
+  {
+    for (int i = 1; i <= pDemuxer->GetChapterCount(); i++)
+    {
+      CDVDThumbTarget target;
+      target.url = GetChapterThumbURL(item.GetPath(), i);
+      target.cacheFile = CTextureCache::GetCacheFile(target.url) + ".jpg";
+      target.chapter = i;
+      targets.push_back(target);
+    }
+  }
+
   int nVideoStream = -1;
   int64_t demuxerId = -1;
   for (CDemuxStream* pStream : pDemuxer->GetStreams())
@@ -186,117 +359,83 @@ bool CDVDFileInfo::ExtractThumb(const CFileItem& fileItem,
 
   if (nVideoStream != -1)
   {
-    CDVDVideoCodec *pVideoCodec;
-    std::unique_ptr<CProcessInfo> pProcessInfo(CProcessInfo::CreateInstance());
-    std::vector<AVPixelFormat> pixFmts;
-    pixFmts.push_back(AV_PIX_FMT_YUV420P);
-    pProcessInfo->SetPixFormats(pixFmts);
+    std::unique_ptr<CDVDThumbDecoderCache> localDecoderCache;
+    if (!decoderCache)
+    {
+      localDecoderCache.reset(new CDVDThumbDecoderCache());
+      decoderCache = localDecoderCache.get();
+    }
 
     CDVDStreamInfo hint(*pDemuxer->GetStream(demuxerId, nVideoStream), true);
     hint.codecOptions = CODEC_FORCE_SOFTWARE;
 
-    pVideoCodec = CDVDFactoryCodec::CreateVideoCodec(hint, *pProcessInfo);
+    CDVDVideoCodec *pVideoCodec = decoderCache->Acquire(hint);
 
     if (pVideoCodec)
     {
       int nTotalLen = pDemuxer->GetStreamLength();
-      int64_t nSeekTo = (pos == -1) ? nTotalLen / 3 : pos;
 
-      CLog::Log(LOGDEBUG, "%s - seeking to pos %lldms (total: %dms) in %s", __FUNCTION__, nSeekTo, nTotalLen, redactPath.c_str());
-      if (pDemuxer->SeekTime(static_cast<double>(nSeekTo), true))
+      for (CDVDThumbTarget& target : targets)
       {
-        CDVDVideoCodec::VCReturn iDecoderState = CDVDVideoCodec::VC_NONE;
-        VideoPicture picture = {};
-
-        // num streams * 160 frames, should get a valid frame, if not abort.
-        int abort_index = pDemuxer->GetNrOfStreams() * 160;
-        do
-        {
-          DemuxPacket* pPacket = pDemuxer->Read();
-          packetsTried++;
-
-          if (!pPacket)
-            break;
-
-          if (pPacket->iStreamId != nVideoStream)
-          {
-            CDVDDemuxUtils::FreeDemuxPacket(pPacket);
-            continue;
-          }
+        if (target.chapter > 0)
+          target.pos = pDemuxer->GetChapterPos(target.chapter) * 1000;
+        else if (target.fraction >= 0.0f)
+          target.pos = static_cast<int64_t>(nTotalLen * target.fraction);
+        else if (target.pos == -1)
+          target.pos = nTotalLen / 3;
+      }
 
-          pVideoCodec->AddData(*pPacket);
-          CDVDDemuxUtils::FreeDemuxPacket(pPacket);
+      // visit the targets in stream order so the demuxer only ever seeks forward
+      std::vector<size_t> order(targets.size());
+      for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+      std::stable_sort(order.begin(), order.end(), [&targets](size_t a, size_t b) {
+        return targets[a].pos < targets[b].pos;
+      });
 
-          iDecoderState = CDVDVideoCodec::VC_NONE;
-          while (iDecoderState == CDVDVideoCodec::VC_NONE)
-          {
-            iDecoderState = pVideoCodec->GetPicture(&picture);
-          }
+      bool firstTarget = true;
+      for (size_t i : order)
+      {
+        CDVDThumbTarget& target = targets[i];
 
-          if (iDecoderState == CDVDVideoCodec::VC_PICTURE)
-          {
-            if(!(picture.iFlags & DVP_FLAG_DROPPED))
-              break;
-          }
+        // drop frames still buffered from the previous seek position
+        if (!firstTarget)
+          pVideoCodec->Reset();
+        firstTarget = false;
 
-        } while (abort_index--);
+        CLog::Log(LOGDEBUG, "%s - seeking to pos %lldms (total: %dms) in %s", __FUNCTION__, target.pos, nTotalLen, redactPath.c_str());
+        if (!pDemuxer->SeekTime(static_cast<double>(target.pos), true))
+          continue;
 
-        if (iDecoderState == CDVDVideoCodec::VC_PICTURE && !(picture.iFlags & DVP_FLAG_DROPPED))
+        VideoPicture picture;
+        if (DecodeThumbPicture(pDemuxer, pVideoCodec, nVideoStream, picture, packetsTried))
         {
-          {
-            unsigned int nWidth = std::min(picture.iDisplayWidth, CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_imageRes);
-            double aspect = (double)picture.iDisplayWidth / (double)picture.iDisplayHeight;
-            if(hint.forced_aspect && hint.aspect != 0)
-              aspect = hint.aspect;
-            unsigned int nHeight = (unsigned int)((double)nWidth / aspect);
-
-            uint8_t *pOutBuf = (uint8_t*)av_malloc(nWidth * nHeight * 4);
-            struct SwsContext *context = sws_getContext(picture.iWidth, picture.iHeight,
-                  AV_PIX_FMT_YUV420P, nWidth, nHeight, AV_PIX_FMT_BGRA, SWS_FAST_BILINEAR, NULL, NULL, NULL);
-
-            if (context)
-            {
-              uint8_t *planes[YuvImage::MAX_PLANES];
-              int stride[YuvImage::MAX_PLANES];
-              picture.videoBuffer->GetPlanes(planes);
-              picture.videoBuffer->GetStrides(stride);
-              uint8_t *src[4]= { planes[0], planes[1], planes[2], 0 };
-              int srcStride[] = { stride[0], stride[1], stride[2], 0 };
-              uint8_t *dst[] = { pOutBuf, 0, 0, 0 };
-              int dstStride[] = { (int)nWidth*4, 0, 0, 0 };
-              int orientation = DegreeToOrientation(hint.orientation);
-              sws_scale(context, src, srcStride, 0, picture.iHeight, dst, dstStride);
-              sws_freeContext(context);
-
-              details.width = nWidth;
-              details.height = nHeight;
-              CPicture::CacheTexture(pOutBuf, nWidth, nHeight, nWidth * 4, orientation, nWidth, nHeight, CTextureCache::GetCachedPath(details.file));
-              bOk = true;
-            }
-            av_free(pOutBuf);
-          }
+          target.extracted = CacheThumbPicture(picture, hint, target);
+          bOk |= target.extracted;
         }
         else
         {
           CLog::Log(LOGDEBUG,"%s - decode failed in %s after %d packets.", __FUNCTION__, redactPath.c_str(), packetsTried);
         }
       }
-      delete pVideoCodec;
     }
   }
 
   if (pDemuxer)
     delete pDemuxer;
 
-  if(!bOk)
+  for (const CDVDThumbTarget& target : targets)
   {
+    if (target.extracted)
+      continue;
+
     XFILE::CFile file;
-    if(file.OpenForWrite(CTextureCache::GetCachedPath(details.file)))
+    if(file.OpenForWrite(CTextureCache::GetCachedPath(target.cacheFile)))
       file.Close();
   }
 
   unsigned int nTotalTime = XbmcThreads::SystemClockMillis() - nTime;
-  CLog::Log(LOGDEBUG,"%s - measured %u ms to extract thumb from file <%s> in %d packets. ", __FUNCTION__, nTotalTime, redactPath.c_str(), packetsTried);
+  CLog::Log(LOGDEBUG,"%s - measured %u ms to extract %u thumb(s) from file <%s> in %d packets. ", __FUNCTION__, nTotalTime, static_cast<unsigned int>(targets.size()), redactPath.c_str(), packetsTried);
   return bOk;
 }
 
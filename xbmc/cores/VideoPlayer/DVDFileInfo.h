@@ -14,11 +14,67 @@
 
 class CFileItem;
 class CDVDDemux;
+class CDVDStreamInfo;
+class CDVDVideoCodec;
+class CProcessInfo;
 class CStreamDetails;
 class CStreamDetailSubtitle;
 class CDVDInputStream;
 class CTextureDetails;
 
+/*!
+ \brief A single image to extract while a media file is open.
+ \sa CDVDFileInfo::ExtractThumbs
+ */
+struct CDVDThumbTarget
+{
+  std::string url; ///< url the image is cached under in the texture cache
+  std::string cacheFile; ///< texture cache file to write, as returned by CTextureCache::GetCacheFile() + extension
+  int64_t pos = -1; ///< position in ms, -1 for a third of the stream length
+  int chapter = 0; ///< chapter to extract from (1-based), overrides pos if > 0
+  float fraction = -1.0f; ///< fraction of the stream length to extract from, overrides pos if >= 0
+  unsigned int width = 0; ///< width of the extracted image
+  unsigned int height = 0; ///< height of the extracted image
+  bool extracted = false; ///< whether the image was extracted and written to cacheFile
+};
+
+/*!
+ \brief Keeps a software video decoder alive between thumbnail extractions.
+
+ Files sharing the same codec parameters (codec, profile, dimensions and extradata)
+ reuse the open decoder instead of creating a new one for every file. An instance
+ must only be used by one thread at a time.
+ */
+class CDVDThumbDecoderCache
+{
+public:
+  CDVDThumbDecoderCache();
+  ~CDVDThumbDecoderCache();
+
+  /*!
+   \brief Get a decoder for the given stream, reusing the cached one if the parameters match.
+   \param hint the stream to decode.
+   \return the decoder, or nullptr if none could be opened. Owned by the cache.
+   */
+  CDVDVideoCodec* Acquire(CDVDStreamInfo& hint);
+
+  /*!
+   \brief Close the cached decoder.
+   */
+  void Clear();
+
+  /*!
+   \brief Number of times a decoder was reused instead of opened.
+   */
+  unsigned int GetReuseCount() const { return m_reuseCount; }
+
+private:
+  std::unique_ptr<CProcessInfo> m_processInfo;
+  std::unique_ptr<CDVDVideoCodec> m_codec;
+  std::unique_ptr<CDVDStreamInfo> m_hint;
+  unsigned int m_reuseCount = 0;
+};
+
 class CDVDFileInfo
 {
 public:
@@ -28,6 +84,36 @@ public:
                            CStreamDetails *pStreamDetails,
                            int64_t pos);
 
+  /*!
+   \brief Extract several images from the media referenced by fileItem with a single open.
+   \param fileItem the media to extract from.
+   \param[in,out] targets images to extract, on return extracted, width and height are set.
+   \param pStreamDetails optional streamdetails to fill.
+   \param decoderCache optional decoder cache to reuse a decoder across files.
+   \param addChapters whether a target should be appended for every chapter of the media.
+   \return true if at least one image was extracted.
+   \sa GetChapterThumbURL
+   */
+  static bool ExtractThumbs(const CFileItem& fileItem,
+                            std::vector<CDVDThumbTarget>& targets,
+                            CStreamDetails* pStreamDetails,
+                            CDVDThumbDecoderCache* decoderCache = nullptr,
+                            bool addChapters = false);
+
+  /*!
+   \brief Url under which the thumb of a chapter is stored in the texture cache.
+   \param path the path of the media.
+   \param chapter the chapter (1-based).
+   */
+  static std::string GetChapterThumbURL(const std::string& path, int chapter);
+
+  /*!
+   \brief Url under which a frame of the thumbnail strip of a media is stored in the texture cache.
+   \param path the path of the media.
+   \param index the index of the frame in the strip (0-based).
+   */
+  static std::string GetStripThumbURL(const std::string& path, unsigned int index);
+
   // Probe the files streams and store the info in the VideoInfoTag
   static bool GetFileStreamDetails(CFileItem *pItem);
   static bool DemuxerToStreamDetails(std::shared_ptr<CDVDInputStream> pInputStream, CDVDDemux *pDemux, CStreamDetails &details, const std::string &path = "");
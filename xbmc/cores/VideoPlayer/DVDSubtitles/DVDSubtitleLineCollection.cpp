@@ -8,17 +8,9 @@
 
 #include "DVDSubtitleLineCollection.h"
 
-#include <stddef.h>
+#include <algorithm>
 
-
-CDVDSubtitleLineCollection::CDVDSubtitleLineCollection()
-{
-  m_pHead = NULL;
-  m_pCurrent = NULL;
-  m_pTail = NULL;
-
-  m_iSize = 0;
-}
+CDVDSubtitleLineCollection::CDVDSubtitleLineCollection() = default;
 
 CDVDSubtitleLineCollection::~CDVDSubtitleLineCollection()
 {
@@ -27,85 +19,70 @@ CDVDSubtitleLineCollection::~CDVDSubtitleLineCollection()
 
 void CDVDSubtitleLineCollection::Add(CDVDOverlay* pOverlay)
 {
-  ListElement* pElement = new ListElement;
-  pElement->pOverlay = pOverlay;
-  pElement->pNext = NULL;
-
-  if (!m_pHead)
-  {
-    m_pHead = m_pTail = pElement;
-    m_pCurrent = m_pHead;
-  }
-  else
-  {
-    m_pTail->pNext = pElement;
-    m_pTail = pElement;
-  }
-
-  m_iSize++;
+  m_subtitles.push_back(pOverlay);
 }
 
 void CDVDSubtitleLineCollection::Sort()
 {
-  if (!m_pHead || !m_pHead->pNext)
-    return;
+  // stable, so cues starting at the same time keep their file order
+  std::stable_sort(m_subtitles.begin(), m_subtitles.end(), [](const CDVDOverlay* a, const CDVDOverlay* b) {
+    return a->iPTSStartTime < b->iPTSStartTime;
+  });
+
+  m_maxStopTime.clear();
+  UpdateMaxStopTime();
+}
 
-  for (ListElement* p1 = m_pHead; p1->pNext != NULL; p1 = p1->pNext)
+void CDVDSubtitleLineCollection::UpdateMaxStopTime()
+{
+  m_maxStopTime.reserve(m_subtitles.size());
+  for (size_t i = m_maxStopTime.size(); i < m_subtitles.size(); i++)
   {
-    for (ListElement* p2 = p1->pNext; p2 != NULL; p2 = p2->pNext)
-    {
-      if (p1->pOverlay->iPTSStartTime > p2->pOverlay->iPTSStartTime)
-      {
-        CDVDOverlay* temp = p1->pOverlay;
-        p1->pOverlay = p2->pOverlay;
-        p2->pOverlay = temp;
-      }
-    }
+    double stopTime = m_subtitles[i]->iPTSStopTime;
+    if (i > 0)
+      stopTime = std::max(stopTime, m_maxStopTime[i - 1]);
+    m_maxStopTime.push_back(stopTime);
   }
 }
 
 CDVDOverlay* CDVDSubtitleLineCollection::Get(double iPts)
 {
-  CDVDOverlay* pOverlay = NULL;
+  if (m_current >= m_subtitles.size())
+    return nullptr;
+
+  UpdateMaxStopTime();
 
-  if (m_pCurrent)
+  // If no cue before the current one is visible any longer, the first cue at or after
+  // the current one with a stop time >= iPts is where the running maximum first reaches iPts.
+  if (m_current == 0 || m_maxStopTime[m_current - 1] < iPts)
+  {
+    auto it = std::lower_bound(m_maxStopTime.begin() + m_current, m_maxStopTime.end(), iPts);
+    m_current = std::distance(m_maxStopTime.begin(), it);
+  }
+  else
   {
-    while (m_pCurrent && m_pCurrent->pOverlay->iPTSStopTime < iPts)
-    {
-      m_pCurrent = m_pCurrent->pNext;
-    }
-
-    if (m_pCurrent)
-    {
-      pOverlay = m_pCurrent->pOverlay;
-
-      // advance to the next overlay
-      m_pCurrent = m_pCurrent->pNext;
-    }
+    while (m_current < m_subtitles.size() && m_subtitles[m_current]->iPTSStopTime < iPts)
+      m_current++;
   }
-  return pOverlay;
+
+  if (m_current >= m_subtitles.size())
+    return nullptr;
+
+  // advance to the next overlay
+  return m_subtitles[m_current++];
 }
 
 void CDVDSubtitleLineCollection::Reset()
 {
-  m_pCurrent = m_pHead;
+  m_current = 0;
 }
 
 void CDVDSubtitleLineCollection::Clear()
 {
-  ListElement* pElement = NULL;
-
-  while (m_pHead)
-  {
-    pElement = m_pHead;
-    m_pHead = pElement->pNext;
-
-    pElement->pOverlay->Release();
-    delete pElement;
-  }
+  for (CDVDOverlay* pOverlay : m_subtitles)
+    pOverlay->Release();
 
-  m_pTail    = NULL;
-  m_pHead    = NULL;
-  m_pCurrent = NULL;
-  m_iSize    = 0;
+  m_subtitles.clear();
+  m_maxStopTime.clear();
+  m_current = 0;
 }
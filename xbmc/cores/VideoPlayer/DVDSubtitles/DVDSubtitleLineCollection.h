@@ -10,22 +10,22 @@
 
 #include "../DVDCodecs/Overlay/DVDOverlay.h"
 
-typedef struct stListElement
-{
-  CDVDOverlay* pOverlay;
-  struct stListElement* pNext;
+#include <cstddef>
+#include <vector>
 
-} ListElement;
+/*!
+ \brief Cues of a text subtitle, ordered by start time.
 
+ Next to the cues the collection keeps the running maximum of their stop times,
+ which is monotonic and allows to locate the first cue still visible at a given
+ pts with a binary search instead of a walk over all preceding cues.
+ */
 class CDVDSubtitleLineCollection
 {
 public:
   CDVDSubtitleLineCollection();
   virtual ~CDVDSubtitleLineCollection();
 
-  //void Lock()   { EnterCriticalSection(&m_critSection); }
-  //void Unlock() { LeaveCriticalSection(&m_critSection); }
-
   void Add(CDVDOverlay* pSubtitle);
   void Sort();
 
@@ -33,16 +33,16 @@ public:
 
   void Reset();
 
-  void Remove();
   void Clear();
-  int GetSize() { return m_iSize; }
+  int GetSize() { return static_cast<int>(m_subtitles.size()); }
 
 private:
-  ListElement* m_pHead;
-  ListElement* m_pCurrent;
-  ListElement* m_pTail;
-
-  int m_iSize;
-  //CRITICAL_SECTION m_critSection;
+  /*!
+   \brief Extend m_maxStopTime to cover all cues.
+   */
+  void UpdateMaxStopTime();
+
+  std::vector<CDVDOverlay*> m_subtitles;
+  std::vector<double> m_maxStopTime; ///< maximum stop time of the cues up to and including the index
+  size_t m_current = 0;
 };
-
@@ -40,22 +40,22 @@ bool CDVDSubtitleParserMicroDVD::Open(CDVDStreamInfo &hints)
   else
     m_framerate = DVD_TIME_BASE / 25.0;
 
-  char line[1024];
-
   CRegExp reg;
   if (!reg.RegComp("\\{([0-9]+)\\}\\{([0-9]+)\\}"))
     return false;
   CDVDSubtitleTagMicroDVD TagConv;
 
-  while (m_pStream->ReadLine(line, sizeof(line)))
+  const char* line;
+  size_t length;
+  while (m_pStream->ReadLine(line, length))
   {
-    if ((strlen(line) > 0) && (line[strlen(line) - 1] == '\r'))
-      line[strlen(line) - 1] = 0;
+    if (length > 0 && line[length - 1] == '\r')
+      length--;
 
-    int pos = reg.RegFind(line);
+    int pos = reg.RegFind(line, length, 0, -1);
     if (pos > -1)
     {
-      const char* text = line + pos + reg.GetFindLen();
+      const size_t textStart = pos + reg.GetFindLen();
       std::string startFrame(reg.GetMatch(1));
       std::string endFrame  (reg.GetMatch(2));
       CDVDOverlayText* pOverlay = new CDVDOverlayText();
@@ -64,7 +64,7 @@ bool CDVDSubtitleParserMicroDVD::Open(CDVDStreamInfo &hints)
       pOverlay->iPTSStartTime = m_framerate * atoi(startFrame.c_str());
       pOverlay->iPTSStopTime  = m_framerate * atoi(endFrame.c_str());
 
-      TagConv.ConvertLine(pOverlay, text, strlen(text));
+      TagConv.ConvertLine(pOverlay, line + textStart, static_cast<int>(length - textStart));
       m_collection.Add(pOverlay);
     }
   }
@@ -29,8 +29,9 @@ bool CDVDSubtitleParserSSA::Open(CDVDStreamInfo &hints)
   if (!CDVDSubtitleParserText::Open())
     return false;
 
-  std::string buffer = m_pStream->m_stringstream.str();
-  if(!m_libass->CreateTrack(const_cast<char*>(buffer.c_str()), buffer.length()))
+  // libass parses the whole file in place, nothing else reads it from the stream
+  std::string buffer = m_pStream->TakeBuffer();
+  if(!m_libass->CreateTrack(&buffer[0], buffer.length()))
     return false;
 
   //Creating the overlays by going through the list of ass_events
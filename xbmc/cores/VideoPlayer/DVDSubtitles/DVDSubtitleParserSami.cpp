@@ -32,8 +32,6 @@ bool CDVDSubtitleParserSami::Open(CDVDStreamInfo &hints)
   if (!CDVDSubtitleParserText::Open())
     return false;
 
-  char line[1024];
-
   CRegExp reg(true);
   if (!reg.RegComp("<SYNC START=([0-9]+)>"))
     return false;
@@ -63,13 +61,16 @@ bool CDVDSubtitleParserSami::Open(CDVDStreamInfo &hints)
     lang = strClassID.c_str();
 
   CDVDOverlayText* pOverlay = NULL;
-  while (m_pStream->ReadLine(line, sizeof(line)))
+  const char* line;
+  size_t length;
+  while (m_pStream->ReadLine(line, length))
   {
-    if ((strlen(line) > 0) && (line[strlen(line) - 1] == '\r'))
-      line[strlen(line) - 1] = 0;
+    if (length > 0 && line[length - 1] == '\r')
+      length--;
 
-    int pos = reg.RegFind(line);
+    int pos = reg.RegFind(line, length, 0, -1);
     const char* text = line;
+    size_t textLength = length;
     if (pos > -1)
     {
       std::string start = reg.GetMatch(1);
@@ -88,9 +89,10 @@ bool CDVDSubtitleParserSami::Open(CDVDStreamInfo &hints)
       pOverlay->iPTSStopTime  = DVD_NOPTS_VALUE;
       m_collection.Add(pOverlay);
       text += pos + reg.GetFindLen();
+      textLength -= pos + reg.GetFindLen();
     }
     if(pOverlay)
-      TagConv.ConvertLine(pOverlay, text, strlen(text), lang);
+      TagConv.ConvertLine(pOverlay, text, static_cast<int>(textLength), lang);
   }
   m_collection.Sort();
   return true;
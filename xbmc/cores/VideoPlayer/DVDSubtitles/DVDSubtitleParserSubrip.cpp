@@ -32,12 +32,13 @@ bool CDVDSubtitleParserSubrip::Open(CDVDStreamInfo &hints)
   if (!TagConv.Init())
     return false;
 
-  char line[1024];
+  const char* line;
+  size_t length;
   std::string strLine;
 
-  while (m_pStream->ReadLine(line, sizeof(line)))
+  while (m_pStream->ReadLine(line, length))
   {
-    strLine = line;
+    strLine.assign(line, length);
     StringUtils::Trim(strLine);
 
     if (strLine.length() > 0)
@@ -60,9 +61,9 @@ bool CDVDSubtitleParserSubrip::Open(CDVDStreamInfo &hints)
         pOverlay->iPTSStartTime = ((double)(((hh1 * 60 + mm1) * 60) + ss1) * 1000 + ms1) * (DVD_TIME_BASE / 1000);
         pOverlay->iPTSStopTime  = ((double)(((hh2 * 60 + mm2) * 60) + ss2) * 1000 + ms2) * (DVD_TIME_BASE / 1000);
 
-        while (m_pStream->ReadLine(line, sizeof(line)))
+        while (m_pStream->ReadLine(line, length))
         {
-          strLine = line;
+          strLine.assign(line, length);
           StringUtils::Trim(strLine);
 
           // empty line, next subtitle is about to start
@@ -17,6 +17,7 @@
 #include "utils/Utf8Utils.h"
 #include "utils/log.h"
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
 
@@ -63,9 +64,11 @@ bool CDVDSubtitleStream::Open(const std::string& strFile)
     std::string tmpStr(buf.get(), totalread);
     buf.clear();
 
+    m_position = 0;
+
     std::string enc(CCharsetDetection::GetBomEncoding(tmpStr));
     if (enc == "UTF-8" || (enc.empty() && CUtf8Utils::isValidUtf8(tmpStr)))
-      m_stringstream << tmpStr;
+      m_buffer = std::move(tmpStr);
     else if (!enc.empty())
     {
       std::string converted;
@@ -73,7 +76,7 @@ bool CDVDSubtitleStream::Open(const std::string& strFile)
       if (converted.empty())
         return false;
 
-      m_stringstream << converted;
+      m_buffer = std::move(converted);
     }
     else
     {
@@ -82,7 +85,7 @@ bool CDVDSubtitleStream::Open(const std::string& strFile)
       if (converted.empty())
         return false;
 
-      m_stringstream << converted;
+      m_buffer = std::move(converted);
     }
 
     return true;
@@ -120,37 +123,83 @@ bool CDVDSubtitleStream::IsIncompatible(CDVDInputStream* pInputStream, XUTILS::a
 
 int CDVDSubtitleStream::Read(char* buf, int buf_size)
 {
-  return (int)m_stringstream.readsome(buf, buf_size);
+  size_t read = std::min(static_cast<size_t>(std::max(buf_size, 0)), m_buffer.size() - m_position);
+  std::memcpy(buf, m_buffer.data() + m_position, read);
+  m_position += read;
+  return static_cast<int>(read);
 }
 
 long CDVDSubtitleStream::Seek(long offset, int whence)
 {
+  long position;
   switch (whence)
   {
     case SEEK_CUR:
     {
-      m_stringstream.seekg(offset, std::ios::cur);
+      position = static_cast<long>(m_position) + offset;
       break;
     }
     case SEEK_END:
     {
-      m_stringstream.seekg(offset, std::ios::end);
+      position = static_cast<long>(m_buffer.size()) + offset;
       break;
     }
     case SEEK_SET:
     {
-      m_stringstream.seekg(offset, std::ios::beg);
+      position = offset;
       break;
     }
+    default:
+      return -1;
   }
-  return (int)m_stringstream.tellg();
+
+  if (position < 0 || position > static_cast<long>(m_buffer.size()))
+    return -1;
+
+  m_position = static_cast<size_t>(position);
+  return position;
 }
 
 char* CDVDSubtitleStream::ReadLine(char* buf, int iLen)
 {
-  if (m_stringstream.getline(buf, iLen))
-    return buf;
-  else
+  const char* line;
+  size_t length;
+  if (iLen <= 0 || !ReadLine(line, length))
     return NULL;
+
+  // overlong lines are truncated to the buffer size
+  length = std::min(length, static_cast<size_t>(iLen - 1));
+  std::memcpy(buf, line, length);
+  buf[length] = '\0';
+  return buf;
 }
 
+std::string CDVDSubtitleStream::TakeBuffer()
+{
+  std::string buffer = std::move(m_buffer);
+  m_buffer.clear();
+  m_position = 0;
+  return buffer;
+}
+
+bool CDVDSubtitleStream::ReadLine(const char*& line, size_t& length)
+{
+  if (m_position >= m_buffer.size())
+    return false;
+
+  line = m_buffer.data() + m_position;
+  const size_t remaining = m_buffer.size() - m_position;
+  const char* end = static_cast<const char*>(std::memchr(line, '\n', remaining));
+
+  if (end)
+  {
+    length = end - line;
+    m_position += length + 1;
+  }
+  else
+  {
+    length = remaining;
+    m_position = m_buffer.size();
+  }
+  return true;
+}
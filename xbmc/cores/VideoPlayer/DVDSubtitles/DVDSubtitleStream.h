@@ -10,7 +10,6 @@
 
 #include "utils/auto_buffer.h"
 
-#include <sstream>
 #include <string>
 
 class CDVDInputStream;
@@ -37,6 +36,22 @@ public:
   char* ReadLine(char* pBuffer, int iLen);
   //wchar* ReadLineW(wchar* pBuffer, int iLen) { return NULL; };
 
-  std::stringstream m_stringstream;
+  /*!
+   \brief Read the next line without copying it.
+   \param[out] line points to the start of the line inside the buffer, not null terminated.
+   \param[out] length length of the line, without the line break.
+   \return false at the end of the stream.
+   */
+  bool ReadLine(const char*& line, size_t& length);
+
+  /*!
+   \brief Hand over the whole utf-8 converted subtitle file without copying it.
+   The stream is empty afterwards, for parsers that consume the file in one go.
+   */
+  std::string TakeBuffer();
+
+private:
+  std::string m_buffer;
+  size_t m_position = 0;
 };
 
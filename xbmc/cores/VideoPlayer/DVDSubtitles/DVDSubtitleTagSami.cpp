@@ -211,15 +211,16 @@ void CDVDSubtitleTagSami::CloseTag(CDVDOverlayText* pOverlay)
 
 void CDVDSubtitleTagSami::LoadHead(CDVDSubtitleStream* samiStream)
 {
-  char cLine[1024];
+  const char* cLine;
+  size_t length;
   bool inSTYLE = false;
   CRegExp reg(true);
   if (!reg.RegComp("\\.([a-z]+)[ \t]*\\{[ \t]*name:([^;]*?);[ \t]*lang:([^;]*?);[ \t]*SAMIType:([^;]*?);[ \t]*\\}"))
     return;
 
-  while (samiStream->ReadLine(cLine, sizeof(cLine)))
+  while (samiStream->ReadLine(cLine, length))
   {
-    std::string line = cLine;
+    std::string line(cLine, length);
     StringUtils::Trim(line);
 
    if (StringUtils::EqualsNoCase(line, "<BODY>"))
@@ -0,0 +1,132 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/VideoPlayer/DVDSubtitles/DVDSubtitleLineCollection.h"
+#include "test/TestUtils.h"
+
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+CDVDOverlay* CreateCue(double start, double stop)
+{
+  CDVDOverlay* overlay = new CDVDOverlay(DVDOVERLAY_TYPE_TEXT);
+  overlay->iPTSStartTime = start;
+  overlay->iPTSStopTime = stop;
+  return overlay;
+}
+
+} // namespace
+
+TEST(TestDVDSubtitleLineCollection, Sort)
+{
+  CDVDSubtitleLineCollection collection;
+  collection.Add(CreateCue(300, 400));
+  collection.Add(CreateCue(100, 200));
+  collection.Add(CreateCue(200, 300));
+  collection.Sort();
+
+  EXPECT_EQ(collection.GetSize(), 3);
+  EXPECT_EQ(collection.Get(0)->iPTSStartTime, 100);
+  EXPECT_EQ(collection.Get(0)->iPTSStartTime, 200);
+  EXPECT_EQ(collection.Get(0)->iPTSStartTime, 300);
+  EXPECT_EQ(collection.Get(0), nullptr);
+}
+
+TEST(TestDVDSubtitleLineCollection, GetSkipsExpired)
+{
+  CDVDSubtitleLineCollection collection;
+  collection.Add(CreateCue(100, 200));
+  collection.Add(CreateCue(200, 300));
+  collection.Add(CreateCue(300, 400));
+  collection.Sort();
+
+  CDVDOverlay* overlay = collection.Get(250);
+  ASSERT_NE(overlay, nullptr);
+  EXPECT_EQ(overlay->iPTSStartTime, 200);
+
+  // seeking back requires a reset
+  overlay = collection.Get(150);
+  ASSERT_NE(overlay, nullptr);
+  EXPECT_EQ(overlay->iPTSStartTime, 300);
+
+  collection.Reset();
+  overlay = collection.Get(150);
+  ASSERT_NE(overlay, nullptr);
+  EXPECT_EQ(overlay->iPTSStartTime, 100);
+
+  EXPECT_EQ(collection.Get(500), nullptr);
+}
+
+TEST(TestDVDSubtitleLineCollection, GetOverlapping)
+{
+  CDVDSubtitleLineCollection collection;
+  collection.Add(CreateCue(0, 1000)); // long cue overlapping the following ones
+  collection.Add(CreateCue(100, 200));
+  collection.Add(CreateCue(300, 400));
+  collection.Add(CreateCue(500, 600));
+  collection.Sort();
+
+  CDVDOverlay* overlay = collection.Get(350);
+  ASSERT_NE(overlay, nullptr);
+  EXPECT_EQ(overlay->iPTSStartTime, 0);
+
+  // the long cue is still visible, so expired cues after it are skipped one by one
+  overlay = collection.Get(350);
+  ASSERT_NE(overlay, nullptr);
+  EXPECT_EQ(overlay->iPTSStartTime, 300);
+
+  collection.Reset();
+  overlay = collection.Get(1500);
+  EXPECT_EQ(overlay, nullptr);
+}
+
+TEST(TestDVDSubtitleLineCollection, GetUnsorted)
+{
+  // parsers of formats in playback order don't sort
+  CDVDSubtitleLineCollection collection;
+  collection.Add(CreateCue(100, 200));
+  collection.Add(CreateCue(200, 300));
+
+  CDVDOverlay* overlay = collection.Get(250);
+  ASSERT_NE(overlay, nullptr);
+  EXPECT_EQ(overlay->iPTSStartTime, 200);
+
+  collection.Add(CreateCue(300, 400));
+  overlay = collection.Get(350);
+  ASSERT_NE(overlay, nullptr);
+  EXPECT_EQ(overlay->iPTSStartTime, 300);
+}
+
+TEST(TestDVDSubtitleLineCollection, SeekLargeCollection)
+{
+  // karaoke style file: 100k short, overlapping cues added in reverse order
+  static const int cues = 100000;
+
+  CTestStopwatch stopwatch;
+
+  CDVDSubtitleLineCollection collection;
+  for (int i = cues - 1; i >= 0; i--)
+    collection.Add(CreateCue(i * 100.0, i * 100.0 + 250.0));
+  collection.Sort();
+
+  for (int seek = 0; seek < 1000; seek++)
+  {
+    const int cue = (seek * 7919) % cues;
+    collection.Reset();
+    CDVDOverlay* overlay = collection.Get(cue * 100.0 + 50.0);
+    ASSERT_NE(overlay, nullptr);
+    // the previous two cues are still visible
+    EXPECT_EQ(overlay->iPTSStartTime, std::max(0, cue - 2) * 100.0);
+  }
+
+  RecordProperty("duration_us", static_cast<int>(stopwatch.Lap()));
+}
@@ -0,0 +1,186 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/VideoPlayer/DVDCodecs/Overlay/DVDOverlayText.h"
+#include "cores/VideoPlayer/DVDStreamInfo.h"
+#include "cores/VideoPlayer/DVDSubtitles/DVDSubtitleParserMicroDVD.h"
+#include "cores/VideoPlayer/DVDSubtitles/DVDSubtitleParserSSA.h"
+#include "cores/VideoPlayer/DVDSubtitles/DVDSubtitleParserSami.h"
+#include "cores/VideoPlayer/Interface/Addon/TimingConstants.h"
+#include "filesystem/File.h"
+#include "test/TestUtils.h"
+#include "utils/StringUtils.h"
+
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+const int BENCHMARK_EVENTS = 50000;
+
+/*!
+ \brief A subtitle file in the temp directory that is deleted again with the object.
+ */
+class CTempSubtitleFile
+{
+public:
+  CTempSubtitleFile(const std::string& suffix, const std::string& content)
+  {
+    m_file = XBMC_CREATETEMPFILE(suffix);
+    if (!m_file)
+      return;
+    m_file->Close();
+    if (m_file->OpenForWrite(XBMC_TEMPFILEPATH(m_file), true))
+    {
+      m_file->Write(content.c_str(), content.size());
+      m_file->Close();
+    }
+  }
+
+  ~CTempSubtitleFile() { XBMC_DELETETEMPFILE(m_file); }
+
+  std::string GetPath() const { return XBMC_TEMPFILEPATH(m_file); }
+
+private:
+  XFILE::CFile* m_file = nullptr;
+};
+
+std::string GetText(CDVDOverlay* overlay)
+{
+  std::string text;
+  CDVDOverlayText* textOverlay = static_cast<CDVDOverlayText*>(overlay);
+  for (CDVDOverlayText::CElement* e = textOverlay->m_pHead; e; e = e->pNext)
+  {
+    if (e->IsElementType(CDVDOverlayText::ELEMENT_TYPE_TEXT))
+      text += static_cast<CDVDOverlayText::CElementText*>(e)->GetText();
+  }
+  return text;
+}
+
+// the overlay shown at pts, which has to start at start
+void ExpectCue(CDVDSubtitleParser& parser, double pts, double start, double stop)
+{
+  CDVDOverlay* overlay = parser.Parse(pts);
+  ASSERT_NE(nullptr, overlay);
+  EXPECT_DOUBLE_EQ(start, overlay->iPTSStartTime);
+  EXPECT_DOUBLE_EQ(stop, overlay->iPTSStopTime);
+  overlay->Release();
+}
+
+std::string CreateSSA(int events)
+{
+  std::string ssa = "[Script Info]\r\n"
+                    "ScriptType: v4.00+\r\n"
+                    "PlayResX: 1920\r\n"
+                    "PlayResY: 1080\r\n"
+                    "\r\n"
+                    "[V4+ Styles]\r\n"
+                    "Format: Name, Fontname, Fontsize, PrimaryColour, SecondaryColour, OutlineColour, "
+                    "BackColour, Bold, Italic, Underline, StrikeOut, ScaleX, ScaleY, Spacing, Angle, "
+                    "BorderStyle, Outline, Shadow, Alignment, MarginL, MarginR, MarginV, Encoding\r\n"
+                    "Style: Default,Arial,48,&H00FFFFFF,&H000000FF,&H00000000,&H00000000,0,0,0,0,100,"
+                    "100,0,0,1,2,0,2,10,10,10,1\r\n"
+                    "\r\n"
+                    "[Events]\r\n"
+                    "Format: Layer, Start, End, Style, Name, MarginL, MarginR, MarginV, Effect, Text\r\n";
+  for (int i = 0; i < events; i++)
+  {
+    // one event a second, shown for half of it
+    ssa += StringUtils::Format("Dialogue: 0,%d:%02d:%02d.00,%d:%02d:%02d.50,Default,,0,0,0,,"
+                               "{\\i1}Line %d{\\i0} of the synthetic subtitle\\Nsecond row\r\n",
+                               i / 3600, i / 60 % 60, i % 60, i / 3600, i / 60 % 60, i % 60, i);
+  }
+  return ssa;
+}
+} // unnamed namespace
+
+TEST(TestDVDSubtitleParsers, MicroDVD)
+{
+  // a line longer than the fixed line buffer the parser used to read into
+  const std::string longText(3000, 'x');
+  const CTempSubtitleFile file(".txt", "{25}{50}First|line\r\n"
+                                       "not a cue\r\n"
+                                       "{100}{150}" + longText + "\r\n"
+                                       "{200}{225}Last line without line break");
+
+  CDVDSubtitleParserMicroDVD parser(nullptr, file.GetPath());
+  CDVDStreamInfo hints;
+  ASSERT_TRUE(parser.Open(hints));
+
+  // 25 frames per second without hints
+  const double frame = DVD_TIME_BASE / 25.0;
+  ExpectCue(parser, 30 * frame, 25 * frame, 50 * frame);
+
+  CDVDOverlay* overlay = parser.Parse(120 * frame);
+  ASSERT_NE(nullptr, overlay);
+  EXPECT_DOUBLE_EQ(100 * frame, overlay->iPTSStartTime);
+  EXPECT_EQ(longText, GetText(overlay));
+  overlay->Release();
+
+  ExpectCue(parser, 210 * frame, 200 * frame, 225 * frame);
+  EXPECT_EQ(nullptr, parser.Parse(300 * frame));
+}
+
+TEST(TestDVDSubtitleParsers, Sami)
+{
+  const CTempSubtitleFile file(".smi", "<SAMI>\r\n"
+                                       "<HEAD>\r\n"
+                                       "<STYLE TYPE=\"text/css\">\r\n"
+                                       "<!--\r\n"
+                                       ".ENUSCC { Name: English; lang: en-US; }\r\n"
+                                       "-->\r\n"
+                                       "</STYLE>\r\n"
+                                       "</HEAD>\r\n"
+                                       "<BODY>\r\n"
+                                       "<SYNC START=1000><P CLASS=ENUSCC>First\r\n"
+                                       "<SYNC START=2500><P CLASS=ENUSCC>Second\r\n"
+                                       "<SYNC START=4000><P CLASS=ENUSCC>&nbsp;\r\n"
+                                       "</BODY>\r\n"
+                                       "</SAMI>\r\n");
+
+  CDVDSubtitleParserSami parser(nullptr, file.GetPath());
+  CDVDStreamInfo hints;
+  ASSERT_TRUE(parser.Open(hints));
+
+  // a cue lasts until the next sync point
+  const double ms = DVD_TIME_BASE / 1000;
+  ExpectCue(parser, 1500 * ms, 1000 * ms, 2500 * ms);
+  ExpectCue(parser, 3000 * ms, 2500 * ms, 4000 * ms);
+}
+
+TEST(TestDVDSubtitleParsers, BenchmarkSSA)
+{
+  const CTempSubtitleFile file(".ass", CreateSSA(BENCHMARK_EVENTS));
+
+  // libass is set up with its fonts outside of the timed part
+  CDVDSubtitleParserSSA parser(nullptr, file.GetPath());
+  CDVDStreamInfo hints;
+
+  CTestStopwatch stopwatch;
+  ASSERT_TRUE(parser.Open(hints));
+  const int64_t openTime = stopwatch.Lap();
+
+  // every event became a cue
+  int cues = 0;
+  for (int i = 0; i < BENCHMARK_EVENTS; i++)
+  {
+    CDVDOverlay* overlay = parser.Parse((i + 0.25) * DVD_TIME_BASE);
+    if (overlay)
+    {
+      if (overlay->iPTSStartTime == i * DVD_TIME_BASE)
+        cues++;
+      overlay->Release();
+    }
+  }
+  EXPECT_EQ(BENCHMARK_EVENTS, cues);
+
+  RecordProperty("events", BENCHMARK_EVENTS);
+  RecordProperty("open_us", static_cast<int>(openTime));
+}
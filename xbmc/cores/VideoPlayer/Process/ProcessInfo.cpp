@@ -295,6 +295,15 @@ CVideoBufferManager& CProcessInfo::GetVideoBufferManager()
   return m_videoBufferManager;
 }
 
+void CProcessInfo::UpdateVideoBufferStats()
+{
+  if (m_dataCache)
+  {
+    const CVideoBufferSlabAllocator::Stats stats = CVideoBufferSlabAllocator::GetInstance().GetStats();
+    m_dataCache->SetVideoBufferStats(stats.allocatedBytes, stats.usedBytes, stats.allocations, stats.reuses);
+  }
+}
+
 std::vector<AVPixelFormat> CProcessInfo::GetPixFormats()
 {
   CSingleLock lock(m_videoCodecSection);
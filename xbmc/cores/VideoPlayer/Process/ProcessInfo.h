@@ -57,6 +57,7 @@ public:
   void SetDeinterlacingMethodDefault(EINTERLACEMETHOD method);
   EINTERLACEMETHOD GetDeinterlacingMethodDefault();
   CVideoBufferManager& GetVideoBufferManager();
+  void UpdateVideoBufferStats();
   std::vector<AVPixelFormat> GetPixFormats();
   void SetPixFormats(std::vector<AVPixelFormat> &formats);
 
@@ -9,9 +9,30 @@
 #include "VideoBuffer.h"
 
 #include "threads/SingleLock.h"
+#include "utils/MemUtils.h"
 
 #include <string.h>
 
+#if defined(TARGET_LINUX)
+#include <sys/mman.h>
+#endif
+
+namespace
+{
+// blocks of at least this size are backed by huge pages where available
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+// smaller blocks are rounded up to a multiple of this size
+constexpr size_t SIZE_CLASS_GRANULARITY = 64 * 1024;
+// the capacity of a block is stored in front of its data
+constexpr size_t BLOCK_HEADER_SIZE = CVideoBufferSlabAllocator::ALIGNMENT;
+
+uint8_t* AlignPlane(uint8_t* plane)
+{
+  constexpr uintptr_t mask = CVideoBufferSlabAllocator::ALIGNMENT - 1;
+  return reinterpret_cast<uint8_t*>((reinterpret_cast<uintptr_t>(plane) + mask) & ~mask);
+}
+}
+
 //-----------------------------------------------------------------------------
 // CVideoBuffer
 //-----------------------------------------------------------------------------
@@ -181,7 +202,7 @@ CVideoBufferSysMem::CVideoBufferSysMem(IVideoBufferPool &pool, int id, AVPixelFo
 
 CVideoBufferSysMem::~CVideoBufferSysMem()
 {
-  delete[] m_data;
+  CVideoBufferSlabAllocator::GetInstance().Release(m_data);
 }
 
 uint8_t* CVideoBufferSysMem::GetMemPtr()
@@ -251,9 +272,10 @@ void CVideoBufferSysMem::SetDimensions(int width, int height, const int (&stride
     m_image.planesize[2] = 0;
   }
 
+  // Alloc() reserves room to start every plane on an aligned address
   m_image.plane[0] = m_data;
-  m_image.plane[1] = m_data + m_image.planesize[0];
-  m_image.plane[2] = m_image.plane[1] + m_image.planesize[1];
+  m_image.plane[1] = AlignPlane(m_data + m_image.planesize[0]);
+  m_image.plane[2] = AlignPlane(m_image.plane[1] + m_image.planesize[1]);
 }
 
 void CVideoBufferSysMem::SetDimensions(int width, int height, const int (&strides)[YuvImage::MAX_PLANES], const int (&planeOffsets)[YuvImage::MAX_PLANES])
@@ -267,8 +289,177 @@ void CVideoBufferSysMem::SetDimensions(int width, int height, const int (&stride
 
 bool CVideoBufferSysMem::Alloc()
 {
-  m_data = new uint8_t[m_size];
-  return true;
+  m_data = CVideoBufferSlabAllocator::GetInstance().Acquire(m_size + (YuvImage::MAX_PLANES - 1) * CVideoBufferSlabAllocator::ALIGNMENT);
+  return m_data != nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// CVideoBufferSlabAllocator
+//-----------------------------------------------------------------------------
+
+CVideoBufferSlabAllocator::CVideoBufferSlabAllocator()
+{
+  for (int i = 0; i < CACHE_SLOTS; i++)
+  {
+    m_cache[i] = nullptr;
+    m_cacheCapacity[i] = 0;
+  }
+
+  m_users = 0;
+  m_allocatedBytes = 0;
+  m_usedBytes = 0;
+  m_peakUsedBytes = 0;
+  m_allocations = 0;
+  m_reuses = 0;
+}
+
+CVideoBufferSlabAllocator::~CVideoBufferSlabAllocator()
+{
+  Trim();
+}
+
+CVideoBufferSlabAllocator& CVideoBufferSlabAllocator::GetInstance()
+{
+  static CVideoBufferSlabAllocator allocator;
+  return allocator;
+}
+
+size_t CVideoBufferSlabAllocator::GetSizeClass(size_t size)
+{
+  const size_t total = size + BLOCK_HEADER_SIZE;
+  const size_t granularity = total >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : SIZE_CLASS_GRANULARITY;
+  return (total + granularity - 1) / granularity * granularity;
+}
+
+size_t CVideoBufferSlabAllocator::GetCapacity(uint8_t* data)
+{
+  return *reinterpret_cast<size_t*>(data - BLOCK_HEADER_SIZE);
+}
+
+uint8_t* CVideoBufferSlabAllocator::Acquire(size_t size)
+{
+  const size_t capacity = GetSizeClass(size);
+
+  uint8_t* data = nullptr;
+  for (int i = 0; i < CACHE_SLOTS && !data; i++)
+  {
+    if (m_cacheCapacity[i] != capacity || !m_cache[i].load(std::memory_order_relaxed))
+      continue;
+
+    uint8_t* cached = m_cache[i].exchange(nullptr);
+    if (!cached)
+      continue;
+
+    if (GetCapacity(cached) == capacity)
+    {
+      data = cached;
+      m_reuses++;
+    }
+    else
+    {
+      // stale hint, put the block back or drop it if the slot was taken meanwhile
+      uint8_t* expected = nullptr;
+      if (!m_cache[i].compare_exchange_strong(expected, cached))
+        Free(cached);
+      else
+        m_cacheCapacity[i] = GetCapacity(cached);
+    }
+  }
+
+  if (!data)
+  {
+    data = Allocate(capacity);
+    if (!data)
+      return nullptr;
+  }
+
+  const uint64_t used = m_usedBytes += capacity;
+  uint64_t peak = m_peakUsedBytes;
+  while (used > peak && !m_peakUsedBytes.compare_exchange_weak(peak, used))
+    ;
+
+  return data;
+}
+
+void CVideoBufferSlabAllocator::Release(uint8_t* data)
+{
+  if (!data)
+    return;
+
+  const uint64_t capacity = GetCapacity(data);
+  m_usedBytes -= capacity;
+
+  // don't keep more memory around than playback needed at its peak
+  if (m_users > 0 && m_allocatedBytes - m_usedBytes <= m_peakUsedBytes)
+  {
+    for (int i = 0; i < CACHE_SLOTS; i++)
+    {
+      uint8_t* expected = nullptr;
+      if (m_cache[i].compare_exchange_strong(expected, data))
+      {
+        m_cacheCapacity[i] = capacity;
+        return;
+      }
+    }
+  }
+
+  Free(data);
+}
+
+uint8_t* CVideoBufferSlabAllocator::Allocate(size_t capacity)
+{
+  const size_t alignment = capacity >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : ALIGNMENT;
+  uint8_t* block = static_cast<uint8_t*>(KODI::MEMORY::AlignedMalloc(capacity, alignment));
+  if (!block)
+    return nullptr;
+
+#if defined(TARGET_LINUX) && defined(MADV_HUGEPAGE)
+  if (capacity >= HUGE_PAGE_SIZE)
+    madvise(block, capacity, MADV_HUGEPAGE);
+#endif
+
+  *reinterpret_cast<size_t*>(block) = capacity;
+  m_allocatedBytes += capacity;
+  m_allocations++;
+  return block + BLOCK_HEADER_SIZE;
+}
+
+void CVideoBufferSlabAllocator::Free(uint8_t* data)
+{
+  m_allocatedBytes -= GetCapacity(data);
+  KODI::MEMORY::AlignedFree(data - BLOCK_HEADER_SIZE);
+}
+
+void CVideoBufferSlabAllocator::Trim()
+{
+  for (auto& slot : m_cache)
+  {
+    uint8_t* data = slot.exchange(nullptr);
+    if (data)
+      Free(data);
+  }
+  m_peakUsedBytes = m_usedBytes.load();
+}
+
+void CVideoBufferSlabAllocator::AddUser()
+{
+  m_users++;
+}
+
+void CVideoBufferSlabAllocator::RemoveUser()
+{
+  if (--m_users == 0)
+    Trim();
+}
+
+CVideoBufferSlabAllocator::Stats CVideoBufferSlabAllocator::GetStats() const
+{
+  Stats stats;
+  stats.allocatedBytes = m_allocatedBytes;
+  stats.usedBytes = m_usedBytes;
+  stats.allocations = m_allocations;
+  stats.reuses = m_reuses;
+  return stats;
 }
 
 
@@ -378,6 +569,12 @@ CVideoBufferManager::CVideoBufferManager()
 {
   CSingleLock lock(m_critSection);
   RegisterPoolFactory("SysMem", &CVideoBufferPoolSysMem::CreatePool);
+  CVideoBufferSlabAllocator::GetInstance().AddUser();
+}
+
+CVideoBufferManager::~CVideoBufferManager()
+{
+  CVideoBufferSlabAllocator::GetInstance().RemoveUser();
 }
 
 void CVideoBufferManager::RegisterPool(std::shared_ptr<IVideoBufferPool> pool)
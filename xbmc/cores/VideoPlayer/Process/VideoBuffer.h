@@ -111,6 +111,68 @@ protected:
   std::shared_ptr<IVideoBufferPool> m_pool;
 };
 
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+
+/**
+ * Process wide cache of frame memory used by system memory video buffers.
+ *
+ * Blocks are 64 byte aligned and rounded up to a size class. Blocks of 2MB and
+ * above are aligned to and advised for huge pages where the platform supports it.
+ * Released blocks are kept for reuse by any pool, also across format changes,
+ * as long as a buffer manager exists and the cached memory does not exceed the
+ * peak memory in use. Acquiring and releasing cached blocks is lock-free.
+ */
+class CVideoBufferSlabAllocator
+{
+public:
+  struct Stats
+  {
+    uint64_t allocatedBytes; // total memory owned, in use and cached
+    uint64_t usedBytes; // memory handed out to buffers
+    uint64_t allocations; // blocks allocated from the system
+    uint64_t reuses; // blocks served from the cache
+  };
+
+  static CVideoBufferSlabAllocator& GetInstance();
+
+  uint8_t* Acquire(size_t size);
+  void Release(uint8_t* data);
+
+  // buffer managers register as users, the cache is emptied when the last one goes
+  void AddUser();
+  void RemoveUser();
+
+  Stats GetStats() const;
+
+  static const size_t ALIGNMENT = 64;
+
+protected:
+  CVideoBufferSlabAllocator();
+  ~CVideoBufferSlabAllocator();
+  static size_t GetSizeClass(size_t size);
+  static size_t GetCapacity(uint8_t* data);
+  uint8_t* Allocate(size_t capacity);
+  void Free(uint8_t* data);
+  void Trim();
+
+  static const int CACHE_SLOTS = 64;
+  std::atomic<uint8_t*> m_cache[CACHE_SLOTS];
+  // capacity of the block in the slot, only a hint as it is not updated atomically with the slot
+  std::atomic<size_t> m_cacheCapacity[CACHE_SLOTS];
+  std::atomic_int m_users;
+  std::atomic<uint64_t> m_allocatedBytes;
+  std::atomic<uint64_t> m_usedBytes;
+  std::atomic<uint64_t> m_peakUsedBytes;
+  std::atomic<uint64_t> m_allocations;
+  std::atomic<uint64_t> m_reuses;
+
+private:
+  CVideoBufferSlabAllocator(const CVideoBufferSlabAllocator&) = delete;
+  CVideoBufferSlabAllocator& operator=(const CVideoBufferSlabAllocator&) = delete;
+};
+
 class CVideoBufferSysMem : public CVideoBuffer
 {
 public:
@@ -173,6 +235,7 @@ class CVideoBufferManager
 {
 public:
   CVideoBufferManager();
+  ~CVideoBufferManager();
   void RegisterPool(std::shared_ptr<IVideoBufferPool> pool);
   void RegisterPoolFactory(std::string id, CreatePoolFunc createFunc);
   void ReleasePools();
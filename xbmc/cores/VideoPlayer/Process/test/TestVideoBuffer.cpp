@@ -0,0 +1,94 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/VideoPlayer/Process/VideoBuffer.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+// a 1080p frame in yuv420p
+const int FRAME_SIZE = 1920 * 1088 * 3 / 2;
+
+std::vector<CVideoBuffer*> GetBuffers(CVideoBufferManager& manager, AVPixelFormat format, int count)
+{
+  std::vector<CVideoBuffer*> buffers;
+  for (int i = 0; i < count; i++)
+    buffers.emplace_back(manager.Get(format, FRAME_SIZE, nullptr));
+  return buffers;
+}
+
+void ReleaseBuffers(std::vector<CVideoBuffer*>& buffers)
+{
+  for (auto buffer : buffers)
+    buffer->Release();
+  buffers.clear();
+}
+} // unnamed namespace
+
+TEST(TestVideoBuffer, PoolReusesMemoryOfReleasedPool)
+{
+  CVideoBufferSlabAllocator& allocator = CVideoBufferSlabAllocator::GetInstance();
+  CVideoBufferManager manager;
+
+  std::vector<CVideoBuffer*> buffers = GetBuffers(manager, AV_PIX_FMT_YUV420P, 4);
+  for (auto buffer : buffers)
+  {
+    ASSERT_NE(nullptr, buffer);
+    ASSERT_NE(nullptr, buffer->GetMemPtr());
+  }
+  const CVideoBufferSlabAllocator::Stats before = allocator.GetStats();
+  ReleaseBuffers(buffers);
+
+  // a new pool for another format, e.g. after the codec changed, takes the memory of the old one
+  manager.ReleasePools();
+  buffers = GetBuffers(manager, AV_PIX_FMT_NV12, 4);
+  const CVideoBufferSlabAllocator::Stats after = allocator.GetStats();
+
+  EXPECT_EQ(before.allocations, after.allocations);
+  EXPECT_EQ(before.reuses + 4, after.reuses);
+  EXPECT_EQ(before.allocatedBytes, after.allocatedBytes);
+  EXPECT_EQ(before.usedBytes, after.usedBytes);
+
+  ReleaseBuffers(buffers);
+  manager.ReleasePools();
+}
+
+TEST(TestVideoBuffer, CacheIsEmptiedWithLastManager)
+{
+  CVideoBufferSlabAllocator& allocator = CVideoBufferSlabAllocator::GetInstance();
+  const uint64_t allocatedBytes = allocator.GetStats().allocatedBytes;
+
+  {
+    CVideoBufferManager manager;
+    std::vector<CVideoBuffer*> buffers = GetBuffers(manager, AV_PIX_FMT_YUV420P, 2);
+    ReleaseBuffers(buffers);
+    manager.ReleasePools();
+
+    // the released blocks are kept while a manager is around
+    EXPECT_LT(allocatedBytes, allocator.GetStats().allocatedBytes);
+  }
+
+  EXPECT_EQ(allocatedBytes, allocator.GetStats().allocatedBytes);
+}
+
+TEST(TestVideoBuffer, BlocksAreAligned)
+{
+  CVideoBufferSlabAllocator& allocator = CVideoBufferSlabAllocator::GetInstance();
+
+  for (size_t size : {100, 70000, FRAME_SIZE, 4 * FRAME_SIZE})
+  {
+    uint8_t* data = allocator.Acquire(size);
+    ASSERT_NE(nullptr, data);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(data) % CVideoBufferSlabAllocator::ALIGNMENT) << size;
+    allocator.Release(data);
+  }
+}
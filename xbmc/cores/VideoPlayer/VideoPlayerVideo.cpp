@@ -12,11 +12,13 @@
 #include "DVDCodecs/DVDFactoryCodec.h"
 #include "DVDCodecs/Video/DVDVideoCodecFFmpeg.h"
 #include "ServiceBroker.h"
+#include "cores/DataCacheCore.h"
 #include "cores/VideoPlayer/Interface/Addon/DemuxPacket.h"
 #include "cores/VideoPlayer/Interface/Addon/TimingConstants.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/SettingsComponent.h"
 #include "utils/MathUtils.h"
+#include "utils/StringUtils.h"
 #include "utils/log.h"
 #include "windowing/GraphicContext.h"
 #include "windowing/WinSystem.h"
@@ -836,6 +838,8 @@ CVideoPlayerVideo::EOutputState CVideoPlayerVideo::OutputPicture(const VideoPict
     m_messageParent.Put(new CDVDMsg(CDVDMsg::PLAYER_AVCHANGE));
   }
 
+  m_processInfo.UpdateVideoBufferStats();
+
   double config_framerate = m_bFpsInvalid ? 0.0 : m_fFrameRate;
   if (m_processInfo.GetVideoInterlaced())
   {
@@ -945,6 +949,17 @@ std::string CVideoPlayerVideo::GetPlayerInfo()
   else
     s << ", pc:none";
 
+  // memory of the system memory video buffers, in use / owned, and the blocks served from the cache
+  CDataCacheCore& dataCache = CServiceBroker::GetDataCacheCore();
+  const uint64_t bufferBytes = dataCache.GetVideoBufferAllocatedBytes();
+  if (bufferBytes > 0)
+  {
+    s << ", buf:" << StringUtils::SizeToString(dataCache.GetVideoBufferUsedBytes());
+    s << "/" << StringUtils::SizeToString(bufferBytes);
+    s << " reused:" << dataCache.GetVideoBufferReuses();
+    s << "/" << dataCache.GetVideoBufferReuses() + dataCache.GetVideoBufferAllocations();
+  }
+
   return s.str();
 }
 
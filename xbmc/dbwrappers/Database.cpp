@@ -7,9 +7,11 @@
  */
 
 #include "Database.h"
+#include "DatabaseStats.h"
 #include "settings/AdvancedSettings.h"
 #include "filesystem/SpecialProtocol.h"
 #include "profiles/ProfileManager.h"
+#include "threads/SystemClock.h"
 #include "settings/SettingsComponent.h"
 #include "utils/log.h"
 #include "utils/SortUtils.h"
@@ -30,6 +32,8 @@
 using namespace dbiplus;
 
 #define MAX_COMPRESS_COUNT 20
+#define SLOW_FILTER_MS 100
+#define MAX_CACHED_STATEMENTS 64
 
 void CDatabase::Filter::AppendField(const std::string &strField)
 {
@@ -258,6 +262,50 @@ std::string CDatabase::PrepareSQL(std::string strStmt, ...) const
   return strResult;
 }
 
+std::shared_ptr<Statement> CDatabase::GetStatement(const std::string &sql) const
+{
+  if (nullptr == m_pDB || nullptr == m_statements)
+    return nullptr;
+
+  std::unique_ptr<Statement> statement;
+  auto it = m_statements->find(sql);
+  if (it != m_statements->end())
+  {
+    statement = std::move(it->second);
+    m_statements->erase(it);
+  }
+  else
+    statement.reset(m_pDB->CreateStatement(PrepareSQL(sql)));
+
+  // put the statement back into the cache when the caller is done with it, unless the
+  // connection has been closed in the meantime
+  std::weak_ptr<StatementCache> cache = m_statements;
+  return std::shared_ptr<Statement>(statement.release(), [cache, sql](Statement *released)
+  {
+    std::unique_ptr<Statement> statement(released);
+    std::shared_ptr<StatementCache> statements = cache.lock();
+    if (!statements || statements->size() >= MAX_CACHED_STATEMENTS)
+      return;
+
+    try
+    {
+      statement->reset();
+      statements->emplace(sql, std::move(statement));
+    }
+    catch (...)
+    {
+    }
+  });
+}
+
+std::unique_ptr<Statement> CDatabase::PrepareStatement(const std::string &sql) const
+{
+  if (nullptr == m_pDB)
+    return nullptr;
+
+  return std::unique_ptr<Statement>(m_pDB->CreateStatement(sql));
+}
+
 std::string CDatabase::GetSingleValue(const std::string &query, std::unique_ptr<Dataset> &ds)
 {
   std::string ret;
@@ -488,6 +536,8 @@ void CDatabase::DropAnalytics()
 
 bool CDatabase::Connect(const std::string &dbName, const DatabaseSettings &dbSettings, bool create)
 {
+  m_statements.reset();
+
   // create the appropriate database structure
   if (dbSettings.type == "sqlite3")
   {
@@ -528,9 +578,19 @@ bool CDatabase::Connect(const std::string &dbName, const DatabaseSettings &dbSet
                    dbSettings.ciphers.c_str(),
                    dbSettings.compression);
 
+  // collect query statistics if enabled
+  const std::shared_ptr<CAdvancedSettings> advancedSettings = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings();
+  if (advancedSettings->m_databaseStatsEnabled)
+  {
+    CDatabaseStats& stats = CDatabaseStats::GetInstance();
+    stats.Configure(advancedSettings->m_databaseSlowQueryThreshold, advancedSettings->m_databaseStatsLogInterval);
+    m_pDB->setQueryObserver(&stats);
+  }
+
   // create the datasets
   m_pDS.reset(m_pDB->CreateDataset());
   m_pDS2.reset(m_pDB->CreateDataset());
+  m_statements = std::make_shared<StatementCache>();
 
   if (m_pDB->connect(create) != DB_CONNECTION_OK)
     return false;
@@ -583,7 +643,7 @@ int CDatabase::GetDBVersion()
   return 0;
 }
 
-bool CDatabase::IsOpen()
+bool CDatabase::IsOpen() const
 {
   return m_openCount > 0;
 }
@@ -606,6 +666,7 @@ void CDatabase::Close()
     return;
   if (nullptr != m_pDS)
     m_pDS->close();
+  m_statements.reset();
   m_pDB->disconnect();
   m_pDB.reset();
   m_pDS.reset();
@@ -743,6 +804,50 @@ bool CDatabase::BuildSQL(const std::string &strQuery, const Filter &filter, std:
   return true;
 }
 
+void CDatabase::ExplainFilter(const std::string &table, const std::string &where)
+{
+  if (!m_sqlite || !m_pDB || table.empty() || where.empty() ||
+      !CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->CanLogComponent(LOGDATABASE))
+    return;
+
+  try
+  {
+    std::unique_ptr<Dataset> pDS(m_pDB->CreateDataset());
+    const std::string query = " FROM " + table + " WHERE " + where;
+
+    unsigned int time = XbmcThreads::SystemClockMillis();
+    if (!pDS->query("SELECT COUNT(1)" + query))
+      return;
+    const int rows = pDS->eof() ? 0 : pDS->fv(0).get_asInt();
+    pDS->close();
+    time = XbmcThreads::SystemClockMillis() - time;
+    if (time < SLOW_FILTER_MS)
+      return;
+
+    CLog::Log(LOGDEBUG, LOGDATABASE, "%s slow filter matching %d items of %s took %u ms: %s",
+              __FUNCTION__, rows, table.c_str(), time, where.c_str());
+
+    // the last column describes each step of the plan, full scans other than
+    // the one over the listed items themselves hint at a missing index
+    if (!pDS->query("EXPLAIN QUERY PLAN SELECT 1" + query))
+      return;
+    while (!pDS->eof())
+    {
+      const std::string detail = pDS->fv(pDS->fieldCount() - 1).get_asString();
+      const bool fullScan = StringUtils::StartsWith(detail, "SCAN") &&
+                            detail.find("INDEX") == std::string::npos;
+      CLog::Log(LOGDEBUG, LOGDATABASE, "%s   %s%s", __FUNCTION__, detail.c_str(),
+                fullScan ? " (full scan)" : "");
+      pDS->next();
+    }
+    pDS->close();
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed for %s", __FUNCTION__, table.c_str());
+  }
+}
+
 bool CDatabase::BuildSQL(const std::string &strBaseDir, const std::string &strQuery, Filter &filter, std::string &strSQL, CDbUrl &dbUrl)
 {
   SortDescription sorting;
@@ -11,8 +11,10 @@
 namespace dbiplus {
   class Database;
   class Dataset;
+  class Statement;
 }
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -94,7 +96,9 @@ public:
 
   CDatabase();
   virtual ~CDatabase(void);
-  bool IsOpen();
+  bool IsOpen() const;
+  /*! \brief Whether this is an SQLite database, as opposed to MySQL/MariaDB. */
+  bool IsSQLite() const { return m_sqlite; }
   virtual void Close();
   bool Compress(bool bForce=true);
   void Interrupt();
@@ -109,6 +113,25 @@ public:
 
   std::string PrepareSQL(std::string strStmt, ...) const;
 
+  /*! \brief Get a prepared statement for a query.
+   The query uses '?' as placeholders for the parameters bound to the statement and is
+   formatted like PrepareSQL, so a literal '%' has to be doubled. Statements are cached
+   per connection and handed back to the cache once released, so a query is only parsed
+   the first time. Statements must be released before the database is closed.
+   \param sql the query.
+   \return the statement, ready to bind parameters to, or nullptr if not connected.
+   \throws dbiplus::DbErrors if the query can't be prepared.
+   */
+  std::shared_ptr<dbiplus::Statement> GetStatement(const std::string &sql) const;
+
+  /*! \brief Prepare a statement for a query that is built for a single use, e.g. a listing.
+   Unlike GetStatement() the query is neither formatted nor cached.
+   \param sql the complete query.
+   \return the statement or nullptr if not connected.
+   \throws dbiplus::DbErrors if the query can't be prepared.
+   */
+  std::unique_ptr<dbiplus::Statement> PrepareStatement(const std::string &sql) const;
+
   /*!
    * @brief Get a single value from a table.
    * @remarks The values of the strWhereClause and strOrderBy parameters have to be FormatSQL'ed when used.
@@ -234,6 +257,14 @@ protected:
 
   bool BuildSQL(const std::string &strQuery, const Filter &filter, std::string &strSQL);
 
+  /*! \brief Log the query plan of a filter that is slow to evaluate.
+   Only done on SQLite with database debug logging enabled, as the filter has
+   to be evaluated an extra time to find out how long it takes.
+   \param table the table or view the filter is applied to
+   \param where the WHERE clause of the filter
+   */
+  void ExplainFilter(const std::string &table, const std::string &where);
+
   bool m_sqlite; ///< \brief whether we use sqlite (defaults to true)
 
   std::unique_ptr<dbiplus::Database> m_pDB;
@@ -248,6 +279,9 @@ private:
   void InitSettings(DatabaseSettings &dbSettings);
   void UpdateVersionNumber();
 
+  typedef std::map<std::string, std::unique_ptr<dbiplus::Statement>> StatementCache;
+  std::shared_ptr<StatementCache> m_statements; /*!< Prepared statements not in use, by query */
+
   bool m_bMultiWrite; /*!< True if there are any queries in the queue, false otherwise */
   unsigned int m_openCount;
 
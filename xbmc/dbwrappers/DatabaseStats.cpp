@@ -0,0 +1,285 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "DatabaseStats.h"
+
+#include "threads/SingleLock.h"
+#include "utils/StringUtils.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace
+{
+// distinct queries beyond this are counted together, e.g. if a query is built with its values
+const size_t MAX_QUERIES = 2000;
+const char* const OTHER_QUERIES = "<other>";
+
+double ToMillis(int64_t usecs)
+{
+  return usecs / 1000.0;
+}
+
+bool IsIdentifierChar(char c)
+{
+  return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.';
+}
+} // unnamed namespace
+
+CDatabaseStats& CDatabaseStats::GetInstance()
+{
+  static CDatabaseStats stats;
+  return stats;
+}
+
+void CDatabaseStats::Configure(unsigned int slowQueryThreshold, unsigned int logInterval)
+{
+  CSingleLock lock(m_critSection);
+  m_slowQueryThreshold = slowQueryThreshold;
+  m_logInterval = logInterval;
+}
+
+std::string CDatabaseStats::GetFingerprint(const std::string& sql)
+{
+  std::string normalized;
+  normalized.reserve(sql.size());
+
+  for (size_t i = 0; i < sql.size();)
+  {
+    const char c = sql[i];
+    if (c == '\'')
+    {
+      // string literal, with quotes escaped by doubling or by a backslash (MySQL)
+      for (++i; i < sql.size(); ++i)
+      {
+        if (sql[i] == '\\')
+          ++i;
+        else if (sql[i] == '\'')
+        {
+          if (i + 1 < sql.size() && sql[i + 1] == '\'')
+            ++i;
+          else
+            break;
+        }
+      }
+      ++i;
+      normalized += '?';
+    }
+    else if (std::isdigit(static_cast<unsigned char>(c)) &&
+             (normalized.empty() || !IsIdentifierChar(normalized.back())))
+    {
+      while (i < sql.size() && (std::isdigit(static_cast<unsigned char>(sql[i])) || sql[i] == '.'))
+        ++i;
+      normalized += '?';
+    }
+    else if (std::isspace(static_cast<unsigned char>(c)))
+    {
+      if (!normalized.empty() && normalized.back() != ' ')
+        normalized += ' ';
+      ++i;
+    }
+    else
+    {
+      normalized += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+      ++i;
+    }
+  }
+
+  if (!normalized.empty() && normalized.back() == ' ')
+    normalized.pop_back();
+
+  // collapse lists of values, so IN clauses of any length share their fingerprint
+  std::string fingerprint;
+  fingerprint.reserve(normalized.size());
+  for (size_t i = 0; i < normalized.size();)
+  {
+    if (normalized[i] == '(')
+    {
+      size_t j = i + 1;
+      unsigned int values = 0;
+      while (true)
+      {
+        while (j < normalized.size() && normalized[j] == ' ')
+          ++j;
+        if (j >= normalized.size() || normalized[j] != '?')
+          break;
+
+        ++values;
+        ++j;
+        while (j < normalized.size() && normalized[j] == ' ')
+          ++j;
+        if (j >= normalized.size() || normalized[j] != ',')
+          break;
+        ++j;
+      }
+
+      if (values > 1 && j < normalized.size() && normalized[j] == ')')
+      {
+        fingerprint += "(?+)";
+        i = j + 1;
+        continue;
+      }
+    }
+    fingerprint += normalized[i++];
+  }
+
+  return fingerprint;
+}
+
+size_t CDatabaseStats::GetBucket(int64_t usecs)
+{
+  if (usecs < 4)
+    return static_cast<size_t>(std::max<int64_t>(usecs, 0));
+
+  unsigned int exponent = 2;
+  while ((usecs >> (exponent + 1)) > 0)
+    ++exponent;
+
+  const size_t bucket = exponent * 4 + ((usecs >> (exponent - 2)) & 3);
+  return std::min(bucket, NUM_BUCKETS - 1);
+}
+
+int64_t CDatabaseStats::GetBucketLimit(size_t bucket)
+{
+  if (bucket < 4)
+    return static_cast<int64_t>(bucket);
+
+  const unsigned int exponent = bucket / 4;
+  return (static_cast<int64_t>(4 + bucket % 4 + 1) << (exponent - 2)) - 1;
+}
+
+int64_t CDatabaseStats::GetPercentile(const Entry& entry, unsigned int percent)
+{
+  if (entry.count == 0)
+    return 0;
+
+  const uint64_t target = (entry.count * percent + 99) / 100;
+  uint64_t count = 0;
+  for (size_t i = 0; i < NUM_BUCKETS; ++i)
+  {
+    count += entry.buckets[i];
+    if (count >= target)
+      return std::min(GetBucketLimit(i), entry.maxTime);
+  }
+  return entry.maxTime;
+}
+
+void CDatabaseStats::queryExecuted(dbiplus::Database* db,
+                                   const std::string& sql,
+                                   int64_t usecs,
+                                   int rows)
+{
+  const std::string fingerprint = GetFingerprint(sql);
+  const std::string database = db ? db->getDatabase() : "";
+
+  unsigned int slowQueryThreshold;
+  bool logSummary = false;
+  {
+    CSingleLock lock(m_critSection);
+
+    auto it = m_entries.find(std::make_pair(database, fingerprint));
+    if (it == m_entries.end())
+    {
+      if (m_entries.size() < MAX_QUERIES)
+        it = m_entries.emplace(std::make_pair(database, fingerprint), Entry()).first;
+      else
+        it = m_entries.emplace(std::make_pair(database, OTHER_QUERIES), Entry()).first;
+    }
+
+    Entry& entry = it->second;
+    entry.count++;
+    entry.rows += std::max(rows, 0);
+    entry.totalTime += usecs;
+    entry.maxTime = std::max(entry.maxTime, usecs);
+    entry.buckets[GetBucket(usecs)]++;
+
+    slowQueryThreshold = m_slowQueryThreshold;
+
+    const auto now = std::chrono::steady_clock::now();
+    if (m_logInterval > 0 && now - m_lastSummary >= std::chrono::seconds(m_logInterval))
+    {
+      m_lastSummary = now;
+      logSummary = true;
+    }
+  }
+
+  if (slowQueryThreshold > 0 && usecs >= slowQueryThreshold * static_cast<int64_t>(1000))
+  {
+    CLog::Log(LOGWARNING, "CDatabaseStats: slow query on %s took %.1f ms returning %d rows: %s",
+              database.c_str(), ToMillis(usecs), rows, sql.c_str());
+
+    if (db && (StringUtils::StartsWith(fingerprint, "select") ||
+               StringUtils::StartsWith(fingerprint, "with")))
+    {
+      const std::string plan = db->explain(sql);
+      if (!plan.empty())
+        CLog::Log(LOGWARNING, "CDatabaseStats: query plan:\n%s", plan.c_str());
+    }
+  }
+
+  if (logSummary)
+    LogSummary();
+}
+
+std::vector<CDatabaseStats::QueryStats> CDatabaseStats::GetStats(size_t limit /* = 0 */) const
+{
+  std::vector<QueryStats> stats;
+  {
+    CSingleLock lock(m_critSection);
+    stats.reserve(m_entries.size());
+    for (const auto& entry : m_entries)
+    {
+      QueryStats query;
+      query.database = entry.first.first;
+      query.fingerprint = entry.first.second;
+      query.count = entry.second.count;
+      query.rows = entry.second.rows;
+      query.totalTime = entry.second.totalTime;
+      query.maxTime = entry.second.maxTime;
+      query.p50Time = GetPercentile(entry.second, 50);
+      query.p99Time = GetPercentile(entry.second, 99);
+      stats.emplace_back(std::move(query));
+    }
+  }
+
+  std::sort(stats.begin(), stats.end(), [](const QueryStats& left, const QueryStats& right)
+  {
+    return left.totalTime > right.totalTime;
+  });
+
+  if (limit > 0 && stats.size() > limit)
+    stats.resize(limit);
+
+  return stats;
+}
+
+void CDatabaseStats::Reset()
+{
+  CSingleLock lock(m_critSection);
+  m_entries.clear();
+}
+
+void CDatabaseStats::LogSummary(size_t limit /* = 10 */) const
+{
+  const std::vector<QueryStats> stats = GetStats(limit);
+  if (stats.empty())
+    return;
+
+  CLog::Log(LOGINFO, "CDatabaseStats: queries taking the most time");
+  for (const auto& query : stats)
+  {
+    CLog::Log(LOGINFO,
+              "  %s: %llu times, total %.1f ms, p50 %.1f ms, p99 %.1f ms, max %.1f ms, "
+              "%llu rows: %s",
+              query.database.c_str(), static_cast<unsigned long long>(query.count),
+              ToMillis(query.totalTime), ToMillis(query.p50Time), ToMillis(query.p99Time),
+              ToMillis(query.maxTime), static_cast<unsigned long long>(query.rows),
+              query.fingerprint.c_str());
+  }
+}
@@ -0,0 +1,104 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "dataset.h"
+#include "threads/CriticalSection.h"
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*!
+ \ingroup database
+ \brief Collects the execution times of the queries run on the databases
+
+ Queries are grouped by their fingerprint, the query text with its literals
+ replaced by placeholders. Queries slower than a threshold are logged along
+ with their query plan and a summary of the most expensive queries is logged
+ periodically. Collection is enabled with the <databasestats> advancedsetting.
+ */
+class CDatabaseStats : public dbiplus::QueryObserver
+{
+public:
+  struct QueryStats
+  {
+    std::string database;
+    std::string fingerprint;
+    uint64_t count = 0;
+    uint64_t rows = 0;
+    int64_t totalTime = 0; ///< microseconds
+    int64_t maxTime = 0; ///< microseconds
+    int64_t p50Time = 0; ///< microseconds
+    int64_t p99Time = 0; ///< microseconds
+  };
+
+  CDatabaseStats() = default;
+  CDatabaseStats(const CDatabaseStats&) = delete;
+  CDatabaseStats& operator=(const CDatabaseStats&) = delete;
+  ~CDatabaseStats() override = default;
+
+  static CDatabaseStats& GetInstance();
+
+  /*! \brief Set how queries are reported.
+   \param slowQueryThreshold queries taking at least this many milliseconds are logged, 0 to disable.
+   \param logInterval seconds between two summaries in the log, 0 to disable.
+   */
+  void Configure(unsigned int slowQueryThreshold, unsigned int logInterval);
+
+  /*! \brief Get the collected statistics, the most expensive queries first.
+   \param limit the maximum number of queries to return, 0 for all.
+   */
+  std::vector<QueryStats> GetStats(size_t limit = 0) const;
+
+  void Reset();
+
+  /*! \brief Log the queries taking the most time in total.
+   */
+  void LogSummary(size_t limit = 10) const;
+
+  /*! \brief Get the fingerprint of a query, grouping queries differing only in their literals.
+   String and number literals are replaced by '?', lists of them by '(?+)'. Whitespace is
+   collapsed and the query is lowercased.
+   */
+  static std::string GetFingerprint(const std::string& sql);
+
+  // implementation of dbiplus::QueryObserver
+  void queryExecuted(dbiplus::Database* db,
+                     const std::string& sql,
+                     int64_t usecs,
+                     int rows) override;
+
+private:
+  // latencies are counted in buckets growing by a quarter of a power of two
+  static const size_t NUM_BUCKETS = 4 * 40;
+
+  struct Entry
+  {
+    uint64_t count = 0;
+    uint64_t rows = 0;
+    int64_t totalTime = 0;
+    int64_t maxTime = 0;
+    std::array<uint32_t, NUM_BUCKETS> buckets{};
+  };
+
+  static size_t GetBucket(int64_t usecs);
+  static int64_t GetBucketLimit(size_t bucket);
+  static int64_t GetPercentile(const Entry& entry, unsigned int percent);
+
+  mutable CCriticalSection m_critSection;
+  std::map<std::pair<std::string, std::string>, Entry> m_entries;
+  unsigned int m_slowQueryThreshold = 0;
+  unsigned int m_logInterval = 0;
+  std::chrono::steady_clock::time_point m_lastSummary = std::chrono::steady_clock::now();
+};
@@ -12,10 +12,13 @@
 
 #include "dataset.h"
 
+#include "utils/StringUtils.h"
 #include "utils/log.h"
 
 #include <algorithm>
 #include <cstring>
+#include <locale>
+#include <sstream>
 
 #ifndef __GNUC__
 #pragma warning (disable:4800)
@@ -35,12 +38,41 @@ Database::Database():
 {
   active = false;	// No connection yet
   compression = false;
+  observer = NULL;
 }
 
 Database::~Database() {
   disconnect();		// Disconnect if connected to database
 }
 
+std::string Database::explain(const std::string &sql) {
+  std::string plan;
+  QueryObserver *current = observer;
+  observer = NULL;
+  try {
+    std::unique_ptr<Dataset> ds(CreateDataset());
+    ds->query(explainQuery(sql));
+    while (!ds->eof()) {
+      std::string line;
+      for (int i = 0; i < ds->fieldCount(); i++) {
+        if (i > 0)
+          line += " | ";
+        line += ds->fv(i).get_asString();
+      }
+      if (!plan.empty())
+        plan += "\n";
+      plan += line;
+      ds->next();
+    }
+    ds->close();
+  }
+  catch (...) {
+    plan.clear();
+  }
+  observer = current;
+  return plan;
+}
+
 int Database::connectFull(const char *newHost, const char *newPort, const char *newDb, const char *newLogin,
                           const char *newPasswd, const char *newKey, const char *newCert, const char *newCA,
                           const char *newCApath, const char *newCiphers, bool newCompression) {
@@ -68,6 +100,10 @@ std::string Database::prepare(const char *format, ...)
   return result;
 }
 
+Statement *Database::CreateStatement(const std::string &sql) {
+  return new DatasetStatement(this, sql);
+}
+
 //************* Dataset implementation ***************
 
 Dataset::Dataset():
@@ -544,6 +580,154 @@ for (unsigned int i=0; i < fields_object->size(); i++)
 
 
 
+//************* Statement implementation ***************
+
+void Statement::getRecord(sql_record &record) {
+  const int columns = columnCount();
+  record.resize(columns);
+  std::string text;
+  for (int col = 0; col < columns; col++) {
+    field_value &value = record[col];
+    if (isNull(col)) {
+      value.set_asString("");
+      value.set_isNull();
+      continue;
+    }
+    // a value of a previous row may have been NULL, a field can't be unmarked
+    if (value.get_isNull())
+      value = field_value();
+    getString(col, text);
+    value.set_asString(text);
+  }
+}
+
+//************* DatasetStatement implementation ***************
+
+DatasetStatement::DatasetStatement(Database *newDb, const std::string &query):
+  Statement(query),
+  db(newDb),
+  ds(newDb->CreateDataset()),
+  executed(false),
+  row(-1)
+{
+}
+
+DatasetStatement::~DatasetStatement() = default;
+
+void DatasetStatement::setParam(int n, const std::string &value) {
+  if (n < 1)
+    throw DbErrors("Invalid parameter index %d for query: %s", n, sql.c_str());
+  if (params.size() < static_cast<size_t>(n))
+    params.resize(n, "NULL");
+  params[n - 1] = value;
+}
+
+void DatasetStatement::bind(int n, int64_t value) {
+  setParam(n, std::to_string(value));
+}
+
+void DatasetStatement::bind(int n, double value) {
+  std::ostringstream str;
+  str.imbue(std::locale::classic());
+  str.precision(17);
+  str << value;
+  setParam(n, str.str());
+}
+
+void DatasetStatement::bind(int n, const std::string &value) {
+  setParam(n, db->prepare("'%s'", value.c_str()));
+}
+
+void DatasetStatement::bindNull(int n) {
+  setParam(n, "NULL");
+}
+
+bool DatasetStatement::step() {
+  if (!executed) {
+    executed = true;
+    row = -1;
+
+    // substitute the parameters for the placeholders outside of quoted literals
+    std::string query;
+    query.reserve(sql.size());
+    size_t param = 0;
+    char quote = 0;
+    for (const char c : sql) {
+      if (quote) {
+        if (c == quote)
+          quote = 0;
+        query += c;
+      }
+      else if (c == '\'' || c == '"' || c == '`') {
+        quote = c;
+        query += c;
+      }
+      else if (c == '?') {
+        query += param < params.size() ? params[param] : "NULL";
+        param++;
+      }
+      else
+        query += c;
+    }
+
+    size_t start = query.find_first_not_of(" \t\r\n(");
+    if (start == std::string::npos ||
+        !(StringUtils::StartsWithNoCase(query.c_str() + start, "select") ||
+          StringUtils::StartsWithNoCase(query.c_str() + start, "with"))) {
+      ds->exec(query);
+      return false;
+    }
+
+    ds->query(query);
+  }
+
+  const int rows = static_cast<int>(ds->get_result_set().records.size());
+  if (row < rows)
+    row++;
+  return row < rows;
+}
+
+void DatasetStatement::reset() {
+  ds->close();
+  params.clear();
+  texts.clear();
+  executed = false;
+  row = -1;
+}
+
+int DatasetStatement::columnCount() {
+  return static_cast<int>(ds->get_result_set().record_header.size());
+}
+
+const field_value &DatasetStatement::value(int col) {
+  const result_set &result = ds->get_result_set();
+  if (row < 0 || row >= static_cast<int>(result.records.size()))
+    throw DbErrors("No current row for query: %s", sql.c_str());
+  if (col < 0 || col >= static_cast<int>(result.records[row]->size()))
+    throw DbErrors("Invalid column %d for query: %s", col, sql.c_str());
+  return result.records[row]->at(col);
+}
+
+bool DatasetStatement::isNull(int col) {
+  return value(col).get_isNull();
+}
+
+int64_t DatasetStatement::getInt64(int col) {
+  return value(col).get_asInt64();
+}
+
+double DatasetStatement::getDouble(int col) {
+  return value(col).get_asDouble();
+}
+
+const char *DatasetStatement::getText(int col) {
+  const field_value &val = value(col);
+  if (texts.size() <= static_cast<size_t>(col))
+    texts.resize(col + 1);
+  texts[col] = val.get_asString();
+  return texts[col].c_str();
+}
+
 //************* DbErrors implementation ***************
 
 DbErrors::DbErrors():
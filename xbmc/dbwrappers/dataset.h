@@ -14,15 +14,20 @@
 
 #include "qry_dat.h"
 
+#include <chrono>
 #include <cstdio>
 #include <list>
 #include <map>
+#include <memory>
 #include <stdarg.h>
+#include <stdint.h>
 #include <string>
 #include <vector>
 
 namespace dbiplus {
 class Dataset;		// forward declaration of class Dataset
+class Statement;	// forward declaration of class Statement
+class QueryObserver;	// forward declaration of class QueryObserver
 
 
 #define S_NO_CONNECTION "No active connection";
@@ -55,6 +60,7 @@ protected:
     sequence_table, //Sequence table for nextid
     default_charset, //Default character set
     key, cert, ca, capath, ciphers; //SSL - Encryption info
+  QueryObserver *observer; // receives the duration of executed queries
 
 public:
 /* constructor */
@@ -62,6 +68,9 @@ public:
 /* destructor */
   virtual ~Database();
   virtual Dataset *CreateDataset() const = 0;
+/* creates a prepared statement for a query with '?' as parameter placeholders,
+   the default implementation substitutes the parameters into the query text */
+  virtual Statement *CreateStatement(const std::string &sql);
 /* sets a new host name */
   virtual void setHostName(const char *newHost) { host = newHost; }
 /* gets a host name */
@@ -150,6 +159,72 @@ public:
 
   virtual bool in_transaction() {return false;};
 
+/* methods for query instrumentation */
+
+/* sets the observer being told about every executed query, NULL to disable */
+  void setQueryObserver(QueryObserver *newObserver) { observer = newObserver; }
+  QueryObserver *getQueryObserver() const { return observer; }
+
+  /*! \brief Get the query plan of a SELECT query, one line per row of the plan.
+   The query isn't reported to the observer.
+   \param sql - the query to explain.
+   \return the query plan or an empty string if it can't be retrieved.
+   */
+  std::string explain(const std::string &sql);
+
+protected:
+/* query returning the plan of a query */
+  virtual std::string explainQuery(const std::string &sql) { return "EXPLAIN " + sql; }
+};
+
+
+
+/***************** Class QueryObserver definition *******************
+
+  receives the duration of every query executed on the databases
+  it's set on, e.g. to collect statistics
+
+******************************************************************/
+class QueryObserver {
+public:
+  virtual ~QueryObserver() = default;
+
+/* called after a query was executed, with its duration in microseconds
+   and the number of rows it returned */
+  virtual void queryExecuted(Database *db, const std::string &sql, int64_t usecs, int rows) = 0;
+};
+
+
+
+/******************* Class QueryTimer definition ********************
+
+  measures the lifetime of a scope executing a query and reports it
+  to the observer of the database, if any
+
+******************************************************************/
+class QueryTimer {
+  Database *db;
+  const std::string &sql;
+  std::chrono::steady_clock::time_point start;
+  int rows;
+
+public:
+  QueryTimer(Database *newDb, const std::string &query) : db(newDb), sql(query), rows(0) {
+    if (db && db->getQueryObserver())
+      start = std::chrono::steady_clock::now();
+  }
+  ~QueryTimer() {
+    if (db && db->getQueryObserver())
+      db->getQueryObserver()->queryExecuted(db, sql,
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count(), rows);
+  }
+
+/* sets the number of rows returned by the query */
+  void setRows(int n) { rows = n; }
+
+ private:
+  QueryTimer(const QueryTimer&) = delete;
+  QueryTimer& operator=(const QueryTimer&) = delete;
 };
 
 
@@ -476,6 +551,110 @@ public:
 
 
 
+/******************* Class Statement definition *******************
+
+  a query prepared once and executed any number of times with
+  different parameters, bound to the '?' placeholders of the query.
+  The statement is a forward-only cursor over the rows of its result:
+  step() moves to the next row, whose columns are read directly
+  without building a result set first.
+
+******************************************************************/
+class Statement {
+protected:
+  std::string sql;
+
+public:
+/* constructor */
+  explicit Statement(const std::string &query) : sql(query) {}
+/* destructor */
+  virtual ~Statement() = default;
+
+/* retrieves the query string */
+  const std::string &getSql() const { return sql; }
+
+/* bind a value to the parameter 'n' (starting with 1) */
+  virtual void bind(int n, int value) { bind(n, static_cast<int64_t>(value)); }
+  virtual void bind(int n, int64_t value) = 0;
+  virtual void bind(int n, double value) = 0;
+  virtual void bind(int n, const std::string &value) = 0;
+  virtual void bind(int n, const char *value) { bind(n, std::string(value)); }
+  virtual void bindNull(int n) = 0;
+
+/* executes the statement on the first call and moves to the next row of
+   its result on the following ones, returns false when there is no more row */
+  virtual bool step() = 0;
+/* executes a statement without results */
+  virtual void exec() { while (step()); }
+/* makes the statement ready for the next execution, clearing its parameters */
+  virtual void reset() = 0;
+
+/* Number of columns of the result */
+  virtual int columnCount() = 0;
+/* column values of the current row (starting with 0) */
+  virtual bool isNull(int col) = 0;
+  virtual int getInt(int col) { return static_cast<int>(getInt64(col)); }
+  virtual int64_t getInt64(int col) = 0;
+  virtual double getDouble(int col) = 0;
+/* text of a column, valid until the next call to step() or reset() */
+  virtual const char *getText(int col) = 0;
+/* copies the text of a column into 'value', reusing its memory */
+  virtual void getString(int col, std::string &value) { value.assign(getText(col)); }
+  std::string getString(int col) { return getText(col); }
+/* copies the current row into 'record' the way a Dataset stores it, as strings with
+   NULL values marked, reusing the memory of the row read into it before */
+  void getRecord(sql_record &record);
+
+ private:
+  Statement(const Statement&) = delete;
+  Statement& operator=(const Statement&) = delete;
+};
+
+
+
+/***************** Class DatasetStatement definition ****************
+
+  a statement for databases without prepared statements, which
+  substitutes the parameters into the query text and runs it on a
+  dataset of the database
+
+******************************************************************/
+class DatasetStatement : public Statement {
+protected:
+  Database *db;
+  std::unique_ptr<Dataset> ds;
+  std::vector<std::string> params; // parameters formatted as SQL literals
+  std::vector<std::string> texts; // text of the columns of the current row
+  bool executed;
+  int row;
+
+  void setParam(int n, const std::string &value);
+  const field_value &value(int col);
+
+public:
+/* constructor */
+  DatasetStatement(Database *newDb, const std::string &query);
+/* destructor */
+  ~DatasetStatement() override;
+
+  using Statement::bind;
+  void bind(int n, int64_t value) override;
+  void bind(int n, double value) override;
+  void bind(int n, const std::string &value) override;
+  void bindNull(int n) override;
+
+  bool step() override;
+  void reset() override;
+
+  int columnCount() override;
+  bool isNull(int col) override;
+  int64_t getInt64(int col) override;
+  double getDouble(int col) override;
+  const char *getText(int col) override;
+};
+
+
+
 /******************** Class DbErrors definition *********************
 
 			   error handling
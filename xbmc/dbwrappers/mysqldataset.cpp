@@ -1499,6 +1499,7 @@ static size_t ci_find(const std::string& where, const std::string& what)
 
 int MysqlDataset::exec(const std::string &sql) {
   if (!handle()) throw DbErrors("No Database Connection");
+  QueryTimer timer(db, sql);
   std::string qry = sql;
   int res = 0;
   exec_res.clear();
@@ -1557,6 +1558,8 @@ bool MysqlDataset::query(const std::string &query) {
 
   close();
 
+  QueryTimer timer(db, query);
+
   size_t loc;
 
   // mysql doesn't understand CAST(foo as integer) => change to CAST(foo as signed integer)
@@ -1640,6 +1643,7 @@ bool MysqlDataset::query(const std::string &query) {
     result.records.push_back(res);
   }
   mysql_free_result(stmt);
+  timer.setRows(static_cast<int>(result.records.size()));
   active = true;
   ds_state = dsSelect;
   this->first();
@@ -10,6 +10,7 @@
  *  See LICENSES/README.md for more information.
  */
 
+#include <chrono>
 #include <iostream>
 #include <map>
 #include <string>
@@ -227,6 +228,10 @@ Dataset* SqliteDatabase::CreateDataset() const {
   return new SqliteDataset(const_cast<SqliteDatabase*>(this));
 }
 
+Statement* SqliteDatabase::CreateStatement(const std::string &sql) {
+  return new SqliteStatement(this, sql);
+}
+
 void SqliteDatabase::setHostName(const char *newHost) {
   host = newHost;
 
@@ -717,6 +722,7 @@ bool SqliteDataset::dropIndex(const char *table, const char *index)
 
 int SqliteDataset::exec(const std::string &sql) {
   if (!handle()) throw DbErrors("No Database Connection");
+  QueryTimer timer(db, sql);
   std::string qry = sql;
   int res;
   exec_res.clear();
@@ -789,6 +795,8 @@ bool SqliteDataset::query(const std::string &query) {
 
   close();
 
+  QueryTimer timer(db, query);
+
   sqlite3_stmt *stmt = NULL;
   if (db->setErr(sqlite3_prepare_v2(handle(),query.c_str(),-1,&stmt, NULL),query.c_str()) != SQLITE_OK)
     throw DbErrors("%s", db->getErrorMsg());
@@ -830,6 +838,7 @@ bool SqliteDataset::query(const std::string &query) {
     }
     result.records.push_back(res);
   }
+  timer.setRows(static_cast<int>(result.records.size()));
   if (db->setErr(sqlite3_finalize(stmt),query.c_str()) == SQLITE_OK)
   {
     active = true;
@@ -951,4 +960,132 @@ long SqliteDataset::nextid(const char *seq_name) {
 void SqliteDataset::interrupt() {
   sqlite3_interrupt(handle());
 }
+
+
+//************* SqliteStatement implementation ***************
+
+SqliteStatement::SqliteStatement(SqliteDatabase *newDb, const std::string &query):
+  Statement(query),
+  db(newDb),
+  stmt(NULL),
+  done(false),
+  executed(false),
+  usecs(0),
+  rows(0)
+{
+  if (!db->getHandle()) throw DbErrors("No Database Connection");
+  if (db->setErr(sqlite3_prepare_v2(db->getHandle(), sql.c_str(), -1, &stmt, NULL), sql.c_str()) != SQLITE_OK)
+  {
+    sqlite3_finalize(stmt);
+    stmt = NULL;
+    throw DbErrors("%s", db->getErrorMsg());
+  }
+}
+
+SqliteStatement::~SqliteStatement() {
+  report();
+  sqlite3_finalize(stmt);
+}
+
+void SqliteStatement::check(int res) {
+  if (res != SQLITE_OK && db->setErr(res, sql.c_str()) != SQLITE_OK)
+    throw DbErrors("%s", db->getErrorMsg());
+}
+
+void SqliteStatement::report() {
+  if (executed && db->getQueryObserver())
+    db->getQueryObserver()->queryExecuted(db, sql, usecs, rows);
+  executed = false;
+  usecs = 0;
+  rows = 0;
+}
+
+void SqliteStatement::bind(int n, int64_t value) {
+  check(sqlite3_bind_int64(stmt, n, value));
+}
+
+void SqliteStatement::bind(int n, double value) {
+  check(sqlite3_bind_double(stmt, n, value));
+}
+
+void SqliteStatement::bind(int n, const std::string &value) {
+  check(sqlite3_bind_text(stmt, n, value.c_str(), static_cast<int>(value.size()), SQLITE_TRANSIENT));
+}
+
+void SqliteStatement::bindNull(int n) {
+  check(sqlite3_bind_null(stmt, n));
+}
+
+bool SqliteStatement::step() {
+  // stepping on would run the statement again
+  if (done)
+    return false;
+
+  // the rows are read while stepping, so the time of all steps makes up the query time
+  const bool timed = db->getQueryObserver() != NULL;
+  std::chrono::steady_clock::time_point start;
+  if (timed)
+    start = std::chrono::steady_clock::now();
+
+  const int res = sqlite3_step(stmt);
+
+  executed = true;
+  if (timed)
+    usecs += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+  if (res == SQLITE_ROW)
+  {
+    rows++;
+    return true;
+  }
+
+  done = true;
+  if (res != SQLITE_DONE)
+  {
+    db->setErr(res, sql.c_str());
+    throw DbErrors("%s", db->getErrorMsg());
+  }
+  return false;
+}
+
+void SqliteStatement::reset() {
+  // the error of a failed step is reported by sqlite3_reset as well, it has been thrown already
+  report();
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+  done = false;
+}
+
+int SqliteStatement::columnCount() {
+  return sqlite3_column_count(stmt);
+}
+
+bool SqliteStatement::isNull(int col) {
+  return sqlite3_column_type(stmt, col) == SQLITE_NULL;
+}
+
+int SqliteStatement::getInt(int col) {
+  return sqlite3_column_int(stmt, col);
+}
+
+int64_t SqliteStatement::getInt64(int col) {
+  return sqlite3_column_int64(stmt, col);
+}
+
+double SqliteStatement::getDouble(int col) {
+  return sqlite3_column_double(stmt, col);
+}
+
+const char *SqliteStatement::getText(int col) {
+  const char *text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, col));
+  return text ? text : "";
+}
+
+void SqliteStatement::getString(int col, std::string &value) {
+  const char *text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, col));
+  if (text)
+    value.assign(text, sqlite3_column_bytes(stmt, col));
+  else
+    value.clear();
+}
 }//namespace
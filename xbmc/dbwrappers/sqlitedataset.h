@@ -38,6 +38,7 @@ public:
   ~SqliteDatabase() override;
 
   Dataset *CreateDataset() const override;
+  Statement *CreateStatement(const std::string &sql) override;
 
 /* func. returns connection handle with SQLite-server */
   sqlite3 *getHandle() {  return conn; }
@@ -82,6 +83,8 @@ public:
 
   bool in_transaction() override {return _in_transaction;};
 
+protected:
+  std::string explainQuery(const std::string &sql) override { return "EXPLAIN QUERY PLAN " + sql; }
 };
 
 
@@ -158,5 +161,50 @@ or insert() operations default = false) */
 
   bool dropIndex(const char *table, const char *index) override;
 };
+
+
+
+/***************** Class SqliteStatement definition *****************
+
+       class 'SqliteStatement' is a statement prepared by SQLite,
+       stepping through its result row by row
+
+******************************************************************/
+
+class SqliteStatement : public Statement {
+protected:
+  SqliteDatabase *db;
+  sqlite3_stmt *stmt;
+  bool done;  // true when the last row has been stepped over
+  bool executed;  // true when stepped since the last reset
+  int64_t usecs;  // time spent stepping, reported to the query observer
+  int rows;
+
+  void check(int res);
+  void report();
+
+public:
+/* constructor, throws DbErrors if the query can't be prepared */
+  SqliteStatement(SqliteDatabase *newDb, const std::string &query);
+/* destructor */
+  ~SqliteStatement() override;
+
+  using Statement::bind;
+  void bind(int n, int64_t value) override;
+  void bind(int n, double value) override;
+  void bind(int n, const std::string &value) override;
+  void bindNull(int n) override;
+
+  bool step() override;
+  void reset() override;
+
+  int columnCount() override;
+  bool isNull(int col) override;
+  int getInt(int col) override;
+  int64_t getInt64(int col) override;
+  double getDouble(int col) override;
+  const char *getText(int col) override;
+  void getString(int col, std::string &value) override;
+};
 } //namespace
 
@@ -0,0 +1,252 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "dbwrappers/Database.h"
+#include "dbwrappers/dataset.h"
+#include "filesystem/SpecialProtocol.h"
+#include "settings/AdvancedSettings.h"
+#include "test/TestUtils.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace dbiplus;
+
+namespace
+{
+const int ROWS = 10000;
+
+class CTestDatabase : public CDatabase
+{
+public:
+  int Rows() { return std::stoi(GetSingleValue("SELECT COUNT(1) FROM art")); }
+
+  // a statement substituting its parameters into the query, as used for MySQL
+  std::unique_ptr<Statement> CreateDatasetStatement(const std::string& sql)
+  {
+    return std::unique_ptr<Statement>(new DatasetStatement(m_pDB.get(), sql));
+  }
+
+  void SetQueryObserver(QueryObserver* observer) { m_pDB->setQueryObserver(observer); }
+  std::string Explain(const std::string& sql) { return m_pDB->explain(sql); }
+
+  std::string QueryUrl(int mediaId, const std::string& type)
+  {
+    m_pDS->query(PrepareSQL("SELECT url FROM art WHERE media_id=%i AND type='%s'", mediaId, type.c_str()));
+    std::string url;
+    if (!m_pDS->eof())
+      url = m_pDS->fv(0).get_asString();
+    m_pDS->close();
+    return url;
+  }
+
+protected:
+  void CreateTables() override
+  {
+    m_pDS->exec("CREATE TABLE art (art_id integer primary key, media_id integer, type text, url text, "
+                "weight double)");
+    m_pDS->exec(PrepareSQL("WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %i) "
+                           "INSERT INTO art SELECT i, i, 'thumb', 'special://thumbs/' || i || '.jpg', "
+                           "i / 4.0 FROM n",
+                           ROWS));
+    m_pDS->exec("INSERT INTO art VALUES (NULL, 1, 'fanart', 'it''s ? here', NULL)");
+  }
+
+  void CreateAnalytics() override
+  {
+    m_pDS->exec("CREATE INDEX ix_art ON art(media_id, type)");
+  }
+
+  int GetSchemaVersion() const override { return 1; }
+  const char* GetBaseDBName() const override { return "DatabaseTest"; }
+};
+
+class CQueryRecorder : public QueryObserver
+{
+public:
+  struct Query
+  {
+    std::string sql;
+    int rows;
+  };
+  std::vector<Query> queries;
+
+  void queryExecuted(Database* db, const std::string& sql, int64_t usecs, int rows) override
+  {
+    EXPECT_LE(0, usecs);
+    queries.push_back({sql, rows});
+  }
+};
+} // unnamed namespace
+
+class TestDatabase : public ::testing::Test
+{
+protected:
+  DatabaseSettings settings;
+  CTestDatabase database;
+
+  void SetUp() override
+  {
+    settings.type = "sqlite3";
+    settings.name = "dbwrappers";
+    settings.host = CSpecialProtocol::TranslatePath("special://temp/");
+
+    ASSERT_TRUE(database.Connect("dbwrappers", settings, true));
+  }
+
+  void TearDown() override
+  {
+    database.Close();
+  }
+};
+
+TEST_F(TestDatabase, Statement)
+{
+  std::shared_ptr<Statement> statement =
+    database.GetStatement("SELECT url, weight, media_id FROM art WHERE media_id=? ORDER BY art_id");
+  ASSERT_NE(nullptr, statement);
+
+  statement->bind(1, 1);
+  ASSERT_TRUE(statement->step());
+  EXPECT_EQ(3, statement->columnCount());
+  EXPECT_STREQ("special://thumbs/1.jpg", statement->getText(0));
+  EXPECT_DOUBLE_EQ(0.25, statement->getDouble(1));
+  EXPECT_EQ(1, statement->getInt(2));
+
+  ASSERT_TRUE(statement->step());
+  std::string url;
+  statement->getString(0, url);
+  EXPECT_EQ("it's ? here", url);
+  EXPECT_TRUE(statement->isNull(1));
+
+  EXPECT_FALSE(statement->step());
+  EXPECT_FALSE(statement->step());
+
+  statement->reset();
+  statement->bind(1, 2);
+  ASSERT_TRUE(statement->step());
+  EXPECT_EQ("special://thumbs/2.jpg", statement->getString(0));
+}
+
+TEST_F(TestDatabase, StatementCache)
+{
+  const std::string sql = "SELECT url FROM art WHERE media_id=?";
+
+  Statement* cached;
+  {
+    std::shared_ptr<Statement> statement = database.GetStatement(sql);
+    cached = statement.get();
+    statement->bind(1, 3);
+    EXPECT_TRUE(statement->step());
+  }
+
+  // a released statement is reset and reused
+  std::shared_ptr<Statement> statement = database.GetStatement(sql);
+  EXPECT_EQ(cached, statement.get());
+
+  // but one in use isn't handed out again
+  std::shared_ptr<Statement> nested = database.GetStatement(sql);
+  EXPECT_NE(cached, nested.get());
+
+  statement->bind(1, 4);
+  nested->bind(1, 5);
+  ASSERT_TRUE(statement->step());
+  ASSERT_TRUE(nested->step());
+  EXPECT_EQ("special://thumbs/4.jpg", statement->getString(0));
+  EXPECT_EQ("special://thumbs/5.jpg", nested->getString(0));
+}
+
+TEST_F(TestDatabase, DatasetStatement)
+{
+  std::unique_ptr<Statement> statement =
+    database.CreateDatasetStatement("SELECT url, weight FROM art WHERE media_id=? AND url<>'?' AND type=? ORDER BY art_id");
+
+  statement->bind(1, 1);
+  statement->bind(2, std::string("fanart"));
+  ASSERT_TRUE(statement->step());
+  EXPECT_EQ("it's ? here", statement->getString(0));
+  EXPECT_TRUE(statement->isNull(1));
+  EXPECT_FALSE(statement->step());
+
+  statement->reset();
+  statement->bind(1, 5);
+  statement->bind(2, std::string("thumb"));
+  ASSERT_TRUE(statement->step());
+  EXPECT_EQ("special://thumbs/5.jpg", statement->getString(0));
+  EXPECT_DOUBLE_EQ(1.25, statement->getDouble(1));
+
+  // the database is kept between runs, so only count the row added here
+  const int rows = database.Rows();
+  std::unique_ptr<Statement> insert =
+    database.CreateDatasetStatement("INSERT INTO art (media_id, type, url) VALUES (?, ?, ?)");
+  insert->bind(1, 6);
+  insert->bind(2, std::string("poster"));
+  insert->bind(3, std::string("it's"));
+  insert->exec();
+  EXPECT_EQ(rows + 1, database.Rows());
+}
+
+TEST_F(TestDatabase, QueryObserver)
+{
+  CQueryRecorder recorder;
+  database.SetQueryObserver(&recorder);
+
+  EXPECT_EQ("special://thumbs/7.jpg", database.QueryUrl(7, "thumb"));
+  ASSERT_EQ(1u, recorder.queries.size());
+  EXPECT_EQ(1, recorder.queries[0].rows);
+
+  // a statement is reported once its rows have been read
+  {
+    std::shared_ptr<Statement> statement = database.GetStatement("SELECT url FROM art WHERE media_id=?");
+    statement->bind(1, 1);
+    while (statement->step());
+    EXPECT_EQ(1u, recorder.queries.size());
+  }
+  ASSERT_EQ(2u, recorder.queries.size());
+  EXPECT_EQ("SELECT url FROM art WHERE media_id=?", recorder.queries[1].sql);
+  EXPECT_EQ(2, recorder.queries[1].rows);
+
+  // explaining a query doesn't report it
+  EXPECT_FALSE(database.Explain("SELECT url FROM art WHERE media_id=1").empty());
+  EXPECT_EQ(2u, recorder.queries.size());
+
+  database.SetQueryObserver(nullptr);
+  database.QueryUrl(7, "thumb");
+  EXPECT_EQ(2u, recorder.queries.size());
+}
+
+TEST_F(TestDatabase, Benchmark)
+{
+  CTestStopwatch stopwatch;
+  size_t queried = 0;
+  for (int i = 1; i <= ROWS; i++)
+    queried += database.QueryUrl(i, "thumb").size();
+  const int64_t queryTime = stopwatch.Lap();
+
+  size_t stepped = 0;
+  std::string url;
+  for (int i = 1; i <= ROWS; i++)
+  {
+    std::shared_ptr<Statement> statement = database.GetStatement("SELECT url FROM art WHERE media_id=? AND type=?");
+    statement->bind(1, i);
+    statement->bind(2, std::string("thumb"));
+    if (statement->step())
+    {
+      statement->getString(0, url);
+      stepped += url.size();
+    }
+  }
+  const int64_t statementTime = stopwatch.Lap();
+
+  EXPECT_EQ(queried, stepped);
+  RecordProperty("query_us", static_cast<int>(queryTime));
+  RecordProperty("statement_us", static_cast<int>(statementTime));
+}
@@ -0,0 +1,65 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "dbwrappers/DatabaseStats.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(TestDatabaseStats, Fingerprint)
+{
+  EXPECT_EQ("select * from movie where idmovie=?",
+            CDatabaseStats::GetFingerprint("SELECT * FROM movie WHERE idMovie=42"));
+  EXPECT_EQ("select idpath from path where strpath=?",
+            CDatabaseStats::GetFingerprint("  select idPath\n  from path where strPath='it''s \\' here'  "));
+  EXPECT_EQ("select c05 from movie where rating > ? and c05 in (?+)",
+            CDatabaseStats::GetFingerprint("select c05 from movie where rating > 7.5 and c05 in (1, 2,3)"));
+  EXPECT_EQ("insert into art (media_id, type) values (?+)",
+            CDatabaseStats::GetFingerprint("INSERT INTO art (media_id, type) VALUES (1, 'thumb')"));
+  EXPECT_EQ("select * from t where a in (?)",
+            CDatabaseStats::GetFingerprint("select * from t where a in ('x')"));
+  EXPECT_EQ(CDatabaseStats::GetFingerprint("select * from t where a in (1,2)"),
+            CDatabaseStats::GetFingerprint("select * from t where a in (1,2,3,4,5)"));
+}
+
+TEST(TestDatabaseStats, Percentiles)
+{
+  CDatabaseStats stats;
+  for (int i = 1; i <= 100; i++)
+    stats.queryExecuted(nullptr, "SELECT 1 FROM a WHERE b=" + std::to_string(i), i * 100, 2);
+  stats.queryExecuted(nullptr, "SELECT 1 FROM c", 1000000, 0);
+
+  const std::vector<CDatabaseStats::QueryStats> all = stats.GetStats();
+  ASSERT_EQ(2u, all.size());
+
+  // the most expensive query first
+  EXPECT_EQ("select ? from c", all[0].fingerprint);
+  EXPECT_EQ(1u, all[0].count);
+  EXPECT_EQ(1000000, all[0].p50Time);
+  EXPECT_EQ(1000000, all[0].maxTime);
+
+  const CDatabaseStats::QueryStats& query = all[1];
+  EXPECT_EQ("select ? from a where b=?", query.fingerprint);
+  EXPECT_EQ(100u, query.count);
+  EXPECT_EQ(200u, query.rows);
+  EXPECT_EQ(505000, query.totalTime);
+  EXPECT_EQ(10000, query.maxTime);
+
+  // percentiles are accurate to a quarter of a power of two
+  EXPECT_GE(query.p50Time, 5000);
+  EXPECT_LT(query.p50Time, 5000 * 1.2);
+  EXPECT_GE(query.p99Time, 9900);
+  EXPECT_LE(query.p99Time, 10000);
+
+  EXPECT_EQ(1u, stats.GetStats(1).size());
+
+  stats.Reset();
+  EXPECT_TRUE(stats.GetStats().empty());
+}
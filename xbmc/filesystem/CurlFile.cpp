@@ -7,6 +7,7 @@
  */
 
 #include "CurlFile.h"
+#include "Application.h"
 #include "ServiceBroker.h"
 #include "Util.h"
 #include "URL.h"
@@ -182,6 +183,7 @@ size_t CCurlFile::CReadState::ReadCallback(char *buffer, size_t size, size_t nit
 
 size_t CCurlFile::CReadState::WriteCallback(char *buffer, size_t size, size_t nitems)
 {
+  CSingleLock lock(m_overflowSection);
   unsigned int amount = size * nitems;
   if (m_overflowSize)
   {
@@ -205,6 +207,13 @@ size_t CCurlFile::CReadState::WriteCallback(char *buffer, size_t size, size_t ni
       // Shrink memory:
       m_overflowBuffer = (char*)realloc_simple(m_overflowBuffer, m_overflowSize);
     }
+
+    // the transfer thread doesn't wait for us, keep the data with curl until we've caught up
+    if (m_overflowSize && m_bTransfer)
+    {
+      m_isPaused = true;
+      return CURL_WRITEFUNC_PAUSE;
+    }
   }
   // ok, now copy the data into our ring buffer
   unsigned int maxWriteable = std::min(m_buffer.getMaxWriteSize(), amount);
@@ -233,6 +242,7 @@ size_t CCurlFile::CReadState::WriteCallback(char *buffer, size_t size, size_t ni
     memcpy(m_overflowBuffer + m_overflowSize, buffer, amount);
     m_overflowSize += amount;
   }
+  m_progress.Set();
   return size * nitems;
 }
 
@@ -242,6 +252,7 @@ CCurlFile::CReadState::CReadState()
   m_multiHandle = NULL;
   m_overflowBuffer = NULL;
   m_overflowSize = 0;
+  m_bTransfer = false;
   m_stillRunning = 0;
   m_filePos = 0;
   m_fileSize = 0;
@@ -329,12 +340,16 @@ long CCurlFile::CReadState::Connect(unsigned int size)
     CLog::Log(LOGDEBUG,"CurlFile::CReadState::Connect - Resume from position %" PRId64, m_filePos);
 
   SetResume();
-  g_curlInterface.multi_add_handle(m_multiHandle, m_easyHandle);
 
   m_bufferSize = size;
   m_buffer.Destroy();
   m_buffer.Create(size * 3);
   m_httpheader.Clear();
+  m_isPaused = false;
+
+  // the GUI thread doesn't wait for the other transfers to the host
+  m_bTransfer = true;
+  g_curlInterface.transfer_add(m_easyHandle, &m_progress, !g_application.IsCurrentThread());
 
   // read some data in to try and obtain the length
   // maybe there's a better way to get this info??
@@ -368,6 +383,11 @@ long CCurlFile::CReadState::Connect(unsigned int size)
 
 void CCurlFile::CReadState::Disconnect()
 {
+  if (m_bTransfer && m_easyHandle)
+    g_curlInterface.transfer_remove(m_easyHandle);
+  m_bTransfer = false;
+  m_isPaused = false;
+
   if(m_multiHandle && m_easyHandle)
     g_curlInterface.multi_remove_handle(m_multiHandle, m_easyHandle);
 
@@ -631,8 +651,15 @@ void CCurlFile::SetCommonOptions(CReadState* state, bool failOnError /* = true *
   if (CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_curlDisableHTTP2)
     g_curlInterface.easy_setopt(h, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
   else
+  {
     // enable HTTP2 support. default: CURL_HTTP_VERSION_1_1. Curl >= 7.62.0 defaults to CURL_HTTP_VERSION_2TLS
     g_curlInterface.easy_setopt(h, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2_0);
+#if LIBCURL_VERSION_NUM >= 0x072B00
+    // rather wait for a connection to the host that's being opened than open another one, reads
+    // are multiplexed on it if the host supports HTTP/2
+    g_curlInterface.easy_setopt(h, CURLOPT_PIPEWAIT, 1L);
+#endif
+  }
 }
 
 void CCurlFile::SetRequestHeaders(CReadState* state)
@@ -1573,9 +1600,9 @@ ssize_t CCurlFile::CReadState::Read(void* lpBuf, size_t uiBufSize)
 int8_t CCurlFile::CReadState::FillBuffer(unsigned int want)
 {
   int retry = 0;
-  fd_set fdread;
-  fd_set fdwrite;
-  fd_set fdexcep;
+
+  // keep the transfer thread reading ahead whenever there's room
+  FlushOverflow();
 
   // only attempt to fill buffer if transactions still running and buffer
   // doesnt exceed required size already
@@ -1585,117 +1612,98 @@ int8_t CCurlFile::CReadState::FillBuffer(unsigned int want)
       return FILLBUFFER_NO_DATA;
 
     /* if there is data in overflow buffer, try to use that first */
-    if (m_overflowSize)
-    {
-      unsigned amount = std::min(m_buffer.getMaxWriteSize(), m_overflowSize);
-      m_buffer.WriteData(m_overflowBuffer, amount);
-
-      if (amount < m_overflowSize)
-        memmove(m_overflowBuffer, m_overflowBuffer + amount, m_overflowSize - amount);
-
-      m_overflowSize -= amount;
-      // Shrink memory:
-      m_overflowBuffer = (char*)realloc_simple(m_overflowBuffer, m_overflowSize);
+    if (FlushOverflow())
       continue;
-    }
 
-    CURLMcode result = g_curlInterface.multi_perform(m_multiHandle, &m_stillRunning);
+    m_stillRunning = g_curlInterface.transfer_running(m_easyHandle) ? 1 : 0;
     if (!m_stillRunning)
     {
-      if (result == CURLM_OK)
+      /* if we still have stuff in buffer, we are fine */
+      if (m_buffer.getMaxReadSize())
+        return FILLBUFFER_OK;
+
+      // check for errors
+      CURLcode result;
+      bool bRetryNow = true;
+      bool bError = false;
+      if (g_curlInterface.transfer_result(m_easyHandle, result))
       {
-        /* if we still have stuff in buffer, we are fine */
-        if (m_buffer.getMaxReadSize())
+        if (result == CURLE_OK)
           return FILLBUFFER_OK;
 
-        // check for errors
-        int msgs;
-        CURLMsg* msg;
-        bool bRetryNow = true;
-        bool bError = false;
-        while ((msg = g_curlInterface.multi_info_read(m_multiHandle, &msgs)))
+        long httpCode = 0;
+        if (result == CURLE_HTTP_RETURNED_ERROR)
         {
-          if (msg->msg == CURLMSG_DONE)
-          {
-            if (msg->data.result == CURLE_OK)
-              return FILLBUFFER_OK;
-
-            long httpCode = 0;
-            if (msg->data.result == CURLE_HTTP_RETURNED_ERROR)
-            {
-              g_curlInterface.easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE, &httpCode);
-
-              // Don't log 404 not-found errors to prevent log-spam
-              if (httpCode != 404)
-                CLog::Log(LOGERROR, "CCurlFile::FillBuffer - Failed: HTTP returned error %ld", httpCode);
-            }
-            else
-            {
-              CLog::Log(LOGERROR, "CCurlFile::FillBuffer - Failed: %s(%d)", g_curlInterface.easy_strerror(msg->data.result), msg->data.result);
-            }
-
-            if ( (msg->data.result == CURLE_OPERATION_TIMEDOUT ||
-                  msg->data.result == CURLE_PARTIAL_FILE       ||
-                  msg->data.result == CURLE_COULDNT_CONNECT    ||
-                  msg->data.result == CURLE_RECV_ERROR)        &&
-                  !m_bFirstLoop)
-            {
-              bRetryNow = false; // Leave it to caller whether the operation is retried
-              bError = true;
-            }
-            else if ( (msg->data.result == CURLE_HTTP_RANGE_ERROR              ||
-                       httpCode == 416 /* = Requested Range Not Satisfiable */ ||
-                       httpCode == 406 /* = Not Acceptable (fixes issues with non compliant HDHomerun servers */) &&
-                       m_bFirstLoop                                   &&
-                       m_filePos == 0                                 &&
-                       m_sendRange)
-            {
-              // If server returns a (possible) range error, disable range and retry (handled below)
-              bRetryNow = true;
-              bError = true;
-              m_sendRange = false;
-            }
-            else
-            {
-              // For all other errors, abort the operation
-              return FILLBUFFER_FAIL;
-            }
-          }
+          g_curlInterface.easy_getinfo(m_easyHandle, CURLINFO_RESPONSE_CODE, &httpCode);
+
+          // Don't log 404 not-found errors to prevent log-spam
+          if (httpCode != 404)
+            CLog::Log(LOGERROR, "CCurlFile::FillBuffer - Failed: HTTP returned error %ld", httpCode);
+        }
+        else
+        {
+          CLog::Log(LOGERROR, "CCurlFile::FillBuffer - Failed: %s(%d)", g_curlInterface.easy_strerror(result), result);
         }
 
-        // Check for an actual error, if not, just return no-data
-        if (!bError && !m_bLastError)
-          return FILLBUFFER_NO_DATA;
+        if ( (result == CURLE_OPERATION_TIMEDOUT ||
+              result == CURLE_PARTIAL_FILE       ||
+              result == CURLE_COULDNT_CONNECT    ||
+              result == CURLE_RECV_ERROR)        &&
+              !m_bFirstLoop)
+        {
+          bRetryNow = false; // Leave it to caller whether the operation is retried
+          bError = true;
+        }
+        else if ( (result == CURLE_HTTP_RANGE_ERROR              ||
+                   httpCode == 416 /* = Requested Range Not Satisfiable */ ||
+                   httpCode == 406 /* = Not Acceptable (fixes issues with non compliant HDHomerun servers */) &&
+                   m_bFirstLoop                                   &&
+                   m_filePos == 0                                 &&
+                   m_sendRange)
+        {
+          // If server returns a (possible) range error, disable range and retry (handled below)
+          bRetryNow = true;
+          bError = true;
+          m_sendRange = false;
+        }
+        else
+        {
+          // For all other errors, abort the operation
+          return FILLBUFFER_FAIL;
+        }
+      }
 
-        // Close handle
-        if (m_multiHandle && m_easyHandle)
-          g_curlInterface.multi_remove_handle(m_multiHandle, m_easyHandle);
+      // Check for an actual error, if not, just return no-data
+      if (!bError && !m_bLastError)
+        return FILLBUFFER_NO_DATA;
 
-        // Reset all the stuff like we would in Disconnect()
-        m_buffer.Clear();
-        free(m_overflowBuffer);
-        m_overflowBuffer = NULL;
-        m_overflowSize = 0;
-        m_bLastError = true; // Flag error for the next run
+      // Close handle
+      g_curlInterface.transfer_remove(m_easyHandle);
 
-        // Retry immediately or leave it up to the caller?
-        if ((m_bRetry && retry < CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_curlretries) || (bRetryNow && retry == 0))
-        {
-          retry++;
+      // Reset all the stuff like we would in Disconnect()
+      m_buffer.Clear();
+      free(m_overflowBuffer);
+      m_overflowBuffer = NULL;
+      m_overflowSize = 0;
+      m_isPaused = false;
+      m_bLastError = true; // Flag error for the next run
 
-          // Connect + seek to current position (again)
-          SetResume();
-          g_curlInterface.multi_add_handle(m_multiHandle, m_easyHandle);
+      // Retry immediately or leave it up to the caller?
+      if ((m_bRetry && retry < CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_curlretries) || (bRetryNow && retry == 0))
+      {
+        retry++;
 
-          CLog::Log(LOGWARNING, "CCurlFile::FillBuffer - Reconnect, (re)try %i", retry);
+        // Connect + seek to current position (again)
+        SetResume();
+        g_curlInterface.transfer_add(m_easyHandle, &m_progress, !g_application.IsCurrentThread());
 
-          // Return to the beginning of the loop:
-          continue;
-        }
+        CLog::Log(LOGWARNING, "CCurlFile::FillBuffer - Reconnect, (re)try %i", retry);
 
-        return FILLBUFFER_NO_DATA; // We failed but flag no data to caller, so it can retry the operation
+        // Return to the beginning of the loop:
+        continue;
       }
-      return FILLBUFFER_FAIL;
+
+      return FILLBUFFER_NO_DATA; // We failed but flag no data to caller, so it can retry the operation
     }
 
     // We've finished out first loop
@@ -1705,92 +1713,45 @@ int8_t CCurlFile::CReadState::FillBuffer(unsigned int want)
     // No error this run
     m_bLastError = false;
 
-    switch (result)
-    {
-      case CURLM_OK:
-      {
-        int maxfd = -1;
-        FD_ZERO(&fdread);
-        FD_ZERO(&fdwrite);
-        FD_ZERO(&fdexcep);
+    // wait for the transfer thread to write more data or finish the transfer
+    if (m_buffer.getMaxReadSize() < want)
+      m_progress.WaitMSec(200);
+  }
+  return FILLBUFFER_OK;
+}
 
-        // get file descriptors from the transfers
-        g_curlInterface.multi_fdset(m_multiHandle, &fdread, &fdwrite, &fdexcep, &maxfd);
+bool CCurlFile::CReadState::FlushOverflow()
+{
+  bool resume = false;
+  {
+    CSingleLock lock(m_overflowSection);
+    if (!m_overflowSize)
+      return false;
 
-        long timeout = 0;
-        if (CURLM_OK != g_curlInterface.multi_timeout(m_multiHandle, &timeout) || timeout == -1 || timeout < 200)
-          timeout = 200;
+    unsigned amount = std::min(m_buffer.getMaxWriteSize(), m_overflowSize);
+    if (!amount)
+      return false;
 
-        XbmcThreads::EndTime endTime(timeout);
-        int rc;
+    m_buffer.WriteData(m_overflowBuffer, amount);
 
-        do
-        {
-          /* On success the value of maxfd is guaranteed to be >= -1. We call
-           * select(maxfd + 1, ...); specially in case of (maxfd == -1) there are
-           * no fds ready yet so we call select(0, ...) --or Sleep() on Windows--
-           * to sleep 100ms, which is the minimum suggested value in the
-           * curl_multi_fdset() doc.
-           */
-          if (maxfd == -1)
-          {
-#ifdef TARGET_WINDOWS
-            /* Windows does not support using select() for sleeping without a dummy
-             * socket. Instead use Windows' Sleep() and sleep for 100ms which is the
-             * minimum suggested value in the curl_multi_fdset() doc.
-             */
-            Sleep(100);
-            rc = 0;
-#else
-            /* Portable sleep for platforms other than Windows. */
-            struct timeval wait = { 0, 100 * 1000 }; /* 100ms */
-            rc = select(0, NULL, NULL, NULL, &wait);
-#endif
-          }
-          else
-          {
-            unsigned int time_left = endTime.MillisLeft();
-            struct timeval wait = { (int)time_left / 1000, ((int)time_left % 1000) * 1000 };
-            rc = select(maxfd + 1, &fdread, &fdwrite, &fdexcep, &wait);
-          }
-#ifdef TARGET_WINDOWS
-        } while(rc == SOCKET_ERROR && WSAGetLastError() == WSAEINTR);
-#else
-        } while(rc == SOCKET_ERROR && errno == EINTR);
-#endif
+    if (amount < m_overflowSize)
+      memmove(m_overflowBuffer, m_overflowBuffer + amount, m_overflowSize - amount);
 
-        if(rc == SOCKET_ERROR)
-        {
-#ifdef TARGET_WINDOWS
-          char buf[256];
-          strerror_s(buf, 256, WSAGetLastError());
-          CLog::Log(LOGERROR, "CCurlFile::FillBuffer - Failed with socket error:%s", buf);
-#else
-          char const * str = strerror(errno);
-          CLog::Log(LOGERROR, "CCurlFile::FillBuffer - Failed with socket error:%s", str);
-#endif
+    m_overflowSize -= amount;
+    // Shrink memory:
+    m_overflowBuffer = (char*)realloc_simple(m_overflowBuffer, m_overflowSize);
 
-          return FILLBUFFER_FAIL;
-        }
-      }
-      break;
-      case CURLM_CALL_MULTI_PERFORM:
-      {
-        // we don't keep calling here as that can easily overwrite our buffer which we want to avoid
-        // docs says we should call it soon after, but aslong as we are reading data somewhere
-        // this aught to be soon enough. should stay in socket otherwise
-        continue;
-      }
-      break;
-      default:
-      {
-        CLog::Log(LOGERROR, "CCurlFile::FillBuffer - Multi perform failed with code %d, aborting", result);
-        return FILLBUFFER_FAIL;
-      }
-      break;
+    // the transfer was paused while the buffers were full, there's room again
+    if (!m_overflowSize && m_isPaused && m_bTransfer)
+    {
+      m_isPaused = false;
+      resume = true;
     }
   }
-  return FILLBUFFER_OK;
+
+  if (resume)
+    g_curlInterface.transfer_resume(m_easyHandle);
+  return true;
 }
 
 void CCurlFile::CReadState::SetReadBuffer(const void* lpBuf, int64_t uiBufSize)
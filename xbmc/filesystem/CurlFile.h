@@ -9,6 +9,8 @@
 #pragma once
 
 #include "IFile.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
 #include "utils/HttpHeader.h"
 #include "utils/RingBuffer.h"
 
@@ -103,6 +105,9 @@ namespace XFILE
 
           char* m_overflowBuffer; // in the rare case we would overflow the above buffer
           unsigned int m_overflowSize; // size of the overflow buffer
+          CCriticalSection m_overflowSection; // the transfer thread writes while we read
+          CEvent m_progress; // set by the transfer thread whenever there's new data
+          bool m_bTransfer; // read by the transfer thread of g_curlInterface
           int m_stillRunning; // Is background url fetch still in progress
           bool m_cancelled;
           int64_t m_fileSize;
@@ -130,6 +135,7 @@ namespace XFILE
           ssize_t Read(void* lpBuf, size_t uiBufSize);
           bool ReadString(char *szLine, int iLineLength);
           int8_t FillBuffer(unsigned int want);
+          bool FlushOverflow();
           void SetReadBuffer(const void* lpBuf, int64_t uiBufSize);
 
           void SetResume(void);
@@ -8,12 +8,23 @@
 
 #include "DllLibCurl.h"
 
+#include "ServiceBroker.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/SettingsComponent.h"
 #include "threads/SingleLock.h"
 #include "threads/SystemClock.h"
 #include "utils/log.h"
 
+#include <algorithm>
 #include <assert.h>
 
+namespace
+{
+// a queued transfer starts after this long even if its host has no free slot, so a reader holding
+// several transfers of a host can't lock itself out
+const unsigned int MAX_QUEUE_TIME = 5000;
+} // unnamed namespace
+
 namespace XCURL
 {
 CURLcode DllLibCurl::global_init(long flags)
@@ -87,6 +98,23 @@ CURLMcode DllLibCurl::multi_timeout(CURLM* multi_handle, long* timeout)
   return curl_multi_timeout(multi_handle, timeout);
 }
 
+CURLMcode DllLibCurl::multi_wait(CURLM* multi_handle, int timeout_ms, int* numfds)
+{
+  return curl_multi_wait(multi_handle, nullptr, 0, timeout_ms, numfds);
+}
+
+#if LIBCURL_VERSION_NUM >= 0x074400
+CURLMcode DllLibCurl::multi_poll(CURLM* multi_handle, int timeout_ms, int* numfds)
+{
+  return curl_multi_poll(multi_handle, nullptr, 0, timeout_ms, numfds);
+}
+
+CURLMcode DllLibCurl::multi_wakeup(CURLM* multi_handle)
+{
+  return curl_multi_wakeup(multi_handle);
+}
+#endif
+
 CURLMsg* DllLibCurl::multi_info_read(CURLM* multi_handle, int* msgs_in_queue)
 {
   return curl_multi_info_read(multi_handle, msgs_in_queue);
@@ -112,6 +140,16 @@ const char* DllLibCurl::easy_strerror(CURLcode code)
   return curl_easy_strerror(code);
 }
 
+CURLSH* DllLibCurl::share_init()
+{
+  return curl_share_init();
+}
+
+CURLSHcode DllLibCurl::share_cleanup(CURLSH* share)
+{
+  return curl_share_cleanup(share);
+}
+
 #if defined(HAS_CURL_STATIC)
 void DllLibCurl::crypto_set_id_callback(unsigned long (*cb)())
 {
@@ -123,50 +161,398 @@ void DllLibCurl::crypto_set_locking_callback(void (*cb)(int, int, const char*, i
 }
 #endif
 
-DllLibCurlGlobal::DllLibCurlGlobal()
+DllLibCurlGlobal::DllLibCurlGlobal() : CThread("CurlTransfers")
 {
   /* we handle this ourself */
   if (curl_global_init(CURL_GLOBAL_ALL))
   {
     CLog::Log(LOGERROR, "Error initializing libcurl");
   }
+
+  // share DNS cache and TLS sessions between all handles. Connections are kept by
+  // the multi handle of the transfer thread, which is the only one using them
+  m_share = share_init();
+  if (m_share)
+  {
+    share_setopt(m_share, CURLSHOPT_LOCKFUNC, share_lock);
+    share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, share_unlock);
+    share_setopt(m_share, CURLSHOPT_USERDATA, this);
+    share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+  }
+  else
+    CLog::Log(LOGERROR, "Error initializing libcurl share handle");
+
+  m_multi = multi_init();
+  if (m_multi)
+  {
+#ifdef CURLPIPE_MULTIPLEX
+    // transfers to a HTTP/2 host are streams on one connection
+    multi_setopt(m_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
+  }
+  else
+    CLog::Log(LOGERROR, "Error initializing libcurl multi handle");
 }
 
 DllLibCurlGlobal::~DllLibCurlGlobal()
 {
+  // the transfer thread has to be done with the handles before they are closed
+  m_bStop = true;
+  WakeTransfers();
+  StopThread(true);
+
+  for (const auto& it : m_transfers)
+  {
+    if (it.m_state == TransferState::RUNNING)
+      multi_remove_handle(m_multi, it.m_easy);
+  }
+  m_transfers.clear();
+
+  // handles must be closed before the share handle they use
+  for (auto& it : m_sessions)
+  {
+    if (it.m_multi && it.m_easy)
+      multi_remove_handle(it.m_multi, it.m_easy);
+    if (it.m_easy)
+      easy_cleanup(it.m_easy);
+    if (it.m_multi)
+      multi_cleanup(it.m_multi);
+  }
+  m_sessions.clear();
+
+  if (m_multi)
+    multi_cleanup(m_multi);
+
+  if (m_share)
+    share_cleanup(m_share);
+
   // close libcurl
   curl_global_cleanup();
 }
 
-void DllLibCurlGlobal::CheckIdle()
+void DllLibCurlGlobal::share_lock(CURL_HANDLE* handle,
+                                  curl_lock_data data,
+                                  curl_lock_access access,
+                                  void* userptr)
+{
+  DllLibCurlGlobal* global = static_cast<DllLibCurlGlobal*>(userptr);
+  if (data >= 0 && data < CURL_LOCK_DATA_LAST)
+    global->m_shareSections[data].lock();
+}
+
+void DllLibCurlGlobal::share_unlock(CURL_HANDLE* handle, curl_lock_data data, void* userptr)
+{
+  DllLibCurlGlobal* global = static_cast<DllLibCurlGlobal*>(userptr);
+  if (data >= 0 && data < CURL_LOCK_DATA_LAST)
+    global->m_shareSections[data].unlock();
+}
+
+void DllLibCurlGlobal::CloseSession(SSession& session)
+{
+  CLog::Log(LOGINFO, "%s - Closing session to %s://%s (easy=%p, multi=%p)\n", __FUNCTION__,
+            session.m_protocol.c_str(), session.m_hostname.c_str(), static_cast<void*>(session.m_easy),
+            static_cast<void*>(session.m_multi));
+
+  if (session.m_multi && session.m_easy)
+    multi_remove_handle(session.m_multi, session.m_easy);
+  if (session.m_easy)
+    easy_cleanup(session.m_easy);
+  if (session.m_multi)
+    multi_cleanup(session.m_multi);
+}
+
+void DllLibCurlGlobal::AddStatistics(CURL_HANDLE* easy_handle)
+{
+  // handles released without performing a transfer have no response code
+  long responseCode = 0;
+  long connects = 0;
+  if (easy_getinfo(easy_handle, CURLINFO_RESPONSE_CODE, &responseCode) != CURLE_OK ||
+      responseCode == 0 ||
+      easy_getinfo(easy_handle, CURLINFO_NUM_CONNECTS, &connects) != CURLE_OK)
+    return;
+
+  m_statistics.m_transfers++;
+  if (connects == 0)
+    m_statistics.m_reused++;
+  m_statistics.m_connects += connects;
+}
+
+DllLibCurlGlobal::SStatistics DllLibCurlGlobal::GetStatistics()
 {
   CSingleLock lock(m_critSection);
-  /* 20 seconds idle time before closing handle */
-  const unsigned int idletime = 30000;
+  SStatistics statistics = m_statistics;
+
+  CSingleLock transferLock(m_transferSection);
+  statistics.m_queued = m_queued;
+  return statistics;
+}
+
+void DllLibCurlGlobal::CheckIdle()
+{
+  {
+    CSingleLock lock(m_critSection);
+    /* 20 seconds idle time before closing handle */
+    const unsigned int idletime = 30000;
+
+    VEC_CURLSESSIONS::iterator it = m_sessions.begin();
+    while (it != m_sessions.end())
+    {
+      if (!it->m_busy && (XbmcThreads::SystemClockMillis() - it->m_idletimestamp) > idletime)
+      {
+        CloseSession(*it);
+        it = m_sessions.erase(it);
+
+        if (m_sessions.empty())
+          CLog::Log(LOGDEBUG,
+                    "%s - %llu transfers, %llu reused a connection, %llu connections opened, "
+                    "%llu queued",
+                    __FUNCTION__, static_cast<unsigned long long>(m_statistics.m_transfers),
+                    static_cast<unsigned long long>(m_statistics.m_reused),
+                    static_cast<unsigned long long>(m_statistics.m_connects),
+                    static_cast<unsigned long long>(m_queued));
+        continue;
+      }
+      ++it;
+    }
+  }
 
-  VEC_CURLSESSIONS::iterator it = m_sessions.begin();
-  while (it != m_sessions.end())
+  // stop the transfer thread while nothing is read
+  CSingleLock threadLock(m_threadSection);
+  bool idle;
+  {
+    CSingleLock lock(m_transferSection);
+    idle = m_transfers.empty();
+  }
+  if (idle && IsRunning())
   {
-    if (!it->m_busy && (XbmcThreads::SystemClockMillis() - it->m_idletimestamp) > idletime)
+    m_bStop = true;
+    WakeTransfers();
+    StopThread(true);
+  }
+}
+
+void DllLibCurlGlobal::transfer_add(CURL_HANDLE* easy_handle, CEvent* progress, bool bQueue)
+{
+  STransfer transfer = {};
+  transfer.m_easy = easy_handle;
+  transfer.m_progress = progress;
+  transfer.m_state = TransferState::QUEUED;
+  transfer.m_queue = bQueue;
+  transfer.m_queuedtimestamp = XbmcThreads::SystemClockMillis();
+
+  {
+    CSingleLock lock(m_critSection);
+    for (const auto& it : m_sessions)
     {
-      CLog::Log(LOGINFO, "%s - Closing session to %s://%s (easy=%p, multi=%p)\n", __FUNCTION__,
-                it->m_protocol.c_str(), it->m_hostname.c_str(), static_cast<void*>(it->m_easy),
-                static_cast<void*>(it->m_multi));
-
-      if (it->m_multi && it->m_easy)
-        multi_remove_handle(it->m_multi, it->m_easy);
-      if (it->m_easy)
-        easy_cleanup(it->m_easy);
-      if (it->m_multi)
-        multi_cleanup(it->m_multi);
-
-      it = m_sessions.erase(it);
+      if (it.m_easy == easy_handle)
+      {
+        transfer.m_host = it.m_protocol + "://" + it.m_hostname;
+        break;
+      }
+    }
+  }
+
+  CSingleLock threadLock(m_threadSection);
+  {
+    CSingleLock lock(m_transferSection);
+    m_transfers.push_back(transfer);
+  }
+
+  if (!IsRunning())
+    Create();
+  WakeTransfers();
+}
+
+void DllLibCurlGlobal::transfer_remove(CURL_HANDLE* easy_handle)
+{
+  CSingleLock lock(m_transferSection);
+  auto it = FindTransfer(easy_handle);
+  if (it == m_transfers.end())
+    return;
+
+  if (it->m_state != TransferState::RUNNING)
+  {
+    m_transfers.erase(it);
+    return;
+  }
+
+  // only the transfer thread may use the multi handle, the easy handle can't be touched before
+  // it has been removed from it
+  it->m_remove = true;
+  WakeTransfers();
+  while (FindTransfer(easy_handle) != m_transfers.end())
+    m_transferRemoved.wait(lock);
+}
+
+void DllLibCurlGlobal::transfer_resume(CURL_HANDLE* easy_handle)
+{
+  CSingleLock lock(m_transferSection);
+  auto it = FindTransfer(easy_handle);
+  if (it != m_transfers.end() && it->m_state == TransferState::RUNNING)
+  {
+    it->m_resume = true;
+    WakeTransfers();
+  }
+}
+
+bool DllLibCurlGlobal::transfer_running(CURL_HANDLE* easy_handle)
+{
+  CSingleLock lock(m_transferSection);
+  auto it = FindTransfer(easy_handle);
+  return it != m_transfers.end() && it->m_state != TransferState::DONE;
+}
+
+bool DllLibCurlGlobal::transfer_result(CURL_HANDLE* easy_handle, CURLcode& result)
+{
+  CSingleLock lock(m_transferSection);
+  auto it = FindTransfer(easy_handle);
+  if (it == m_transfers.end() || !it->m_hasResult)
+    return false;
+
+  // like curl_multi_info_read() the result is only reported once
+  result = it->m_result;
+  it->m_hasResult = false;
+  return true;
+}
+
+std::list<DllLibCurlGlobal::STransfer>::iterator DllLibCurlGlobal::FindTransfer(
+    CURL_HANDLE* easy_handle)
+{
+  return std::find_if(m_transfers.begin(), m_transfers.end(),
+                      [easy_handle](const STransfer& transfer) {
+                        return transfer.m_easy == easy_handle;
+                      });
+}
+
+void DllLibCurlGlobal::Process()
+{
+  while (!m_bStop)
+  {
+    {
+      CSingleLock lock(m_transferSection);
+      StartTransfers();
+
+      int running = 0;
+      multi_perform(m_multi, &running);
+
+      FinishTransfers();
+    }
+    WaitTransfers();
+  }
+}
+
+void DllLibCurlGlobal::StartTransfers()
+{
+  int maxHostTransfers = 0;
+  if (CServiceBroker::GetSettingsComponent())
+    maxHostTransfers = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_curlMaxHostConnections;
+
+  auto it = m_transfers.begin();
+  while (it != m_transfers.end())
+  {
+    if (it->m_remove)
+    {
+      multi_remove_handle(m_multi, it->m_easy);
+      if (--m_hostTransfers[it->m_host] <= 0)
+        m_hostTransfers.erase(it->m_host);
+
+      it = m_transfers.erase(it);
+      m_transferRemoved.notifyAll();
       continue;
     }
+
+    if (it->m_state == TransferState::RUNNING && it->m_resume)
+    {
+      it->m_resume = false;
+      easy_pause(it->m_easy, CURLPAUSE_CONT);
+    }
+    else if (it->m_state == TransferState::QUEUED)
+    {
+      int& running = m_hostTransfers[it->m_host];
+      if (!it->m_queue || maxHostTransfers <= 0 || running < maxHostTransfers ||
+          XbmcThreads::SystemClockMillis() - it->m_queuedtimestamp >= MAX_QUEUE_TIME)
+      {
+        const CURLMcode result = multi_add_handle(m_multi, it->m_easy);
+        if (result == CURLM_OK)
+        {
+          it->m_state = TransferState::RUNNING;
+          running++;
+        }
+        else
+        {
+          CLog::Log(LOGERROR, "%s - Unable to start transfer to %s (%d)", __FUNCTION__,
+                    it->m_host.c_str(), result);
+          it->m_state = TransferState::DONE;
+          it->m_hasResult = true;
+          it->m_result = CURLE_FAILED_INIT;
+          it->m_progress->Set();
+        }
+      }
+      else if (!it->m_waited)
+      {
+        it->m_waited = true;
+        m_queued++;
+      }
+
+      if (running <= 0)
+        m_hostTransfers.erase(it->m_host);
+    }
     ++it;
   }
 }
 
+void DllLibCurlGlobal::FinishTransfers()
+{
+  int msgs;
+  CURLMsg* msg;
+  while ((msg = multi_info_read(m_multi, &msgs)))
+  {
+    if (msg->msg != CURLMSG_DONE)
+      continue;
+
+    // msg is gone once the handle is removed
+    CURL_HANDLE* easy = msg->easy_handle;
+    const CURLcode result = msg->data.result;
+    multi_remove_handle(m_multi, easy);
+
+    auto it = FindTransfer(easy);
+    if (it == m_transfers.end())
+      continue;
+
+    if (--m_hostTransfers[it->m_host] <= 0)
+      m_hostTransfers.erase(it->m_host);
+
+    it->m_state = TransferState::DONE;
+    it->m_hasResult = true;
+    it->m_result = result;
+    it->m_progress->Set();
+  }
+}
+
+void DllLibCurlGlobal::WaitTransfers()
+{
+#if LIBCURL_VERSION_NUM >= 0x074400
+  // woken up by WakeTransfers() whenever a transfer is added, resumed or removed
+  multi_poll(m_multi, 1000, nullptr);
+#else
+  // older libcurl can't be woken up while it waits for the sockets, so only wait a little. it
+  // returns right away if there is no socket to wait for
+  int numfds = 0;
+  if (multi_wait(m_multi, 10, &numfds) != CURLM_OK || numfds == 0)
+    m_transferEvent.WaitMSec(10);
+#endif
+}
+
+void DllLibCurlGlobal::WakeTransfers()
+{
+  m_transferEvent.Set();
+#if LIBCURL_VERSION_NUM >= 0x074400
+  if (m_multi)
+    multi_wakeup(m_multi);
+#endif
+}
+
 void DllLibCurlGlobal::easy_acquire(const char* protocol,
                                     const char* hostname,
                                     CURL_HANDLE** easy_handle,
@@ -191,6 +577,7 @@ void DllLibCurlGlobal::easy_acquire(const char* protocol,
             it.m_easy = easy_init();
 
           *easy_handle = it.m_easy;
+          easy_setopt(it.m_easy, CURLOPT_SHARE, m_share);
         }
 
         if (multi_handle)
@@ -215,6 +602,7 @@ void DllLibCurlGlobal::easy_acquire(const char* protocol,
   {
     session.m_easy = easy_init();
     *easy_handle = session.m_easy;
+    easy_setopt(session.m_easy, CURLOPT_SHARE, m_share);
   }
 
   if (multi_handle)
@@ -247,6 +635,9 @@ void DllLibCurlGlobal::easy_release(CURL_HANDLE** easy_handle, CURLM** multi_han
     *multi_handle = NULL;
   }
 
+  if (easy)
+    AddStatistics(easy);
+
   for (auto& it : m_sessions)
   {
     if (it.m_easy == easy && (multi == nullptr || it.m_multi == multi))
@@ -261,6 +652,14 @@ void DllLibCurlGlobal::easy_release(CURL_HANDLE** easy_handle, CURLM** multi_han
   }
 }
 
+void DllLibCurlGlobal::easy_reset(CURL_HANDLE* easy_handle)
+{
+  DllLibCurl::easy_reset(easy_handle);
+
+  // the share handle is reset too
+  easy_setopt(easy_handle, CURLOPT_SHARE, m_share);
+}
+
 CURL_HANDLE* DllLibCurlGlobal::easy_duphandle(CURL_HANDLE* easy_handle)
 {
   CSingleLock lock(m_critSection);
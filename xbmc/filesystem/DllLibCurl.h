@@ -8,8 +8,15 @@
 
 #pragma once
 
+#include "threads/Condition.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
 
+#include <list>
+#include <map>
+#include <stdint.h>
 #include <stdio.h>
 #include <string>
 #include <sys/time.h>
@@ -37,7 +44,7 @@ public:
   }
   CURLcode easy_perform(CURL_HANDLE* handle);
   CURLcode easy_pause(CURL_HANDLE* handle, int bitmask);
-  void easy_reset(CURL_HANDLE* handle);
+  virtual void easy_reset(CURL_HANDLE* handle);
   template<typename... Args>
   CURLcode easy_getinfo(CURL_HANDLE* curl, CURLINFO info, Args... args)
   {
@@ -55,18 +62,35 @@ public:
                         fd_set* exc_fd_set,
                         int* max_fd);
   CURLMcode multi_timeout(CURLM* multi_handle, long* timeout);
+  CURLMcode multi_wait(CURLM* multi_handle, int timeout_ms, int* numfds);
+#if LIBCURL_VERSION_NUM >= 0x074400
+  CURLMcode multi_poll(CURLM* multi_handle, int timeout_ms, int* numfds);
+  CURLMcode multi_wakeup(CURLM* multi_handle);
+#endif
+  template<typename... Args>
+  CURLMcode multi_setopt(CURLM* multi_handle, CURLMoption option, Args... args)
+  {
+    return curl_multi_setopt(multi_handle, option, std::forward<Args>(args)...);
+  }
   CURLMsg* multi_info_read(CURLM* multi_handle, int* msgs_in_queue);
   CURLMcode multi_cleanup(CURLM* handle);
   curl_slist* slist_append(curl_slist* list, const char* to_append);
   void slist_free_all(curl_slist* list);
   const char* easy_strerror(CURLcode code);
+  CURLSH* share_init();
+  template<typename... Args>
+  CURLSHcode share_setopt(CURLSH* share, CURLSHoption option, Args... args)
+  {
+    return curl_share_setopt(share, option, std::forward<Args>(args)...);
+  }
+  CURLSHcode share_cleanup(CURLSH* share);
 };
 
-class DllLibCurlGlobal : public DllLibCurl
+class DllLibCurlGlobal : public DllLibCurl, private CThread
 {
 public:
   DllLibCurlGlobal();
-  ~DllLibCurlGlobal();
+  ~DllLibCurlGlobal() override;
   /* extend interface with buffered functions */
   void easy_acquire(const char* protocol,
                     const char* hostname,
@@ -75,8 +99,37 @@ public:
   void easy_release(CURL_HANDLE** easy_handle, CURLM** multi_handle);
   void easy_duplicate(CURL_HANDLE* easy, CURLM* multi, CURL_HANDLE** easy_out, CURLM** multi_out);
   CURL_HANDLE* easy_duphandle(CURL_HANDLE* easy_handle) override;
+  void easy_reset(CURL_HANDLE* easy_handle) override;
+  template<typename... Args>
+  CURLcode easy_getinfo(CURL_HANDLE* curl, CURLINFO info, Args... args)
+  {
+    // a handle added with transfer_add() is in use by the transfer thread
+    CSingleLock lock(m_transferSection);
+    return DllLibCurl::easy_getinfo(curl, info, std::forward<Args>(args)...);
+  }
   void CheckIdle();
 
+  /* reads are run by a transfer thread on one multi handle shared by all hosts, so connections
+   * are reused and HTTP/2 streams multiplexed between handles. a host has at most
+   * <curlmaxhostconnections> transfers running, further ones are queued until one of them is done
+   * unless bQueue is false */
+  void transfer_add(CURL_HANDLE* easy_handle, CEvent* progress, bool bQueue);
+  void transfer_remove(CURL_HANDLE* easy_handle);
+  void transfer_resume(CURL_HANDLE* easy_handle);
+  bool transfer_running(CURL_HANDLE* easy_handle);
+  bool transfer_result(CURL_HANDLE* easy_handle, CURLcode& result);
+
+  /* connection reuse statistics, collected whenever a handle is released */
+  typedef struct SStatistics
+  {
+    uint64_t m_transfers; // transfers performed
+    uint64_t m_reused; // transfers that reused an existing connection
+    uint64_t m_connects; // new connections opened
+    uint64_t m_queued; // transfers that waited for a running transfer of their host to finish
+  } SStatistics;
+
+  SStatistics GetStatistics();
+
   /* overloaded load and unload with reference counter */
 
   /* structure holding a session info */
@@ -94,6 +147,59 @@ public:
 
   VEC_CURLSESSIONS m_sessions;
   CCriticalSection m_critSection;
+
+private:
+  enum class TransferState
+  {
+    QUEUED,
+    RUNNING,
+    DONE
+  };
+
+  /* structure holding a transfer run by the transfer thread */
+  typedef struct STransfer
+  {
+    CURL_HANDLE* m_easy;
+    std::string m_host;
+    CEvent* m_progress; // set once the transfer is done
+    TransferState m_state;
+    bool m_queue; // wait for a free slot of the host before starting
+    bool m_waited; // counted in m_queued
+    unsigned int m_queuedtimestamp;
+    bool m_resume;
+    bool m_remove;
+    bool m_hasResult;
+    CURLcode m_result;
+  } STransfer;
+
+  void Process() override;
+  void StartTransfers();
+  void FinishTransfers();
+  void WaitTransfers();
+  void WakeTransfers();
+  std::list<STransfer>::iterator FindTransfer(CURL_HANDLE* easy_handle);
+
+  static void share_lock(CURL_HANDLE* handle, curl_lock_data data, curl_lock_access access, void* userptr);
+  static void share_unlock(CURL_HANDLE* handle, curl_lock_data data, void* userptr);
+  void CloseSession(SSession& session);
+  void AddStatistics(CURL_HANDLE* easy_handle);
+
+  /* DNS cache and TLS sessions shared by all handles */
+  CURLSH* m_share = nullptr;
+  CCriticalSection m_shareSections[CURL_LOCK_DATA_LAST];
+  SStatistics m_statistics = {};
+
+  /* all reads, accessed by the transfer thread under m_transferSection */
+  CURLM* m_multi = nullptr;
+  std::list<STransfer> m_transfers;
+  std::map<std::string, int> m_hostTransfers; // running transfers per host
+  uint64_t m_queued = 0;
+  CCriticalSection m_transferSection;
+  XbmcThreads::ConditionVariable m_transferRemoved;
+  CEvent m_transferEvent;
+
+  /* guards starting and stopping the transfer thread */
+  CCriticalSection m_threadSection;
 };
 } // namespace XCURL
 
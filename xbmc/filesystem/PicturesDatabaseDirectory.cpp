@@ -0,0 +1,110 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "PicturesDatabaseDirectory.h"
+
+#include "FileItem.h"
+#include "URL.h"
+#include "guilib/LocalizeStrings.h"
+#include "pictures/PictureDatabase.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+#include <stdlib.h>
+#include <vector>
+
+using namespace XFILE;
+
+namespace
+{
+void AddRootFolder(CFileItemList& items, const std::string& node, int label)
+{
+  CFileItemPtr item(new CFileItem(g_localizeStrings.Get(label)));
+  item->SetPath("picturesdb://" + node + "/");
+  item->m_bIsFolder = true;
+  items.Add(item);
+}
+
+// the numeric folders below the node, empty for the node itself
+bool GetIds(const CURL& url, std::vector<int>& ids)
+{
+  std::vector<std::string> folders = StringUtils::Split(url.GetFileName(), '/');
+  for (const std::string& folder : folders)
+  {
+    if (folder.empty())
+      continue;
+    if (!StringUtils::IsNaturalNumber(folder))
+      return false;
+    ids.push_back(atoi(folder.c_str()));
+  }
+  return true;
+}
+}
+
+bool CPicturesDatabaseDirectory::GetDirectory(const CURL& url, CFileItemList& items)
+{
+  const std::string node = url.GetHostName();
+  if (node.empty())
+  {
+    AddRootFolder(items, "dates", 577);
+    AddRootFolder(items, "cameras", 21901);
+    AddRootFolder(items, "locations", 21902);
+    return true;
+  }
+
+  std::vector<int> ids;
+  if (!GetIds(url, ids))
+    return false;
+
+  CPictureDatabase database;
+  if (!database.Open())
+    return false;
+
+  const std::string path = URIUtils::AddFileToFolder(url.Get(), "");
+  bool result = false;
+  if (node == "dates")
+  {
+    if (ids.empty())
+      result = database.GetYearsNav(path, items);
+    else if (ids.size() == 1)
+      result = database.GetMonthsNav(path, ids[0], items);
+    else if (ids.size() == 2)
+      result = database.GetPicturesByDate(ids[0], ids[1], items);
+  }
+  else if (node == "cameras")
+  {
+    if (ids.empty())
+      result = database.GetCamerasNav(path, items);
+    else if (ids.size() == 1)
+    {
+      result = database.GetPicturesByCamera(ids[0], items);
+      items.SetLabel(database.GetCameraById(ids[0]));
+    }
+  }
+  else if (node == "locations")
+  {
+    if (ids.empty())
+      result = database.GetLocationsNav(path, items);
+    else if (ids.size() == 1)
+    {
+      result = database.GetPicturesByLocation(ids[0], items);
+      items.SetLabel(database.GetLocationById(ids[0]));
+    }
+  }
+
+  database.Close();
+  return result;
+}
+
+bool CPicturesDatabaseDirectory::Exists(const CURL& url)
+{
+  const std::string node = url.GetHostName();
+  std::vector<int> ids;
+  return (node.empty() || node == "dates" || node == "cameras" || node == "locations") &&
+         GetIds(url, ids);
+}
@@ -0,0 +1,32 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "IDirectory.h"
+
+namespace XFILE
+{
+  /*!
+   \brief Browses the picture database.
+
+   picturesdb://dates/[year/[month/]]
+   picturesdb://cameras/[idCamera/]
+   picturesdb://locations/[idLocation/]
+   */
+  class CPicturesDatabaseDirectory : public IDirectory
+  {
+  public:
+    CPicturesDatabaseDirectory() = default;
+    ~CPicturesDatabaseDirectory() override = default;
+
+    bool GetDirectory(const CURL& url, CFileItemList& items) override;
+    bool AllowAll() const override { return true; }
+    bool Exists(const CURL& url) override;
+  };
+}
@@ -13,9 +13,13 @@
 #include "utils/auto_buffer.h"
 #include "utils/log.h"
 
+#include <algorithm>
+
 #include <sys/stat.h>
 
 #define ZIP_CACHE_LIMIT 4*1024*1024
+#define ZIP_SEEK_POINT_MIN_INTERVAL 256*1024
+#define ZIP_MAX_SEEK_POINTS 16
 
 using namespace XFILE;
 
@@ -97,7 +101,68 @@ bool CZipFile::InitDecompress()
   m_ZStream.next_in = (Bytef*)m_szBuffer;
   m_ZStream.avail_in = 0;
   m_ZStream.total_out = 0;
+  m_seekPoints.clear();
+  m_iSeekPointInterval = std::max<int64_t>(ZIP_SEEK_POINT_MIN_INTERVAL, mZipItem.usize / ZIP_MAX_SEEK_POINTS);
+
+  return true;
+}
+
+void CZipFile::RestartDecompress()
+{
+  m_iFilePos = 0;
+  m_iZipFilePos = 0;
+  m_bFlush = false;
+  inflateEnd(&m_ZStream);
+  inflateInit2(&m_ZStream,-MAX_WBITS); // simply restart zlib
+  mFile.Seek(mZipItem.offset,SEEK_SET);
+  m_ZStream.next_in = (Bytef*)m_szBuffer;
+  m_ZStream.avail_in = 0;
+  m_ZStream.total_out = 0;
+}
+
+void CZipFile::AddSeekPoint()
+{
+  std::unique_ptr<SSeekPoint> point(new SSeekPoint);
+  if (inflateCopy(&point->stream, &m_ZStream) != Z_OK)
+    return;
+
+  // the input still buffered gets read again when restoring
+  point->iFilePos = m_iFilePos;
+  point->iZipFilePos = m_iZipFilePos - m_ZStream.avail_in;
+  point->bFlush = m_bFlush;
+  m_seekPoints.push_back(std::move(point));
+}
+
+bool CZipFile::RestoreSeekPoint(int64_t iFilePosition)
+{
+  // the closest seek point before the position
+  auto it = std::upper_bound(m_seekPoints.begin(), m_seekPoints.end(), iFilePosition,
+                             [](int64_t position, const std::unique_ptr<SSeekPoint>& point)
+                             {
+                               return position < point->iFilePos;
+                             });
+  if (it == m_seekPoints.begin())
+    return false;
+
+  const SSeekPoint& point = **(--it);
+  // just go on inflating if we're already closer
+  if (iFilePosition >= m_iFilePos && point.iFilePos <= m_iFilePos)
+    return false;
 
+  inflateEnd(&m_ZStream);
+  if (inflateCopy(&m_ZStream, const_cast<z_streamp>(&point.stream)) != Z_OK)
+  {
+    inflateInit2(&m_ZStream,-MAX_WBITS);
+    RestartDecompress();
+    return true;
+  }
+
+  m_iFilePos = point.iFilePos;
+  m_iZipFilePos = point.iZipFilePos;
+  m_bFlush = point.bFlush;
+  mFile.Seek(mZipItem.offset+m_iZipFilePos,SEEK_SET);
+  m_ZStream.next_in = (Bytef*)m_szBuffer;
+  m_ZStream.avail_in = 0;
   return true;
 }
 
@@ -168,27 +233,10 @@ int64_t CZipFile::Seek(int64_t iFilePosition, int iWhence)
         return -1;
       // read until position in 128k blocks.. only way to do it due to format.
       // can't start in the middle of data since then we'd have no clue where
-      // we are in uncompressed data..
-      if (iFilePosition < m_iFilePos)
-      {
-        m_iFilePos = 0;
-        m_iZipFilePos = 0;
-        inflateEnd(&m_ZStream);
-        inflateInit2(&m_ZStream,-MAX_WBITS); // simply restart zlib
-        mFile.Seek(mZipItem.offset,SEEK_SET);
-        m_ZStream.next_in = (Bytef*)m_szBuffer;
-        m_ZStream.avail_in = 0;
-        m_ZStream.total_out = 0;
-        while (m_iFilePos < iFilePosition)
-        {
-          ssize_t iToRead = (iFilePosition - m_iFilePos) > blockSize ? blockSize : iFilePosition - m_iFilePos;
-          if (Read(buf.get(),iToRead) != iToRead)
-            return -1;
-        }
-        return m_iFilePos;
-      }
-      else // seek forward
-        return Seek(iFilePosition-m_iFilePos,SEEK_CUR);
+      // we are in uncompressed data.. unless we kept the inflate state there
+      if (!RestoreSeekPoint(iFilePosition) && iFilePosition < m_iFilePos)
+        RestartDecompress();
+      return Seek(iFilePosition-m_iFilePos,SEEK_CUR);
       break;
 
     case SEEK_CUR:
@@ -209,15 +257,7 @@ int64_t CZipFile::Seek(int64_t iFilePosition, int iWhence)
 
     case SEEK_END:
       // now this is a nasty bastard, possibly takes lotsoftime
-      // uncompress, minding m_ZStream.total_out
-
-      while(static_cast<ssize_t>(m_ZStream.total_out) < mZipItem.usize+iFilePosition)
-      {
-        ssize_t iToRead = (mZipItem.usize + iFilePosition - m_ZStream.total_out > blockSize) ? blockSize : mZipItem.usize + iFilePosition - m_ZStream.total_out;
-        if (Read(buf.get(), iToRead) != iToRead)
-          return -1;
-      }
-      return m_iFilePos;
+      return Seek(mZipItem.usize+iFilePosition,SEEK_SET);
       break;
     default:
       return -1;
@@ -330,6 +370,11 @@ ssize_t CZipFile::Read(void* lpBuf, size_t uiBufSize)
       iDecompressed = m_ZStream.total_out-prevOut;
     }
     m_iFilePos += iDecompressed;
+
+    const int64_t iLastSeekPoint = m_seekPoints.empty() ? 0 : m_seekPoints.back()->iFilePos;
+    if (m_iFilePos - iLastSeekPoint >= m_iSeekPointInterval && m_iFilePos < mZipItem.usize)
+      AddSeekPoint();
+
     return static_cast<unsigned int>(iDecompressed);
   }
   else if (mZipItem.method == 0) // uncompressed. just read from file, but mind our boundaries.
@@ -355,6 +400,7 @@ void CZipFile::Close()
 {
   if (mZipItem.method == 8 && !m_bCached && m_iRead != -1)
     inflateEnd(&m_ZStream);
+  m_seekPoints.clear();
 
   mFile.Close();
 }
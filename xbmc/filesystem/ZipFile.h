@@ -12,6 +12,9 @@
 #include "IFile.h"
 #include "ZipManager.h"
 
+#include <memory>
+#include <vector>
+
 #include <zlib.h>
 
 namespace XFILE
@@ -40,7 +43,21 @@ namespace XFILE
     static bool DecompressGzip(const std::string& in, std::string& out);
 
   private:
+    // inflate state at a position of the uncompressed data, so that seeking
+    // back doesn't need to inflate everything from the start again
+    struct SSeekPoint
+    {
+      ~SSeekPoint() { inflateEnd(&stream); }
+      int64_t iFilePos = 0; // position in uncompressed data
+      int64_t iZipFilePos = 0; // position in compressed data
+      bool bFlush = false;
+      z_stream stream = {};
+    };
+
     bool InitDecompress();
+    void RestartDecompress();
+    void AddSeekPoint();
+    bool RestoreSeekPoint(int64_t iFilePosition);
     bool FillBuffer();
     void DestroyBuffer(void* lpBuffer, int iBufSize);
     CFile mFile;
@@ -56,6 +73,8 @@ namespace XFILE
     int m_iRead;
     bool m_bFlush = false;
     bool m_bCached;
+    std::vector<std::unique_ptr<SSeekPoint>> m_seekPoints; // ascending positions
+    int64_t m_iSeekPointInterval = 0;
   };
 }
 
@@ -9,13 +9,18 @@
 #include "ZipManager.h"
 
 #include <algorithm>
+#include <atomic>
+#include <set>
+#include <thread>
 #include <utility>
 
+#include "Directory.h"
 #include "File.h"
 #include "URL.h"
 #if defined(TARGET_POSIX)
 #include "PlatformDefs.h"
 #endif
+#include "threads/SingleLock.h"
 #include "utils/CharsetConverter.h"
 #include "utils/EndianSwap.h"
 #include "utils/log.h"
@@ -26,6 +31,8 @@ using namespace XFILE;
 
 static const size_t ZC_FLAG_EFS = 1 << 11; // general purpose bit 11 - zip holds utf-8 filenames
 
+const unsigned int CZipManager::MAX_EXTRACT_THREADS;
+
 CZipManager::CZipManager() = default;
 
 CZipManager::~CZipManager() = default;
@@ -42,18 +49,18 @@ bool CZipManager::GetZipList(const CURL& url, std::vector<SZipEntry>& items)
     return false;
   }
 
-  std::map<std::string, std::vector<SZipEntry> >::iterator it = mZipMap.find(strFile);
-  if (it != mZipMap.end()) // already listed, just return it if not changed, else release and reread
   {
-    std::map<std::string,int64_t>::iterator it2=mZipDate.find(strFile);
-
-    if (m_StatData.st_mtime == it2->second)
+    CSingleLock lock(m_critSection);
+    std::list<SZipListing>::iterator it = FindListing(strFile);
+    if (it != m_listings.end()) // already listed, just return it if not changed, else release and reread
     {
-      items = it->second;
-      return true;
+      if (m_StatData.st_mtime == it->date)
+      {
+        items = it->entries;
+        return true;
+      }
+      m_listings.erase(it);
     }
-    mZipMap.erase(it);
-    mZipDate.erase(it2);
   }
 
   CFile mFile;
@@ -76,10 +83,6 @@ bool CZipManager::GetZipList(const CURL& url, std::vector<SZipEntry>& items)
   if (Endian_SwapLE32(hdr) == ZIP_SPLIT_ARCHIVE_HEADER)
     CLog::LogF(LOGWARNING, "ZIP split archive header found. Trying to process as a single archive..");
 
-  // push date for update detection
-  mZipDate.insert(make_pair(strFile,m_StatData.st_mtime));
-
-
   // Look for end of central directory record
   // Zipfile comment may be up to 65535 bytes
   // End of central directory record is 22 bytes (ECDREC_SIZE)
@@ -212,7 +215,8 @@ bool CZipManager::GetZipList(const CURL& url, std::vector<SZipEntry>& items)
 
   }
 
-  mZipMap.insert(make_pair(strFile,items));
+  // push date for update detection
+  AddListing(strFile, m_StatData.st_mtime, items);
   mFile.Close();
   return true;
 }
@@ -221,27 +225,26 @@ bool CZipManager::GetZipEntry(const CURL& url, SZipEntry& item)
 {
   std::string strFile = url.GetHostName();
 
-  std::map<std::string, std::vector<SZipEntry> >::iterator it = mZipMap.find(strFile);
-  std::vector<SZipEntry> items;
-  if (it == mZipMap.end()) // we need to list the zip
-  {
-    GetZipList(url,items);
-  }
-  else
+  CSingleLock lock(m_critSection);
+  std::list<SZipListing>::iterator it = FindListing(strFile);
+  if (it == m_listings.end()) // we need to list the zip
   {
-    items = it->second;
+    lock.Leave();
+    std::vector<SZipEntry> items;
+    if (!GetZipList(url, items))
+      return false;
+    lock.Enter();
+    it = FindListing(strFile);
+    if (it == m_listings.end())
+      return false;
   }
 
-  std::string strFileName = url.GetFileName();
-  for (const auto& it2 : items)
-  {
-    if (std::string(it2.name) == strFileName)
-    {
-      item = it2;
-      return true;
-    }
-  }
-  return false;
+  std::unordered_map<std::string, size_t>::const_iterator entry = it->index.find(url.GetFileName());
+  if (entry == it->index.end())
+    return false;
+
+  item = it->entries[entry->second];
+  return true;
 }
 
 bool CZipManager::ExtractArchive(const std::string& strArchive, const std::string& strPath)
@@ -255,18 +258,46 @@ bool CZipManager::ExtractArchive(const CURL& archive, const std::string& strPath
   std::vector<SZipEntry> entry;
   CURL url = URIUtils::CreateArchivePath("zip", archive);
   GetZipList(url, entry);
+
+  std::vector<std::string> files;
+  std::set<std::string> directories;
   for (const auto& it : entry)
   {
-    if (it.name[strlen(it.name) - 1] == '/') // skip dirs
-      continue;
     std::string strFilePath(it.name);
+    if (strFilePath.empty() || strFilePath.back() == '/') // skip dirs
+      continue;
 
-    CURL zipPath = URIUtils::CreateArchivePath("zip", archive, strFilePath);
-    const CURL pathToUrl(strPath + strFilePath);
-    if (!CFile::Copy(zipPath, pathToUrl))
-      return false;
+    directories.insert(URIUtils::GetDirectory(strPath + strFilePath));
+    files.push_back(strFilePath);
   }
-  return true;
+
+  // create the directories up front, parents sort before their children
+  for (const auto& it : directories)
+    CDirectory::Create(it);
+
+  // entries are independent of each other, inflate several of them at a time
+  std::atomic<size_t> next(0);
+  std::atomic<bool> failed(false);
+  auto extract = [&]()
+  {
+    for (size_t i = next++; i < files.size() && !failed; i = next++)
+    {
+      CURL zipPath = URIUtils::CreateArchivePath("zip", archive, files[i]);
+      const CURL pathToUrl(strPath + files[i]);
+      if (!CFile::Copy(zipPath, pathToUrl))
+        failed = true;
+    }
+  };
+
+  const size_t threadCount = std::min<size_t>(files.size(), std::max(1u, std::min(MAX_EXTRACT_THREADS, std::thread::hardware_concurrency())));
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < threadCount; ++i)
+    threads.emplace_back(extract);
+  extract();
+  for (auto& thread : threads)
+    thread.join();
+
+  return !failed;
 }
 
 // Read local file header
@@ -309,13 +340,41 @@ void CZipManager::readCHeader(const char* buffer, SZipEntry& info)
 void CZipManager::release(const std::string& strPath)
 {
   CURL url(strPath);
-  std::map<std::string, std::vector<SZipEntry> >::iterator it= mZipMap.find(url.GetHostName());
-  if (it != mZipMap.end())
-  {
-    std::map<std::string,int64_t>::iterator it2=mZipDate.find(url.GetHostName());
-    mZipMap.erase(it);
-    mZipDate.erase(it2);
-  }
+  CSingleLock lock(m_critSection);
+  std::list<SZipListing>::iterator it = FindListing(url.GetHostName());
+  if (it != m_listings.end())
+    m_listings.erase(it);
 }
 
+std::list<CZipManager::SZipListing>::iterator CZipManager::FindListing(const std::string& strFile)
+{
+  std::list<SZipListing>::iterator it = std::find_if(m_listings.begin(), m_listings.end(),
+                                                     [&strFile](const SZipListing& listing)
+                                                     {
+                                                       return listing.path == strFile;
+                                                     });
+  if (it != m_listings.end() && it != m_listings.begin())
+    m_listings.splice(m_listings.begin(), m_listings, it);
+
+  return it;
+}
 
+void CZipManager::AddListing(const std::string& strFile, int64_t date, const std::vector<SZipEntry>& entries)
+{
+  SZipListing listing;
+  listing.path = strFile;
+  listing.date = date;
+  listing.entries = entries;
+  listing.index.reserve(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i)
+    listing.index.emplace(entries[i].name, i);
+
+  CSingleLock lock(m_critSection);
+  std::list<SZipListing>::iterator it = FindListing(strFile);
+  if (it != m_listings.end())
+    m_listings.erase(it);
+
+  m_listings.push_front(std::move(listing));
+  if (m_listings.size() > MAX_LISTINGS)
+    m_listings.pop_back();
+}
@@ -18,9 +18,12 @@
 #define CHDR_SIZE 46
 #define ECDREC_SIZE 22
 
+#include "threads/CriticalSection.h"
+
+#include <list>
 #include <string>
+#include <unordered_map>
 #include <vector>
-#include <map>
 
 class CURL;
 
@@ -64,8 +67,25 @@ public:
   static void readHeader(const char* buffer, SZipEntry& info);
   static void readCHeader(const char* buffer, SZipEntry& info);
 private:
-  std::map<std::string,std::vector<SZipEntry> > mZipMap;
-  std::map<std::string,int64_t> mZipDate;
+  // the parsed central directory of an archive
+  struct SZipListing
+  {
+    std::string path;
+    int64_t date = 0;
+    std::vector<SZipEntry> entries;
+    std::unordered_map<std::string, size_t> index; // entry name -> position in entries
+  };
+
+  // number of archives whose central directory is kept, least recently used ones are dropped
+  static const size_t MAX_LISTINGS = 16;
+  // number of entries extracted in parallel by ExtractArchive
+  static const unsigned int MAX_EXTRACT_THREADS = 4;
+
+  std::list<SZipListing>::iterator FindListing(const std::string& strFile);
+  void AddListing(const std::string& strFile, int64_t date, const std::vector<SZipEntry>& entries);
+
+  CCriticalSection m_critSection;
+  std::list<SZipListing> m_listings; // most recently used first
 };
 
 extern CZipManager g_ZipManager;
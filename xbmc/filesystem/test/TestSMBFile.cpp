@@ -0,0 +1,204 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "platform/posix/filesystem/SMBFile.h"
+
+#include <memory>
+#include <set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+// CheckIfIdle() is called twice a second, an unused context is freed after 90 seconds
+const int IDLE_TICKS = 180;
+
+/*!
+ \brief The context pool of CSMB with contexts that are never initialized, so no smbd is needed.
+ */
+class CTestSMB : public CSMB
+{
+public:
+  ~CTestSMB() override
+  {
+    // the contexts have to be freed before CSMB is destructed and FreeContext() isn't ours anymore
+    Deinit();
+  }
+
+  int created = 0;
+  int freed = 0;
+  bool fail = false;
+
+protected:
+  SMBCCTX* CreateContext() override
+  {
+    if (fail)
+      return nullptr;
+    m_fakeContexts.emplace_back(new char);
+    created++;
+    return reinterpret_cast<SMBCCTX*>(m_fakeContexts.back().get());
+  }
+
+  void FreeContext(SMBCCTX*) override
+  {
+    freed++;
+  }
+
+private:
+  std::vector<std::unique_ptr<char>> m_fakeContexts;
+};
+
+void Tick(CSMB& pool, int iTicks)
+{
+  for (int i = 0; i < iTicks; i++)
+    pool.CheckIfIdle();
+}
+} // unnamed namespace
+
+TEST(TestSMBFile, AcquireCreatesContextPerFile)
+{
+  CTestSMB pool;
+
+  const std::shared_ptr<CSMBContext> first = pool.AcquireContext("server");
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ(1, first->users);
+  EXPECT_EQ("server", first->server);
+
+  // a second file on the server is read through a context of its own
+  const std::shared_ptr<CSMBContext> second = pool.AcquireContext("SERVER");
+  ASSERT_NE(nullptr, second);
+  EXPECT_NE(first, second);
+  EXPECT_NE(first->context, second->context);
+
+  // other servers don't share contexts
+  const std::shared_ptr<CSMBContext> other = pool.AcquireContext("other");
+  ASSERT_NE(nullptr, other);
+  EXPECT_NE(first, other);
+  EXPECT_NE(second, other);
+  EXPECT_EQ(3, pool.created);
+
+  pool.ReleaseContext(first);
+  pool.ReleaseContext(second);
+  pool.ReleaseContext(other);
+}
+
+TEST(TestSMBFile, ReleasedContextIsReused)
+{
+  CTestSMB pool;
+
+  const std::shared_ptr<CSMBContext> context = pool.AcquireContext("server");
+  ASSERT_NE(nullptr, context);
+  pool.ReleaseContext(context);
+  EXPECT_EQ(0, context->users);
+
+  EXPECT_EQ(context, pool.AcquireContext("server"));
+  EXPECT_EQ(1, context->users);
+  EXPECT_EQ(1, pool.created);
+  pool.ReleaseContext(context);
+}
+
+TEST(TestSMBFile, ExhaustedServerSharesLeastUsedContext)
+{
+  CTestSMB pool;
+
+  std::vector<std::shared_ptr<CSMBContext>> contexts;
+  for (int i = 0; i < CSMB::MAX_CONTEXTS_PER_SERVER; i++)
+    contexts.emplace_back(pool.AcquireContext("server"));
+  EXPECT_EQ(CSMB::MAX_CONTEXTS_PER_SERVER, pool.created);
+  EXPECT_EQ(static_cast<size_t>(CSMB::MAX_CONTEXTS_PER_SERVER),
+            std::set<std::shared_ptr<CSMBContext>>(contexts.begin(), contexts.end()).size());
+
+  // no more contexts are created, the files are spread over the existing ones
+  std::vector<std::shared_ptr<CSMBContext>> shared;
+  for (int i = 0; i < CSMB::MAX_CONTEXTS_PER_SERVER; i++)
+    shared.emplace_back(pool.AcquireContext("server"));
+  EXPECT_EQ(CSMB::MAX_CONTEXTS_PER_SERVER, pool.created);
+  EXPECT_EQ(contexts, shared);
+  for (const auto& context : contexts)
+    EXPECT_EQ(2, context->users);
+
+  // a context with less files is preferred
+  pool.ReleaseContext(shared[2]);
+  pool.ReleaseContext(shared[3]);
+  shared.resize(2);
+  EXPECT_EQ(contexts[2], pool.AcquireContext("server"));
+  shared.emplace_back(contexts[2]);
+
+  for (const auto& context : contexts)
+    pool.ReleaseContext(context);
+  for (const auto& context : shared)
+    pool.ReleaseContext(context);
+}
+
+TEST(TestSMBFile, FailedCreateReturnsNoContext)
+{
+  CTestSMB pool;
+  pool.fail = true;
+  EXPECT_EQ(nullptr, pool.AcquireContext("server"));
+
+  // a server with a context still gets the existing one
+  pool.fail = false;
+  const std::shared_ptr<CSMBContext> context = pool.AcquireContext("server");
+  ASSERT_NE(nullptr, context);
+  pool.fail = true;
+  EXPECT_EQ(context, pool.AcquireContext("server"));
+  EXPECT_EQ(2, context->users);
+
+  pool.ReleaseContext(context);
+  pool.ReleaseContext(context);
+}
+
+TEST(TestSMBFile, IdleContextsAreReaped)
+{
+  CTestSMB pool;
+
+  const std::shared_ptr<CSMBContext> idle = pool.AcquireContext("server");
+  const std::shared_ptr<CSMBContext> busy = pool.AcquireContext("server");
+  ASSERT_NE(nullptr, idle);
+  ASSERT_NE(nullptr, busy);
+  pool.ReleaseContext(idle);
+
+  Tick(pool, IDLE_TICKS - 1);
+  EXPECT_EQ(0, pool.freed);
+
+  // the context in use is kept no matter how long
+  Tick(pool, 1);
+  EXPECT_EQ(1, pool.freed);
+  Tick(pool, 2 * IDLE_TICKS);
+  EXPECT_EQ(1, pool.freed);
+
+  // the freed context isn't handed out again
+  pool.ReleaseContext(busy);
+  const std::shared_ptr<CSMBContext> context = pool.AcquireContext("server");
+  EXPECT_EQ(busy, context);
+  EXPECT_EQ(2, pool.created);
+
+  // using a context again restarts its idle time
+  pool.ReleaseContext(context);
+  Tick(pool, IDLE_TICKS - 1);
+  EXPECT_EQ(1, pool.freed);
+  Tick(pool, 1);
+  EXPECT_EQ(2, pool.freed);
+}
+
+TEST(TestSMBFile, DeinitFreesOnlyUnusedContexts)
+{
+  CTestSMB pool;
+
+  const std::shared_ptr<CSMBContext> unused = pool.AcquireContext("server");
+  const std::shared_ptr<CSMBContext> used = pool.AcquireContext("server");
+  pool.ReleaseContext(unused);
+
+  pool.Deinit();
+  EXPECT_EQ(1, pool.freed);
+
+  pool.ReleaseContext(used);
+  pool.Deinit();
+  EXPECT_EQ(2, pool.freed);
+}
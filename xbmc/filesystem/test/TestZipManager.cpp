@@ -6,10 +6,138 @@
  *  See LICENSES/README.md for more information.
  */
 
+#include "URL.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
 #include "filesystem/ZipManager.h"
+#include "test/TestUtils.h"
 #include "utils/RegExp.h"
+#include "utils/URIUtils.h"
+#include "utils/auto_buffer.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <gtest/gtest.h>
+#include <zlib.h>
+
+namespace
+{
+// iSize bytes of text that compresses about as well as typical addon content
+std::string CreateContent(size_t iSize, unsigned int seed)
+{
+  static const char* words[] = {"kodi ", "addon ", "skin ", "<control> ", "texture ",
+                                "include ", "</control>\n", "label ", "=\"", "\" "};
+  std::string content;
+  content.reserve(iSize + 16);
+  while (content.size() < iSize)
+  {
+    seed = seed * 1103515245 + 12345;
+    content += words[(seed >> 16) % 10];
+    content += static_cast<char>('a' + (seed >> 8) % 26);
+  }
+  content.resize(iSize);
+  return content;
+}
+
+void AppendLE(std::string& data, unsigned int value, int bytes)
+{
+  for (int i = 0; i < bytes; ++i)
+    data += static_cast<char>((value >> (8 * i)) & 0xff);
+}
+
+// a zip archive of deflated entries
+std::string CreateZip(const std::vector<std::pair<std::string, std::string>>& entries)
+{
+  std::string zip;
+  std::string centralDir;
+  for (const auto& entry : entries)
+  {
+    std::string compressed(compressBound(entry.second.size()), '\0');
+    z_stream stream = {};
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(entry.second.data()));
+    stream.avail_in = entry.second.size();
+    stream.next_out = reinterpret_cast<Bytef*>(&compressed[0]);
+    stream.avail_out = compressed.size();
+    deflate(&stream, Z_FINISH);
+    compressed.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    const unsigned int crc = crc32(0, reinterpret_cast<const Bytef*>(entry.second.data()), entry.second.size());
+    const unsigned int offset = zip.size();
+
+    AppendLE(zip, ZIP_LOCAL_HEADER, 4);
+    AppendLE(zip, 20, 2); // version needed
+    AppendLE(zip, 0, 2); // flags
+    AppendLE(zip, 8, 2); // deflate
+    AppendLE(zip, 0, 2); // time
+    AppendLE(zip, 0x21, 2); // date
+    AppendLE(zip, crc, 4);
+    AppendLE(zip, compressed.size(), 4);
+    AppendLE(zip, entry.second.size(), 4);
+    AppendLE(zip, entry.first.size(), 2);
+    AppendLE(zip, 0, 2); // extra field length
+    zip += entry.first;
+    zip += compressed;
+
+    AppendLE(centralDir, ZIP_CENTRAL_HEADER, 4);
+    AppendLE(centralDir, 20, 2); // version made by
+    AppendLE(centralDir, 20, 2); // version needed
+    AppendLE(centralDir, 0, 2); // flags
+    AppendLE(centralDir, 8, 2); // deflate
+    AppendLE(centralDir, 0, 2); // time
+    AppendLE(centralDir, 0x21, 2); // date
+    AppendLE(centralDir, crc, 4);
+    AppendLE(centralDir, compressed.size(), 4);
+    AppendLE(centralDir, entry.second.size(), 4);
+    AppendLE(centralDir, entry.first.size(), 2);
+    AppendLE(centralDir, 0, 2); // extra field length
+    AppendLE(centralDir, 0, 2); // comment length
+    AppendLE(centralDir, 0, 2); // disk number
+    AppendLE(centralDir, 0, 2); // internal attributes
+    AppendLE(centralDir, 0, 4); // external attributes
+    AppendLE(centralDir, offset, 4);
+    centralDir += entry.first;
+  }
+
+  const unsigned int centralDirOffset = zip.size();
+  zip += centralDir;
+  AppendLE(zip, ZIP_END_CENTRAL_HEADER, 4);
+  AppendLE(zip, 0, 2); // disk number
+  AppendLE(zip, 0, 2); // disk with the central directory
+  AppendLE(zip, entries.size(), 2);
+  AppendLE(zip, entries.size(), 2);
+  AppendLE(zip, centralDir.size(), 4);
+  AppendLE(zip, centralDirOffset, 4);
+  AppendLE(zip, 0, 2); // comment length
+  return zip;
+}
+
+XFILE::CFile* CreateZipFile(const std::vector<std::pair<std::string, std::string>>& entries)
+{
+  XFILE::CFile* file = XBMC_CREATETEMPFILE(".zip");
+  if (file)
+  {
+    const std::string zip = CreateZip(entries);
+    file->Write(zip.data(), zip.size());
+    file->Close();
+  }
+  return file;
+}
+
+std::string ReadFile(const std::string& path)
+{
+  XUTILS::auto_buffer buffer;
+  XFILE::CFile file;
+  if (file.LoadFile(path, buffer) <= 0)
+    return "";
+  return std::string(buffer.get(), buffer.size());
+}
+} // unnamed namespace
 
 TEST(TestZipManager, PathTraversal)
 {
@@ -28,3 +156,88 @@ TEST(TestZipManager, PathTraversal)
   ASSERT_FALSE(pathTraversal.RegFind("test.txt..") >= 0);
   ASSERT_FALSE(pathTraversal.RegFind("test..test.txt") >= 0);
 }
+
+TEST(TestZipManager, ExtractArchive)
+{
+  // an addon like archive with many entries in a few directories
+  std::vector<std::pair<std::string, std::string>> entries;
+  for (unsigned int i = 0; i < 64; ++i)
+  {
+    const std::string dir = "skin.test/" + std::to_string(i % 4) + "/";
+    entries.emplace_back(dir + "file" + std::to_string(i) + ".xml", CreateContent(512 * 1024, i));
+  }
+  XFILE::CFile* file = CreateZipFile(entries);
+  ASSERT_NE(nullptr, file);
+  const std::string archive = XBMC_TEMPFILEPATH(file);
+
+  std::vector<SZipEntry> items;
+  ASSERT_TRUE(g_ZipManager.GetZipList(URIUtils::CreateArchivePath("zip", CURL(archive)), items));
+  EXPECT_EQ(entries.size(), items.size());
+
+  const std::string serialPath = CSpecialProtocol::TranslatePath("special://temp/zipserial/");
+  const std::string parallelPath = CSpecialProtocol::TranslatePath("special://temp/zipparallel/");
+
+  // one entry at a time, as before
+  CTestStopwatch stopwatch;
+  for (const auto& entry : entries)
+  {
+    XFILE::CDirectory::Create(URIUtils::GetDirectory(serialPath + entry.first));
+    EXPECT_TRUE(XFILE::CFile::Copy(URIUtils::CreateArchivePath("zip", CURL(archive), entry.first),
+                                   CURL(serialPath + entry.first)));
+  }
+  const int64_t serialTime = stopwatch.Lap();
+
+  EXPECT_TRUE(g_ZipManager.ExtractArchive(archive, parallelPath));
+  const int64_t parallelTime = stopwatch.Lap();
+
+  for (const auto& entry : entries)
+    EXPECT_EQ(entry.second, ReadFile(parallelPath + entry.first)) << entry.first;
+
+  const int totalMB = static_cast<int>(entries.size() * entries.front().second.size() / (1024 * 1024));
+  RecordProperty("entries", static_cast<int>(entries.size()));
+  RecordProperty("serial_mb_per_s", static_cast<int>(totalMB * 1000000LL / std::max<int64_t>(serialTime, 1)));
+  RecordProperty("parallel_mb_per_s", static_cast<int>(totalMB * 1000000LL / std::max<int64_t>(parallelTime, 1)));
+
+  XFILE::CDirectory::RemoveRecursive(serialPath);
+  XFILE::CDirectory::RemoveRecursive(parallelPath);
+  g_ZipManager.release(URIUtils::CreateArchivePath("zip", CURL(archive)).Get());
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(file));
+}
+
+TEST(TestZipManager, SeekBackward)
+{
+  const std::string content = CreateContent(16 * 1024 * 1024, 1);
+  XFILE::CFile* file = CreateZipFile({{"video.ts", content}});
+  ASSERT_NE(nullptr, file);
+  const std::string archive = XBMC_TEMPFILEPATH(file);
+
+  // read the entry directly instead of from a cached copy
+  CURL zipPath = URIUtils::CreateArchivePath("zip", CURL(archive), "video.ts");
+  zipPath.SetOptions("?cache=no");
+  XFILE::CFile zipFile;
+  ASSERT_TRUE(zipFile.Open(zipPath));
+
+  // read through once, like a player probing the stream
+  std::vector<char> buffer(64 * 1024);
+  while (zipFile.Read(buffer.data(), buffer.size()) > 0)
+    ;
+
+  // then jump around, mostly backwards
+  const int seeks = 50;
+  CTestStopwatch stopwatch;
+  for (int i = 0; i < seeks; ++i)
+  {
+    const int64_t position = (static_cast<int64_t>(seeks - i) * 2654435761u) % (content.size() - buffer.size());
+    ASSERT_EQ(position, zipFile.Seek(position, SEEK_SET));
+    ASSERT_EQ(static_cast<ssize_t>(buffer.size()), zipFile.Read(buffer.data(), buffer.size()));
+    EXPECT_EQ(0, memcmp(content.data() + position, buffer.data(), buffer.size())) << position;
+  }
+  const int64_t seekTime = stopwatch.Lap();
+
+  RecordProperty("seeks", seeks);
+  RecordProperty("us_per_seek", static_cast<int>(seekTime / seeks));
+
+  zipFile.Close();
+  g_ZipManager.release(zipPath.Get());
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(file));
+}
@@ -139,7 +139,7 @@ bool CFFmpegImage::LoadImageFromMemory(unsigned char* buffer, unsigned int bufSi
                                       unsigned int width, unsigned int height)
 {
 
-  if (!Initialize(buffer, bufSize))
+  if (!Initialize(buffer, bufSize, width, height))
   {
     //log
     return false;
@@ -151,7 +151,76 @@ bool CFFmpegImage::LoadImageFromMemory(unsigned char* buffer, unsigned int bufSi
   return !(m_pFrame == nullptr);
 }
 
-bool CFFmpegImage::Initialize(unsigned char* buffer, size_t bufSize)
+namespace
+{
+/*!
+ \brief Read the size of a JPEG image from its frame header.
+ \return false if the image isn't a baseline, extended or progressive JPEG
+ */
+bool GetJpegSize(const unsigned char* buffer, size_t bufSize, unsigned int& width, unsigned int& height)
+{
+  size_t pos = 2; // skip SOI
+  while (pos + 4 <= bufSize)
+  {
+    if (buffer[pos] != 0xFF)
+      return false;
+    const unsigned char marker = buffer[pos + 1];
+    if (marker == 0xFF)
+    { // fill byte
+      pos++;
+      continue;
+    }
+    if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7))
+    { // markers without a payload
+      pos += 2;
+      continue;
+    }
+    if (marker == 0xD9 || marker == 0xDA)
+      return false; // no frame header before the image data
+
+    const size_t length = (buffer[pos + 2] << 8) | buffer[pos + 3];
+    if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC)
+    {
+      // the decoder can't scale lossless and arithmetic coded images
+      if (marker > 0xC2 || pos + 9 > bufSize)
+        return false;
+      height = (buffer[pos + 5] << 8) | buffer[pos + 6];
+      width = (buffer[pos + 7] << 8) | buffer[pos + 8];
+      return width > 0 && height > 0;
+    }
+    pos += 2 + length;
+  }
+  return false;
+}
+
+/*!
+ \brief Get by how many powers of two the decoder may scale an image down.
+
+ The image is scaled down only as far as it still covers the given size, in
+ either orientation as it may still be rotated according to its EXIF data.
+ */
+int GetLowres(unsigned int width, unsigned int height,
+              unsigned int maxWidth, unsigned int maxHeight, int maxLowres)
+{
+  const float scale = std::min(std::max(std::min(maxWidth / static_cast<float>(width),
+                                                 maxHeight / static_cast<float>(height)),
+                                        std::min(maxHeight / static_cast<float>(width),
+                                                 maxWidth / static_cast<float>(height))),
+                               1.0f);
+  const unsigned int neededWidth = static_cast<unsigned int>(width * scale + 0.5f);
+  const unsigned int neededHeight = static_cast<unsigned int>(height * scale + 0.5f);
+
+  int lowres = 0;
+  while (lowres < maxLowres &&
+         ((width + (2u << lowres) - 1) >> (lowres + 1)) >= neededWidth &&
+         ((height + (2u << lowres) - 1) >> (lowres + 1)) >= neededHeight)
+    lowres++;
+  return lowres;
+}
+} // namespace
+
+bool CFFmpegImage::Initialize(unsigned char* buffer, size_t bufSize,
+                              unsigned int maxWidth /* = 0 */, unsigned int maxHeight /* = 0 */)
 {
   int bufferSize = 4096;
   uint8_t* fbuffer = (uint8_t*)av_malloc(bufferSize + AV_INPUT_BUFFER_PADDING_SIZE);
@@ -249,6 +318,18 @@ bool CFFmpegImage::Initialize(unsigned char* buffer, size_t bufSize)
     return false;
   }
 
+  // JPEG images can be scaled down while they are decoded, skipping most of
+  // the work for images that are a lot larger than they are going to be shown
+  unsigned int jpegWidth = 0;
+  unsigned int jpegHeight = 0;
+  if (is_jpeg && maxWidth && maxHeight && codec->max_lowres > 0 &&
+      GetJpegSize(buffer, bufSize, jpegWidth, jpegHeight))
+  {
+    m_codec_ctx->lowres = GetLowres(jpegWidth, jpegHeight, maxWidth, maxHeight, codec->max_lowres);
+    m_originalWidth = jpegWidth;
+    m_originalHeight = jpegHeight;
+  }
+
   if (avcodec_open2(m_codec_ctx, codec, NULL) < 0)
   {
     avformat_close_input(&m_fctx);
@@ -293,8 +374,11 @@ AVFrame* CFFmpegImage::ExtractFrame()
   frame->pkt_duration = av_rescale_q(frame->pkt_duration, m_fctx->streams[0]->time_base, AVRational{ 1, 1000 });
   m_height = frame->height;
   m_width = frame->width;
-  m_originalWidth = m_width;
-  m_originalHeight = m_height;
+  if (m_codec_ctx->lowres == 0)
+  {
+    m_originalWidth = m_width;
+    m_originalHeight = m_height;
+  }
 
   const AVPixFmtDescriptor* pixDescriptor = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(frame->format));
   if (pixDescriptor && ((pixDescriptor->flags & (AV_PIX_FMT_FLAG_ALPHA | AV_PIX_FMT_FLAG_PAL)) != 0))
@@ -468,8 +552,8 @@ bool CFFmpegImage::DecodeFrame(AVFrame* frame, unsigned int width, unsigned int
 
   // assumption quadratic maximums e.g. 2048x2048
   float ratio = m_width / (float)m_height;
-  unsigned int nHeight = m_originalHeight;
-  unsigned int nWidth = m_originalWidth;
+  unsigned int nHeight = frame->height;
+  unsigned int nWidth = frame->width;
   if (nHeight > height)
   {
     nHeight = height;
@@ -481,7 +565,7 @@ bool CFFmpegImage::DecodeFrame(AVFrame* frame, unsigned int width, unsigned int
     nHeight = (unsigned int)(nWidth / ratio + 0.5f);
   }
 
-  struct SwsContext* context = sws_getContext(m_originalWidth, m_originalHeight, pixFormat,
+  struct SwsContext* context = sws_getContext(frame->width, frame->height, pixFormat,
     nWidth, nHeight, AV_PIX_FMT_RGB32, SWS_BICUBIC, NULL, NULL, NULL);
 
   if (range == AVCOL_RANGE_JPEG)
@@ -494,7 +578,7 @@ bool CFFmpegImage::DecodeFrame(AVFrame* frame, unsigned int width, unsigned int
     sws_setColorspaceDetails(context, inv_table, srcRange, table, dstRange, brightness, contrast, saturation);
   }
 
-  sws_scale(context, frame->data, frame->linesize, 0, m_originalHeight,
+  sws_scale(context, frame->data, frame->linesize, 0, frame->height,
     pictureRGB->data, pictureRGB->linesize);
   sws_freeContext(context);
 
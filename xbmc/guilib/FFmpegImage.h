@@ -69,7 +69,13 @@ public:
                                   unsigned int &bufferoutSize) override;
   void ReleaseThumbnailBuffer() override;
 
-  bool Initialize(unsigned char* buffer, size_t bufSize);
+  /*!
+   \brief Open an image for decoding.
+   \param maxWidth, maxHeight size the image is needed at, JPEG images are
+   scaled down on decode as far as they still cover it. 0 decodes them in full.
+   */
+  bool Initialize(unsigned char* buffer, size_t bufSize,
+                  unsigned int maxWidth = 0, unsigned int maxHeight = 0);
 
   std::shared_ptr<Frame> ReadFrame();
 
@@ -10,14 +10,204 @@
 
 #include "addons/LanguageResource.h"
 #include "filesystem/Directory.h"
+#include "filesystem/File.h"
 #include "filesystem/SpecialProtocol.h"
 #include "threads/SharedSection.h"
+#include "threads/SingleLock.h"
 #include "utils/CharsetConverter.h"
+#include "utils/Crc32.h"
 #include "utils/POUtils.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
+#include "utils/auto_buffer.h"
 #include "utils/log.h"
 
+#include <algorithm>
+#include <string.h>
+
+namespace
+{
+const std::string COMPILED_STRINGS_FOLDER = "special://temp/languagecache/";
+const uint32_t COMPILED_STRINGS_MAGIC = 0x4B4C5354; // "KLST"
+const uint32_t COMPILED_STRINGS_VERSION = 1;
+
+// serializes writing of the compiled tables, add-on strings are loaded from jobs as well
+CCriticalSection compiledStringsSection;
+
+/*! \brief A strings.po file a table is compiled from.
+ */
+struct POSource
+{
+  std::string filename;
+  bool sourceLanguage;
+  uint64_t mtime;
+  uint64_t size;
+
+  bool operator==(const POSource& rhs) const
+  {
+    return filename == rhs.filename && sourceLanguage == rhs.sourceLanguage &&
+           mtime == rhs.mtime && size == rhs.size;
+  }
+};
+
+void AppendUInt32(std::string& data, uint32_t value)
+{
+  data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void AppendUInt64(std::string& data, uint64_t value)
+{
+  data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void AppendString(std::string& data, const std::string& value)
+{
+  AppendUInt32(data, static_cast<uint32_t>(value.size()));
+  data.append(value);
+}
+
+template<typename T>
+bool ReadValue(const char*& pos, const char* end, T& value)
+{
+  if (static_cast<size_t>(end - pos) < sizeof(T))
+    return false;
+  memcpy(&value, pos, sizeof(T));
+  pos += sizeof(T);
+  return true;
+}
+
+bool ReadString(const char*& pos, const char* end, std::string& value)
+{
+  uint32_t size;
+  if (!ReadValue(pos, end, size) || static_cast<size_t>(end - pos) < size)
+    return false;
+  value.assign(pos, size);
+  pos += size;
+  return true;
+}
+}
+
+CLocalizeStringTable::CLocalizeStringTable(const std::map<uint32_t, LocStr>& strings)
+{
+  m_ids.reserve(strings.size());
+  m_strings.reserve(strings.size());
+  for (const auto& string : strings)
+  {
+    m_ids.push_back(string.first);
+    m_strings.push_back(string.second.strTranslated);
+  }
+}
+
+const std::string* CLocalizeStringTable::Find(uint32_t code) const
+{
+  const auto it = std::lower_bound(m_ids.begin(), m_ids.end(), code);
+  if (it == m_ids.end() || *it != code)
+    return nullptr;
+  return &m_strings[it - m_ids.begin()];
+}
+
+void CLocalizeStringTable::Erase(uint32_t start, uint32_t end)
+{
+  const auto first = std::lower_bound(m_ids.begin(), m_ids.end(), start);
+  const auto last = std::upper_bound(first, m_ids.end(), end);
+  m_strings.erase(m_strings.begin() + (first - m_ids.begin()), m_strings.begin() + (last - m_ids.begin()));
+  m_ids.erase(first, last);
+}
+
+void CLocalizeStringTable::Merge(CLocalizeStringTable&& other, bool replace)
+{
+  std::vector<uint32_t> ids;
+  std::vector<std::string> strings;
+  ids.reserve(m_ids.size() + other.m_ids.size());
+  strings.reserve(m_ids.size() + other.m_ids.size());
+
+  size_t i = 0;
+  size_t j = 0;
+  while (i < m_ids.size() || j < other.m_ids.size())
+  {
+    if (j == other.m_ids.size() || (i < m_ids.size() && m_ids[i] < other.m_ids[j]))
+    {
+      ids.push_back(m_ids[i]);
+      strings.push_back(std::move(m_strings[i++]));
+    }
+    else if (i == m_ids.size() || other.m_ids[j] < m_ids[i])
+    {
+      ids.push_back(other.m_ids[j]);
+      strings.push_back(std::move(other.m_strings[j++]));
+    }
+    else
+    {
+      ids.push_back(m_ids[i]);
+      strings.push_back(replace ? std::move(other.m_strings[j]) : std::move(m_strings[i]));
+      i++;
+      j++;
+    }
+  }
+
+  m_ids = std::move(ids);
+  m_strings = std::move(strings);
+  other = CLocalizeStringTable();
+}
+
+void CLocalizeStringTable::Serialize(std::string& data) const
+{
+  AppendUInt32(data, static_cast<uint32_t>(m_ids.size()));
+  for (uint32_t id : m_ids)
+    AppendUInt32(data, id);
+
+  uint32_t offset = 0;
+  AppendUInt32(data, offset);
+  for (const std::string& string : m_strings)
+  {
+    offset += static_cast<uint32_t>(string.size());
+    AppendUInt32(data, offset);
+  }
+
+  for (const std::string& string : m_strings)
+    data.append(string);
+}
+
+bool CLocalizeStringTable::Deserialize(const char* data, size_t size)
+{
+  const char* pos = data;
+  const char* end = data + size;
+
+  uint32_t count;
+  if (!ReadValue(pos, end, count) || static_cast<size_t>(end - pos) / 8 < count)
+    return false;
+
+  const char* ids = pos;
+  const char* offsets = ids + count * sizeof(uint32_t);
+  const char* pool = offsets + (count + 1) * sizeof(uint32_t);
+  if (pool > end)
+    return false;
+
+  std::vector<uint32_t> idTable(count);
+  std::vector<std::string> stringTable(count);
+  if (count > 0)
+    memcpy(idTable.data(), ids, count * sizeof(uint32_t));
+
+  uint32_t begin;
+  memcpy(&begin, offsets, sizeof(begin));
+  for (uint32_t i = 0; i < count; i++)
+  {
+    uint32_t next;
+    memcpy(&next, offsets + (i + 1) * sizeof(uint32_t), sizeof(next));
+    if (next < begin || next > static_cast<size_t>(end - pool) || (i > 0 && idTable[i] <= idTable[i - 1]))
+      return false;
+
+    stringTable[i].assign(pool + begin, next - begin);
+    begin = next;
+  }
+
+  if (pool + begin != end)
+    return false;
+
+  m_ids = std::move(idTable);
+  m_strings = std::move(stringTable);
+  return true;
+}
+
 
 /*! \brief Tries to load ids and strings from a strings.po file to the `strings` map.
  * It should only be called from the LoadStr2Mem function to have a fallback.
@@ -83,16 +273,13 @@ static bool LoadPO(const std::string &filename, std::map<uint32_t, LocStr>& stri
   return true;
 }
 
-/*! \brief Loads language ids and strings to memory map `strings`.
- \param pathname The directory name, where we look for the strings file.
- \param language We load the strings for this language. Fallback language is always English.
- \param strings [out] The resulting strings map.
- \param encoding Encoding of the strings. For PO files we only use utf-8.
- \param offset An offset value to place strings from the id value.
- \return false if no strings.po file was loaded.
+/*! \brief Finds the strings.po file of a language.
+ \param pathname The directory name, where we look for the language folder.
+ \param language We look for the strings of this language.
+ \param source [out] The strings file and its modification time and size.
+ \return false if there is no strings.po file.
  */
-static bool LoadStr2Mem(const std::string &pathname_in, const std::string &language,
-    std::map<uint32_t, LocStr>& strings,  std::string &encoding, uint32_t offset = 0 )
+static bool FindPO(const std::string &pathname_in, const std::string &language, POSource& source)
 {
   std::string pathname = CSpecialProtocol::TranslatePathConvertCase(pathname_in + language);
   if (!XFILE::CDirectory::Exists(pathname))
@@ -110,23 +297,161 @@ static bool LoadStr2Mem(const std::string &pathname_in, const std::string &langu
       return false;
   }
 
-  bool useSourceLang = StringUtils::EqualsNoCase(language, LANGUAGE_DEFAULT) || StringUtils::EqualsNoCase(language, LANGUAGE_OLD_DEFAULT);
+  source.filename = URIUtils::AddFileToFolder(pathname, "strings.po");
+  source.sourceLanguage = StringUtils::EqualsNoCase(language, LANGUAGE_DEFAULT) || StringUtils::EqualsNoCase(language, LANGUAGE_OLD_DEFAULT);
 
-  return LoadPO(URIUtils::AddFileToFolder(pathname, "strings.po"), strings, encoding, offset, useSourceLang);
+  struct __stat64 st;
+  if (XFILE::CFile::Stat(source.filename, &st) != 0)
+    return false;
+
+  source.mtime = static_cast<uint64_t>(st.st_mtime);
+  source.size = static_cast<uint64_t>(st.st_size);
+  return true;
 }
 
-static bool LoadWithFallback(const std::string& path, const std::string& language, std::map<uint32_t, LocStr>& strings)
+/*! \brief Path of the compiled table of a set of strings files.
+ */
+static std::string GetCompiledPath(const std::vector<POSource>& sources)
 {
-  std::string encoding;
-  if (!LoadStr2Mem(path, language, strings, encoding))
+  std::string key;
+  for (const POSource& source : sources)
+    key += source.filename + "|";
+  return StringUtils::Format("%s%08x.strings", COMPILED_STRINGS_FOLDER.c_str(), static_cast<uint32_t>(Crc32::Compute(key)));
+}
+
+/*! \brief Loads the compiled table of a set of strings files.
+ \return false if there is no compiled table or it is outdated.
+ */
+static bool LoadCompiled(const std::vector<POSource>& sources, CLocalizeStringTable& strings)
+{
+  const std::string path = GetCompiledPath(sources);
+
+  XFILE::CFile file;
+  XUTILS::auto_buffer buffer;
+  if (file.LoadFile(path, buffer) <= 0)
+    return false;
+
+  const char* pos = buffer.get();
+  const char* end = pos + buffer.size();
+
+  uint32_t magic, version, count;
+  if (!ReadValue(pos, end, magic) || magic != COMPILED_STRINGS_MAGIC ||
+      !ReadValue(pos, end, version) || version != COMPILED_STRINGS_VERSION ||
+      !ReadValue(pos, end, count) || count != sources.size())
+    return false;
+
+  for (const POSource& expected : sources)
   {
-    if (StringUtils::EqualsNoCase(language, LANGUAGE_DEFAULT)) // no fallback, nothing to do
+    POSource source;
+    uint32_t sourceLanguage;
+    if (!ReadString(pos, end, source.filename) || !ReadValue(pos, end, sourceLanguage) ||
+        !ReadValue(pos, end, source.mtime) || !ReadValue(pos, end, source.size))
+      return false;
+
+    source.sourceLanguage = sourceLanguage != 0;
+    if (!(source == expected))
       return false;
   }
 
+  if (!strings.Deserialize(pos, end - pos))
+  {
+    CLog::Log(LOGWARNING, "LocalizeStrings: ignoring damaged compiled strings %s", path.c_str());
+    return false;
+  }
+
+  CLog::Log(LOGDEBUG, "LocalizeStrings: loaded %u compiled strings for %s", static_cast<unsigned int>(strings.Size()),
+            sources.front().filename.c_str());
+  return true;
+}
+
+/*! \brief Stores the compiled table of a set of strings files.
+ */
+static void SaveCompiled(const std::vector<POSource>& sources, const CLocalizeStringTable& strings)
+{
+  std::string data;
+  AppendUInt32(data, COMPILED_STRINGS_MAGIC);
+  AppendUInt32(data, COMPILED_STRINGS_VERSION);
+  AppendUInt32(data, static_cast<uint32_t>(sources.size()));
+  for (const POSource& source : sources)
+  {
+    AppendString(data, source.filename);
+    AppendUInt32(data, source.sourceLanguage ? 1 : 0);
+    AppendUInt64(data, source.mtime);
+    AppendUInt64(data, source.size);
+  }
+  strings.Serialize(data);
+
+  const std::string path = GetCompiledPath(sources);
+  const std::string tempPath = path + ".tmp";
+
+  CSingleLock lock(compiledStringsSection);
+  if (!XFILE::CDirectory::Exists(COMPILED_STRINGS_FOLDER))
+    XFILE::CDirectory::Create(COMPILED_STRINGS_FOLDER);
+
+  // write to a temporary file first so a crash can't leave a truncated table behind
+  XFILE::CFile file;
+  if (!file.OpenForWrite(tempPath, true))
+    return;
+
+  const bool written = file.Write(data.data(), data.size()) == static_cast<ssize_t>(data.size());
+  file.Close();
+
+  if (!written || !(XFILE::CFile::Rename(tempPath, path) ||
+                    (XFILE::CFile::Delete(path) && XFILE::CFile::Rename(tempPath, path))))
+  {
+    CLog::Log(LOGWARNING, "LocalizeStrings: unable to write compiled strings %s", path.c_str());
+    XFILE::CFile::Delete(tempPath);
+  }
+}
+
+/*! \brief Loads the strings of a language with English as fallback.
+ Uses the compiled table if it is up to date, otherwise the strings.po files
+ are parsed and the table is compiled for the next time.
+ \param path The directory name, where we look for the language folders.
+ \param language We load the strings for this language.
+ \param strings [out] The resulting strings table.
+ \return false if the strings of the default language couldn't be loaded.
+ */
+static bool LoadWithFallback(const std::string& path, const std::string& language, CLocalizeStringTable& strings)
+{
+  const bool isDefault = StringUtils::EqualsNoCase(language, LANGUAGE_DEFAULT);
+
+  std::vector<POSource> sources;
+  POSource source;
+  if (FindPO(path, language, source))
+    sources.push_back(source);
+  else if (isDefault) // no fallback, nothing to do
+    return false;
+
   // load the fallback
-  if (!StringUtils::EqualsNoCase(language, LANGUAGE_DEFAULT))
-    LoadStr2Mem(path, LANGUAGE_DEFAULT, strings, encoding);
+  if (!isDefault && FindPO(path, LANGUAGE_DEFAULT, source))
+    sources.push_back(source);
+
+  if (sources.empty())
+  {
+    strings = CLocalizeStringTable();
+    return true;
+  }
+
+  if (LoadCompiled(sources, strings))
+    return true;
+
+  std::map<uint32_t, LocStr> parsed;
+  std::string encoding;
+  bool complete = true;
+  for (const POSource& po : sources)
+  {
+    if (!LoadPO(po.filename, parsed, encoding, 0, po.sourceLanguage))
+    {
+      if (isDefault)
+        return false;
+      complete = false;
+    }
+  }
+
+  strings = CLocalizeStringTable(parsed);
+  if (complete)
+    SaveCompiled(sources, strings);
 
   return true;
 }
@@ -144,42 +469,48 @@ void CLocalizeStrings::ClearSkinStrings()
 
 bool CLocalizeStrings::LoadSkinStrings(const std::string& path, const std::string& language)
 {
-  //! @todo shouldn't hold lock while loading file
+  CLocalizeStringTable strings;
+  const bool ret = LoadWithFallback(path, language, strings);
+
   CExclusiveLock lock(m_stringsMutex);
   ClearSkinStrings();
-  // load the skin strings in.
-  return LoadWithFallback(path, language, m_strings);
+  // load the skin strings in, they don't replace the application strings
+  m_strings.Merge(std::move(strings), false);
+  return ret;
 }
 
 bool CLocalizeStrings::Load(const std::string& strPathName, const std::string& strLanguage)
 {
-  std::map<uint32_t, LocStr> strings;
+  CLocalizeStringTable strings;
   if (!LoadWithFallback(strPathName, strLanguage, strings))
     return false;
 
   // fill in the constant strings
-  strings[20022].strTranslated = "";
-  strings[20027].strTranslated = "°F";
-  strings[20028].strTranslated = "K";
-  strings[20029].strTranslated = "°C";
-  strings[20030].strTranslated = "°Ré";
-  strings[20031].strTranslated = "°Ra";
-  strings[20032].strTranslated = "°Rø";
-  strings[20033].strTranslated = "°De";
-  strings[20034].strTranslated = "°N";
-
-  strings[20200].strTranslated = "km/h";
-  strings[20201].strTranslated = "m/min";
-  strings[20202].strTranslated = "m/s";
-  strings[20203].strTranslated = "ft/h";
-  strings[20204].strTranslated = "ft/min";
-  strings[20205].strTranslated = "ft/s";
-  strings[20206].strTranslated = "mph";
-  strings[20207].strTranslated = "kts";
-  strings[20208].strTranslated = "Beaufort";
-  strings[20209].strTranslated = "inch/s";
-  strings[20210].strTranslated = "yard/s";
-  strings[20211].strTranslated = "Furlong/Fortnight";
+  std::map<uint32_t, LocStr> constants;
+  constants[20022].strTranslated = "";
+  constants[20027].strTranslated = "°F";
+  constants[20028].strTranslated = "K";
+  constants[20029].strTranslated = "°C";
+  constants[20030].strTranslated = "°Ré";
+  constants[20031].strTranslated = "°Ra";
+  constants[20032].strTranslated = "°Rø";
+  constants[20033].strTranslated = "°De";
+  constants[20034].strTranslated = "°N";
+
+  constants[20200].strTranslated = "km/h";
+  constants[20201].strTranslated = "m/min";
+  constants[20202].strTranslated = "m/s";
+  constants[20203].strTranslated = "ft/h";
+  constants[20204].strTranslated = "ft/min";
+  constants[20205].strTranslated = "ft/s";
+  constants[20206].strTranslated = "mph";
+  constants[20207].strTranslated = "kts";
+  constants[20208].strTranslated = "Beaufort";
+  constants[20209].strTranslated = "inch/s";
+  constants[20210].strTranslated = "yard/s";
+  constants[20211].strTranslated = "Furlong/Fortnight";
+
+  strings.Merge(CLocalizeStringTable(constants), true);
 
   CExclusiveLock lock(m_stringsMutex);
   Clear();
@@ -190,36 +521,29 @@ bool CLocalizeStrings::Load(const std::string& strPathName, const std::string& s
 const std::string& CLocalizeStrings::Get(uint32_t dwCode) const
 {
   CSharedLock lock(m_stringsMutex);
-  ciStrings i = m_strings.find(dwCode);
-  if (i == m_strings.end())
+  const std::string* string = m_strings.Find(dwCode);
+  if (!string)
   {
     return StringUtils::Empty;
   }
-  return i->second.strTranslated;
+  return *string;
 }
 
 void CLocalizeStrings::Clear()
 {
   CExclusiveLock lock(m_stringsMutex);
-  m_strings.clear();
+  m_strings = CLocalizeStringTable();
 }
 
 void CLocalizeStrings::Clear(uint32_t start, uint32_t end)
 {
   CExclusiveLock lock(m_stringsMutex);
-  iStrings it = m_strings.begin();
-  while (it != m_strings.end())
-  {
-    if (it->first >= start && it->first <= end)
-      m_strings.erase(it++);
-    else
-      ++it;
-  }
+  m_strings.Erase(start, end);
 }
 
 bool CLocalizeStrings::LoadAddonStrings(const std::string& path, const std::string& language, const std::string& addonId)
 {
-  std::map<uint32_t, LocStr> strings;
+  CLocalizeStringTable strings;
   if (!LoadWithFallback(path, language, strings))
     return false;
 
@@ -238,9 +562,9 @@ std::string CLocalizeStrings::GetAddonString(const std::string& addonId, uint32_
   if (i == m_addonStrings.end())
     return StringUtils::Empty;
 
-  auto j = i->second.find(code);
-  if (j == i->second.end())
+  const std::string* string = i->second.Find(code);
+  if (!string)
     return StringUtils::Empty;
 
-  return j->second.strTranslated;
+  return *string;
 }
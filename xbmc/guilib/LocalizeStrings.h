@@ -19,6 +19,7 @@
 #include <map>
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 /*!
  \ingroup strings
@@ -31,6 +32,51 @@ struct LocStr
   std::string strOriginal;   // the original English string the translation is based on
 };
 
+/*!
+ \ingroup strings
+ \brief Localized strings sorted by id, looked up by binary search.
+
+ Only the translated strings are kept, the originals are needed while merging
+ a translation with its English fallback only. Tables are compiled to a cache
+ file on first load, which is read instead of the strings.po files until they
+ change.
+ */
+class CLocalizeStringTable
+{
+public:
+  CLocalizeStringTable() = default;
+  explicit CLocalizeStringTable(const std::map<uint32_t, LocStr>& strings);
+
+  /*!
+   \brief Look up a string.
+   \return the string or nullptr if the id isn't in the table.
+   */
+  const std::string* Find(uint32_t code) const;
+
+  size_t Size() const { return m_ids.size(); }
+
+  /*!
+   \brief Remove the strings with ids in the range [start, end].
+   */
+  void Erase(uint32_t start, uint32_t end);
+
+  /*!
+   \brief Add the strings of another table.
+   \param replace whether strings of the other table replace the ones with the same id.
+   */
+  void Merge(CLocalizeStringTable&& other, bool replace);
+
+  /*!
+   \brief Append the compiled table: the sorted ids, the string offsets and the string pool.
+   */
+  void Serialize(std::string& data) const;
+  bool Deserialize(const char* data, size_t size);
+
+private:
+  std::vector<uint32_t> m_ids;
+  std::vector<std::string> m_strings;
+};
+
 // The default fallback language is fixed to be English
 const std::string LANGUAGE_DEFAULT = "resource.language.en_gb";
 const std::string LANGUAGE_OLD_DEFAULT = "English";
@@ -54,10 +100,8 @@ public:
 protected:
   void Clear(uint32_t start, uint32_t end);
 
-  std::map<uint32_t, LocStr> m_strings;
-  std::map<std::string, std::map<uint32_t, LocStr>> m_addonStrings;
-  typedef std::map<uint32_t, LocStr>::const_iterator ciStrings;
-  typedef std::map<uint32_t, LocStr>::iterator       iStrings;
+  CLocalizeStringTable m_strings;
+  std::map<std::string, CLocalizeStringTable> m_addonStrings;
 
   mutable CSharedSection m_stringsMutex;
   CSharedSection m_addonStringsMutex;
@@ -51,13 +51,16 @@ void CBaseTexture::Allocate(unsigned int width, unsigned int height, unsigned in
   m_textureWidth = m_imageWidth;
   m_textureHeight = m_imageHeight;
 
-  if (m_format & XB_FMT_DXT_MASK)
+  // without a render system there are no limits of a GPU to meet
+  CRenderSystemBase* renderSystem = CServiceBroker::GetRenderSystem();
+
+  if (renderSystem && (m_format & XB_FMT_DXT_MASK))
   {
-    while (GetPitch() < CServiceBroker::GetRenderSystem()->GetMinDXTPitch())
+    while (GetPitch() < renderSystem->GetMinDXTPitch())
       m_textureWidth += GetBlockSize();
   }
 
-  if (!CServiceBroker::GetRenderSystem()->SupportsNPOT((m_format & XB_FMT_DXT_MASK) != 0))
+  if (renderSystem && !renderSystem->SupportsNPOT((m_format & XB_FMT_DXT_MASK) != 0))
   {
     m_textureWidth = PadPow2(m_textureWidth);
     m_textureHeight = PadPow2(m_textureHeight);
@@ -86,8 +89,11 @@ void CBaseTexture::Allocate(unsigned int width, unsigned int height, unsigned in
 
   // check for max texture size
   #define CLAMP(x, y) { if (x > y) x = y; }
-  CLAMP(m_textureWidth, CServiceBroker::GetRenderSystem()->GetMaxTextureSize());
-  CLAMP(m_textureHeight, CServiceBroker::GetRenderSystem()->GetMaxTextureSize());
+  if (renderSystem)
+  {
+    CLAMP(m_textureWidth, renderSystem->GetMaxTextureSize());
+    CLAMP(m_textureHeight, renderSystem->GetMaxTextureSize());
+  }
   CLAMP(m_imageWidth, m_textureWidth);
   CLAMP(m_imageHeight, m_textureHeight);
 
@@ -0,0 +1,314 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "FileItem.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "guilib/LocalizeStrings.h"
+#include "utils/auto_buffer.h"
+
+#include <map>
+#include <string>
+
+#include <gtest/gtest.h>
+
+using namespace XFILE;
+
+namespace
+{
+const std::string LANGUAGES = "special://temp/localizestrings/";
+const std::string CACHE = "special://temp/languagecache/";
+const std::string GERMAN = "resource.language.de_de";
+const std::map<uint32_t, std::string> ENGLISH = {{100, "Hello"}, {101, "World"}, {102, "Again"}};
+
+CLocalizeStringTable CreateTable(const std::map<uint32_t, std::string>& strings)
+{
+  std::map<uint32_t, LocStr> table;
+  for (const auto& string : strings)
+    table[string.first].strTranslated = string.second;
+  return CLocalizeStringTable(table);
+}
+
+std::string Get(const CLocalizeStringTable& table, uint32_t code)
+{
+  const std::string* string = table.Find(code);
+  return string ? *string : "<none>";
+}
+
+bool WriteFile(const std::string& path, const std::string& data)
+{
+  CFile file;
+  if (!file.OpenForWrite(path, true))
+    return false;
+  const bool written = file.Write(data.data(), data.size()) == static_cast<ssize_t>(data.size());
+  file.Close();
+  return written;
+}
+
+std::string ReadFile(const std::string& path)
+{
+  CFile file;
+  XUTILS::auto_buffer buffer;
+  if (file.LoadFile(path, buffer) <= 0)
+    return "";
+  return std::string(buffer.get(), buffer.size());
+}
+
+/*!
+ \brief Write the strings.po file of a language.
+ \param originals the English strings, if the strings are a translation of them
+ */
+void WritePO(const std::string& language, const std::map<uint32_t, std::string>& strings,
+             const std::map<uint32_t, std::string>& originals = {})
+{
+  std::string po = "msgid \"\"\n"
+                   "msgstr \"\"\n"
+                   "\"Language: en\\n\"\n";
+  for (const auto& string : strings)
+  {
+    po += "\nmsgctxt \"#" + std::to_string(string.first) + "\"\n";
+    if (!originals.empty())
+      po += "msgid \"" + originals.at(string.first) + "\"\nmsgstr \"" + string.second + "\"\n";
+    else
+      po += "msgid \"" + string.second + "\"\nmsgstr \"\"\n";
+  }
+
+  ASSERT_TRUE(CDirectory::Create(LANGUAGES + language));
+  ASSERT_TRUE(WriteFile(LANGUAGES + language + "/strings.po", po));
+}
+} // unnamed namespace
+
+class TestLocalizeStrings : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    CDirectory::RemoveRecursive(LANGUAGES);
+    CDirectory::RemoveRecursive(CACHE);
+    ASSERT_TRUE(CDirectory::Create(LANGUAGES));
+
+    WritePO(LANGUAGE_DEFAULT, ENGLISH);
+    WritePO(GERMAN, {{100, "Hallo"}, {101, "Welt"}}, ENGLISH);
+  }
+
+  void TearDown() override
+  {
+    CDirectory::RemoveRecursive(LANGUAGES);
+    CDirectory::RemoveRecursive(CACHE);
+  }
+
+  // path of the only compiled table
+  std::string GetCompiledTable()
+  {
+    CFileItemList items;
+    if (!CDirectory::GetDirectory(CACHE, items, ".strings", DIR_FLAG_DEFAULTS) || items.Size() != 1)
+      return "";
+    return items[0]->GetPath();
+  }
+
+  void ExpectGerman(const CLocalizeStrings& strings)
+  {
+    EXPECT_EQ("Hallo", strings.Get(100));
+    EXPECT_EQ("Welt", strings.Get(101));
+    // English is the fallback
+    EXPECT_EQ("Again", strings.Get(102));
+    EXPECT_EQ("", strings.Get(103));
+  }
+};
+
+TEST_F(TestLocalizeStrings, TableLookup)
+{
+  const CLocalizeStringTable table = CreateTable({{5, "five"}, {1, "one"}, {3, ""}});
+  EXPECT_EQ(3u, table.Size());
+  EXPECT_EQ("one", Get(table, 1));
+  EXPECT_EQ("", Get(table, 3));
+  EXPECT_EQ("five", Get(table, 5));
+  EXPECT_EQ("<none>", Get(table, 0));
+  EXPECT_EQ("<none>", Get(table, 2));
+  EXPECT_EQ("<none>", Get(table, 6));
+  EXPECT_EQ("<none>", Get(CLocalizeStringTable(), 1));
+}
+
+TEST_F(TestLocalizeStrings, TableErase)
+{
+  CLocalizeStringTable table = CreateTable({{1, "one"}, {2, "two"}, {4, "four"}, {6, "six"}, {7, "seven"}});
+
+  // the range is inclusive and doesn't have to start or end at an id
+  table.Erase(2, 5);
+  EXPECT_EQ(3u, table.Size());
+  EXPECT_EQ("one", Get(table, 1));
+  EXPECT_EQ("<none>", Get(table, 2));
+  EXPECT_EQ("<none>", Get(table, 4));
+  EXPECT_EQ("six", Get(table, 6));
+
+  table.Erase(7, 7);
+  EXPECT_EQ("<none>", Get(table, 7));
+  table.Erase(100, 200);
+  EXPECT_EQ(2u, table.Size());
+}
+
+TEST_F(TestLocalizeStrings, TableMerge)
+{
+  CLocalizeStringTable table = CreateTable({{1, "one"}, {3, "three"}, {5, "five"}});
+
+  // the strings already there stay without replace
+  table.Merge(CreateTable({{0, "zero"}, {3, "drei"}, {4, "vier"}, {9, "neun"}}), false);
+  EXPECT_EQ(6u, table.Size());
+  EXPECT_EQ("zero", Get(table, 0));
+  EXPECT_EQ("one", Get(table, 1));
+  EXPECT_EQ("three", Get(table, 3));
+  EXPECT_EQ("vier", Get(table, 4));
+  EXPECT_EQ("five", Get(table, 5));
+  EXPECT_EQ("neun", Get(table, 9));
+
+  table.Merge(CreateTable({{3, "drei"}, {5, ""}}), true);
+  EXPECT_EQ(6u, table.Size());
+  EXPECT_EQ("drei", Get(table, 3));
+  EXPECT_EQ("", Get(table, 5));
+
+  // the merged table is emptied
+  CLocalizeStringTable other = CreateTable({{10, "ten"}});
+  table.Merge(std::move(other), false);
+  EXPECT_EQ("ten", Get(table, 10));
+  EXPECT_EQ(0u, other.Size());
+}
+
+TEST_F(TestLocalizeStrings, TableSerialization)
+{
+  const CLocalizeStringTable table = CreateTable({{1, "one"}, {2, ""}, {31000, "skin"}, {0xFFFFFFFF, "last"}});
+  std::string data;
+  table.Serialize(data);
+
+  CLocalizeStringTable loaded;
+  ASSERT_TRUE(loaded.Deserialize(data.data(), data.size()));
+  EXPECT_EQ(4u, loaded.Size());
+  EXPECT_EQ("one", Get(loaded, 1));
+  EXPECT_EQ("", Get(loaded, 2));
+  EXPECT_EQ("skin", Get(loaded, 31000));
+  EXPECT_EQ("last", Get(loaded, 0xFFFFFFFF));
+
+  std::string empty;
+  CLocalizeStringTable().Serialize(empty);
+  EXPECT_TRUE(loaded.Deserialize(empty.data(), empty.size()));
+  EXPECT_EQ(0u, loaded.Size());
+}
+
+TEST_F(TestLocalizeStrings, DamagedTableIsRejected)
+{
+  std::string data;
+  CreateTable({{1, "one"}, {2, "two"}}).Serialize(data);
+
+  // truncated or with trailing data
+  CLocalizeStringTable loaded = CreateTable({{7, "seven"}});
+  for (size_t size = 0; size < data.size(); size++)
+    EXPECT_FALSE(loaded.Deserialize(data.data(), size)) << size;
+  EXPECT_FALSE(loaded.Deserialize((data + "x").data(), data.size() + 1));
+
+  // a count larger than the data
+  std::string count = data;
+  count[0] = 100;
+  EXPECT_FALSE(loaded.Deserialize(count.data(), count.size()));
+
+  // ids out of order
+  std::string order = data;
+  order[4] = 3;
+  EXPECT_FALSE(loaded.Deserialize(order.data(), order.size()));
+
+  // an offset past the pool
+  std::string offset = data;
+  offset[16] = 100;
+  EXPECT_FALSE(loaded.Deserialize(offset.data(), offset.size()));
+
+  // a failed load leaves the table alone
+  EXPECT_EQ(1u, loaded.Size());
+  EXPECT_EQ("seven", Get(loaded, 7));
+}
+
+TEST_F(TestLocalizeStrings, CompiledTableRoundTrip)
+{
+  CLocalizeStrings strings;
+  ASSERT_TRUE(strings.Load(LANGUAGES, GERMAN));
+  ExpectGerman(strings);
+
+  const std::string compiled = GetCompiledTable();
+  ASSERT_FALSE(compiled.empty());
+
+  // the compiled table is read instead of the strings.po files: change a string in it
+  std::string data = ReadFile(compiled);
+  const size_t pos = data.find("Welt");
+  ASSERT_NE(std::string::npos, pos);
+  data.replace(pos, 4, "WELT");
+  ASSERT_TRUE(WriteFile(compiled, data));
+
+  CLocalizeStrings cached;
+  ASSERT_TRUE(cached.Load(LANGUAGES, GERMAN));
+  EXPECT_EQ("Hallo", cached.Get(100));
+  EXPECT_EQ("WELT", cached.Get(101));
+  EXPECT_EQ("Again", cached.Get(102));
+
+  // the constant strings are added to the loaded ones
+  EXPECT_EQ("km/h", cached.Get(20200));
+}
+
+TEST_F(TestLocalizeStrings, ChangedSourceRebuildsTable)
+{
+  CLocalizeStrings strings;
+  ASSERT_TRUE(strings.Load(LANGUAGES, GERMAN));
+  const std::string compiled = GetCompiledTable();
+  ASSERT_FALSE(compiled.empty());
+
+  // the size of the fallback changes, so does its stamp
+  WritePO(LANGUAGE_DEFAULT, {{100, "Hello"}, {101, "World"}, {102, "Once more"}});
+  CLocalizeStrings changed;
+  ASSERT_TRUE(changed.Load(LANGUAGES, GERMAN));
+  EXPECT_EQ("Hallo", changed.Get(100));
+  EXPECT_EQ("Once more", changed.Get(102));
+
+  // the table was compiled again, to the same file
+  EXPECT_EQ(compiled, GetCompiledTable());
+  EXPECT_NE(std::string::npos, ReadFile(compiled).find("Once more"));
+
+  // another language gets a table of its own
+  CLocalizeStrings english;
+  ASSERT_TRUE(english.Load(LANGUAGES, LANGUAGE_DEFAULT));
+  EXPECT_EQ("Hello", english.Get(100));
+  CFileItemList items;
+  ASSERT_TRUE(CDirectory::GetDirectory(CACHE, items, ".strings", DIR_FLAG_DEFAULTS));
+  EXPECT_EQ(2, items.Size());
+}
+
+TEST_F(TestLocalizeStrings, DamagedCompiledTableIsRebuilt)
+{
+  CLocalizeStrings strings;
+  ASSERT_TRUE(strings.Load(LANGUAGES, GERMAN));
+  const std::string compiled = GetCompiledTable();
+  ASSERT_FALSE(compiled.empty());
+  const std::string data = ReadFile(compiled);
+  ASSERT_FALSE(data.empty());
+
+  // truncated
+  ASSERT_TRUE(WriteFile(compiled, data.substr(0, data.size() - 3)));
+  CLocalizeStrings truncated;
+  ASSERT_TRUE(truncated.Load(LANGUAGES, GERMAN));
+  ExpectGerman(truncated);
+  EXPECT_EQ(data, ReadFile(compiled));
+
+  // not a compiled table
+  ASSERT_TRUE(WriteFile(compiled, std::string(data.size(), 'x')));
+  CLocalizeStrings corrupt;
+  ASSERT_TRUE(corrupt.Load(LANGUAGES, GERMAN));
+  ExpectGerman(corrupt);
+  EXPECT_EQ(data, ReadFile(compiled));
+
+  // empty
+  ASSERT_TRUE(WriteFile(compiled, ""));
+  CLocalizeStrings empty;
+  ASSERT_TRUE(empty.Load(LANGUAGES, GERMAN));
+  ExpectGerman(empty);
+  EXPECT_EQ(data, ReadFile(compiled));
+}
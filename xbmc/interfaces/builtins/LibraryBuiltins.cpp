@@ -244,7 +244,7 @@ static int ExportLibrary2(const std::vector<std::string>& params)
 
 /*! \brief Update a library.
  *  \param params The parameters.
- *  \details params[0] = "video" or "music".
+ *  \details params[0] = "video", "music" or "pictures".
  *           params[1] = "true" to suppress dialogs (optional).
  */
 static int UpdateLibrary(const std::vector<std::string>& params)
@@ -266,6 +266,13 @@ static int UpdateLibrary(const std::vector<std::string>& params)
     else
       g_application.StartVideoScan(params.size() > 1 ? params[1] : "", userInitiated);
   }
+  else if (StringUtils::EqualsNoCase(params[0], "pictures"))
+  {
+    if (g_application.IsPictureScanning())
+      g_application.StopPictureScan();
+    else
+      g_application.StartPictureScan(params.size() > 1 ? params[1] : "", userInitiated);
+  }
 
   return 0;
 }
@@ -329,8 +336,8 @@ static int SearchVideoLibrary(const std::vector<std::string>& params)
 ///   \table_row2_l{
 ///     <b>`updatelibrary([type\, suppressDialogs])`</b>
 ///     ,
-///     Update the selected library (music or video)
-///     @param[in] type                  "video" or "music".
+///     Update the selected library (music, video or pictures)
+///     @param[in] type                  "video", "music" or "pictures".
 ///     @param[in] suppressDialogs       Add "true" to suppress dialogs (optional).
 ///   }
 ///   \table_row2_l{
@@ -347,7 +354,7 @@ CBuiltins::CommandMap CLibraryBuiltins::GetOperations() const
           {"cleanlibrary",        {"Clean the video/music library", 1, CleanLibrary}},
           {"exportlibrary",       {"Export the video/music library", 1, ExportLibrary}},
           {"exportlibrary2",      {"Export the video/music library", 1, ExportLibrary2}},
-          {"updatelibrary",       {"Update the selected library (music or video)", 1, UpdateLibrary}},
+          {"updatelibrary",       {"Update the selected library (music, video or pictures)", 1, UpdateLibrary}},
           {"videolibrary.search", {"Brings up a search dialog which will search the library", 0, SearchVideoLibrary}}
          };
 }
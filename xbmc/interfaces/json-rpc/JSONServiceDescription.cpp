@@ -235,7 +235,8 @@ JsonRpcMethodMap CJSONServiceDescription::m_methodMaps[] = {
 
 // XBMC operations
   { "XBMC.GetInfoLabels",                           CXBMCOperations::GetInfoLabels },
-  { "XBMC.GetInfoBooleans",                         CXBMCOperations::GetInfoBooleans }
+  { "XBMC.GetInfoBooleans",                         CXBMCOperations::GetInfoBooleans },
+  { "XBMC.GetDatabaseStats",                        CXBMCOperations::GetDatabaseStats }
 };
 
 JSONSchemaTypeDefinition::JSONSchemaTypeDefinition()
@@ -9,8 +9,11 @@
 #include "XBMCOperations.h"
 
 #include "ServiceBroker.h"
+#include "dbwrappers/DatabaseStats.h"
 #include "messaging/ApplicationMessenger.h"
 #include "powermanagement/PowerManager.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/SettingsComponent.h"
 #include "utils/Variant.h"
 
 using namespace JSONRPC;
@@ -85,3 +88,29 @@ JSONRPC_STATUS CXBMCOperations::GetInfoBooleans(const std::string &method, ITran
 
   return OK;
 }
+
+JSONRPC_STATUS CXBMCOperations::GetDatabaseStats(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  CDatabaseStats& stats = CDatabaseStats::GetInstance();
+
+  result["enabled"] = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_databaseStatsEnabled;
+  result["queries"] = CVariant(CVariant::VariantTypeArray);
+  for (const auto& query : stats.GetStats(static_cast<size_t>(parameterObject["limit"].asUnsignedInteger())))
+  {
+    CVariant item(CVariant::VariantTypeObject);
+    item["database"] = query.database;
+    item["fingerprint"] = query.fingerprint;
+    item["count"] = query.count;
+    item["rows"] = query.rows;
+    item["totaltime"] = query.totalTime;
+    item["p50time"] = query.p50Time;
+    item["p99time"] = query.p99Time;
+    item["maxtime"] = query.maxTime;
+    result["queries"].push_back(item);
+  }
+
+  if (parameterObject["reset"].asBoolean())
+    stats.Reset();
+
+  return OK;
+}
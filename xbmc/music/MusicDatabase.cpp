@@ -4791,60 +4791,78 @@ bool CMusicDatabase::GetSongsByWhere(const std::string &baseDir, const Filter &f
     strSQL = PrepareSQL(strSQL, !filter.fields.empty() && filter.fields.compare("*") != 0 ? filter.fields.c_str() : "songview.*") + strSQLExtra;
 
     CLog::Log(LOGDEBUG, "%s query = %s", __FUNCTION__, strSQL.c_str());
-    // run query
-    if (!m_pDS->query(strSQL))
+    // the rows are read one at a time and turned into items right away, only a sorted and
+    // limited listing keeps them until it's known which of them are listed
+    std::unique_ptr<dbiplus::Statement> statement = PrepareStatement(strSQL);
+    if (!statement)
       return false;
 
-    int iRowsFound = m_pDS->num_rows();
-    if (iRowsFound == 0)
+    const bool keepRows = sortDescription.sortBy != SortByNone &&
+                          (sortDescription.limitStart > 0 || sortDescription.limitEnd > 0);
+    const FieldList sortFields = SortUtils::GetSortFields(sortDescription.sortBy, MediaTypeSong);
+
+    DatabaseResults results;
+    std::vector<CFileItemPtr> songs;
+    std::vector<dbiplus::sql_record> rows;
+    dbiplus::sql_record record;
+    while (statement->step())
     {
-      m_pDS->close();
-      return true;
+      statement->getRecord(record);
+
+      DatabaseResult result;
+      if (!DatabaseUtils::GetDatabaseResult(MediaTypeSong, sortFields, record, results.size(), result))
+        return false;
+      results.push_back(std::move(result));
+
+      if (keepRows)
+        rows.push_back(record);
+      else
+      {
+        CFileItemPtr item(new CFileItem);
+        GetFileItemFromDataset(&record, item.get(), musicUrl);
+        songs.push_back(item);
+      }
     }
+    statement.reset();
+
+    int iRowsFound = static_cast<int>(results.size());
+    if (iRowsFound == 0)
+      return true;
 
     // store the total value of items as a property
     if (total < iRowsFound)
       total = iRowsFound;
     items.SetProperty("total", total);
 
-    DatabaseResults results;
-    results.reserve(iRowsFound);
-    if (!SortUtils::SortFromDataset(sortDescription, MediaTypeSong, m_pDS, results))
-      return false;
+    SortUtils::SortDatabaseResults(sortDescription, results);
 
     // get data from returned rows
     items.Reserve(results.size());
-    const dbiplus::query_data &data = m_pDS->get_result_set().records;
     int count = 0;
     for (const auto &i : results)
     {
       unsigned int targetRow = (unsigned int)i.at(FieldRow).asInteger();
-      const dbiplus::sql_record* const record = data.at(targetRow);
 
       try
       {
-        CFileItemPtr item(new CFileItem);
-        GetFileItemFromDataset(record, item.get(), musicUrl);
+        CFileItemPtr item = keepRows ? CFileItemPtr(new CFileItem) : songs.at(targetRow);
+        if (keepRows)
+          GetFileItemFromDataset(&rows.at(targetRow), item.get(), musicUrl);
         // HACK for sorting by database returned order
         item->m_iprogramCount = ++count;
         items.Add(item);
       }
       catch (...)
       {
-        m_pDS->close();
         CLog::Log(LOGERROR, "%s: out of memory loading query: %s", __FUNCTION__, filter.where.c_str());
         return (items.Size() > 0);
       }
     }
 
-    // cleanup
-    m_pDS->close();
     return true;
   }
   catch (...)
   {
-    // cleanup
-    m_pDS->close();
     CLog::Log(LOGERROR, "%s(%s) failed", __FUNCTION__, filter.where.c_str());
   }
   return false;
@@ -10693,19 +10711,16 @@ bool CMusicDatabase::GetArtForItem(int mediaId, const std::string &mediaType, st
 {
   try
   {
-    if (nullptr == m_pDB)
+    // a statement of its own, as we're likely called in loops on the datasets
+    const std::shared_ptr<dbiplus::Statement> statement = GetStatement("SELECT type,url FROM art WHERE media_id=? AND media_type=?");
+    if (nullptr == statement)
       return false;
-    if (nullptr == m_pDS2)
-      return false; // using dataset 2 as we're likely called in loops on dataset 1
 
-    std::string sql = PrepareSQL("SELECT type,url FROM art WHERE media_id=%i AND media_type='%s'", mediaId, mediaType.c_str());
-    m_pDS2->query(sql);
-    while (!m_pDS2->eof())
-    {
-      art.insert(std::make_pair(m_pDS2->fv(0).get_asString(), m_pDS2->fv(1).get_asString()));
-      m_pDS2->next();
-    }
-    m_pDS2->close();
+    statement->bind(1, mediaId);
+    statement->bind(2, mediaType);
+    while (statement->step())
+      art.insert(std::make_pair(statement->getString(0), statement->getString(1)));
+
     return !art.empty();
   }
   catch (...)
@@ -10717,8 +10732,23 @@ bool CMusicDatabase::GetArtForItem(int mediaId, const std::string &mediaType, st
 
 std::string CMusicDatabase::GetArtForItem(int mediaId, const std::string &mediaType, const std::string &artType)
 {
-  std::string query = PrepareSQL("SELECT url FROM art WHERE media_id=%i AND media_type='%s' AND type='%s'", mediaId, mediaType.c_str(), artType.c_str());
-  return GetSingleValue(query, m_pDS2);
+  try
+  {
+    const std::shared_ptr<dbiplus::Statement> statement = GetStatement("SELECT url FROM art WHERE media_id=? AND media_type=? AND type=?");
+    if (nullptr == statement)
+      return "";
+
+    statement->bind(1, mediaId);
+    statement->bind(2, mediaType);
+    statement->bind(3, artType);
+    if (statement->step())
+      return statement->getString(0);
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s(%d, '%s', '%s') failed", __FUNCTION__, mediaId, mediaType.c_str(), artType.c_str());
+  }
+  return "";
 }
 
 bool CMusicDatabase::RemoveArtForItem(int mediaId, const MediaType & mediaType, const std::string & artType)
@@ -10837,6 +10867,7 @@ bool CMusicDatabase::GetFilter(CDbUrl &musicUrl, Filter &filter, SortDescription
     if (xsp.GetType() == type ||
       (xsp.GetGroup() == type && !xsp.IsGroupMixed()))
     {
+      ExplainFilter(CSmartPlaylist::GetView(xsp.GetType()), xspWhere);
       filter.AppendWhere(xspWhere);
 
       if (xsp.GetLimit() > 0)
@@ -11244,7 +11275,9 @@ bool CMusicDatabase::GetFilter(CDbUrl &musicUrl, Filter &filter, SortDescription
     if (xspFilter.GetType() == type)
     {
       std::set<std::string> playlists;
-      filter.AppendWhere(xspFilter.GetWhereClause(*this, playlists));
+      const std::string xspWhere = xspFilter.GetWhereClause(*this, playlists);
+      ExplainFilter(CSmartPlaylist::GetView(xspFilter.GetType()), xspWhere);
+      filter.AppendWhere(xspWhere);
     }
     // remove the filter if it doesn't match the item type
     else
@@ -0,0 +1,206 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "DatabaseManager.h"
+#include "FileItem.h"
+#include "ServiceBroker.h"
+#include "music/MusicDatabase.h"
+#include "music/Song.h"
+#include "music/tags/MusicInfoTag.h"
+#include "utils/SortUtils.h"
+#include "utils/Variant.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+const int SONGS = 1000;
+const int ALBUMS = 50;
+const int ARTISTS = 20;
+
+/*!
+ \brief The music database filled with a synthetic library. The titles are a permutation of
+ the song ids, so that sorting by title reorders them, and only every third song has a comment,
+ so that the listing reads NULL values as well.
+ */
+class CSyntheticMusicDatabase : public CMusicDatabase
+{
+public:
+  bool Fill()
+  {
+    const std::string numbers = "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %i) ";
+    return ExecuteQuery("INSERT INTO path (idPath, strPath) VALUES (1, 'special://temp/musicdatabase/')") &&
+           ExecuteQuery(PrepareSQL(numbers + "INSERT INTO artist (idArtist, strArtist) SELECT i + 1, 'Artist ' || i FROM n", ARTISTS)) &&
+           ExecuteQuery(PrepareSQL(numbers + "INSERT INTO album (idAlbum, strAlbum, strArtistDisp, strReleaseType) "
+                                  "SELECT i, 'Album ' || i, 'Artist ' || (i %% %i + 1), 'album' FROM n", ALBUMS, ARTISTS)) &&
+           ExecuteQuery(PrepareSQL(numbers + "INSERT INTO album_artist SELECT i %% %i + 2, i, 0, 'Artist ' || (i %% %i + 1) FROM n",
+                                  ALBUMS, ARTISTS, ARTISTS)) &&
+           ExecuteQuery(PrepareSQL(numbers + "INSERT INTO song (idSong, idAlbum, idPath, strArtistDisp, strTitle, iTrack, iDuration, "
+                                  "strFileName, comment, iTimesPlayed, dateAdded) "
+                                  "SELECT i, i %% %i + 1, 1, 'Artist ' || (i %% %i + 1), 'Song ' || (i * 7919 %% %i), i %% 20 + 1, i, "
+                                  "'song' || i || '.mp3', CASE WHEN i %% 3 = 0 THEN 'Comment ' || i END, i %% 4, "
+                                  "'2020-01-01 00:00:00' FROM n", SONGS, ALBUMS, ARTISTS, SONGS)) &&
+           ExecuteQuery(PrepareSQL(numbers + "INSERT INTO song_artist SELECT i %% %i + 2, i, 1, 0, 'Artist ' || (i %% %i + 1) FROM n",
+                                  SONGS, ARTISTS, ARTISTS));
+  }
+
+  void Empty()
+  {
+    ExecuteQuery("DELETE FROM song_artist");
+    ExecuteQuery("DELETE FROM song");
+    ExecuteQuery("DELETE FROM album_artist");
+    ExecuteQuery("DELETE FROM album");
+    ExecuteQuery("DELETE FROM path");
+    ExecuteQuery("DELETE FROM artist WHERE idArtist > 1");
+  }
+};
+
+SortDescription GetPage(SortBy sortBy, int start, int end)
+{
+  SortDescription sorting;
+  sorting.sortBy = sortBy;
+  sorting.sortOrder = SortOrderAscending;
+  sorting.limitStart = start;
+  sorting.limitEnd = end;
+  return sorting;
+}
+
+std::vector<std::string> GetPaths(const CFileItemList& items)
+{
+  std::vector<std::string> paths;
+  for (int i = 0; i < items.Size(); i++)
+    paths.emplace_back(items[i]->GetPath());
+  return paths;
+}
+} // unnamed namespace
+
+class TestMusicDatabase : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    // the database manager has to create the databases before they can be opened
+    CServiceBroker::GetDatabaseManager().Initialize();
+
+    CSyntheticMusicDatabase database;
+    ASSERT_TRUE(database.Open());
+    database.Empty();
+    ASSERT_TRUE(database.Fill());
+    database.Close();
+  }
+
+  static void TearDownTestCase()
+  {
+    CSyntheticMusicDatabase database;
+    if (database.Open())
+    {
+      database.Empty();
+      database.Close();
+    }
+  }
+
+  void SetUp() override { ASSERT_TRUE(m_database.Open()); }
+
+  void TearDown() override { m_database.Close(); }
+
+  bool GetSongs(const SortDescription& sorting, CFileItemList& items)
+  {
+    CDatabase::Filter filter;
+    return m_database.GetSongsByWhere("musicdb://songs/", filter, items, sorting);
+  }
+
+  // the listed songs are the same as the ones read by a lookup through a dataset
+  void ExpectSameAsLookup(const CFileItemList& items)
+  {
+    for (int i = 0; i < items.Size(); i++)
+    {
+      ASSERT_TRUE(items[i]->HasMusicInfoTag());
+      const MUSIC_INFO::CMusicInfoTag& tag = *items[i]->GetMusicInfoTag();
+
+      CSong expected;
+      ASSERT_TRUE(m_database.GetSong(tag.GetDatabaseId(), expected));
+      EXPECT_EQ(expected.strTitle, tag.GetTitle());
+      EXPECT_EQ(expected.strTitle, items[i]->GetLabel());
+      EXPECT_EQ(expected.strAlbum, tag.GetAlbum());
+      EXPECT_EQ(expected.idAlbum, tag.GetAlbumId());
+      EXPECT_EQ(expected.GetArtistString(), tag.GetArtistString());
+      EXPECT_EQ(expected.iTrack, tag.GetTrackNumber());
+      EXPECT_EQ(expected.iDuration, tag.GetDuration());
+      EXPECT_EQ(expected.strFileName, tag.GetURL());
+      EXPECT_EQ(expected.strComment, tag.GetComment());
+      EXPECT_EQ(expected.iTimesPlayed, tag.GetPlayCount());
+    }
+  }
+
+  CSyntheticMusicDatabase m_database;
+};
+
+TEST_F(TestMusicDatabase, UnsortedListingMatchesLookups)
+{
+  CFileItemList items;
+  ASSERT_TRUE(GetSongs(GetPage(SortByNone, 0, -1), items));
+  ASSERT_EQ(SONGS, items.Size());
+  EXPECT_EQ(SONGS, items.GetProperty("total").asInteger());
+  ExpectSameAsLookup(items);
+
+  int comments = 0;
+  for (int i = 0; i < items.Size(); i++)
+    comments += items[i]->GetMusicInfoTag()->GetComment().empty() ? 0 : 1;
+  EXPECT_EQ(SONGS / 3, comments);
+}
+
+TEST_F(TestMusicDatabase, UnsortedPageIsLimitedInDatabase)
+{
+  CFileItemList all;
+  ASSERT_TRUE(GetSongs(GetPage(SortByNone, 0, -1), all));
+
+  CFileItemList page;
+  ASSERT_TRUE(GetSongs(GetPage(SortByNone, 100, 150), page));
+  ASSERT_EQ(50, page.Size());
+  EXPECT_EQ(SONGS, page.GetProperty("total").asInteger());
+
+  const std::vector<std::string> paths = GetPaths(all);
+  EXPECT_EQ(std::vector<std::string>(paths.begin() + 100, paths.begin() + 150), GetPaths(page));
+  ExpectSameAsLookup(page);
+}
+
+TEST_F(TestMusicDatabase, SortedPagesMatchSortedListing)
+{
+  CFileItemList all;
+  ASSERT_TRUE(GetSongs(GetPage(SortByTitle, 0, -1), all));
+  ASSERT_EQ(SONGS, all.Size());
+  ExpectSameAsLookup(all);
+
+  const int pageSize = 300;
+  std::vector<std::string> paths;
+  for (int start = 0; start < SONGS; start += pageSize)
+  {
+    CFileItemList page;
+    ASSERT_TRUE(GetSongs(GetPage(SortByTitle, start, start + pageSize), page));
+    EXPECT_EQ(std::min(pageSize, SONGS - start), page.Size());
+    EXPECT_EQ(SONGS, page.GetProperty("total").asInteger());
+    ExpectSameAsLookup(page);
+
+    // the items are numbered in the order they are listed
+    for (int i = 0; i < page.Size(); i++)
+      EXPECT_EQ(i + 1, page[i]->m_iprogramCount);
+
+    const std::vector<std::string> pagePaths = GetPaths(page);
+    paths.insert(paths.end(), pagePaths.begin(), pagePaths.end());
+  }
+  EXPECT_EQ(GetPaths(all), paths);
+
+  // the title order differs from the database order
+  CFileItemList unsorted;
+  ASSERT_TRUE(GetSongs(GetPage(SortByNone, 0, -1), unsorted));
+  EXPECT_NE(GetPaths(unsorted), paths);
+}
@@ -8,10 +8,14 @@
 
 #include "DNSNameCache.h"
 
+#include "threads/Event.h"
 #include "threads/SingleLock.h"
+#include "utils/JobManager.h"
 #include "utils/StringUtils.h"
 #include "utils/log.h"
 
+#include <algorithm>
+
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <netinet/in.h>
@@ -20,16 +24,114 @@ CDNSNameCache g_DNSCache;
 
 CCriticalSection CDNSNameCache::m_critical;
 
+const unsigned int CDNSNameCache::MAX_TTL_SECONDS;
+
+class CDNSNameCache::CLookup
+{
+public:
+  CEvent m_done{true};
+  std::string m_strIpAddress;
+};
+
 CDNSNameCache::CDNSNameCache(void) = default;
 
 CDNSNameCache::~CDNSNameCache(void) = default;
 
-bool CDNSNameCache::Lookup(const std::string& strHostName, std::string& strIpAddress)
+bool CDNSNameCache::Lookup(const std::string& strHostName, std::string& strIpAddress, bool bRetryFailures /* = false */)
+{
+  if (strHostName.empty() && strIpAddress.empty())
+    return false;
+
+  if (GetAddress(strHostName, strIpAddress))
+    return true;
+
+  std::shared_ptr<CLookup> lookup;
+  bool bResolve = false;
+  {
+    CSingleLock lock(m_critical);
+    // check if there's a custom entry or if it's already cached
+    if (GetCached(strHostName, strIpAddress, bRetryFailures))
+      return !strIpAddress.empty();
+
+    // join the lookup in flight, if any
+    std::shared_ptr<CLookup>& inFlight = g_DNSCache.m_lookups[strHostName];
+    if (!inFlight)
+    {
+      inFlight = std::make_shared<CLookup>();
+      bResolve = true;
+    }
+    lookup = inFlight;
+  }
+
+  if (bResolve)
+    Resolve(strHostName, lookup);
+  else
+    lookup->m_done.Wait();
+
+  strIpAddress = lookup->m_strIpAddress;
+  return !strIpAddress.empty();
+}
+
+bool CDNSNameCache::LookupAsync(const std::string& strHostName, std::string& strIpAddress, bool bRetryFailures /* = false */)
 {
   if (strHostName.empty() && strIpAddress.empty())
     return false;
 
-  // first see if this is already an ip address
+  if (GetAddress(strHostName, strIpAddress))
+    return true;
+
+  CSingleLock lock(m_critical);
+  if (GetCached(strHostName, strIpAddress, bRetryFailures))
+    return !strIpAddress.empty();
+
+  std::shared_ptr<CLookup>& inFlight = g_DNSCache.m_lookups[strHostName];
+  if (!inFlight)
+  {
+    std::shared_ptr<CLookup> lookup = std::make_shared<CLookup>();
+    inFlight = lookup;
+    CJobManager::GetInstance().Submit([strHostName, lookup]() {
+      Resolve(strHostName, lookup);
+    }, CJob::PRIORITY_HIGH);
+  }
+  return false;
+}
+
+void CDNSNameCache::Resolve(const std::string& strHostName, const std::shared_ptr<CLookup>& lookup)
+{
+  Resolver resolver;
+  {
+    CSingleLock lock(m_critical);
+    resolver = g_DNSCache.m_resolver;
+  }
+
+  std::string strIpAddress;
+  unsigned int ttlSeconds = DEFAULT_TTL_SECONDS;
+  bool bResolved = resolver ? resolver(strHostName, strIpAddress, ttlSeconds)
+                            : ResolveSystem(strHostName, strIpAddress, ttlSeconds);
+  if (!bResolved)
+  {
+    strIpAddress.clear();
+    ttlSeconds = NEGATIVE_TTL_SECONDS;
+  }
+
+  {
+    CSingleLock lock(m_critical);
+    // failures are cached too, so that an unreachable host doesn't stall every caller
+    CDNSName& dnsName = g_DNSCache.m_dnsNames[strHostName];
+    if (!dnsName.m_expires.IsInfinite()) // don't replace custom entries added meanwhile
+    {
+      dnsName.m_strIpAddress = strIpAddress;
+      dnsName.m_expires.Set(std::min(ttlSeconds, MAX_TTL_SECONDS) * 1000);
+    }
+    g_DNSCache.m_lookups.erase(strHostName);
+    lookup->m_strIpAddress = dnsName.m_strIpAddress;
+  }
+  lookup->m_done.Set();
+}
+
+bool CDNSNameCache::GetAddress(const std::string& strHostName, std::string& strIpAddress)
+{
+  // see if this is already an ip address
   unsigned long address = inet_addr(strHostName.c_str());
   strIpAddress.clear();
 
@@ -38,13 +140,16 @@ bool CDNSNameCache::Lookup(const std::string& strHostName, std::string& strIpAdd
     strIpAddress = StringUtils::Format("%lu.%lu.%lu.%lu", (address & 0xFF), (address & 0xFF00) >> 8, (address & 0xFF0000) >> 16, (address & 0xFF000000) >> 24 );
     return true;
   }
+  return false;
+}
 
-  // check if there's a custom entry or if it's already cached
-  if(g_DNSCache.GetCached(strHostName, strIpAddress))
-    return true;
+bool CDNSNameCache::ResolveSystem(const std::string& strHostName, std::string& strIpAddress, unsigned int& ttlSeconds)
+{
+  // the system resolver doesn't tell the ttl of the record
+  ttlSeconds = DEFAULT_TTL_SECONDS;
 
 #if !defined(TARGET_WINDOWS) && defined(HAS_FILESYSTEM_SMB)
-  // perform netbios lookup (win32 is handling this via gethostbyname)
+  // perform netbios lookup (win32 is handling this via getaddrinfo)
   char nmb_ip[100];
   char line[200];
 
@@ -64,56 +169,75 @@ bool CDNSNameCache::Lookup(const std::string& strHostName, std::string& strIpAdd
   }
 
   if (!strIpAddress.empty())
-  {
-    g_DNSCache.Add(strHostName, strIpAddress);
     return true;
-  }
 #endif
 
-  // perform dns lookup
-  struct hostent *host = gethostbyname(strHostName.c_str());
-  if (host && host->h_addr_list[0])
+  // perform dns lookup, getaddrinfo is safe to call from several threads
+  struct addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  struct addrinfo* result = nullptr;
+  if (getaddrinfo(strHostName.c_str(), nullptr, &hints, &result) == 0 && result)
   {
-    strIpAddress = StringUtils::Format("%d.%d.%d.%d",
-                                       (unsigned char)host->h_addr_list[0][0],
-                                       (unsigned char)host->h_addr_list[0][1],
-                                       (unsigned char)host->h_addr_list[0][2],
-                                       (unsigned char)host->h_addr_list[0][3]);
-    g_DNSCache.Add(strHostName, strIpAddress);
-    return true;
+    char address[INET_ADDRSTRLEN];
+    const struct sockaddr_in* addr = reinterpret_cast<const struct sockaddr_in*>(result->ai_addr);
+    if (inet_ntop(AF_INET, &addr->sin_addr, address, sizeof(address)))
+      strIpAddress = address;
+    freeaddrinfo(result);
+    if (!strIpAddress.empty())
+      return true;
   }
 
   CLog::Log(LOGERROR, "Unable to lookup host: '%s'", strHostName.c_str());
   return false;
 }
 
-bool CDNSNameCache::GetCached(const std::string& strHostName, std::string& strIpAddress)
+bool CDNSNameCache::GetCached(const std::string& strHostName, std::string& strIpAddress, bool bIgnoreFailures)
 {
   CSingleLock lock(m_critical);
 
-  // loop through all DNSname entries and see if strHostName is cached
-  for (int i = 0; i < (int)g_DNSCache.m_vecDNSNames.size(); ++i)
+  auto it = g_DNSCache.m_dnsNames.find(strHostName);
+  if (it == g_DNSCache.m_dnsNames.end())
+    return false;
+
+  if (it->second.m_expires.IsTimePast())
   {
-    CDNSName& DNSname = g_DNSCache.m_vecDNSNames[i];
-    if ( DNSname.m_strHostName == strHostName )
-    {
-      strIpAddress = DNSname.m_strIpAddress;
-      return true;
-    }
+    g_DNSCache.m_dnsNames.erase(it);
+    return false;
   }
 
-  // not cached
-  return false;
+  // a failure is replaced once the host is resolved again
+  if (bIgnoreFailures && it->second.m_strIpAddress.empty())
+    return false;
+
+  strIpAddress = it->second.m_strIpAddress;
+  return true;
 }
 
 void CDNSNameCache::Add(const std::string &strHostName, const std::string &strIpAddress)
 {
   CDNSName dnsName;
 
-  dnsName.m_strHostName = strHostName;
   dnsName.m_strIpAddress  = strIpAddress;
+  dnsName.m_expires.SetInfinite();
+
+  CSingleLock lock(m_critical);
+  g_DNSCache.m_dnsNames[strHostName] = dnsName;
+}
 
+void CDNSNameCache::Clear()
+{
   CSingleLock lock(m_critical);
-  g_DNSCache.m_vecDNSNames.push_back(dnsName);
+  for (auto it = g_DNSCache.m_dnsNames.begin(); it != g_DNSCache.m_dnsNames.end();)
+  {
+    if (it->second.m_expires.IsInfinite())
+      ++it;
+    else
+      it = g_DNSCache.m_dnsNames.erase(it);
+  }
 }
 
+void CDNSNameCache::SetResolver(Resolver resolver)
+{
+  CSingleLock lock(m_critical);
+  g_DNSCache.m_resolver = std::move(resolver);
+}
@@ -8,27 +8,82 @@
 
 #pragma once
 
+#include "threads/SystemClock.h"
+
+#include <functional>
+#include <memory>
 #include <string>
-#include <vector>
+#include <unordered_map>
 
 class CCriticalSection;
 
 class CDNSNameCache
 {
 public:
-  class CDNSName
-  {
-  public:
-    std::string m_strHostName;
-    std::string m_strIpAddress;
-  };
+  /*!
+   * \brief Resolves a host name, blocking the calling thread.
+   * \param strHostName The name to resolve.
+   * \param[out] strIpAddress The address of the host.
+   * \param[out] ttlSeconds How long the address (or the failure to resolve it) may be cached.
+   * \return true if the name was resolved.
+   */
+  using Resolver = std::function<bool(const std::string& strHostName, std::string& strIpAddress, unsigned int& ttlSeconds)>;
+
+  static const unsigned int DEFAULT_TTL_SECONDS = 300;
+  // shorter than the network and host waits of wake on access, which poll the lookup
+  static const unsigned int NEGATIVE_TTL_SECONDS = 5;
+  static const unsigned int MAX_TTL_SECONDS = 86400;
+
   CDNSNameCache(void);
   virtual ~CDNSNameCache(void);
-  static bool Lookup(const std::string& strHostName, std::string& strIpAddress);
+
+  /*!
+   * \brief Look up the address of a host, resolving it on the calling thread if it is not cached.
+   * Concurrent lookups of the same host wait for a single resolve.
+   * \param bRetryFailures Resolve the host again if it failed to resolve before, e.g. while
+   * waiting for it to wake up.
+   */
+  static bool Lookup(const std::string& strHostName, std::string& strIpAddress, bool bRetryFailures = false);
+
+  /*!
+   * \brief Look up the address of a host without blocking, e.g. from the GUI thread.
+   * \param bRetryFailures Resolve the host again if it failed to resolve before.
+   * \return true if the address is cached. Otherwise false, and the host gets resolved in the
+   * background so that the address is cached for a later call.
+   */
+  static bool LookupAsync(const std::string& strHostName, std::string& strIpAddress, bool bRetryFailures = false);
+
+  /*!
+   * \brief Add a custom entry, which never expires.
+   */
   static void Add(const std::string& strHostName, const std::string& strIpAddress);
 
+  /*!
+   * \brief Drop all resolved names, keeping the custom entries, e.g. once the network is up.
+   */
+  static void Clear();
+
+  /*!
+   * \brief Replace the resolver, e.g. by a stub for testing.
+   * \param resolver The resolver to use or nullptr to use the system resolver again.
+   */
+  static void SetResolver(Resolver resolver);
+
 protected:
-  static bool GetCached(const std::string& strHostName, std::string& strIpAddress);
+  class CDNSName
+  {
+  public:
+    std::string m_strIpAddress; // empty if the host could not be resolved
+    XbmcThreads::EndTime m_expires;
+  };
+  class CLookup;
+
+  static bool GetCached(const std::string& strHostName, std::string& strIpAddress, bool bIgnoreFailures);
+  static bool GetAddress(const std::string& strHostName, std::string& strIpAddress);
+  static bool ResolveSystem(const std::string& strHostName, std::string& strIpAddress, unsigned int& ttlSeconds);
+  static void Resolve(const std::string& strHostName, const std::shared_ptr<CLookup>& lookup);
   static CCriticalSection m_critical;
-  std::vector<CDNSName> m_vecDNSNames;
+  std::unordered_map<std::string, CDNSName> m_dnsNames;
+  std::unordered_map<std::string, std::shared_ptr<CLookup>> m_lookups; // in flight
+  Resolver m_resolver;
 };
@@ -14,6 +14,7 @@
 #include "Network.h"
 #include "ServiceBroker.h"
 #include "messaging/ApplicationMessenger.h"
+#include "network/DNSNameCache.h"
 #include "network/NetworkServices.h"
 #include "settings/Settings.h"
 #include "settings/SettingsComponent.h"
@@ -217,6 +218,8 @@ void CNetworkBase::NetworkMessage(EMESSAGE message, int param)
   {
     case SERVICES_UP:
       CLog::Log(LOGDEBUG, "%s - Starting network services",__FUNCTION__);
+      // names that failed to resolve while the network was down may resolve now
+      CDNSNameCache::Clear();
       m_services->Start();
       break;
 
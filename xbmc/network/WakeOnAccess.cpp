@@ -60,10 +60,14 @@ static int GetTotalSeconds(const CDateTimeSpan& ts)
   return ts.GetSeconds() + minutes * 60;
 }
 
-static unsigned long HostToIP(const std::string& host)
+static unsigned long HostToIP(const std::string& host, bool bBlocking = true)
 {
+  // the host may just be waking up, so a failure to resolve it isn't taken from the cache
   std::string ip;
-  CDNSNameCache::Lookup(host, ip);
+  if (bBlocking)
+    CDNSNameCache::Lookup(host, ip, true);
+  else if (!CDNSNameCache::LookupAsync(host, ip, true))
+    return INADDR_NONE; // not resolved yet
   return inet_addr(ip.c_str());
 }
 
@@ -346,7 +350,8 @@ public:
   }
   bool SuccessWaiting () const override
   {
-    unsigned long address = ntohl(HostToIP(m_host));
+    // polled while the progress dialog is shown, don't block on a slow dns
+    unsigned long address = ntohl(HostToIP(m_host, false));
     bool online = CServiceBroker::GetNetwork().HasInterfaceForIP(address);
 
     if (!online) // setup endtime so we dont return true until network is consistently connected
@@ -14,10 +14,13 @@
 #include <utility>
 
 #if defined(TARGET_POSIX)
+#include <fcntl.h>
 #include <pthread.h>
+#include <unistd.h>
 #endif
 
 #include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
 #include "network/httprequesthandler/HTTPRequestHandlerUtils.h"
 #include "network/httprequesthandler/IHTTPRequestHandler.h"
 #include "settings/AdvancedSettings.h"
@@ -35,6 +38,7 @@
 #include "XBDateTime.h"
 
 #define MAX_POST_BUFFER_SIZE 2048
+#define FILE_DOWNLOAD_BLOCK_SIZE (64 * 1024)
 
 #define PAGE_FILE_NOT_FOUND "<html><head><title>File not found</title></head><body>File not found</body></html>"
 #define NOT_SUPPORTED       "<html><head><title>Not Supported</title></head><body>The method you are trying to use is not supported by this server</body></html>"
@@ -86,6 +90,32 @@ static MHD_Response* create_response(size_t size, const void* data, int free, in
   return MHD_create_response_from_buffer(size, const_cast<void*>(data), mode);
 }
 
+// a response sending a part of a local file straight from the file descriptor (sendfile if available)
+static MHD_Response* create_file_response(const std::string& filePath, uint64_t offset, uint64_t length)
+{
+#if defined(TARGET_POSIX)
+  if (URIUtils::IsStack(filePath))
+    return nullptr;
+
+  const std::string localPath = CSpecialProtocol::TranslatePath(filePath);
+  if (URIUtils::IsURL(localPath))
+    return nullptr;
+
+  int fd = open(localPath.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return nullptr;
+
+  // the file descriptor is closed by mhd along with the response
+  MHD_Response* response = MHD_create_response_from_fd_at_offset64(length, fd, offset);
+  if (response == nullptr)
+    close(fd);
+
+  return response;
+#else
+  return nullptr;
+#endif
+}
+
 int CWebServer::AskForAuthentication(const HTTPRequest& request) const
 {
   struct MHD_Response *response = create_response(0, nullptr, MHD_NO, MHD_NO);
@@ -814,18 +844,25 @@ int CWebServer::CreateFileDownloadResponse(const std::shared_ptr<IHTTPRequestHan
     // set the initial write position
     context->ranges.GetFirstPosition(context->writePosition);
 
+    // a single range of a local file doesn't need to be copied through our buffers
+    if (context->rangeCountTotal == 1 && totalLength > 0 && context->writePosition + totalLength <= fileLength)
+      response = create_file_response(filePath, context->writePosition, totalLength);
+
     // create the response object
-    response = MHD_create_response_from_callback(totalLength, 2048,
-                                                  &CWebServer::ContentReaderCallback,
-                                                  context.get(),
-                                                  &CWebServer::ContentReaderFreeCallback);
     if (response == nullptr)
     {
-      CLog::Log(LOGERROR, "CWebServer[%hu]: failed to create a HTTP response for %s to be filled from %s", m_port, request.pathUrl.c_str(), filePath.c_str());
-      return MHD_NO;
-    }
+      response = MHD_create_response_from_callback(totalLength, FILE_DOWNLOAD_BLOCK_SIZE,
+                                                    &CWebServer::ContentReaderCallback,
+                                                    context.get(),
+                                                    &CWebServer::ContentReaderFreeCallback);
+      if (response == nullptr)
+      {
+        CLog::Log(LOGERROR, "CWebServer[%hu]: failed to create a HTTP response for %s to be filled from %s", m_port, request.pathUrl.c_str(), filePath.c_str());
+        return MHD_NO;
+      }
 
-    context.release(); // ownership was passed to mhd
+      context.release(); // ownership was passed to mhd
+    }
 
     // add Content-Range header
     if (ranged)
@@ -1101,64 +1138,79 @@ bool CWebServer::LoadCert(std::string &skey, std::string &scert)
 
 struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
 {
-  unsigned int timeout = 60 * 60 * 24;
+  const std::shared_ptr<CAdvancedSettings> advancedSettings = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings();
+  // WARNING: set MHD_OPTION_CONNECTION_TIMEOUT to something higher than 1
+  // otherwise on libmicrohttpd 0.4.4-1 it spins a busy loop
+  const unsigned int timeout = std::max(advancedSettings->m_webserverConnectionTimeout, 2u);
+  const unsigned int threadPoolSize = advancedSettings->m_webserverThreadPoolSize;
   const char* ciphers = "NORMAL:-VERS-TLS1.0";
 
   MHD_set_panic_func(&panicHandlerForMHD, nullptr);
 
+  flags |= MHD_USE_DEBUG; /* Print MHD error messages to log */
+
+  std::vector<MHD_OptionItem> options = {
+    { MHD_OPTION_CONNECTION_LIMIT, 512, nullptr },
+    { MHD_OPTION_CONNECTION_TIMEOUT, static_cast<intptr_t>(timeout), nullptr },
+    // options with two arguments take the first one as value and the second one as pointer
+    { MHD_OPTION_URI_LOG_CALLBACK, reinterpret_cast<intptr_t>(&CWebServer::UriRequestLogger), this },
+    { MHD_OPTION_EXTERNAL_LOGGER, reinterpret_cast<intptr_t>(&logFromMHD), nullptr },
+    { MHD_OPTION_THREAD_STACK_SIZE, static_cast<intptr_t>(m_thread_stacksize), nullptr },
+  };
+
+  if (threadPoolSize > 0)
+  {
+    // a fixed number of threads serves all connections, waiting for them with epoll (or poll)
+    // instead of keeping a thread for every connection, including the idle keep-alive ones
+#if (MHD_VERSION >= 0x00095207)
+    flags |= MHD_USE_INTERNAL_POLLING_THREAD;
+    if (MHD_is_feature_supported(MHD_FEATURE_EPOLL) == MHD_YES)
+      flags |= MHD_USE_EPOLL;
+#else
+    flags |= MHD_USE_SELECT_INTERNALLY;
+    if (MHD_is_feature_supported(MHD_FEATURE_EPOLL) == MHD_YES)
+      flags |= MHD_USE_EPOLL_LINUX_ONLY;
+#endif
+    else if (MHD_is_feature_supported(MHD_FEATURE_POLL) == MHD_YES)
+      flags |= MHD_USE_POLL;
+
+    if (threadPoolSize > 1)
+      options.push_back({ MHD_OPTION_THREAD_POOL_SIZE, static_cast<intptr_t>(threadPoolSize), nullptr });
+  }
+  else
+  {
+    // one thread per connection
+    flags |= MHD_USE_THREAD_PER_CONNECTION;
+#if (MHD_VERSION >= 0x00095207)
+    flags |= MHD_USE_INTERNAL_POLLING_THREAD; /* MHD_USE_THREAD_PER_CONNECTION must be used only with MHD_USE_INTERNAL_POLLING_THREAD since 0.9.54 */
+#endif
+  }
+
   if (CServiceBroker::GetSettingsComponent()->GetSettings()->GetBool(CSettings::SETTING_SERVICES_WEBSERVERSSL) &&
       MHD_is_feature_supported(MHD_FEATURE_SSL) == MHD_YES &&
       LoadCert(m_key, m_cert))
+  {
     // SSL enabled
-    return MHD_start_daemon(flags |
-                          // one thread per connection
-                          // WARNING: set MHD_OPTION_CONNECTION_TIMEOUT to something higher than 1
-                          // otherwise on libmicrohttpd 0.4.4-1 it spins a busy loop
-                          MHD_USE_THREAD_PER_CONNECTION
-#if (MHD_VERSION >= 0x00095207)
-                          | MHD_USE_INTERNAL_POLLING_THREAD /* MHD_USE_THREAD_PER_CONNECTION must be used only with MHD_USE_INTERNAL_POLLING_THREAD since 0.9.54 */
-#endif
-                          | MHD_USE_DEBUG /* Print MHD error messages to log */
-                          | MHD_USE_SSL
-                          ,
-                          port,
-                          0,
-                          0,
-                          &CWebServer::AnswerToConnection,
-                          this,
+    flags |= MHD_USE_SSL;
+    //! @bug libmicrohttpd isn't const correct
+    options.push_back({ MHD_OPTION_HTTPS_MEM_KEY, 0, const_cast<char*>(m_key.c_str()) });
+    options.push_back({ MHD_OPTION_HTTPS_MEM_CERT, 0, const_cast<char*>(m_cert.c_str()) });
+    options.push_back({ MHD_OPTION_HTTPS_PRIORITIES, 0, const_cast<char*>(ciphers) });
+  }
 
-                          MHD_OPTION_CONNECTION_LIMIT, 512,
-                          MHD_OPTION_CONNECTION_TIMEOUT, timeout,
-                          MHD_OPTION_URI_LOG_CALLBACK, &CWebServer::UriRequestLogger, this,
-                          MHD_OPTION_EXTERNAL_LOGGER, &logFromMHD, 0,
-                          MHD_OPTION_THREAD_STACK_SIZE, m_thread_stacksize,
-                          MHD_OPTION_HTTPS_MEM_KEY, m_key.c_str(),
-                          MHD_OPTION_HTTPS_MEM_CERT, m_cert.c_str(),
-                          MHD_OPTION_HTTPS_PRIORITIES, ciphers,
-                          MHD_OPTION_END);
+  options.push_back({ MHD_OPTION_END, 0, nullptr });
 
-  // No SSL
-  return MHD_start_daemon(flags |
-                          // one thread per connection
-                          // WARNING: set MHD_OPTION_CONNECTION_TIMEOUT to something higher than 1
-                          // otherwise on libmicrohttpd 0.4.4-1 it spins a busy loop
-                          MHD_USE_THREAD_PER_CONNECTION
-#if (MHD_VERSION >= 0x00095207)
-                          | MHD_USE_INTERNAL_POLLING_THREAD /* MHD_USE_THREAD_PER_CONNECTION must be used only with MHD_USE_INTERNAL_POLLING_THREAD since 0.9.54 */
-#endif
-                          | MHD_USE_DEBUG /* Print MHD error messages to log */
-                          ,
+  if (threadPoolSize > 0)
+    CLog::Log(LOGDEBUG, "CWebServer[%d]: serving connections with %u worker threads", port, threadPoolSize);
+
+  return MHD_start_daemon(flags,
                           port,
                           0,
                           0,
                           &CWebServer::AnswerToConnection,
                           this,
 
-                          MHD_OPTION_CONNECTION_LIMIT, 512,
-                          MHD_OPTION_CONNECTION_TIMEOUT, timeout,
-                          MHD_OPTION_URI_LOG_CALLBACK, &CWebServer::UriRequestLogger, this,
-                          MHD_OPTION_EXTERNAL_LOGGER, &logFromMHD, 0,
-                          MHD_OPTION_THREAD_STACK_SIZE, m_thread_stacksize,
+                          MHD_OPTION_ARRAY, options.data(),
                           MHD_OPTION_END);
 }
 
@@ -0,0 +1,212 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "network/DNSNameCache.h"
+#include "test/TestUtils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+class TestDNSNameCache : public testing::Test
+{
+protected:
+  TestDNSNameCache()
+  {
+    // a local stub instead of the system resolver
+    CDNSNameCache::SetResolver([this](const std::string& strHostName, std::string& strIpAddress,
+                                      unsigned int& ttlSeconds) {
+      ++m_resolves;
+      if (m_delayMs)
+        std::this_thread::sleep_for(std::chrono::milliseconds(m_delayMs));
+      if (strHostName.find("unknown") != std::string::npos || strHostName == m_offlineHost)
+        return false;
+      strIpAddress = "10.0.0." + std::to_string(m_resolves.load());
+      ttlSeconds = m_ttlSeconds;
+      return true;
+    });
+    CDNSNameCache::Clear();
+  }
+
+  ~TestDNSNameCache() override
+  {
+    CDNSNameCache::SetResolver(nullptr);
+    CDNSNameCache::Clear();
+  }
+
+  // waits for a background lookup to complete
+  bool WaitForAsync(const std::string& strHostName, std::string& strIpAddress)
+  {
+    XbmcThreads::EndTime timeout(5000);
+    while (!timeout.IsTimePast())
+    {
+      if (CDNSNameCache::LookupAsync(strHostName, strIpAddress))
+        return true;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+  }
+
+  std::atomic<int> m_resolves{0};
+  std::string m_offlineHost;
+  unsigned int m_delayMs = 0;
+  unsigned int m_ttlSeconds = CDNSNameCache::DEFAULT_TTL_SECONDS;
+};
+
+TEST_F(TestDNSNameCache, Lookup)
+{
+  std::string ip;
+  EXPECT_TRUE(CDNSNameCache::Lookup("192.168.1.2", ip));
+  EXPECT_EQ("192.168.1.2", ip);
+  EXPECT_EQ(0, m_resolves);
+
+  CDNSNameCache::Add("custom.host", "192.168.1.3");
+  EXPECT_TRUE(CDNSNameCache::Lookup("custom.host", ip));
+  EXPECT_EQ("192.168.1.3", ip);
+  EXPECT_EQ(0, m_resolves);
+
+  EXPECT_TRUE(CDNSNameCache::Lookup("nas.local", ip));
+  EXPECT_EQ("10.0.0.1", ip);
+  EXPECT_TRUE(CDNSNameCache::Lookup("nas.local", ip));
+  EXPECT_EQ("10.0.0.1", ip);
+  EXPECT_EQ(1, m_resolves);
+
+  // custom entries survive clearing the cache
+  CDNSNameCache::Clear();
+  EXPECT_TRUE(CDNSNameCache::Lookup("custom.host", ip));
+  EXPECT_TRUE(CDNSNameCache::Lookup("nas.local", ip));
+  EXPECT_EQ(2, m_resolves);
+}
+
+TEST_F(TestDNSNameCache, TTL)
+{
+  // a record that must not be cached
+  m_ttlSeconds = 0;
+  std::string ip;
+  EXPECT_TRUE(CDNSNameCache::Lookup("nas.local", ip));
+  EXPECT_EQ("10.0.0.1", ip);
+  EXPECT_TRUE(CDNSNameCache::Lookup("nas.local", ip));
+  EXPECT_EQ("10.0.0.2", ip);
+  EXPECT_EQ(2, m_resolves);
+
+  m_ttlSeconds = 60;
+  EXPECT_TRUE(CDNSNameCache::Lookup("nas.local", ip));
+  EXPECT_TRUE(CDNSNameCache::Lookup("nas.local", ip));
+  EXPECT_EQ("10.0.0.3", ip);
+  EXPECT_EQ(3, m_resolves);
+}
+
+TEST_F(TestDNSNameCache, NegativeCaching)
+{
+  std::string ip;
+  EXPECT_FALSE(CDNSNameCache::Lookup("unknown.host", ip));
+  EXPECT_TRUE(ip.empty());
+  EXPECT_FALSE(CDNSNameCache::Lookup("unknown.host", ip));
+  EXPECT_FALSE(CDNSNameCache::LookupAsync("unknown.host", ip));
+  EXPECT_EQ(1, m_resolves);
+}
+
+TEST_F(TestDNSNameCache, RetryFailures)
+{
+  // a host that is asleep doesn't resolve until it woke up
+  m_offlineHost = "sleeping.host";
+  std::string ip;
+  EXPECT_FALSE(CDNSNameCache::Lookup("sleeping.host", ip));
+  m_offlineHost.clear();
+  EXPECT_FALSE(CDNSNameCache::Lookup("sleeping.host", ip));
+  EXPECT_EQ(1, m_resolves);
+
+  // as wake on access waits for it, the cached failure is ignored
+  EXPECT_TRUE(CDNSNameCache::Lookup("sleeping.host", ip, true));
+  EXPECT_EQ("10.0.0.2", ip);
+  EXPECT_TRUE(CDNSNameCache::Lookup("sleeping.host", ip));
+  EXPECT_EQ("10.0.0.2", ip);
+  EXPECT_EQ(2, m_resolves);
+
+  m_offlineHost = "sleeping2.host";
+  EXPECT_FALSE(CDNSNameCache::Lookup("sleeping2.host", ip));
+  m_offlineHost.clear();
+  EXPECT_FALSE(CDNSNameCache::LookupAsync("sleeping2.host", ip));
+  EXPECT_FALSE(CDNSNameCache::LookupAsync("sleeping2.host", ip, true));
+  EXPECT_TRUE(WaitForAsync("sleeping2.host", ip));
+  EXPECT_EQ("10.0.0.4", ip);
+}
+
+TEST_F(TestDNSNameCache, ConcurrentLookups)
+{
+  m_delayMs = 100;
+  std::atomic<int> resolved{0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i)
+  {
+    threads.emplace_back([&resolved]() {
+      std::string ip;
+      if (CDNSNameCache::Lookup("nas.local", ip) && ip == "10.0.0.1")
+        ++resolved;
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(8, resolved);
+  EXPECT_EQ(1, m_resolves);
+}
+
+TEST_F(TestDNSNameCache, LookupAsync)
+{
+  m_delayMs = 100;
+  std::string ip;
+  CTestStopwatch stopwatch;
+  EXPECT_FALSE(CDNSNameCache::LookupAsync("nas.local", ip));
+  EXPECT_FALSE(CDNSNameCache::LookupAsync("nas.local", ip));
+  const int64_t asyncTime = stopwatch.Lap();
+  EXPECT_LT(asyncTime, static_cast<int64_t>(m_delayMs) * 1000);
+
+  EXPECT_TRUE(WaitForAsync("nas.local", ip));
+  EXPECT_EQ("10.0.0.1", ip);
+
+  // a blocking lookup joins the one in flight
+  EXPECT_FALSE(CDNSNameCache::LookupAsync("nas2.local", ip));
+  EXPECT_TRUE(CDNSNameCache::Lookup("nas2.local", ip));
+  EXPECT_EQ("10.0.0.2", ip);
+  EXPECT_EQ(2, m_resolves);
+}
+
+TEST_F(TestDNSNameCache, Benchmark)
+{
+  // a slow dns server, polled by the gui thread while a dialog is shown
+  m_delayMs = 200;
+  const int hosts = 10;
+
+  CTestStopwatch stopwatch;
+  std::string ip;
+  for (int i = 0; i < hosts; ++i)
+    CDNSNameCache::Lookup("blocking" + std::to_string(i) + ".local", ip);
+  const int64_t blockingTime = stopwatch.Lap();
+
+  int64_t maxPollTime = 0;
+  for (int i = 0; i < hosts; ++i)
+  {
+    CTestStopwatch poll;
+    CDNSNameCache::LookupAsync("async" + std::to_string(i) + ".local", ip);
+    maxPollTime = std::max(maxPollTime, poll.Lap());
+  }
+  for (int i = 0; i < hosts; ++i)
+    EXPECT_TRUE(WaitForAsync("async" + std::to_string(i) + ".local", ip));
+  const int64_t asyncTime = stopwatch.Lap();
+
+  RecordProperty("hosts", hosts);
+  RecordProperty("blocking_us", static_cast<int>(blockingTime));
+  RecordProperty("async_us", static_cast<int>(asyncTime));
+  RecordProperty("max_gui_stall_us", static_cast<int>(maxPollTime));
+}
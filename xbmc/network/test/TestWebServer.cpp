@@ -16,19 +16,31 @@
 #include <gtest/gtest.h>
 #include "URL.h"
 #include "filesystem/CurlFile.h"
+#include "filesystem/DllLibCurl.h"
 #include "filesystem/File.h"
 #include "interfaces/json-rpc/JSONRPC.h"
 #include "network/WebServer.h"
 #include "network/httprequesthandler/HTTPVfsHandler.h"
 #include "network/httprequesthandler/HTTPJsonRpcHandler.h"
+#include "ServiceBroker.h"
+#include "settings/AdvancedSettings.h"
 #include "settings/MediaSourceSettings.h"
+#include "settings/Settings.h"
+#include "settings/SettingsComponent.h"
 #include "test/TestUtils.h"
+#include "threads/SingleLock.h"
 #include "utils/JSONVariantParser.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
 #include "utils/Variant.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <random>
+#include <thread>
+#include <vector>
 
 using namespace XFILE;
 
@@ -76,6 +88,9 @@ protected:
     if (webserver.IsStarted())
       webserver.Stop();
 
+    if (m_streamFile)
+      XBMC_DELETETEMPFILE(m_streamFile);
+
     webserver.UnregisterRequestHandler(&m_vfsHandler);
     webserver.UnregisterRequestHandler(&m_jsonRpcHandler);
 
@@ -339,12 +354,65 @@ protected:
     return StringUtils::Format("bytes=%u-%u", start, end);
   }
 
+  // restarts the webserver with the self-signed certificate of the test data, false if
+  // libmicrohttpd has no TLS support
+  bool RestartWithTls()
+  {
+    if (!CWebServer::WebServerSupportsSSL())
+      return false;
+
+    // the webserver only loads its certificate from the userdata folder
+    const std::string certPath = XBMC_REF_FILE_PATH("xbmc/network/test/data/");
+    if (!CFile::Copy(URIUtils::AddFileToFolder(certPath, "server.key"), "special://userdata/server.key") ||
+        !CFile::Copy(URIUtils::AddFileToFolder(certPath, "server.pem"), "special://userdata/server.pem"))
+      return false;
+
+    const std::shared_ptr<CSettings> settings = CServiceBroker::GetSettingsComponent()->GetSettings();
+    settings->SetBool(CSettings::SETTING_SERVICES_WEBSERVERSSL, true);
+    webserver.Stop();
+    const bool started = webserver.Start(webserverPort, "", "");
+    settings->SetBool(CSettings::SETTING_SERVICES_WEBSERVERSSL, false);
+
+    CFile::Delete("special://userdata/server.key");
+    CFile::Delete("special://userdata/server.pem");
+
+    baseUrl = StringUtils::Format("https://" WEBSERVER_HOST ":%u", webserverPort);
+    return started;
+  }
+
+  // a file of the given size shared by the webserver, returns its url
+  std::string CreateStreamFile(size_t size)
+  {
+    m_streamFile = XBMC_CREATETEMPFILE(".bin");
+    if (!m_streamFile)
+      return "";
+
+    const std::vector<char> streamData(size, 'k');
+    if (m_streamFile->Write(streamData.data(), streamData.size()) != static_cast<ssize_t>(size))
+      return "";
+    m_streamFile->Close();
+
+    const std::string streamDirectory = CXBMCTestUtils::Instance().TempFileDirectory(m_streamFile);
+    CMediaSource source;
+    source.strName = "WebServer Stream Share";
+    source.strPath = streamDirectory;
+    source.vecPaths.push_back(streamDirectory);
+    source.m_allowSharing = true;
+    source.m_iDriveType = CMediaSource::SOURCE_TYPE_LOCAL;
+    source.m_iLockMode = LOCK_MODE_EVERYONE;
+    source.m_ignore = true;
+    CMediaSourceSettings::GetInstance().AddShare("videos", source);
+
+    return GetUrl(URIUtils::AddFileToFolder("vfs", CURL::Encode(XBMC_TEMPFILEPATH(m_streamFile))));
+  }
+
   CWebServer webserver;
   CHTTPJsonRpcHandler m_jsonRpcHandler;
   CHTTPVfsHandler m_vfsHandler;
   std::string baseUrl;
   std::string sourcePath;
   uint16_t webserverPort;
+  XFILE::CFile* m_streamFile = nullptr;
 };
 
 TEST_F(TestWebServer, IsStarted)
@@ -897,3 +965,178 @@ TEST_F(TestWebServer, CanGetCachedRangedFileWithNewerIfRange)
   ASSERT_TRUE(curl.Get(GetUrlOfTestFile(TEST_FILES_RANGES), result));
   CheckRangesTestFileResponse(curl, result, ranges);
 }
+
+namespace
+{
+// runs the given number of clients in parallel, returns the time it took in us
+int64_t RunClients(int clients, const std::function<void()>& client)
+{
+  CTestStopwatch stopwatch;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < clients; ++i)
+    threads.emplace_back(client);
+  for (auto& thread : threads)
+    thread.join();
+  return std::max<int64_t>(stopwatch.Lap(), 1);
+}
+} // unnamed namespace
+
+TEST_F(TestWebServer, LoadTest)
+{
+  const int clients = 8;
+  const int requestsPerClient = 50;
+  const size_t streamSize = 8 * 1024 * 1024;
+
+  // a file to stream, shared like the other test files
+  const std::string streamUrl = CreateStreamFile(streamSize);
+  ASSERT_FALSE(streamUrl.empty());
+  const std::string smallUrl = GetUrlOfTestFile(TEST_FILES_HTML);
+
+  const std::shared_ptr<CAdvancedSettings> advancedSettings = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings();
+  const unsigned int threadPoolSize = advancedSettings->m_webserverThreadPoolSize;
+
+  // thread per connection first, then 4 worker threads
+  for (unsigned int workers : {0u, 4u})
+  {
+    webserver.Stop();
+    advancedSettings->m_webserverThreadPoolSize = workers;
+    ASSERT_TRUE(webserver.Start(webserverPort, "", ""));
+
+    std::atomic<int> failures(0);
+    const int64_t requestsTime = RunClients(clients, [&]()
+    {
+      CCurlFile curl;
+      std::string result;
+      for (int i = 0; i < requestsPerClient; ++i)
+      {
+        if (!curl.Get(smallUrl, result) || result != TEST_FILES_DATA)
+          failures++;
+      }
+    });
+
+    const int64_t streamTime = RunClients(clients, [&]()
+    {
+      CCurlFile curl;
+      std::string result;
+      if (!curl.Get(streamUrl, result) || result.size() != streamSize)
+        failures++;
+    });
+
+    EXPECT_EQ(0, failures.load());
+
+    const std::string mode = workers > 0 ? "pool" : "thread_per_connection";
+    RecordProperty(mode + "_requests_per_s", static_cast<int>(clients * requestsPerClient * 1000000LL / requestsTime));
+    RecordProperty(mode + "_stream_mb_per_s", static_cast<int>(clients * streamSize * 1000000LL / streamTime / (1024 * 1024)));
+  }
+
+  advancedSettings->m_webserverThreadPoolSize = threadPoolSize;
+}
+
+TEST_F(TestWebServer, CurlConnectionReuse)
+{
+  const int clients = 4;
+  const int requestsPerClient = 25;
+
+  const std::shared_ptr<CAdvancedSettings> advancedSettings = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings();
+  const int maxHostConnections = advancedSettings->m_curlMaxHostConnections;
+
+  // plain HTTP first, then TLS where every connection opened is a full handshake
+  for (bool tls : {false, true})
+  {
+    if (tls && !RestartWithTls())
+      continue;
+
+    // the certificate of the test data is self-signed
+    const std::string url = GetUrlOfTestFile(TEST_FILES_HTML) + (tls ? "|verifypeer=false" : "");
+
+    // no limit first, then fewer transfers running for the host than clients
+    for (int limit : {0, 2})
+    {
+      advancedSettings->m_curlMaxHostConnections = limit;
+      const XCURL::DllLibCurlGlobal::SStatistics before = g_curlInterface.GetStatistics();
+
+      std::atomic<int> failures(0);
+      const int64_t time = RunClients(clients, [&]()
+      {
+        std::string result;
+        for (int i = 0; i < requestsPerClient; ++i)
+        {
+          // a new file for every request, all of them are read on the connections of the transfer
+          // thread
+          CCurlFile curl;
+          if (!curl.Get(url, result) || result != TEST_FILES_DATA)
+            failures++;
+        }
+      });
+
+      const XCURL::DllLibCurlGlobal::SStatistics after = g_curlInterface.GetStatistics();
+      const int transfers = static_cast<int>(after.m_transfers - before.m_transfers);
+      const int reused = static_cast<int>(after.m_reused - before.m_reused);
+      const int connects = static_cast<int>(after.m_connects - before.m_connects);
+      const int queued = static_cast<int>(after.m_queued - before.m_queued);
+
+      EXPECT_EQ(0, failures.load());
+      EXPECT_EQ(clients * requestsPerClient, transfers);
+
+      // at most one connection per transfer running at a time, plus any that went stale with the
+      // webserver of a previous test
+      const int running = limit > 0 ? limit : clients;
+      EXPECT_LE(connects, 2 * running);
+      EXPECT_GE(reused, transfers - 2 * running);
+      if (limit == 0)
+        EXPECT_EQ(0, queued);
+
+      const std::string mode = std::string(tls ? "tls_" : "") + (limit > 0 ? "limited" : "unlimited");
+      RecordProperty(mode + "_requests_per_s", static_cast<int>(transfers * 1000000LL / time));
+      RecordProperty(mode + "_connects", connects);
+      RecordProperty(mode + "_reused", reused);
+      RecordProperty(mode + "_queued", queued);
+    }
+  }
+
+  advancedSettings->m_curlMaxHostConnections = maxHostConnections;
+}
+
+TEST_F(TestWebServer, CurlHostTransferLimit)
+{
+  const std::string streamUrl = CreateStreamFile(8 * 1024 * 1024);
+  ASSERT_FALSE(streamUrl.empty());
+  const std::string url = GetUrlOfTestFile(TEST_FILES_HTML);
+
+  const std::shared_ptr<CAdvancedSettings> advancedSettings = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings();
+  const int maxHostConnections = advancedSettings->m_curlMaxHostConnections;
+  advancedSettings->m_curlMaxHostConnections = 2;
+  const XCURL::DllLibCurlGlobal::SStatistics before = g_curlInterface.GetStatistics();
+
+  // the transfers of the streams are paused once our buffers are full, but they keep their slots
+  CCurlFile first;
+  CCurlFile second;
+  ASSERT_TRUE(first.Open(CURL(streamUrl)));
+  ASSERT_TRUE(second.Open(CURL(streamUrl)));
+
+  // so another file of the host waits until one of them is closed
+  std::atomic<bool> done(false);
+  std::atomic<bool> succeeded(false);
+  std::thread third([&]()
+  {
+    CCurlFile curl;
+    std::string result;
+    succeeded = curl.Get(url, result) && result == TEST_FILES_DATA;
+    done = true;
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+  EXPECT_FALSE(done.load());
+  EXPECT_EQ(1u, g_curlInterface.GetStatistics().m_queued - before.m_queued);
+
+  first.Close();
+  third.join();
+  EXPECT_TRUE(succeeded.load());
+
+  // the remaining stream is still read
+  char buffer[1024];
+  EXPECT_EQ(static_cast<ssize_t>(sizeof(buffer)), second.Read(buffer, sizeof(buffer)));
+  second.Close();
+
+  advancedSettings->m_curlMaxHostConnections = maxHostConnections;
+}
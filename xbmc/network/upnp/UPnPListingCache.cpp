@@ -0,0 +1,72 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "UPnPListingCache.h"
+
+#include "FileItem.h"
+#include "threads/SingleLock.h"
+#include "utils/URIUtils.h"
+
+#include <algorithm>
+
+namespace UPNP
+{
+
+const size_t CUPnPListingCache::DEFAULT_MAX_LISTINGS;
+
+CUPnPListingCache::CUPnPListingCache(size_t maxListings /* = DEFAULT_MAX_LISTINGS */)
+  : m_maxListings(std::max<size_t>(maxListings, 1))
+{
+}
+
+std::shared_ptr<const CFileItemList> CUPnPListingCache::Get(const std::string& path, const std::string& sortCriteria)
+{
+  CSingleLock lock(m_critSection);
+  for (auto it = m_listings.begin(); it != m_listings.end(); ++it)
+  {
+    if (it->path == path && it->sortCriteria == sortCriteria)
+    {
+      m_listings.splice(m_listings.begin(), m_listings, it);
+      return m_listings.front().items;
+    }
+  }
+  return {};
+}
+
+void CUPnPListingCache::Add(const std::string& path, const std::string& sortCriteria, const std::shared_ptr<const CFileItemList>& items)
+{
+  CSingleLock lock(m_critSection);
+  m_listings.remove_if([&path, &sortCriteria](const Listing& listing)
+  {
+    return listing.path == path && listing.sortCriteria == sortCriteria;
+  });
+  m_listings.push_front({path, sortCriteria, items});
+  if (m_listings.size() > m_maxListings)
+    m_listings.pop_back();
+}
+
+void CUPnPListingCache::Clear()
+{
+  CSingleLock lock(m_critSection);
+  m_listings.clear();
+}
+
+bool CUPnPListingCache::IsCacheable(const std::string& path)
+{
+  return URIUtils::IsMusicDb(path) || URIUtils::IsVideoDb(path) || URIUtils::IsLibraryFolder(path);
+}
+
+void CUPnPListingCache::GetPage(const CFileItemList& items, unsigned int start, unsigned int count, CFileItemList& page)
+{
+  const unsigned int size = static_cast<unsigned int>(items.Size());
+  const unsigned int end = start < size ? start + std::min(count, size - start) : start;
+  for (unsigned int i = start; i < end; ++i)
+    page.Add(std::make_shared<CFileItem>(*items.Get(i)));
+}
+
+} /* namespace UPNP */
@@ -0,0 +1,83 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "threads/CriticalSection.h"
+
+#include <list>
+#include <memory>
+#include <string>
+
+class CFileItemList;
+
+namespace UPNP
+{
+
+/*!
+ * \brief Keeps the sorted listings of the most recently browsed containers, so that renderers
+ * paging through a large container don't have it listed and sorted again for every page.
+ */
+class CUPnPListingCache
+{
+public:
+  static const size_t DEFAULT_MAX_LISTINGS = 4;
+
+  explicit CUPnPListingCache(size_t maxListings = DEFAULT_MAX_LISTINGS);
+
+  /*!
+   * \brief Get the cached listing of a container.
+   * \param path The path of the container.
+   * \param sortCriteria The UPnP sort criteria the listing was sorted by.
+   * \return The listing or nullptr if it is not cached.
+   */
+  std::shared_ptr<const CFileItemList> Get(const std::string& path, const std::string& sortCriteria);
+
+  /*!
+   * \brief Add the listing of a container, evicting the least recently used listing if full.
+   * \param path The path of the container.
+   * \param sortCriteria The UPnP sort criteria the listing was sorted by.
+   * \param items The listing. It must not be modified anymore once added.
+   */
+  void Add(const std::string& path, const std::string& sortCriteria, const std::shared_ptr<const CFileItemList>& items);
+
+  /*!
+   * \brief Drop all cached listings, e.g. because the library was updated.
+   */
+  void Clear();
+
+  /*!
+   * \brief Whether the listing of a container may be cached. Only library containers are, as
+   * the cache is cleared on library updates. Other folders may change at any time.
+   * \param path The path of the container.
+   */
+  static bool IsCacheable(const std::string& path);
+
+  /*!
+   * \brief Copy the items [start, start + count) of a listing.
+   * \param items The listing.
+   * \param start The index of the first item to copy.
+   * \param count The maximum number of items to copy.
+   * \param page The list to copy the items to. The copies can be modified freely.
+   */
+  static void GetPage(const CFileItemList& items, unsigned int start, unsigned int count, CFileItemList& page);
+
+private:
+  struct Listing
+  {
+    std::string path;
+    std::string sortCriteria;
+    std::shared_ptr<const CFileItemList> items;
+  };
+
+  CCriticalSection m_critSection;
+  std::list<Listing> m_listings; // most recently used first
+  const size_t m_maxListings;
+};
+
+} /* namespace UPNP */
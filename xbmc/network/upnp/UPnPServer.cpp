@@ -24,6 +24,7 @@
 #include "interfaces/AnnouncementManager.h"
 #include "music/Artist.h"
 #include "music/MusicDatabase.h"
+#include "music/MusicDbUrl.h"
 #include "music/MusicThumbLoader.h"
 #include "music/tags/MusicInfoTag.h"
 #include "settings/Settings.h"
@@ -40,6 +41,10 @@
 #include "video/VideoThumbLoader.h"
 #include "view/GUIViewState.h"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include <Platinum/Source/Platinum/Platinum.h>
 
 NPT_SET_LOCAL_LOGGER("xbmc.upnp.server")
@@ -145,6 +150,9 @@ CUPnPServer::UpdateContainer(const std::string& id)
     if (itr != m_UpdateIDs.end())
         count = ++itr->second.second;
     m_UpdateIDs[id] = std::make_pair(true, count);
+
+    // an update may affect any listing of the library, e.g. its genres or years
+    m_ListingCache.Clear();
     PropagateUpdates();
 }
 
@@ -633,8 +641,7 @@ CUPnPServer::OnBrowseDirectChildren(PLT_ActionReference&          action,
                                     const char*                   sort_criteria,
                                     const PLT_HttpRequestContext& context)
 {
-    CFileItemList items;
-    NPT_String    parent_id = TranslateWMPObjectId(object_id);
+    NPT_String parent_id = TranslateWMPObjectId(object_id);
 
     CLog::Log(LOGINFO, "UPnP: Received Browse DirectChildren request for object '%s', with sort criteria %s", object_id, sort_criteria);
 
@@ -643,82 +650,121 @@ CUPnPServer::OnBrowseDirectChildren(PLT_ActionReference&          action,
         return NPT_FAILURE;
     }
 
-    items.SetPath(std::string(parent_id));
-
-    // guard against loading while saving to the same cache file
-    // as CArchive currently performs no locking itself
-    bool load;
-    { NPT_AutoLock lock(m_CacheMutex);
-      load = items.Load();
+    // Don't pass parent_id if action is Search not BrowseDirectChildren, as
+    // we want the engine to determine the best parent id, not necessarily the one
+    // passed
+    NPT_String action_name = action->GetActionDesc().GetName();
+    const char* response_parent_id = (action_name.Compare("Search", true)==0)?NULL:parent_id.GetChars();
+
+    const std::string path(parent_id);
+    const std::string criteria(sort_criteria ? sort_criteria : "");
+    NPT_UInt32 max_count = (requested_count == 0)?m_MaxReturnedItems:std::min((unsigned long)requested_count, (unsigned long)m_MaxReturnedItems);
+
+    std::shared_ptr<const CFileItemList> listing = m_ListingCache.Get(path, criteria);
+    if (!listing && requested_count > 0) {
+        // renderers page through large library containers, let the database sort
+        // and limit those instead of listing and sorting the whole container per page
+        CFileItemList page(path);
+        std::vector<std::string> tokens = StringUtils::Split(criteria, ",");
+        tokens.erase(std::remove(tokens.begin(), tokens.end(), ""), tokens.end());
+
+        SortDescription sorting;
+        bool sortable = tokens.empty() ? GetDefaultSortDescription(page, sorting) :
+                        tokens.size() == 1 && GetSortDescription(tokens.front(), sorting);
+        if (sortable) {
+            sorting.limitStart = starting_index;
+            sorting.limitEnd = starting_index + max_count;
+            if (GetLibraryItems(path, sorting, page) && page.HasProperty("total")) {
+                NPT_UInt32 total = static_cast<NPT_UInt32>(page.GetProperty("total").asInteger());
+                return BuildResponse(action, page, filter, 0, page.Size(), sort_criteria, context, response_parent_id, total);
+            }
+        }
     }
 
-    if (!load) {
-        // cache anything that takes more than a second to retrieve
-        unsigned int time = XbmcThreads::SystemClockMillis();
+    if (!listing) {
+        std::shared_ptr<CFileItemList> items = std::make_shared<CFileItemList>(path);
+
+        // guard against loading while saving to the same cache file
+        // as CArchive currently performs no locking itself
+        bool load;
+        { NPT_AutoLock lock(m_CacheMutex);
+          load = items->Load();
+        }
 
-        if (parent_id.StartsWith("virtualpath://upnproot")) {
-            CFileItemPtr item;
+        if (!load) {
+            // cache anything that takes more than a second to retrieve
+            unsigned int time = XbmcThreads::SystemClockMillis();
 
-            // music library
-            item.reset(new CFileItem("musicdb://", true));
-            item->SetLabel("Music Library");
-            item->SetLabelPreformatted(true);
-            items.Add(item);
+            if (parent_id.StartsWith("virtualpath://upnproot")) {
+                CFileItemPtr item;
 
-            // video library
-            item.reset(new CFileItem("library://video/", true));
-            item->SetLabel("Video Library");
-            item->SetLabelPreformatted(true);
-            items.Add(item);
+                // music library
+                item.reset(new CFileItem("musicdb://", true));
+                item->SetLabel("Music Library");
+                item->SetLabelPreformatted(true);
+                items->Add(item);
 
-            items.Sort(SortByLabel, SortOrderAscending);
-        } else {
-            // this is the only way to hide unplayable items in the 'files'
-            // view as we cannot tell what context (eg music vs video) the
-            // request came from
-            std::string supported = CServiceBroker::GetFileExtensionProvider().GetPictureExtensions() + "|"
-                                  + CServiceBroker::GetFileExtensionProvider().GetVideoExtensions() + "|"
-                                  + CServiceBroker::GetFileExtensionProvider().GetMusicExtensions() + "|"
-                                  + CServiceBroker::GetFileExtensionProvider().GetPictureExtensions();
-            CDirectory::GetDirectory((const char*)parent_id, items, supported, DIR_FLAG_DEFAULTS);
-            DefaultSortItems(items);
+                // video library
+                item.reset(new CFileItem("library://video/", true));
+                item->SetLabel("Video Library");
+                item->SetLabelPreformatted(true);
+                items->Add(item);
+
+                items->Sort(SortByLabel, SortOrderAscending);
+            } else {
+                // this is the only way to hide unplayable items in the 'files'
+                // view as we cannot tell what context (eg music vs video) the
+                // request came from
+                std::string supported = CServiceBroker::GetFileExtensionProvider().GetPictureExtensions() + "|"
+                                      + CServiceBroker::GetFileExtensionProvider().GetVideoExtensions() + "|"
+                                      + CServiceBroker::GetFileExtensionProvider().GetMusicExtensions() + "|"
+                                      + CServiceBroker::GetFileExtensionProvider().GetPictureExtensions();
+                CDirectory::GetDirectory(path, *items, supported, DIR_FLAG_DEFAULTS);
+                DefaultSortItems(*items);
+            }
+
+            if (items->CacheToDiscAlways() || (items->CacheToDiscIfSlow() && (XbmcThreads::SystemClockMillis() - time) > 1000 )) {
+                NPT_AutoLock lock(m_CacheMutex);
+                items->Save();
+            }
         }
 
-        if (items.CacheToDiscAlways() || (items.CacheToDiscIfSlow() && (XbmcThreads::SystemClockMillis() - time) > 1000 )) {
-            NPT_AutoLock lock(m_CacheMutex);
-            items.Save();
+        SortItems(*items, criteria.c_str());
+
+        // as there's no library://music support, manually add playlists and music
+        // video nodes
+        if (items->GetPath() == "musicdb://") {
+          CFileItemPtr playlists(new CFileItem("special://musicplaylists/", true));
+          playlists->SetLabel(g_localizeStrings.Get(136));
+          items->Add(playlists);
+
+          CVideoDatabase database;
+          database.Open();
+          if (database.HasContent(VIDEODB_CONTENT_MUSICVIDEOS)) {
+              CFileItemPtr mvideos(new CFileItem("library://video/musicvideos/", true));
+              mvideos->SetLabel(g_localizeStrings.Get(20389));
+              items->Add(mvideos);
+          }
         }
-    }
 
-    // as there's no library://music support, manually add playlists and music
-    // video nodes
-    if (items.GetPath() == "musicdb://") {
-      CFileItemPtr playlists(new CFileItem("special://musicplaylists/", true));
-      playlists->SetLabel(g_localizeStrings.Get(136));
-      items.Add(playlists);
+        // this isn't pretty but needed to properly hide the addons node from clients
+        if (StringUtils::StartsWith(items->GetPath(), "library")) {
+            for (int i=0; i<items->Size(); i++) {
+                if (StringUtils::StartsWith(items->Get(i)->GetPath(), "addons") ||
+                    StringUtils::EndsWith(items->Get(i)->GetPath(), "/addons.xml/"))
+                    items->Remove(i);
+            }
+        }
 
-      CVideoDatabase database;
-      database.Open();
-      if (database.HasContent(VIDEODB_CONTENT_MUSICVIDEOS)) {
-          CFileItemPtr mvideos(new CFileItem("library://video/musicvideos/", true));
-          mvideos->SetLabel(g_localizeStrings.Get(20389));
-          items.Add(mvideos);
-      }
+        listing = items;
+        if (CUPnPListingCache::IsCacheable(path))
+            m_ListingCache.Add(path, criteria, listing);
     }
 
-    // Don't pass parent_id if action is Search not BrowseDirectChildren, as
-    // we want the engine to determine the best parent id, not necessarily the one
-    // passed
-    NPT_String action_name = action->GetActionDesc().GetName();
-    return BuildResponse(
-        action,
-        items,
-        filter,
-        starting_index,
-        requested_count,
-        sort_criteria,
-        context,
-        (action_name.Compare("Search", true)==0)?NULL:parent_id.GetChars());
+    // the cached listing is shared, hand out copies of the requested items only
+    CFileItemList page(path);
+    CUPnPListingCache::GetPage(*listing, starting_index, max_count, page);
+    return BuildResponse(action, page, filter, 0, page.Size(), sort_criteria, context, response_parent_id, listing->Size());
 }
 
 /*----------------------------------------------------------------------
@@ -732,7 +778,8 @@ CUPnPServer::BuildResponse(PLT_ActionReference&          action,
                            NPT_UInt32                    requested_count,
                            const char*                   sort_criteria,
                            const PLT_HttpRequestContext& context,
-                           const char*                   parent_id /* = NULL */)
+                           const char*                   parent_id /* = NULL */,
+                           NPT_UInt32                    total_matches /* = 0 */)
 {
     NPT_COMPILER_UNUSED(sort_criteria);
 
@@ -759,22 +806,13 @@ CUPnPServer::BuildResponse(PLT_ActionReference&          action,
         thumb_loader->OnLoaderStart();
     }
 
-    // this isn't pretty but needed to properly hide the addons node from clients
-    if (StringUtils::StartsWith(items.GetPath(), "library")) {
-        for (int i=0; i<items.Size(); i++) {
-            if (StringUtils::StartsWith(items[i]->GetPath(), "addons") ||
-                StringUtils::EndsWith(items[i]->GetPath(), "/addons.xml/"))
-                items.Remove(i);
-        }
-    }
-
     // won't return more than UPNP_MAX_RETURNED_ITEMS items at a time to keep things smooth
     // 0 requested means as many as possible
     NPT_UInt32 max_count  = (requested_count == 0)?m_MaxReturnedItems:std::min((unsigned long)requested_count, (unsigned long)m_MaxReturnedItems);
     NPT_UInt32 stop_index = std::min((unsigned long)(starting_index + max_count), (unsigned long)items.Size()); // don't return more than we can
 
     NPT_Cardinal count = 0;
-    NPT_Cardinal total = items.Size();
+    NPT_Cardinal total = total_matches ? total_matches : items.Size();
     NPT_String didl = didl_header;
     PLT_MediaObjectReference object;
     for (unsigned long i=starting_index; i<stop_index; ++i) {
@@ -1238,55 +1276,8 @@ CUPnPServer::SortItems(CFileItemList& items, const char* sort_criteria)
   std::vector<std::string> tokens = StringUtils::Split(criteria, ",");
   for (std::vector<std::string>::reverse_iterator itr = tokens.rbegin(); itr != tokens.rend(); ++itr) {
     SortDescription sorting;
-    /* Platinum guarantees 1st char is - or + */
-    sorting.sortOrder = StringUtils::StartsWith(*itr, "+") ? SortOrderAscending : SortOrderDescending;
-    std::string method = itr->substr(1);
-
-    /* resource specific */
-    if (StringUtils::EqualsNoCase(method, "res@duration"))
-      sorting.sortBy = SortByTime;
-    else if (StringUtils::EqualsNoCase(method, "res@size"))
-      sorting.sortBy = SortBySize;
-    else if (StringUtils::EqualsNoCase(method, "res@bitrate"))
-      sorting.sortBy = SortByBitrate;
-
-    /* dc: */
-    else if (StringUtils::EqualsNoCase(method, "dc:date"))
-      sorting.sortBy = SortByDate;
-    else if (StringUtils::EqualsNoCase(method, "dc:title"))
-    {
-      sorting.sortBy = SortByTitle;
-      sorting.sortAttributes = SortAttributeIgnoreArticle;
-    }
-
-    /* upnp: */
-    else if (StringUtils::EqualsNoCase(method, "upnp:album"))
-      sorting.sortBy = SortByAlbum;
-    else if (StringUtils::EqualsNoCase(method, "upnp:artist") ||
-             StringUtils::EqualsNoCase(method, "upnp:albumArtist"))
-      sorting.sortBy = SortByArtist;
-    else if (StringUtils::EqualsNoCase(method, "upnp:episodeNumber"))
-      sorting.sortBy = SortByEpisodeNumber;
-    else if (StringUtils::EqualsNoCase(method, "upnp:episodeCount"))
-      sorting.sortBy = SortByNumberOfEpisodes;
-    else if (StringUtils::EqualsNoCase(method, "upnp:episodeSeason"))
-      sorting.sortBy = SortBySeason;
-    else if (StringUtils::EqualsNoCase(method, "upnp:genre"))
-      sorting.sortBy = SortByGenre;
-    else if (StringUtils::EqualsNoCase(method, "upnp:originalTrackNumber"))
-      sorting.sortBy = SortByTrackNumber;
-    else if(StringUtils::EqualsNoCase(method, "upnp:rating"))
-      sorting.sortBy = SortByMPAA;
-    else if (StringUtils::EqualsNoCase(method, "xbmc:rating"))
-      sorting.sortBy = SortByRating;
-    else if (StringUtils::EqualsNoCase(method, "xbmc:dateadded"))
-      sorting.sortBy = SortByDateAdded;
-    else if (StringUtils::EqualsNoCase(method, "xbmc:votes"))
-      sorting.sortBy = SortByVotes;
-    else {
-      CLog::Log(LOGINFO, "UPnP: unsupported sort criteria '%s' passed", method.c_str());
+    if (!GetSortDescription(*itr, sorting))
       continue; // needed so unidentified sort methods don't re-sort by label
-    }
 
     CLog::Log(LOGINFO, "UPnP: Sorting by method %d, order %d, attributes %d", sorting.sortBy, sorting.sortOrder, sorting.sortAttributes);
     items.Sort(sorting);
@@ -1296,16 +1287,173 @@ CUPnPServer::SortItems(CFileItemList& items, const char* sort_criteria)
   return sorted;
 }
 
+/*----------------------------------------------------------------------
+|   CUPnPServer::GetSortDescription
+|
+|   return true if the single sort criterion is supported
++---------------------------------------------------------------------*/
+bool
+CUPnPServer::GetSortDescription(const std::string& criterion, SortDescription& sorting)
+{
+  if (criterion.empty())
+    return false;
+
+  /* Platinum guarantees 1st char is - or + */
+  sorting.sortOrder = StringUtils::StartsWith(criterion, "+") ? SortOrderAscending : SortOrderDescending;
+  std::string method = criterion.substr(1);
+
+  /* resource specific */
+  if (StringUtils::EqualsNoCase(method, "res@duration"))
+    sorting.sortBy = SortByTime;
+  else if (StringUtils::EqualsNoCase(method, "res@size"))
+    sorting.sortBy = SortBySize;
+  else if (StringUtils::EqualsNoCase(method, "res@bitrate"))
+    sorting.sortBy = SortByBitrate;
+
+  /* dc: */
+  else if (StringUtils::EqualsNoCase(method, "dc:date"))
+    sorting.sortBy = SortByDate;
+  else if (StringUtils::EqualsNoCase(method, "dc:title"))
+  {
+    sorting.sortBy = SortByTitle;
+    sorting.sortAttributes = SortAttributeIgnoreArticle;
+  }
+
+  /* upnp: */
+  else if (StringUtils::EqualsNoCase(method, "upnp:album"))
+    sorting.sortBy = SortByAlbum;
+  else if (StringUtils::EqualsNoCase(method, "upnp:artist") ||
+           StringUtils::EqualsNoCase(method, "upnp:albumArtist"))
+    sorting.sortBy = SortByArtist;
+  else if (StringUtils::EqualsNoCase(method, "upnp:episodeNumber"))
+    sorting.sortBy = SortByEpisodeNumber;
+  else if (StringUtils::EqualsNoCase(method, "upnp:episodeCount"))
+    sorting.sortBy = SortByNumberOfEpisodes;
+  else if (StringUtils::EqualsNoCase(method, "upnp:episodeSeason"))
+    sorting.sortBy = SortBySeason;
+  else if (StringUtils::EqualsNoCase(method, "upnp:genre"))
+    sorting.sortBy = SortByGenre;
+  else if (StringUtils::EqualsNoCase(method, "upnp:originalTrackNumber"))
+    sorting.sortBy = SortByTrackNumber;
+  else if(StringUtils::EqualsNoCase(method, "upnp:rating"))
+    sorting.sortBy = SortByMPAA;
+  else if (StringUtils::EqualsNoCase(method, "xbmc:rating"))
+    sorting.sortBy = SortByRating;
+  else if (StringUtils::EqualsNoCase(method, "xbmc:dateadded"))
+    sorting.sortBy = SortByDateAdded;
+  else if (StringUtils::EqualsNoCase(method, "xbmc:votes"))
+    sorting.sortBy = SortByVotes;
+  else {
+    CLog::Log(LOGINFO, "UPnP: unsupported sort criteria '%s' passed", method.c_str());
+    return false;
+  }
+
+  return true;
+}
+
 void
 CUPnPServer::DefaultSortItems(CFileItemList& items)
 {
-  CGUIViewState* viewState = CGUIViewState::GetViewState(items.IsVideoDb() ? WINDOW_VIDEO_NAV : -1, items);
-  if (viewState)
-  {
-    SortDescription sorting = viewState->GetSortMethod();
+  SortDescription sorting;
+  if (GetDefaultSortDescription(items, sorting))
     items.Sort(sorting.sortBy, sorting.sortOrder, sorting.sortAttributes);
-    delete viewState;
+}
+
+bool
+CUPnPServer::GetDefaultSortDescription(const CFileItemList& items, SortDescription& sorting)
+{
+  std::unique_ptr<CGUIViewState> viewState(CGUIViewState::GetViewState(items.IsVideoDb() ? WINDOW_VIDEO_NAV : -1, items));
+  if (!viewState)
+    return false;
+
+  sorting = viewState->GetSortMethod();
+  return true;
+}
+
+/*----------------------------------------------------------------------
+|   CUPnPServer::GetLibraryItems
+|
+|   Lists the songs, albums, artists, movies, tv shows, episodes and music
+|   videos containers straight from the database, so that the limits of
+|   sorting are applied before any items get created.
+|   return false if the container isn't one of those
++---------------------------------------------------------------------*/
+bool
+CUPnPServer::GetLibraryItems(const std::string& path, const SortDescription& sorting, CFileItemList& items)
+{
+  if (URIUtils::IsMusicDb(path)) {
+    MUSICDATABASEDIRECTORY::NODE_TYPE type, childType;
+    MUSICDATABASEDIRECTORY::CQueryParams params;
+    if (!CMusicDatabaseDirectory::GetDirectoryNodeInfo(path, type, childType, params))
+      return false;
+    if (childType != MUSICDATABASEDIRECTORY::NODE_TYPE_SONG &&
+        childType != MUSICDATABASEDIRECTORY::NODE_TYPE_ALBUM &&
+        childType != MUSICDATABASEDIRECTORY::NODE_TYPE_ARTIST)
+      return false;
+
+    CMusicDatabase database;
+    if (!database.Open())
+      return false;
+
+    if (childType == MUSICDATABASEDIRECTORY::NODE_TYPE_SONG) {
+      if (sorting.sortBy == SortByNone)
+        return database.GetSongsNav(path, items, params.GetGenreId(), params.GetArtistId(), params.GetAlbumId(), sorting);
+
+      // GetSongsNav joins a row per song artist and only sorts the items after
+      // the query, so it can't apply the limits of a sorted page
+      CMusicDbUrl musicUrl;
+      if (!musicUrl.FromString(path))
+        return false;
+      if (params.GetAlbumId() > 0)
+        musicUrl.AddOption("albumid", static_cast<int>(params.GetAlbumId()));
+      if (params.GetGenreId() > 0)
+        musicUrl.AddOption("genreid", static_cast<int>(params.GetGenreId()));
+      if (params.GetArtistId() > 0)
+        musicUrl.AddOption("artistid", static_cast<int>(params.GetArtistId()));
+      return database.GetSongsByWhere(musicUrl.ToString(), CDatabase::Filter(), items, sorting);
+    }
+    if (childType == MUSICDATABASEDIRECTORY::NODE_TYPE_ALBUM)
+      return database.GetAlbumsNav(path, items, params.GetGenreId(), params.GetArtistId(), CDatabase::Filter(), sorting);
+    return database.GetArtistsNav(path, items, !CServiceBroker::GetSettingsComponent()->GetSettings()->GetBool(CSettings::SETTING_MUSICLIBRARY_SHOWCOMPILATIONARTISTS),
+                                  params.GetGenreId(), -1, -1, CDatabase::Filter(), sorting);
   }
+
+  if (URIUtils::IsVideoDb(path)) {
+    VIDEODATABASEDIRECTORY::NODE_TYPE childType = CVideoDatabaseDirectory::GetDirectoryChildType(path);
+    if (childType != VIDEODATABASEDIRECTORY::NODE_TYPE_TITLE_MOVIES &&
+        childType != VIDEODATABASEDIRECTORY::NODE_TYPE_TITLE_TVSHOWS &&
+        childType != VIDEODATABASEDIRECTORY::NODE_TYPE_EPISODES &&
+        childType != VIDEODATABASEDIRECTORY::NODE_TYPE_TITLE_MUSICVIDEOS)
+      return false;
+
+    VIDEODATABASEDIRECTORY::CQueryParams params;
+    CVideoDatabase database;
+    if (!CVideoDatabaseDirectory::GetQueryParams(path, params) || !database.Open())
+      return false;
+
+    bool result;
+    if (childType == VIDEODATABASEDIRECTORY::NODE_TYPE_TITLE_MOVIES)
+      result = database.GetMoviesNav(path, items, params.GetGenreId(), params.GetYear(), params.GetActorId(), params.GetDirectorId(),
+                                     params.GetStudioId(), params.GetCountryId(), params.GetSetId(), params.GetTagId(), sorting);
+    else if (childType == VIDEODATABASEDIRECTORY::NODE_TYPE_TITLE_TVSHOWS)
+      result = database.GetTvShowsNav(path, items, params.GetGenreId(), params.GetYear(), params.GetActorId(), params.GetDirectorId(),
+                                      params.GetStudioId(), params.GetTagId(), sorting);
+    else if (childType == VIDEODATABASEDIRECTORY::NODE_TYPE_EPISODES)
+      result = database.GetEpisodesNav(path, items, params.GetGenreId(), params.GetYear(), params.GetActorId(), params.GetDirectorId(),
+                                       params.GetTvShowId(), params.GetSeason() == -2 ? -1 : params.GetSeason(), sorting);
+    else
+      result = database.GetMusicVideosNav(path, items, params.GetGenreId(), params.GetYear(), params.GetActorId(), params.GetDirectorId(),
+                                          params.GetStudioId(), params.GetAlbumId(), params.GetTagId(), sorting);
+
+    // as done by CVideoDatabaseDirectory
+    for (int i = 0; i < items.Size(); ++i) {
+      if (items[i]->HasVideoInfoTag())
+        items[i]->SetDynPath(items[i]->GetVideoInfoTag()->GetPath());
+    }
+    return result;
+  }
+
+  return false;
 }
 
 NPT_Result
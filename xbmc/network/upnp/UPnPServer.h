@@ -9,16 +9,19 @@
 #pragma once
 
 #include "FileItem.h"
+#include "UPnPListingCache.h"
 #include "interfaces/IAnnouncer.h"
 
 #include <utility>
 
 #include <Platinum/Source/Devices/MediaConnect/PltMediaConnect.h>
 
+struct SortDescription;
 class CVariant;
 class CThumbLoader;
 class PLT_MediaObject;
 class PLT_HttpRequestContext;
+class TestUPnPServer;
 
 namespace UPNP
 {
@@ -27,6 +30,8 @@ class CUPnPServer : public PLT_MediaConnect,
                     public PLT_FileMediaConnectDelegate,
                     public ANNOUNCEMENT::IAnnouncer
 {
+    friend class ::TestUPnPServer;
+
 public:
     CUPnPServer(const char* friendly_name, const char* uuid = NULL, int port = 0);
     ~CUPnPServer() override;
@@ -112,11 +117,15 @@ private:
                              NPT_UInt32                    requested_count,
                              const char*                   sort_criteria,
                              const PLT_HttpRequestContext& context,
-                             const char*                   parent_id /* = NULL */);
+                             const char*                   parent_id /* = NULL */,
+                             NPT_UInt32                    total_matches = 0);
 
     // class methods
     static bool SortItems(CFileItemList& items, const char* sort_criteria);
     static void DefaultSortItems(CFileItemList& items);
+    static bool GetSortDescription(const std::string& criterion, SortDescription& sorting);
+    static bool GetDefaultSortDescription(const CFileItemList& items, SortDescription& sorting);
+    static bool GetLibraryItems(const std::string& path, const SortDescription& sorting, CFileItemList& items);
     static NPT_String GetParentFolder(NPT_String file_path) {
         int index = file_path.ReverseFind("\\");
         if (index == -1) return "";
@@ -125,6 +134,7 @@ private:
     }
 
     NPT_Mutex m_CacheMutex;
+    CUPnPListingCache m_ListingCache;
 
     NPT_Mutex m_FileMutex;
     NPT_Map<NPT_String, NPT_String> m_FileMap;
@@ -0,0 +1,141 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "FileItem.h"
+#include "network/upnp/UPnPListingCache.h"
+#include "test/TestUtils.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+using namespace UPNP;
+
+namespace
+{
+// a synthetic library container of iSongs songs in reverse label order
+std::shared_ptr<CFileItemList> CreateListing(const std::string& path, int iSongs)
+{
+  std::shared_ptr<CFileItemList> items = std::make_shared<CFileItemList>(path);
+  for (int i = iSongs - 1; i >= 0; --i)
+  {
+    const std::string label = "Song " + std::to_string(i);
+    CFileItemPtr item = std::make_shared<CFileItem>("/music/" + label + ".mp3", false);
+    item->SetLabel(label);
+    items->Add(item);
+  }
+  return items;
+}
+} // unnamed namespace
+
+TEST(TestUPnPListingCache, GetAdd)
+{
+  CUPnPListingCache cache(2);
+  EXPECT_EQ(nullptr, cache.Get("musicdb://songs/", ""));
+
+  cache.Add("musicdb://songs/", "", CreateListing("musicdb://songs/", 3));
+  cache.Add("musicdb://songs/", "+dc:title", CreateListing("musicdb://songs/", 2));
+  ASSERT_NE(nullptr, cache.Get("musicdb://songs/", ""));
+  EXPECT_EQ(3, cache.Get("musicdb://songs/", "")->Size());
+  EXPECT_EQ(2, cache.Get("musicdb://songs/", "+dc:title")->Size());
+
+  // the least recently used listing is evicted
+  cache.Get("musicdb://songs/", "");
+  cache.Add("musicdb://albums/", "", CreateListing("musicdb://albums/", 1));
+  EXPECT_NE(nullptr, cache.Get("musicdb://songs/", ""));
+  EXPECT_EQ(nullptr, cache.Get("musicdb://songs/", "+dc:title"));
+  EXPECT_NE(nullptr, cache.Get("musicdb://albums/", ""));
+
+  // adding again replaces the listing
+  cache.Add("musicdb://albums/", "", CreateListing("musicdb://albums/", 4));
+  EXPECT_EQ(4, cache.Get("musicdb://albums/", "")->Size());
+
+  cache.Clear();
+  EXPECT_EQ(nullptr, cache.Get("musicdb://songs/", ""));
+  EXPECT_EQ(nullptr, cache.Get("musicdb://albums/", ""));
+}
+
+TEST(TestUPnPListingCache, IsCacheable)
+{
+  EXPECT_TRUE(CUPnPListingCache::IsCacheable("musicdb://songs/"));
+  EXPECT_TRUE(CUPnPListingCache::IsCacheable("videodb://movies/titles/"));
+  EXPECT_TRUE(CUPnPListingCache::IsCacheable("library://video/movies/"));
+
+  // folders and sources change without the cache being cleared
+  EXPECT_FALSE(CUPnPListingCache::IsCacheable("/home/user/Music/"));
+  EXPECT_FALSE(CUPnPListingCache::IsCacheable("smb://nas/music/"));
+  EXPECT_FALSE(CUPnPListingCache::IsCacheable("special://musicplaylists/"));
+  EXPECT_FALSE(CUPnPListingCache::IsCacheable("virtualpath://upnproot/"));
+}
+
+TEST(TestUPnPListingCache, GetPage)
+{
+  const std::shared_ptr<CFileItemList> items = CreateListing("musicdb://songs/", 10);
+
+  CFileItemList page;
+  CUPnPListingCache::GetPage(*items, 8, 5, page);
+  ASSERT_EQ(2, page.Size());
+  EXPECT_EQ("Song 1", page.Get(0)->GetLabel());
+  EXPECT_EQ("Song 0", page.Get(1)->GetLabel());
+
+  // pages hold copies
+  page.Get(0)->SetLabel("Changed");
+  EXPECT_EQ("Song 1", items->Get(8)->GetLabel());
+
+  page.Clear();
+  CUPnPListingCache::GetPage(*items, 10, 5, page);
+  EXPECT_EQ(0, page.Size());
+}
+
+TEST(TestUPnPListingCache, Benchmark)
+{
+  // a renderer paging through a 30k songs container 50 items at a time
+  const int songs = 30000;
+  const unsigned int pageSize = 50;
+  const unsigned int pages = 20;
+  const std::string path = "musicdb://songs/";
+
+  // listing and sorting the whole container for every page
+  CTestStopwatch stopwatch;
+  for (unsigned int i = 0; i < pages; ++i)
+  {
+    std::shared_ptr<CFileItemList> items = CreateListing(path, songs);
+    items->Sort(SortByLabel, SortOrderAscending);
+    CFileItemList page;
+    CUPnPListingCache::GetPage(*items, i * pageSize, pageSize, page);
+    EXPECT_EQ(static_cast<int>(pageSize), page.Size());
+  }
+  const int64_t uncachedTime = stopwatch.Lap();
+
+  // listing and sorting it once
+  CUPnPListingCache cache;
+  stopwatch.Lap();
+  for (unsigned int i = 0; i < pages; ++i)
+  {
+    std::shared_ptr<const CFileItemList> listing = cache.Get(path, "");
+    if (!listing)
+    {
+      std::shared_ptr<CFileItemList> items = CreateListing(path, songs);
+      items->Sort(SortByLabel, SortOrderAscending);
+      listing = items;
+      cache.Add(path, "", listing);
+    }
+    CFileItemList page;
+    CUPnPListingCache::GetPage(*listing, i * pageSize, pageSize, page);
+    EXPECT_EQ(static_cast<int>(pageSize), page.Size());
+  }
+  const int64_t cachedTime = stopwatch.Lap();
+
+  RecordProperty("songs", songs);
+  RecordProperty("pages", static_cast<int>(pages));
+  RecordProperty("uncached_us_per_page", static_cast<int>(uncachedTime / pages));
+  RecordProperty("cached_us_per_page", static_cast<int>(cachedTime / pages));
+  RecordProperty("speedup", static_cast<int>(uncachedTime / std::max<int64_t>(cachedTime, 1)));
+}
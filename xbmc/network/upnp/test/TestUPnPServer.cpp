@@ -0,0 +1,178 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "DatabaseManager.h"
+#include "FileItem.h"
+#include "ServiceBroker.h"
+#include "music/MusicDatabase.h"
+#include "network/upnp/UPnPServer.h"
+#include "utils/SortUtils.h"
+#include "utils/Variant.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace UPNP;
+
+namespace
+{
+const int SONGS = 2000;
+const int ALBUMS = 100;
+const int ARTISTS = 50;
+
+/*!
+ \brief The music database filled with a synthetic library. The artist with
+ id 1 is the [Missing] artist every music database starts with.
+ */
+class CSyntheticMusicDatabase : public CMusicDatabase
+{
+public:
+  bool Fill()
+  {
+    const std::string numbers = "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %i) ";
+    return ExecuteQuery("INSERT INTO path (idPath, strPath) VALUES (1, 'special://temp/upnpserver/')") &&
+           ExecuteQuery(PrepareSQL(numbers + "INSERT INTO artist (idArtist, strArtist) SELECT i + 1, 'Artist ' || i FROM n", ARTISTS)) &&
+           ExecuteQuery(PrepareSQL(numbers + "INSERT INTO album (idAlbum, strAlbum, strArtistDisp, strReleaseType) "
+                                  "SELECT i, 'Album ' || i, 'Artist ' || (i %% %i + 1), 'album' FROM n", ALBUMS, ARTISTS)) &&
+           ExecuteQuery(PrepareSQL(numbers + "INSERT INTO album_artist SELECT i %% %i + 2, i, 0, 'Artist ' || (i %% %i + 1) FROM n",
+                                  ALBUMS, ARTISTS, ARTISTS)) &&
+           // the titles are a permutation of the song ids, so that sorting by title reorders them
+           ExecuteQuery(PrepareSQL(numbers + "INSERT INTO song (idSong, idAlbum, idPath, strArtistDisp, strTitle, iTrack, strFileName, dateAdded) "
+                                  "SELECT i, i %% %i + 1, 1, 'Artist ' || (i %% %i + 1), 'Song ' || (i * 7919 %% %i), i %% 20 + 1, "
+                                  "'song' || i || '.mp3', '2020-01-01 00:00:00' FROM n", SONGS, ALBUMS, ARTISTS, SONGS)) &&
+           ExecuteQuery(PrepareSQL(numbers + "INSERT INTO song_artist SELECT i %% %i + 2, i, 1, 0, 'Artist ' || (i %% %i + 1) FROM n",
+                                  SONGS, ARTISTS, ARTISTS));
+  }
+
+  void Empty()
+  {
+    ExecuteQuery("DELETE FROM song_artist");
+    ExecuteQuery("DELETE FROM song");
+    ExecuteQuery("DELETE FROM album_artist");
+    ExecuteQuery("DELETE FROM album");
+    ExecuteQuery("DELETE FROM path");
+    ExecuteQuery("DELETE FROM artist WHERE idArtist > 1");
+  }
+};
+
+SortDescription GetPage(SortBy sortBy, int start, int end)
+{
+  SortDescription sorting;
+  sorting.sortBy = sortBy;
+  sorting.sortOrder = SortOrderAscending;
+  sorting.limitStart = start;
+  sorting.limitEnd = end;
+  return sorting;
+}
+
+std::vector<std::string> GetPaths(const CFileItemList& items)
+{
+  std::vector<std::string> paths;
+  for (int i = 0; i < items.Size(); i++)
+    paths.emplace_back(items[i]->GetPath());
+  return paths;
+}
+} // unnamed namespace
+
+class TestUPnPServer : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    // the database manager has to create the databases before they can be opened
+    CServiceBroker::GetDatabaseManager().Initialize();
+
+    CSyntheticMusicDatabase database;
+    ASSERT_TRUE(database.Open());
+    database.Empty();
+    ASSERT_TRUE(database.Fill());
+    database.Close();
+  }
+
+  static void TearDownTestCase()
+  {
+    CSyntheticMusicDatabase database;
+    if (database.Open())
+    {
+      database.Empty();
+      database.Close();
+    }
+  }
+
+  static bool GetLibraryItems(const std::string& path, const SortDescription& sorting, CFileItemList& items)
+  {
+    return CUPnPServer::GetLibraryItems(path, sorting, items);
+  }
+};
+
+TEST_F(TestUPnPServer, UnsortedPageIsLimitedInDatabase)
+{
+  CFileItemList all("musicdb://songs/");
+  ASSERT_TRUE(GetLibraryItems("musicdb://songs/", GetPage(SortByNone, 0, -1), all));
+  ASSERT_EQ(SONGS, all.Size());
+
+  CFileItemList page("musicdb://songs/");
+  ASSERT_TRUE(GetLibraryItems("musicdb://songs/", GetPage(SortByNone, 100, 150), page));
+  ASSERT_EQ(50, page.Size());
+  ASSERT_TRUE(page.HasProperty("total"));
+  EXPECT_EQ(SONGS, page.GetProperty("total").asInteger());
+
+  const std::vector<std::string> paths = GetPaths(all);
+  EXPECT_EQ(std::vector<std::string>(paths.begin() + 100, paths.begin() + 150), GetPaths(page));
+}
+
+TEST_F(TestUPnPServer, SortedPagesMatchSortedListing)
+{
+  CFileItemList all("musicdb://songs/");
+  ASSERT_TRUE(GetLibraryItems("musicdb://songs/", GetPage(SortByTitle, 0, -1), all));
+  ASSERT_EQ(SONGS, all.Size());
+
+  const int pageSize = 300;
+  std::vector<std::string> paths;
+  for (int start = 0; start < SONGS; start += pageSize)
+  {
+    CFileItemList page("musicdb://songs/");
+    ASSERT_TRUE(GetLibraryItems("musicdb://songs/", GetPage(SortByTitle, start, start + pageSize), page));
+    EXPECT_EQ(std::min(pageSize, SONGS - start), page.Size());
+    EXPECT_EQ(SONGS, page.GetProperty("total").asInteger());
+
+    const std::vector<std::string> pagePaths = GetPaths(page);
+    paths.insert(paths.end(), pagePaths.begin(), pagePaths.end());
+  }
+  EXPECT_EQ(GetPaths(all), paths);
+
+  // the title order differs from the database order
+  CFileItemList unsorted("musicdb://songs/");
+  ASSERT_TRUE(GetLibraryItems("musicdb://songs/", GetPage(SortByNone, 0, -1), unsorted));
+  EXPECT_NE(GetPaths(unsorted), paths);
+}
+
+TEST_F(TestUPnPServer, AlbumsPage)
+{
+  CFileItemList page("musicdb://albums/");
+  ASSERT_TRUE(GetLibraryItems("musicdb://albums/", GetPage(SortByAlbum, 10, 30), page));
+  EXPECT_EQ(20, page.Size());
+  EXPECT_EQ(ALBUMS, page.GetProperty("total").asInteger());
+
+  page.Clear();
+  ASSERT_TRUE(GetLibraryItems("musicdb://albums/", GetPage(SortByNone, 90, 120), page));
+  EXPECT_EQ(10, page.Size());
+  EXPECT_EQ(ALBUMS, page.GetProperty("total").asInteger());
+}
+
+TEST_F(TestUPnPServer, OtherContainersAreNotPaged)
+{
+  CFileItemList items;
+  EXPECT_FALSE(GetLibraryItems("musicdb://genres/", GetPage(SortByNone, 0, 10), items));
+  EXPECT_FALSE(GetLibraryItems("library://video/movies/", GetPage(SortByNone, 0, 10), items));
+  EXPECT_FALSE(GetLibraryItems("special://temp/upnpserver/", GetPage(SortByNone, 0, 10), items));
+  EXPECT_EQ(0, items.Size());
+}
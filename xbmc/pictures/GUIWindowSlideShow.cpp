@@ -30,6 +30,7 @@
 #include "rendering/RenderSystem.h"
 #include "guilib/LocalizeStrings.h"
 #include "TextureDatabase.h"
+#include "utils/CPUInfo.h"
 #include "utils/log.h"
 #include "utils/Random.h"
 #include "utils/Variant.h"
@@ -40,6 +41,8 @@
 #ifdef TARGET_POSIX
 #include "platform/posix/XTimeUtils.h"
 #endif
+#include <algorithm>
+#include <cstdlib>
 #include <random>
 
 using namespace XFILE;
@@ -48,6 +51,11 @@ using namespace KODI::MESSAGING;
 #define MAX_ZOOM_FACTOR                     10
 #define MAX_PICTURE_SIZE             2048*2048
 
+#define PREFETCH_AHEAD                       3
+#define PREFETCH_BEHIND                      1
+#define MAX_PICTURE_DECODERS                 3
+#define PREFETCH_MEMORY           128*1024*1024
+
 #define IMMEDIATE_TRANSITION_TIME          1
 
 #define PICTURE_MOVE_AMOUNT              0.02f
@@ -63,78 +71,347 @@ using namespace KODI::MESSAGING;
 
 static float zoomamount[10] = { 1.0f, 1.2f, 1.5f, 2.0f, 2.8f, 4.0f, 6.0f, 9.0f, 13.5f, 20.0f };
 
-CBackgroundPicLoader::CBackgroundPicLoader()
-  : CThread("BgPicLoader")
-  , m_iPic{0}
-  , m_iSlideNumber{0}
-  , m_maxWidth{0}
-  , m_maxHeight{0}
-  , m_isLoading{false}
-  , m_pCallback{nullptr}
+CBackgroundPicLoader::CBackgroundPicLoader(unsigned int decoders, size_t maxMemory)
+  : m_bStop{false}
+  , m_maxMemory{maxMemory}
 {
+  for (unsigned int i = 0; i < decoders; i++)
+  {
+    m_threads.emplace_back(new CThread(this, "BgPicLoader"));
+    m_threads.back()->Create();
+  }
 }
 
 CBackgroundPicLoader::~CBackgroundPicLoader()
 {
-  StopThread();
+  m_bStop = true;
+  for (auto& thread : m_threads)
+    thread->StopThread();
+  m_threads.clear();
+
+  if (m_stats.decoded > 0)
+    CLog::Log(LOGDEBUG, "Time for loading %u images: %u ms, average %u ms",
+              m_stats.decoded, m_stats.decodeTime, m_stats.decodeTime / m_stats.decoded);
+}
+
+std::vector<int> CBackgroundPicLoader::GetWantedSlides(const std::vector<CFileItemPtr> &slides, int iCurrentSlide, int iNextSlide,
+                                                       int direction, int ahead, int behind)
+{
+  std::vector<int> wanted{iCurrentSlide};
+  if (iNextSlide != iCurrentSlide)
+    wanted.push_back(iNextSlide);
+
+  const int step = direction >= 0 ? 1 : -1;
+  int slideAhead = iNextSlide;
+  int slideBehind = iCurrentSlide;
+  for (int i = 0; i < ahead || i < behind; i++)
+  {
+    if (i < ahead)
+    {
+      slideAhead = GetSlide(slides, slideAhead, step);
+      if (std::find(wanted.begin(), wanted.end(), slideAhead) == wanted.end())
+        wanted.push_back(slideAhead);
+    }
+    if (i < behind)
+    {
+      slideBehind = GetSlide(slides, slideBehind, -step);
+      if (std::find(wanted.begin(), wanted.end(), slideBehind) == wanted.end())
+        wanted.push_back(slideBehind);
+    }
+  }
+  return wanted;
 }
 
-void CBackgroundPicLoader::Create(CGUIWindowSlideShow *pCallback)
+int CBackgroundPicLoader::GetSlide(const std::vector<CFileItemPtr> &slides, int iSlide, int step)
 {
-  m_pCallback = pCallback;
-  m_isLoading = false;
-  CThread::Create(false);
+  const int count = slides.size();
+  int slide = (iSlide + step + count) % count;
+  while (slide != iSlide)
+  {
+    if (!slides.at(slide)->HasProperty("unplayable"))
+      return slide;
+    slide = (slide + step + count) % count;
+  }
+  return iSlide;
 }
 
-void CBackgroundPicLoader::Process()
+void CBackgroundPicLoader::Run()
 {
-  unsigned int totalTime = 0;
-  unsigned int count = 0;
   while (!m_bStop)
   { // loop around forever, waiting for the app to call LoadPic
-    if (AbortableWait(m_loadPic,10) == WAIT_SIGNALED)
+    if (!m_loadPic.WaitMSec(10))
+      continue;
+
+    while (!m_bStop && DecodeNext())
+      ;
+  }
+}
+
+CBaseTexture* CBackgroundPicLoader::LoadTexture(const std::string &strFileName, int maxWidth, int maxHeight)
+{
+  return CTexture::LoadFromFile(strFileName, maxWidth, maxHeight);
+}
+
+bool CBackgroundPicLoader::DecodeNext()
+{
+  Request request;
+  {
+    CSingleLock lock(m_section);
+    if (m_queue.empty())
+      return false;
+    request = m_queue.front();
+    m_queue.pop_front();
+    m_decoding.push_back(request);
+    // let another decoder pick up the next one
+    if (!m_queue.empty())
+      m_loadPic.Set();
+  }
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  CBaseTexture* texture = LoadTexture(request.fileName, request.maxWidth, request.maxHeight);
+  unsigned int time = XbmcThreads::SystemClockMillis() - start;
+  bool bFullSize = texture && IsFullSize(texture, request.maxWidth, request.maxHeight);
+
+  CSingleLock lock(m_section);
+  m_stats.decodeTime += time;
+  m_stats.decoded++;
+  for (auto it = m_decoding.begin(); it != m_decoding.end(); ++it)
+  {
+    if (it->slideNumber == request.slideNumber && it->fileName == request.fileName &&
+        it->maxWidth == request.maxWidth && it->maxHeight == request.maxHeight)
     {
-      if (m_pCallback)
+      m_decoding.erase(it);
+      break;
+    }
+  }
+  StorePic(request.slideNumber, request.fileName, texture, bFullSize, request.maxWidth, request.maxHeight);
+  return true;
+}
+
+bool CBackgroundPicLoader::LoadPic(int iSlideNumber, const std::string &strFileName, int maxWidth, int maxHeight, bool urgent)
+{
+  CSingleLock lock(m_section);
+  auto pic = m_pics.find(iSlideNumber);
+  if (pic != m_pics.end() && pic->second.fileName == strFileName &&
+      (pic->second.fullSize || (pic->second.maxWidth >= maxWidth && pic->second.maxHeight >= maxHeight)))
+    return false;
+
+  for (const auto& request : m_decoding)
+  {
+    if (Covers(request, iSlideNumber, strFileName, maxWidth, maxHeight))
+      return false;
+  }
+
+  for (auto it = m_queue.begin(); it != m_queue.end(); ++it)
+  {
+    if (Covers(*it, iSlideNumber, strFileName, maxWidth, maxHeight))
+    {
+      if (urgent && it != m_queue.begin())
       {
-        unsigned int start = XbmcThreads::SystemClockMillis();
-        CBaseTexture* texture = CTexture::LoadFromFile(m_strFileName, m_maxWidth, m_maxHeight);
-        totalTime += XbmcThreads::SystemClockMillis() - start;
-        count++;
-        // tell our parent
-        bool bFullSize = false;
-        if (texture)
-        {
-          bFullSize = ((int)texture->GetWidth() < m_maxWidth) && ((int)texture->GetHeight() < m_maxHeight);
-          if (!bFullSize)
-          {
-            int iSize = texture->GetWidth() * texture->GetHeight() - MAX_PICTURE_SIZE;
-            if ((iSize + (int)texture->GetWidth() > 0) || (iSize + (int)texture->GetHeight() > 0))
-              bFullSize = true;
-            if (!bFullSize && texture->GetWidth() == CServiceBroker::GetRenderSystem()->GetMaxTextureSize())
-              bFullSize = true;
-            if (!bFullSize && texture->GetHeight() == CServiceBroker::GetRenderSystem()->GetMaxTextureSize())
-              bFullSize = true;
-          }
-        }
-        m_pCallback->OnLoadPic(m_iPic, m_iSlideNumber, m_strFileName, texture, bFullSize);
-        m_isLoading = false;
+        Request request = *it;
+        m_queue.erase(it);
+        m_queue.push_front(request);
       }
+      return false;
     }
   }
-  if (count > 0)
-    CLog::Log(LOGDEBUG, "Time for loading %u images: %u ms, average %u ms",
-              count, totalTime, totalTime / count);
+
+  Request request{iSlideNumber, strFileName, maxWidth, maxHeight};
+  if (urgent)
+    m_queue.push_front(request);
+  else
+    m_queue.push_back(request);
+  m_loadPic.Set();
+  return true;
 }
 
-void CBackgroundPicLoader::LoadPic(int iPic, int iSlideNumber, const std::string &strFileName, const int maxWidth, const int maxHeight)
+CBackgroundPicLoader::PicState CBackgroundPicLoader::TakePic(int iSlideNumber, const std::string &strFileName, std::unique_ptr<CBaseTexture> &texture, bool &bFullSize)
 {
-  m_iPic = iPic;
-  m_iSlideNumber = iSlideNumber;
-  m_strFileName = strFileName;
-  m_maxWidth = maxWidth;
-  m_maxHeight = maxHeight;
-  m_isLoading = true;
-  m_loadPic.Set();
+  CSingleLock lock(m_section);
+  auto pic = m_pics.find(iSlideNumber);
+  if (pic != m_pics.end())
+  {
+    if (pic->second.fileName == strFileName)
+    {
+      PicState state = pic->second.texture ? PicState::LOADED : PicState::FAILED;
+      bFullSize = pic->second.fullSize;
+      m_stats.memory -= GetMemorySize(pic->second.texture.get());
+      if (state == PicState::LOADED)
+        m_stats.hits++;
+      texture = std::move(pic->second.texture);
+      m_pics.erase(pic);
+      return state;
+    }
+    // the slides changed since it was decoded
+    DropPic(pic);
+  }
+
+  for (const auto& request : m_decoding)
+  {
+    if (request.slideNumber == iSlideNumber && request.fileName == strFileName)
+      return PicState::LOADING;
+  }
+  for (const auto& request : m_queue)
+  {
+    if (request.slideNumber == iSlideNumber && request.fileName == strFileName)
+      return PicState::LOADING;
+  }
+  return PicState::NONE;
+}
+
+bool CBackgroundPicLoader::IsLoading(int iSlideNumber) const
+{
+  CSingleLock lock(m_section);
+  for (const auto& request : m_decoding)
+  {
+    if (request.slideNumber == iSlideNumber)
+      return true;
+  }
+  for (const auto& request : m_queue)
+  {
+    if (request.slideNumber == iSlideNumber)
+      return true;
+  }
+  return false;
+}
+
+bool CBackgroundPicLoader::IsLoaded(int iSlideNumber) const
+{
+  CSingleLock lock(m_section);
+  auto pic = m_pics.find(iSlideNumber);
+  return pic != m_pics.end() && pic->second.texture;
+}
+
+void CBackgroundPicLoader::KeepPic(int iSlideNumber, const std::string &strFileName, CBaseTexture* texture, bool bFullSize, int maxWidth, int maxHeight)
+{
+  CSingleLock lock(m_section);
+  StorePic(iSlideNumber, strFileName, texture, bFullSize, maxWidth, maxHeight);
+}
+
+void CBackgroundPicLoader::Trim(const std::vector<int> &slides)
+{
+  CSingleLock lock(m_section);
+  m_wanted = slides;
+  for (auto pic = m_pics.begin(); pic != m_pics.end();)
+  {
+    if (std::find(slides.begin(), slides.end(), pic->first) == slides.end())
+      pic = DropPic(pic);
+    else
+      ++pic;
+  }
+
+  m_queue.erase(std::remove_if(m_queue.begin(), m_queue.end(),
+                               [&slides](const Request& request) {
+                                 return std::find(slides.begin(), slides.end(), request.slideNumber) == slides.end();
+                               }),
+                m_queue.end());
+
+  if (!slides.empty())
+    FreeMemory(slides.front());
+}
+
+bool CBackgroundPicLoader::IsFull() const
+{
+  CSingleLock lock(m_section);
+  return m_stats.memory >= m_maxMemory;
+}
+
+CBackgroundPicLoader::Stats CBackgroundPicLoader::GetStats() const
+{
+  CSingleLock lock(m_section);
+  return m_stats;
+}
+
+bool CBackgroundPicLoader::IsFullSize(const CBaseTexture* texture, int maxWidth, int maxHeight)
+{
+  if (texture->GetWidth() >= texture->GetOriginalWidth() && texture->GetHeight() >= texture->GetOriginalHeight())
+    return true;
+
+  bool bFullSize = ((int)texture->GetWidth() < maxWidth) && ((int)texture->GetHeight() < maxHeight);
+  if (!bFullSize)
+  {
+    int iSize = texture->GetWidth() * texture->GetHeight() - MAX_PICTURE_SIZE;
+    if ((iSize + (int)texture->GetWidth() > 0) || (iSize + (int)texture->GetHeight() > 0))
+      bFullSize = true;
+    if (!bFullSize && texture->GetWidth() == CServiceBroker::GetRenderSystem()->GetMaxTextureSize())
+      bFullSize = true;
+    if (!bFullSize && texture->GetHeight() == CServiceBroker::GetRenderSystem()->GetMaxTextureSize())
+      bFullSize = true;
+  }
+  return bFullSize;
+}
+
+size_t CBackgroundPicLoader::GetMemorySize(const CBaseTexture* texture)
+{
+  return texture ? static_cast<size_t>(texture->GetPitch()) * texture->GetRows() : 0;
+}
+
+bool CBackgroundPicLoader::Covers(const Request &request, int iSlideNumber, const std::string &strFileName, int maxWidth, int maxHeight) const
+{
+  return request.slideNumber == iSlideNumber && request.fileName == strFileName &&
+         request.maxWidth >= maxWidth && request.maxHeight >= maxHeight;
+}
+
+void CBackgroundPicLoader::StorePic(int iSlideNumber, const std::string &strFileName, CBaseTexture* texture, bool bFullSize, int maxWidth, int maxHeight)
+{
+  auto pic = m_pics.find(iSlideNumber);
+  if (pic != m_pics.end())
+  {
+    // keep the one we have unless this one is larger
+    if (pic->second.fileName == strFileName && pic->second.texture &&
+        (!texture || pic->second.fullSize || texture->GetWidth() <= pic->second.texture->GetWidth()))
+    {
+      delete texture;
+      return;
+    }
+    DropPic(pic);
+  }
+
+  Pic& newPic = m_pics[iSlideNumber];
+  newPic.fileName = strFileName;
+  newPic.texture.reset(texture);
+  newPic.fullSize = bFullSize;
+  newPic.maxWidth = maxWidth;
+  newPic.maxHeight = maxHeight;
+  m_stats.memory += GetMemorySize(texture);
+
+  FreeMemory(m_wanted.empty() ? iSlideNumber : m_wanted.front());
+}
+
+std::map<int, CBackgroundPicLoader::Pic>::iterator CBackgroundPicLoader::DropPic(std::map<int, Pic>::iterator pic)
+{
+  m_stats.memory -= GetMemorySize(pic->second.texture.get());
+  return m_pics.erase(pic);
+}
+
+void CBackgroundPicLoader::FreeMemory(int iSlideNumber)
+{
+  while (m_stats.memory > m_maxMemory)
+  {
+    // wanted slides rank by how much they are wanted, all others are farther
+    // away and rank by their distance to the slide about to be shown
+    auto farthest = m_pics.end();
+    size_t farthestRank = 0;
+    for (auto pic = m_pics.begin(); pic != m_pics.end(); ++pic)
+    {
+      if (pic->first == iSlideNumber || !pic->second.texture)
+        continue;
+
+      size_t rank = std::find(m_wanted.begin(), m_wanted.end(), pic->first) - m_wanted.begin();
+      if (rank == m_wanted.size())
+        rank += std::abs(pic->first - iSlideNumber);
+      if (farthest == m_pics.end() || rank > farthestRank)
+      {
+        farthest = pic;
+        farthestRank = rank;
+      }
+    }
+    if (farthest == m_pics.end())
+      break;
+
+    DropPic(farthest);
+    m_stats.dropped++;
+  }
 }
 
 CGUIWindowSlideShow::CGUIWindowSlideShow(void)
@@ -196,6 +473,14 @@ void CGUIWindowSlideShow::AnnouncePropertyChanged(const std::string &strProperty
   CServiceBroker::GetAnnouncementManager()->Announce(ANNOUNCEMENT::Player, "xbmc", "OnPropertyChanged", data);
 }
 
+CGUIWindowSlideShow::DisplayStats CGUIWindowSlideShow::GetDisplayStats() const
+{
+  DisplayStats stats = m_displayStats;
+  if (m_pBackgroundLoader)
+    stats.loader = m_pBackgroundLoader->GetStats();
+  return stats;
+}
+
 bool CGUIWindowSlideShow::IsPlaying() const
 {
   return m_Image[m_iCurrentPic].IsLoaded();
@@ -223,6 +508,8 @@ void CGUIWindowSlideShow::Reset()
   m_iCurrentPic = 0;
   m_iDirection = 1;
   m_iLastFailedNextSlide = -1;
+  m_iErrorSlide = -1;
+  m_iFullSizeFailedSlide = -1;
   m_slides.clear();
   AnnouncePlaylistClear();
   m_Resolution = CServiceBroker::GetWinSystem()->GetGfxContext().GetVideoResolution();
@@ -242,18 +529,20 @@ void CGUIWindowSlideShow::OnDeinitWindow(int nextWindowID)
     // wait for any outstanding picture loads
     if (m_pBackgroundLoader)
     {
-      // sleep until the loader finishes loading the current pic
-      CLog::Log(LOGDEBUG,"Waiting for BackgroundLoader thread to close");
-      while (m_pBackgroundLoader->IsLoading())
-        Sleep(10);
-      // stop the thread
-      CLog::Log(LOGDEBUG,"Stopping BackgroundLoader thread");
-      m_pBackgroundLoader->StopThread();
+      // stop the threads, once they finish the pics they are loading
+      CLog::Log(LOGDEBUG,"Stopping BackgroundLoader threads");
+      m_displayStats.loader = m_pBackgroundLoader->GetStats();
       m_pBackgroundLoader.reset();
     }
     // and close the images.
     m_Image[0].Close();
     m_Image[1].Close();
+
+    if (m_displayStats.slides > 0)
+      CLog::Log(LOGDEBUG, "Time to display %u slides: average %u ms, max %u ms, %u of them prefetched",
+                m_displayStats.slides, m_displayStats.totalTime / m_displayStats.slides,
+                m_displayStats.maxTime, m_displayStats.prefetched);
+    m_iRequestedSlide = -1;
   }
   CServiceBroker::GetGUI()->GetInfoManager().GetInfoProviders().GetPicturesInfoProvider().SetCurrentSlide(nullptr);
   m_bSlideShow = false;
@@ -289,6 +578,7 @@ void CGUIWindowSlideShow::ShowNext()
   m_fZoom        = 1.0f;
   m_fRotate      = 0.0f;
   m_bLoadNextPic = true;
+  OnDisplayRequested(m_iNextSlide);
 }
 
 void CGUIWindowSlideShow::ShowPrevious()
@@ -302,6 +592,7 @@ void CGUIWindowSlideShow::ShowPrevious()
   m_fZoom        = 1.0f;
   m_fRotate      = 0.0f;
   m_bLoadNextPic = true;
+  OnDisplayRequested(m_iNextSlide);
 }
 
 void CGUIWindowSlideShow::Select(const std::string& strPicture)
@@ -312,7 +603,8 @@ void CGUIWindowSlideShow::Select(const std::string& strPicture)
     if (item->GetPath() == strPicture)
     {
       m_iDirection = 1;
-      if (!m_Image[m_iCurrentPic].IsLoaded() && (!m_pBackgroundLoader || !m_pBackgroundLoader->IsLoading()))
+      OnDisplayRequested(i);
+      if (!m_Image[m_iCurrentPic].IsLoaded() && (!m_pBackgroundLoader || !m_pBackgroundLoader->IsLoading(m_iCurrentSlide)))
       {
         // will trigger loading current slide when next Process call.
         m_iCurrentSlide = i;
@@ -388,8 +680,8 @@ void CGUIWindowSlideShow::Process(unsigned int currentTime, CDirtyRegionList &re
   // Create our background loader if necessary
   if (!m_pBackgroundLoader)
   {
-    m_pBackgroundLoader.reset(new CBackgroundPicLoader());
-    m_pBackgroundLoader->Create(this);
+    const int decoders = std::min(MAX_PICTURE_DECODERS, std::max(1, g_cpuInfo.getCPUCount() - 1));
+    m_pBackgroundLoader.reset(new CBackgroundPicLoader(decoders, PREFETCH_MEMORY));
   }
 
   bool bSlideShow = m_bSlideShow && !m_bPause && !m_bPlayingVideo;
@@ -405,8 +697,8 @@ void CGUIWindowSlideShow::Process(unsigned int currentTime, CDirtyRegionList &re
   if (m_bErrorMessage)
   { // we have an error when loading either the current or next picture
     // check to see if we have a picture loaded
-    CLog::Log(LOGDEBUG, "We have an error loading picture %d!", m_pBackgroundLoader->SlideNumber());
-    if (m_iCurrentSlide == m_pBackgroundLoader->SlideNumber())
+    CLog::Log(LOGDEBUG, "We have an error loading picture %d!", m_iErrorSlide);
+    if (m_iCurrentSlide == m_iErrorSlide)
     {
       if (m_Image[m_iCurrentPic].IsLoaded())
       {
@@ -432,7 +724,7 @@ void CGUIWindowSlideShow::Process(unsigned int currentTime, CDirtyRegionList &re
         // else just drop through - there's nothing we can do (error message will be displayed)
       }
     }
-    else if (m_iNextSlide == m_pBackgroundLoader->SlideNumber())
+    else if (m_iNextSlide == m_iErrorSlide)
     {
       CLog::Log(LOGERROR, "Error loading the next image %d: %s", m_iNextSlide, m_slides.at(m_iNextSlide)->GetPath().c_str());
       // load next image failed, then skip to load next of next if next is not video.
@@ -451,7 +743,7 @@ void CGUIWindowSlideShow::Process(unsigned int currentTime, CDirtyRegionList &re
     }
     else
     { // Non-current and non-next slide, just ignore error.
-      CLog::Log(LOGERROR, "Error loading the non-current non-next image %d/%d: %s", m_iNextSlide, m_pBackgroundLoader->SlideNumber(), m_slides.at(m_iNextSlide)->GetPath().c_str());
+      CLog::Log(LOGERROR, "Error loading the non-current non-next image %d/%d: %s", m_iNextSlide, m_iErrorSlide, m_slides.at(m_iNextSlide)->GetPath().c_str());
       m_bErrorMessage = false;
     }
   }
@@ -462,24 +754,17 @@ void CGUIWindowSlideShow::Process(unsigned int currentTime, CDirtyRegionList &re
     return;
   }
 
-  if (!m_Image[m_iCurrentPic].IsLoaded() && !m_pBackgroundLoader->IsLoading())
+  if (!m_Image[m_iCurrentPic].IsLoaded())
   { // load first image
     CFileItemPtr item = m_slides.at(m_iCurrentSlide);
     std::string picturePath = GetPicturePath(item.get());
-    if (!picturePath.empty())
+    if (!picturePath.empty() && LoadPic(m_iCurrentPic, m_iCurrentSlide, picturePath, true))
     {
       if (item->IsVideo())
         CLog::Log(LOGDEBUG, "Loading the thumb %s for current video %d: %s", picturePath.c_str(), m_iCurrentSlide, item->GetPath().c_str());
       else
         CLog::Log(LOGDEBUG, "Loading the current image %d: %s", m_iCurrentSlide, item->GetPath().c_str());
 
-      // load using the background loader
-      int maxWidth, maxHeight;
-
-      GetCheckedSize((float)res.iWidth * m_fZoom,
-        (float)res.iHeight * m_fZoom,
-        maxWidth, maxHeight);
-      m_pBackgroundLoader->LoadPic(m_iCurrentPic, m_iCurrentSlide, picturePath, maxWidth, maxHeight);
       m_iLastFailedNextSlide = -1;
       m_bLoadNextPic = false;
     }
@@ -487,28 +772,51 @@ void CGUIWindowSlideShow::Process(unsigned int currentTime, CDirtyRegionList &re
 
   // check if we should discard an already loaded next slide
   if (m_Image[1 - m_iCurrentPic].IsLoaded() && m_Image[1 - m_iCurrentPic].SlideNumber() != m_iNextSlide)
-    m_Image[1 - m_iCurrentPic].Close();
+    ClosePic(1 - m_iCurrentPic);
 
-  if (m_iNextSlide != m_iCurrentSlide && m_Image[m_iCurrentPic].IsLoaded() && !m_Image[1 - m_iCurrentPic].IsLoaded() && !m_pBackgroundLoader->IsLoading() && m_iLastFailedNextSlide != m_iNextSlide)
+  if (m_iNextSlide != m_iCurrentSlide && m_Image[m_iCurrentPic].IsLoaded() && !m_Image[1 - m_iCurrentPic].IsLoaded() && m_iLastFailedNextSlide != m_iNextSlide)
   { // load the next image
     m_iLastFailedNextSlide = -1;
     CFileItemPtr item = m_slides.at(m_iNextSlide);
     std::string picturePath = GetPicturePath(item.get());
-    if (!picturePath.empty() && (!item->IsVideo() || !m_bSlideShow || m_bPause))
+    if (!picturePath.empty() && (!item->IsVideo() || !m_bSlideShow || m_bPause) &&
+        LoadPic(1 - m_iCurrentPic, m_iNextSlide, picturePath, false))
     {
       if (item->IsVideo())
         CLog::Log(LOGDEBUG, "Loading the thumb %s for next video %d: %s", picturePath.c_str(), m_iNextSlide, item->GetPath().c_str());
       else
         CLog::Log(LOGDEBUG, "Loading the next image %d: %s", m_iNextSlide, item->GetPath().c_str());
+    }
+  }
 
+  // zoomed in on a slide that was scaled down on decode, so decode it in full
+  if (m_fZoom > 1.0f && m_Image[m_iCurrentPic].IsLoaded() && !m_Image[m_iCurrentPic].FullSize() &&
+      m_Image[m_iCurrentPic].SlideNumber() == m_iCurrentSlide && m_iFullSizeFailedSlide != m_iCurrentSlide)
+  {
+    std::string picturePath = GetPicturePath(m_slides.at(m_iCurrentSlide).get());
+    std::unique_ptr<CBaseTexture> texture;
+    bool bFullSize = false;
+    CBackgroundPicLoader::PicState state = m_pBackgroundLoader->TakePic(m_iCurrentSlide, picturePath, texture, bFullSize);
+    if (state == CBackgroundPicLoader::PicState::LOADED && bFullSize)
+    {
+      CLog::Log(LOGDEBUG, "Showing the full size image %d: %s", m_iCurrentSlide, m_slides.at(m_iCurrentSlide)->GetPath().c_str());
+      m_Image[m_iCurrentPic].SetOriginalSize(texture->GetOriginalWidth(), texture->GetOriginalHeight(), true);
+      m_Image[m_iCurrentPic].UpdateTexture(texture.release());
+    }
+    else if (state == CBackgroundPicLoader::PicState::FAILED)
+      m_iFullSizeFailedSlide = m_iCurrentSlide;
+    else if (state != CBackgroundPicLoader::PicState::LOADING)
+    {
       int maxWidth, maxHeight;
-      GetCheckedSize((float)res.iWidth * m_fZoom,
-                     (float)res.iHeight * m_fZoom,
+      GetCheckedSize((float)res.iWidth * zoomamount[MAX_ZOOM_FACTOR - 1],
+                     (float)res.iHeight * zoomamount[MAX_ZOOM_FACTOR - 1],
                      maxWidth, maxHeight);
-      m_pBackgroundLoader->LoadPic(1 - m_iCurrentPic, m_iNextSlide, picturePath, maxWidth, maxHeight);
+      m_pBackgroundLoader->LoadPic(m_iCurrentSlide, picturePath, maxWidth, maxHeight, true);
     }
   }
 
+  Prefetch();
+
   bool bPlayVideo = m_slides.at(m_iCurrentSlide)->IsVideo() && m_iVideoSlide != m_iCurrentSlide;
   if (bPlayVideo)
     bSlideShow = false;
@@ -560,7 +868,7 @@ void CGUIWindowSlideShow::Process(unsigned int currentTime, CDirtyRegionList &re
     }
     else // next pic isn't loaded.  We should hang around if it is in progress
     {
-      if (m_pBackgroundLoader->IsLoading())
+      if (m_pBackgroundLoader->IsLoading(m_iNextSlide))
       {
 //        CLog::Log(LOGDEBUG, "Having to hold the current image (%s) while we load %s", m_vecSlides[m_iCurrentSlide].c_str(), m_vecSlides[m_iNextSlide].c_str());
         m_Image[m_iCurrentPic].Keep();
@@ -587,14 +895,13 @@ void CGUIWindowSlideShow::Process(unsigned int currentTime, CDirtyRegionList &re
       else
         m_Image[m_iCurrentPic].Close();
 
-      if ((m_Image[1 - m_iCurrentPic].IsLoaded() && m_Image[1 - m_iCurrentPic].SlideNumber() == m_iNextSlide) ||
-          (m_pBackgroundLoader->IsLoading() && m_pBackgroundLoader->SlideNumber() == m_iNextSlide && m_pBackgroundLoader->Pic() == 1 - m_iCurrentPic))
+      if (m_Image[1 - m_iCurrentPic].IsLoaded() && m_Image[1 - m_iCurrentPic].SlideNumber() == m_iNextSlide)
       {
         m_iCurrentPic = 1 - m_iCurrentPic;
       }
       else
       {
-        m_Image[1 - m_iCurrentPic].Close();
+        ClosePic(1 - m_iCurrentPic);
         m_iCurrentPic = 1 - m_iCurrentPic;
       }
       m_iCurrentSlide = m_iNextSlide;
@@ -615,6 +922,20 @@ void CGUIWindowSlideShow::Process(unsigned int currentTime, CDirtyRegionList &re
   if (m_Image[m_iCurrentPic].IsLoaded())
     CServiceBroker::GetGUI()->GetInfoManager().GetInfoProviders().GetPicturesInfoProvider().SetCurrentSlide(m_slides.at(m_iCurrentSlide).get());
 
+  if (m_iRequestedSlide == m_iCurrentSlide && m_Image[m_iCurrentPic].IsLoaded() &&
+      m_Image[m_iCurrentPic].SlideNumber() == m_iCurrentSlide)
+  {
+    unsigned int time = XbmcThreads::SystemClockMillis() - m_requestTime;
+    CLog::Log(LOGDEBUG, "Image %d shown %u ms after it was asked for (%s)", m_iCurrentSlide, time,
+              m_bRequestedPrefetched ? "prefetched" : "not prefetched");
+    m_displayStats.slides++;
+    m_displayStats.totalTime += time;
+    m_displayStats.maxTime = std::max(m_displayStats.maxTime, time);
+    if (m_bRequestedPrefetched)
+      m_displayStats.prefetched++;
+    m_iRequestedSlide = -1;
+  }
+
   RenderPause();
   if (m_slides.at(m_iCurrentSlide)->IsVideo() &&
       g_application.GetAppPlayer().IsRenderingGuiLayer())
@@ -680,15 +1001,98 @@ int CGUIWindowSlideShow::GetNextSlide()
 {
   if (m_slides.size() <= 1)
     return m_iCurrentSlide;
-  int step = m_iDirection >= 0 ? 1 : -1;
-  int nextSlide = (m_iCurrentSlide + step + m_slides.size()) % m_slides.size();
-  while (nextSlide != m_iCurrentSlide)
+  return GetSlide(m_iCurrentSlide, m_iDirection >= 0 ? 1 : -1);
+}
+
+int CGUIWindowSlideShow::GetSlide(int iSlide, int step) const
+{
+  return CBackgroundPicLoader::GetSlide(m_slides, iSlide, step);
+}
+
+bool CGUIWindowSlideShow::LoadPic(int iPic, int iSlideNumber, const std::string &strFileName, bool urgent)
+{
+  std::unique_ptr<CBaseTexture> texture;
+  bool bFullSize = false;
+  switch (m_pBackgroundLoader->TakePic(iSlideNumber, strFileName, texture, bFullSize))
   {
-    if (!m_slides.at(nextSlide)->HasProperty("unplayable"))
-      return nextSlide;
-    nextSlide = (nextSlide + step + m_slides.size()) % m_slides.size();
+  case CBackgroundPicLoader::PicState::LOADED:
+    OnLoadPic(iPic, iSlideNumber, strFileName, texture.release(), bFullSize);
+    return false;
+  case CBackgroundPicLoader::PicState::FAILED:
+    OnLoadPic(iPic, iSlideNumber, strFileName, nullptr, false);
+    return false;
+  case CBackgroundPicLoader::PicState::LOADING:
+    return false;
+  default:
+    break;
   }
-  return m_iCurrentSlide;
+
+  const RESOLUTION_INFO res = CServiceBroker::GetWinSystem()->GetGfxContext().GetResInfo();
+  int maxWidth, maxHeight;
+  GetCheckedSize((float)res.iWidth * m_fZoom,
+                 (float)res.iHeight * m_fZoom,
+                 maxWidth, maxHeight);
+  return m_pBackgroundLoader->LoadPic(iSlideNumber, strFileName, maxWidth, maxHeight, urgent);
+}
+
+void CGUIWindowSlideShow::ClosePic(int iPic)
+{
+  const int iSlideNumber = m_Image[iPic].SlideNumber();
+  if (!m_Image[iPic].IsLoaded() || !m_pBackgroundLoader ||
+      iSlideNumber < 0 || iSlideNumber >= static_cast<int>(m_slides.size()))
+  {
+    m_Image[iPic].Close();
+    return;
+  }
+
+  // keep it around in case we go back to it
+  const bool bFullSize = m_Image[iPic].FullSize();
+  CBaseTexture* texture = m_Image[iPic].Detach();
+  if (texture)
+  {
+    const RESOLUTION_INFO res = CServiceBroker::GetWinSystem()->GetGfxContext().GetResInfo();
+    int maxWidth, maxHeight;
+    GetCheckedSize((float)res.iWidth, (float)res.iHeight, maxWidth, maxHeight);
+    m_pBackgroundLoader->KeepPic(iSlideNumber, GetPicturePath(m_slides.at(iSlideNumber).get()),
+                                 texture, bFullSize, maxWidth, maxHeight);
+  }
+}
+
+void CGUIWindowSlideShow::Prefetch()
+{
+  const std::vector<int> slides = CBackgroundPicLoader::GetWantedSlides(m_slides, m_iCurrentSlide, m_iNextSlide,
+                                                                        m_iDirection, PREFETCH_AHEAD, PREFETCH_BEHIND);
+
+  const RESOLUTION_INFO res = CServiceBroker::GetWinSystem()->GetGfxContext().GetResInfo();
+  int maxWidth, maxHeight;
+  GetCheckedSize((float)res.iWidth, (float)res.iHeight, maxWidth, maxHeight);
+
+  for (int slide : slides)
+  {
+    if (m_pBackgroundLoader->IsFull())
+      break;
+
+    if ((m_Image[0].IsLoaded() && m_Image[0].SlideNumber() == slide) ||
+        (m_Image[1].IsLoaded() && m_Image[1].SlideNumber() == slide))
+      continue;
+
+    // the current slide is loaded right away, and video thumbs aren't worth it
+    const CFileItemPtr& item = m_slides.at(slide);
+    if (slide == m_iCurrentSlide || item->IsVideo() || item->HasProperty("unplayable"))
+      continue;
+
+    m_pBackgroundLoader->LoadPic(slide, item->GetPath(), maxWidth, maxHeight, false);
+  }
+
+  m_pBackgroundLoader->Trim(slides);
+}
+
+void CGUIWindowSlideShow::OnDisplayRequested(int iSlideNumber)
+{
+  m_iRequestedSlide = iSlideNumber;
+  m_requestTime = XbmcThreads::SystemClockMillis();
+  m_bRequestedPrefetched = (m_Image[1 - m_iCurrentPic].IsLoaded() && m_Image[1 - m_iCurrentPic].SlideNumber() == iSlideNumber) ||
+                           (m_pBackgroundLoader && m_pBackgroundLoader->IsLoaded(iSlideNumber));
 }
 
 EVENT_RESULT CGUIWindowSlideShow::OnMouseEvent(const CPoint &point, const CMouseEvent &event)
@@ -951,6 +1355,9 @@ bool CGUIWindowSlideShow::OnMessage(CGUIMessage& message)
 
       CGUIDialog::OnMessage(message);
 
+      // the stats of the last time the slideshow was open are kept until it opens again
+      m_displayStats = DisplayStats();
+
       // turn off slideshow if we only have 1 image
       if (m_slides.size() <= 1)
         m_bSlideShow = false;
@@ -1173,6 +1580,7 @@ void CGUIWindowSlideShow::OnLoadPic(int iPic, int iSlideNumber, const std::strin
     // We should wait for the current pic to finish rendering, then transition it out,
     // release the texture, and try and reload this pic from scratch
     m_bErrorMessage = true;
+    m_iErrorSlide = iSlideNumber;
   }
   MarkDirtyRegion();
 }
@@ -1295,8 +1703,9 @@ void CGUIWindowSlideShow::AddItems(const std::string &strPath, path_set *recursi
 
 void CGUIWindowSlideShow::GetCheckedSize(float width, float height, int &maxWidth, int &maxHeight)
 {
-  maxWidth = CServiceBroker::GetRenderSystem()->GetMaxTextureSize();
-  maxHeight = CServiceBroker::GetRenderSystem()->GetMaxTextureSize();
+  const int maxTextureSize = CServiceBroker::GetRenderSystem()->GetMaxTextureSize();
+  maxWidth = std::min(static_cast<int>(width), maxTextureSize);
+  maxHeight = std::min(static_cast<int>(height), maxTextureSize);
 }
 
 std::string CGUIWindowSlideShow::GetPicturePath(CFileItem *item)
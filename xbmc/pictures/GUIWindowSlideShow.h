@@ -10,42 +10,158 @@
 
 #include "SlideShowPicture.h"
 #include "guilib/GUIDialog.h"
+#include "threads/CriticalSection.h"
 #include "threads/Event.h"
+#include "threads/IRunnable.h"
 #include "threads/Thread.h"
 #include "utils/SortUtils.h"
 
+#include <atomic>
+#include <deque>
+#include <map>
 #include <memory>
 #include <set>
+#include <vector>
 
 class CFileItemList;
 class CVariant;
 
-class CGUIWindowSlideShow;
+/*!
+ \brief Decodes slides in the background and holds them until they are shown.
 
-class CBackgroundPicLoader : public CThread
+ Several decoder threads work through the queued slides. Decoded slides stay in
+ the loader until the slideshow takes them, and slides that were shown can be
+ handed back so that going back to them doesn't decode them again. Slides that
+ are no longer wanted are dropped, least wanted first once the decoded slides
+ take up more memory than the loader may use.
+ */
+class CBackgroundPicLoader : public IRunnable
 {
 public:
-  CBackgroundPicLoader();
+  enum class PicState
+  {
+    NONE,
+    LOADING,
+    LOADED,
+    FAILED
+  };
+
+  struct Stats
+  {
+    unsigned int decoded = 0; // slides decoded
+    unsigned int decodeTime = 0; // ms spent decoding them
+    unsigned int hits = 0; // decoded slides taken for showing
+    unsigned int dropped = 0; // decoded slides dropped to stay within the memory budget
+    size_t memory = 0; // memory taken up by the decoded slides
+  };
+
+  CBackgroundPicLoader(unsigned int decoders, size_t maxMemory);
   ~CBackgroundPicLoader() override;
 
-  void Create(CGUIWindowSlideShow *pCallback);
-  void LoadPic(int iPic, int iSlideNumber, const std::string &strFileName, const int maxWidth, const int maxHeight);
-  bool IsLoading() { return m_isLoading;};
-  int SlideNumber() const { return m_iSlideNumber; }
-  int Pic() const { return m_iPic; }
+  /*!
+   \brief Get the slides to keep decoded, most wanted first: the current and next
+   slide, then alternately the ones ahead of them and the ones behind. Unplayable
+   slides are skipped.
+   \param direction the direction the slideshow moves in, -1 or 1
+   \param ahead, behind how many slides to keep ahead of and behind the current ones
+   */
+  static std::vector<int> GetWantedSlides(const std::vector<CFileItemPtr> &slides, int iCurrentSlide, int iNextSlide,
+                                          int direction, int ahead, int behind);
+  /*! \brief Get the first playable slide step slides away, or iSlide if there is none. */
+  static int GetSlide(const std::vector<CFileItemPtr> &slides, int iSlide, int step);
+
+  /*!
+   \brief Queue a slide for decoding, unless it is decoded or being decoded at
+   least at the given size already.
+   \param urgent decode the slide before the slides queued so far
+   \return true if the slide was queued
+   */
+  bool LoadPic(int iSlideNumber, const std::string &strFileName, int maxWidth, int maxHeight, bool urgent);
+
+  /*!
+   \brief Take a decoded slide out of the loader.
+   \param texture [out] the decoded slide, only set if it is LOADED
+   \param bFullSize [out] whether the slide was decoded at its full size
+   \return the state of the slide, a failed slide is reported only once
+   */
+  PicState TakePic(int iSlideNumber, const std::string &strFileName, std::unique_ptr<CBaseTexture> &texture, bool &bFullSize);
+
+  /*! \brief Whether a slide is queued or being decoded. */
+  bool IsLoading(int iSlideNumber) const;
+  /*! \brief Whether a slide is decoded and waiting to be taken. */
+  bool IsLoaded(int iSlideNumber) const;
+
+  /*!
+   \brief Hand a slide that is no longer shown back to the loader.
+   \param maxWidth, maxHeight the size the slide was decoded for
+   */
+  void KeepPic(int iSlideNumber, const std::string &strFileName, CBaseTexture* texture, bool bFullSize, int maxWidth, int maxHeight);
+
+  /*!
+   \brief Drop the slides not in the given list, and the last ones of the list
+   if the decoded slides take up too much memory.
+   \param slides the slides to keep, most wanted first
+   */
+  void Trim(const std::vector<int> &slides);
+
+  /*! \brief Whether the decoded slides take up all the memory the loader may use. */
+  bool IsFull() const;
+
+  Stats GetStats() const;
+
+  void Run() override;
+
+protected:
+  virtual CBaseTexture* LoadTexture(const std::string &strFileName, int maxWidth, int maxHeight);
+
+  /*!
+   \brief Decode the first queued slide.
+   \return false if no slide was queued
+   */
+  bool DecodeNext();
 
 private:
-  void Process() override;
-  int m_iPic;
-  int m_iSlideNumber;
-  std::string m_strFileName;
-  int m_maxWidth;
-  int m_maxHeight;
+  struct Request
+  {
+    int slideNumber;
+    std::string fileName;
+    int maxWidth;
+    int maxHeight;
+  };
+
+  struct Pic
+  {
+    std::string fileName;
+    std::unique_ptr<CBaseTexture> texture;
+    bool fullSize = false;
+    int maxWidth = 0;
+    int maxHeight = 0;
+  };
+
+  static bool IsFullSize(const CBaseTexture* texture, int maxWidth, int maxHeight);
+  static size_t GetMemorySize(const CBaseTexture* texture);
+  bool Covers(const Request &request, int iSlideNumber, const std::string &strFileName, int maxWidth, int maxHeight) const;
+  void StorePic(int iSlideNumber, const std::string &strFileName, CBaseTexture* texture, bool bFullSize, int maxWidth, int maxHeight);
+  std::map<int, Pic>::iterator DropPic(std::map<int, Pic>::iterator pic);
+  /*!
+   \brief Drop decoded slides until they fit into the memory budget, farthest from
+   the slide about to be shown first. That slide itself is never dropped.
+   \param iSlideNumber the slide about to be shown if Trim() wasn't called yet
+   */
+  void FreeMemory(int iSlideNumber);
 
+  std::vector<std::unique_ptr<CThread>> m_threads;
+  std::atomic<bool> m_bStop;
   CEvent m_loadPic;
-  bool m_isLoading;
 
-  CGUIWindowSlideShow *m_pCallback;
+  mutable CCriticalSection m_section;
+  std::deque<Request> m_queue; //!< Slides waiting for a decoder
+  std::vector<Request> m_decoding; //!< Slides being decoded
+  std::map<int, Pic> m_pics; //!< Decoded slides by slide number
+  std::vector<int> m_wanted; //!< Slides to keep as of the last Trim(), most wanted first
+  size_t m_maxMemory;
+
+  Stats m_stats;
 };
 
 class CGUIWindowSlideShow : public CGUIDialog
@@ -92,6 +208,18 @@ public:
 
   static void RunSlideShow(std::vector<std::string> paths, int start=0);
 
+  struct DisplayStats
+  {
+    unsigned int slides = 0; // slides shown after they were asked for
+    unsigned int totalTime = 0; // ms from asking for them until they were shown
+    unsigned int maxTime = 0; // ms the slowest of them took
+    unsigned int prefetched = 0; // slides already decoded when they were asked for
+    CBackgroundPicLoader::Stats loader; // decoding since the slideshow was opened
+  };
+
+  /*! \brief Get the time to display of the slides since the slideshow was opened. */
+  DisplayStats GetDisplayStats() const;
+
 private:
   void ShowNext();
   void ShowPrevious();
@@ -113,6 +241,18 @@ private:
   void GetCheckedSize(float width, float height, int &maxWidth, int &maxHeight);
   std::string GetPicturePath(CFileItem *item);
   int  GetNextSlide();
+  int  GetSlide(int iSlide, int step) const;
+
+  /*!
+   \brief Put a slide into a picture slot, or have it decoded if it isn't yet.
+   \return true if the slide was queued for decoding
+   */
+  bool LoadPic(int iPic, int iSlideNumber, const std::string &strFileName, bool urgent);
+  /*! \brief Close a picture slot, handing its slide back to the background loader. */
+  void ClosePic(int iPic);
+  /*! \brief Have the slides around the current one decoded and drop the others. */
+  void Prefetch();
+  void OnDisplayRequested(int iSlideNumber);
 
   void AnnouncePlayerPlay(const CFileItemPtr& item);
   void AnnouncePlayerPause(const CFileItemPtr& item);
@@ -144,7 +284,14 @@ private:
   int m_iCurrentPic;
   // background loader
   std::unique_ptr<CBackgroundPicLoader> m_pBackgroundLoader;
+  int m_iErrorSlide = -1;
+  int m_iFullSizeFailedSlide = -1;
   int m_iLastFailedNextSlide;
+  // time to display
+  int m_iRequestedSlide = -1;
+  unsigned int m_requestTime = 0;
+  bool m_bRequestedPrefetched = false;
+  DisplayStats m_displayStats;
   bool m_bLoadNextPic;
   RESOLUTION m_Resolution;
   CPoint m_firstGesturePoint;
@@ -0,0 +1,650 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "PictureDatabase.h"
+
+#include "FileItem.h"
+#include "dbwrappers/dataset.h"
+#include "guilib/LocalizeStrings.h"
+#include "pictures/PictureInfoTag.h"
+#include "utils/JSONVariantParser.h"
+#include "utils/JSONVariantWriter.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+#include "utils/Variant.h"
+#include "utils/log.h"
+
+#include <inttypes.h>
+#include <vector>
+
+namespace
+{
+// most of a tag is empty, only the values that are set are stored
+void RemoveEmptyValues(CVariant& value)
+{
+  std::vector<std::string> empty;
+  for (auto it = value.begin_map(); it != value.end_map(); ++it)
+  {
+    CVariant& member = it->second;
+    if (member.isObject())
+      RemoveEmptyValues(member);
+
+    if ((member.isString() || member.isObject()) && member.empty())
+      empty.push_back(it->first);
+    else if ((member.isInteger() || member.isUnsignedInteger()) && member.asInteger() == 0)
+      empty.push_back(it->first);
+    else if (member.isDouble() && member.asDouble() == 0.0)
+      empty.push_back(it->first);
+    else if (member.isBoolean() && !member.asBoolean())
+      empty.push_back(it->first);
+    else if (member.isArray())
+    { // the offsets of the date tags are only needed to edit the file
+      empty.push_back(it->first);
+    }
+  }
+
+  for (const std::string& key : empty)
+    value.erase(key);
+}
+}
+
+CPictureDatabase::CPictureDatabase() = default;
+
+CPictureDatabase::~CPictureDatabase() = default;
+
+bool CPictureDatabase::Open()
+{
+  return CDatabase::Open();
+}
+
+void CPictureDatabase::CreateTables()
+{
+  CLog::Log(LOGINFO, "create path table");
+  m_pDS->exec("CREATE TABLE path (idPath integer primary key, strPath text)");
+
+  CLog::Log(LOGINFO, "create camera table");
+  m_pDS->exec("CREATE TABLE camera (idCamera integer primary key, strMake text, strModel text)");
+
+  CLog::Log(LOGINFO, "create location table");
+  m_pDS->exec("CREATE TABLE location (idLocation integer primary key, strCountry text, strState text, strCity text)");
+
+  CLog::Log(LOGINFO, "create picture table");
+  m_pDS->exec("CREATE TABLE picture (idPicture integer primary key, idPath integer, strFileName text, "
+              "dateModified text, size integer, dateTaken text, iYear integer, iMonth integer, "
+              "idCamera integer, idLocation integer, tag text)");
+}
+
+void CPictureDatabase::CreateAnalytics()
+{
+  CLog::Log(LOGINFO, "%s creating indices", __FUNCTION__);
+  m_pDS->exec("CREATE UNIQUE INDEX ix_path ON path (strPath(255))");
+  m_pDS->exec("CREATE UNIQUE INDEX ix_camera ON camera (strMake(64), strModel(64))");
+  m_pDS->exec("CREATE UNIQUE INDEX ix_location ON location (strCountry(64), strState(64), strCity(64))");
+  m_pDS->exec("CREATE UNIQUE INDEX ix_picture_1 ON picture (idPath, strFileName(255))");
+  m_pDS->exec("CREATE INDEX ix_picture_2 ON picture (iYear, iMonth, dateTaken)");
+  m_pDS->exec("CREATE INDEX ix_picture_3 ON picture (idCamera, dateTaken)");
+  m_pDS->exec("CREATE INDEX ix_picture_4 ON picture (idLocation, dateTaken)");
+
+  CLog::Log(LOGINFO, "%s creating triggers", __FUNCTION__);
+  m_pDS->exec("CREATE TRIGGER delete_path AFTER DELETE ON path FOR EACH ROW BEGIN "
+              "DELETE FROM picture WHERE picture.idPath = old.idPath; END");
+}
+
+CPictureDatabase::Stamp CPictureDatabase::GetStamp(const CDateTime& dateModified, int64_t size)
+{
+  Stamp stamp;
+  if (dateModified.IsValid())
+    stamp.dateModified = dateModified.GetAsDBDateTime();
+  stamp.size = size;
+  return stamp;
+}
+
+bool CPictureDatabase::GetPictureInfo(const std::string& path, const Stamp& stamp, CPictureInfoTag& tag)
+{
+  try
+  {
+    if (!m_pDB)
+      return false;
+    if (!m_pDS)
+      return false;
+
+    std::string strPath, strFileName;
+    URIUtils::Split(path, strPath, strFileName);
+
+    std::string strSQL = PrepareSQL("SELECT dateModified, size, tag FROM picture "
+                                    "JOIN path ON path.idPath = picture.idPath "
+                                    "WHERE path.strPath = '%s' AND picture.strFileName = '%s'",
+                                    strPath.c_str(), strFileName.c_str());
+    if (!m_pDS->query(strSQL))
+      return false;
+
+    bool found = false;
+    if (!m_pDS->eof())
+    {
+      Stamp indexed;
+      indexed.dateModified = m_pDS->fv(0).get_asString();
+      indexed.size = m_pDS->fv(1).get_asInt64();
+      if (indexed == stamp)
+      {
+        const std::string serialized = m_pDS->fv(2).get_asString();
+        CVariant value;
+        if (serialized.empty())
+        {
+          tag.Reset();
+          found = true;
+        }
+        else if (CJSONVariantParser::Parse(serialized, value))
+        {
+          tag.Deserialize(value);
+          found = true;
+        }
+      }
+    }
+    m_pDS->close();
+    return found;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed on '%s'", __FUNCTION__, path.c_str());
+  }
+  return false;
+}
+
+bool CPictureDatabase::AddPicture(const std::string& path, const Stamp& stamp, const CPictureInfoTag& tag)
+{
+  try
+  {
+    if (!m_pDB)
+      return false;
+    if (!m_pDS)
+      return false;
+
+    std::string strPath, strFileName;
+    URIUtils::Split(path, strPath, strFileName);
+
+    int idPath = AddPath(strPath);
+    if (idPath < 0)
+      return false;
+
+    std::string serialized;
+    std::string dateTaken;
+    int year = 0;
+    int month = 0;
+    int idCamera = -1;
+    int idLocation = -1;
+    if (tag.Loaded())
+    {
+      CVariant value;
+      tag.Serialize(value);
+      RemoveEmptyValues(value);
+      if (!CJSONVariantWriter::Write(value, serialized, true))
+        serialized.clear();
+
+      const CDateTime& taken = tag.GetDateTimeTaken();
+      if (taken.IsValid())
+      {
+        dateTaken = taken.GetAsDBDateTime();
+        year = taken.GetYear();
+        month = taken.GetMonth();
+      }
+
+      std::string make = value["cameramake"].asString();
+      StringUtils::Trim(make);
+      std::string model = value["cameramodel"].asString();
+      StringUtils::Trim(model);
+      if (!make.empty() || !model.empty())
+        idCamera = AddCamera(make, model);
+
+      std::string country = value["country"].asString();
+      StringUtils::Trim(country);
+      std::string state = value["state"].asString();
+      StringUtils::Trim(state);
+      std::string city = value["city"].asString();
+      StringUtils::Trim(city);
+      if (!country.empty() || !state.empty() || !city.empty())
+        idLocation = AddLocation(country, state, city);
+    }
+
+    std::string strSQL = PrepareSQL("SELECT idPicture FROM picture WHERE idPath = %i AND strFileName = '%s'",
+                                    idPath, strFileName.c_str());
+    m_pDS->query(strSQL);
+    if (!m_pDS->eof())
+    {
+      int idPicture = m_pDS->fv(0).get_asInt();
+      m_pDS->close();
+      strSQL = PrepareSQL("UPDATE picture SET dateModified = '%s', size = %" PRIi64 ", dateTaken = '%s', "
+                          "iYear = %i, iMonth = %i, idCamera = %i, idLocation = %i, tag = '%s' "
+                          "WHERE idPicture = %i",
+                          stamp.dateModified.c_str(), stamp.size, dateTaken.c_str(), year, month,
+                          idCamera, idLocation, serialized.c_str(), idPicture);
+    }
+    else
+    {
+      m_pDS->close();
+      strSQL = PrepareSQL("INSERT INTO picture (idPicture, idPath, strFileName, dateModified, size, "
+                          "dateTaken, iYear, iMonth, idCamera, idLocation, tag) "
+                          "VALUES (NULL, %i, '%s', '%s', %" PRIi64 ", '%s', %i, %i, %i, %i, '%s')",
+                          idPath, strFileName.c_str(), stamp.dateModified.c_str(), stamp.size,
+                          dateTaken.c_str(), year, month, idCamera, idLocation, serialized.c_str());
+    }
+    return ExecuteQuery(strSQL);
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed on '%s'", __FUNCTION__, path.c_str());
+  }
+  return false;
+}
+
+bool CPictureDatabase::GetPicturesInPath(const std::string& path, std::map<std::string, Stamp>& pictures)
+{
+  try
+  {
+    if (!m_pDB)
+      return false;
+    if (!m_pDS)
+      return false;
+
+    std::string strSQL = PrepareSQL("SELECT strFileName, dateModified, size FROM picture "
+                                    "JOIN path ON path.idPath = picture.idPath "
+                                    "WHERE path.strPath = '%s'", path.c_str());
+    if (!m_pDS->query(strSQL))
+      return false;
+
+    while (!m_pDS->eof())
+    {
+      Stamp& stamp = pictures[m_pDS->fv(0).get_asString()];
+      stamp.dateModified = m_pDS->fv(1).get_asString();
+      stamp.size = m_pDS->fv(2).get_asInt64();
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed on '%s'", __FUNCTION__, path.c_str());
+  }
+  return false;
+}
+
+bool CPictureDatabase::DeletePicture(const std::string& path)
+{
+  std::string strPath, strFileName;
+  URIUtils::Split(path, strPath, strFileName);
+
+  std::string strSQL = PrepareSQL("DELETE FROM picture WHERE strFileName = '%s' AND "
+                                  "idPath IN (SELECT idPath FROM path WHERE strPath = '%s')",
+                                  strFileName.c_str(), strPath.c_str());
+  return ExecuteQuery(strSQL);
+}
+
+bool CPictureDatabase::CleanPaths(const std::string& root, const std::set<std::string>& paths)
+{
+  try
+  {
+    if (!m_pDB)
+      return false;
+    if (!m_pDS)
+      return false;
+
+    std::string strSQL = PrepareSQL("SELECT idPath, strPath FROM path WHERE SUBSTR(strPath, 1, %i) = '%s'",
+                                    StringUtils::utf8_strlen(root.c_str()), root.c_str());
+    if (!m_pDS->query(strSQL))
+      return false;
+
+    std::vector<int> obsolete;
+    while (!m_pDS->eof())
+    {
+      if (paths.find(m_pDS->fv(1).get_asString()) == paths.end())
+        obsolete.push_back(m_pDS->fv(0).get_asInt());
+      m_pDS->next();
+    }
+    m_pDS->close();
+
+    if (obsolete.empty())
+      return true;
+
+    std::string ids;
+    for (int idPath : obsolete)
+      ids += StringUtils::Format("%i,", idPath);
+    ids.pop_back();
+
+    // the trigger removes the pictures as well
+    if (!ExecuteQuery(PrepareSQL("DELETE FROM path WHERE idPath IN (%s)", ids.c_str())))
+      return false;
+
+    // drop cameras and locations that aren't referenced any more
+    return ExecuteQuery("DELETE FROM camera WHERE NOT EXISTS "
+                        "(SELECT 1 FROM picture WHERE picture.idCamera = camera.idCamera)") &&
+           ExecuteQuery("DELETE FROM location WHERE NOT EXISTS "
+                        "(SELECT 1 FROM picture WHERE picture.idLocation = location.idLocation)");
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed on '%s'", __FUNCTION__, root.c_str());
+  }
+  return false;
+}
+
+int CPictureDatabase::AddPath(const std::string& path)
+{
+  std::string strSQL = PrepareSQL("SELECT idPath FROM path WHERE strPath = '%s'", path.c_str());
+  m_pDS->query(strSQL);
+  if (!m_pDS->eof())
+  {
+    int idPath = m_pDS->fv(0).get_asInt();
+    m_pDS->close();
+    return idPath;
+  }
+  m_pDS->close();
+
+  strSQL = PrepareSQL("INSERT INTO path (idPath, strPath) VALUES (NULL, '%s')", path.c_str());
+  m_pDS->exec(strSQL);
+  return static_cast<int>(m_pDS->lastinsertid());
+}
+
+int CPictureDatabase::AddCamera(const std::string& make, const std::string& model)
+{
+  std::string strSQL = PrepareSQL("SELECT idCamera FROM camera WHERE strMake = '%s' AND strModel = '%s'",
+                                  make.c_str(), model.c_str());
+  m_pDS->query(strSQL);
+  if (!m_pDS->eof())
+  {
+    int idCamera = m_pDS->fv(0).get_asInt();
+    m_pDS->close();
+    return idCamera;
+  }
+  m_pDS->close();
+
+  strSQL = PrepareSQL("INSERT INTO camera (idCamera, strMake, strModel) VALUES (NULL, '%s', '%s')",
+                      make.c_str(), model.c_str());
+  m_pDS->exec(strSQL);
+  return static_cast<int>(m_pDS->lastinsertid());
+}
+
+int CPictureDatabase::AddLocation(const std::string& country, const std::string& state, const std::string& city)
+{
+  std::string strSQL = PrepareSQL("SELECT idLocation FROM location WHERE strCountry = '%s' AND "
+                                  "strState = '%s' AND strCity = '%s'",
+                                  country.c_str(), state.c_str(), city.c_str());
+  m_pDS->query(strSQL);
+  if (!m_pDS->eof())
+  {
+    int idLocation = m_pDS->fv(0).get_asInt();
+    m_pDS->close();
+    return idLocation;
+  }
+  m_pDS->close();
+
+  strSQL = PrepareSQL("INSERT INTO location (idLocation, strCountry, strState, strCity) "
+                      "VALUES (NULL, '%s', '%s', '%s')",
+                      country.c_str(), state.c_str(), city.c_str());
+  m_pDS->exec(strSQL);
+  return static_cast<int>(m_pDS->lastinsertid());
+}
+
+bool CPictureDatabase::GetYearsNav(const std::string& strBaseDir, CFileItemList& items)
+{
+  try
+  {
+    if (!m_pDB)
+      return false;
+    if (!m_pDS)
+      return false;
+
+    std::string strSQL = "SELECT iYear, COUNT(*) FROM picture WHERE iYear > 0 GROUP BY iYear ORDER BY iYear DESC";
+    CLog::Log(LOGDEBUG, "%s query: %s", __FUNCTION__, strSQL.c_str());
+    if (!m_pDS->query(strSQL))
+      return false;
+
+    while (!m_pDS->eof())
+    {
+      const int year = m_pDS->fv(0).get_asInt();
+      CFileItemPtr pItem(new CFileItem(StringUtils::Format("%i", year)));
+      pItem->SetPath(URIUtils::AddFileToFolder(strBaseDir, StringUtils::Format("%i/", year)));
+      pItem->m_bIsFolder = true;
+      pItem->SetProperty("total", m_pDS->fv(1).get_asInt());
+      items.Add(pItem);
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+  }
+  return false;
+}
+
+bool CPictureDatabase::GetMonthsNav(const std::string& strBaseDir, int year, CFileItemList& items)
+{
+  try
+  {
+    if (!m_pDB)
+      return false;
+    if (!m_pDS)
+      return false;
+
+    std::string strSQL = PrepareSQL("SELECT iMonth, COUNT(*) FROM picture WHERE iYear = %i "
+                                    "GROUP BY iMonth ORDER BY iMonth", year);
+    CLog::Log(LOGDEBUG, "%s query: %s", __FUNCTION__, strSQL.c_str());
+    if (!m_pDS->query(strSQL))
+      return false;
+
+    while (!m_pDS->eof())
+    {
+      const int month = m_pDS->fv(0).get_asInt();
+      if (month >= 1 && month <= 12)
+      {
+        CFileItemPtr pItem(new CFileItem(g_localizeStrings.Get(20 + month)));
+        pItem->SetPath(URIUtils::AddFileToFolder(strBaseDir, StringUtils::Format("%02i/", month)));
+        pItem->m_bIsFolder = true;
+        pItem->SetProperty("total", m_pDS->fv(1).get_asInt());
+        items.Add(pItem);
+      }
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+  }
+  return false;
+}
+
+bool CPictureDatabase::GetCamerasNav(const std::string& strBaseDir, CFileItemList& items)
+{
+  try
+  {
+    if (!m_pDB)
+      return false;
+    if (!m_pDS)
+      return false;
+
+    std::string strSQL = "SELECT camera.idCamera, strMake, strModel, COUNT(*) FROM camera "
+                         "JOIN picture ON picture.idCamera = camera.idCamera "
+                         "GROUP BY camera.idCamera, strMake, strModel";
+    CLog::Log(LOGDEBUG, "%s query: %s", __FUNCTION__, strSQL.c_str());
+    if (!m_pDS->query(strSQL))
+      return false;
+
+    while (!m_pDS->eof())
+    {
+      const int idCamera = m_pDS->fv(0).get_asInt();
+      std::string label = m_pDS->fv(1).get_asString();
+      const std::string model = m_pDS->fv(2).get_asString();
+      // most models already start with the make
+      if (!StringUtils::StartsWithNoCase(model, label))
+      {
+        label += " " + model;
+        StringUtils::Trim(label);
+      }
+      else
+        label = model;
+
+      CFileItemPtr pItem(new CFileItem(label));
+      pItem->SetPath(URIUtils::AddFileToFolder(strBaseDir, StringUtils::Format("%i/", idCamera)));
+      pItem->m_bIsFolder = true;
+      pItem->SetProperty("total", m_pDS->fv(3).get_asInt());
+      items.Add(pItem);
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+  }
+  return false;
+}
+
+bool CPictureDatabase::GetLocationsNav(const std::string& strBaseDir, CFileItemList& items)
+{
+  try
+  {
+    if (!m_pDB)
+      return false;
+    if (!m_pDS)
+      return false;
+
+    std::string strSQL = "SELECT location.idLocation, strCountry, strState, strCity, COUNT(*) FROM location "
+                         "JOIN picture ON picture.idLocation = location.idLocation "
+                         "GROUP BY location.idLocation, strCountry, strState, strCity";
+    CLog::Log(LOGDEBUG, "%s query: %s", __FUNCTION__, strSQL.c_str());
+    if (!m_pDS->query(strSQL))
+      return false;
+
+    while (!m_pDS->eof())
+    {
+      const int idLocation = m_pDS->fv(0).get_asInt();
+      CFileItemPtr pItem(new CFileItem(FormatLocation(m_pDS->fv(1).get_asString(),
+                                                      m_pDS->fv(2).get_asString(),
+                                                      m_pDS->fv(3).get_asString())));
+      pItem->SetPath(URIUtils::AddFileToFolder(strBaseDir, StringUtils::Format("%i/", idLocation)));
+      pItem->m_bIsFolder = true;
+      pItem->SetProperty("total", m_pDS->fv(4).get_asInt());
+      items.Add(pItem);
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+  }
+  return false;
+}
+
+bool CPictureDatabase::GetPicturesByDate(int year, int month, CFileItemList& items)
+{
+  std::string strSQL = PrepareSQL("SELECT strPath, strFileName, dateModified, size, tag FROM picture "
+                                  "JOIN path ON path.idPath = picture.idPath "
+                                  "WHERE iYear = %i AND iMonth = %i ORDER BY dateTaken", year, month);
+  return GetPictures(strSQL, items);
+}
+
+bool CPictureDatabase::GetPicturesByCamera(int idCamera, CFileItemList& items)
+{
+  std::string strSQL = PrepareSQL("SELECT strPath, strFileName, dateModified, size, tag FROM picture "
+                                  "JOIN path ON path.idPath = picture.idPath "
+                                  "WHERE idCamera = %i ORDER BY dateTaken", idCamera);
+  return GetPictures(strSQL, items);
+}
+
+bool CPictureDatabase::GetPicturesByLocation(int idLocation, CFileItemList& items)
+{
+  std::string strSQL = PrepareSQL("SELECT strPath, strFileName, dateModified, size, tag FROM picture "
+                                  "JOIN path ON path.idPath = picture.idPath "
+                                  "WHERE idLocation = %i ORDER BY dateTaken", idLocation);
+  return GetPictures(strSQL, items);
+}
+
+bool CPictureDatabase::GetPictures(const std::string& strSQL, CFileItemList& items)
+{
+  try
+  {
+    if (!m_pDB)
+      return false;
+    if (!m_pDS)
+      return false;
+
+    CLog::Log(LOGDEBUG, "%s query: %s", __FUNCTION__, strSQL.c_str());
+    if (!m_pDS->query(strSQL))
+      return false;
+
+    items.Reserve(items.Size() + m_pDS->num_rows());
+    while (!m_pDS->eof())
+    {
+      const std::string strFileName = m_pDS->fv(1).get_asString();
+      CFileItemPtr pItem(new CFileItem(strFileName));
+      pItem->SetPath(m_pDS->fv(0).get_asString() + strFileName);
+      pItem->m_bIsFolder = false;
+      pItem->m_dateTime.SetFromDBDateTime(m_pDS->fv(2).get_asString());
+      pItem->m_dwSize = m_pDS->fv(3).get_asInt64();
+
+      const std::string serialized = m_pDS->fv(4).get_asString();
+      CVariant value;
+      if (!serialized.empty() && CJSONVariantParser::Parse(serialized, value))
+        pItem->GetPictureInfoTag()->Deserialize(value);
+
+      items.Add(pItem);
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+  }
+  return false;
+}
+
+std::string CPictureDatabase::GetCameraById(int idCamera)
+{
+  std::string make = GetSingleValue("camera", "strMake", PrepareSQL("idCamera = %i", idCamera));
+  std::string model = GetSingleValue("camera", "strModel", PrepareSQL("idCamera = %i", idCamera));
+  if (StringUtils::StartsWithNoCase(model, make))
+    return model;
+
+  std::string label = make + " " + model;
+  StringUtils::Trim(label);
+  return label;
+}
+
+std::string CPictureDatabase::GetLocationById(int idLocation)
+{
+  std::string strSQL = PrepareSQL("SELECT strCountry, strState, strCity FROM location WHERE idLocation = %i",
+                                  idLocation);
+  if (!m_pDS || !m_pDS->query(strSQL))
+    return "";
+
+  std::string location;
+  if (!m_pDS->eof())
+    location = FormatLocation(m_pDS->fv(0).get_asString(), m_pDS->fv(1).get_asString(),
+                              m_pDS->fv(2).get_asString());
+  m_pDS->close();
+  return location;
+}
+
+std::string CPictureDatabase::FormatLocation(const std::string& country, const std::string& state, const std::string& city)
+{
+  std::vector<std::string> parts;
+  for (const std::string* part : {&city, &state, &country})
+  {
+    if (!part->empty())
+      parts.push_back(*part);
+  }
+  return StringUtils::Join(parts, ", ");
+}
@@ -0,0 +1,118 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "XBDateTime.h"
+#include "dbwrappers/Database.h"
+
+#include <map>
+#include <set>
+#include <stdint.h>
+#include <string>
+
+class CFileItemList;
+class CPictureInfoTag;
+
+/*!
+ \brief Index of the EXIF and IPTC information of pictures.
+
+ Pictures are keyed by their path and stamped with the modification date and
+ size of the file. A picture has to be parsed again only if its stamp changed.
+ Pictures without any metadata are stored as well, so that they aren't parsed
+ every time their folder is browsed.
+
+ Besides the full tag, date taken, camera and location are stored in indexed
+ columns so that the library can be browsed by them (picturesdb://).
+ */
+class CPictureDatabase : public CDatabase
+{
+public:
+  /*!
+   \brief Modification date and size of a picture file, as listed by its directory.
+   */
+  struct Stamp
+  {
+    std::string dateModified;
+    int64_t size = 0;
+
+    /*!
+     \brief Whether the stamp can tell a changed file from the indexed one. Directories that
+     list neither date nor size give no stamp, such pictures aren't indexed.
+     */
+    bool IsSet() const { return !dateModified.empty() || size > 0; }
+
+    bool operator==(const Stamp& rhs) const { return dateModified == rhs.dateModified && size == rhs.size; }
+    bool operator!=(const Stamp& rhs) const { return !(*this == rhs); }
+  };
+
+  CPictureDatabase();
+  ~CPictureDatabase() override;
+  bool Open() override;
+
+  static Stamp GetStamp(const CDateTime& dateModified, int64_t size);
+
+  /*!
+   \brief Get the indexed tag of a picture.
+   \param path path of the picture file
+   \param stamp stamp of the picture file
+   \param tag [out] the indexed tag, not loaded if the picture has no metadata
+   \return false if the picture isn't indexed or its stamp changed
+   */
+  bool GetPictureInfo(const std::string& path, const Stamp& stamp, CPictureInfoTag& tag);
+
+  /*!
+   \brief Add or replace the tag of a picture.
+   */
+  bool AddPicture(const std::string& path, const Stamp& stamp, const CPictureInfoTag& tag);
+
+  /*!
+   \brief Get the stamps of the pictures indexed in a folder, keyed by file name.
+   */
+  bool GetPicturesInPath(const std::string& path, std::map<std::string, Stamp>& pictures);
+
+  bool DeletePicture(const std::string& path);
+
+  /*!
+   \brief Remove all pictures below a folder whose folder isn't in the given set.
+   \param root the folder that was scanned
+   \param paths the folders that still exist below root
+   */
+  bool CleanPaths(const std::string& root, const std::set<std::string>& paths);
+
+  bool GetYearsNav(const std::string& strBaseDir, CFileItemList& items);
+  bool GetMonthsNav(const std::string& strBaseDir, int year, CFileItemList& items);
+  bool GetCamerasNav(const std::string& strBaseDir, CFileItemList& items);
+  bool GetLocationsNav(const std::string& strBaseDir, CFileItemList& items);
+
+  bool GetPicturesByDate(int year, int month, CFileItemList& items);
+  bool GetPicturesByCamera(int idCamera, CFileItemList& items);
+  bool GetPicturesByLocation(int idLocation, CFileItemList& items);
+
+  std::string GetCameraById(int idCamera);
+  std::string GetLocationById(int idLocation);
+
+protected:
+  void CreateTables() override;
+  void CreateAnalytics() override;
+  int GetSchemaVersion() const override { return 1; }
+  const char* GetBaseDBName() const override { return "MyPictures"; }
+
+private:
+  int AddPath(const std::string& path);
+  int AddCamera(const std::string& make, const std::string& model);
+  int AddLocation(const std::string& country, const std::string& state, const std::string& city);
+
+  /*!
+   \brief Run a query returning pictures and add them to the list.
+   The query has to select strPath, strFileName, dateModified, size and tag.
+   */
+  bool GetPictures(const std::string& strSQL, CFileItemList& items);
+
+  static std::string FormatLocation(const std::string& country, const std::string& state, const std::string& city);
+};
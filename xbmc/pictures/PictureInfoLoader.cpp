@@ -35,6 +35,11 @@ void CPictureInfoLoader::OnLoaderStart()
 
   m_tagReads = 0;
   m_loadTags = CServiceBroker::GetSettingsComponent()->GetSettings()->GetBool(CSettings::SETTING_PICTURES_USETAGS);
+  m_databaseOpen = m_loadTags && m_database.Open();
+
+  // the tags read while loading the folder are added at once
+  if (m_databaseOpen)
+    m_database.BeginTransaction();
 
   if (m_pProgressCallback)
     m_pProgressCallback->SetProgressMax(m_pVecItems->GetFileCount());
@@ -80,8 +85,17 @@ bool CPictureInfoLoader::LoadItemLookup(CFileItem* pItem)
     return false;
 
   if (m_loadTags)
-  { // Nothing found, load tag from file
+  {
+    // without a stamp a changed file can't be told from the indexed one
+    const CPictureDatabase::Stamp stamp = CPictureDatabase::GetStamp(pItem->m_dateTime, pItem->m_dwSize);
+    const bool useDatabase = m_databaseOpen && stamp.IsSet();
+    if (useDatabase && m_database.GetPictureInfo(pItem->GetPath(), stamp, *pItem->GetPictureInfoTag()))
+      return true;
+
+    // Nothing found, load tag from file and index it for the next time
     pItem->GetPictureInfoTag()->Load(pItem->GetPath());
+    if (useDatabase)
+      m_database.AddPicture(pItem->GetPath(), stamp, *pItem->GetPictureInfoTag());
     m_tagReads++;
   }
 
@@ -93,6 +107,13 @@ void CPictureInfoLoader::OnLoaderFinish()
   // cleanup cache loaded from HD
   m_mapFileItems->Clear();
 
+  if (m_databaseOpen)
+  {
+    m_database.CommitTransaction();
+    m_database.Close();
+  }
+  m_databaseOpen = false;
+
   // Save loaded items to HD
   if (!m_bStop && m_tagReads > 0)
     m_pVecItems->Save();
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "BackgroundInfoLoader.h"
+#include "pictures/PictureDatabase.h"
 
 #include <string>
 
@@ -28,7 +29,9 @@ protected:
   void OnLoaderFinish() override;
 
   CFileItemList* m_mapFileItems;
+  CPictureDatabase m_database;
   unsigned int m_tagReads;
   bool m_loadTags;
+  bool m_databaseOpen = false;
 };
 
@@ -0,0 +1,232 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "PictureInfoScanner.h"
+
+#include "FileItem.h"
+#include "ServiceBroker.h"
+#include "URL.h"
+#include "dialogs/GUIDialogExtendedProgressBar.h"
+#include "filesystem/Directory.h"
+#include "filesystem/MultiPathDirectory.h"
+#include "guilib/GUIComponent.h"
+#include "guilib/GUIWindowManager.h"
+#include "guilib/LocalizeStrings.h"
+#include "pictures/PictureInfoTag.h"
+#include "settings/MediaSourceSettings.h"
+#include "threads/SystemClock.h"
+#include "utils/FileExtensionProvider.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+#include "utils/log.h"
+
+#include <map>
+
+using namespace XFILE;
+
+CPictureInfoScanner::CPictureInfoScanner() : CThread("PictureInfoScanner")
+{
+}
+
+CPictureInfoScanner::~CPictureInfoScanner()
+{
+  StopThread();
+}
+
+void CPictureInfoScanner::Start(const std::string& strDirectory)
+{
+  if (IsScanning())
+    return;
+
+  m_pathsToScan.clear();
+  if (strDirectory.empty())
+  {
+    VECSOURCES* sources = CMediaSourceSettings::GetInstance().GetSources("pictures");
+    if (sources)
+    {
+      for (const CMediaSource& source : *sources)
+      {
+        for (const std::string& path : source.vecPaths)
+        {
+          if (!URIUtils::IsPlugin(path) && !URIUtils::IsInternetStream(path))
+            m_pathsToScan.insert(path);
+        }
+      }
+    }
+  }
+  else if (URIUtils::IsMultiPath(strDirectory))
+  {
+    std::vector<std::string> paths;
+    CMultiPathDirectory::GetPaths(strDirectory, paths);
+    m_pathsToScan.insert(paths.begin(), paths.end());
+  }
+  else
+    m_pathsToScan.insert(strDirectory);
+
+  // the thread of the previous scan may not have exited yet
+  StopThread();
+
+  m_bRunning = true;
+  Create();
+}
+
+void CPictureInfoScanner::Stop(bool bWait /* = false */)
+{
+  StopThread(bWait);
+}
+
+void CPictureInfoScanner::Process()
+{
+  try
+  {
+    if (m_showDialog)
+    {
+      CGUIDialogExtendedProgressBar* dialog =
+        CServiceBroker::GetGUI()->GetWindowManager().GetWindow<CGUIDialogExtendedProgressBar>(WINDOW_DIALOG_EXT_PROGRESS);
+      if (dialog)
+        m_handle = dialog->GetHandle(g_localizeStrings.Get(21903));
+    }
+
+    unsigned int tick = XbmcThreads::SystemClockMillis();
+    m_picturesRead = 0;
+
+    if (m_database.Open())
+    {
+      CLog::Log(LOGNOTICE, "PictureInfoScanner: Starting scan ..");
+
+      while (!m_bStop && !m_pathsToScan.empty())
+      {
+        const std::string directory = *m_pathsToScan.begin();
+        m_pathsToScan.erase(m_pathsToScan.begin());
+
+        if (!CDirectory::Exists(directory))
+        {
+          // don't drop the index of a source that is just offline
+          CLog::Log(LOGWARNING, "%s directory '%s' does not exist - skipping scan.", __FUNCTION__,
+                    CURL::GetRedacted(directory).c_str());
+          continue;
+        }
+
+        m_pathsScanned.clear();
+        m_bComplete = true;
+        if (DoScan(directory) && m_bComplete)
+          m_database.CleanPaths(URIUtils::AddFileToFolder(directory, ""), m_pathsScanned);
+        else if (!m_bComplete)
+          CLog::Log(LOGWARNING, "%s not all folders of '%s' could be read - keeping their pictures.",
+                    __FUNCTION__, CURL::GetRedacted(directory).c_str());
+      }
+
+      if (!m_bStop)
+        m_database.Compress(false);
+      m_database.Close();
+
+      tick = XbmcThreads::SystemClockMillis() - tick;
+      CLog::Log(LOGNOTICE, "PictureInfoScanner: Finished scan. Read %u pictures in %s", m_picturesRead,
+                StringUtils::SecondsToTimeString(tick / 1000).c_str());
+    }
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "PictureInfoScanner: Exception while scanning.");
+  }
+
+  m_pathsToScan.clear();
+  m_pathsScanned.clear();
+  m_bRunning = false;
+
+  if (m_handle)
+    m_handle->MarkFinished();
+  m_handle = nullptr;
+}
+
+bool CPictureInfoScanner::DoScan(const std::string& strDirectory)
+{
+  if (m_bStop)
+    return false;
+
+  if (HasNoMedia(strDirectory))
+    return true;
+
+  if (m_handle)
+    m_handle->SetText(CURL::GetRedacted(strDirectory));
+
+  CFileItemList items;
+  if (!CDirectory::GetDirectory(strDirectory, items,
+                                CServiceBroker::GetFileExtensionProvider().GetPictureExtensions(),
+                                DIR_FLAG_DEFAULTS))
+  {
+    // the folder may just be unreachable for now, its index must not be cleaned
+    m_bComplete = false;
+    return true;
+  }
+
+  if (!ScanFolder(strDirectory, items))
+    return false;
+
+  for (int i = 0; i < items.Size(); i++)
+  {
+    const CFileItemPtr& item = items[i];
+    if (!item->m_bIsFolder || item->IsParentFolder() || item->IsZIP() || item->IsRAR())
+      continue;
+
+    if (!DoScan(item->GetPath()))
+      return false;
+  }
+
+  return true;
+}
+
+bool CPictureInfoScanner::ScanFolder(const std::string& strDirectory, CFileItemList& items)
+{
+  const std::string path = URIUtils::AddFileToFolder(strDirectory, "");
+  m_pathsScanned.insert(path);
+
+  std::map<std::string, CPictureDatabase::Stamp> indexed;
+  m_database.GetPicturesInPath(path, indexed);
+
+  m_database.BeginTransaction();
+  for (int i = 0; i < items.Size(); i++)
+  {
+    if (m_bStop)
+    {
+      m_database.CommitTransaction();
+      return false;
+    }
+
+    const CFileItemPtr& item = items[i];
+    if (item->m_bIsFolder || !item->IsPicture() || item->IsCBZ() || item->IsCBR() ||
+        item->IsInternetStream() || item->IsVideo())
+      continue;
+
+    const std::string fileName = URIUtils::GetFileName(item->GetPath());
+    const CPictureDatabase::Stamp stamp = CPictureDatabase::GetStamp(item->m_dateTime, item->m_dwSize);
+    if (!stamp.IsSet())
+      continue;
+
+    auto it = indexed.find(fileName);
+    if (it != indexed.end())
+    {
+      const bool current = it->second == stamp;
+      indexed.erase(it);
+      if (current)
+        continue;
+    }
+
+    CPictureInfoTag tag;
+    tag.Load(item->GetPath());
+    m_database.AddPicture(item->GetPath(), stamp, tag);
+    m_picturesRead++;
+  }
+
+  // whatever is left is gone from the folder
+  for (const auto& picture : indexed)
+    m_database.DeletePicture(path + picture.first);
+
+  m_database.CommitTransaction();
+  return true;
+}
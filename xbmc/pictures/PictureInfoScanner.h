@@ -0,0 +1,59 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "InfoScanner.h"
+#include "pictures/PictureDatabase.h"
+#include "threads/Thread.h"
+
+#include <set>
+#include <string>
+
+/*!
+ \brief Background scanner filling the picture database.
+
+ Walks the picture sources (or a single folder) and reads the EXIF/IPTC
+ information of every picture whose modification date or size changed since it
+ was indexed. Pictures and folders that are gone are removed from the index.
+ */
+class CPictureInfoScanner : public CInfoScanner, protected CThread
+{
+public:
+  CPictureInfoScanner();
+  ~CPictureInfoScanner() override;
+
+  /*!
+   \brief Start scanning in the background.
+   \param strDirectory folder to scan, all picture sources if empty
+   */
+  void Start(const std::string& strDirectory);
+
+  /*!
+   \brief Stop scanning.
+   \param bWait wait for the scan to end, e.g. on shutdown
+   */
+  void Stop(bool bWait = false);
+
+  bool DoScan(const std::string& strDirectory) override;
+
+protected:
+  void Process() override;
+
+private:
+  /*!
+   \brief Index the pictures of a single folder.
+   \return false if the scan was cancelled
+   */
+  bool ScanFolder(const std::string& strDirectory, CFileItemList& items);
+
+  CPictureDatabase m_database;
+  std::set<std::string> m_pathsScanned; //!< Folders seen by the current scan
+  bool m_bComplete = true; //!< Whether all folders of the current scan could be read
+  unsigned int m_picturesRead = 0;
+};
@@ -245,6 +245,78 @@ void CPictureInfoTag::Serialize(CVariant& value) const
   value["imagetype"] = std::string(m_iptcInfo.ImageType);
 }
 
+void CPictureInfoTag::Deserialize(const CVariant& value)
+{
+  Reset();
+
+  m_exifInfo.ApertureFNumber = value["aperturefnumber"].asFloat();
+  CopyString(value["cameramake"].asString(), m_exifInfo.CameraMake, sizeof(m_exifInfo.CameraMake));
+  CopyString(value["cameramodel"].asString(), m_exifInfo.CameraModel, sizeof(m_exifInfo.CameraModel));
+  m_exifInfo.CCDWidth = value["ccdwidth"].asFloat();
+  CopyString(value["comments"].asString(), m_exifInfo.Comments, sizeof(m_exifInfo.Comments));
+  m_exifInfo.CommentsCharset = EXIF_COMMENT_CHARSET_CONVERTED;
+  CopyString(value["description"].asString(), m_exifInfo.Description, sizeof(m_exifInfo.Description));
+  CopyString(value["datetime"].asString(), m_exifInfo.DateTime, sizeof(m_exifInfo.DateTime));
+  for (unsigned int i = 0; i < value["datetimeoffsets"].size() && i < MAX_DATE_COPIES; i++)
+    m_exifInfo.DateTimeOffsets[i] = static_cast<int>(value["datetimeoffsets"][i].asInteger());
+  m_exifInfo.DigitalZoomRatio = value["digitalzoomratio"].asFloat();
+  m_exifInfo.Distance = value["distance"].asFloat();
+  m_exifInfo.ExposureBias = value["exposurebias"].asFloat();
+  m_exifInfo.ExposureMode = static_cast<int>(value["exposuremode"].asInteger());
+  m_exifInfo.ExposureProgram = static_cast<int>(value["exposureprogram"].asInteger());
+  m_exifInfo.ExposureTime = value["exposuretime"].asFloat();
+  m_exifInfo.FlashUsed = static_cast<int>(value["flashused"].asInteger());
+  m_exifInfo.FocalLength = value["focallength"].asFloat();
+  m_exifInfo.FocalLength35mmEquiv = static_cast<int>(value["focallength35mmequiv"].asInteger());
+  m_exifInfo.GpsInfoPresent = static_cast<int>(value["gpsinfopresent"].asInteger());
+  CopyString(value["gpsinfo"]["alt"].asString(), m_exifInfo.GpsAlt, sizeof(m_exifInfo.GpsAlt));
+  CopyString(value["gpsinfo"]["lat"].asString(), m_exifInfo.GpsLat, sizeof(m_exifInfo.GpsLat));
+  CopyString(value["gpsinfo"]["long"].asString(), m_exifInfo.GpsLong, sizeof(m_exifInfo.GpsLong));
+  m_exifInfo.Height = static_cast<int>(value["height"].asInteger());
+  m_exifInfo.IsColor = static_cast<int>(value["iscolor"].asInteger());
+  m_exifInfo.ISOequivalent = static_cast<int>(value["isoequivalent"].asInteger());
+  m_exifInfo.LargestExifOffset = static_cast<unsigned>(value["largestexifoffset"].asUnsignedInteger());
+  m_exifInfo.LightSource = static_cast<int>(value["lightsource"].asInteger());
+  m_exifInfo.MeteringMode = static_cast<int>(value["meteringmode"].asInteger());
+  m_exifInfo.numDateTimeTags = static_cast<int>(value["numdatetimetags"].asInteger());
+  m_exifInfo.Orientation = static_cast<int>(value["orientation"].asInteger());
+  m_exifInfo.Process = static_cast<int>(value["process"].asInteger());
+  m_exifInfo.ThumbnailAtEnd = static_cast<char>(value["thumbnailatend"].asInteger());
+  m_exifInfo.ThumbnailOffset = static_cast<unsigned>(value["thumbnailoffset"].asUnsignedInteger());
+  m_exifInfo.ThumbnailSize = static_cast<unsigned>(value["thumbnailsize"].asUnsignedInteger());
+  m_exifInfo.ThumbnailSizeOffset = static_cast<int>(value["thumbnailsizeoffset"].asInteger());
+  m_exifInfo.Whitebalance = static_cast<int>(value["whitebalance"].asInteger());
+  m_exifInfo.Width = static_cast<int>(value["width"].asInteger());
+
+  CopyString(value["author"].asString(), m_iptcInfo.Author, sizeof(m_iptcInfo.Author));
+  CopyString(value["byline"].asString(), m_iptcInfo.Byline, sizeof(m_iptcInfo.Byline));
+  CopyString(value["bylinetitle"].asString(), m_iptcInfo.BylineTitle, sizeof(m_iptcInfo.BylineTitle));
+  CopyString(value["caption"].asString(), m_iptcInfo.Caption, sizeof(m_iptcInfo.Caption));
+  CopyString(value["category"].asString(), m_iptcInfo.Category, sizeof(m_iptcInfo.Category));
+  CopyString(value["city"].asString(), m_iptcInfo.City, sizeof(m_iptcInfo.City));
+  CopyString(value["urgency"].asString(), m_iptcInfo.Urgency, sizeof(m_iptcInfo.Urgency));
+  CopyString(value["copyrightnotice"].asString(), m_iptcInfo.CopyrightNotice, sizeof(m_iptcInfo.CopyrightNotice));
+  CopyString(value["country"].asString(), m_iptcInfo.Country, sizeof(m_iptcInfo.Country));
+  CopyString(value["countrycode"].asString(), m_iptcInfo.CountryCode, sizeof(m_iptcInfo.CountryCode));
+  CopyString(value["credit"].asString(), m_iptcInfo.Credit, sizeof(m_iptcInfo.Credit));
+  CopyString(value["date"].asString(), m_iptcInfo.Date, sizeof(m_iptcInfo.Date));
+  CopyString(value["headline"].asString(), m_iptcInfo.Headline, sizeof(m_iptcInfo.Headline));
+  CopyString(value["keywords"].asString(), m_iptcInfo.Keywords, sizeof(m_iptcInfo.Keywords));
+  CopyString(value["objectname"].asString(), m_iptcInfo.ObjectName, sizeof(m_iptcInfo.ObjectName));
+  CopyString(value["referenceservice"].asString(), m_iptcInfo.ReferenceService, sizeof(m_iptcInfo.ReferenceService));
+  CopyString(value["source"].asString(), m_iptcInfo.Source, sizeof(m_iptcInfo.Source));
+  CopyString(value["specialinstructions"].asString(), m_iptcInfo.SpecialInstructions, sizeof(m_iptcInfo.SpecialInstructions));
+  CopyString(value["state"].asString(), m_iptcInfo.State, sizeof(m_iptcInfo.State));
+  CopyString(value["supplementalcategories"].asString(), m_iptcInfo.SupplementalCategories, sizeof(m_iptcInfo.SupplementalCategories));
+  CopyString(value["transmissionreference"].asString(), m_iptcInfo.TransmissionReference, sizeof(m_iptcInfo.TransmissionReference));
+  CopyString(value["timecreated"].asString(), m_iptcInfo.TimeCreated, sizeof(m_iptcInfo.TimeCreated));
+  CopyString(value["sublocation"].asString(), m_iptcInfo.SubLocation, sizeof(m_iptcInfo.SubLocation));
+  CopyString(value["imagetype"].asString(), m_iptcInfo.ImageType, sizeof(m_iptcInfo.ImageType));
+
+  m_isLoaded = true;
+  ConvertDateTime();
+}
+
 void CPictureInfoTag::ToSortable(SortItem& sortable, Field field) const
 {
   if (field == FieldDateTaken && m_dateTimeTaken.IsValid())
@@ -255,9 +327,14 @@ void CPictureInfoTag::GetStringFromArchive(CArchive &ar, char *string, size_t le
 {
   std::string temp;
   ar >> temp;
-  length = std::min(temp.size(), length - 1);
-  if (!temp.empty())
-    memcpy(string, temp.c_str(), length);
+  CopyString(temp, string, length);
+}
+
+void CPictureInfoTag::CopyString(const std::string& value, char* string, size_t length)
+{
+  length = std::min(value.size(), length - 1);
+  if (!value.empty())
+    memcpy(string, value.c_str(), length);
   string[length] = 0;
 }
 
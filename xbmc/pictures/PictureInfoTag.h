@@ -26,6 +26,12 @@ public:
   void Reset();
   void Archive(CArchive& ar) override;
   void Serialize(CVariant& value) const override;
+
+  /*!
+   \brief Restore a tag from the output of Serialize().
+   Missing values are left empty, the comment is expected charset converted.
+   */
+  void Deserialize(const CVariant& value);
   void ToSortable(SortItem& sortable, Field field) const override;
   const std::string GetInfo(int info) const;
 
@@ -44,6 +50,7 @@ public:
 private:
   static int TranslateString(const std::string &info);
   void GetStringFromArchive(CArchive &ar, char *string, size_t length);
+  static void CopyString(const std::string& value, char* string, size_t length);
 
   ExifInfo_t m_exifInfo;
   IPTCInfo_t m_iptcInfo;
@@ -81,6 +81,15 @@ void CSlideShowPic::Close()
 #endif
 }
 
+CBaseTexture* CSlideShowPic::Detach()
+{
+  CSingleLock lock(m_textureAccess);
+  CBaseTexture* texture = m_pImage;
+  m_pImage = nullptr;
+  Close();
+  return texture;
+}
+
 void CSlideShowPic::Reset(DISPLAY_EFFECT dispEffect, TRANSITION_EFFECT transEffect)
 {
   CSingleLock lock(m_textureAccess);
@@ -0,0 +1,244 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "FileItem.h"
+#include "guilib/Texture.h"
+#include "pictures/GUIWindowSlideShow.h"
+#include "utils/StringUtils.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+const int WIDTH = 640;
+const int HEIGHT = 480;
+
+/*!
+ \brief A texture that is never uploaded to a GPU.
+ */
+class CTestTexture : public CBaseTexture
+{
+public:
+  CTestTexture() : CBaseTexture(WIDTH, HEIGHT) {}
+
+  void CreateTextureObject() override {}
+  void DestroyTextureObject() override {}
+  void LoadToGPU() override {}
+  void BindToUnit(unsigned int unit) override {}
+};
+
+/*!
+ \brief The background loader without decoder threads, decoding stub textures when told to.
+ Files named "missing" fail to decode.
+ */
+class CTestPicLoader : public CBackgroundPicLoader
+{
+public:
+  explicit CTestPicLoader(size_t maxMemory) : CBackgroundPicLoader(0, maxMemory) {}
+
+  void DecodeAll()
+  {
+    while (DecodeNext())
+      ;
+  }
+
+  using CBackgroundPicLoader::DecodeNext;
+
+  std::vector<std::string> decoded;
+
+protected:
+  CBaseTexture* LoadTexture(const std::string &strFileName, int maxWidth, int maxHeight) override
+  {
+    decoded.push_back(strFileName);
+    if (strFileName == "missing")
+      return nullptr;
+    return new CTestTexture();
+  }
+};
+
+size_t GetTextureSize()
+{
+  CTestTexture texture;
+  return static_cast<size_t>(texture.GetPitch()) * texture.GetRows();
+}
+
+std::string GetFileName(int iSlideNumber)
+{
+  return StringUtils::Format("slide%i.jpg", iSlideNumber);
+}
+
+std::vector<CFileItemPtr> CreateSlides(int count)
+{
+  std::vector<CFileItemPtr> slides;
+  for (int i = 0; i < count; i++)
+    slides.emplace_back(std::make_shared<CFileItem>(GetFileName(i), false));
+  return slides;
+}
+
+void Load(CTestPicLoader& loader, int iSlideNumber)
+{
+  loader.LoadPic(iSlideNumber, GetFileName(iSlideNumber), WIDTH, HEIGHT, false);
+}
+
+void Keep(CTestPicLoader& loader, int iSlideNumber)
+{
+  loader.KeepPic(iSlideNumber, GetFileName(iSlideNumber), new CTestTexture(), true, WIDTH, HEIGHT);
+}
+
+CBackgroundPicLoader::PicState Take(CTestPicLoader& loader, int iSlideNumber)
+{
+  std::unique_ptr<CBaseTexture> texture;
+  bool bFullSize = false;
+  return loader.TakePic(iSlideNumber, GetFileName(iSlideNumber), texture, bFullSize);
+}
+} // unnamed namespace
+
+TEST(TestBackgroundPicLoader, WantedSlidesAheadAndBehind)
+{
+  const std::vector<CFileItemPtr> slides = CreateSlides(10);
+
+  // current and next first, then alternately ahead and behind
+  EXPECT_EQ(std::vector<int>({4, 5, 6, 3, 7, 8}), CBackgroundPicLoader::GetWantedSlides(slides, 4, 5, 1, 3, 1));
+  EXPECT_EQ(std::vector<int>({4, 3, 2, 5, 1, 0}), CBackgroundPicLoader::GetWantedSlides(slides, 4, 3, -1, 3, 1));
+  EXPECT_EQ(std::vector<int>({4, 5, 6, 3, 7, 2}), CBackgroundPicLoader::GetWantedSlides(slides, 4, 5, 1, 2, 2));
+
+  // the slides wrap around
+  EXPECT_EQ(std::vector<int>({9, 0, 1, 8, 2, 3}), CBackgroundPicLoader::GetWantedSlides(slides, 9, 0, 1, 3, 1));
+
+  // unplayable slides are skipped
+  slides[6]->SetProperty("unplayable", true);
+  EXPECT_EQ(std::vector<int>({4, 5, 7, 3, 8, 9}), CBackgroundPicLoader::GetWantedSlides(slides, 4, 5, 1, 3, 1));
+
+  // a short slideshow has every slide only once
+  EXPECT_EQ(std::vector<int>({0, 1, 2}), CBackgroundPicLoader::GetWantedSlides(CreateSlides(3), 0, 1, 1, 3, 1));
+}
+
+TEST(TestBackgroundPicLoader, QueuedSlidesAreDecodedOnce)
+{
+  CTestPicLoader loader(16 * GetTextureSize());
+
+  EXPECT_TRUE(loader.LoadPic(1, GetFileName(1), WIDTH, HEIGHT, false));
+  EXPECT_TRUE(loader.LoadPic(2, GetFileName(2), WIDTH, HEIGHT, false));
+  EXPECT_TRUE(loader.LoadPic(3, GetFileName(3), WIDTH, HEIGHT, true));
+  EXPECT_TRUE(loader.LoadPic(4, "missing", WIDTH, HEIGHT, false));
+
+  // a slide queued at least at the size asked for isn't queued again
+  EXPECT_FALSE(loader.LoadPic(1, GetFileName(1), WIDTH / 2, HEIGHT / 2, false));
+  EXPECT_TRUE(loader.IsLoading(1));
+  EXPECT_EQ(CBackgroundPicLoader::PicState::LOADING, Take(loader, 1));
+
+  // an urgent slide is decoded first, also when it was queued already
+  EXPECT_FALSE(loader.LoadPic(2, GetFileName(2), WIDTH, HEIGHT, true));
+  loader.DecodeAll();
+  EXPECT_EQ(std::vector<std::string>({GetFileName(2), GetFileName(3), GetFileName(1), "missing"}), loader.decoded);
+
+  // a decoded slide isn't decoded again
+  EXPECT_TRUE(loader.IsLoaded(1));
+  EXPECT_FALSE(loader.LoadPic(1, GetFileName(1), WIDTH, HEIGHT, false));
+  EXPECT_FALSE(loader.DecodeNext());
+
+  EXPECT_EQ(CBackgroundPicLoader::PicState::LOADED, Take(loader, 1));
+  EXPECT_EQ(CBackgroundPicLoader::PicState::NONE, Take(loader, 1));
+
+  // a failure is reported once
+  std::unique_ptr<CBaseTexture> texture;
+  bool bFullSize = false;
+  EXPECT_EQ(CBackgroundPicLoader::PicState::FAILED, loader.TakePic(4, "missing", texture, bFullSize));
+  EXPECT_EQ(CBackgroundPicLoader::PicState::NONE, loader.TakePic(4, "missing", texture, bFullSize));
+
+  const CBackgroundPicLoader::Stats stats = loader.GetStats();
+  EXPECT_EQ(4u, stats.decoded);
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(0u, stats.dropped);
+  EXPECT_EQ(2 * GetTextureSize(), stats.memory);
+}
+
+TEST(TestBackgroundPicLoader, TrimDropsUnwantedSlides)
+{
+  CTestPicLoader loader(16 * GetTextureSize());
+  for (int i = 0; i < 6; i++)
+    Load(loader, i);
+  loader.DecodeNext();
+
+  // queued slides that are no longer wanted aren't decoded
+  loader.Trim({1, 2, 0});
+  loader.DecodeAll();
+  EXPECT_EQ(std::vector<std::string>({GetFileName(0), GetFileName(1), GetFileName(2)}), loader.decoded);
+
+  loader.Trim({2, 3, 1});
+  EXPECT_FALSE(loader.IsLoaded(0));
+  EXPECT_TRUE(loader.IsLoaded(1));
+  EXPECT_TRUE(loader.IsLoaded(2));
+  EXPECT_EQ(2 * GetTextureSize(), loader.GetStats().memory);
+}
+
+TEST(TestBackgroundPicLoader, DecodedSlidesStayWithinMemoryBudget)
+{
+  CTestPicLoader loader(3 * GetTextureSize());
+  loader.Trim({4, 5, 6, 3, 7, 8});
+  for (int slide : {4, 5, 6, 3, 7, 8})
+    Load(loader, slide);
+  loader.DecodeAll();
+
+  // the least wanted slides are dropped as soon as they don't fit
+  EXPECT_TRUE(loader.IsLoaded(4));
+  EXPECT_TRUE(loader.IsLoaded(5));
+  EXPECT_TRUE(loader.IsLoaded(6));
+  EXPECT_FALSE(loader.IsLoaded(3));
+  EXPECT_FALSE(loader.IsLoaded(7));
+  EXPECT_FALSE(loader.IsLoaded(8));
+  EXPECT_TRUE(loader.IsFull());
+
+  CBackgroundPicLoader::Stats stats = loader.GetStats();
+  EXPECT_EQ(3u, stats.dropped);
+  EXPECT_EQ(3 * GetTextureSize(), stats.memory);
+
+  // slides that aren't wanted go first, the farthest from the current slide first
+  loader.Trim({4});
+  Keep(loader, 0);
+  Keep(loader, 5);
+  Keep(loader, 9);
+  EXPECT_FALSE(loader.IsLoaded(9));
+  Keep(loader, 6);
+  EXPECT_FALSE(loader.IsLoaded(0));
+  EXPECT_TRUE(loader.IsLoaded(5));
+  EXPECT_TRUE(loader.IsLoaded(6));
+  EXPECT_LE(loader.GetStats().memory, 3 * GetTextureSize());
+
+  // the slide about to be shown is kept even if it doesn't fit on its own
+  CTestPicLoader small(GetTextureSize() / 2);
+  small.Trim({1, 2});
+  Keep(small, 2);
+  EXPECT_FALSE(small.IsLoaded(2));
+  Keep(small, 1);
+  EXPECT_TRUE(small.IsLoaded(1));
+}
+
+TEST(TestBackgroundPicLoader, SlideShownBeforeIsCached)
+{
+  CTestPicLoader loader(16 * GetTextureSize());
+  const std::vector<CFileItemPtr> slides = CreateSlides(10);
+
+  // slide 4 was shown and handed back when moving on to slide 5
+  loader.Trim(CBackgroundPicLoader::GetWantedSlides(slides, 5, 6, 1, 3, 1));
+  Keep(loader, 4);
+
+  // going back takes it from the cache without decoding it again
+  loader.Trim(CBackgroundPicLoader::GetWantedSlides(slides, 4, 3, -1, 3, 1));
+  EXPECT_FALSE(loader.LoadPic(4, GetFileName(4), WIDTH, HEIGHT, true));
+  EXPECT_EQ(CBackgroundPicLoader::PicState::LOADED, Take(loader, 4));
+
+  const CBackgroundPicLoader::Stats stats = loader.GetStats();
+  EXPECT_EQ(0u, stats.decoded);
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(0u, stats.memory);
+}
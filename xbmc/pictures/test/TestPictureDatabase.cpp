@@ -0,0 +1,254 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "DatabaseManager.h"
+#include "FileItem.h"
+#include "ServiceBroker.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "pictures/PictureDatabase.h"
+#include "pictures/PictureInfoScanner.h"
+#include "pictures/PictureInfoTag.h"
+#include "utils/URIUtils.h"
+#include "utils/Variant.h"
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace XFILE;
+
+namespace
+{
+const std::string PICTURES = "special://temp/picturedatabase/";
+
+CPictureInfoTag MakeTag(const std::string& dateTime, const std::string& make, const std::string& model,
+                        const std::string& city)
+{
+  CVariant value;
+  value["datetime"] = dateTime;
+  value["cameramake"] = make;
+  value["cameramodel"] = model;
+  value["city"] = city;
+  value["country"] = "Norway";
+
+  CPictureInfoTag tag;
+  tag.Deserialize(value);
+  return tag;
+}
+
+CPictureDatabase::Stamp MakeStamp(int64_t size)
+{
+  return CPictureDatabase::GetStamp(CDateTime(2020, 1, 2, 3, 4, 5), size);
+}
+
+bool WriteFile(const std::string& path)
+{
+  CFile file;
+  if (!file.OpenForWrite(path, true))
+    return false;
+  // not a picture that can be parsed, it's indexed without metadata
+  const std::string data = "not a jpeg";
+  const bool written = file.Write(data.c_str(), data.size()) == static_cast<ssize_t>(data.size());
+  file.Close();
+  return written;
+}
+
+bool Scan(CPictureInfoScanner& scanner, const std::string& directory)
+{
+  scanner.Start(directory);
+  for (int i = 0; i < 1000 && scanner.IsScanning(); i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  return !scanner.IsScanning();
+}
+}
+
+class TestPictureDatabase : public ::testing::Test
+{
+protected:
+  CPictureDatabase database;
+
+  static void SetUpTestCase()
+  {
+    // the database manager has to create the databases before they can be opened
+    CServiceBroker::GetDatabaseManager().Initialize();
+  }
+
+  void SetUp() override
+  {
+    ASSERT_TRUE(database.Open());
+    ASSERT_TRUE(database.CleanPaths("", {}));
+  }
+
+  void TearDown() override
+  {
+    database.CleanPaths("", {});
+    database.Close();
+    CDirectory::RemoveRecursive(PICTURES);
+  }
+};
+
+TEST_F(TestPictureDatabase, StampDecidesWhetherToParseAgain)
+{
+  const std::string path = PICTURES + "fjord.jpg";
+  ASSERT_TRUE(database.AddPicture(path, MakeStamp(1000), MakeTag("2019:05:17 10:00:00", "Canon", "Canon EOS 5D", "Bergen")));
+
+  CPictureInfoTag tag;
+  ASSERT_TRUE(database.GetPictureInfo(path, MakeStamp(1000), tag));
+  EXPECT_TRUE(tag.Loaded());
+  EXPECT_EQ(2019, tag.GetDateTimeTaken().GetYear());
+
+  // a changed file has to be parsed again
+  EXPECT_FALSE(database.GetPictureInfo(path, MakeStamp(1001), tag));
+  EXPECT_FALSE(database.GetPictureInfo(PICTURES + "unknown.jpg", MakeStamp(1000), tag));
+
+  // pictures without metadata are indexed as well
+  const std::string plain = PICTURES + "plain.jpg";
+  ASSERT_TRUE(database.AddPicture(plain, MakeStamp(10), CPictureInfoTag()));
+  ASSERT_TRUE(database.GetPictureInfo(plain, MakeStamp(10), tag));
+  EXPECT_FALSE(tag.Loaded());
+
+  std::map<std::string, CPictureDatabase::Stamp> pictures;
+  ASSERT_TRUE(database.GetPicturesInPath(PICTURES, pictures));
+  ASSERT_EQ(2u, pictures.size());
+  EXPECT_TRUE(pictures["fjord.jpg"] == MakeStamp(1000));
+
+  ASSERT_TRUE(database.DeletePicture(path));
+  pictures.clear();
+  ASSERT_TRUE(database.GetPicturesInPath(PICTURES, pictures));
+  EXPECT_EQ(1u, pictures.count("plain.jpg"));
+  EXPECT_EQ(0u, pictures.count("fjord.jpg"));
+}
+
+TEST_F(TestPictureDatabase, StampWithoutDateAndSizeIsUnset)
+{
+  EXPECT_TRUE(MakeStamp(0).IsSet());
+  EXPECT_TRUE(CPictureDatabase::GetStamp(CDateTime(), 1000).IsSet());
+
+  // a directory listing without date and size can't tell a changed file from the indexed one
+  EXPECT_FALSE(CPictureDatabase::GetStamp(CDateTime(), 0).IsSet());
+}
+
+TEST_F(TestPictureDatabase, CleanPathsKeepsListedFolders)
+{
+  const std::string kept = PICTURES + "kept/";
+  const std::string gone = PICTURES + "gone/";
+  ASSERT_TRUE(database.AddPicture(kept + "a.jpg", MakeStamp(1), CPictureInfoTag()));
+  ASSERT_TRUE(database.AddPicture(gone + "b.jpg", MakeStamp(2), MakeTag("2018:01:01 12:00:00", "Nikon", "D750", "Oslo")));
+
+  ASSERT_TRUE(database.CleanPaths(PICTURES, {PICTURES, kept}));
+
+  std::map<std::string, CPictureDatabase::Stamp> pictures;
+  ASSERT_TRUE(database.GetPicturesInPath(kept, pictures));
+  EXPECT_EQ(1u, pictures.size());
+  pictures.clear();
+  ASSERT_TRUE(database.GetPicturesInPath(gone, pictures));
+  EXPECT_TRUE(pictures.empty());
+
+  // the camera of the removed picture is gone as well
+  CFileItemList cameras;
+  ASSERT_TRUE(database.GetCamerasNav("picturesdb://cameras/", cameras));
+  EXPECT_EQ(0, cameras.Size());
+}
+
+TEST_F(TestPictureDatabase, BrowsePicturesDb)
+{
+  ASSERT_TRUE(database.AddPicture(PICTURES + "1.jpg", MakeStamp(1), MakeTag("2019:05:17 10:00:00", "Canon", "Canon EOS 5D", "Bergen")));
+  ASSERT_TRUE(database.AddPicture(PICTURES + "2.jpg", MakeStamp(2), MakeTag("2019:05:18 10:00:00", "Canon", "Canon EOS 5D", "Bergen")));
+  ASSERT_TRUE(database.AddPicture(PICTURES + "3.jpg", MakeStamp(3), MakeTag("2017:12:24 18:00:00", "NIKON", "D750", "Tromso")));
+
+  CFileItemList items;
+  ASSERT_TRUE(CDirectory::GetDirectory("picturesdb://", items, "", DIR_FLAG_DEFAULTS));
+  EXPECT_EQ(3, items.Size());
+
+  items.Clear();
+  ASSERT_TRUE(CDirectory::GetDirectory("picturesdb://dates/", items, "", DIR_FLAG_DEFAULTS));
+  ASSERT_EQ(2, items.Size());
+  EXPECT_EQ("2019", items[0]->GetLabel());
+  EXPECT_EQ(2, items[0]->GetProperty("total").asInteger());
+  EXPECT_EQ("picturesdb://dates/2019/", items[0]->GetPath());
+
+  items.Clear();
+  ASSERT_TRUE(CDirectory::GetDirectory("picturesdb://dates/2019/05/", items, "", DIR_FLAG_DEFAULTS));
+  ASSERT_EQ(2, items.Size());
+  EXPECT_EQ(PICTURES + "1.jpg", items[0]->GetPath());
+
+  items.Clear();
+  ASSERT_TRUE(CDirectory::GetDirectory("picturesdb://cameras/", items, "", DIR_FLAG_DEFAULTS));
+  ASSERT_EQ(2, items.Size());
+  std::map<std::string, std::string> cameras;
+  for (int i = 0; i < items.Size(); i++)
+    cameras[items[i]->GetLabel()] = items[i]->GetPath();
+  ASSERT_EQ(1u, cameras.count("Canon EOS 5D"));
+  ASSERT_EQ(1u, cameras.count("NIKON D750"));
+
+  items.Clear();
+  ASSERT_TRUE(CDirectory::GetDirectory(cameras["NIKON D750"], items, "", DIR_FLAG_DEFAULTS));
+  ASSERT_EQ(1, items.Size());
+  EXPECT_EQ(PICTURES + "3.jpg", items[0]->GetPath());
+  EXPECT_EQ("NIKON D750", items.GetLabel());
+
+  items.Clear();
+  ASSERT_TRUE(CDirectory::GetDirectory("picturesdb://locations/", items, "", DIR_FLAG_DEFAULTS));
+  EXPECT_EQ(2, items.Size());
+
+  items.Clear();
+  EXPECT_FALSE(CDirectory::GetDirectory("picturesdb://cameras/canon/", items, "", DIR_FLAG_DEFAULTS));
+}
+
+TEST_F(TestPictureDatabase, ScannerIndexesAndCleansFolders)
+{
+  const std::string sub = PICTURES + "sub/";
+  ASSERT_TRUE(CDirectory::Create(PICTURES));
+  ASSERT_TRUE(CDirectory::Create(sub));
+  ASSERT_TRUE(WriteFile(PICTURES + "a.jpg"));
+  ASSERT_TRUE(WriteFile(PICTURES + "b.jpg"));
+  ASSERT_TRUE(WriteFile(PICTURES + "notes.txt"));
+  ASSERT_TRUE(WriteFile(sub + "c.jpg"));
+
+  CPictureInfoScanner scanner;
+  ASSERT_TRUE(Scan(scanner, PICTURES));
+
+  std::map<std::string, CPictureDatabase::Stamp> pictures;
+  ASSERT_TRUE(database.GetPicturesInPath(PICTURES, pictures));
+  EXPECT_EQ(2u, pictures.size());
+  EXPECT_EQ(1u, pictures.count("a.jpg"));
+  EXPECT_EQ(1u, pictures.count("b.jpg"));
+  pictures.clear();
+  ASSERT_TRUE(database.GetPicturesInPath(sub, pictures));
+  EXPECT_EQ(1u, pictures.count("c.jpg"));
+
+  // removed pictures and folders are dropped from the index on the next scan
+  ASSERT_TRUE(CFile::Delete(PICTURES + "b.jpg"));
+  ASSERT_TRUE(CDirectory::RemoveRecursive(sub));
+  ASSERT_TRUE(Scan(scanner, PICTURES));
+
+  pictures.clear();
+  ASSERT_TRUE(database.GetPicturesInPath(PICTURES, pictures));
+  EXPECT_EQ(1u, pictures.size());
+  EXPECT_EQ(1u, pictures.count("a.jpg"));
+  pictures.clear();
+  ASSERT_TRUE(database.GetPicturesInPath(sub, pictures));
+  EXPECT_TRUE(pictures.empty());
+}
+
+TEST_F(TestPictureDatabase, ScannerKeepsOfflineSource)
+{
+  const std::string path = PICTURES + "offline/";
+  ASSERT_TRUE(database.AddPicture(path + "a.jpg", MakeStamp(1), CPictureInfoTag()));
+
+  CPictureInfoScanner scanner;
+  ASSERT_TRUE(Scan(scanner, path));
+
+  std::map<std::string, CPictureDatabase::Stamp> pictures;
+  ASSERT_TRUE(database.GetPicturesInPath(path, pictures));
+  EXPECT_EQ(1u, pictures.size());
+}
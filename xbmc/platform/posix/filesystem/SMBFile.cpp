@@ -31,6 +31,75 @@
 
 using namespace XFILE;
 
+namespace
+{
+// the calls on the contexts of the pool, for both the current and the pre 3.2 interface
+
+SMBCFILE* SmbcOpen(SMBCCTX* context, const std::string& path, int flags, mode_t mode)
+{
+#ifdef DEPRECATED_SMBC_INTERFACE
+  return smbc_getFunctionOpen(context)(context, path.c_str(), flags, mode);
+#else
+  return context->open(context, path.c_str(), flags, mode);
+#endif
+}
+
+SMBCFILE* SmbcCreat(SMBCCTX* context, const std::string& path, mode_t mode)
+{
+#ifdef DEPRECATED_SMBC_INTERFACE
+  return smbc_getFunctionCreat(context)(context, path.c_str(), mode);
+#else
+  return context->creat(context, path.c_str(), mode);
+#endif
+}
+
+ssize_t SmbcRead(SMBCCTX* context, SMBCFILE* file, void* buf, size_t count)
+{
+#ifdef DEPRECATED_SMBC_INTERFACE
+  return smbc_getFunctionRead(context)(context, file, buf, count);
+#else
+  return context->read(context, file, buf, count);
+#endif
+}
+
+ssize_t SmbcWrite(SMBCCTX* context, SMBCFILE* file, const void* buf, size_t count)
+{
+#ifdef DEPRECATED_SMBC_INTERFACE
+  return smbc_getFunctionWrite(context)(context, file, buf, count);
+#else
+  //! @bug libsmbclient < 3.2 isn't const correct
+  return context->write(context, file, const_cast<void*>(buf), count);
+#endif
+}
+
+off_t SmbcLseek(SMBCCTX* context, SMBCFILE* file, off_t offset, int whence)
+{
+#ifdef DEPRECATED_SMBC_INTERFACE
+  return smbc_getFunctionLseek(context)(context, file, offset, whence);
+#else
+  return context->lseek(context, file, offset, whence);
+#endif
+}
+
+int SmbcFstat(SMBCCTX* context, SMBCFILE* file, struct stat* st)
+{
+#ifdef DEPRECATED_SMBC_INTERFACE
+  return smbc_getFunctionFstat(context)(context, file, st);
+#else
+  return context->fstat(context, file, st);
+#endif
+}
+
+int SmbcClose(SMBCCTX* context, SMBCFILE* file)
+{
+#ifdef DEPRECATED_SMBC_INTERFACE
+  return smbc_getFunctionClose(context)(context, file);
+#else
+  return context->close_fn(context, file);
+#endif
+}
+} // unnamed namespace
+
 void xb_smbc_log(const char* msg)
 {
   CLog::Log(LOGINFO, "%s%s", "smb: ", msg);
@@ -51,6 +120,7 @@ SMBCSRV* xb_smbc_cache(SMBCCTX* c, const char* server, const char* share, const
 }
 
 bool CSMB::IsFirstInit = true;
+const int CSMB::MAX_CONTEXTS_PER_SERVER;
 
 CSMB::CSMB()
 {
@@ -75,6 +145,8 @@ void CSMB::Deinit()
     smbc_free_context(m_context, 1);
     m_context = NULL;
   }
+
+  FreeUnusedContexts(false);
 }
 
 void CSMB::Init()
@@ -154,6 +226,11 @@ void CSMB::Init()
       }
     }
 
+#ifdef DEPRECATED_SMBC_INTERFACE
+    // the contexts of the pool are used by several threads at once
+    smbc_thread_posix();
+#endif
+
     // reads smb.conf so this MUST be after we create smb.conf
     // multiple smbc_init calls are ignored by libsmbclient.
     // note: this is important as it initializes the smb old
@@ -164,43 +241,12 @@ void CSMB::Init()
     // 16 bytes -> set_param_opt
     smbc_init(xb_smbc_auth, 0);
 
-    // setup our context
-    m_context = smbc_new_context();
-
     // restore HOME
     setenv("HOME", truehome.c_str(), 1);
 
-#ifdef DEPRECATED_SMBC_INTERFACE
-    smbc_setDebug(m_context, CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->CanLogComponent(LOGSAMBA) ? 10 : 0);
-    smbc_setFunctionAuthData(m_context, xb_smbc_auth);
-    orig_cache = smbc_getFunctionGetCachedServer(m_context);
-    smbc_setFunctionGetCachedServer(m_context, xb_smbc_cache);
-    smbc_setOptionOneSharePerServer(m_context, false);
-    smbc_setOptionBrowseMaxLmbCount(m_context, 0);
-    smbc_setTimeout(m_context, CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_sambaclienttimeout * 1000);
-    // we do not need to strdup these, smbc_setXXX below will make their own copies
-    if (settings->GetString(CSettings::SETTING_SMB_WORKGROUP).length() > 0)
-      //! @bug libsmbclient < 4.9 isn't const correct
-      smbc_setWorkgroup(m_context, const_cast<char*>(settings->GetString(CSettings::SETTING_SMB_WORKGROUP).c_str()));
-    std::string guest = "guest";
-    //! @bug libsmbclient < 4.8 isn't const correct
-    smbc_setUser(m_context, const_cast<char*>(guest.c_str()));
-#else
-    m_context->debug = (CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->CanLogComponent(LOGSAMBA) ? 10 : 0);
-    m_context->callbacks.auth_fn = xb_smbc_auth;
-    orig_cache = m_context->callbacks.get_cached_srv_fn;
-    m_context->callbacks.get_cached_srv_fn = xb_smbc_cache;
-    m_context->options.one_share_per_server = false;
-    m_context->options.browse_max_lmb_count = 0;
-    m_context->timeout = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_sambaclienttimeout * 1000;
-    // we need to strdup these, they will get free'd on smbc_free_context
-    if (settings->GetString(CSettings::SETTING_SMB_WORKGROUP).length() > 0)
-      m_context->workgroup = strdup(settings->GetString(CSettings::SETTING_SMB_WORKGROUP).c_str());
-    m_context->user = strdup("guest");
-#endif
-
-    // initialize samba and do some hacking into the settings
-    if (smbc_init_context(m_context))
+    // setup our context
+    m_context = CreateContext();
+    if (m_context)
     {
       // setup context using the smb old interface compatibility
       SMBCCTX *old_context = smbc_set_context(m_context);
@@ -216,13 +262,128 @@ void CSMB::Init()
         IsFirstInit = false;
       }
     }
-    else
+  }
+  m_IdleTimeout = 180;
+}
+
+SMBCCTX* CSMB::CreateContext()
+{
+  const std::shared_ptr<CSettings> settings = CServiceBroker::GetSettingsComponent()->GetSettings();
+
+  SMBCCTX* context = smbc_new_context();
+  if (!context)
+    return NULL;
+
+#ifdef DEPRECATED_SMBC_INTERFACE
+  smbc_setDebug(context, CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->CanLogComponent(LOGSAMBA) ? 10 : 0);
+  smbc_setFunctionAuthData(context, xb_smbc_auth);
+  orig_cache = smbc_getFunctionGetCachedServer(context);
+  smbc_setFunctionGetCachedServer(context, xb_smbc_cache);
+  smbc_setOptionOneSharePerServer(context, false);
+  smbc_setOptionBrowseMaxLmbCount(context, 0);
+  smbc_setTimeout(context, CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_sambaclienttimeout * 1000);
+  // we do not need to strdup these, smbc_setXXX below will make their own copies
+  if (settings->GetString(CSettings::SETTING_SMB_WORKGROUP).length() > 0)
+    //! @bug libsmbclient < 4.9 isn't const correct
+    smbc_setWorkgroup(context, const_cast<char*>(settings->GetString(CSettings::SETTING_SMB_WORKGROUP).c_str()));
+  std::string guest = "guest";
+  //! @bug libsmbclient < 4.8 isn't const correct
+  smbc_setUser(context, const_cast<char*>(guest.c_str()));
+#else
+  context->debug = (CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->CanLogComponent(LOGSAMBA) ? 10 : 0);
+  context->callbacks.auth_fn = xb_smbc_auth;
+  orig_cache = context->callbacks.get_cached_srv_fn;
+  context->callbacks.get_cached_srv_fn = xb_smbc_cache;
+  context->options.one_share_per_server = false;
+  context->options.browse_max_lmb_count = 0;
+  context->timeout = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_sambaclienttimeout * 1000;
+  // we need to strdup these, they will get free'd on smbc_free_context
+  if (settings->GetString(CSettings::SETTING_SMB_WORKGROUP).length() > 0)
+    context->workgroup = strdup(settings->GetString(CSettings::SETTING_SMB_WORKGROUP).c_str());
+  context->user = strdup("guest");
+#endif
+
+  if (!smbc_init_context(context))
+  {
+    CLog::Log(LOGERROR, "%s - Unable to initialize a samba context", __FUNCTION__);
+    smbc_free_context(context, 1);
+    return NULL;
+  }
+
+  return context;
+}
+
+void CSMB::FreeContext(SMBCCTX* context)
+{
+  smbc_free_context(context, 1);
+}
+
+std::shared_ptr<CSMBContext> CSMB::AcquireContext(const std::string& server)
+{
+  CSingleLock lock(m_poolSection);
+
+  std::shared_ptr<CSMBContext> leastUsed;
+  int iServerContexts = 0;
+  for (const auto& context : m_contexts)
+  {
+    if (!StringUtils::EqualsNoCase(context->server, server))
+      continue;
+
+    iServerContexts++;
+    if (!leastUsed || context->users < leastUsed->users)
+      leastUsed = context;
+  }
+
+  // every file gets a connection of its own until the server has the maximum number of them
+  if (!leastUsed || (leastUsed->users > 0 && iServerContexts < MAX_CONTEXTS_PER_SERVER))
+  {
+    SMBCCTX* context = CreateContext();
+    if (context)
     {
-      smbc_free_context(m_context, 1);
-      m_context = NULL;
+      leastUsed = std::make_shared<CSMBContext>();
+      leastUsed->context = context;
+      leastUsed->server = server;
+      m_contexts.emplace_back(leastUsed);
+      CLog::Log(LOGDEBUG, "%s - Created samba context %d for server '%s'", __FUNCTION__, iServerContexts + 1, server.c_str());
     }
   }
-  m_IdleTimeout = 180;
+
+  if (leastUsed)
+    leastUsed->users++;
+
+  return leastUsed;
+}
+
+void CSMB::ReleaseContext(const std::shared_ptr<CSMBContext>& context)
+{
+  CSingleLock lock(m_poolSection);
+  context->users--;
+  context->idleTimeout = 180;
+}
+
+void CSMB::FreeUnusedContexts(bool bExpiredOnly)
+{
+  std::vector<std::shared_ptr<CSMBContext>> unused;
+  {
+    CSingleLock lock(m_poolSection);
+    for (auto it = m_contexts.begin(); it != m_contexts.end();)
+    {
+      if ((*it)->users == 0 && (!bExpiredOnly || (*it)->idleTimeout == 0))
+      {
+        unused.emplace_back(*it);
+        it = m_contexts.erase(it);
+      }
+      else
+        ++it;
+    }
+  }
+
+  // closing the connections talks to the servers, don't block the pool meanwhile
+  for (const auto& context : unused)
+  {
+    CLog::Log(LOGDEBUG, "%s - Freeing idle samba context for server '%s'", __FUNCTION__, context->server.c_str());
+    FreeContext(context->context);
+  }
 }
 
 std::string CSMB::URLEncode(const CURL &url)
@@ -277,6 +438,18 @@ std::string CSMB::URLEncode(const std::string &value)
 /* This is called from CApplication::ProcessSlow() and is used to tell if smbclient have been idle for too long */
 void CSMB::CheckIfIdle()
 {
+  /* The contexts of the pool are reaped on their own, a context not used by any file for 90 sec is freed.
+     The pool is never locked during network I/O, so this doesn't halt the mainthread either. */
+  {
+    CSingleLock lock(m_poolSection);
+    for (const auto& context : m_contexts)
+    {
+      if (context->users == 0 && context->idleTimeout > 0)
+        context->idleTimeout--;
+    }
+  }
+  FreeUnusedContexts(true);
+
 /* We check if there are open connections. This is done without a lock to not halt the mainthread. It should be thread safe as
    worst case scenario is that m_OpenConnections could read 0 and then changed to 1 if this happens it will enter the if wich will lead to another check, wich is locked.  */
   if (m_OpenConnections == 0)
@@ -325,7 +498,7 @@ CSMB smb;
 CSMBFile::CSMBFile()
 {
   smb.Init();
-  m_fd = -1;
+  m_file = NULL;
   smb.AddActiveConnection();
   m_allowRetry = true;
 }
@@ -338,15 +511,15 @@ CSMBFile::~CSMBFile()
 
 int64_t CSMBFile::GetPosition()
 {
-  if (m_fd == -1)
+  if (!m_file)
     return -1;
-  CSingleLock lock(smb);
-  return smbc_lseek(m_fd, 0, SEEK_CUR);
+  CSingleLock lock(m_context->section);
+  return SmbcLseek(m_context->context, m_file, 0, SEEK_CUR);
 }
 
 int64_t CSMBFile::GetLength()
 {
-  if (m_fd == -1)
+  if (!m_file)
     return -1;
   return m_fileSize;
 }
@@ -369,34 +542,33 @@ bool CSMBFile::Open(const CURL& url)
   // listed, which will create lot's of open sessions.
 
   std::string strFileName;
-  m_fd = OpenFile(url, strFileName);
+  m_file = OpenFile(url, strFileName);
 
-  CLog::Log(LOGDEBUG,"CSMBFile::Open - opened %s, fd=%d",url.GetRedacted().c_str(), m_fd);
-  if (m_fd == -1)
+  CLog::Log(LOGDEBUG,"CSMBFile::Open - opened %s, file=%p",url.GetRedacted().c_str(), static_cast<void*>(m_file));
+  if (!m_file)
   {
     // write error to logfile
     CLog::Log(LOGINFO, "SMBFile->Open: Unable to open file : '%s'\nunix_err:'%x' error : '%s'", CURL::GetRedacted(strFileName).c_str(), errno, strerror(errno));
     return false;
   }
 
-  CSingleLock lock(smb);
   struct stat tmpBuffer;
-  if (smbc_stat(strFileName.c_str(), &tmpBuffer) < 0)
+  int64_t ret;
   {
-    smbc_close(m_fd);
-    m_fd = -1;
-    return false;
+    CSingleLock lock(m_context->section);
+    if (SmbcFstat(m_context->context, m_file, &tmpBuffer) < 0)
+      ret = -1;
+    else
+      ret = SmbcLseek(m_context->context, m_file, 0, SEEK_SET);
   }
 
-  m_fileSize = tmpBuffer.st_size;
-
-  int64_t ret = smbc_lseek(m_fd, 0, SEEK_SET);
   if ( ret < 0 )
   {
-    smbc_close(m_fd);
-    m_fd = -1;
+    Close();
     return false;
   }
+
+  m_fileSize = tmpBuffer.st_size;
   // We've successfully opened the file!
   return true;
 }
@@ -427,23 +599,33 @@ int CSMBFile::OpenFile(std::string& strAuth)
 }
 */
 
-int CSMBFile::OpenFile(const CURL &url, std::string& strAuth)
+SMBCFILE* CSMBFile::OpenFile(const CURL &url, std::string& strAuth)
 {
-  int fd = -1;
+  SMBCFILE* file = NULL;
   smb.Init();
 
   strAuth = GetAuthenticatedPath(url);
   std::string strPath = strAuth;
 
+  // reads of files on different connections don't wait for each other
+  m_context = smb.AcquireContext(url.GetHostName());
+  if (!m_context)
+    return NULL;
+
   {
-    CSingleLock lock(smb);
-    fd = smbc_open(strPath.c_str(), O_RDONLY, 0);
+    CSingleLock lock(m_context->section);
+    file = SmbcOpen(m_context->context, strPath, O_RDONLY, 0);
   }
 
-  if (fd >= 0)
+  if (file)
     strAuth = strPath;
+  else
+  {
+    smb.ReleaseContext(m_context);
+    m_context.reset();
+  }
 
-  return fd;
+  return file;
 }
 
 bool CSMBFile::Exists(const CURL& url)
@@ -466,13 +648,13 @@ bool CSMBFile::Exists(const CURL& url)
 
 int CSMBFile::Stat(struct __stat64* buffer)
 {
-  if (m_fd == -1)
+  if (!m_file)
     return -1;
 
   struct stat tmpBuffer = {0};
 
-  CSingleLock lock(smb);
-  int iResult = smbc_fstat(m_fd, &tmpBuffer);
+  CSingleLock lock(m_context->section);
+  int iResult = SmbcFstat(m_context->context, m_file, &tmpBuffer);
   CUtil::StatToStat64(buffer, &tmpBuffer);
   return iResult;
 }
@@ -491,7 +673,7 @@ int CSMBFile::Stat(const CURL& url, struct __stat64* buffer)
 
 int CSMBFile::Truncate(int64_t size)
 {
-  if (m_fd == -1) return 0;
+  if (!m_file) return 0;
 /*
  * This would force us to be dependant on SMBv3.2 which is GPLv3
  * This is only used by the TagLib writers, which are not currently in use
@@ -513,7 +695,7 @@ ssize_t CSMBFile::Read(void *lpBuf, size_t uiBufSize)
   if (uiBufSize > SSIZE_MAX)
     uiBufSize = SSIZE_MAX;
 
-  if (m_fd == -1)
+  if (!m_file)
     return -1;
 
   // Some external libs (libass) use test read with zero size and
@@ -524,15 +706,15 @@ ssize_t CSMBFile::Read(void *lpBuf, size_t uiBufSize)
   if (uiBufSize == 0 && lpBuf == NULL)
     return 0;
 
-  CSingleLock lock(smb); // Init not called since it has to be "inited" by now
+  CSingleLock lock(m_context->section); // only files sharing the connection wait for each other
   smb.SetActivityTime();
 
-  ssize_t bytesRead = smbc_read(m_fd, lpBuf, (int)uiBufSize);
+  ssize_t bytesRead = SmbcRead(m_context->context, m_file, lpBuf, uiBufSize);
 
   if (m_allowRetry && bytesRead < 0 && errno == EINVAL )
   {
     CLog::Log(LOGERROR, "%s - Error( %" PRIdS ", %d, %s ) - Retrying", __FUNCTION__, bytesRead, errno, strerror(errno));
-    bytesRead = smbc_read(m_fd, lpBuf, (int)uiBufSize);
+    bytesRead = SmbcRead(m_context->context, m_file, lpBuf, uiBufSize);
   }
 
   if ( bytesRead < 0 )
@@ -543,11 +725,11 @@ ssize_t CSMBFile::Read(void *lpBuf, size_t uiBufSize)
 
 int64_t CSMBFile::Seek(int64_t iFilePosition, int iWhence)
 {
-  if (m_fd == -1) return -1;
+  if (!m_file) return -1;
 
-  CSingleLock lock(smb); // Init not called since it has to be "inited" by now
+  CSingleLock lock(m_context->section);
   smb.SetActivityTime();
-  int64_t pos = smbc_lseek(m_fd, iFilePosition, iWhence);
+  int64_t pos = SmbcLseek(m_context->context, m_file, iFilePosition, iWhence);
 
   if ( pos < 0 )
   {
@@ -560,23 +742,28 @@ int64_t CSMBFile::Seek(int64_t iFilePosition, int iWhence)
 
 void CSMBFile::Close()
 {
-  if (m_fd != -1)
+  if (m_file)
   {
-    CLog::Log(LOGDEBUG,"CSMBFile::Close closing fd %d", m_fd);
-    CSingleLock lock(smb);
-    smbc_close(m_fd);
+    CLog::Log(LOGDEBUG,"CSMBFile::Close closing file %p", static_cast<void*>(m_file));
+    CSingleLock lock(m_context->section);
+    SmbcClose(m_context->context, m_file);
+  }
+  m_file = NULL;
+
+  if (m_context)
+  {
+    smb.ReleaseContext(m_context);
+    m_context.reset();
   }
-  m_fd = -1;
 }
 
 ssize_t CSMBFile::Write(const void* lpBuf, size_t uiBufSize)
 {
-  if (m_fd == -1) return -1;
+  if (!m_file) return -1;
 
-  // lpBuf can be safely casted to void* since xbmc_write will only read from it.
-  CSingleLock lock(smb);
+  CSingleLock lock(m_context->section);
 
-  return  smbc_write(m_fd, lpBuf, uiBufSize);
+  return SmbcWrite(m_context->context, m_file, lpBuf, uiBufSize);
 }
 
 bool CSMBFile::Delete(const CURL& url)
@@ -619,20 +806,30 @@ bool CSMBFile::OpenForWrite(const CURL& url, bool bOverWrite)
   if (!IsValidFile(url.GetFileName())) return false;
 
   std::string strFileName = GetAuthenticatedPath(url);
-  CSingleLock lock(smb);
 
-  if (bOverWrite)
-  {
-    CLog::Log(LOGWARNING, "SMBFile::OpenForWrite() called with overwriting enabled! - %s", CURL::GetRedacted(strFileName).c_str());
-    m_fd = smbc_creat(strFileName.c_str(), 0);
-  }
-  else
+  m_context = smb.AcquireContext(url.GetHostName());
+  if (!m_context)
+    return false;
+
   {
-    m_fd = smbc_open(strFileName.c_str(), O_RDWR, 0);
+    CSingleLock lock(m_context->section);
+
+    if (bOverWrite)
+    {
+      CLog::Log(LOGWARNING, "SMBFile::OpenForWrite() called with overwriting enabled! - %s", CURL::GetRedacted(strFileName).c_str());
+      m_file = SmbcCreat(m_context->context, strFileName, 0);
+    }
+    else
+    {
+      m_file = SmbcOpen(m_context->context, strFileName, O_RDWR, 0);
+    }
   }
 
-  if (m_fd == -1)
+  if (!m_file)
   {
+    smb.ReleaseContext(m_context);
+    m_context.reset();
+
     // write error to logfile
     CLog::Log(LOGERROR, "SMBFile->Open: Unable to open file : '%s'\nunix_err:'%x' error : '%s'", CURL::GetRedacted(strFileName).c_str(), errno, strerror(errno));
     return false;
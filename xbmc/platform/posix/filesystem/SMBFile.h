@@ -19,6 +19,10 @@
 #include "filesystem/IFile.h"
 #include "threads/CriticalSection.h"
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #define NT_STATUS_CONNECTION_REFUSED long(0xC0000000 | 0x0236)
 #define NT_STATUS_INVALID_HANDLE long(0xC0000000 | 0x0008)
 #define NT_STATUS_ACCESS_DENIED long(0xC0000000 | 0x0022)
@@ -27,12 +31,27 @@
 
 struct _SMBCCTX;
 typedef _SMBCCTX SMBCCTX;
+struct _SMBCFILE;
+typedef _SMBCFILE SMBCFILE;
+
+/*!
+ \brief A libsmbclient context of the pool of CSMB, used by the files opened on one server.
+ Each context has connections of its own, files using different contexts are read concurrently.
+ */
+struct CSMBContext
+{
+  SMBCCTX* context = nullptr;
+  CCriticalSection section; ///< serializes the calls using the context
+  std::string server;
+  int users = 0;
+  unsigned int idleTimeout = 0;
+};
 
 class CSMB : public CCriticalSection
 {
 public:
   CSMB();
-  ~CSMB();
+  virtual ~CSMB();
   void Init();
   void Deinit();
   void CheckIfIdle();
@@ -42,9 +61,34 @@ public:
   std::string URLEncode(const std::string &value);
   std::string URLEncode(const CURL &url);
 
+  /*!
+   \brief Get a context of the pool for a file on a server.
+   A new context is created as long as the server has less than MAX_CONTEXTS_PER_SERVER, after
+   that the context with the least files is shared.
+   \param server The host name of the server.
+   \return The context, nullptr if it couldn't be created.
+   */
+  std::shared_ptr<CSMBContext> AcquireContext(const std::string& server);
+
+  /*!
+   \brief Give back a context obtained from AcquireContext.
+   \param context The context.
+   */
+  void ReleaseContext(const std::shared_ptr<CSMBContext>& context);
+
   DWORD ConvertUnixToNT(int error);
+
+  static const int MAX_CONTEXTS_PER_SERVER = 4;
+
+protected:
+  virtual SMBCCTX* CreateContext();
+  virtual void FreeContext(SMBCCTX* context);
+  void FreeUnusedContexts(bool bExpiredOnly);
+
 private:
   SMBCCTX *m_context;
+  CCriticalSection m_poolSection;
+  std::vector<std::shared_ptr<CSMBContext>> m_contexts;
   int m_OpenConnections;
   unsigned int m_IdleTimeout;
   static bool IsFirstInit;
@@ -58,7 +102,7 @@ class CSMBFile : public IFile
 {
 public:
   CSMBFile();
-  int OpenFile(const CURL &url, std::string& strAuth);
+  SMBCFILE* OpenFile(const CURL &url, std::string& strAuth);
   ~CSMBFile() override;
   void Close() override;
   int64_t Seek(int64_t iFilePosition, int iWhence = SEEK_SET) override;
@@ -83,7 +127,8 @@ protected:
   bool IsValidFile(const std::string& strFileName);
   std::string GetAuthenticatedPath(const CURL &url);
   int64_t m_fileSize;
-  int m_fd;
+  std::shared_ptr<CSMBContext> m_context;
+  SMBCFILE* m_file;
   bool m_allowRetry;
 };
 }
@@ -7,9 +7,17 @@
  */
 
 #include "PosixInterfaceForCLog.h"
+#include <algorithm>
+#include <errno.h>
+#include <limits.h>
 #include <stdio.h>
 #include <time.h>
 #include <sys/time.h>
+#include <sys/uio.h>
+
+#if !defined(IOV_MAX)
+#define IOV_MAX 1024
+#endif
 
 #if defined(TARGET_DARWIN)
 #include "platform/darwin/DarwinUtils.h"
@@ -71,6 +79,50 @@ bool CPosixInterfaceForCLog::WriteStringToLog(const std::string &logString)
   return ret;
 }
 
+bool CPosixInterfaceForCLog::WriteBuffersToLog(const std::vector<std::pair<const char*, size_t>>& buffers)
+{
+  if (!m_file)
+    return false;
+
+  // whatever went through the FILE so far has to be in front
+  (void)fflush(m_file);
+  const int fd = fileno(m_file);
+
+  std::vector<struct iovec> iov(buffers.size());
+  for (size_t i = 0; i < buffers.size(); i++)
+  {
+    iov[i].iov_base = const_cast<char*>(buffers[i].first);
+    iov[i].iov_len = buffers[i].second;
+  }
+
+  size_t index = 0;
+  while (index < iov.size())
+  {
+    const int count = static_cast<int>(std::min<size_t>(iov.size() - index, IOV_MAX));
+    ssize_t written = writev(fd, &iov[index], count);
+    if (written < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+
+    // a short write may end in the middle of a buffer
+    while (index < iov.size() && static_cast<size_t>(written) >= iov[index].iov_len)
+    {
+      written -= iov[index].iov_len;
+      index++;
+    }
+    if (written > 0)
+    {
+      iov[index].iov_base = static_cast<char*>(iov[index].iov_base) + written;
+      iov[index].iov_len -= written;
+    }
+  }
+
+  return true;
+}
+
 void CPosixInterfaceForCLog::PrintDebugString(const std::string &debugString)
 {
 #ifdef _DEBUG
@@ -9,6 +9,8 @@
 #pragma once
 
 #include <string>
+#include <utility>
+#include <vector>
 
 struct FILEWRAP; // forward declaration, wrapper for FILE
 
@@ -20,6 +22,7 @@ public:
   bool OpenLogFile(const std::string& logFilename, const std::string& backupOldLogToFilename);
   void CloseLogFile(void);
   bool WriteStringToLog(const std::string& logString);
+  bool WriteBuffersToLog(const std::vector<std::pair<const char*, size_t>>& buffers);
   void PrintDebugString(const std::string& debugString);
   static void GetCurrentLocalTime(int& year, int& month, int& day, int& hour, int& minute, int& second, double& millisecond);
 private:
@@ -91,6 +91,27 @@ bool CWin32InterfaceForCLog::WriteStringToLog(const std::string& logString)
   return ret;
 }
 
+bool CWin32InterfaceForCLog::WriteBuffersToLog(const std::vector<std::pair<const char*, size_t>>& buffers)
+{
+  if (m_hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  size_t size = 0;
+  for (const auto& buffer : buffers)
+    size += buffer.second;
+
+  std::string strData;
+  strData.reserve(size + size / 32);
+  for (const auto& buffer : buffers)
+    strData.append(buffer.first, buffer.second);
+  StringUtils::Replace(strData, "\n", "\r\n");
+
+  DWORD written;
+  const bool ret = (WriteFile(m_hFile, strData.c_str(), strData.length(), &written, NULL) != 0) && written == strData.length();
+
+  return ret;
+}
+
 void CWin32InterfaceForCLog::PrintDebugString(const std::string& debugString)
 {
 #ifdef _DEBUG
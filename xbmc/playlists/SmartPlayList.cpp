@@ -9,10 +9,13 @@
 #include "SmartPlayList.h"
 
 #include "Util.h"
+#include "XBDateTime.h"
 #include "dbwrappers/Database.h"
 #include "filesystem/File.h"
 #include "filesystem/SmartPlaylistDirectory.h"
 #include "guilib/LocalizeStrings.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
 #include "utils/DatabaseUtils.h"
 #include "utils/JSONVariantParser.h"
 #include "utils/JSONVariantWriter.h"
@@ -28,10 +31,19 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 using namespace XFILE;
 
+namespace
+{
+// WHERE clauses of evaluated playlists, keyed by CSmartPlaylist::GetCacheKey()
+const size_t MAX_CACHED_WHERE_CLAUSES = 256;
+CCriticalSection whereClauseCacheSection;
+std::unordered_map<std::string, std::string> whereClauseCache;
+}
+
 typedef struct
 {
   char string[17];
@@ -768,13 +780,21 @@ std::string CSmartPlaylistRule::FormatParameter(const std::string &operatorStrin
   return CDatabaseQueryRule::FormatParameter(operatorString, param, db, strType);
 }
 
-std::string CSmartPlaylistRule::FormatLinkQuery(const char *field, const char *table, const MediaType& mediaType, const std::string& mediaField, const std::string& parameter)
+std::string CSmartPlaylistRule::FormatLinkQuery(const std::string& negate, const char *field, const char *table, const MediaType& mediaType, const std::string& mediaField, const std::string& parameter)
 {
   // NOTE: no need for a PrepareSQL here, as the parameter has already been formatted
-  return StringUtils::Format(" EXISTS (SELECT 1 FROM %s_link"
+  // the subquery doesn't depend on the outer row, so it is only run once and
+  // can be answered from the (<table>_id, media_type, media_id) index of the link table
+  return StringUtils::Format("%s%sIN (SELECT %s_link.media_id FROM %s_link"
                              "         JOIN %s ON %s.%s_id=%s_link.%s_id"
-                             "         WHERE %s_link.media_id=%s AND %s.name %s AND %s_link.media_type = '%s')",
-                             field, table, table, table, field, table, field, mediaField.c_str(), table, parameter.c_str(), field, mediaType.c_str());
+                             "         WHERE %s.name %s AND %s_link.media_type = '%s')",
+                             mediaField.c_str(), negate.empty() ? " " : negate.c_str(), field, field,
+                             table, table, table, field, table, table, parameter.c_str(), field, mediaType.c_str());
+}
+
+std::string CSmartPlaylistRule::FormatInQuery(const std::string& negate, const std::string& idField, const std::string& subQuery)
+{
+  return idField + (negate.empty() ? " " : negate) + "IN (" + subQuery + ")";
 }
 
 std::string CSmartPlaylistRule::FormatWhereClause(const std::string &negate, const std::string &oper, const std::string &param,
@@ -789,32 +809,32 @@ std::string CSmartPlaylistRule::FormatWhereClause(const std::string &negate, con
     table = "songview";
 
     if (m_field == FieldGenre)
-      query = negate + " EXISTS (SELECT 1 FROM song_genre, genre WHERE song_genre.idSong = " + GetField(FieldId, strType) + " AND song_genre.idGenre = genre.idGenre AND genre.strGenre" + parameter + ")";
+      query = FormatInQuery(negate, GetField(FieldId, strType), "SELECT song_genre.idSong FROM song_genre JOIN genre ON genre.idGenre = song_genre.idGenre WHERE genre.strGenre" + parameter);
     else if (m_field == FieldArtist)
-      query = negate + " EXISTS (SELECT 1 FROM song_artist, artist WHERE song_artist.idSong = " + GetField(FieldId, strType) + " AND song_artist.idArtist = artist.idArtist AND artist.strArtist" + parameter + ")";
+      query = FormatInQuery(negate, GetField(FieldId, strType), "SELECT song_artist.idSong FROM song_artist JOIN artist ON artist.idArtist = song_artist.idArtist WHERE artist.strArtist" + parameter);
     else if (m_field == FieldAlbumArtist)
-      query = negate + " EXISTS (SELECT 1 FROM album_artist, artist WHERE album_artist.idAlbum = " + table + ".idAlbum AND album_artist.idArtist = artist.idArtist AND artist.strArtist" + parameter + ")";
+      query = FormatInQuery(negate, table + ".idAlbum", "SELECT album_artist.idAlbum FROM album_artist JOIN artist ON artist.idArtist = album_artist.idArtist WHERE artist.strArtist" + parameter);
     else if (m_field == FieldLastPlayed && (m_operator == OPERATOR_LESS_THAN || m_operator == OPERATOR_BEFORE || m_operator == OPERATOR_NOT_IN_THE_LAST))
       query = GetField(m_field, strType) + " is NULL or " + GetField(m_field, strType) + parameter;
     else if (m_field == FieldSource)
-      query = negate + " EXISTS (SELECT 1 FROM album_source, source WHERE album_source.idAlbum = " + table + ".idAlbum AND album_source.idSource = source.idSource AND source.strName" + parameter + ")";
+      query = FormatInQuery(negate, table + ".idAlbum", "SELECT album_source.idAlbum FROM album_source JOIN source ON source.idSource = album_source.idSource WHERE source.strName" + parameter);
   }
   else if (strType == "albums")
   {
     table = "albumview";
 
     if (m_field == FieldGenre)
-      query = negate + " EXISTS (SELECT 1 FROM song, song_genre, genre WHERE song.idAlbum = " + GetField(FieldId, strType) + " AND song.idSong = song_genre.idSong AND song_genre.idGenre = genre.idGenre AND genre.strGenre" + parameter + ")";
+      query = FormatInQuery(negate, GetField(FieldId, strType), "SELECT song.idAlbum FROM song_genre JOIN genre ON genre.idGenre = song_genre.idGenre JOIN song ON song.idSong = song_genre.idSong WHERE genre.strGenre" + parameter);
     else if (m_field == FieldArtist)
-      query = negate + " EXISTS (SELECT 1 FROM song, song_artist, artist WHERE song.idAlbum = " + GetField(FieldId, strType) + " AND song.idSong = song_artist.idSong AND song_artist.idArtist = artist.idArtist AND artist.strArtist" + parameter + ")";
+      query = FormatInQuery(negate, GetField(FieldId, strType), "SELECT song.idAlbum FROM song_artist JOIN artist ON artist.idArtist = song_artist.idArtist JOIN song ON song.idSong = song_artist.idSong WHERE artist.strArtist" + parameter);
     else if (m_field == FieldAlbumArtist)
-      query = negate + " EXISTS (SELECT 1 FROM album_artist, artist WHERE album_artist.idAlbum = " + GetField(FieldId, strType) + " AND album_artist.idArtist = artist.idArtist AND artist.strArtist" + parameter + ")";
+      query = FormatInQuery(negate, GetField(FieldId, strType), "SELECT album_artist.idAlbum FROM album_artist JOIN artist ON artist.idArtist = album_artist.idArtist WHERE artist.strArtist" + parameter);
     else if (m_field == FieldPath)
       query = negate + " EXISTS (SELECT 1 FROM song JOIN path on song.idpath = path.idpath WHERE song.idAlbum = " + GetField(FieldId, strType) + " AND path.strPath" + parameter + ")";
     else if (m_field == FieldLastPlayed && (m_operator == OPERATOR_LESS_THAN || m_operator == OPERATOR_BEFORE || m_operator == OPERATOR_NOT_IN_THE_LAST))
       query = GetField(m_field, strType) + " is NULL or " + GetField(m_field, strType) + parameter;
     else if (m_field == FieldSource)
-      query = negate + " EXISTS (SELECT 1 FROM album_source, source WHERE album_source.idAlbum = " + GetField(FieldId, strType) + " AND album_source.idSource = source.idSource AND source.strName" + parameter + ")";
+      query = FormatInQuery(negate, GetField(FieldId, strType), "SELECT album_source.idAlbum FROM album_source JOIN source ON source.idSource = album_source.idSource WHERE source.strName" + parameter);
   }
   else if (strType == "artists")
   {
@@ -847,51 +867,51 @@ std::string CSmartPlaylistRule::FormatWhereClause(const std::string &negate, con
     table = "movie_view";
 
     if (m_field == FieldGenre)
-      query = negate + FormatLinkQuery("genre", "genre", MediaTypeMovie, GetField(FieldId, strType), parameter);
+      query = FormatLinkQuery(negate, "genre", "genre", MediaTypeMovie, GetField(FieldId, strType), parameter);
     else if (m_field == FieldDirector)
-      query = negate + FormatLinkQuery("director", "actor", MediaTypeMovie, GetField(FieldId, strType), parameter);
+      query = FormatLinkQuery(negate, "director", "actor", MediaTypeMovie, GetField(FieldId, strType), parameter);
     else if (m_field == FieldActor)
-      query = negate + FormatLinkQuery("actor", "actor", MediaTypeMovie, GetField(FieldId, strType), parameter);
+      query = FormatLinkQuery(negate, "actor", "actor", MediaTypeMovie, GetField(FieldId, strType), parameter);
     else if (m_field == FieldWriter)
-      query = negate + FormatLinkQuery("writer", "actor", MediaTypeMovie, GetField(FieldId, strType), parameter);
+      query = FormatLinkQuery(negate, "writer", "actor", MediaTypeMovie, GetField(FieldId, strType), parameter);
     else if (m_field == FieldStudio)
-      query = negate + FormatLinkQuery("studio", "studio", MediaTypeMovie, GetField(FieldId, strType), parameter);
+      query = FormatLinkQuery(negate, "studio", "studio", MediaTypeMovie, GetField(FieldId, strType), parameter);
     else if (m_field == FieldCountry)
-      query = negate + FormatLinkQuery("country", "country", MediaTypeMovie, GetField(FieldId, strType), parameter);
+      query = FormatLinkQuery(negate, "country", "country", MediaTypeMovie, GetField(FieldId, strType), parameter);
     else if ((m_field == FieldLastPlayed || m_field == FieldDateAdded) && (m_operator == OPERATOR_LESS_THAN || m_operator == OPERATOR_BEFORE || m_operator == OPERATOR_NOT_IN_THE_LAST))
       query = GetField(m_field, strType) + " IS NULL OR " + GetField(m_field, strType) + parameter;
     else if (m_field == FieldTag)
-      query = negate + FormatLinkQuery("tag", "tag", MediaTypeMovie, GetField(FieldId, strType), parameter);
+      query = FormatLinkQuery(negate, "tag", "tag", MediaTypeMovie, GetField(FieldId, strType), parameter);
   }
   else if (strType == "musicvideos")
   {
     table = "musicvideo_view";
 
     if (m_field == FieldGenre)
-      query = negate + FormatLinkQuery("genre", "genre", MediaTypeMusicVideo, GetField(FieldId, strType), parameter);
+      query = FormatLinkQuery(negate, "genre", "genre", MediaTypeMusicVideo, GetField(FieldId, strType), parameter);
     else if (m_field == FieldArtist || m_field == FieldAlbumArtist)
-      query = negate + FormatLinkQuery("actor", "actor", MediaTypeMusicVideo, GetField(FieldId, strType), parameter);
+      query = FormatLinkQuery(negate, "actor", "actor", MediaTypeMusicVideo, GetField(FieldId, strType), parameter);
     else if (m_field == FieldStudio)
-      query = negate + FormatLinkQuery("studio", "studio", MediaTypeMusicVideo, GetField(FieldId, strType), parameter);
+      query = FormatLinkQuery(negate, "studio", "studio", MediaTypeMusicVideo, GetField(FieldId, strType), parameter);
     else if (m_field == FieldDirector)
-      query = negate + FormatLinkQuery("director", "actor", MediaTypeMusicVideo, GetField(FieldId, strType), parameter);
+      query = FormatLinkQuery(negate, "director", "actor", MediaTypeMusicVideo, GetField(FieldId, strType), parameter);
     else if ((m_field == FieldLastPlayed || m_field == FieldDateAdded) && (m_operator == OPERATOR_LESS_THAN || m_operator == OPERATOR_BEFORE || m_operator == OPERATOR_NOT_IN_THE_LAST))
       query = GetField(m_field, strType) + " IS NULL OR " + GetField(m_field, strType) + parameter;
     else if (m_field == FieldTag)
-      query = negate + FormatLinkQuery("tag", "tag", MediaTypeMusicVideo, GetField(FieldId, strType), parameter);
+      query = FormatLinkQuery(negate, "tag", "tag", MediaTypeMusicVideo, GetField(FieldId, strType), parameter);
   }
   else if (strType == "tvshows")
   {
     table = "tvshow_view";
 
     if (m_field == FieldGenre)
-      query = negate + FormatLinkQuery("genre", "genre", MediaTypeTvShow, GetField(FieldId, strType), parameter);
+      query = FormatLinkQuery(negate, "genre", "genre", MediaTypeTvShow, GetField(FieldId, strType), parameter);
     else if (m_field == FieldDirector)
-      query = negate + FormatLinkQuery("director", "actor", MediaTypeTvShow, GetField(FieldId, strType), parameter);
+      query = FormatLinkQuery(negate, "director", "actor", MediaTypeTvShow, GetField(FieldId, strType), parameter);
     else if (m_field == FieldActor)
-      query = negate + FormatLinkQuery("actor", "actor", MediaTypeTvShow, GetField(FieldId, strType), parameter);
+      query = FormatLinkQuery(negate, "actor", "actor", MediaTypeTvShow, GetField(FieldId, strType), parameter);
     else if (m_field == FieldStudio)
-      query = negate + FormatLinkQuery("studio", "studio", MediaTypeTvShow, GetField(FieldId, strType), parameter);
+      query = FormatLinkQuery(negate, "studio", "studio", MediaTypeTvShow, GetField(FieldId, strType), parameter);
     else if (m_field == FieldMPAA)
       query = negate + " (" + GetField(m_field, strType) + parameter + ")";
     else if ((m_field == FieldLastPlayed || m_field == FieldDateAdded) && (m_operator == OPERATOR_LESS_THAN || m_operator == OPERATOR_BEFORE || m_operator == OPERATOR_NOT_IN_THE_LAST))
@@ -899,26 +919,26 @@ std::string CSmartPlaylistRule::FormatWhereClause(const std::string &negate, con
     else if (m_field == FieldPlaycount)
       query = "CASE WHEN COALESCE(" + GetField(FieldNumberOfEpisodes, strType) + " - " + GetField(FieldNumberOfWatchedEpisodes, strType) + ", 0) > 0 THEN 0 ELSE 1 END " + parameter;
     else if (m_field == FieldTag)
-      query = negate + FormatLinkQuery("tag", "tag", MediaTypeTvShow, GetField(FieldId, strType), parameter);
+      query = FormatLinkQuery(negate, "tag", "tag", MediaTypeTvShow, GetField(FieldId, strType), parameter);
   }
   else if (strType == "episodes")
   {
     table = "episode_view";
 
     if (m_field == FieldGenre)
-      query = negate + FormatLinkQuery("genre", "genre", MediaTypeTvShow, (table + ".idShow").c_str(), parameter);
+      query = FormatLinkQuery(negate, "genre", "genre", MediaTypeTvShow, (table + ".idShow").c_str(), parameter);
     else if (m_field == FieldTag)
-      query = negate + FormatLinkQuery("tag", "tag", MediaTypeTvShow, (table + ".idShow").c_str(), parameter);
+      query = FormatLinkQuery(negate, "tag", "tag", MediaTypeTvShow, (table + ".idShow").c_str(), parameter);
     else if (m_field == FieldDirector)
-      query = negate + FormatLinkQuery("director", "actor", MediaTypeEpisode, GetField(FieldId, strType), parameter);
+      query = FormatLinkQuery(negate, "director", "actor", MediaTypeEpisode, GetField(FieldId, strType), parameter);
     else if (m_field == FieldActor)
-      query = negate + FormatLinkQuery("actor", "actor", MediaTypeEpisode, GetField(FieldId, strType), parameter);
+      query = FormatLinkQuery(negate, "actor", "actor", MediaTypeEpisode, GetField(FieldId, strType), parameter);
     else if (m_field == FieldWriter)
-      query = negate + FormatLinkQuery("writer", "actor", MediaTypeEpisode, GetField(FieldId, strType), parameter);
+      query = FormatLinkQuery(negate, "writer", "actor", MediaTypeEpisode, GetField(FieldId, strType), parameter);
     else if ((m_field == FieldLastPlayed || m_field == FieldDateAdded) && (m_operator == OPERATOR_LESS_THAN || m_operator == OPERATOR_BEFORE || m_operator == OPERATOR_NOT_IN_THE_LAST))
       query = GetField(m_field, strType) + " IS NULL OR " + GetField(m_field, strType) + parameter;
     else if (m_field == FieldStudio)
-      query = negate + FormatLinkQuery("studio", "studio", MediaTypeTvShow, (table + ".idShow").c_str(), parameter);
+      query = FormatLinkQuery(negate, "studio", "studio", MediaTypeTvShow, (table + ".idShow").c_str(), parameter);
     else if (m_field == FieldMPAA)
       query = negate + " (" + GetField(m_field, strType) +  parameter + ")";
   }
@@ -1026,6 +1046,36 @@ std::string CSmartPlaylistRuleCombination::GetWhereClause(const CDatabase &db, c
   return rule;
 }
 
+bool CSmartPlaylistRuleCombination::GetCacheKey(std::string& key, bool& relativeDate) const
+{
+  key += m_type == CombinationAnd ? "and(" : "or(";
+  for (const auto& it : m_combinations)
+  {
+    std::shared_ptr<CSmartPlaylistRuleCombination> combo = std::static_pointer_cast<CSmartPlaylistRuleCombination>(it);
+    if (!combo || !combo->GetCacheKey(key, relativeDate))
+      return false;
+  }
+
+  for (const auto& it : m_rules)
+  {
+    // other playlists may change on disk at any time
+    if (it->m_field == FieldPlaylist)
+      return false;
+    if (it->m_operator == CDatabaseQueryRule::OPERATOR_IN_THE_LAST ||
+        it->m_operator == CDatabaseQueryRule::OPERATOR_NOT_IN_THE_LAST)
+      relativeDate = true;
+
+    key += StringUtils::Format("%i:%i", it->m_field, static_cast<int>(it->m_operator));
+    // prefix the values with their length so that no value can fake a separator
+    for (const auto& parameter : it->m_parameter)
+      key += StringUtils::Format(",%u:", static_cast<unsigned int>(parameter.size())) + parameter;
+    key += ";";
+  }
+  key += ")";
+
+  return true;
+}
+
 void CSmartPlaylistRuleCombination::GetVirtualFolders(const std::string& strType, std::vector<std::string> &virtualFolders) const
 {
   for (CDatabaseQueryRuleCombinations::const_iterator it = m_combinations.begin(); it != m_combinations.end(); ++it)
@@ -1429,7 +1479,66 @@ bool CSmartPlaylist::IsMusicType(const std::string &type)
 
 std::string CSmartPlaylist::GetWhereClause(const CDatabase &db, std::set<std::string> &referencedPlaylists) const
 {
-  return m_ruleCombination.GetWhereClause(db, GetType(), referencedPlaylists);
+  std::string key;
+  if (!db.IsOpen() || !GetCacheKey(db, key))
+    return m_ruleCombination.GetWhereClause(db, GetType(), referencedPlaylists);
+
+  {
+    CSingleLock lock(whereClauseCacheSection);
+    auto it = whereClauseCache.find(key);
+    if (it != whereClauseCache.end())
+      return it->second;
+  }
+
+  std::string where = m_ruleCombination.GetWhereClause(db, GetType(), referencedPlaylists);
+
+  CSingleLock lock(whereClauseCacheSection);
+  if (whereClauseCache.size() >= MAX_CACHED_WHERE_CLAUSES)
+    whereClauseCache.clear();
+  whereClauseCache.emplace(key, where);
+
+  return where;
+}
+
+bool CSmartPlaylist::GetCacheKey(const CDatabase &db, std::string &key) const
+{
+  // values are escaped differently for MySQL
+  key = GetType() + (db.IsSQLite() ? "|sqlite|" : "|mysql|");
+
+  bool relativeDate = false;
+  if (!m_ruleCombination.GetCacheKey(key, relativeDate))
+    return false;
+
+  // relative dates are translated into absolute ones of the current day
+  if (relativeDate)
+    key += CDateTime::GetCurrentDateTime().GetAsDBDate();
+
+  return true;
+}
+
+void CSmartPlaylist::ClearWhereClauseCache()
+{
+  CSingleLock lock(whereClauseCacheSection);
+  whereClauseCache.clear();
+}
+
+std::string CSmartPlaylist::GetView(const std::string &type)
+{
+  if (type == "songs")
+    return "songview";
+  else if (type == "albums")
+    return "albumview";
+  else if (type == "artists")
+    return "artistview";
+  else if (type == "movies")
+    return "movie_view";
+  else if (type == "musicvideos")
+    return "musicvideo_view";
+  else if (type == "tvshows")
+    return "tvshow_view";
+  else if (type == "episodes")
+    return "episode_view";
+  return "";
 }
 
 void CSmartPlaylist::GetVirtualFolders(std::vector<std::string> &virtualFolders) const
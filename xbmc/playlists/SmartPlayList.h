@@ -66,7 +66,12 @@ protected:
 
 private:
   std::string GetVideoResolutionQuery(const std::string &parameter) const;
-  static std::string FormatLinkQuery(const char *field, const char *table, const MediaType& mediaType, const std::string& mediaField, const std::string& parameter);
+  static std::string FormatLinkQuery(const std::string& negate, const char *field, const char *table, const MediaType& mediaType, const std::string& mediaField, const std::string& parameter);
+  /*! \brief Match an id against an uncorrelated subquery.
+   Unlike a correlated EXISTS, the subquery is evaluated once and the outer
+   query is answered by looking the ids up in its result.
+   */
+  static std::string FormatInQuery(const std::string& negate, const std::string& idField, const std::string& subQuery);
 };
 
 class CSmartPlaylistRuleCombination : public CDatabaseQueryRuleCombination
@@ -82,6 +87,13 @@ public:
                          std::vector<std::string> &virtualFolders) const;
 
   void AddRule(const CSmartPlaylistRule &rule);
+
+  /*! \brief Append a key identifying the rules to the given key.
+   \param key the key to append to
+   \param relativeDate [out] set if any rule depends on the current date
+   \return false if the rules can't be cached because they reference other playlists
+   */
+  bool GetCacheKey(std::string& key, bool& relativeDate) const;
 };
 
 class CSmartPlaylist : public IDatabaseQueryRuleFactory
@@ -141,6 +153,15 @@ public:
   std::string GetWhereClause(const CDatabase &db, std::set<std::string> &referencedPlaylists) const;
   void GetVirtualFolders(std::vector<std::string> &virtualFolders) const;
 
+  /*! \brief Forget the WHERE clauses of all evaluated playlists.
+   The clause of a playlist only depends on its rules, so playlists evaluated
+   over and over again, e.g. by skin widgets, are only translated into SQL once.
+   */
+  static void ClearWhereClauseCache();
+
+  /*! \brief Get the view the WHERE clause of a playlist of the given type applies to. */
+  static std::string GetView(const std::string &type);
+
   std::string GetSaveLocation() const;
 
   static void GetAvailableFields(const std::string &type, std::vector<std::string> &fieldList);
@@ -158,6 +179,11 @@ private:
   friend class CGUIDialogSmartPlaylistEditor;
   friend class CGUIDialogMediaFilter;
 
+  /*! \brief Get the key the WHERE clause of the playlist is cached with.
+   \return false if the WHERE clause can't be cached
+   */
+  bool GetCacheKey(const CDatabase &db, std::string &key) const;
+
   const TiXmlNode* readName(const TiXmlNode *root);
   const TiXmlNode* readNameFromPath(const CURL &url);
   const TiXmlNode* readNameFromXml(const std::string &xml);
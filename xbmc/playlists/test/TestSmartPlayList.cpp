@@ -0,0 +1,191 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "dbwrappers/Database.h"
+#include "dbwrappers/dataset.h"
+#include "filesystem/SpecialProtocol.h"
+#include "playlists/SmartPlayList.h"
+#include "settings/AdvancedSettings.h"
+#include "test/TestUtils.h"
+
+#include <set>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+const int SONGS = 100000;
+const int ALBUMS = 10000;
+const int ARTISTS = 5000;
+const int GENRES = 50;
+
+/*!
+ \brief The tables of the music database smart playlists of songs are
+ evaluated against, filled with a synthetic library.
+ */
+class CSyntheticMusicDatabase : public CDatabase
+{
+public:
+  int Count(const std::string& where)
+  {
+    return std::stoi(GetSingleValue("SELECT COUNT(1) FROM songview WHERE " + where));
+  }
+
+protected:
+  void CreateTables() override
+  {
+    m_pDS->exec("CREATE TABLE artist (idArtist integer primary key, strArtist varchar(256))");
+    m_pDS->exec("CREATE TABLE album (idAlbum integer primary key, strAlbum varchar(256))");
+    m_pDS->exec("CREATE TABLE album_artist (idArtist integer, idAlbum integer, iOrder integer)");
+    m_pDS->exec("CREATE TABLE genre (idGenre integer primary key, strGenre varchar(256))");
+    m_pDS->exec("CREATE TABLE song (idSong integer primary key, idAlbum integer, strTitle varchar(512))");
+    m_pDS->exec("CREATE TABLE song_artist (idArtist integer, idSong integer, idRole integer, iOrder integer)");
+    m_pDS->exec("CREATE TABLE song_genre (idGenre integer, idSong integer, iOrder integer)");
+
+    const std::string numbers = "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %i) ";
+    m_pDS->exec(PrepareSQL(numbers + "INSERT INTO artist SELECT i, 'Artist ' || i FROM n", ARTISTS));
+    m_pDS->exec(PrepareSQL(numbers + "INSERT INTO album SELECT i, 'Album ' || i FROM n", ALBUMS));
+    m_pDS->exec(PrepareSQL(numbers + "INSERT INTO album_artist SELECT i %% %i + 1, i, 0 FROM n", ALBUMS, ARTISTS));
+    m_pDS->exec(PrepareSQL(numbers + "INSERT INTO genre SELECT i, 'Genre ' || i FROM n", GENRES));
+    m_pDS->exec(PrepareSQL(numbers + "INSERT INTO song SELECT i, i %% %i + 1, 'Song ' || i FROM n", SONGS, ALBUMS));
+    m_pDS->exec(PrepareSQL(numbers + "INSERT INTO song_artist SELECT i * 7 %% %i + 1, i, 1, 0 FROM n", SONGS, ARTISTS));
+    m_pDS->exec(PrepareSQL(numbers + "INSERT INTO song_genre SELECT i %% %i + 1, i, 0 FROM n", SONGS, GENRES));
+    // every fourth song has a second genre
+    m_pDS->exec(PrepareSQL(numbers + "INSERT INTO song_genre SELECT (i + 3) %% %i + 1, i, 1 FROM n WHERE i %% 4 = 0", SONGS, GENRES));
+  }
+
+  void CreateAnalytics() override
+  {
+    m_pDS->exec("CREATE INDEX idxArtist ON artist(strArtist)");
+    m_pDS->exec("CREATE UNIQUE INDEX idxAlbumArtist_1 ON album_artist ( idAlbum, idArtist )");
+    m_pDS->exec("CREATE UNIQUE INDEX idxAlbumArtist_2 ON album_artist ( idArtist, idAlbum )");
+    m_pDS->exec("CREATE INDEX idxGenre ON genre(strGenre)");
+    m_pDS->exec("CREATE INDEX idxSong3 ON song(idAlbum)");
+    m_pDS->exec("CREATE UNIQUE INDEX idxSongArtist_1 ON song_artist ( idSong, idArtist, idRole )");
+    m_pDS->exec("CREATE INDEX idxSongArtist_3 ON song_artist ( idArtist, idRole )");
+    m_pDS->exec("CREATE UNIQUE INDEX idxSongGenre_1 ON song_genre ( idSong, idGenre )");
+    m_pDS->exec("CREATE UNIQUE INDEX idxSongGenre_2 ON song_genre ( idGenre, idSong )");
+    m_pDS->exec("CREATE VIEW songview AS SELECT song.idSong, song.idAlbum, song.strTitle FROM song");
+  }
+
+  int GetSchemaVersion() const override { return 1; }
+  const char* GetBaseDBName() const override { return "SmartPlaylistTest"; }
+};
+
+// the rules as they were translated before they were rewritten into
+// uncorrelated subqueries
+const std::string legacyGenre =
+  "EXISTS (SELECT 1 FROM song_genre, genre WHERE song_genre.idSong = songview.idSong AND "
+  "song_genre.idGenre = genre.idGenre AND genre.strGenre LIKE 'Genre 7')";
+const std::string legacyArtist =
+  "EXISTS (SELECT 1 FROM song_artist, artist WHERE song_artist.idSong = songview.idSong AND "
+  "song_artist.idArtist = artist.idArtist AND artist.strArtist LIKE '%Artist 12%')";
+const std::string legacyAlbumArtist =
+  "NOT EXISTS (SELECT 1 FROM album_artist, artist WHERE album_artist.idAlbum = songview.idAlbum AND "
+  "album_artist.idArtist = artist.idArtist AND artist.strArtist LIKE 'Artist 3')";
+
+const std::string playlistJson =
+  "{\"type\":\"songs\",\"rules\":{\"or\":["
+  "{\"and\":["
+  "{\"field\":\"genre\",\"operator\":\"is\",\"value\":[\"Genre 7\"]},"
+  "{\"field\":\"albumartist\",\"operator\":\"isnot\",\"value\":[\"Artist 3\"]}]},"
+  "{\"field\":\"artist\",\"operator\":\"contains\",\"value\":[\"Artist 12\"]}]}}";
+}
+
+class TestSmartPlayList : public ::testing::Test
+{
+protected:
+  DatabaseSettings settings;
+  CSyntheticMusicDatabase database;
+
+  void SetUp() override
+  {
+    settings.type = "sqlite3";
+    settings.name = "smartplaylist";
+    settings.host = CSpecialProtocol::TranslatePath("special://temp/");
+
+    ASSERT_TRUE(database.Connect("smartplaylist", settings, true));
+    CSmartPlaylist::ClearWhereClauseCache();
+  }
+
+  void TearDown() override
+  {
+    database.Close();
+  }
+};
+
+TEST_F(TestSmartPlayList, RewrittenRulesMatchCorrelatedSubqueries)
+{
+  CSmartPlaylist playlist;
+  ASSERT_TRUE(playlist.LoadFromJson(playlistJson));
+
+  std::set<std::string> playlists;
+  const std::string where = playlist.GetWhereClause(database, playlists);
+  EXPECT_EQ(std::string::npos, where.find("EXISTS"));
+
+  const int expected = database.Count("(" + legacyGenre + " AND " + legacyAlbumArtist + ") OR " + legacyArtist);
+  EXPECT_LT(0, expected);
+  EXPECT_EQ(expected, database.Count(where));
+}
+
+TEST_F(TestSmartPlayList, CachedWhereClause)
+{
+  CSmartPlaylist playlist;
+  ASSERT_TRUE(playlist.LoadFromJson(playlistJson));
+
+  std::set<std::string> playlists;
+  const std::string where = playlist.GetWhereClause(database, playlists);
+  EXPECT_EQ(where, playlist.GetWhereClause(database, playlists));
+
+  // a playlist with different values must not get the cached clause
+  CSmartPlaylist other;
+  ASSERT_TRUE(other.LoadFromJson("{\"type\":\"songs\",\"rules\":{\"and\":["
+                                 "{\"field\":\"genre\",\"operator\":\"is\",\"value\":[\"Genre 8\"]}]}}"));
+  const std::string otherWhere = other.GetWhereClause(database, playlists);
+  EXPECT_NE(where, otherWhere);
+  EXPECT_NE(std::string::npos, otherWhere.find("Genre 8"));
+
+  // nor one of a different type
+  other.SetType("albums");
+  EXPECT_NE(std::string::npos, other.GetWhereClause(database, playlists).find("albumview"));
+}
+
+TEST_F(TestSmartPlayList, Benchmark)
+{
+  CSmartPlaylist playlist;
+  ASSERT_TRUE(playlist.LoadFromJson(playlistJson));
+
+  const int iterations = 1000;
+  std::set<std::string> playlists;
+
+  CTestStopwatch stopwatch;
+  for (int i = 0; i < iterations; i++)
+  {
+    CSmartPlaylist::ClearWhereClauseCache();
+    playlist.GetWhereClause(database, playlists);
+  }
+  const int64_t uncachedTime = stopwatch.Lap();
+
+  std::string where;
+  for (int i = 0; i < iterations; i++)
+    where = playlist.GetWhereClause(database, playlists);
+  const int64_t cachedTime = stopwatch.Lap();
+
+  const int legacyCount = database.Count("(" + legacyGenre + " AND " + legacyAlbumArtist + ") OR " + legacyArtist);
+  const int64_t legacyQueryTime = stopwatch.Lap();
+
+  const int count = database.Count(where);
+  const int64_t queryTime = stopwatch.Lap();
+
+  EXPECT_EQ(legacyCount, count);
+  RecordProperty("translate_us", static_cast<int>(uncachedTime));
+  RecordProperty("translate_cached_us", static_cast<int>(cachedTime));
+  RecordProperty("query_correlated_us", static_cast<int>(legacyQueryTime));
+  RecordProperty("query_us", static_cast<int>(queryTime));
+}
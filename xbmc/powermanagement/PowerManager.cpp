@@ -19,6 +19,7 @@
 #include "guilib/LocalizeStrings.h"
 #include "interfaces/AnnouncementManager.h"
 #include "interfaces/builtins/Builtins.h"
+#include "network/DNSNameCache.h"
 #include "network/Network.h"
 #include "pvr/PVRManager.h"
 #include "settings/Settings.h"
@@ -211,6 +212,8 @@ void CPowerManager::OnWake()
 #endif
 
   CServiceBroker::GetActiveAE()->Resume();
+  // the network may have changed while sleeping
+  CDNSNameCache::Clear();
   g_application.UpdateLibraries();
   CServiceBroker::GetWeatherManager().Refresh();
   CServiceBroker::GetPVRManager().OnWake();
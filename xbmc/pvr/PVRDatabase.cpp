@@ -26,6 +26,7 @@
 #include <cstdlib>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -349,6 +350,7 @@ int CPVRDatabase::Get(CPVRChannelGroup& results, bool bCompressDB)
                                                                  CPVRChannelNumber(static_cast<unsigned int>(m_pDS->fv("iClientChannelNumber").get_asInt()),
                                                                                    static_cast<unsigned int>(m_pDS->fv("iClientSubChannelNumber").get_asInt()))
         );
+        newMember->persistedData = newMember->GetData(results.GroupID());
         results.m_sortedMembers.emplace_back(newMember);
         results.m_members.insert(std::make_pair(channel->StorageId(), newMember));
 
@@ -508,10 +510,14 @@ bool CPVRDatabase::RemoveStaleChannelsFromGroup(const CPVRChannelGroup& group)
     std::vector<int> currentMembers;
     if (GetCurrentGroupMembers(group, currentMembers))
     {
+      std::set<int> groupMembers;
+      for (const auto& groupMember : group.m_members)
+        groupMembers.insert(groupMember.second->channel->ChannelID());
+
       std::vector<int> channelsToDelete;
       for (int iChannelId : currentMembers)
       {
-        if (!group.IsGroupMember(iChannelId))
+        if (groupMembers.find(iChannelId) == groupMembers.end())
         {
           int iClientId = GetClientIdByChannelId(iChannelId);
           if (iClientId == PVR_INVALID_CLIENT_ID || !group.IsMissingChannelsFromClient(iClientId))
@@ -659,6 +665,7 @@ int CPVRDatabase::Get(CPVRChannelGroup& group, const CPVRChannelGroup& allGroup)
                                                                    0, static_cast<int>(m_pDS->fv("iOrder").get_asInt()),
                                                                    CPVRChannelNumber(static_cast<unsigned int>(m_pDS->fv("iClientChannelNumber").get_asInt()),
                                                                                      static_cast<unsigned int>(m_pDS->fv("iClientSubChannelNumber").get_asInt())));
+          newMember->persistedData = newMember->GetData(group.GroupID());
 
           group.m_sortedMembers.emplace_back(newMember);
           group.m_members.insert(std::make_pair(channel->second->StorageId(), newMember));
@@ -719,7 +726,11 @@ bool CPVRDatabase::PersistChannels(CPVRChannelGroup& group)
     std::string strValue;
     for (const auto& groupMember : group.m_members)
     {
+      /* only new channels got an id assigned */
       channel = groupMember.second->channel;
+      if (channel->ChannelID() > 0)
+        continue;
+
       strQuery = PrepareSQL("iUniqueId = %u AND iClientId = %u", channel->UniqueID(), channel->ClientID());
       strValue = GetSingleValue("channels", "idChannel", strQuery);
       if (!strValue.empty() && StringUtils::IsInteger(strValue))
@@ -739,26 +750,41 @@ bool CPVRDatabase::PersistGroupMembers(const CPVRChannelGroup& group)
 
   if (group.HasChannels())
   {
+    /* only write the members that differ from what's stored, all in one transaction */
+    std::vector<std::pair<std::shared_ptr<PVRChannelGroupMember>, PVRChannelGroupMember::Data>> changedMembers;
     for (const auto& groupMember : group.m_sortedMembers)
     {
-      const std::string strWhereClause = PrepareSQL("idChannel = %u AND idGroup = %u AND iChannelNumber = %u AND iSubChannelNumber = %u AND iOrder = %u AND iClientChannelNumber = %u AND iClientSubChannelNumber = %u",
-          groupMember->channel->ChannelID(), group.GroupID(), groupMember->channelNumber.GetChannelNumber(), groupMember->channelNumber.GetSubChannelNumber(), groupMember->iOrder,
-          groupMember->clientChannelNumber.GetChannelNumber(), groupMember->clientChannelNumber.GetSubChannelNumber());
+      const PVRChannelGroupMember::Data data = groupMember->GetData(group.GroupID());
+      if (data != groupMember->persistedData)
+        changedMembers.emplace_back(groupMember, data);
+    }
 
-      const std::string strValue = GetSingleValue("map_channelgroups_channels", "idChannel", strWhereClause);
-      if (strValue.empty())
-      {
-        strQuery = PrepareSQL("REPLACE INTO map_channelgroups_channels ("
-            "idGroup, idChannel, iChannelNumber, iSubChannelNumber, iOrder, iClientChannelNumber, iClientSubChannelNumber) "
-            "VALUES (%i, %i, %i, %i, %i, %i, %i);",
-            group.GroupID(), groupMember->channel->ChannelID(), groupMember->channelNumber.GetChannelNumber(), groupMember->channelNumber.GetSubChannelNumber(), groupMember->iOrder,
-            groupMember->clientChannelNumber.GetChannelNumber(), groupMember->clientChannelNumber.GetSubChannelNumber());
-        QueueInsertQuery(strQuery);
-      }
+    BeginMultipleExecute();
+
+    for (const auto& changedMember : changedMembers)
+    {
+      const std::shared_ptr<PVRChannelGroupMember>& groupMember = changedMember.first;
+      strQuery = PrepareSQL("REPLACE INTO map_channelgroups_channels ("
+          "idGroup, idChannel, iChannelNumber, iSubChannelNumber, iOrder, iClientChannelNumber, iClientSubChannelNumber) "
+          "VALUES (%i, %i, %i, %i, %i, %i, %i);",
+          group.GroupID(), groupMember->channel->ChannelID(), groupMember->channelNumber.GetChannelNumber(), groupMember->channelNumber.GetSubChannelNumber(), groupMember->iOrder,
+          groupMember->clientChannelNumber.GetChannelNumber(), groupMember->clientChannelNumber.GetSubChannelNumber());
+      ExecuteQuery(strQuery);
     }
 
-    bReturn = CommitInsertQueries();
+    /* the deletes of stale members are queued as well */
     bRemoveChannels = RemoveStaleChannelsFromGroup(group);
+    bReturn = CommitMultipleExecute();
+
+    if (bReturn)
+    {
+      for (const auto& changedMember : changedMembers)
+        changedMember.first->persistedData = changedMember.second;
+    }
+
+    CLog::LogFC(LOGDEBUG, LOGPVR, "Persisted %d of %d members of channel group '%s'",
+                static_cast<int>(changedMembers.size()), static_cast<int>(group.m_sortedMembers.size()),
+                group.GroupName().c_str());
   }
 
   return bReturn && bRemoveChannels;
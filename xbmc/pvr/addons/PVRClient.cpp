@@ -18,6 +18,7 @@
 #include "pvr/PVRDatabase.h"
 #include "pvr/PVRManager.h"
 #include "pvr/PVRStreamProperties.h"
+#include "pvr/addons/PVRClientFanOut.h"
 #include "pvr/addons/PVRClientMenuHooks.h"
 #include "pvr/addons/PVRClients.h"
 #include "pvr/channels/PVRChannel.h"
@@ -35,9 +36,11 @@
 #include "pvr/timers/PVRTimers.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/SettingsComponent.h"
+#include "threads/SystemClock.h"
 #include "utils/StringUtils.h"
 #include "utils/log.h"
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <string>
@@ -54,6 +57,7 @@ namespace PVR
 {
 
 #define DEFAULT_INFO_STRING_VALUE "unknown"
+#define ADDON_CALLS_TIMEOUT_MS 30000
 
 CPVRClient::CPVRClient(const AddonInfoPtr& addonInfo)
   : CAddonDll(addonInfo, ADDON_PVRDLL)
@@ -173,10 +177,18 @@ bool CPVRClient::DllLoaded(void) const
 
 void CPVRClient::Destroy(void)
 {
-  if (!m_bReadyToUse)
-    return;
+  {
+    CSingleLock lock(m_addonCallsSection);
+    if (!m_bReadyToUse)
+      return;
 
-  m_bReadyToUse = false;
+    m_bReadyToUse = false;
+
+    /* the add-on must not be unloaded while a call is still running inside of it. A call that
+       doesn't return at all would block the shutdown forever though, so it is unloaded anyway. */
+    if (!WaitForAddonCalls(lock))
+      CLog::LogF(LOGERROR, "Destroying PVR add-on instance '%s' with calls in progress", GetFriendlyName().c_str());
+  }
 
   /* reset 'ready to use' to false */
   CLog::LogFC(LOGDEBUG, LOGPVR, "Destroying PVR add-on instance '%s'", GetFriendlyName().c_str());
@@ -193,8 +205,11 @@ void CPVRClient::Destroy(void)
 
 void CPVRClient::Stop()
 {
+  CSingleLock lock(m_addonCallsSection);
   m_bBlockAddonCalls = true;
   m_bPriorityFetched = false;
+
+  WaitForAddonCalls(lock);
 }
 
 void CPVRClient::Continue()
@@ -1165,15 +1180,27 @@ PVR_ERROR CPVRClient::DoAddonCall(const char* strFunctionName, std::function<PVR
   if (!bIsImplemented)
     return PVR_ERROR_NOT_IMPLEMENTED;
 
-  if (m_bBlockAddonCalls)
-    return PVR_ERROR_SERVER_ERROR;
+  {
+    CSingleLock lock(m_addonCallsSection);
+
+    if (m_bBlockAddonCalls)
+      return PVR_ERROR_SERVER_ERROR;
+
+    if (!m_bReadyToUse && bCheckReadyToUse)
+      return PVR_ERROR_SERVER_ERROR;
 
-  if (!m_bReadyToUse && bCheckReadyToUse)
-    return PVR_ERROR_SERVER_ERROR;
+    m_iAddonCalls++;
+  }
 
   // Call.
   const PVR_ERROR error = function(&m_struct.toAddon);
 
+  {
+    CSingleLock lock(m_addonCallsSection);
+    if (--m_iAddonCalls == 0)
+      m_addonCallsDone.notifyAll();
+  }
+
   // Log error, if any.
   if (error != PVR_ERROR_NO_ERROR && error != PVR_ERROR_NOT_IMPLEMENTED)
     CLog::LogFunction(LOGERROR, strFunctionName, "Add-on '%s' returned an error: %s", GetFriendlyName().c_str(), ToString(error));
@@ -1181,6 +1208,31 @@ PVR_ERROR CPVRClient::DoAddonCall(const char* strFunctionName, std::function<PVR
   return error;
 }
 
+bool CPVRClient::WaitForAddonCalls(CSingleLock& lock) const
+{
+  if (m_iAddonCalls == 0)
+    return true;
+
+  CLog::LogF(LOGINFO, "Waiting for %u call(s) in progress of PVR add-on instance '%s'", m_iAddonCalls, GetFriendlyName().c_str());
+
+  const XbmcThreads::EndTime timeout(ADDON_CALLS_TIMEOUT_MS);
+  while (m_iAddonCalls > 0)
+  {
+    if (timeout.IsTimePast())
+    {
+      CLog::LogF(LOGERROR, "Gave up waiting for %u call(s) in progress of PVR add-on instance '%s' after %u ms", m_iAddonCalls, GetFriendlyName().c_str(), ADDON_CALLS_TIMEOUT_MS);
+      return false;
+    }
+
+    m_addonCallsDone.wait(lock, std::min(1000u, timeout.MillisLeft()));
+    if (m_iAddonCalls > 0)
+      CLog::LogFC(LOGDEBUG, LOGPVR, "Still waiting for %u call(s) in progress of PVR add-on instance '%s'", m_iAddonCalls, GetFriendlyName().c_str());
+  }
+
+  CLog::LogF(LOGINFO, "Calls in progress of PVR add-on instance '%s' returned after %u ms", GetFriendlyName().c_str(), ADDON_CALLS_TIMEOUT_MS - timeout.MillisLeft());
+  return true;
+}
+
 bool CPVRClient::CanPlayChannel(const std::shared_ptr<CPVRChannel>& channel) const
 {
   return (m_bReadyToUse &&
@@ -1466,8 +1518,11 @@ void CPVRClient::cb_transfer_channel_group(void* kodiInstance, const ADDON_HANDL
   }
 
   /* transfer this entry to the groups container */
-  CPVRChannelGroup transferGroup(*group, kodiGroups->GetGroupAll());
-  kodiGroups->UpdateFromClient(transferGroup);
+  const PVR_CHANNEL_GROUP groupData = *group;
+  CPVRClientFanOut::Transfer([kodiGroups, groupData]() {
+    CPVRChannelGroup transferGroup(groupData, kodiGroups->GetGroupAll());
+    kodiGroups->UpdateFromClient(transferGroup);
+  });
 }
 
 void CPVRClient::cb_transfer_channel_group_member(void* kodiInstance, const ADDON_HANDLE handle, const PVR_CHANNEL_GROUP_MEMBER* member)
@@ -1486,16 +1541,20 @@ void CPVRClient::cb_transfer_channel_group_member(void* kodiInstance, const ADDO
     return;
   }
 
-  std::shared_ptr<CPVRChannel> channel = CServiceBroker::GetPVRManager().ChannelGroups()->GetByUniqueID(member->iChannelUniqueId, client->GetID());
-  if (!channel)
-  {
-    CLog::LogF(LOGERROR, "Cannot find group '%s' or channel '%d'", member->strGroupName, member->iChannelUniqueId);
-  }
-  else if (group->IsRadio() == channel->IsRadio())
-  {
-    /* transfer this entry to the group */
-    group->AddToGroup(channel, CPVRChannelNumber(), member->iOrder, true, CPVRChannelNumber(member->iChannelNumber, member->iSubChannelNumber));
-  }
+  const PVR_CHANNEL_GROUP_MEMBER memberData = *member;
+  const int iClientId = client->GetID();
+  CPVRClientFanOut::Transfer([group, memberData, iClientId]() {
+    std::shared_ptr<CPVRChannel> channel = CServiceBroker::GetPVRManager().ChannelGroups()->GetByUniqueID(memberData.iChannelUniqueId, iClientId);
+    if (!channel)
+    {
+      CLog::LogF(LOGERROR, "Cannot find group '%s' or channel '%d'", memberData.strGroupName, memberData.iChannelUniqueId);
+    }
+    else if (group->IsRadio() == channel->IsRadio())
+    {
+      /* transfer this entry to the group */
+      group->AddToGroup(channel, CPVRChannelNumber(), memberData.iOrder, true, CPVRChannelNumber(memberData.iChannelNumber, memberData.iSubChannelNumber));
+    }
+  });
 }
 
 void CPVRClient::cb_transfer_epg_entry(void* kodiInstance, const ADDON_HANDLE handle, const EPG_TAG* epgentry)
@@ -1536,7 +1595,10 @@ void CPVRClient::cb_transfer_channel_entry(void* kodiInstance, const ADDON_HANDL
 
   /* transfer this entry to the internal channels group */
   std::shared_ptr<CPVRChannel> transferChannel(new CPVRChannel(*channel, client->GetID()));
-  kodiChannels->UpdateFromClient(transferChannel, CPVRChannelNumber(), channel->iOrder, transferChannel->ClientChannelNumber());
+  const int iOrder = channel->iOrder;
+  CPVRClientFanOut::Transfer([kodiChannels, transferChannel, iOrder]() {
+    kodiChannels->UpdateFromClient(transferChannel, CPVRChannelNumber(), iOrder, transferChannel->ClientChannelNumber());
+  });
 }
 
 void CPVRClient::cb_transfer_recording_entry(void* kodiInstance, const ADDON_HANDLE handle, const PVR_RECORDING* recording)
@@ -1557,7 +1619,9 @@ void CPVRClient::cb_transfer_recording_entry(void* kodiInstance, const ADDON_HAN
 
   /* transfer this entry to the recordings container */
   std::shared_ptr<CPVRRecording> transferRecording(new CPVRRecording(*recording, client->GetID()));
-  kodiRecordings->UpdateFromClient(transferRecording);
+  CPVRClientFanOut::Transfer([kodiRecordings, transferRecording]() {
+    kodiRecordings->UpdateFromClient(transferRecording);
+  });
 }
 
 void CPVRClient::cb_transfer_timer_entry(void* kodiInstance, const ADDON_HANDLE handle, const PVR_TIMER* timer)
@@ -1581,7 +1645,9 @@ void CPVRClient::cb_transfer_timer_entry(void* kodiInstance, const ADDON_HANDLE
 
   /* transfer this entry to the timers container */
   std::shared_ptr<CPVRTimerInfoTag> transferTimer(new CPVRTimerInfoTag(*timer, channel, client->GetID()));
-  kodiTimers->UpdateFromClient(transferTimer);
+  CPVRClientFanOut::Transfer([kodiTimers, transferTimer]() {
+    kodiTimers->UpdateFromClient(transferTimer);
+  });
 }
 
 void CPVRClient::cb_add_menu_hook(void* kodiInstance, PVR_MENUHOOK* hook)
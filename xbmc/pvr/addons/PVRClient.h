@@ -10,6 +10,7 @@
 
 #include "addons/binary-addons/AddonDll.h"
 #include "addons/kodi-addon-dev-kit/include/kodi/xbmc_pvr_types.h"
+#include "threads/Condition.h"
 
 #include <atomic>
 #include <functional>
@@ -965,6 +966,13 @@ namespace PVR
                           bool bIsImplemented = true,
                           bool bCheckReadyToUse = true) const;
 
+    /*!
+     * @brief Wait until no add-on call is in progress any longer, e.g. one of a fan-out which timed out.
+     * @param lock The lock held on m_addonCallsSection.
+     * @return True if all calls returned, false if they didn't within ADDON_CALLS_TIMEOUT_MS.
+     */
+    bool WaitForAddonCalls(CSingleLock& lock) const;
+
     /*!
      * @brief Callback functions from addon to kodi
      */
@@ -1131,6 +1139,10 @@ namespace PVR
 
     mutable CCriticalSection m_critSection;
 
+    mutable CCriticalSection m_addonCallsSection; /*!< guards the add-on calls in progress */
+    mutable XbmcThreads::ConditionVariable m_addonCallsDone; /*!< signalled when the last add-on call in progress returned */
+    mutable unsigned int m_iAddonCalls = 0; /*!< the number of add-on calls in progress */
+
     AddonInstance_PVR m_struct;
   };
 }
@@ -0,0 +1,177 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "PVRClientFanOut.h"
+
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/Job.h"
+#include "utils/JobManager.h"
+#include "utils/log.h"
+
+#include <set>
+
+using namespace PVR;
+
+namespace
+{
+  // the transfers held back for the call run by this thread, if any
+  thread_local std::vector<std::function<void()>>* g_transfers = nullptr;
+
+  CCriticalSection& BusyClientsSection()
+  {
+    static CCriticalSection section;
+    return section;
+  }
+
+  // clients with a call still running after it timed out
+  std::set<int>& BusyClients()
+  {
+    static std::set<int> clients;
+    return clients;
+  }
+} // unnamed namespace
+
+struct CPVRClientFanOut::CallState
+{
+  CEvent done{true};
+  PVR_ERROR error = PVR_ERROR_UNKNOWN;
+  std::vector<std::function<void()>> transfers;
+};
+
+class CPVRClientFanOut::CCallJob : public CJob
+{
+public:
+  CCallJob(const std::shared_ptr<CallState>& state, const ClientCall& call, int iClientId)
+  : m_state(state), m_call(call), m_iClientId(iClientId)
+  {
+  }
+
+  ~CCallJob() override
+  {
+    // a job cancelled before it ran, e.g. on shutdown, must not leave the client busy
+    if (!m_bFinished)
+      Finish(PVR_ERROR_SERVER_ERROR);
+  }
+
+  const char* GetType() const override { return "pvr-client-call"; }
+
+  bool DoWork() override
+  {
+    g_transfers = &m_state->transfers;
+    const PVR_ERROR error = m_call();
+    g_transfers = nullptr;
+
+    Finish(error);
+    return true;
+  }
+
+private:
+  void Finish(PVR_ERROR error)
+  {
+    m_bFinished = true;
+
+    {
+      CSingleLock lock(BusyClientsSection());
+      BusyClients().erase(m_iClientId);
+    }
+
+    m_state->error = error;
+    m_state->done.Set();
+  }
+
+  const std::shared_ptr<CallState> m_state;
+  const ClientCall m_call;
+  const int m_iClientId;
+  bool m_bFinished = false;
+};
+
+CPVRClientFanOut::CPVRClientFanOut(unsigned int iTimeoutMs)
+: m_iTimeoutMs(iTimeoutMs)
+{
+}
+
+void CPVRClientFanOut::Add(int iClientId, const ClientCall& call)
+{
+  m_calls[iClientId] = call;
+}
+
+void CPVRClientFanOut::Transfer(const std::function<void()>& transfer)
+{
+  if (g_transfers)
+    g_transfers->emplace_back(transfer);
+  else
+    transfer();
+}
+
+std::vector<CPVRClientFanOut::Result> CPVRClientFanOut::Run()
+{
+  std::vector<Result> results;
+  std::vector<std::shared_ptr<CallState>> states;
+  results.reserve(m_calls.size());
+  states.reserve(m_calls.size());
+
+  for (const auto& call : m_calls)
+  {
+    const int iClientId = call.first;
+    results.push_back({iClientId, PVR_ERROR_NO_ERROR, false, false});
+
+    {
+      CSingleLock lock(BusyClientsSection());
+      if (!BusyClients().insert(iClientId).second)
+      {
+        results.back().error = PVR_ERROR_SERVER_TIMEOUT;
+        results.back().bBusy = true;
+        states.emplace_back();
+        continue;
+      }
+    }
+
+    const std::shared_ptr<CallState> state = std::make_shared<CallState>();
+    states.emplace_back(state);
+
+    CCallJob* job = new CCallJob(state, call.second, iClientId);
+    if (CJobManager::GetInstance().AddJob(job, nullptr, CJob::PRIORITY_DEDICATED) == 0)
+    {
+      CLog::LogF(LOGWARNING, "Unable to queue the call of client %d, calling it directly", iClientId);
+      job->DoWork();
+      delete job;
+    }
+  }
+
+  XbmcThreads::EndTime timeout;
+  if (m_iTimeoutMs == 0)
+    timeout.SetInfinite();
+  else
+    timeout.Set(m_iTimeoutMs);
+
+  // apply the transfers in order of the clients, while the later ones may still be busy
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    const std::shared_ptr<CallState>& state = states[i];
+    if (!state)
+      continue;
+
+    if (!state->done.WaitMSec(timeout.MillisLeft()))
+    {
+      results[i].error = PVR_ERROR_SERVER_TIMEOUT;
+      results[i].bTimedOut = true;
+      continue;
+    }
+
+    for (const auto& transfer : state->transfers)
+      transfer();
+
+    results[i].error = state->error;
+  }
+
+  m_calls.clear();
+  return results;
+}
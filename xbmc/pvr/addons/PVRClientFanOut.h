@@ -0,0 +1,80 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "addons/kodi-addon-dev-kit/include/kodi/xbmc_pvr_types.h"
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace PVR
+{
+  /*!
+   * @brief Calls several PVR clients concurrently, each in a dedicated job of the job manager.
+   *
+   * The data a client transfers to Kodi during its call is held back and applied on the calling
+   * thread once the call completed, client after client in order of their ids. The result is
+   * thus the same as calling the clients one after the other.
+   *
+   * A client not completing its call in time is reported as timed out and the data it transfers
+   * is dropped. A client still busy with a call that timed out before isn't called again.
+   */
+  class CPVRClientFanOut
+  {
+  public:
+    typedef std::function<PVR_ERROR()> ClientCall;
+
+    struct Result
+    {
+      int iClientId;
+      PVR_ERROR error;
+      bool bTimedOut;
+      bool bBusy;
+    };
+
+    /*!
+     * @brief Create a fan-out.
+     * @param iTimeoutMs The time the clients have to complete their calls, 0 to wait forever.
+     */
+    explicit CPVRClientFanOut(unsigned int iTimeoutMs);
+
+    /*!
+     * @brief Add the call of a client.
+     * @param iClientId The id of the client.
+     * @param call The call.
+     */
+    void Add(int iClientId, const ClientCall& call);
+
+    /*!
+     * @brief Run the calls and apply the transferred data.
+     * @return The results of the calls, in order of the client ids.
+     */
+    std::vector<Result> Run();
+
+    /*!
+     * @brief Transfer data from a client to Kodi.
+     * @param transfer The function storing the data. It's called right away, unless the calling
+     * thread runs the call of a fan-out. Then it's called once the call completed.
+     */
+    static void Transfer(const std::function<void()>& transfer);
+
+  private:
+    CPVRClientFanOut(const CPVRClientFanOut&) = delete;
+    CPVRClientFanOut& operator=(const CPVRClientFanOut&) = delete;
+
+    struct CallState;
+    class CCallJob;
+
+    unsigned int m_iTimeoutMs;
+    std::map<int, ClientCall> m_calls;
+  };
+}
@@ -16,7 +16,10 @@
 #include "pvr/PVRManager.h"
 #include "pvr/PVRPlaybackState.h"
 #include "pvr/addons/PVRClient.h"
+#include "pvr/addons/PVRClientFanOut.h"
 #include "pvr/channels/PVRChannelGroupInternal.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/SettingsComponent.h"
 #include "utils/JobManager.h"
 #include "utils/log.h"
 
@@ -470,7 +473,7 @@ std::vector<SBackend> CPVRClients::GetBackendProperties() const
 
 bool CPVRClients::GetTimers(CPVRTimersContainer* timers, std::vector<int>& failedClients)
 {
-  return ForCreatedClients(__FUNCTION__, [timers](const std::shared_ptr<CPVRClient>& client) {
+  return ForCreatedClientsConcurrently(__FUNCTION__, [timers](const std::shared_ptr<CPVRClient>& client) {
     return client->GetTimers(timers);
   }, failedClients) == PVR_ERROR_NO_ERROR;
 }
@@ -488,9 +491,10 @@ PVR_ERROR CPVRClients::GetTimerTypes(std::vector<std::shared_ptr<CPVRTimerType>>
 
 PVR_ERROR CPVRClients::GetRecordings(CPVRRecordings* recordings, bool deleted)
 {
-  return ForCreatedClients(__FUNCTION__, [recordings, deleted](const std::shared_ptr<CPVRClient>& client) {
+  std::vector<int> failedClients;
+  return ForCreatedClientsConcurrently(__FUNCTION__, [recordings, deleted](const std::shared_ptr<CPVRClient>& client) {
     return client->GetRecordings(recordings, deleted);
-  });
+  }, failedClients);
 }
 
 PVR_ERROR CPVRClients::DeleteAllRecordingsFromTrash()
@@ -509,21 +513,21 @@ PVR_ERROR CPVRClients::SetEPGTimeFrame(int iDays)
 
 PVR_ERROR CPVRClients::GetChannels(CPVRChannelGroupInternal* group, std::vector<int>& failedClients)
 {
-  return ForCreatedClients(__FUNCTION__, [group](const std::shared_ptr<CPVRClient>& client) {
+  return ForCreatedClientsConcurrently(__FUNCTION__, [group](const std::shared_ptr<CPVRClient>& client) {
     return client->GetChannels(*group, group->IsRadio());
   }, failedClients);
 }
 
 PVR_ERROR CPVRClients::GetChannelGroups(CPVRChannelGroups* groups, std::vector<int>& failedClients)
 {
-  return ForCreatedClients(__FUNCTION__, [groups](const std::shared_ptr<CPVRClient>& client) {
+  return ForCreatedClientsConcurrently(__FUNCTION__, [groups](const std::shared_ptr<CPVRClient>& client) {
     return client->GetChannelGroups(groups);
   }, failedClients);
 }
 
 PVR_ERROR CPVRClients::GetChannelGroupMembers(CPVRChannelGroup* group, std::vector<int>& failedClients)
 {
-  return ForCreatedClients(__FUNCTION__, [group](const std::shared_ptr<CPVRClient>& client) {
+  return ForCreatedClientsConcurrently(__FUNCTION__, [group](const std::shared_ptr<CPVRClient>& client) {
     return client->GetChannelGroupMembers(group);
   }, failedClients);
 }
@@ -685,3 +689,39 @@ PVR_ERROR CPVRClients::ForCreatedClients(const char* strFunctionName, PVRClientF
   }
   return lastError;
 }
+
+PVR_ERROR CPVRClients::ForCreatedClientsConcurrently(const char* strFunctionName, PVRClientFunction function, std::vector<int>& failedClients) const
+{
+  PVR_ERROR lastError = PVR_ERROR_NO_ERROR;
+
+  CPVRClientMap clients;
+  GetCreatedClients(clients, failedClients);
+
+  CPVRClientFanOut fanOut(CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_iPVRClientTimeout);
+  for (const auto& clientEntry : clients)
+  {
+    const std::shared_ptr<CPVRClient> client = clientEntry.second;
+    fanOut.Add(clientEntry.first, [function, client]() { return function(client); });
+  }
+
+  for (const auto& result : fanOut.Run())
+  {
+    if (result.error != PVR_ERROR_NO_ERROR && result.error != PVR_ERROR_NOT_IMPLEMENTED)
+    {
+      const std::shared_ptr<CPVRClient>& client = clients[result.iClientId];
+      if (result.bTimedOut)
+        CLog::LogFunction(LOGERROR, strFunctionName,
+                          "PVR client '%s' did not respond in time", client->GetFriendlyName().c_str());
+      else if (result.bBusy)
+        CLog::LogFunction(LOGERROR, strFunctionName,
+                          "PVR client '%s' is still busy with a call that timed out", client->GetFriendlyName().c_str());
+      else
+        CLog::LogFunction(LOGERROR, strFunctionName,
+                          "PVR client '%s' returned an error: %s",
+                          client->GetFriendlyName().c_str(), CPVRClient::ToString(result.error));
+      lastError = result.error;
+      failedClients.emplace_back(result.iClientId);
+    }
+  }
+  return lastError;
+}
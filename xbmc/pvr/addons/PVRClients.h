@@ -356,6 +356,16 @@ namespace PVR
      */
     PVR_ERROR ForCreatedClients(const char* strFunctionName, PVRClientFunction function, std::vector<int>& failedClients) const;
 
+    /*!
+     * @brief Wraps calls to all created clients, calling the clients concurrently. The data transferred by the clients is
+     * applied in order of the clients once their calls completed, clients not completing their calls in time fail.
+     * @param strFunctionName The function name, for logging purposes.
+     * @param function The function to wrap. It has to have return type PVR_ERROR and must take a const reference to a std::shared_ptr<CPVRClient> as parameter.
+     * @param failedClients Contains a list of the ids of clients for that the call failed, if any.
+     * @return PVR_ERROR_NO_ERROR on success, any other PVR_ERROR_* value otherwise.
+     */
+    PVR_ERROR ForCreatedClientsConcurrently(const char* strFunctionName, PVRClientFunction function, std::vector<int>& failedClients) const;
+
     mutable CCriticalSection m_critSection;
     CPVRClientMap m_clientMap;
   };
@@ -0,0 +1,150 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "pvr/addons/PVRClientFanOut.h"
+#include "test/TestUtils.h"
+#include "threads/Event.h"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace PVR;
+
+namespace
+{
+typedef std::vector<int> Results;
+
+// a client transferring a few entries to Kodi with a delay between them, as a backend would
+CPVRClientFanOut::ClientCall StubClient(const std::shared_ptr<Results>& results,
+                                        int iClientId,
+                                        unsigned int iDelayMs,
+                                        PVR_ERROR error = PVR_ERROR_NO_ERROR,
+                                        const std::shared_ptr<CEvent>& done = nullptr)
+{
+  return [results, iClientId, iDelayMs, error, done]()
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(iDelayMs / 3));
+      const int iEntry = iClientId * 10 + i;
+      // the results aren't synchronized, transfers must be applied by the calling thread
+      CPVRClientFanOut::Transfer([results, iEntry]() { results->emplace_back(iEntry); });
+    }
+    if (done)
+      done->Set();
+    return error;
+  };
+}
+} // unnamed namespace
+
+TEST(TestPVRClientFanOut, ConcurrentCallsApplyInClientOrder)
+{
+  const std::shared_ptr<Results> results = std::make_shared<Results>();
+
+  CPVRClientFanOut fanOut(0);
+  // added in reverse and with the first clients being the slowest
+  fanOut.Add(4, StubClient(results, 4, 60));
+  fanOut.Add(3, StubClient(results, 3, 120));
+  fanOut.Add(2, StubClient(results, 2, 180));
+  fanOut.Add(1, StubClient(results, 1, 240));
+
+  CTestStopwatch stopwatch;
+  const std::vector<CPVRClientFanOut::Result> clients = fanOut.Run();
+  const int64_t duration = stopwatch.Lap();
+
+  // the calls overlap, it takes about as long as the slowest client and not the sum of all
+  EXPECT_LT(duration, (60 + 120 + 180 + 240) * 1000);
+
+  ASSERT_EQ(4u, clients.size());
+  for (size_t i = 0; i < clients.size(); ++i)
+  {
+    EXPECT_EQ(static_cast<int>(i + 1), clients[i].iClientId);
+    EXPECT_EQ(PVR_ERROR_NO_ERROR, clients[i].error);
+    EXPECT_FALSE(clients[i].bTimedOut);
+  }
+
+  const Results expected = {10, 11, 12, 20, 21, 22, 30, 31, 32, 40, 41, 42};
+  EXPECT_EQ(expected, *results);
+}
+
+TEST(TestPVRClientFanOut, FailedClientsAreIsolated)
+{
+  const std::shared_ptr<Results> results = std::make_shared<Results>();
+  const std::shared_ptr<CEvent> slowDone = std::make_shared<CEvent>(true);
+
+  CPVRClientFanOut fanOut(300);
+  fanOut.Add(11, StubClient(results, 11, 30));
+  fanOut.Add(12, StubClient(results, 12, 3000, PVR_ERROR_NO_ERROR, slowDone));
+  fanOut.Add(13, StubClient(results, 13, 30, PVR_ERROR_SERVER_ERROR));
+
+  std::vector<CPVRClientFanOut::Result> clients = fanOut.Run();
+  ASSERT_EQ(3u, clients.size());
+  EXPECT_EQ(PVR_ERROR_NO_ERROR, clients[0].error);
+  EXPECT_EQ(PVR_ERROR_SERVER_TIMEOUT, clients[1].error);
+  EXPECT_TRUE(clients[1].bTimedOut);
+  EXPECT_EQ(PVR_ERROR_SERVER_ERROR, clients[2].error);
+  EXPECT_FALSE(clients[2].bTimedOut);
+
+  // the data of a client that timed out is dropped, the data of a client that failed is kept
+  const Results expected = {110, 111, 112, 130, 131, 132};
+  EXPECT_EQ(expected, *results);
+
+  // a client still busy isn't called again
+  fanOut.Add(12, StubClient(results, 12, 0));
+  clients = fanOut.Run();
+  ASSERT_EQ(1u, clients.size());
+  EXPECT_TRUE(clients[0].bBusy);
+  EXPECT_EQ(expected, *results);
+
+  // until it's done
+  ASSERT_TRUE(slowDone->WaitMSec(10000));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  fanOut.Add(12, StubClient(results, 12, 0));
+  clients = fanOut.Run();
+  ASSERT_EQ(1u, clients.size());
+  EXPECT_FALSE(clients[0].bBusy);
+  EXPECT_EQ(PVR_ERROR_NO_ERROR, clients[0].error);
+  EXPECT_EQ(9u, results->size());
+}
+
+TEST(TestPVRClientFanOut, TransferOutsideOfFanOut)
+{
+  int iTransfers = 0;
+  CPVRClientFanOut::Transfer([&iTransfers]() { iTransfers++; });
+  EXPECT_EQ(1, iTransfers);
+}
+
+TEST(TestPVRClientFanOut, Benchmark)
+{
+  // two tuners, an IPTV source and a recording server
+  const unsigned int delays[] = {150, 150, 300, 90};
+
+  const std::shared_ptr<Results> serialResults = std::make_shared<Results>();
+  CTestStopwatch stopwatch;
+  for (int i = 0; i < 4; ++i)
+    StubClient(serialResults, i + 21, delays[i])();
+  const int64_t serialTime = stopwatch.Lap();
+
+  const std::shared_ptr<Results> results = std::make_shared<Results>();
+  CPVRClientFanOut fanOut(0);
+  for (int i = 0; i < 4; ++i)
+    fanOut.Add(i + 21, StubClient(results, i + 21, delays[i]));
+  stopwatch.Lap();
+  fanOut.Run();
+  const int64_t concurrentTime = stopwatch.Lap();
+
+  EXPECT_EQ(*serialResults, *results);
+  EXPECT_LT(concurrentTime, serialTime);
+
+  RecordProperty("serial_us", static_cast<int>(serialTime));
+  RecordProperty("concurrent_us", static_cast<int>(concurrentTime));
+}
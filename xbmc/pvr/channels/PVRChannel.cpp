@@ -122,6 +122,13 @@ bool CPVRChannel::Delete(void)
 
 std::shared_ptr<CPVREpg> CPVRChannel::GetEPG(void) const
 {
+  {
+    // a hidden channel or one with its epg disabled has none, don't create it just to drop it
+    CSingleLock lock(m_critSection);
+    if (m_bIsHidden || !m_bEPGEnabled)
+      return {};
+  }
+
   const_cast<CPVRChannel*>(this)->CreateEPG();
 
   CSingleLock lock(m_critSection);
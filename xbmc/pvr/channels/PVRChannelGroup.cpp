@@ -25,6 +25,7 @@
 #include "settings/SettingsComponent.h"
 #include "settings/lib/Setting.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "utils/StringUtils.h"
 #include "utils/log.h"
 
@@ -36,6 +37,17 @@
 
 using namespace PVR;
 
+PVRChannelGroupMember::Data PVRChannelGroupMember::GetData(int iGroupId) const
+{
+  Data data;
+  data.iGroupId = iGroupId;
+  data.iChannelId = channel ? channel->ChannelID() : -1;
+  data.channelNumber = channelNumber;
+  data.clientChannelNumber = clientChannelNumber;
+  data.iOrder = iOrder;
+  return data;
+}
+
 CPVRChannelGroup::CPVRChannelGroup(const CPVRChannelsPath& path,
                                    int iGroupId /* = INVALID_GROUP_ID */,
                                    const std::shared_ptr<CPVRChannelGroup>& allChannelsGroup /* = {} */)
@@ -204,6 +216,21 @@ struct sortByChannelNumber
   }
 };
 
+namespace
+{
+  template<typename Compare>
+  void SortMembers(std::vector<std::shared_ptr<PVRChannelGroupMember>>& members, Compare compare)
+  {
+    // the members are usually sorted already, except for the few ones appended since the last sort
+    const auto unsorted = std::is_sorted_until(members.begin(), members.end(), compare);
+    if (unsorted == members.end())
+      return;
+
+    std::sort(unsorted, members.end(), compare);
+    std::inplace_merge(members.begin(), unsorted, members.end(), compare);
+  }
+} // unnamed namespace
+
 void CPVRChannelGroup::Sort()
 {
   if (m_bUsingBackendChannelOrder)
@@ -228,23 +255,25 @@ void CPVRChannelGroup::SortByClientChannelNumber(void)
 {
   CSingleLock lock(m_critSection);
   if (!PreventSortAndRenumber())
-    sort(m_sortedMembers.begin(), m_sortedMembers.end(), sortByClientChannelNumber());
+    SortMembers(m_sortedMembers, sortByClientChannelNumber());
 }
 
 void CPVRChannelGroup::SortByChannelNumber(void)
 {
   CSingleLock lock(m_critSection);
   if (!PreventSortAndRenumber())
-    sort(m_sortedMembers.begin(), m_sortedMembers.end(), sortByChannelNumber());
+    SortMembers(m_sortedMembers, sortByChannelNumber());
 }
 
 bool CPVRChannelGroup::UpdateClientPriorities()
 {
-  const std::shared_ptr<CPVRClients> clients = CServiceBroker::GetPVRManager().Clients();
   bool bChanged = false;
 
   CSingleLock lock(m_critSection);
 
+  // the clients are only needed for the backend channel order
+  const std::shared_ptr<CPVRClients> clients = m_bUsingBackendChannelOrder ? CServiceBroker::GetPVRManager().Clients() : nullptr;
+
   for (auto& member : m_sortedMembers)
   {
     int iNewPriority = 0;
@@ -563,26 +592,27 @@ std::vector<std::shared_ptr<CPVRChannel>> CPVRChannelGroup::RemoveDeletedChannel
   std::vector<std::shared_ptr<CPVRChannel>> removedChannels;
   CSingleLock lock(m_critSection);
 
-  /* check for deleted channels */
-  for (std::vector<std::shared_ptr<PVRChannelGroupMember>>::iterator it = m_sortedMembers.begin(); it != m_sortedMembers.end();)
+  /* check for deleted channels, removing them from the sorted members in a single pass */
+  const auto it = std::remove_if(m_sortedMembers.begin(), m_sortedMembers.end(),
+                                 [this, &channels, &removedChannels](const std::shared_ptr<PVRChannelGroupMember>& member)
   {
-    const std::shared_ptr<CPVRChannel> channel = (*it)->channel;
-    if (channels.m_members.find(channel->StorageId()) == channels.m_members.end())
-    {
-      /* channel was not found */
-      CLog::Log(LOGINFO,"Deleted %s channel '%s' from group '%s'",
-                IsRadio() ? "radio" : "TV", channel->ChannelName().c_str(), GroupName().c_str());
+    const std::shared_ptr<CPVRChannel>& channel = member->channel;
+    if (channels.m_members.find(channel->StorageId()) != channels.m_members.end())
+      return false;
 
-      removedChannels.emplace_back(channel);
+    /* channel was not found */
+    CLog::Log(LOGINFO,"Deleted %s channel '%s' from group '%s'",
+              IsRadio() ? "radio" : "TV", channel->ChannelName().c_str(), GroupName().c_str());
 
-      m_members.erase(channel->StorageId());
-      it = m_sortedMembers.erase(it);
-      m_bChanged = true;
-    }
-    else
-    {
-      ++it;
-    }
+    removedChannels.emplace_back(channel);
+    m_members.erase(channel->StorageId());
+    return true;
+  });
+
+  if (it != m_sortedMembers.end())
+  {
+    m_sortedMembers.erase(it, m_sortedMembers.end());
+    m_bChanged = true;
   }
 
   return removedChannels;
@@ -594,7 +624,11 @@ bool CPVRChannelGroup::UpdateGroupEntries(const CPVRChannelGroup& channels, std:
   bool bChanged(false);
   bool bRemoved(false);
 
+  const unsigned int iStart = XbmcThreads::SystemClockMillis();
+
   CSingleLock lock(m_critSection);
+  const size_t iMembersBefore = m_members.size();
+
   /* sort by client channel number if this is the first time or if SETTING_PVRMANAGER_BACKENDCHANNELORDER is true */
   bool bUseBackendChannelNumbers(m_members.empty() || m_bUsingBackendChannelOrder);
 
@@ -606,12 +640,23 @@ bool CPVRChannelGroup::UpdateGroupEntries(const CPVRChannelGroup& channels, std:
 
   bChanged |= UpdateClientPriorities();
 
+  SyncStats stats;
+  stats.iRemovedMembers = channelsToRemove.size();
+  stats.iAddedMembers = m_members.size() + stats.iRemovedMembers - iMembersBefore;
+
   if (bChanged)
   {
     /* renumber to make sure all channels have a channel number.
        new channels were added at the back, so they'll get the highest numbers */
     bool bRenumbered = SortAndRenumber();
 
+    /* only the members differing from what's stored will be written to the database */
+    for (const auto& member : m_sortedMembers)
+    {
+      if (member->IsPersisted() && member->persistedData != member->GetData(m_iGroupId))
+        stats.iChangedMembers++;
+    }
+
     m_bChanged = true;
     bReturn = Persist();
 
@@ -622,6 +667,13 @@ bool CPVRChannelGroup::UpdateGroupEntries(const CPVRChannelGroup& channels, std:
     bReturn = true;
   }
 
+  stats.iDurationMs = XbmcThreads::SystemClockMillis() - iStart;
+  m_lastSyncStats = stats;
+
+  CLog::LogFC(LOGDEBUG, LOGPVR, "Updated group '%s' with %d channels in %u ms: %u added, %u changed, %u removed",
+              GroupName().c_str(), static_cast<int>(m_members.size()), stats.iDurationMs,
+              stats.iAddedMembers, stats.iChangedMembers, stats.iRemovedMembers);
+
   return bReturn;
 }
 
@@ -712,7 +764,6 @@ bool CPVRChannelGroup::IsGroupMember(int iChannelId) const
 bool CPVRChannelGroup::Persist(void)
 {
   bool bReturn(true);
-  const std::shared_ptr<CPVRDatabase> database(CServiceBroker::GetPVRManager().GetTVDatabase());
 
   CSingleLock lock(m_critSection);
 
@@ -720,6 +771,8 @@ bool CPVRChannelGroup::Persist(void)
   if (!HasChanges() || (!m_bLoaded && m_iGroupId != INVALID_GROUP_ID))
     return bReturn;
 
+  const std::shared_ptr<CPVRDatabase> database(CServiceBroker::GetPVRManager().GetTVDatabase());
+
   // Mark newly created groups as loaded so future updates will also be persisted...
   if (m_iGroupId == INVALID_GROUP_ID)
     m_bLoaded = true;
@@ -832,6 +885,12 @@ bool CPVRChannelGroup::HasChanges(void) const
   return m_bChanged || HasNewChannels() || HasChangedChannels();
 }
 
+CPVRChannelGroup::SyncStats CPVRChannelGroup::GetLastSyncStats() const
+{
+  CSingleLock lock(m_critSection);
+  return m_lastSyncStats;
+}
+
 void CPVRChannelGroup::OnSettingChanged(std::shared_ptr<const CSetting> setting)
 {
   if (setting == NULL)
@@ -21,6 +21,7 @@
 #include <vector>
 
 struct PVR_CHANNEL_GROUP;
+class TestPVRChannelGroup;
 
 namespace PVR
 {
@@ -44,11 +45,44 @@ namespace PVR
       , iClientPriority(_iClientPriority)
       , iOrder(_iOrder) {}
 
+    /*!
+     * @brief The values of a member stored in the database.
+     */
+    struct Data
+    {
+      int iGroupId = -1; // -1 if the member is not stored
+      int iChannelId = -1;
+      CPVRChannelNumber channelNumber;
+      CPVRChannelNumber clientChannelNumber;
+      int iOrder = 0;
+
+      bool operator==(const Data& right) const
+      {
+        return iGroupId == right.iGroupId && iChannelId == right.iChannelId &&
+               channelNumber == right.channelNumber && clientChannelNumber == right.clientChannelNumber &&
+               iOrder == right.iOrder;
+      }
+      bool operator!=(const Data& right) const { return !(*this == right); }
+    };
+
+    /*!
+     * @brief Get the values of this member to be stored in the database.
+     * @param iGroupId The id of the group this member belongs to.
+     * @return The values.
+     */
+    Data GetData(int iGroupId) const;
+
+    /*!
+     * @return True if the member was read from or written to the database, false otherwise.
+     */
+    bool IsPersisted() const { return persistedData.iGroupId != -1; }
+
     std::shared_ptr<CPVRChannel> channel;
     CPVRChannelNumber channelNumber; // the channel number this channel has in the group
     CPVRChannelNumber clientChannelNumber; // the client channel number this channel has in the group
     int iClientPriority = 0;
     int iOrder = 0; // The value denoting the order of this member in the group
+    Data persistedData; // the values last read from or written to the database
   };
 
   enum EpgDateType
@@ -61,6 +95,7 @@ namespace PVR
   {
     friend class CPVRChannelGroupInternal;
     friend class CPVRDatabase;
+    friend class ::TestPVRChannelGroup;
 
   public:
     static const int INVALID_GROUP_ID = -1;
@@ -371,6 +406,22 @@ namespace PVR
      */
     bool HasChanges(void) const;
 
+    /*!
+     * @brief The outcome of the last update of this group from the clients.
+     */
+    struct SyncStats
+    {
+      unsigned int iAddedMembers = 0; /*!< the amount of members added */
+      unsigned int iChangedMembers = 0; /*!< the amount of members changed, e.g. renumbered */
+      unsigned int iRemovedMembers = 0; /*!< the amount of members removed */
+      unsigned int iDurationMs = 0; /*!< the time it took to update and persist the group */
+    };
+
+    /*!
+     * @return The outcome of the last update of this group from the clients.
+     */
+    SyncStats GetLastSyncStats() const;
+
     /*!
      * @brief Create an EPG table for each channel.
      * @brief bForce Create the tables, even if they already have been created before.
@@ -556,6 +607,7 @@ namespace PVR
     CEventSource<PVREvent> m_events;
     bool m_bIsSelectedGroup = false; /*!< Whether or not this group is currently selected */
     bool m_bStartGroupChannelNumbersFromOne = false; /*!< true if we start group channel numbers from one when not using backend channel numbers, false otherwise */
+    SyncStats m_lastSyncStats; /*!< the outcome of the last update of this group from the clients */
 
   private:
     CDateTime GetEPGDate(EpgDateType epgDateType) const;
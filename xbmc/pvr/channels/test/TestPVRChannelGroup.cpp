@@ -0,0 +1,329 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "DatabaseManager.h"
+#include "ServiceBroker.h"
+#include "addons/kodi-addon-dev-kit/include/kodi/xbmc_pvr_types.h"
+#include "pvr/PVRDatabase.h"
+#include "pvr/channels/PVRChannel.h"
+#include "pvr/channels/PVRChannelGroup.h"
+#include "pvr/channels/PVRChannelsPath.h"
+#include "utils/StringUtils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace PVR;
+
+namespace
+{
+const int CLIENT_ID = 999;
+const int GROUP_ID = 1000;
+const int CHANNELS = 100;
+
+std::shared_ptr<CPVRChannel> CreateChannel(int iUniqueId)
+{
+  PVR_CHANNEL data = {};
+  data.iUniqueId = iUniqueId;
+  data.iChannelNumber = iUniqueId;
+  strncpy(data.strChannelName, StringUtils::Format("Channel %d", iUniqueId).c_str(), sizeof(data.strChannelName) - 1);
+
+  // the channel id is left unset, setting it would create the epg through the pvr manager
+  return std::make_shared<CPVRChannel>(data, CLIENT_ID);
+}
+
+/*!
+ \brief The pvr database with the channels 1 to CHANNELS of a client, all of
+ them members of the group GROUP_ID with their unique id as channel number
+ and order.
+ */
+class CPVRTestDatabase : public CPVRDatabase
+{
+public:
+  bool Fill()
+  {
+    const std::string numbers = "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %i) ";
+    return ExecuteQuery(PrepareSQL(numbers + "INSERT INTO channels (idChannel, iUniqueId, bIsRadio, bIsHidden, bIsUserSetIcon, "
+                                   "bIsUserSetName, bIsLocked, sIconPath, sChannelName, bIsVirtual, bEPGEnabled, sEPGScraper, "
+                                   "iLastWatched, iClientId, idEpg, bHasArchive) "
+                                   "SELECT i, i, 0, 0, 0, 0, 0, '', 'Channel ' || i, 0, 1, 'client', 0, %i, 0, 0 FROM n",
+                                   CHANNELS, CLIENT_ID)) &&
+           ExecuteQuery(PrepareSQL(numbers + "INSERT INTO map_channelgroups_channels (idGroup, idChannel, iChannelNumber, "
+                                   "iSubChannelNumber, iOrder, iClientChannelNumber, iClientSubChannelNumber) "
+                                   "SELECT %i, i, i, 0, i, i, 0 FROM n", CHANNELS, GROUP_ID));
+  }
+
+  void Empty()
+  {
+    ExecuteQuery(PrepareSQL("DELETE FROM map_channelgroups_channels WHERE idGroup = %i", GROUP_ID));
+    ExecuteQuery(PrepareSQL("DELETE FROM channelgroups WHERE idGroup = %i", GROUP_ID));
+    ExecuteQuery(PrepareSQL("DELETE FROM channels WHERE iClientId = %i", CLIENT_ID));
+  }
+
+  std::string GetMemberValue(int iChannelId, const std::string& strColumn)
+  {
+    return GetSingleValue("map_channelgroups_channels", strColumn,
+                          PrepareSQL("idGroup = %i AND idChannel = %i", GROUP_ID, iChannelId));
+  }
+
+  bool SetMemberValue(int iChannelId, const std::string& strColumn, int iValue)
+  {
+    return ExecuteQuery(PrepareSQL("UPDATE map_channelgroups_channels SET %s = %i WHERE idGroup = %i AND idChannel = %i",
+                                   strColumn.c_str(), iValue, GROUP_ID, iChannelId));
+  }
+
+  int GetMemberCount()
+  {
+    return std::stoi(GetSingleValue(PrepareSQL("SELECT COUNT(1) FROM map_channelgroups_channels WHERE idGroup = %i", GROUP_ID)));
+  }
+};
+
+int GetUniqueID(const std::shared_ptr<PVRChannelGroupMember>& member)
+{
+  return member->channel->UniqueID();
+}
+} // unnamed namespace
+
+class TestPVRChannelGroup : public ::testing::Test
+{
+protected:
+  static void AddMember(CPVRChannelGroup& group, const std::shared_ptr<CPVRChannel>& channel,
+                        const CPVRChannelNumber& channelNumber, int iOrder)
+  {
+    const auto member = std::make_shared<PVRChannelGroupMember>(channel, channelNumber, 0, iOrder, channelNumber);
+    group.m_sortedMembers.emplace_back(member);
+    group.m_members.insert(std::make_pair(channel->StorageId(), member));
+  }
+
+  static void RemoveMember(CPVRChannelGroup& group, int iUniqueId)
+  {
+    group.m_members.erase(std::make_pair(CLIENT_ID, iUniqueId));
+    group.m_sortedMembers.erase(std::remove_if(group.m_sortedMembers.begin(), group.m_sortedMembers.end(),
+                                               [iUniqueId](const std::shared_ptr<PVRChannelGroupMember>& member)
+                                               {
+                                                 return GetUniqueID(member) == iUniqueId;
+                                               }),
+                                group.m_sortedMembers.end());
+  }
+
+  static std::vector<std::shared_ptr<PVRChannelGroupMember>>& Members(CPVRChannelGroup& group)
+  {
+    return group.m_sortedMembers;
+  }
+
+  static std::shared_ptr<PVRChannelGroupMember>& Member(CPVRChannelGroup& group, int iUniqueId)
+  {
+    return group.GetByUniqueID(std::make_pair(CLIENT_ID, iUniqueId));
+  }
+
+  static void SortByChannelNumber(CPVRChannelGroup& group) { group.SortByChannelNumber(); }
+  static void SortByClientChannelNumber(CPVRChannelGroup& group) { group.SortByClientChannelNumber(); }
+
+  static bool UpdateGroupEntries(CPVRChannelGroup& group, const CPVRChannelGroup& channels,
+                                 std::vector<std::shared_ptr<CPVRChannel>>& channelsToRemove)
+  {
+    return group.UpdateGroupEntries(channels, channelsToRemove);
+  }
+};
+
+TEST_F(TestPVRChannelGroup, SortByChannelNumberMergesAppendedMembers)
+{
+  CPVRChannelGroup group(CPVRChannelsPath(false, "Sort"));
+  for (int i = 1; i <= 1000; ++i)
+    AddMember(group, CreateChannel(i), CPVRChannelNumber(i * 2, 0), i);
+
+  // a sorted group is left alone
+  const std::vector<std::shared_ptr<PVRChannelGroupMember>> sorted = Members(group);
+  SortByChannelNumber(group);
+  EXPECT_EQ(sorted, Members(group));
+
+  // members appended since the last sort
+  AddMember(group, CreateChannel(1001), CPVRChannelNumber(3000, 0), 1001);
+  AddMember(group, CreateChannel(1002), CPVRChannelNumber(501, 0), 1002);
+  AddMember(group, CreateChannel(1003), CPVRChannelNumber(1, 0), 1003);
+  AddMember(group, CreateChannel(1004), CPVRChannelNumber(500, 1), 1004);
+  const std::set<std::shared_ptr<PVRChannelGroupMember>> members(Members(group).begin(), Members(group).end());
+
+  SortByChannelNumber(group);
+
+  const std::vector<std::shared_ptr<PVRChannelGroupMember>>& result = Members(group);
+  ASSERT_EQ(1004u, result.size());
+  EXPECT_EQ(members, std::set<std::shared_ptr<PVRChannelGroupMember>>(result.begin(), result.end()));
+  EXPECT_TRUE(std::is_sorted(result.begin(), result.end(),
+                             [](const std::shared_ptr<PVRChannelGroupMember>& member1,
+                                const std::shared_ptr<PVRChannelGroupMember>& member2)
+                             {
+                               return member1->channelNumber < member2->channelNumber;
+                             }));
+  EXPECT_EQ(1003, GetUniqueID(result.front()));
+  EXPECT_EQ(250, GetUniqueID(result[250]));
+  EXPECT_EQ(1004, GetUniqueID(result[251]));
+  EXPECT_EQ(1002, GetUniqueID(result[252]));
+  EXPECT_EQ(1001, GetUniqueID(result.back()));
+}
+
+TEST_F(TestPVRChannelGroup, SortByClientChannelNumberMergesAppendedMembers)
+{
+  CPVRChannelGroup group(CPVRChannelsPath(false, "Sort"));
+  for (int i = 1; i <= 100; ++i)
+    AddMember(group, CreateChannel(i), CPVRChannelNumber(i, 0), i);
+
+  const std::vector<std::shared_ptr<PVRChannelGroupMember>> sorted = Members(group);
+  SortByClientChannelNumber(group);
+  EXPECT_EQ(sorted, Members(group));
+
+  // members with the same client channel number are sorted by name, "Channel 101" before "Channel 50"
+  AddMember(group, CreateChannel(101), CPVRChannelNumber(50, 0), 101);
+  AddMember(group, CreateChannel(102), CPVRChannelNumber(0, 1), 102);
+
+  SortByClientChannelNumber(group);
+
+  const std::vector<std::shared_ptr<PVRChannelGroupMember>>& result = Members(group);
+  ASSERT_EQ(102u, result.size());
+  EXPECT_EQ(102, GetUniqueID(result.front()));
+  EXPECT_EQ(49, GetUniqueID(result[49]));
+  EXPECT_EQ(101, GetUniqueID(result[50]));
+  EXPECT_EQ(50, GetUniqueID(result[51]));
+  EXPECT_EQ(100, GetUniqueID(result.back()));
+}
+
+TEST_F(TestPVRChannelGroup, SyncStatsCountMemberChanges)
+{
+  const auto allChannels = std::make_shared<CPVRChannelGroup>(CPVRChannelsPath(false, "All channels"), 1);
+  allChannels->SetGroupType(PVR_GROUP_TYPE_INTERNAL);
+  std::vector<std::shared_ptr<CPVRChannel>> channels;
+  for (int i = 1; i <= 12; ++i)
+  {
+    channels.emplace_back(CreateChannel(i));
+    AddMember(*allChannels, channels.back(), CPVRChannelNumber(i, 0), i);
+  }
+
+  // the group as stored with the first ten channels. it isn't loaded, so it won't be written
+  CPVRChannelGroup group(CPVRChannelsPath(false, "Group"), GROUP_ID, allChannels);
+  for (int i = 1; i <= 10; ++i)
+    AddMember(group, channels[i - 1], CPVRChannelNumber(i, 0), i);
+  for (const auto& member : Members(group))
+    member->persistedData = member->GetData(GROUP_ID);
+
+  // the client dropped the channels 9 and 10, added 11 and 12 and moved channel 3 to the back
+  CPVRChannelGroup clientGroup(CPVRChannelsPath(false, "Group"), CPVRChannelGroup::INVALID_GROUP_ID, allChannels);
+  for (int i : {1, 2, 3, 4, 5, 6, 7, 8, 11, 12})
+    AddMember(clientGroup, channels[i - 1], CPVRChannelNumber(i, 0), i == 3 ? 30 : i);
+
+  std::vector<std::shared_ptr<CPVRChannel>> channelsToRemove;
+  EXPECT_TRUE(UpdateGroupEntries(group, clientGroup, channelsToRemove));
+  EXPECT_EQ(2u, channelsToRemove.size());
+  EXPECT_EQ(10u, Members(group).size());
+
+  CPVRChannelGroup::SyncStats stats = group.GetLastSyncStats();
+  EXPECT_EQ(2u, stats.iAddedMembers);
+  EXPECT_EQ(1u, stats.iChangedMembers);
+  EXPECT_EQ(2u, stats.iRemovedMembers);
+
+  // nothing to do for the same members again
+  EXPECT_TRUE(UpdateGroupEntries(group, clientGroup, channelsToRemove));
+  EXPECT_TRUE(channelsToRemove.empty());
+
+  stats = group.GetLastSyncStats();
+  EXPECT_EQ(0u, stats.iAddedMembers);
+  EXPECT_EQ(0u, stats.iChangedMembers);
+  EXPECT_EQ(0u, stats.iRemovedMembers);
+}
+
+class TestPVRChannelGroupDatabase : public TestPVRChannelGroup
+{
+protected:
+  CPVRTestDatabase database;
+  std::shared_ptr<CPVRChannelGroup> group;
+
+  static void SetUpTestCase()
+  {
+    // the database manager has to create the databases before they can be opened
+    CServiceBroker::GetDatabaseManager().Initialize();
+  }
+
+  void SetUp() override
+  {
+    ASSERT_TRUE(database.Open());
+    database.Empty();
+    ASSERT_TRUE(database.Fill());
+
+    group = std::make_shared<CPVRChannelGroup>(CPVRChannelsPath(false, "Group"), GROUP_ID);
+    ASSERT_EQ(CHANNELS, database.Get(*group, false));
+  }
+
+  void TearDown() override
+  {
+    group.reset();
+    database.Empty();
+    database.Close();
+  }
+};
+
+TEST_F(TestPVRChannelGroupDatabase, LoadedMembersArePersisted)
+{
+  for (const auto& member : Members(*group))
+  {
+    EXPECT_TRUE(member->IsPersisted());
+    EXPECT_TRUE(member->persistedData == member->GetData(GROUP_ID));
+  }
+}
+
+TEST_F(TestPVRChannelGroupDatabase, PersistWritesOnlyChangedMembers)
+{
+  // an unchanged member isn't written, so this value must survive
+  ASSERT_TRUE(database.SetMemberValue(5, "iOrder", 999));
+
+  Member(*group, 7)->iOrder = 1000;
+  Member(*group, 8)->channelNumber = CPVRChannelNumber(8, 1);
+  // values exchanged between members are detected as well
+  Member(*group, 10)->iOrder = 11;
+  Member(*group, 11)->iOrder = 10;
+  RemoveMember(*group, 9);
+
+  ASSERT_TRUE(database.Persist(*group));
+
+  EXPECT_EQ("999", database.GetMemberValue(5, "iOrder"));
+  EXPECT_EQ("1000", database.GetMemberValue(7, "iOrder"));
+  EXPECT_EQ("1", database.GetMemberValue(8, "iSubChannelNumber"));
+  EXPECT_EQ("11", database.GetMemberValue(10, "iOrder"));
+  EXPECT_EQ("10", database.GetMemberValue(11, "iOrder"));
+  EXPECT_EQ("", database.GetMemberValue(9, "iOrder"));
+  EXPECT_EQ(CHANNELS - 1, database.GetMemberCount());
+
+  for (const auto& member : Members(*group))
+    EXPECT_TRUE(member->persistedData == member->GetData(GROUP_ID)) << GetUniqueID(member);
+
+  // persisting again doesn't write anything
+  ASSERT_TRUE(database.SetMemberValue(7, "iOrder", 7));
+  ASSERT_TRUE(database.Persist(*group));
+  EXPECT_EQ("7", database.GetMemberValue(7, "iOrder"));
+}
+
+TEST_F(TestPVRChannelGroupDatabase, PersistWritesAddedMembers)
+{
+  const std::shared_ptr<CPVRChannel> channel = Member(*group, 20)->channel;
+  RemoveMember(*group, 20);
+  ASSERT_TRUE(database.Persist(*group));
+  EXPECT_EQ(CHANNELS - 1, database.GetMemberCount());
+
+  // a member added again is written, even with the values it had before
+  AddMember(*group, channel, CPVRChannelNumber(20, 0), 20);
+  EXPECT_FALSE(Member(*group, 20)->IsPersisted());
+  ASSERT_TRUE(database.Persist(*group));
+
+  EXPECT_EQ(CHANNELS, database.GetMemberCount());
+  EXPECT_EQ("20", database.GetMemberValue(20, "iOrder"));
+  EXPECT_TRUE(Member(*group, 20)->IsPersisted());
+}
@@ -0,0 +1,137 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "FileItem.h"
+#include "addons/kodi-addon-dev-kit/include/kodi/xbmc_pvr_types.h"
+#include "music/tags/MusicInfoTag.h"
+#include "pvr/channels/PVRChannel.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace PVR;
+
+namespace
+{
+const int THREADS = 8;
+const int ROUNDS = 50;
+
+// the channel is hidden, so it has no epg and filling the music tag doesn't need the pvr manager
+std::shared_ptr<CPVRChannel> CreateChannel(bool bRadio)
+{
+  PVR_CHANNEL data = {};
+  data.iUniqueId = 1;
+  data.bIsRadio = bRadio;
+  data.bIsHidden = true;
+  strncpy(data.strChannelName, "Channel", sizeof(data.strChannelName) - 1);
+  return std::make_shared<CPVRChannel>(data, 999);
+}
+} // unnamed namespace
+
+class TestPVRFileItem : public ::testing::Test
+{
+protected:
+  // whether the music tag of the item still has to be filled, without filling it
+  static bool IsMusicInfoTagDeferred(const CFileItem& item)
+  {
+    return item.m_bFillPVRMusicInfoTag && !item.m_musicInfoTag;
+  }
+
+  static bool HasFilledMusicInfoTag(const CFileItem& item)
+  {
+    return !item.m_bFillPVRMusicInfoTag && item.m_musicInfoTag;
+  }
+};
+
+TEST_F(TestPVRFileItem, RadioChannelMusicTagIsDeferred)
+{
+  const CFileItem item(CreateChannel(true));
+  EXPECT_TRUE(IsMusicInfoTagDeferred(item));
+
+  // the first access fills the tag
+  ASSERT_TRUE(item.HasMusicInfoTag());
+  EXPECT_TRUE(HasFilledMusicInfoTag(item));
+  EXPECT_EQ("Channel", item.GetMusicInfoTag()->GetArtistString());
+  EXPECT_TRUE(item.GetMusicInfoTag()->Loaded());
+
+  // tv channels don't get a music tag
+  const CFileItem tvItem(CreateChannel(false));
+  EXPECT_FALSE(IsMusicInfoTagDeferred(tvItem));
+  EXPECT_FALSE(tvItem.HasMusicInfoTag());
+}
+
+TEST_F(TestPVRFileItem, CopyOfUnfilledItemStaysUnfilled)
+{
+  const CFileItem item(CreateChannel(true));
+
+  CFileItem copy(item);
+  EXPECT_TRUE(IsMusicInfoTagDeferred(item));
+  EXPECT_TRUE(IsMusicInfoTagDeferred(copy));
+
+  CFileItem assigned;
+  assigned = item;
+  EXPECT_TRUE(IsMusicInfoTagDeferred(assigned));
+
+  // filling the copy leaves the original alone
+  ASSERT_NE(nullptr, copy.GetMusicInfoTag());
+  EXPECT_EQ("Channel", copy.GetMusicInfoTag()->GetArtistString());
+  EXPECT_TRUE(IsMusicInfoTagDeferred(item));
+  EXPECT_TRUE(IsMusicInfoTagDeferred(assigned));
+
+  // a filled item is copied with its tag
+  assigned = copy;
+  EXPECT_TRUE(HasFilledMusicInfoTag(assigned));
+  EXPECT_NE(copy.GetMusicInfoTag(), assigned.GetMusicInfoTag());
+  EXPECT_EQ("Channel", assigned.GetMusicInfoTag()->GetArtistString());
+
+  // an item reset has nothing left to fill
+  CFileItem reset(item);
+  reset.Reset();
+  EXPECT_FALSE(IsMusicInfoTagDeferred(reset));
+  EXPECT_FALSE(reset.HasMusicInfoTag());
+}
+
+TEST_F(TestPVRFileItem, ConcurrentReadersFillTagOnce)
+{
+  for (int round = 0; round < ROUNDS; round++)
+  {
+    const CFileItem item(CreateChannel(true));
+    ASSERT_TRUE(IsMusicInfoTagDeferred(item));
+
+    std::vector<const MUSIC_INFO::CMusicInfoTag*> tags(THREADS);
+    std::vector<std::string> copiedArtists(THREADS);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREADS; i++)
+    {
+      threads.emplace_back([&item, &tags, &copiedArtists, i]() {
+        // half of the threads copy the item while the others fill its tag
+        if (i % 2)
+        {
+          const CFileItem copy(item);
+          copiedArtists[i] = copy.GetMusicInfoTag()->GetArtistString();
+        }
+        tags[i] = item.GetMusicInfoTag();
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+
+    ASSERT_TRUE(HasFilledMusicInfoTag(item));
+    for (int i = 0; i < THREADS; i++)
+    {
+      EXPECT_EQ(item.GetMusicInfoTag(), tags[i]);
+      if (i % 2)
+        EXPECT_EQ("Channel", copiedArtists[i]);
+    }
+  }
+}
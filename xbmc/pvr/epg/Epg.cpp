@@ -15,6 +15,7 @@
 #include "pvr/epg/EpgChannelData.h"
 #include "pvr/epg/EpgDatabase.h"
 #include "pvr/epg/EpgInfoTag.h"
+#include "pvr/epg/EpgSearchIndex.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "settings/SettingsComponent.h"
@@ -71,9 +72,35 @@ bool CPVREpg::HasValidEntries(void) const
 void CPVREpg::Clear(void)
 {
   CSingleLock lock(m_critSection);
+  if (m_searchIndex)
+  {
+    for (const auto& tag : m_tags)
+      m_searchIndex->Remove(tag.second);
+  }
   m_tags.clear();
 }
 
+void CPVREpg::SetSearchIndex(const std::shared_ptr<CPVREpgSearchIndex>& index)
+{
+  CSingleLock lock(m_critSection);
+  if (m_searchIndex == index)
+    return;
+
+  if (m_searchIndex)
+  {
+    for (const auto& tag : m_tags)
+      m_searchIndex->Remove(tag.second);
+  }
+
+  m_searchIndex = index;
+
+  if (m_searchIndex)
+  {
+    for (const auto& tag : m_tags)
+      m_searchIndex->Update(tag.second);
+  }
+}
+
 void CPVREpg::Cleanup(int iPastDays)
 {
   const CDateTime cleanupTime = CDateTime::GetUTCDateTime() - CDateTimeSpan(iPastDays, 0, 0, 0);
@@ -90,6 +117,9 @@ void CPVREpg::Cleanup(const CDateTime& time)
       if (m_nowActiveStart == it->first)
         m_nowActiveStart.SetValid(false);
 
+      if (m_searchIndex)
+        m_searchIndex->Remove(it->second);
+
       it = m_tags.erase(it);
     }
     else
@@ -265,6 +295,9 @@ void CPVREpg::AddEntry(const CPVREpgInfoTag& tag)
   newTag->Update(tag);
   newTag->SetChannelData(m_channelData);
   newTag->SetEpgID(m_iEpgID);
+
+  if (m_searchIndex)
+    m_searchIndex->Update(newTag);
 }
 
 bool CPVREpg::Load(const std::shared_ptr<CPVREpgDatabase>& database)
@@ -355,6 +388,9 @@ bool CPVREpg::UpdateEntry(const std::shared_ptr<CPVREpgInfoTag>& tag, bool bUpda
   infoTag->SetChannelData(m_channelData);
   infoTag->SetEpgID(m_iEpgID);
 
+  if (m_searchIndex)
+    m_searchIndex->Update(infoTag);
+
   if (bUpdateDatabase)
     m_changedTags.insert(std::make_pair(infoTag->UniqueBroadcastID(), infoTag));
 
@@ -394,6 +430,9 @@ bool CPVREpg::UpdateEntry(const std::shared_ptr<CPVREpgInfoTag>& tag, EPG_EVENT_
         if (bUpdateDatabase)
           m_deletedTags.insert(std::make_pair(it->second->UniqueBroadcastID(), it->second));
 
+        if (m_searchIndex)
+          m_searchIndex->Remove(it->second);
+
         m_tags.erase(it);
       }
       else
@@ -569,6 +608,9 @@ bool CPVREpg::FixOverlappingEvents(bool bUpdateDb /* = false */)
       if (m_nowActiveStart == it->first)
         m_nowActiveStart.SetValid(false);
 
+      if (m_searchIndex)
+        m_searchIndex->Remove(currentTag);
+
       m_tags.erase(it++);
     }
     else if (previousTag->EndAsUTC() > currentTag->StartAsUTC())
@@ -25,6 +25,7 @@ namespace PVR
   class CPVREpgChannelData;
   class CPVREpgDatabase;
   class CPVREpgInfoTag;
+  class CPVREpgSearchIndex;
 
   class CPVREpg
   {
@@ -251,6 +252,12 @@ namespace PVR
      */
     CEventStream<PVREvent>& Events() { return m_events; }
 
+    /*!
+     * @brief Set the search index to keep up to date with the tags of this EPG.
+     * @param index The index or nullptr to remove the tags from the current index.
+     */
+    void SetSearchIndex(const std::shared_ptr<CPVREpgSearchIndex>& index);
+
   private:
     CPVREpg(void) = delete;
     CPVREpg(const CPVREpg&) = delete;
@@ -318,6 +325,7 @@ namespace PVR
     bool m_bUpdateLastScanTime = false;
 
     std::shared_ptr<CPVREpgChannelData> m_channelData;
+    std::shared_ptr<CPVREpgSearchIndex> m_searchIndex; /*!< the index containing the tags of this table, if any */
 
     CEventSource<PVREvent> m_events;
   };
@@ -16,13 +16,17 @@
 #include "pvr/epg/EpgContainer.h"
 #include "pvr/epg/EpgDatabase.h"
 #include "pvr/epg/EpgInfoTag.h"
+#include "pvr/epg/EpgSearchFilter.h"
+#include "pvr/epg/EpgSearchIndex.h"
 #include "pvr/guilib/PVRGUIProgressHandler.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "settings/SettingsComponent.h"
 #include "threads/SingleLock.h"
+#include "utils/TextSearch.h"
 #include "utils/log.h"
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -94,6 +98,7 @@ void CEpgTagStateChange::Deliver()
 CPVREpgContainer::CPVREpgContainer(void) :
   CThread("EPGUpdater"),
   m_database(new CPVREpgDatabase),
+  m_searchIndex(new CPVREpgSearchIndex),
   m_settings({
     CSettings::SETTING_EPG_STOREEPGINDATABASE,
     CSettings::SETTING_EPG_EPGUPDATE,
@@ -144,9 +149,13 @@ void CPVREpgContainer::Clear()
     CSingleLock lock(m_critSection);
     /* clear all epg tables and remove pointers to epg tables on channels */
     for (const auto& epgEntry : m_epgIdToEpgMap)
+    {
       epgEntry.second->Events().Unsubscribe(this);
+      epgEntry.second->SetSearchIndex(nullptr);
+    }
 
     m_epgIdToEpgMap.clear();
+    m_searchIndex->Clear();
     m_channelUidToEpgMap.clear();
     m_iNextEpgUpdate = 0;
     m_bStarted = false;
@@ -505,6 +514,37 @@ std::vector<std::shared_ptr<CPVREpgInfoTag>> CPVREpgContainer::GetAllTags() cons
   return allTags;
 }
 
+std::vector<std::shared_ptr<CPVREpgInfoTag>> CPVREpgContainer::GetTagsContaining(const std::vector<std::string>& anyOf,
+                                                                                 const std::vector<std::string>& allOf) const
+{
+  std::vector<std::shared_ptr<CPVREpgInfoTag>> tags;
+  if (!m_searchIndex->GetCandidates(anyOf, allOf, tags))
+    tags = GetAllTags();
+
+  return tags;
+}
+
+std::vector<std::shared_ptr<CPVREpgInfoTag>> CPVREpgContainer::GetTags(const CPVREpgSearchFilter& filter) const
+{
+  std::vector<std::shared_ptr<CPVREpgInfoTag>> tags;
+
+  // 'not' terms can't narrow down the tags to check
+  const std::shared_ptr<const CTextSearch> search = filter.GetTextSearch();
+  if (search)
+    tags = GetTagsContaining(search->GetOrTerms(), search->GetAndTerms());
+  else
+    tags = GetAllTags();
+
+  tags.erase(std::remove_if(tags.begin(), tags.end(),
+                            [&filter](const std::shared_ptr<CPVREpgInfoTag>& tag)
+                            {
+                              return !filter.FilterEntry(tag);
+                            }),
+             tags.end());
+
+  return tags;
+}
+
 void CPVREpgContainer::InsertFromDB(const std::shared_ptr<CPVREpg>& newEpg)
 {
   // table might already have been created when pvr channels were loaded
@@ -515,6 +555,7 @@ void CPVREpgContainer::InsertFromDB(const std::shared_ptr<CPVREpg>& newEpg)
     epg = newEpg;
     m_epgIdToEpgMap.insert({epg->EpgID(), epg});
     epg->Events().Subscribe(this, &CPVREpgContainer::Notify);
+    epg->SetSearchIndex(m_searchIndex);
   }
 }
 
@@ -539,6 +580,7 @@ std::shared_ptr<CPVREpg> CPVREpgContainer::CreateChannelEpg(int iEpgId, const st
     m_epgIdToEpgMap.insert({iEpgId, epg});
     m_channelUidToEpgMap.insert({{channelData->ClientId(), channelData->UniqueClientChannelId()}, epg});
     epg->Events().Subscribe(this, &CPVREpgContainer::Notify);
+    epg->SetSearchIndex(m_searchIndex);
   }
   else if (epg->ChannelID() == -1)
   {
@@ -597,6 +639,7 @@ bool CPVREpgContainer::DeleteEpg(const std::shared_ptr<CPVREpg>& epg, bool bDele
     m_database->Delete(*epgEntry->second);
 
   epgEntry->second->Events().Unsubscribe(this);
+  epgEntry->second->SetSearchIndex(nullptr);
   m_epgIdToEpgMap.erase(epgEntry);
 
   return true;
@@ -31,6 +31,8 @@ namespace PVR
   class CPVREpgChannelData;
   class CPVREpgDatabase;
   class CPVREpgInfoTag;
+  class CPVREpgSearchFilter;
+  class CPVREpgSearchIndex;
 
   enum class PVREvent;
 
@@ -152,6 +154,23 @@ namespace PVR
      */
     std::vector<std::shared_ptr<CPVREpgInfoTag>> GetAllTags() const;
 
+    /*!
+     * @brief Get the EPG tags that may contain the given texts, ignoring case.
+     * @param anyOf Texts of which at least one has to be contained. Ignored if empty.
+     * @param allOf Texts which all have to be contained.
+     * @return The tags found using the search index, or all tags if the texts are too short to narrow
+     * them down. The tags still have to be checked against the exact search criteria.
+     */
+    std::vector<std::shared_ptr<CPVREpgInfoTag>> GetTagsContaining(const std::vector<std::string>& anyOf,
+                                                                   const std::vector<std::string>& allOf) const;
+
+    /*!
+     * @brief Get the EPG tags matching a search filter.
+     * @param filter The filter.
+     * @return The tags.
+     */
+    std::vector<std::shared_ptr<CPVREpgInfoTag>> GetTags(const CPVREpgSearchFilter& filter) const;
+
     /*!
      * @brief Check whether data should be persisted to the EPG database.
      * @return True if data should be persisted to the EPG database, false otherwise.
@@ -275,6 +294,7 @@ namespace PVR
 
     std::map<int, std::shared_ptr<CPVREpg>> m_epgIdToEpgMap; /*!< the EPGs in this container. maps epg ids to epgs */
     std::map<std::pair<int, int>, std::shared_ptr<CPVREpg>> m_channelUidToEpgMap; /*!< the EPGs in this container. maps channel uids to epgs */
+    std::shared_ptr<CPVREpgSearchIndex> m_searchIndex; /*!< the search index over the tags of all EPGs in this container */
 
     mutable CCriticalSection m_critSection; /*!< a critical section for changes to this container */
     CEvent m_updateEvent; /*!< trigger when an update finishes */
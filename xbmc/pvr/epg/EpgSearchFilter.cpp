@@ -22,7 +22,9 @@
 #include "utils/log.h"
 
 #include <algorithm>
+#include <functional>
 #include <memory>
+#include <unordered_map>
 
 using namespace PVR;
 
@@ -35,6 +37,7 @@ CPVREpgSearchFilter::CPVREpgSearchFilter(bool bRadio)
 void CPVREpgSearchFilter::Reset()
 {
   m_strSearchTerm.clear();
+  m_textSearch.reset();
   m_bIsCaseSensitive = false;
   m_bSearchInDescription = false;
   m_iGenreType = EPG_SEARCH_UNSET;
@@ -100,26 +103,47 @@ bool CPVREpgSearchFilter::MatchStartAndEndTimes(const std::shared_ptr<CPVREpgInf
   return (tag->StartAsLocalTime() >= m_startDateTime && tag->EndAsLocalTime() <= m_endDateTime);
 }
 
+void CPVREpgSearchFilter::SetSearchTerm(const std::string& strSearchTerm)
+{
+  m_strSearchTerm = strSearchTerm;
+  UpdateTextSearch();
+}
+
 void CPVREpgSearchFilter::SetSearchPhrase(const std::string& strSearchPhrase)
 {
   // match the exact phrase
   m_strSearchTerm = "\"";
   m_strSearchTerm.append(strSearchPhrase);
   m_strSearchTerm.append("\"");
+  UpdateTextSearch();
+}
+
+void CPVREpgSearchFilter::SetCaseSensitive(bool bIsCaseSensitive)
+{
+  m_bIsCaseSensitive = bIsCaseSensitive;
+  UpdateTextSearch();
+}
+
+void CPVREpgSearchFilter::UpdateTextSearch()
+{
+  // parse the term once instead of once per tag
+  if (m_strSearchTerm.empty())
+    m_textSearch.reset();
+  else
+    m_textSearch = std::make_shared<CTextSearch>(m_strSearchTerm, m_bIsCaseSensitive, SEARCH_DEFAULT_OR);
 }
 
 bool CPVREpgSearchFilter::MatchSearchTerm(const std::shared_ptr<CPVREpgInfoTag>& tag) const
 {
   bool bReturn(true);
 
-  if (!m_strSearchTerm.empty())
+  if (m_textSearch)
   {
-    CTextSearch search(m_strSearchTerm, m_bIsCaseSensitive, SEARCH_DEFAULT_OR);
     bReturn = !CServiceBroker::GetPVRManager().IsParentalLocked(tag);
     if (bReturn)
-      bReturn = search.Search(tag->Title()) ||
-                search.Search(tag->PlotOutline()) ||
-                (m_bSearchInDescription && search.Search(tag->Plot()));
+      bReturn = m_textSearch->Search(tag->Title()) ||
+                m_textSearch->Search(tag->PlotOutline()) ||
+                (m_bSearchInDescription && m_textSearch->Search(tag->Plot()));
   }
 
   return bReturn;
@@ -150,19 +174,42 @@ bool CPVREpgSearchFilter::FilterEntry(const std::shared_ptr<CPVREpgInfoTag>& tag
 
 void CPVREpgSearchFilter::RemoveDuplicates(std::vector<std::shared_ptr<CPVREpgInfoTag>>& results)
 {
-  for (auto it = results.begin(); it != results.end();)
+  struct Texts
   {
-    it = results.erase(std::remove_if(results.begin(),
-                                      results.end(),
-                                      [&it](const std::shared_ptr<CPVREpgInfoTag>& entry)
-                                      {
-                                         return *it != entry &&
-                                                (*it)->Title() == entry->Title() &&
-                                                (*it)->Plot() == entry->Plot() &&
-                                                (*it)->PlotOutline() == entry->PlotOutline();
-                                      }),
-                       results.end());
-  }
+    std::string strTitle;
+    std::string strPlot;
+    std::string strPlotOutline;
+
+    bool operator==(const Texts& right) const
+    {
+      return strTitle == right.strTitle && strPlot == right.strPlot && strPlotOutline == right.strPlotOutline;
+    }
+  };
+
+  // keep the first of the tags with equal texts, comparing the texts only if their hashes collide
+  std::unordered_multimap<size_t, Texts> kept;
+  kept.reserve(results.size());
+
+  const std::hash<std::string> hash;
+  auto last = std::remove_if(results.begin(), results.end(),
+                             [&kept, &hash](const std::shared_ptr<CPVREpgInfoTag>& entry)
+                             {
+                               Texts texts{entry->Title(), entry->Plot(), entry->PlotOutline()};
+                               const size_t iHash = hash(texts.strTitle) ^
+                                                    (hash(texts.strPlot) * 31) ^
+                                                    (hash(texts.strPlotOutline) * 961);
+
+                               const auto range = kept.equal_range(iHash);
+                               for (auto it = range.first; it != range.second; ++it)
+                               {
+                                 if (it->second == texts)
+                                   return true;
+                               }
+
+                               kept.emplace(iHash, std::move(texts));
+                               return false;
+                             });
+  results.erase(last, results.end());
 }
 
 bool CPVREpgSearchFilter::MatchChannelType(const std::shared_ptr<CPVREpgInfoTag>& tag) const
@@ -15,6 +15,8 @@
 #include <string>
 #include <vector>
 
+class CTextSearch;
+
 namespace PVR
 {
   #define EPG_SEARCH_UNSET (-1)
@@ -59,11 +61,17 @@ namespace PVR
     bool IsRadio() const { return m_bIsRadio; }
 
     const std::string& GetSearchTerm() const { return m_strSearchTerm; }
-    void SetSearchTerm(const std::string& strSearchTerm) { m_strSearchTerm = strSearchTerm; }
+    void SetSearchTerm(const std::string& strSearchTerm);
     void SetSearchPhrase(const std::string& strSearchPhrase);
 
+    /*!
+     * @brief Get the parsed search term.
+     * @return The search, or nullptr if no search term is set.
+     */
+    std::shared_ptr<const CTextSearch> GetTextSearch() const { return m_textSearch; }
+
     bool IsCaseSensitive() const { return m_bIsCaseSensitive; }
-    void SetCaseSensitive(bool bIsCaseSensitive) { m_bIsCaseSensitive = bIsCaseSensitive; }
+    void SetCaseSensitive(bool bIsCaseSensitive);
 
     bool ShouldSearchInDescription() const { return m_bSearchInDescription; }
     void SetSearchInDescription(bool bSearchInDescription) {m_bSearchInDescription = bSearchInDescription; }
@@ -123,7 +131,10 @@ namespace PVR
     bool MatchTimers(const std::shared_ptr<CPVREpgInfoTag>& tag) const;
     bool MatchRecordings(const std::shared_ptr<CPVREpgInfoTag>& tag) const;
 
+    void UpdateTextSearch();
+
     std::string m_strSearchTerm; /*!< The term to search for */
+    std::shared_ptr<const CTextSearch> m_textSearch; /*!< The parsed term to search for, shared by all tags checked */
     bool m_bIsCaseSensitive; /*!< Do a case sensitive search */
     bool m_bSearchInDescription; /*!< Search for strSearchTerm in the description too */
     int m_iGenreType; /*!< The genre type for an entry */
@@ -0,0 +1,258 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "EpgSearchIndex.h"
+
+#include "pvr/epg/EpgInfoTag.h"
+#include "threads/SingleLock.h"
+#include "utils/StringUtils.h"
+
+#include <algorithm>
+#include <functional>
+
+using namespace PVR;
+
+namespace
+{
+  // shorter parts of a search text match too many words to narrow down the tags
+  const size_t MIN_PART_LENGTH = 2;
+  // stale slots are dropped once there are more of them than indexed tags
+  const size_t MIN_STALE_SLOTS = 4096;
+
+  const char* const WHITESPACE = " \t\r\n";
+
+  template<typename F>
+  void ForEachWord(const std::string& strText, F&& func)
+  {
+    size_t iStart = strText.find_first_not_of(WHITESPACE);
+    while (iStart != std::string::npos)
+    {
+      const size_t iEnd = strText.find_first_of(WHITESPACE, iStart);
+      func(strText.substr(iStart, iEnd == std::string::npos ? std::string::npos : iEnd - iStart));
+      iStart = strText.find_first_not_of(WHITESPACE, iEnd);
+    }
+  }
+} // unnamed namespace
+
+std::string CPVREpgSearchIndex::GetText(const CPVREpgInfoTag& tag)
+{
+  std::string strText = tag.Title();
+  strText += '\n';
+  strText += tag.EpisodeName();
+  strText += '\n';
+  strText += tag.PlotOutline();
+  strText += '\n';
+  strText += tag.Plot();
+  for (const auto& genre : tag.Genre())
+  {
+    strText += '\n';
+    strText += genre;
+  }
+
+  // same as CTextSearch
+  StringUtils::ToLower(strText);
+  return strText;
+}
+
+void CPVREpgSearchIndex::AddWords(unsigned int iSlot, const std::string& strText)
+{
+  std::vector<std::string> words;
+  ForEachWord(strText, [&words](std::string&& word) { words.emplace_back(std::move(word)); });
+
+  std::sort(words.begin(), words.end());
+  words.erase(std::unique(words.begin(), words.end()), words.end());
+
+  // slots are handed out in ascending order, so the lists stay sorted
+  for (auto& word : words)
+    m_words[std::move(word)].emplace_back(iSlot);
+}
+
+void CPVREpgSearchIndex::Update(const std::shared_ptr<CPVREpgInfoTag>& tag)
+{
+  const std::string strText = GetText(*tag);
+  const size_t iTextHash = std::hash<std::string>()(strText);
+
+  CSingleLock lock(m_critSection);
+  const auto it = m_entries.find(tag.get());
+  if (it != m_entries.end())
+  {
+    if (it->second.iTextHash == iTextHash)
+      return;
+
+    m_slots[it->second.iSlot].reset();
+    m_iStaleSlots++;
+    m_entries.erase(it);
+  }
+
+  const unsigned int iSlot = static_cast<unsigned int>(m_slots.size());
+  m_slots.emplace_back(tag);
+  m_entries.insert({tag.get(), {iSlot, iTextHash}});
+  AddWords(iSlot, strText);
+
+  if (m_iStaleSlots > MIN_STALE_SLOTS && m_iStaleSlots > m_entries.size())
+    Compact();
+}
+
+void CPVREpgSearchIndex::Remove(const std::shared_ptr<CPVREpgInfoTag>& tag)
+{
+  CSingleLock lock(m_critSection);
+  const auto it = m_entries.find(tag.get());
+  if (it == m_entries.end())
+    return;
+
+  m_slots[it->second.iSlot].reset();
+  m_iStaleSlots++;
+  m_entries.erase(it);
+
+  if (m_iStaleSlots > MIN_STALE_SLOTS && m_iStaleSlots > m_entries.size())
+    Compact();
+}
+
+void CPVREpgSearchIndex::Clear()
+{
+  CSingleLock lock(m_critSection);
+  m_slots.clear();
+  m_entries.clear();
+  m_words.clear();
+  m_iStaleSlots = 0;
+}
+
+size_t CPVREpgSearchIndex::Size() const
+{
+  CSingleLock lock(m_critSection);
+  return m_entries.size();
+}
+
+void CPVREpgSearchIndex::Compact()
+{
+  std::vector<std::shared_ptr<CPVREpgInfoTag>> tags;
+  tags.reserve(m_entries.size());
+  for (auto& tag : m_slots)
+  {
+    if (tag)
+      tags.emplace_back(std::move(tag));
+  }
+
+  m_slots.clear();
+  m_words.clear();
+  m_iStaleSlots = 0;
+
+  for (auto& tag : tags)
+  {
+    const unsigned int iSlot = static_cast<unsigned int>(m_slots.size());
+    m_entries[tag.get()].iSlot = iSlot;
+    AddWords(iSlot, GetText(*tag));
+    m_slots.emplace_back(std::move(tag));
+  }
+}
+
+bool CPVREpgSearchIndex::Match(const std::string& strText, std::vector<bool>& slots) const
+{
+  std::string strLowerText(strText);
+  StringUtils::ToLower(strLowerText);
+
+  // a text found in a tag consists of parts found within the words of the tag
+  std::vector<std::string> parts;
+  ForEachWord(strLowerText, [&parts](std::string&& part) {
+    if (part.size() >= MIN_PART_LENGTH)
+      parts.emplace_back(std::move(part));
+  });
+
+  if (parts.empty())
+    return false;
+
+  slots.assign(m_slots.size(), false);
+  bool bFirst = true;
+  for (const auto& part : parts)
+  {
+    std::vector<bool> partSlots(m_slots.size(), false);
+    for (const auto& word : m_words)
+    {
+      if (word.first.find(part) == std::string::npos)
+        continue;
+
+      for (unsigned int iSlot : word.second)
+        partSlots[iSlot] = true;
+    }
+
+    if (bFirst)
+    {
+      slots.swap(partSlots);
+      bFirst = false;
+    }
+    else
+    {
+      for (size_t i = 0; i < slots.size(); ++i)
+        slots[i] = slots[i] && partSlots[i];
+    }
+  }
+
+  return true;
+}
+
+bool CPVREpgSearchIndex::GetCandidates(const std::vector<std::string>& anyOf,
+                                       const std::vector<std::string>& allOf,
+                                       std::vector<std::shared_ptr<CPVREpgInfoTag>>& tags) const
+{
+  CSingleLock lock(m_critSection);
+
+  std::vector<bool> slots;
+  bool bNarrowed = false;
+
+  for (const auto& text : anyOf)
+  {
+    std::vector<bool> textSlots;
+    if (!Match(text, textSlots))
+    {
+      // a single text that can't be narrowed down may match any tag
+      bNarrowed = false;
+      break;
+    }
+
+    if (!bNarrowed)
+    {
+      slots.swap(textSlots);
+      bNarrowed = true;
+    }
+    else
+    {
+      for (size_t i = 0; i < slots.size(); ++i)
+        slots[i] = slots[i] || textSlots[i];
+    }
+  }
+
+  for (const auto& text : allOf)
+  {
+    std::vector<bool> textSlots;
+    if (!Match(text, textSlots))
+      continue;
+
+    if (!bNarrowed)
+    {
+      slots.swap(textSlots);
+      bNarrowed = true;
+    }
+    else
+    {
+      for (size_t i = 0; i < slots.size(); ++i)
+        slots[i] = slots[i] && textSlots[i];
+    }
+  }
+
+  if (!bNarrowed)
+    return false;
+
+  tags.clear();
+  for (size_t i = 0; i < slots.size(); ++i)
+  {
+    if (slots[i] && m_slots[i])
+      tags.emplace_back(m_slots[i]);
+  }
+
+  return true;
+}
@@ -0,0 +1,104 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "threads/CriticalSection.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace PVR
+{
+  class CPVREpgInfoTag;
+
+  /*!
+   * @brief Inverted index over the title, episode name, plot outline, plot and genre of EPG tags.
+   *
+   * The index maps the whitespace separated words of the lower-cased texts to the tags containing
+   * them. Searching for a text looks up the words containing the parts of the text, so the index
+   * answers which tags may contain a text anywhere, just like a substring search would. The result
+   * is a superset of the matching tags that still has to be checked against the exact search
+   * criteria, e.g. case sensitivity or the position of the parts of a phrase.
+   *
+   * Tags replaced or removed leave stale entries behind, which are dropped once they make up the
+   * larger part of the index.
+   */
+  class CPVREpgSearchIndex
+  {
+  public:
+    CPVREpgSearchIndex() = default;
+    virtual ~CPVREpgSearchIndex() = default;
+
+    /*!
+     * @brief Add a tag to the index or re-index it if its texts changed.
+     * @param tag The tag.
+     */
+    void Update(const std::shared_ptr<CPVREpgInfoTag>& tag);
+
+    /*!
+     * @brief Remove a tag from the index.
+     * @param tag The tag.
+     */
+    void Remove(const std::shared_ptr<CPVREpgInfoTag>& tag);
+
+    /*!
+     * @brief Remove all tags from the index.
+     */
+    void Clear();
+
+    /*!
+     * @brief Get the number of tags in the index.
+     * @return The number of tags.
+     */
+    size_t Size() const;
+
+    /*!
+     * @brief Get the tags that may contain the given texts, ignoring case.
+     * @param anyOf Texts of which at least one has to be contained. Ignored if empty.
+     * @param allOf Texts which all have to be contained.
+     * @param tags The tags that may match.
+     * @return True on success, false if the texts are too short to narrow down the tags.
+     */
+    bool GetCandidates(const std::vector<std::string>& anyOf,
+                       const std::vector<std::string>& allOf,
+                       std::vector<std::shared_ptr<CPVREpgInfoTag>>& tags) const;
+
+  private:
+    CPVREpgSearchIndex(const CPVREpgSearchIndex&) = delete;
+    CPVREpgSearchIndex& operator=(const CPVREpgSearchIndex&) = delete;
+
+    struct Entry
+    {
+      unsigned int iSlot;
+      size_t iTextHash;
+    };
+
+    static std::string GetText(const CPVREpgInfoTag& tag);
+    void AddWords(unsigned int iSlot, const std::string& strText);
+
+    /*!
+     * @brief Mark the slots of the tags that may contain a text.
+     * @return False if the text is too short to narrow down the tags.
+     */
+    bool Match(const std::string& strText, std::vector<bool>& slots) const;
+
+    /*!
+     * @brief Rebuild the index without the stale entries.
+     */
+    void Compact();
+
+    mutable CCriticalSection m_critSection;
+    std::vector<std::shared_ptr<CPVREpgInfoTag>> m_slots; /*!< the indexed tags, nullptr for stale slots */
+    std::unordered_map<const CPVREpgInfoTag*, Entry> m_entries; /*!< the slot of each indexed tag */
+    std::unordered_map<std::string, std::vector<unsigned int>> m_words; /*!< the slots containing a word, ascending */
+    size_t m_iStaleSlots = 0;
+  };
+}
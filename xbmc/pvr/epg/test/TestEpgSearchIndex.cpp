@@ -0,0 +1,239 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "addons/kodi-addon-dev-kit/include/kodi/xbmc_pvr_types.h"
+#include "pvr/epg/EpgInfoTag.h"
+#include "pvr/epg/EpgSearchFilter.h"
+#include "pvr/epg/EpgSearchIndex.h"
+#include "test/TestUtils.h"
+#include "utils/StringUtils.h"
+#include "utils/TextSearch.h"
+
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace PVR;
+
+namespace
+{
+const char* const WORDS[] = {"News", "Weather", "Sport", "Football", "Crime", "Detective",
+                             "Cooking", "Kitchen", "Nature", "Wildlife", "Ocean", "Mountain",
+                             "History", "Empire", "Science", "Space", "Comedy", "Family",
+                             "Music", "Concert", "Travel", "Island", "Drama", "Hospital"};
+const size_t NUM_WORDS = sizeof(WORDS) / sizeof(WORDS[0]);
+
+std::string GetText(unsigned int iSeed, size_t iLength)
+{
+  std::string strText;
+  for (size_t i = 0; i < iLength; ++i)
+  {
+    iSeed = iSeed * 1103515245 + 12345;
+    if (!strText.empty())
+      strText += ' ';
+    strText += WORDS[(iSeed >> 16) % NUM_WORDS];
+  }
+  return strText;
+}
+
+std::shared_ptr<CPVREpgInfoTag> CreateTag(unsigned int iId,
+                                          const std::string& strTitle,
+                                          const std::string& strPlot)
+{
+  EPG_TAG data = {};
+  data.iUniqueBroadcastId = iId;
+  data.iUniqueChannelId = 1;
+  data.startTime = 1000000 + iId * 1800;
+  data.endTime = data.startTime + 1800;
+  data.iGenreType = EPG_GENRE_USE_STRING;
+  data.strGenreDescription = "Entertainment";
+  data.strTitle = strTitle.c_str();
+  data.strPlot = strPlot.c_str();
+  return std::make_shared<CPVREpgInfoTag>(data, 1, nullptr, 1);
+}
+
+std::vector<std::shared_ptr<CPVREpgInfoTag>> CreateGuide(unsigned int iTags)
+{
+  std::vector<std::shared_ptr<CPVREpgInfoTag>> tags;
+  tags.reserve(iTags);
+  for (unsigned int i = 0; i < iTags; ++i)
+  {
+    // a few hundred distinct shows, repeated over the guide
+    tags.emplace_back(CreateTag(i, GetText(i % 500, 2), GetText(i % 700 + 1000, 12)));
+  }
+  return tags;
+}
+
+bool Matches(const CTextSearch& search, const std::shared_ptr<CPVREpgInfoTag>& tag)
+{
+  return search.Search(tag->Title()) || search.Search(tag->PlotOutline()) ||
+         search.Search(tag->Plot());
+}
+
+std::vector<std::shared_ptr<CPVREpgInfoTag>> GetCandidates(const CPVREpgSearchIndex& index,
+                                                           const CTextSearch& search)
+{
+  std::vector<std::shared_ptr<CPVREpgInfoTag>> tags;
+  EXPECT_TRUE(index.GetCandidates(search.GetOrTerms(), search.GetAndTerms(), tags));
+  return tags;
+}
+} // unnamed namespace
+
+TEST(TestEpgSearchIndex, CandidatesContainAllMatches)
+{
+  const std::vector<std::shared_ptr<CPVREpgInfoTag>> tags = CreateGuide(5000);
+
+  CPVREpgSearchIndex index;
+  for (const auto& tag : tags)
+    index.Update(tag);
+  EXPECT_EQ(tags.size(), index.Size());
+
+  const char* const searches[] = {"football", "Detective Kitchen", "\"ocean mountain\"",
+                                  "+space +family", "ildlif", "\"ce Isl\"", "news !weather",
+                                  "SPORT"};
+  for (const char* strSearch : searches)
+  {
+    for (bool bCaseSensitive : {false, true})
+    {
+      const CTextSearch search(strSearch, bCaseSensitive);
+      const std::vector<std::shared_ptr<CPVREpgInfoTag>> candidates = GetCandidates(index, search);
+      const std::set<std::shared_ptr<CPVREpgInfoTag>> candidateSet(candidates.begin(), candidates.end());
+
+      for (const auto& tag : tags)
+      {
+        if (Matches(search, tag))
+          EXPECT_EQ(1u, candidateSet.count(tag)) << strSearch << " " << tag->Title();
+      }
+    }
+  }
+
+  // a search narrows the tags down
+  const CTextSearch search("\"ocean mountain\"");
+  EXPECT_LT(GetCandidates(index, search).size(), tags.size());
+}
+
+TEST(TestEpgSearchIndex, UnconstrainedSearch)
+{
+  CPVREpgSearchIndex index;
+  index.Update(CreateTag(1, "A Show", "About something"));
+
+  std::vector<std::shared_ptr<CPVREpgInfoTag>> tags;
+  EXPECT_FALSE(index.GetCandidates({}, {}, tags));
+  EXPECT_FALSE(index.GetCandidates({"a"}, {}, tags));
+  EXPECT_FALSE(index.GetCandidates({"show", "a"}, {}, tags));
+
+  EXPECT_TRUE(index.GetCandidates({"show", "a"}, {"about"}, tags));
+  EXPECT_EQ(1u, tags.size());
+
+  EXPECT_TRUE(index.GetCandidates({"nothing"}, {}, tags));
+  EXPECT_TRUE(tags.empty());
+}
+
+TEST(TestEpgSearchIndex, UpdateAndRemove)
+{
+  const std::vector<std::shared_ptr<CPVREpgInfoTag>> tags = CreateGuide(10000);
+
+  CPVREpgSearchIndex index;
+  for (const auto& tag : tags)
+    index.Update(tag);
+
+  std::shared_ptr<CPVREpgInfoTag> tag = tags.front();
+  const std::shared_ptr<CPVREpgInfoTag> changed = CreateTag(0, "Unique Title", "");
+  tag->Update(*changed);
+  index.Update(tag);
+  EXPECT_EQ(tags.size(), index.Size());
+
+  std::vector<std::shared_ptr<CPVREpgInfoTag>> candidates;
+  EXPECT_TRUE(index.GetCandidates({"unique"}, {}, candidates));
+  ASSERT_EQ(1u, candidates.size());
+  EXPECT_EQ(tag, candidates.front());
+
+  index.Remove(tag);
+  EXPECT_TRUE(index.GetCandidates({"unique"}, {}, candidates));
+  EXPECT_TRUE(candidates.empty());
+
+  // removing most of the tags compacts the index, which must keep the remaining ones
+  for (size_t i = 1; i < tags.size() - 1; ++i)
+    index.Remove(tags[i]);
+
+  EXPECT_EQ(1u, index.Size());
+  EXPECT_TRUE(index.GetCandidates({StringUtils::Split(tags.back()->Title(), " ").front()}, {}, candidates));
+  ASSERT_EQ(1u, candidates.size());
+  EXPECT_EQ(tags.back(), candidates.front());
+}
+
+TEST(TestEpgSearchIndex, RemoveDuplicatesKeepsFirst)
+{
+  std::vector<std::shared_ptr<CPVREpgInfoTag>> tags = {
+    CreateTag(1, "Show", "Plot 1"), CreateTag(2, "Show", "Plot 2"), CreateTag(3, "Show", "Plot 1"),
+    CreateTag(4, "Other", "Plot 1"), CreateTag(5, "Show", "Plot 2")};
+
+  CPVREpgSearchFilter::RemoveDuplicates(tags);
+
+  ASSERT_EQ(3u, tags.size());
+  EXPECT_EQ(1u, tags[0]->UniqueBroadcastID());
+  EXPECT_EQ(2u, tags[1]->UniqueBroadcastID());
+  EXPECT_EQ(4u, tags[2]->UniqueBroadcastID());
+}
+
+TEST(TestEpgSearchIndex, Benchmark)
+{
+  const std::vector<std::shared_ptr<CPVREpgInfoTag>> tags = CreateGuide(100000);
+
+  CTestStopwatch stopwatch;
+  CPVREpgSearchIndex index;
+  for (const auto& tag : tags)
+    index.Update(tag);
+  const int64_t indexTime = stopwatch.Lap();
+
+  const CTextSearch search("\"detective kitchen\"");
+
+  // what the search did before: check every tag
+  stopwatch.Lap();
+  std::vector<std::shared_ptr<CPVREpgInfoTag>> scanned;
+  for (const auto& tag : tags)
+  {
+    if (Matches(search, tag))
+      scanned.emplace_back(tag);
+  }
+  const int64_t scanTime = stopwatch.Lap();
+
+  std::vector<std::shared_ptr<CPVREpgInfoTag>> found = GetCandidates(index, search);
+  found.erase(std::remove_if(found.begin(), found.end(),
+                             [&search](const std::shared_ptr<CPVREpgInfoTag>& tag)
+                             {
+                               return !Matches(search, tag);
+                             }),
+              found.end());
+  const int64_t searchTime = stopwatch.Lap();
+
+  std::sort(scanned.begin(), scanned.end());
+  std::sort(found.begin(), found.end());
+  EXPECT_EQ(scanned, found);
+
+  std::vector<std::shared_ptr<CPVREpgInfoTag>> results(tags);
+  stopwatch.Lap();
+  CPVREpgSearchFilter::RemoveDuplicates(results);
+  const int64_t dedupTime = stopwatch.Lap();
+
+  std::set<std::pair<std::string, std::string>> distinct;
+  for (const auto& tag : tags)
+    distinct.insert({tag->Title(), tag->Plot()});
+  EXPECT_EQ(distinct.size(), results.size());
+
+  RecordProperty("tags", static_cast<int>(tags.size()));
+  RecordProperty("index_us", static_cast<int>(indexTime));
+  RecordProperty("scan_us", static_cast<int>(scanTime));
+  RecordProperty("search_us", static_cast<int>(searchTime));
+  RecordProperty("remove_duplicates_us", static_cast<int>(dedupTime));
+}
@@ -250,30 +250,36 @@ bool CPVRGUIDirectory::GetRecordingsDirectory(CFileItemList& results) const
 
   const CPVRRecordingsPath recPath(m_url.GetWithoutOptions());
   if (recPath.IsValid())
+    GetRecordingsDirectory(recPath, bGrouped, recordings, results);
+
+  return recPath.IsValid();
+}
+
+void CPVRGUIDirectory::GetRecordingsDirectory(const CPVRRecordingsPath& recPath,
+                                              bool bGrouped,
+                                              const std::vector<std::shared_ptr<CPVRRecording>>& recordings,
+                                              CFileItemList& results)
+{
+  // Get the directory structure if in non-flatten mode
+  // Deleted view is always flatten. So only for an active view
+  const std::string strDirectory = recPath.GetUnescapedDirectoryPath();
+  if (!recPath.IsDeleted() && bGrouped)
+    GetSubDirectories(recPath, recordings, results);
+
+  // get all files of the current directory or recursively all files starting at the current directory if in flatten mode
+  std::shared_ptr<CFileItem> item;
+  for (const auto& recording : recordings)
   {
-    // Get the directory structure if in non-flatten mode
-    // Deleted view is always flatten. So only for an active view
-    const std::string strDirectory = recPath.GetUnescapedDirectoryPath();
-    if (!recPath.IsDeleted() && bGrouped)
-      GetSubDirectories(recPath, recordings, results);
+    // Omit recordings not matching criteria
+    if (recording->IsDeleted() != recPath.IsDeleted() ||
+        recording->IsRadio() != recPath.IsRadio() ||
+        !IsDirectoryMember(strDirectory, recording->m_strDirectory, bGrouped))
+      continue;
 
-    // get all files of the current directory or recursively all files starting at the current directory if in flatten mode
-    std::shared_ptr<CFileItem> item;
-    for (const auto& recording : recordings)
-    {
-      // Omit recordings not matching criteria
-      if (recording->IsDeleted() != recPath.IsDeleted() ||
-          recording->IsRadio() != recPath.IsRadio() ||
-          !IsDirectoryMember(strDirectory, recording->m_strDirectory, bGrouped))
-        continue;
-
-      item = std::make_shared<CFileItem>(recording);
-      item->SetOverlayImage(CGUIListItem::ICON_OVERLAY_UNWATCHED, recording->GetPlayCount() > 0);
-      results.Add(item);
-    }
+    item = std::make_shared<CFileItem>(recording);
+    item->SetOverlayImage(CGUIListItem::ICON_OVERLAY_UNWATCHED, recording->GetPlayCount() > 0);
+    results.Add(item);
   }
-
-  return recPath.IsValid();
 }
 
 bool CPVRGUIDirectory::FilterDirectory(CFileItemList& results) const
@@ -10,12 +10,16 @@
 
 #include "URL.h"
 
+#include <memory>
 #include <string>
+#include <vector>
 
 class CFileItemList;
 
 namespace PVR
 {
+class CPVRRecording;
+class CPVRRecordingsPath;
 
 class CPVRGUIDirectory
 {
@@ -96,6 +100,18 @@ public:
    */
   bool GetChannelsDirectory(CFileItemList& results) const;
 
+  /*!
+   * @brief Get the list of recordings and recording folders for a recordings path.
+   * @param recPath The recordings path.
+   * @param bGrouped If true, list the sub folders and the recordings of the folder, all recordings below the folder otherwise.
+   * @param recordings The recordings to list.
+   * @param results The file list to store the results in.
+   */
+  static void GetRecordingsDirectory(const CPVRRecordingsPath& recPath,
+                                     bool bGrouped,
+                                     const std::vector<std::shared_ptr<CPVRRecording>>& recordings,
+                                     CFileItemList& results);
+
 private:
   bool FilterDirectory(CFileItemList& results) const;
   bool GetTimersDirectory(CFileItemList& results) const;
@@ -0,0 +1,103 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "FileItem.h"
+#include "pvr/filesystem/PVRGUIDirectory.h"
+#include "pvr/recordings/PVRRecording.h"
+#include "pvr/recordings/PVRRecordingsPath.h"
+#include "test/TestUtils.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace PVR;
+
+namespace
+{
+typedef std::vector<std::shared_ptr<CPVRRecording>> Recordings;
+
+// iShows folders with iEpisodes recordings each, every other one watched
+Recordings CreateRecordings(int iShows, int iEpisodes)
+{
+  Recordings recordings;
+  recordings.reserve(iShows * iEpisodes);
+  for (int i = 0; i < iEpisodes; ++i)
+  {
+    for (int j = 0; j < iShows; ++j)
+    {
+      const std::shared_ptr<CPVRRecording> recording = std::make_shared<CPVRRecording>();
+      recording->m_strTitle = "Episode " + std::to_string(i);
+      recording->m_strDirectory = "/Show " + std::to_string(j) + "/";
+      recording->m_strFileNameAndPath = "pvr://recordings/tv/active/Show " + std::to_string(j) +
+                                        "/Episode " + std::to_string(i) + ".pvr";
+      recording->SetLocalPlayCount((i + j) % 2);
+      recordings.emplace_back(recording);
+    }
+  }
+  return recordings;
+}
+} // unnamed namespace
+
+TEST(TestPVRGUIDirectory, GroupedRecordings)
+{
+  Recordings recordings = CreateRecordings(3, 4);
+  // a show with all recordings watched
+  recordings.emplace_back(std::make_shared<CPVRRecording>());
+  recordings.back()->m_strDirectory = "Watched";
+  recordings.back()->SetLocalPlayCount(1);
+
+  CFileItemList results;
+  CPVRGUIDirectory::GetRecordingsDirectory(CPVRRecordingsPath("pvr://recordings/tv/active/"), true, recordings, results);
+  ASSERT_EQ(4, results.Size());
+  for (int i = 0; i < results.Size(); ++i)
+  {
+    EXPECT_TRUE(results.Get(i)->m_bIsFolder);
+    EXPECT_EQ(i < 3 ? "OverlayUnwatched.png" : "OverlayWatched.png", results.Get(i)->GetOverlayImage());
+  }
+  EXPECT_EQ("Show 0", results.Get(0)->GetLabel());
+  EXPECT_EQ("pvr://recordings/tv/active/Show%200/", results.Get(0)->GetPath());
+
+  results.Clear();
+  CPVRGUIDirectory::GetRecordingsDirectory(CPVRRecordingsPath("pvr://recordings/tv/active/Show%201/"), true, recordings, results);
+  ASSERT_EQ(4, results.Size());
+  EXPECT_FALSE(results.Get(0)->m_bIsFolder);
+  EXPECT_EQ("Episode 0", results.Get(0)->GetLabel());
+  EXPECT_EQ("OverlayWatched.png", results.Get(0)->GetOverlayImage());
+  EXPECT_EQ("OverlayUnwatched.png", results.Get(1)->GetOverlayImage());
+
+  results.Clear();
+  CPVRGUIDirectory::GetRecordingsDirectory(CPVRRecordingsPath("pvr://recordings/tv/active/"), false, recordings, results);
+  EXPECT_EQ(13, results.Size());
+}
+
+TEST(TestPVRGUIDirectory, Benchmark)
+{
+  const Recordings recordings = CreateRecordings(500, 100);
+  const CPVRRecordingsPath recPath("pvr://recordings/tv/active/");
+
+  CFileItemList grouped;
+  CTestStopwatch stopwatch;
+  CPVRGUIDirectory::GetRecordingsDirectory(recPath, true, recordings, grouped);
+  const int64_t groupedTime = stopwatch.Lap();
+  EXPECT_EQ(500, grouped.Size());
+
+  CFileItemList flat;
+  stopwatch.Lap();
+  CPVRGUIDirectory::GetRecordingsDirectory(recPath, false, recordings, flat);
+  const int64_t flatTime = stopwatch.Lap();
+  EXPECT_EQ(50000, flat.Size());
+
+  RecordProperty("recordings", static_cast<int>(recordings.size()));
+  RecordProperty("grouped_us", static_cast<int>(groupedTime));
+  RecordProperty("flat_us", static_cast<int>(flatTime));
+  RecordProperty("flat_items_per_s", static_cast<int>(flat.Size() * 1000000LL / std::max<int64_t>(flatTime, 1)));
+}
@@ -2270,6 +2270,10 @@ void CGUIEPGGridContainer::HandleProgrammeGrid(bool bRender, unsigned int curren
 
   if (bRender)
     CServiceBroker::GetWinSystem()->GetGfxContext().SetClipRegion(m_gridPosX, m_gridPosY, m_gridWidth, m_gridHeight);
+  else
+    // prepare the channels on screen plus a page of channels on each side, ahead of scrolling
+    m_gridModel->PrefetchGridItems(chanOffset - cacheBeforeProgramme - m_channelsPerPage,
+                                   chanOffset + 2 * m_channelsPerPage + cacheAfterProgramme);
 
   CPoint originProgramme = CPoint(m_gridPosX, m_gridPosY) + m_renderOffset;
   float posA;
@@ -16,9 +16,13 @@
 #include "pvr/epg/Epg.h"
 #include "pvr/epg/EpgChannelData.h"
 #include "pvr/epg/EpgInfoTag.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+#include "utils/JobManager.h"
 #include "utils/Variant.h"
 #include "utils/log.h"
 
+#include <algorithm>
 #include <cmath>
 #include <memory>
 #include <vector>
@@ -26,20 +30,44 @@
 using namespace PVR;
 
 static const unsigned int GRID_START_PADDING = 30; // minutes
+static const size_t MIN_CACHED_GRID_ROWS = 64; // channels
+
+CGUIEPGGridContainerModel::CGUIEPGGridContainerModel()
+  : m_data(std::make_shared<GridData>())
+{
+}
+
+CGUIEPGGridContainerModel::CGUIEPGGridContainerModel(const CGUIEPGGridContainerModel& other)
+  : m_gridStart(other.m_gridStart),
+    m_gridEnd(other.m_gridEnd),
+    m_rulerItems(other.m_rulerItems),
+    m_data(std::make_shared<GridData>()),
+    m_blocks(other.m_blocks)
+{
+  // the grid items are not copied, but created again on demand
+  m_data->gridStart = other.m_data->gridStart;
+  m_data->gridEnd = other.m_data->gridEnd;
+  m_data->blocks = other.m_data->blocks;
+  m_data->fBlockSize = other.m_data->fBlockSize;
+  m_data->programmeItems = other.m_data->programmeItems;
+  m_data->channelItems = other.m_data->channelItems;
+  m_data->epgItemsPtr = other.m_data->epgItemsPtr;
+  m_data->rows.resize(m_data->channelItems.size());
+}
 
 void CGUIEPGGridContainerModel::SetInvalid()
 {
-  for (const auto& programme : m_programmeItems)
+  for (const auto& programme : m_data->programmeItems)
     programme->SetInvalid();
-  for (const auto& channel : m_channelItems)
+  for (const auto& channel : m_data->channelItems)
     channel->SetInvalid();
   for (const auto& ruler : m_rulerItems)
     ruler->SetInvalid();
 }
 
-std::shared_ptr<CFileItem> CGUIEPGGridContainerModel::CreateGapItem(int iChannel) const
+std::shared_ptr<CFileItem> CGUIEPGGridContainerModel::GridData::CreateGapItem(int iChannel) const
 {
-  const std::shared_ptr<CPVRChannel> channel = m_channelItems[iChannel]->GetPVRChannelInfoTag();
+  const std::shared_ptr<CPVRChannel> channel = channelItems[iChannel]->GetPVRChannelInfoTag();
 
   std::shared_ptr<CPVREpgInfoTag> gapTag;
   const std::shared_ptr<CPVREpg> epg = channel->GetEPG();
@@ -53,7 +81,7 @@ std::shared_ptr<CFileItem> CGUIEPGGridContainerModel::CreateGapItem(int iChannel
 
 void CGUIEPGGridContainerModel::Initialize(const std::unique_ptr<CFileItemList>& items, const CDateTime& gridStart, const CDateTime& gridEnd, int iRulerUnit, int iBlocksPerPage, float fBlockSize)
 {
-  if (!m_channelItems.empty())
+  if (!m_data->channelItems.empty())
   {
     CLog::LogF(LOGERROR, "Already initialized!");
     return;
@@ -61,11 +89,15 @@ void CGUIEPGGridContainerModel::Initialize(const std::unique_ptr<CFileItemList>&
 
   ////////////////////////////////////////////////////////////////////////
   // Create programme & channel items
-  m_programmeItems.reserve(items->Size());
+  std::vector<std::shared_ptr<CFileItem>>& programmeItems = m_data->programmeItems;
+  std::vector<std::shared_ptr<CFileItem>>& channelItems = m_data->channelItems;
+  std::vector<GridData::ItemsPtr>& epgItemsPtr = m_data->epgItemsPtr;
+
+  programmeItems.reserve(items->Size());
   CFileItemPtr fileItem;
   int iLastChannelUID = -1;
   int iLastClientUID = -1;
-  ItemsPtr itemsPointer;
+  GridData::ItemsPtr itemsPointer;
   itemsPointer.start = 0;
   int j = 0;
   for (int i = 0; i < items->Size(); ++i)
@@ -74,7 +106,8 @@ void CGUIEPGGridContainerModel::Initialize(const std::unique_ptr<CFileItemList>&
     if (!fileItem->HasEPGInfoTag())
       continue;
 
-    m_programmeItems.emplace_back(fileItem);
+    programmeItems.emplace_back(fileItem);
+    fileItem->SetProperty("GenreType", fileItem->GetEPGInfoTag()->GenreType());
 
     int iCurrentChannelUID = fileItem->GetEPGInfoTag()->UniqueChannelID();
     int iCurrentClientUID = fileItem->GetEPGInfoTag()->ClientID();
@@ -90,17 +123,17 @@ void CGUIEPGGridContainerModel::Initialize(const std::unique_ptr<CFileItemList>&
       if (j > 0)
       {
         itemsPointer.stop = j - 1;
-        m_epgItemsPtr.emplace_back(itemsPointer);
+        epgItemsPtr.emplace_back(itemsPointer);
         itemsPointer.start = j;
       }
-      m_channelItems.emplace_back(CFileItemPtr(new CFileItem(channel)));
+      channelItems.emplace_back(CFileItemPtr(new CFileItem(channel)));
     }
     ++j;
   }
-  if (!m_programmeItems.empty())
+  if (!programmeItems.empty())
   {
-    itemsPointer.stop = m_programmeItems.size() - 1;
-    m_epgItemsPtr.emplace_back(itemsPointer);
+    itemsPointer.stop = programmeItems.size() - 1;
+    epgItemsPtr.emplace_back(itemsPointer);
   }
 
   /* check for invalid start and end time */
@@ -148,7 +181,6 @@ void CGUIEPGGridContainerModel::Initialize(const std::unique_ptr<CFileItemList>&
 
   ////////////////////////////////////////////////////////////////////////
   // Create epg grid
-  const CDateTimeSpan blockDuration(0, 0, MINSPERBLOCK, 0);
   const CDateTimeSpan gridDuration(m_gridEnd - m_gridStart);
   m_blocks = (gridDuration.GetDays() * 24 * 60 + gridDuration.GetHours() * 60 + gridDuration.GetMinutes()) / MINSPERBLOCK;
   if (m_blocks >= MAXBLOCKS)
@@ -156,106 +188,166 @@ void CGUIEPGGridContainerModel::Initialize(const std::unique_ptr<CFileItemList>&
   else if (m_blocks < iBlocksPerPage)
     m_blocks = iBlocksPerPage;
 
-  m_gridIndex.reserve(m_channelItems.size());
-  const std::vector<GridItem> blocks(m_blocks);
+  // the grid items are created on demand, for the channels on screen and around them
+  m_data->gridStart = m_gridStart;
+  m_data->gridEnd = m_gridEnd;
+  m_data->blocks = m_blocks;
+  m_data->fBlockSize = fBlockSize;
+  m_data->rows.resize(channelItems.size());
+}
 
-  for (size_t channel = 0; channel < m_channelItems.size(); ++channel)
+std::unique_ptr<CGUIEPGGridContainerModel::GridRow> CGUIEPGGridContainerModel::GridData::CreateRow(int iChannel) const
+{
+  const size_t channel = iChannel;
+  std::vector<GridItem> gridIndex(blocks);
+
+  CDateTime gridCursor(gridStart); //reset cursor for new channel
+  unsigned long progIdx = epgItemsPtr[channel].start;
+  unsigned long lastIdx = epgItemsPtr[channel].stop;
+  int iEpgId = programmeItems[progIdx]->GetEPGInfoTag()->EpgID();
+  int itemSize = 1; // size of the programme in blocks
+  int savedBlock = 0;
+  CFileItemPtr item;
+  std::shared_ptr<CPVREpgInfoTag> tag;
+  const CDateTimeSpan blockDuration(0, 0, MINSPERBLOCK, 0);
+
+  for (int block = 0; block < blocks; ++block)
   {
-    m_gridIndex.emplace_back(blocks);
+    while (progIdx <= lastIdx)
+    {
+      item = programmeItems[progIdx];
+      tag = item->GetEPGInfoTag();
 
-    CDateTime gridCursor(m_gridStart); //reset cursor for new channel
-    unsigned long progIdx = m_epgItemsPtr[channel].start;
-    unsigned long lastIdx = m_epgItemsPtr[channel].stop;
-    int iEpgId = m_programmeItems[progIdx]->GetEPGInfoTag()->EpgID();
-    int itemSize = 1; // size of the programme in blocks
-    int savedBlock = 0;
-    CFileItemPtr item;
-    std::shared_ptr<CPVREpgInfoTag> tag;
+      // Note: Start block of an event is start-time-based calculated block + 1,
+      //       unless start times matches exactly the begin of a block.
 
-    for (int block = 0; block < m_blocks; ++block)
-    {
-      while (progIdx <= lastIdx)
+      if (tag->EpgID() != iEpgId || gridCursor < tag->StartAsUTC() || gridEnd <= tag->StartAsUTC())
+        break;
+
+      if (gridCursor < tag->EndAsUTC())
       {
-        item = m_programmeItems[progIdx];
-        tag = item->GetEPGInfoTag();
+        gridIndex[block].item = item;
+        gridIndex[block].progIndex = progIdx;
+        break;
+      }
 
-        // Note: Start block of an event is start-time-based calculated block + 1,
-        //       unless start times matches exactly the begin of a block.
+      progIdx++;
+    }
 
-        if (tag->EpgID() != iEpgId || gridCursor < tag->StartAsUTC() || m_gridEnd <= tag->StartAsUTC())
-          break;
+    gridCursor += blockDuration;
 
-        if (gridCursor < tag->EndAsUTC())
-        {
-          m_gridIndex[channel][block].item = item;
-          m_gridIndex[channel][block].progIndex = progIdx;
-          break;
-        }
+    if (block == 0)
+      continue;
 
-        progIdx++;
+    const CFileItemPtr prevItem(gridIndex[block - 1].item);
+    const CFileItemPtr currItem(gridIndex[block].item);
+
+    if (block == blocks - 1 || prevItem != currItem)
+    {
+      // special handling for last block.
+      int blockDelta = -1;
+      int sizeDelta = 0;
+      if (block == blocks - 1 && prevItem == currItem)
+      {
+        itemSize++;
+        blockDelta = 0;
+        sizeDelta = 1;
       }
 
-      gridCursor += blockDuration;
+      if (!prevItem)
+      {
+        const std::shared_ptr<CFileItem> gapItem = CreateGapItem(channel);
+        for (int i = block + blockDelta; i >= block - itemSize + sizeDelta; --i)
+        {
+          gridIndex[i].item = gapItem;
+        }
+      }
 
-      if (block == 0)
-        continue;
+      float fItemWidth = itemSize * fBlockSize;
+      gridIndex[savedBlock].originWidth = fItemWidth;
+      gridIndex[savedBlock].width = fItemWidth;
 
-      const CFileItemPtr prevItem(m_gridIndex[channel][block - 1].item);
-      const CFileItemPtr currItem(m_gridIndex[channel][block].item);
+      itemSize = 1;
+      savedBlock = block;
 
-      if (block == m_blocks - 1 || prevItem != currItem)
+      // special handling for last block.
+      if (block == blocks - 1 && prevItem != currItem)
       {
-        // special handling for last block.
-        int blockDelta = -1;
-        int sizeDelta = 0;
-        if (block == m_blocks - 1 && prevItem == currItem)
-        {
-          itemSize++;
-          blockDelta = 0;
-          sizeDelta = 1;
-        }
+        if (!currItem)
+          gridIndex[block].item = CreateGapItem(channel);
 
-        if (prevItem)
-        {
-          m_gridIndex[channel][savedBlock].item->SetProperty("GenreType", prevItem->GetEPGInfoTag()->GenreType());
-        }
-        else
-        {
-          const std::shared_ptr<CFileItem> gapItem = CreateGapItem(channel);
-          for (int i = block + blockDelta; i >= block - itemSize + sizeDelta; --i)
-          {
-            m_gridIndex[channel][i].item = gapItem;
-          }
-        }
+        gridIndex[savedBlock].originWidth = fBlockSize; // size always 1 block here
+        gridIndex[savedBlock].width = fBlockSize;
+      }
+    }
+    else
+    {
+      itemSize++;
+    }
+  }
+
+  // keep one grid item per programme or gap instead of one per block
+  std::unique_ptr<GridRow> row(new GridRow);
+  for (int block = 0; block < blocks; ++block)
+  {
+    if (block == 0 || gridIndex[block].item != gridIndex[block - 1].item)
+    {
+      row->firstBlocks.emplace_back(block);
+      row->items.emplace_back(gridIndex[block]);
+    }
+  }
+  return row;
+}
 
-        float fItemWidth = itemSize * fBlockSize;
-        m_gridIndex[channel][savedBlock].originWidth = fItemWidth;
-        m_gridIndex[channel][savedBlock].width = fItemWidth;
+CGUIEPGGridContainerModel::GridRow* CGUIEPGGridContainerModel::GridData::GetRow(int iChannel)
+{
+  CSingleLock lock(critSection);
 
-        itemSize = 1;
-        savedBlock = block;
+  std::unique_ptr<GridRow>& row = rows[iChannel];
+  if (!row)
+  {
+    row = CreateRow(iChannel);
+    iRows++;
+  }
 
-        // special handling for last block.
-        if (block == m_blocks - 1 && prevItem != currItem)
-        {
-          if (currItem)
-          {
-            m_gridIndex[channel][savedBlock].item->SetProperty("GenreType", currItem->GetEPGInfoTag()->GenreType());
-          }
-          else
-          {
-            m_gridIndex[channel][block].item = CreateGapItem(channel);
-          }
+  row->iLastUsed = ++iUseCounter;
+  return row.get();
+}
 
-          m_gridIndex[channel][savedBlock].originWidth = fBlockSize; // size always 1 block here
-          m_gridIndex[channel][savedBlock].width = fBlockSize;
+void CGUIEPGGridContainerModel::GridData::Prefetch()
+{
+  while (true)
+  {
+    // follow the channels to keep, they change while the user scrolls
+    int iChannel = INVALID_INDEX;
+    {
+      CSingleLock lock(critSection);
+      for (int i = iKeepStart; i <= iKeepEnd; ++i)
+      {
+        if (!rows[i])
+        {
+          iChannel = i;
+          break;
         }
       }
-      else
+
+      if (iChannel == INVALID_INDEX)
       {
-        itemSize++;
+        bPrefetching = false;
+        return;
       }
     }
+
+    // create the row without holding the lock, the grid may be rendered meanwhile
+    std::unique_ptr<GridRow> row = CreateRow(iChannel);
+
+    CSingleLock lock(critSection);
+    if (!rows[iChannel])
+    {
+      row->iLastUsed = iUseCounter;
+      rows[iChannel] = std::move(row);
+      iRows++;
+    }
   }
 }
 
@@ -268,7 +360,7 @@ void CGUIEPGGridContainerModel::FindChannelAndBlockIndex(int channelUid, unsigne
 
   // find the channel
   int iCurrentChannel = 0;
-  for (const auto& channel : m_channelItems)
+  for (const auto& channel : m_data->channelItems)
   {
     if (channel->GetPVRChannelInfoTag()->UniqueID() == channelUid)
     {
@@ -282,15 +374,15 @@ void CGUIEPGGridContainerModel::FindChannelAndBlockIndex(int channelUid, unsigne
   {
     // find the block
     CDateTime gridCursor(m_gridStart); //reset cursor for new channel
-    unsigned long progIdx = m_epgItemsPtr[newChannelIndex].start;
-    unsigned long lastIdx = m_epgItemsPtr[newChannelIndex].stop;
-    int iEpgId = m_programmeItems[progIdx]->GetEPGInfoTag()->EpgID();
+    unsigned long progIdx = m_data->epgItemsPtr[newChannelIndex].start;
+    unsigned long lastIdx = m_data->epgItemsPtr[newChannelIndex].stop;
+    int iEpgId = m_data->programmeItems[progIdx]->GetEPGInfoTag()->EpgID();
     std::shared_ptr<CPVREpgInfoTag> tag;
     for (int block = 0; block < m_blocks; ++block)
     {
       while (progIdx <= lastIdx)
       {
-        tag = m_programmeItems[progIdx]->GetEPGInfoTag();
+        tag = m_data->programmeItems[progIdx]->GetEPGInfoTag();
 
         if (tag->EpgID() != iEpgId || gridCursor < tag->StartAsUTC() || m_gridEnd <= tag->StartAsUTC())
           break; // next block
@@ -327,15 +419,15 @@ void CGUIEPGGridContainerModel::FreeChannelMemory(int keepStart, int keepEnd)
   {
     // remove before keepStart and after keepEnd
     for (int i = 0; i < keepStart && i < ChannelItemsSize(); ++i)
-      m_channelItems[i]->FreeMemory();
+      m_data->channelItems[i]->FreeMemory();
     for (int i = keepEnd + 1; i < ChannelItemsSize(); ++i)
-      m_channelItems[i]->FreeMemory();
+      m_data->channelItems[i]->FreeMemory();
   }
   else
   {
     // wrapping
     for (int i = keepEnd + 1; i < keepStart && i < ChannelItemsSize(); ++i)
-      m_channelItems[i]->FreeMemory();
+      m_data->channelItems[i]->FreeMemory();
   }
 }
 
@@ -343,41 +435,83 @@ void CGUIEPGGridContainerModel::FreeProgrammeMemory(int channel, int keepStart,
 {
   if (keepStart < keepEnd)
   {
+    CSingleLock lock(m_data->critSection);
+
+    // nothing to free if the grid items of the channel weren't created (yet)
+    const GridRow* row = m_data->rows[channel].get();
+    if (!row)
+      return;
+
     // remove before keepStart and after keepEnd
-    if (keepStart > 0 && keepStart < m_blocks)
+    // FreeMemory() is smart enough to not cause any problems when called multiple times on same item
+    // but skip the items that are partially visible
+    for (size_t i = 0; i < row->items.size(); ++i)
     {
-      // if item exist and block is not part of visible item
-      std::shared_ptr<CGUIListItem> last = m_gridIndex[channel][keepStart].item;
-      for (int i = keepStart - 1; i > 0; --i)
-      {
-        if (m_gridIndex[channel][i].item && m_gridIndex[channel][i].item != last)
-        {
-          m_gridIndex[channel][i].item->FreeMemory();
-          // FreeMemory() is smart enough to not cause any problems when called multiple times on same item
-          // but we can make use of condition needed to not call FreeMemory() on item that is partially visible
-          // to avoid calling FreeMemory() multiple times on item that occupy few blocks in a row
-          last = m_gridIndex[channel][i].item;
-        }
-      }
+      const int firstBlock = row->firstBlocks[i];
+      const int lastBlock = i + 1 < row->items.size() ? row->firstBlocks[i + 1] - 1 : m_blocks - 1;
+      if (!row->items[i].item || lastBlock <= 0 || (lastBlock >= keepStart && firstBlock <= keepEnd))
+        continue;
+
+      row->items[i].item->FreeMemory();
     }
+  }
+}
+
+void CGUIEPGGridContainerModel::PrefetchGridItems(int firstChannel, int lastChannel)
+{
+  const std::shared_ptr<GridData> data = m_data;
+  firstChannel = std::max(firstChannel, 0);
+  lastChannel = std::min(lastChannel, static_cast<int>(data->rows.size()) - 1);
+  if (firstChannel > lastChannel)
+    return;
+
+  std::vector<std::unique_ptr<GridRow>> droppedRows;
+  bool bStartPrefetch = false;
+  {
+    CSingleLock lock(data->critSection);
+
+    if (data->iKeepStart == firstChannel && data->iKeepEnd == lastChannel)
+      return;
 
-    if (keepEnd > 0 && keepEnd < m_blocks)
+    data->iKeepStart = firstChannel;
+    data->iKeepEnd = lastChannel;
+
+    // drop the grid items of the channels not used for the longest time, but keep the ones around the screen
+    const size_t iMaxRows = std::max(MIN_CACHED_GRID_ROWS, static_cast<size_t>(lastChannel - firstChannel + 1) * 2);
+    while (data->iRows > iMaxRows)
     {
-      std::shared_ptr<CGUIListItem> last = m_gridIndex[channel][keepEnd].item;
-      for (int i = keepEnd + 1; i < m_blocks; ++i)
+      int iOldest = INVALID_INDEX;
+      for (int i = 0; i < static_cast<int>(data->rows.size()); ++i)
       {
-        // if item exist and block is not part of visible item
-        if (m_gridIndex[channel][i].item && m_gridIndex[channel][i].item != last)
-        {
-          m_gridIndex[channel][i].item->FreeMemory();
-          // FreeMemory() is smart enough to not cause any problems when called multiple times on same item
-          // but we can make use of condition needed to not call FreeMemory() on item that is partially visible
-          // to avoid calling FreeMemory() multiple times on item that occupy few blocks in a row
-          last = m_gridIndex[channel][i].item;
-        }
+        if (data->rows[i] && (i < firstChannel || i > lastChannel) &&
+            (iOldest == INVALID_INDEX || data->rows[i]->iLastUsed < data->rows[iOldest]->iLastUsed))
+          iOldest = i;
       }
+
+      if (iOldest == INVALID_INDEX)
+        break;
+
+      droppedRows.emplace_back(std::move(data->rows[iOldest]));
+      data->iRows--;
     }
+
+    // a running prefetch job picks up the new channels
+    bStartPrefetch = !data->bPrefetching;
+    data->bPrefetching = true;
   }
+
+  // the dropped items are not on screen, release their layouts on this (the gui) thread
+  for (const auto& row : droppedRows)
+  {
+    for (const auto& gridItem : row->items)
+    {
+      if (gridItem.item)
+        gridItem.item->FreeMemory();
+    }
+  }
+
+  if (bStartPrefetch)
+    CJobManager::GetInstance().Submit([data]() { data->Prefetch(); });
 }
 
 void CGUIEPGGridContainerModel::FreeRulerMemory(int keepStart, int keepEnd)
@@ -405,14 +539,111 @@ void CGUIEPGGridContainerModel::FreeRulerMemory(int keepStart, int keepEnd)
 
 void CGUIEPGGridContainerModel::FreeItemsMemory()
 {
-  for (const auto& programme : m_programmeItems)
+  for (const auto& programme : m_data->programmeItems)
     programme->FreeMemory();
-  for (const auto& channel : m_channelItems)
+  for (const auto& channel : m_data->channelItems)
     channel->FreeMemory();
   for (const auto& ruler : m_rulerItems)
     ruler->FreeMemory();
 }
 
+std::shared_ptr<CFileItem> CGUIEPGGridContainerModel::GetProgrammeItem(int iIndex) const
+{
+  return m_data->programmeItems[iIndex];
+}
+
+bool CGUIEPGGridContainerModel::HasProgrammeItems() const
+{
+  return !m_data->programmeItems.empty();
+}
+
+int CGUIEPGGridContainerModel::ProgrammeItemsSize() const
+{
+  return static_cast<int>(m_data->programmeItems.size());
+}
+
+std::shared_ptr<CFileItem> CGUIEPGGridContainerModel::GetChannelItem(int iIndex) const
+{
+  return m_data->channelItems[iIndex];
+}
+
+bool CGUIEPGGridContainerModel::HasChannelItems() const
+{
+  return !m_data->channelItems.empty();
+}
+
+int CGUIEPGGridContainerModel::ChannelItemsSize() const
+{
+  return static_cast<int>(m_data->channelItems.size());
+}
+
+bool CGUIEPGGridContainerModel::HasGridItems() const
+{
+  return !m_data->rows.empty();
+}
+
+GridItem* CGUIEPGGridContainerModel::GetGridItemRun(int iChannel, int iBlock, bool& bFirstBlock) const
+{
+  GridRow* row = m_data->GetRow(iChannel);
+
+  const auto it = std::upper_bound(row->firstBlocks.begin(), row->firstBlocks.end(), iBlock);
+  if (it == row->firstBlocks.begin())
+    return nullptr;
+
+  const size_t index = std::distance(row->firstBlocks.begin(), it) - 1;
+  bFirstBlock = row->firstBlocks[index] == iBlock;
+  return &row->items[index];
+}
+
+GridItem* CGUIEPGGridContainerModel::GetGridItemPtr(int iChannel, int iBlock)
+{
+  // blocks after the first one of an item only share the item, the width is stored with the first
+  CSingleLock lock(m_data->critSection);
+  bool bFirstBlock = false;
+  return GetGridItemRun(iChannel, iBlock, bFirstBlock);
+}
+
+std::shared_ptr<CFileItem> CGUIEPGGridContainerModel::GetGridItem(int iChannel, int iBlock) const
+{
+  CSingleLock lock(m_data->critSection);
+  bool bFirstBlock = false;
+  const GridItem* gridItem = GetGridItemRun(iChannel, iBlock, bFirstBlock);
+  return gridItem ? gridItem->item : std::shared_ptr<CFileItem>();
+}
+
+float CGUIEPGGridContainerModel::GetGridItemWidth(int iChannel, int iBlock) const
+{
+  CSingleLock lock(m_data->critSection);
+  bool bFirstBlock = false;
+  const GridItem* gridItem = GetGridItemRun(iChannel, iBlock, bFirstBlock);
+  return gridItem && bFirstBlock ? gridItem->width : 0.0f;
+}
+
+float CGUIEPGGridContainerModel::GetGridItemOriginWidth(int iChannel, int iBlock) const
+{
+  CSingleLock lock(m_data->critSection);
+  bool bFirstBlock = false;
+  const GridItem* gridItem = GetGridItemRun(iChannel, iBlock, bFirstBlock);
+  return gridItem && bFirstBlock ? gridItem->originWidth : 0.0f;
+}
+
+int CGUIEPGGridContainerModel::GetGridItemIndex(int iChannel, int iBlock) const
+{
+  CSingleLock lock(m_data->critSection);
+  bool bFirstBlock = false;
+  const GridItem* gridItem = GetGridItemRun(iChannel, iBlock, bFirstBlock);
+  return gridItem ? gridItem->progIndex : -1;
+}
+
+void CGUIEPGGridContainerModel::SetGridItemWidth(int iChannel, int iBlock, float fWidth)
+{
+  CSingleLock lock(m_data->critSection);
+  bool bFirstBlock = false;
+  GridItem* gridItem = GetGridItemRun(iChannel, iBlock, bFirstBlock);
+  if (gridItem && bFirstBlock)
+    gridItem->width = fWidth;
+}
+
 unsigned int CGUIEPGGridContainerModel::GetPageNowOffset() const
 {
   return GetGridStartPadding() / MINSPERBLOCK; // this is the 'now' block relative to page start
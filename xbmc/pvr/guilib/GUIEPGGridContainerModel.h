@@ -9,12 +9,14 @@
 #pragma once
 
 #include "XBDateTime.h"
+#include "threads/CriticalSection.h"
 
 #include <memory>
 #include <vector>
 
 class CFileItem;
 class CFileItemList;
+class TestGUIEPGGridContainerModel;
 
 namespace PVR
 {
@@ -30,11 +32,14 @@ namespace PVR
 
   class CGUIEPGGridContainerModel
   {
+    friend class ::TestGUIEPGGridContainerModel;
+
   public:
     static const int MINSPERBLOCK = 5; // minutes
     static const int MAXBLOCKS = 33 * 24 * 60 / MINSPERBLOCK; //! 33 days of 5 minute blocks (31 days for upcoming data + 1 day for past data + 1 day for fillers)
 
-    CGUIEPGGridContainerModel() = default;
+    CGUIEPGGridContainerModel();
+    CGUIEPGGridContainerModel(const CGUIEPGGridContainerModel& other);
     virtual ~CGUIEPGGridContainerModel() = default;
 
     void Initialize(const std::unique_ptr<CFileItemList>& items, const CDateTime& gridStart, const CDateTime& gridEnd, int iRulerUnit, int iBlocksPerPage, float fBlockSize);
@@ -47,25 +52,33 @@ namespace PVR
     void FreeProgrammeMemory(int channel, int keepStart, int keepEnd);
     void FreeRulerMemory(int keepStart, int keepEnd);
 
-    std::shared_ptr<CFileItem> GetProgrammeItem(int iIndex) const { return m_programmeItems[iIndex]; }
-    bool HasProgrammeItems() const { return !m_programmeItems.empty(); }
-    int ProgrammeItemsSize() const { return static_cast<int>(m_programmeItems.size()); }
+    /*!
+     * @brief Prepare the grid items of the given channels in the background and drop the grid items
+     * of other channels not used recently.
+     * @param firstChannel The first channel to prepare, usually the first one on screen minus a margin.
+     * @param lastChannel The last channel to prepare, usually the last one on screen plus a margin.
+     */
+    void PrefetchGridItems(int firstChannel, int lastChannel);
+
+    std::shared_ptr<CFileItem> GetProgrammeItem(int iIndex) const;
+    bool HasProgrammeItems() const;
+    int ProgrammeItemsSize() const;
 
-    std::shared_ptr<CFileItem> GetChannelItem(int iIndex) const { return m_channelItems[iIndex]; }
-    bool HasChannelItems() const { return !m_channelItems.empty(); }
-    int ChannelItemsSize() const { return static_cast<int>(m_channelItems.size()); }
+    std::shared_ptr<CFileItem> GetChannelItem(int iIndex) const;
+    bool HasChannelItems() const;
+    int ChannelItemsSize() const;
 
     std::shared_ptr<CFileItem> GetRulerItem(int iIndex) const { return m_rulerItems[iIndex]; }
     int RulerItemsSize() const { return static_cast<int>(m_rulerItems.size()); }
 
     int GetBlockCount() const { return m_blocks; }
-    bool HasGridItems() const { return !m_gridIndex.empty(); }
-    GridItem* GetGridItemPtr(int iChannel, int iBlock) { return &m_gridIndex[iChannel][iBlock]; }
-    std::shared_ptr<CFileItem> GetGridItem(int iChannel, int iBlock) const { return m_gridIndex[iChannel][iBlock].item; }
-    float GetGridItemWidth(int iChannel, int iBlock) const { return m_gridIndex[iChannel][iBlock].width; }
-    float GetGridItemOriginWidth(int iChannel, int iBlock) const { return m_gridIndex[iChannel][iBlock].originWidth; }
-    int GetGridItemIndex(int iChannel, int iBlock) const { return m_gridIndex[iChannel][iBlock].progIndex; }
-    void SetGridItemWidth(int iChannel, int iBlock, float fWidth) { m_gridIndex[iChannel][iBlock].width = fWidth; }
+    bool HasGridItems() const;
+    GridItem* GetGridItemPtr(int iChannel, int iBlock);
+    std::shared_ptr<CFileItem> GetGridItem(int iChannel, int iBlock) const;
+    float GetGridItemWidth(int iChannel, int iBlock) const;
+    float GetGridItemOriginWidth(int iChannel, int iBlock) const;
+    int GetGridItemIndex(int iChannel, int iBlock) const;
+    void SetGridItemWidth(int iChannel, int iBlock, float fWidth);
 
     bool IsZeroGridDuration() const { return (m_gridEnd - m_gridStart) == CDateTimeSpan(0, 0, 0, 0); }
     const CDateTime& GetGridStart() const { return m_gridStart; }
@@ -82,22 +95,58 @@ namespace PVR
 
   private:
     void FreeItemsMemory();
-    std::shared_ptr<CFileItem> CreateGapItem(int iChannel) const;
 
-    struct ItemsPtr
+    struct GridRow
+    {
+      // the grid items of a channel, one per programme or gap, with the block each of them starts at
+      std::vector<int> firstBlocks;
+      std::vector<GridItem> items;
+      unsigned int iLastUsed = 0;
+    };
+
+    struct GridData
     {
-      long start;
-      long stop;
+      struct ItemsPtr
+      {
+        long start;
+        long stop;
+      };
+
+      std::shared_ptr<CFileItem> CreateGapItem(int iChannel) const;
+      std::unique_ptr<GridRow> CreateRow(int iChannel) const;
+      GridRow* GetRow(int iChannel);
+      void Prefetch();
+
+      // set by Initialize, not changed afterwards
+      CDateTime gridStart;
+      CDateTime gridEnd;
+      int blocks = 0;
+      float fBlockSize = 0.0f;
+      std::vector<std::shared_ptr<CFileItem>> programmeItems;
+      std::vector<std::shared_ptr<CFileItem>> channelItems;
+      std::vector<ItemsPtr> epgItemsPtr;
+
+      // the grid items, created on demand and by the prefetch jobs
+      CCriticalSection critSection;
+      std::vector<std::unique_ptr<GridRow>> rows;
+      size_t iRows = 0;
+      unsigned int iUseCounter = 0;
+      int iKeepStart = 0;
+      int iKeepEnd = -1;
+      bool bPrefetching = false;
     };
 
+    /*!
+     * @brief Get the grid item of the given channel and block, creating the grid items of the channel if needed.
+     * @return The grid item, or nullptr if the block isn't part of any item.
+     */
+    GridItem* GetGridItemRun(int iChannel, int iBlock, bool& bFirstBlock) const;
+
     CDateTime m_gridStart;
     CDateTime m_gridEnd;
 
-    std::vector<std::shared_ptr<CFileItem>> m_programmeItems;
-    std::vector<std::shared_ptr<CFileItem>> m_channelItems;
     std::vector<std::shared_ptr<CFileItem>> m_rulerItems;
-    std::vector<ItemsPtr> m_epgItemsPtr;
-    std::vector<std::vector<GridItem> > m_gridIndex;
+    std::shared_ptr<GridData> m_data; // shared with the prefetch jobs
 
     int m_blocks = 0;
   };
@@ -0,0 +1,185 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "FileItem.h"
+#include "addons/kodi-addon-dev-kit/include/kodi/xbmc_pvr_types.h"
+#include "guilib/GUIListItemLayout.h"
+#include "pvr/channels/PVRChannel.h"
+#include "pvr/epg/EpgInfoTag.h"
+#include "pvr/guilib/GUIEPGGridContainerModel.h"
+#include "threads/SingleLock.h"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace PVR;
+
+namespace
+{
+const int CHANNELS = 200;
+const int PROGRAMMES = 8; // per channel, each half an hour long
+const int BLOCKS_PER_PROGRAMME = 30 / CGUIEPGGridContainerModel::MINSPERBLOCK;
+const time_t GRID_START = 1577836800; // 2020-01-01 00:00 UTC
+
+std::shared_ptr<CFileItem> CreateProgramme(int iChannel, int iProgramme)
+{
+  EPG_TAG data = {};
+  data.iUniqueBroadcastId = iChannel * PROGRAMMES + iProgramme + 1;
+  data.iUniqueChannelId = iChannel + 1;
+  data.startTime = GRID_START + iProgramme * 1800;
+  data.endTime = data.startTime + 1800;
+  data.strTitle = "Programme";
+
+  // the pvr manager isn't available to the tests, so don't let CFileItem look up the channel
+  const std::shared_ptr<CFileItem> item = std::make_shared<CFileItem>();
+  item->SetEPGInfoTag(std::make_shared<CPVREpgInfoTag>(data, 1, nullptr, iChannel + 1));
+  return item;
+}
+} // unnamed namespace
+
+class TestGUIEPGGridContainerModel : public ::testing::Test
+{
+protected:
+  CGUIEPGGridContainerModel model;
+
+  void SetUp() override
+  {
+    // the grid Initialize() would create from the epg of CHANNELS channels without gaps
+    CGUIEPGGridContainerModel::GridData& data = *model.m_data;
+    for (int i = 0; i < CHANNELS; ++i)
+    {
+      data.epgItemsPtr.push_back({static_cast<long>(data.programmeItems.size()),
+                                  static_cast<long>(data.programmeItems.size() + PROGRAMMES - 1)});
+      for (int j = 0; j < PROGRAMMES; ++j)
+        data.programmeItems.emplace_back(CreateProgramme(i, j));
+      data.channelItems.emplace_back(std::make_shared<CFileItem>(std::make_shared<CPVRChannel>()));
+    }
+
+    data.gridStart = data.programmeItems.front()->GetEPGInfoTag()->StartAsUTC();
+    data.gridEnd = data.programmeItems.back()->GetEPGInfoTag()->EndAsUTC();
+    data.blocks = PROGRAMMES * BLOCKS_PER_PROGRAMME;
+    data.fBlockSize = 10.0f;
+    data.rows.resize(CHANNELS);
+
+    model.m_gridStart = data.gridStart;
+    model.m_gridEnd = data.gridEnd;
+    model.m_blocks = data.blocks;
+  }
+
+  void TearDown() override
+  {
+    EXPECT_TRUE(WaitForPrefetch());
+  }
+
+  bool HasRow(int iChannel)
+  {
+    CSingleLock lock(model.m_data->critSection);
+    return model.m_data->rows[iChannel] != nullptr;
+  }
+
+  void SetPrefetching(bool bPrefetching)
+  {
+    CSingleLock lock(model.m_data->critSection);
+    model.m_data->bPrefetching = bPrefetching;
+  }
+
+  bool WaitForPrefetch()
+  {
+    for (int i = 0; i < 500; ++i)
+    {
+      {
+        CSingleLock lock(model.m_data->critSection);
+        if (!model.m_data->bPrefetching)
+          return true;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+  }
+
+  // show the first iChannels channels one after the other, with a layout for each first programme
+  std::vector<std::shared_ptr<CFileItem>> ShowChannels(int iChannels)
+  {
+    std::vector<std::shared_ptr<CFileItem>> items;
+    for (int i = 0; i < iChannels; ++i)
+    {
+      const std::shared_ptr<CFileItem> item = model.GetGridItem(i, 0);
+      if (item)
+        item->SetLayout(CGUIListItemLayoutPtr(new CGUIListItemLayout()));
+      items.emplace_back(item);
+    }
+    return items;
+  }
+};
+
+TEST_F(TestGUIEPGGridContainerModel, GridItemsAreCreatedOnDemand)
+{
+  EXPECT_FALSE(HasRow(10));
+
+  const std::shared_ptr<CFileItem> item = model.GetGridItem(10, BLOCKS_PER_PROGRAMME + 1);
+  ASSERT_TRUE(item);
+  EXPECT_EQ(static_cast<unsigned int>(10 * PROGRAMMES + 2), item->GetEPGInfoTag()->UniqueBroadcastID());
+  EXPECT_EQ(BLOCKS_PER_PROGRAMME * 10.0f, model.GetGridItemWidth(10, BLOCKS_PER_PROGRAMME));
+  EXPECT_TRUE(HasRow(10));
+  EXPECT_FALSE(HasRow(11));
+}
+
+TEST_F(TestGUIEPGGridContainerModel, PrefetchCreatesRowsOfChannelsToKeep)
+{
+  model.PrefetchGridItems(20, 29);
+  ASSERT_TRUE(WaitForPrefetch());
+
+  for (int i = 20; i <= 29; ++i)
+    EXPECT_TRUE(HasRow(i)) << i;
+  EXPECT_FALSE(HasRow(19));
+  EXPECT_FALSE(HasRow(30));
+
+  EXPECT_EQ(model.GetProgrammeItem(25 * PROGRAMMES), model.GetGridItem(25, 0));
+}
+
+TEST_F(TestGUIEPGGridContainerModel, EvictsRowsNotUsedRecently)
+{
+  const std::vector<std::shared_ptr<CFileItem>> items = ShowChannels(100);
+  ASSERT_TRUE(items.front() && items.back());
+  ASSERT_TRUE(items.front()->GetLayout());
+
+  // 64 rows are kept at least, the channels shown first are dropped
+  model.PrefetchGridItems(150, 159);
+  for (int i = 0; i < 36; ++i)
+    EXPECT_FALSE(HasRow(i)) << i;
+  for (int i = 36; i < 100; ++i)
+    EXPECT_TRUE(HasRow(i)) << i;
+
+  EXPECT_EQ(nullptr, items.front()->GetLayout());
+  EXPECT_NE(nullptr, items.back()->GetLayout());
+
+  ASSERT_TRUE(WaitForPrefetch());
+  for (int i = 150; i <= 159; ++i)
+    EXPECT_TRUE(HasRow(i)) << i;
+}
+
+TEST_F(TestGUIEPGGridContainerModel, EvictsRowsWhilePrefetching)
+{
+  const std::vector<std::shared_ptr<CFileItem>> items = ShowChannels(100);
+  ASSERT_TRUE(items.front() && items.back());
+
+  // the running prefetch job picks up the new channels, no other job is started
+  SetPrefetching(true);
+  model.PrefetchGridItems(150, 159);
+
+  EXPECT_FALSE(HasRow(0));
+  EXPECT_FALSE(HasRow(150));
+  EXPECT_EQ(nullptr, items.front()->GetLayout());
+  EXPECT_NE(nullptr, items.back()->GetLayout());
+
+  SetPrefetching(false);
+}
@@ -13,6 +13,8 @@
 #include "pvr/timers/PVRTimerInfoTag.h"
 #include "utils/RegExp.h"
 
+#include <algorithm>
+
 using namespace PVR;
 
 CPVRTimerRuleMatcher::CPVRTimerRuleMatcher(const std::shared_ptr<CPVRTimerInfoTag>& timerRule, const CDateTime& start)
@@ -80,6 +82,23 @@ bool CPVRTimerRuleMatcher::Matches(const std::shared_ptr<CPVREpgInfoTag>& epgTag
          MatchSearchText(epgTag);
 }
 
+bool CPVRTimerRuleMatcher::GetSearchText(std::string& strText) const
+{
+  if (!m_timerRule->GetTimerType()->SupportsEpgFulltextMatch() &&
+      !m_timerRule->GetTimerType()->SupportsEpgTitleMatch())
+    return false;
+
+  // search strings are regular expressions; only plain ascii ones are searched for as they are
+  const std::string& strSearch = m_timerRule->m_strEpgSearchString;
+  if (strSearch.empty() ||
+      strSearch.find_first_of("\\^$.|?*+()[]{}") != std::string::npos ||
+      std::any_of(strSearch.begin(), strSearch.end(), [](char c) { return c & 0x80; }))
+    return false;
+
+  strText = strSearch;
+  return true;
+}
+
 bool CPVRTimerRuleMatcher::MatchSeriesLink(const std::shared_ptr<CPVREpgInfoTag>& epgTag) const
 {
   if (m_timerRule->GetTimerType()->RequiresEpgSeriesLinkOnCreate())
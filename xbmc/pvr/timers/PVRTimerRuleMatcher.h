@@ -11,6 +11,7 @@
 #include "XBDateTime.h"
 
 #include <memory>
+#include <string>
 
 class CRegExp;
 
@@ -32,6 +33,13 @@ namespace PVR
     CDateTime GetNextTimerStart() const;
     bool Matches(const std::shared_ptr<CPVREpgInfoTag>& epgTag) const;
 
+    /*!
+     * @brief Get the text an EPG tag has to contain to match this rule.
+     * @param strText The text.
+     * @return True if the rule searches for a plain text, false if it matches any text or a pattern.
+     */
+    bool GetSearchText(std::string& strText) const;
+
   private:
     bool MatchSeriesLink(const std::shared_ptr<CPVREpgInfoTag>& epgTag) const;
     bool MatchChannel(const std::shared_ptr<CPVREpgInfoTag>& epgTag) const;
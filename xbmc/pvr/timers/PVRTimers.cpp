@@ -400,16 +400,18 @@ namespace
     }
     else
     {
-      // match any channel
-      const std::vector<std::shared_ptr<CPVREpg>> epgs = CServiceBroker::GetPVRManager().EpgContainer().GetAllEpgs();
-      for (const auto& epg : epgs)
+      // match any channel, checking only the tags containing the search text if there is one
+      std::vector<std::string> searchTexts;
+      std::string strSearchText;
+      if (matcher.GetSearchText(strSearchText))
+        searchTexts.emplace_back(strSearchText);
+
+      const std::vector<std::shared_ptr<CPVREpgInfoTag>> tags =
+        CServiceBroker::GetPVRManager().EpgContainer().GetTagsContaining(searchTexts, {});
+      for (const auto& tag : tags)
       {
-        std::vector<std::shared_ptr<CPVREpgInfoTag>> tags = epg->GetTags();
-        for (const auto& tag : tags)
-        {
-          if (matcher.Matches(tag))
-            matches.emplace_back(tag);
-        }
+        if (matcher.Matches(tag))
+          matches.emplace_back(tag);
       }
     }
 
@@ -29,7 +29,6 @@
 #include "utils/URIUtils.h"
 #include "utils/Variant.h"
 
-#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -61,17 +60,7 @@ namespace
 
   void AsyncSearchAction::Run()
   {
-    std::vector<std::shared_ptr<CPVREpgInfoTag>> results = CServiceBroker::GetPVRManager().EpgContainer().GetAllTags();
-    for (auto it = results.begin(); it != results.end();)
-    {
-      it = results.erase(std::remove_if(results.begin(),
-                                        results.end(),
-                                        [this](const std::shared_ptr<CPVREpgInfoTag>& entry)
-                                        {
-                                          return !m_filter->FilterEntry(entry);
-                                        }),
-                         results.end());
-    }
+    std::vector<std::shared_ptr<CPVREpgInfoTag>> results = CServiceBroker::GetPVRManager().EpgContainer().GetTags(*m_filter);
 
     if (m_filter->ShouldRemoveDuplicates())
       m_filter->RemoveDuplicates(results);
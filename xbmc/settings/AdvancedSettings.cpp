@@ -274,6 +274,9 @@ void CAdvancedSettings::Initialize()
 
   m_bHTTPDirectoryStatFilesize = false;
 
+  m_webserverThreadPoolSize = 0;
+  m_webserverConnectionTimeout = 60 * 60 * 24;
+
   m_bFTPThumbs = false;
 
   m_musicThumbs = "folder.jpg|Folder.jpg|folder.JPG|Folder.JPG|cover.jpg|Cover.jpg|cover.jpeg|thumb.jpg|Thumb.jpg|thumb.JPG|Thumb.JPG";
@@ -301,6 +304,11 @@ void CAdvancedSettings::Initialize()
   m_bVideoScannerIgnoreErrors = false;
   m_iVideoLibraryDateAdded = 1; // prefer mtime over ctime and current time
 
+  m_videoThumbExtractionConcurrency = 2;
+  m_videoThumbExtractionMaxCPUPercent = 50;
+  m_videoThumbExtractionBatchSize = 8;
+  m_videoThumbExtractionStripFrames = 0;
+
   m_videoEpisodeExtraArt = {};
   m_videoTvShowExtraArt = {};
   m_videoTvSeasonExtraArt = {};
@@ -344,6 +352,7 @@ void CAdvancedSettings::Initialize()
   m_curlconnecttimeout = 30;
   m_curllowspeedtime = 20;
   m_curlretries = 2;
+  m_curlMaxHostConnections = 8;
   m_curlDisableIPV6 = false;      //Certain hardware/OS combinations have trouble
                                   //with ipv6.
   m_curlDisableHTTP2 = false;
@@ -379,6 +388,7 @@ void CAdvancedSettings::Initialize()
   m_bPVRAutoScanIconsUserSet       = false;
   m_iPVRNumericChannelSwitchTimeout = 2000;
   m_iPVRTimeshiftThreshold = 10;
+  m_iPVRClientTimeout = 60000;
   m_bPVRTimeshiftSimpleOSD = true;
 
   m_cacheMemSize = 1024 * 1024 * 20;
@@ -403,6 +413,9 @@ void CAdvancedSettings::Initialize()
 
   m_databaseMusic.Reset();
   m_databaseVideo.Reset();
+  m_databaseStatsEnabled = false;
+  m_databaseSlowQueryThreshold = 0;
+  m_databaseStatsLogInterval = 0;
 
   m_pictureExtensions = ".png|.jpg|.jpeg|.bmp|.gif|.ico|.tif|.tiff|.tga|.pcx|.cbz|.zip|.rss|.webp|.jp2|.apng";
   m_musicExtensions = ".nsv|.m4a|.flac|.aac|.strm|.pls|.rm|.rma|.mpa|.wav|.wma|.ogg|.mp3|.mp2|.m3u|.gdm|.imf|.m15|.sfx|.uni|.ac3|.dts|.cue|.aif|.aiff|.wpl|.xspf|.ape|.mac|.mpc|.mp+|.mpp|.shn|.zip|.wv|.dsp|.xsp|.xwav|.waa|.wvs|.wam|.gcm|.idsp|.mpdsp|.mss|.spt|.rsd|.sap|.cmc|.cmr|.dmc|.mpt|.mpd|.rmt|.tmc|.tm8|.tm2|.oga|.url|.pxml|.tta|.rss|.wtv|.mka|.tak|.opus|.dff|.dsf|.m4b|.dtshd";
@@ -785,6 +798,15 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     SetExtraArtwork(pElement->FirstChildElement("movieextraart"), m_videoMovieExtraArt);
     SetExtraArtwork(pElement->FirstChildElement("moviesetextraart"), m_videoMovieSetExtraArt);
     SetExtraArtwork(pElement->FirstChildElement("musicvideoextraart"), m_videoMusicVideoExtraArt);
+
+    TiXmlElement* pThumbExtraction = pElement->FirstChildElement("thumbextraction");
+    if (pThumbExtraction)
+    {
+      XMLUtils::GetUInt(pThumbExtraction, "concurrency", m_videoThumbExtractionConcurrency, 1, 16);
+      XMLUtils::GetUInt(pThumbExtraction, "maxcpupercent", m_videoThumbExtractionMaxCPUPercent, 1, 100);
+      XMLUtils::GetUInt(pThumbExtraction, "batchsize", m_videoThumbExtractionBatchSize, 1, 100);
+      XMLUtils::GetUInt(pThumbExtraction, "stripframes", m_videoThumbExtractionStripFrames, 0, 20);
+    }
   }
 
   pElement = pRootElement->FirstChildElement("videoscanner");
@@ -813,6 +835,7 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetInt(pElement, "curlclienttimeout", m_curlconnecttimeout, 1, 1000);
     XMLUtils::GetInt(pElement, "curllowspeedtime", m_curllowspeedtime, 1, 1000);
     XMLUtils::GetInt(pElement, "curlretries", m_curlretries, 0, 10);
+    XMLUtils::GetInt(pElement, "curlmaxhostconnections", m_curlMaxHostConnections, 0, 64);
     XMLUtils::GetBoolean(pElement, "disableipv6", m_curlDisableIPV6);
     XMLUtils::GetBoolean(pElement, "disablehttp2", m_curlDisableHTTP2);
   }
@@ -844,6 +867,14 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
   if (pElement)
     XMLUtils::GetBoolean(pElement, "statfilesize", m_bHTTPDirectoryStatFilesize);
 
+  pElement = pRootElement->FirstChildElement("webserver");
+  if (pElement)
+  {
+    XMLUtils::GetUInt(pElement, "threadpoolsize", m_webserverThreadPoolSize, 0, 64);
+    // WARNING: must be higher than 1, otherwise on libmicrohttpd 0.4.4-1 it spins a busy loop
+    XMLUtils::GetUInt(pElement, "connectiontimeout", m_webserverConnectionTimeout, 2, 60 * 60 * 24);
+  }
+
   pElement = pRootElement->FirstChildElement("ftp");
   if (pElement)
   {
@@ -1087,6 +1118,7 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetInt(pPVR, "numericchannelswitchtimeout", m_iPVRNumericChannelSwitchTimeout, 50, 60000);
     XMLUtils::GetInt(pPVR, "timeshiftthreshold", m_iPVRTimeshiftThreshold, 0, 60);
     XMLUtils::GetBoolean(pPVR, "timeshiftsimpleosd", m_bPVRTimeshiftSimpleOSD);
+    XMLUtils::GetUInt(pPVR, "clienttimeout", m_iPVRClientTimeout, 0, 600000);
   }
 
   TiXmlElement* pDatabase = pRootElement->FirstChildElement("videodatabase");
@@ -1158,6 +1190,14 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetBoolean(pDatabase, "compression", m_databaseEpg.compression);
   }
 
+  pElement = pRootElement->FirstChildElement("databasestats");
+  if (pElement)
+  {
+    XMLUtils::GetBoolean(pElement, "enabled", m_databaseStatsEnabled);
+    XMLUtils::GetUInt(pElement, "slowquerythreshold", m_databaseSlowQueryThreshold, 0, 600000);
+    XMLUtils::GetUInt(pElement, "loginterval", m_databaseStatsLogInterval, 0, 86400);
+  }
+
   pElement = pRootElement->FirstChildElement("enablemultimediakeys");
   if (pElement)
   {
@@ -231,6 +231,9 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
 
     bool m_bHTTPDirectoryStatFilesize;
 
+    unsigned int m_webserverThreadPoolSize; ///< \brief worker threads of the event-driven web server, 0 for a thread per connection
+    unsigned int m_webserverConnectionTimeout; ///< \brief seconds an idle (keep-alive) web server connection is kept open
+
     bool m_bFTPThumbs;
 
     std::string m_musicThumbs;
@@ -266,6 +269,11 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_bVideoScannerIgnoreErrors;
     int m_iVideoLibraryDateAdded;
 
+    unsigned int m_videoThumbExtractionConcurrency; ///< \brief maximum number of concurrent thumb extraction workers
+    unsigned int m_videoThumbExtractionMaxCPUPercent; ///< \brief percentage of the CPU cores thumb extraction workers may occupy
+    unsigned int m_videoThumbExtractionBatchSize; ///< \brief number of items a thumb extraction worker processes at once
+    unsigned int m_videoThumbExtractionStripFrames; ///< \brief number of frames extracted as thumb strip, 0 to disable
+
     std::set<std::string> m_vecTokens;
 
     int m_iEpgUpdateCheckInterval;  // seconds
@@ -288,6 +296,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_curlconnecttimeout;
     int m_curllowspeedtime;
     int m_curlretries;
+    int m_curlMaxHostConnections;
     bool m_curlDisableIPV6;
     bool m_curlDisableHTTP2;
 
@@ -316,10 +325,14 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_iPVRNumericChannelSwitchTimeout; /*!< @brief time in msecs after that a channel switch occurs after entering a channel number, if confirmchannelswitch is disabled */
     int m_iPVRTimeshiftThreshold; /*!< @brief time diff between current playing time and timeshift buffer end, in seconds, before a playing stream is displayed as timeshifting. */
     bool m_bPVRTimeshiftSimpleOSD; /*!< @brief use simple timeshift OSD (with progress only for the playing event instead of progress for the whole ts buffer). */
+    unsigned int m_iPVRClientTimeout; /*!< @brief time in msecs PVR clients have to transfer channels, groups, timers and recordings before they are considered failed, 0 to wait forever. */
     DatabaseSettings m_databaseMusic; // advanced music database setup
     DatabaseSettings m_databaseVideo; // advanced video database setup
     DatabaseSettings m_databaseTV;    // advanced tv database setup
     DatabaseSettings m_databaseEpg;   /*!< advanced EPG database setup */
+    bool m_databaseStatsEnabled;              /*!< collect the execution times of database queries */
+    unsigned int m_databaseSlowQueryThreshold; /*!< log queries taking at least this many msecs along with their plan, 0 to disable */
+    unsigned int m_databaseStatsLogInterval;   /*!< seconds between summaries of the query statistics in the log, 0 to disable */
 
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
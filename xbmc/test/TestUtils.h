@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -94,6 +96,27 @@ private:
   double probability;
 };
 
+/* Stopwatch for the benchmark tests, which record the time of each of their
+ * steps as test properties. It starts running when it's created.
+ */
+class CTestStopwatch
+{
+public:
+  CTestStopwatch() : m_start(std::chrono::steady_clock::now()) {}
+
+  /* Function to get the microseconds since the start and restart it. */
+  int64_t Lap()
+  {
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    const int64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - m_start).count();
+    m_start = now;
+    return elapsed;
+  }
+
+private:
+  std::chrono::steady_clock::time_point m_start;
+};
+
 #define XBMC_REF_FILE_PATH(s) CXBMCTestUtils::Instance().ReferenceFilePath(s)
 #define XBMC_CREATETEMPFILE(a) CXBMCTestUtils::Instance().CreateTempFile(a)
 #define XBMC_DELETETEMPFILE(a) CXBMCTestUtils::Instance().DeleteTempFile(a)
@@ -0,0 +1,362 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "AsyncLogWriter.h"
+
+#include "commons/ilog.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <string.h>
+#include <thread>
+
+namespace
+{
+// how long the writer sleeps if nobody wakes it up
+const unsigned int IDLE_WAIT_MS = 1000;
+// how long a message of LOGERROR and above waits for room in a full ring
+const unsigned int BLOCKING_WAIT_MS = 1000;
+// how long Flush waits for the writer
+const unsigned int FLUSH_WAIT_MS = 1000;
+
+// marks the unused end of the ring if a record doesn't fit in front of the wrap around
+const int32_t WRAP_MARKER = -1;
+
+const size_t RECORD_ALIGNMENT = 8;
+
+struct RecordHeader
+{
+  uint32_t size;
+  int32_t level;
+  uint64_t sequence;
+  uint64_t threadId;
+  CAsyncLogWriter::Time time;
+  uint32_t length;
+};
+
+size_t AlignRecord(size_t size)
+{
+  return (size + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+}
+}
+
+/*!
+ \brief Single producer, single consumer ring of log records.
+
+ The logging thread is the only one writing and the writer the only one reading,
+ head and tail are the only shared state.
+ */
+class CAsyncLogWriter::CRing
+{
+public:
+  explicit CRing(size_t size) : m_data(new char[size]), m_mask(size - 1)
+  {
+    m_head = 0;
+    m_tail = 0;
+    m_dropped = 0;
+  }
+
+  size_t GetMaxLength() const { return (m_mask + 1) / 2 - sizeof(RecordHeader); }
+
+  bool Write(uint64_t sequence, int level, uint64_t threadId, const Time& time, const char* message, size_t length)
+  {
+    const size_t size = AlignRecord(sizeof(RecordHeader) + length);
+    const uint64_t head = m_head.load(std::memory_order_relaxed);
+    const uint64_t tail = m_tail.load(std::memory_order_acquire);
+
+    // records are never split, skip the end of the buffer if the record doesn't fit in front of it
+    const size_t contiguous = m_mask + 1 - (head & m_mask);
+    const size_t padding = contiguous < size ? contiguous : 0;
+    if (m_mask + 1 - (head - tail) < size + padding)
+      return false;
+
+    uint64_t pos = head;
+    if (padding)
+    {
+      RecordHeader marker;
+      marker.size = static_cast<uint32_t>(padding);
+      marker.level = WRAP_MARKER;
+      memcpy(m_data.get() + (pos & m_mask), &marker, offsetof(RecordHeader, sequence));
+      pos += padding;
+    }
+
+    RecordHeader header;
+    header.size = static_cast<uint32_t>(size);
+    header.level = level;
+    header.sequence = sequence;
+    header.threadId = threadId;
+    header.time = time;
+    header.length = static_cast<uint32_t>(length);
+
+    char* dest = m_data.get() + (pos & m_mask);
+    memcpy(dest, &header, sizeof(header));
+    memcpy(dest + sizeof(header), message, length);
+
+    m_head.store(pos + size, std::memory_order_release);
+    return true;
+  }
+
+  /*!
+   \brief Append all queued records.
+   \return the read position to pass to Release once the records have been written.
+   */
+  uint64_t Read(std::vector<Record>& records) const
+  {
+    const uint64_t head = m_head.load(std::memory_order_acquire);
+    uint64_t pos = m_tail.load(std::memory_order_relaxed);
+
+    while (pos < head)
+    {
+      const char* data = m_data.get() + (pos & m_mask);
+      RecordHeader header;
+      memcpy(&header, data, offsetof(RecordHeader, sequence));
+      if (header.level != WRAP_MARKER)
+      {
+        memcpy(&header, data, sizeof(header));
+
+        Record record;
+        record.sequence = header.sequence;
+        record.level = header.level;
+        record.threadId = header.threadId;
+        record.time = header.time;
+        record.message = data + sizeof(header);
+        record.length = header.length;
+        records.push_back(record);
+      }
+      pos += header.size;
+    }
+    return head;
+  }
+
+  void Release(uint64_t pos) { m_tail.store(pos, std::memory_order_release); }
+
+  bool IsEmpty() const { return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_relaxed); }
+
+  void AddDropped() { m_dropped.fetch_add(1, std::memory_order_relaxed); }
+  uint64_t TakeDropped() { return m_dropped.exchange(0); }
+
+private:
+  std::unique_ptr<char[]> m_data;
+  const size_t m_mask;
+  std::atomic<uint64_t> m_head;
+  std::atomic<uint64_t> m_tail;
+  std::atomic<uint64_t> m_dropped;
+};
+
+CAsyncLogWriter::CAsyncLogWriter(Sink sink, size_t ringSize /* = DEFAULT_RING_SIZE */)
+  : CThread("AsyncLogWriter"),
+    m_sink(std::move(sink)),
+    m_ringSize([ringSize]() {
+      size_t size = 4096;
+      while (size < ringSize)
+        size <<= 1;
+      return size;
+    }()),
+    m_id([]() {
+      static std::atomic<uint64_t> nextId{1};
+      return nextId++;
+    }())
+{
+  m_active = false;
+  m_pushing = 0;
+  m_idle = false;
+  m_sequence = 0;
+  m_written = 0;
+  m_dropped = 0;
+}
+
+CAsyncLogWriter::~CAsyncLogWriter()
+{
+  Stop();
+}
+
+void CAsyncLogWriter::Start()
+{
+  if (m_active)
+    return;
+
+  m_bStop = false;
+  m_active = true;
+  Create();
+}
+
+void CAsyncLogWriter::Stop()
+{
+  if (!m_active.exchange(false))
+    return;
+
+  // let messages being queued right now make it into the ring
+  while (m_pushing > 0)
+    std::this_thread::yield();
+
+  m_bStop = true;
+  m_wakeUp.Set();
+  StopThread(true);
+
+  // pick up anything queued after the last pass of the writer thread
+  Drain();
+}
+
+bool CAsyncLogWriter::Push(int level, uint64_t threadId, const Time& time, const std::string& message)
+{
+  m_pushing++;
+  if (!m_active)
+  {
+    m_pushing--;
+    return false;
+  }
+
+  CRing& ring = GetRing();
+  const size_t length = std::min(message.size(), ring.GetMaxLength());
+  const uint64_t sequence = m_sequence++;
+
+  bool queued = ring.Write(sequence, level, threadId, time, message.c_str(), length);
+
+  // important messages wait for room, unless it's the writer itself that would have to make it
+  if (!queued && level >= LOGERROR && !IsCurrentThread())
+  {
+    XbmcThreads::EndTime timeout(BLOCKING_WAIT_MS);
+    while (!queued && !timeout.IsTimePast())
+    {
+      uint64_t pass;
+      {
+        CSingleLock lock(m_passSection);
+        pass = m_passes;
+      }
+      m_wakeUp.Set();
+      WaitForPass(pass + 1, timeout.MillisLeft());
+      queued = ring.Write(sequence, level, threadId, time, message.c_str(), length);
+    }
+  }
+
+  if (!queued)
+    ring.AddDropped();
+
+  WakeUp();
+  m_pushing--;
+  return true;
+}
+
+void CAsyncLogWriter::Flush()
+{
+  if (!m_active || IsCurrentThread())
+    return;
+
+  uint64_t pass;
+  {
+    CSingleLock lock(m_passSection);
+    pass = m_passes;
+  }
+  m_wakeUp.Set();
+
+  // the pass running right now may have missed our messages, the next one won't
+  WaitForPass(pass + 2, FLUSH_WAIT_MS);
+}
+
+void CAsyncLogWriter::Process()
+{
+  while (!m_bStop)
+  {
+    if (Drain())
+      continue;
+
+    // check again after announcing the nap, a message queued in between won't wake us
+    m_idle = true;
+    if (!Drain())
+      m_wakeUp.WaitMSec(IDLE_WAIT_MS);
+    m_idle = false;
+  }
+
+  Drain();
+}
+
+CAsyncLogWriter::CRing& CAsyncLogWriter::GetRing()
+{
+  static thread_local uint64_t ringWriterId = 0;
+  static thread_local std::shared_ptr<CRing> ring;
+
+  if (ringWriterId != m_id || !ring)
+  {
+    ring = std::make_shared<CRing>(m_ringSize);
+    ringWriterId = m_id;
+
+    CSingleLock lock(m_ringsSection);
+    m_rings.push_back(ring);
+  }
+  return *ring;
+}
+
+bool CAsyncLogWriter::Drain()
+{
+  CSingleLock lock(m_drainSection);
+
+  std::vector<std::shared_ptr<CRing>> rings;
+  {
+    CSingleLock ringsLock(m_ringsSection);
+
+    // forget the rings of threads that are gone once everything has been written
+    m_rings.erase(std::remove_if(m_rings.begin(), m_rings.end(),
+                                 [](const std::shared_ptr<CRing>& ring) {
+                                   return ring.use_count() == 1 && ring->IsEmpty();
+                                 }),
+                  m_rings.end());
+    rings = m_rings;
+  }
+
+  m_records.clear();
+  std::vector<uint64_t> positions(rings.size());
+  uint64_t dropped = 0;
+  for (size_t i = 0; i < rings.size(); i++)
+  {
+    dropped += rings[i]->TakeDropped();
+    positions[i] = rings[i]->Read(m_records);
+  }
+
+  const bool written = !m_records.empty() || dropped > 0;
+  if (written)
+  {
+    std::sort(m_records.begin(), m_records.end(), [](const Record& a, const Record& b) {
+      return a.sequence < b.sequence;
+    });
+
+    m_sink(m_records, dropped);
+
+    for (size_t i = 0; i < rings.size(); i++)
+      rings[i]->Release(positions[i]);
+
+    m_written += m_records.size();
+    m_dropped += dropped;
+  }
+
+  {
+    CSingleLock passLock(m_passSection);
+    m_passes++;
+  }
+  m_passDone.notifyAll();
+
+  return written;
+}
+
+void CAsyncLogWriter::WakeUp()
+{
+  if (m_idle.exchange(false))
+    m_wakeUp.Set();
+}
+
+bool CAsyncLogWriter::WaitForPass(uint64_t pass, unsigned int milliSeconds)
+{
+  XbmcThreads::EndTime timeout(milliSeconds);
+
+  CSingleLock lock(m_passSection);
+  while (m_passes < pass && !timeout.IsTimePast())
+    m_passDone.wait(lock, timeout.MillisLeft());
+
+  return m_passes >= pass;
+}
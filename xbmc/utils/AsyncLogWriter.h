@@ -0,0 +1,151 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "threads/Condition.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*!
+ \brief Moves writing log messages off the logging threads.
+
+ Every logging thread gets its own lock-free single producer ring buffer, so
+ logging threads never wait for each other or for the disk. A background thread
+ collects the queued messages of all threads, puts them back into logging order
+ and hands them to the sink in batches.
+
+ If the ring of a thread is full, messages below LOGERROR are dropped and
+ counted, the number of dropped messages is passed to the sink with the next
+ batch. Messages of LOGERROR and above wait for the writer for a bounded time.
+ */
+class CAsyncLogWriter : public CThread
+{
+public:
+  struct Time
+  {
+    int year;
+    int month;
+    int day;
+    int hour;
+    int minute;
+    int second;
+    int millisecond;
+  };
+
+  /*!
+   \brief A queued message, the message text is only valid during the sink call.
+   */
+  struct Record
+  {
+    uint64_t sequence;
+    int level;
+    uint64_t threadId;
+    Time time;
+    const char* message;
+    size_t length;
+  };
+
+  /*!
+   \brief Writes a batch of records in logging order.
+   \param records the queued records.
+   \param dropped number of records dropped since the previous batch.
+   */
+  using Sink = std::function<void(const std::vector<Record>& records, uint64_t dropped)>;
+
+  static const size_t DEFAULT_RING_SIZE = 64 * 1024;
+
+  /*!
+   \param sink called on the writer thread for every batch.
+   \param ringSize size of the ring buffer of each logging thread, rounded up to a power of two.
+   */
+  explicit CAsyncLogWriter(Sink sink, size_t ringSize = DEFAULT_RING_SIZE);
+  ~CAsyncLogWriter() override;
+
+  /*!
+   \brief Start the writer thread.
+   */
+  void Start();
+
+  /*!
+   \brief Stop the writer thread after everything queued has been written.
+   */
+  void Stop();
+
+  /*!
+   \brief Whether messages are accepted.
+   */
+  bool IsActive() const { return m_active; }
+
+  /*!
+   \brief Queue a message of the calling thread.
+   \return false if the writer is not running, the message has to be written by the caller.
+   Dropped messages are reported as queued.
+   */
+  bool Push(int level, uint64_t threadId, const Time& time, const std::string& message);
+
+  /*!
+   \brief Wait until everything queued so far by the calling thread has been written.
+   */
+  void Flush();
+
+  uint64_t GetWrittenCount() const { return m_written; }
+  uint64_t GetDroppedCount() const { return m_dropped; }
+
+protected:
+  void Process() override;
+
+private:
+  class CRing;
+
+  CAsyncLogWriter(const CAsyncLogWriter&) = delete;
+  CAsyncLogWriter& operator=(const CAsyncLogWriter&) = delete;
+
+  CRing& GetRing();
+
+  /*!
+   \brief Hand everything queued to the sink.
+   \return true if something was written.
+   */
+  bool Drain();
+
+  void WakeUp();
+  bool WaitForPass(uint64_t pass, unsigned int milliSeconds);
+
+  const Sink m_sink;
+  const size_t m_ringSize;
+  const uint64_t m_id;
+
+  std::atomic_bool m_active;
+  std::atomic_int m_pushing;
+  std::atomic_bool m_idle;
+  std::atomic<uint64_t> m_sequence;
+  std::atomic<uint64_t> m_written;
+  std::atomic<uint64_t> m_dropped;
+
+  CEvent m_wakeUp;
+
+  CCriticalSection m_ringsSection;
+  std::vector<std::shared_ptr<CRing>> m_rings;
+
+  // serializes draining between the writer thread and Stop
+  CCriticalSection m_drainSection;
+  std::vector<Record> m_records;
+
+  CCriticalSection m_passSection;
+  XbmcThreads::ConditionVariable m_passDone;
+  uint64_t m_passes = 0;
+};
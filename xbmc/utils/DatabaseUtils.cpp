@@ -361,86 +361,81 @@ bool DatabaseUtils::GetDatabaseResults(const MediaType &mediaType, const FieldLi
   const dbiplus::result_set &resultSet = dataset->get_result_set();
   unsigned int offset = results.size();
 
-  if (fields.empty())
+  if (!fields.empty() && resultSet.record_header.size() < fields.size())
+    return false;
+
+  results.reserve(resultSet.records.size() + offset);
+  for (unsigned int index = 0; index < resultSet.records.size(); index++)
   {
     DatabaseResult result;
-    for (unsigned int index = 0; index < resultSet.records.size(); index++)
-    {
-      result[FieldRow] = index + offset;
-      results.push_back(result);
-    }
+    if (!GetDatabaseResult(mediaType, fields, *resultSet.records[index], index + offset, result))
+      return false;
 
-    return true;
+    results.push_back(std::move(result));
   }
 
-  if (resultSet.record_header.size() < fields.size())
+  return true;
+}
+
+bool DatabaseUtils::GetDatabaseResult(const MediaType &mediaType, const FieldList &fields, const std::vector<dbiplus::field_value> &record, unsigned int row, DatabaseResult &result)
+{
+  result[FieldRow] = row;
+  if (fields.empty())
+    return true;
+
+  if (record.size() < fields.size())
     return false;
 
-  std::vector<int> fieldIndexLookup;
-  fieldIndexLookup.reserve(fields.size());
   for (FieldList::const_iterator it = fields.begin(); it != fields.end(); ++it)
-    fieldIndexLookup.push_back(GetFieldIndex(*it, mediaType));
-
-  results.reserve(resultSet.records.size() + offset);
-  for (unsigned int index = 0; index < resultSet.records.size(); index++)
   {
-    DatabaseResult result;
-    result[FieldRow] = index + offset;
-
-    unsigned int lookupIndex = 0;
-    for (FieldList::const_iterator it = fields.begin(); it != fields.end(); ++it)
-    {
-      int fieldIndex = fieldIndexLookup[lookupIndex++];
-      if (fieldIndex < 0)
-        return false;
+    int fieldIndex = GetFieldIndex(*it, mediaType);
+    if (fieldIndex < 0)
+      return false;
 
-      std::pair<Field, CVariant> value;
-      value.first = *it;
-      if (!GetFieldValue(resultSet.records[index]->at(fieldIndex), value.second))
-        CLog::Log(LOGWARNING, "GetDatabaseResults: unable to retrieve value of field %s", resultSet.record_header[fieldIndex].name.c_str());
+    std::pair<Field, CVariant> value;
+    value.first = *it;
+    if (!GetFieldValue(record.at(fieldIndex), value.second))
+      CLog::Log(LOGWARNING, "GetDatabaseResult: unable to retrieve value of field %d", fieldIndex);
 
-      if (value.first == FieldYear &&
-         (mediaType == MediaTypeTvShow || mediaType == MediaTypeEpisode))
+    if (value.first == FieldYear &&
+       (mediaType == MediaTypeTvShow || mediaType == MediaTypeEpisode))
+    {
+      CDateTime dateTime;
+      dateTime.SetFromDBDate(value.second.asString());
+      if (dateTime.IsValid())
       {
-        CDateTime dateTime;
-        dateTime.SetFromDBDate(value.second.asString());
-        if (dateTime.IsValid())
-        {
-          value.second.clear();
-          value.second = dateTime.GetYear();
-        }
+        value.second.clear();
+        value.second = dateTime.GetYear();
       }
-
-      result.insert(value);
     }
 
-    result[FieldMediaType] = mediaType;
-    if (mediaType == MediaTypeMovie || mediaType == MediaTypeVideoCollection ||
-        mediaType == MediaTypeTvShow || mediaType == MediaTypeMusicVideo)
-      result[FieldLabel] = result.at(FieldTitle).asString();
-    else if (mediaType == MediaTypeEpisode)
-    {
-      std::ostringstream label;
-      label << (int)(result.at(FieldSeason).asInteger() * 100 + result.at(FieldEpisodeNumber).asInteger());
-      label << ". ";
-      label << result.at(FieldTitle).asString();
-      result[FieldLabel] = label.str();
-    }
-    else if (mediaType == MediaTypeAlbum)
-      result[FieldLabel] = result.at(FieldAlbum).asString();
-    else if (mediaType == MediaTypeSong)
-    {
-      std::ostringstream label;
-      label << (int)result.at(FieldTrackNumber).asInteger();
-      label << ". ";
-      label << result.at(FieldTitle).asString();
-      result[FieldLabel] = label.str();
-    }
-    else if (mediaType == MediaTypeArtist)
-      result[FieldLabel] = result.at(FieldArtist).asString();
+    result.insert(value);
+  }
 
-    results.push_back(result);
+  result[FieldMediaType] = mediaType;
+  if (mediaType == MediaTypeMovie || mediaType == MediaTypeVideoCollection ||
+      mediaType == MediaTypeTvShow || mediaType == MediaTypeMusicVideo)
+    result[FieldLabel] = result.at(FieldTitle).asString();
+  else if (mediaType == MediaTypeEpisode)
+  {
+    std::ostringstream label;
+    label << (int)(result.at(FieldSeason).asInteger() * 100 + result.at(FieldEpisodeNumber).asInteger());
+    label << ". ";
+    label << result.at(FieldTitle).asString();
+    result[FieldLabel] = label.str();
+  }
+  else if (mediaType == MediaTypeAlbum)
+    result[FieldLabel] = result.at(FieldAlbum).asString();
+  else if (mediaType == MediaTypeSong)
+  {
+    std::ostringstream label;
+    label << (int)result.at(FieldTrackNumber).asInteger();
+    label << ". ";
+    label << result.at(FieldTitle).asString();
+    result[FieldLabel] = label.str();
   }
+  else if (mediaType == MediaTypeArtist)
+    result[FieldLabel] = result.at(FieldArtist).asString();
 
   return true;
 }
@@ -159,6 +159,15 @@ public:
 
   static bool GetFieldValue(const dbiplus::field_value &fieldValue, CVariant &variantValue);
   static bool GetDatabaseResults(const MediaType &mediaType, const FieldList &fields, const std::unique_ptr<dbiplus::Dataset> &dataset, DatabaseResults &results);
+  /*! \brief Get the result of a single row, e.g. one read from a dbiplus::Statement.
+   \param mediaType the media type of the row.
+   \param fields the fields to retrieve, see GetSelectFields().
+   \param record the values of the row.
+   \param row the number of the row, stored as FieldRow.
+   \param result the result to fill.
+   \return false if the row lacks one of the fields.
+   */
+  static bool GetDatabaseResult(const MediaType &mediaType, const FieldList &fields, const std::vector<dbiplus::field_value> &record, unsigned int row, DatabaseResult &result);
 
   static std::string BuildLimitClause(int end, int start = 0);
 
@@ -0,0 +1,291 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "InitGraph.h"
+
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "utils/StartupProfiler.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
+
+CInitGraph::CInitGraph(std::string name) : m_name(std::move(name))
+{
+}
+
+CInitGraph::~CInitGraph() = default;
+
+void CInitGraph::Add(std::string name, std::vector<std::string> dependencies, InitFunc func, Affinity affinity /* = ANY_THREAD */)
+{
+  Step step;
+  step.name = std::move(name);
+  step.dependencyNames = std::move(dependencies);
+  step.func = std::move(func);
+  step.affinity = affinity;
+
+  CSingleLock lock(m_critSection);
+  m_steps.emplace_back(std::move(step));
+}
+
+bool CInitGraph::Run(unsigned int workers)
+{
+  CStartupProfiler::CScope scope(m_name);
+
+  {
+    CSingleLock lock(m_critSection);
+    if (!Resolve())
+      return false;
+  }
+
+  // no point in starting more threads than there are steps they may run
+  const size_t anyThreadSteps = std::count_if(m_steps.begin(), m_steps.end(), [](const Step& step) {
+    return step.affinity == ANY_THREAD;
+  });
+  workers = std::min<unsigned int>(workers, anyThreadSteps);
+
+  std::vector<std::unique_ptr<CThread>> threads;
+  for (unsigned int i = 0; i < workers; i++)
+  {
+    threads.emplace_back(new CThread(this, "InitGraph"));
+    threads.back()->Create();
+  }
+
+  Work(true);
+
+  for (auto& thread : threads)
+    thread->StopThread(true);
+
+  const std::vector<std::string> failed = GetFailed();
+  if (!failed.empty())
+  {
+    CLog::Log(LOGERROR, "CInitGraph::%s - %s: %u step(s) failed or skipped", __FUNCTION__,
+              m_name.c_str(), static_cast<unsigned int>(failed.size()));
+    return false;
+  }
+  return true;
+}
+
+std::vector<std::string> CInitGraph::GetFailed() const
+{
+  CSingleLock lock(m_critSection);
+
+  std::vector<std::string> failed;
+  for (const Step& step : m_steps)
+  {
+    if (step.state == State::FAILED || step.state == State::SKIPPED)
+      failed.push_back(step.name);
+  }
+  return failed;
+}
+
+bool CInitGraph::DependsOn(const std::string& name, const std::string& dependency) const
+{
+  CSingleLock lock(m_critSection);
+
+  std::set<std::string> visited;
+  std::vector<std::string> pending = {name};
+  while (!pending.empty())
+  {
+    const std::string current = pending.back();
+    pending.pop_back();
+    if (!visited.insert(current).second)
+      continue;
+
+    const auto it = std::find_if(m_steps.begin(), m_steps.end(),
+                                 [&current](const Step& step) { return step.name == current; });
+    if (it == m_steps.end())
+      continue;
+
+    for (const std::string& stepDependency : it->dependencyNames)
+    {
+      if (stepDependency == dependency)
+        return true;
+      pending.push_back(stepDependency);
+    }
+  }
+  return false;
+}
+
+bool CInitGraph::IsMainThreadStep(const std::string& name) const
+{
+  CSingleLock lock(m_critSection);
+
+  const auto it = std::find_if(m_steps.begin(), m_steps.end(),
+                               [&name](const Step& step) { return step.name == name; });
+  return it != m_steps.end() && it->affinity == MAIN_THREAD;
+}
+
+bool CInitGraph::Resolve()
+{
+  std::map<std::string, size_t> indices;
+  for (size_t i = 0; i < m_steps.size(); i++)
+  {
+    Step& step = m_steps[i];
+    step.dependents.clear();
+    step.waitingFor = step.dependencyNames.size();
+    step.state = State::PENDING;
+
+    if (!indices.emplace(step.name, i).second)
+    {
+      CLog::Log(LOGERROR, "CInitGraph::%s - %s: step %s added twice", __FUNCTION__,
+                m_name.c_str(), step.name.c_str());
+      return false;
+    }
+  }
+  m_finished = 0;
+
+  for (size_t i = 0; i < m_steps.size(); i++)
+  {
+    for (const std::string& dependency : m_steps[i].dependencyNames)
+    {
+      const auto it = indices.find(dependency);
+      if (it == indices.end())
+      {
+        CLog::Log(LOGERROR, "CInitGraph::%s - %s: step %s depends on unknown step %s", __FUNCTION__,
+                  m_name.c_str(), m_steps[i].name.c_str(), dependency.c_str());
+        return false;
+      }
+      m_steps[it->second].dependents.push_back(i);
+    }
+  }
+
+  // every step has to be reachable from the steps without dependencies
+  std::vector<size_t> waitingFor;
+  std::vector<size_t> ready;
+  for (size_t i = 0; i < m_steps.size(); i++)
+  {
+    waitingFor.push_back(m_steps[i].waitingFor);
+    if (waitingFor[i] == 0)
+      ready.push_back(i);
+  }
+
+  size_t reachable = 0;
+  while (!ready.empty())
+  {
+    const size_t index = ready.back();
+    ready.pop_back();
+    reachable++;
+    for (size_t dependent : m_steps[index].dependents)
+    {
+      if (--waitingFor[dependent] == 0)
+        ready.push_back(dependent);
+    }
+  }
+
+  if (reachable != m_steps.size())
+  {
+    CLog::Log(LOGERROR, "CInitGraph::%s - %s: circular dependencies", __FUNCTION__, m_name.c_str());
+    return false;
+  }
+  return true;
+}
+
+void CInitGraph::Run()
+{
+  Work(false);
+}
+
+void CInitGraph::Work(bool mainThread)
+{
+  int index;
+  while ((index = TakeStep(mainThread)) >= 0)
+  {
+    const Step& step = m_steps[index];
+
+    bool success;
+    {
+      CStartupProfiler::CScope scope(step.name);
+      success = step.func();
+    }
+
+    if (!success)
+      CLog::Log(LOGERROR, "CInitGraph::%s - %s: step %s failed", __FUNCTION__, m_name.c_str(),
+                step.name.c_str());
+
+    FinishStep(index, success);
+  }
+}
+
+int CInitGraph::TakeStep(bool mainThread)
+{
+  CSingleLock lock(m_critSection);
+
+  while (m_finished < m_steps.size())
+  {
+    // the main thread takes its own steps first, nobody else can run them
+    int candidate = -1;
+    for (size_t i = 0; i < m_steps.size(); i++)
+    {
+      const Step& step = m_steps[i];
+      if (step.state != State::PENDING || step.waitingFor > 0)
+        continue;
+
+      if (step.affinity == MAIN_THREAD)
+      {
+        if (!mainThread)
+          continue;
+        candidate = static_cast<int>(i);
+        break;
+      }
+
+      if (candidate < 0)
+        candidate = static_cast<int>(i);
+    }
+
+    if (candidate >= 0)
+    {
+      m_steps[candidate].state = State::RUNNING;
+      return candidate;
+    }
+
+    m_changed.wait(lock);
+  }
+
+  return -1;
+}
+
+void CInitGraph::FinishStep(size_t index, bool success)
+{
+  {
+    CSingleLock lock(m_critSection);
+
+    Step& step = m_steps[index];
+    step.state = success ? State::SUCCEEDED : State::FAILED;
+    m_finished++;
+
+    for (size_t dependent : step.dependents)
+    {
+      if (!success)
+        Skip(dependent);
+      else
+        m_steps[dependent].waitingFor--;
+    }
+  }
+
+  m_changed.notifyAll();
+}
+
+void CInitGraph::Skip(size_t index)
+{
+  Step& step = m_steps[index];
+  if (step.state != State::PENDING)
+    return;
+
+  CLog::Log(LOGERROR, "CInitGraph::%s - %s: skipping step %s", __FUNCTION__, m_name.c_str(),
+            step.name.c_str());
+
+  step.state = State::SKIPPED;
+  m_finished++;
+
+  for (size_t dependent : step.dependents)
+    Skip(dependent);
+}
@@ -0,0 +1,131 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "threads/Condition.h"
+#include "threads/CriticalSection.h"
+#include "threads/IRunnable.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/*!
+ \brief Runs initialization steps concurrently as far as their dependencies allow.
+
+ Every step names the steps it depends on and is started once all of them
+ succeeded. Steps whose dependencies failed are skipped. Steps that have to
+ run on the thread calling Run(), e.g. because they touch the windowing
+ system, are marked as main thread steps, all others may run on any of the
+ worker threads or on the calling thread.
+
+ Each step is recorded in the CStartupProfiler.
+
+ \code
+ CInitGraph graph("example");
+ graph.Add("database", {}, []() { return OpenDatabase(); });
+ graph.Add("library", {"database"}, []() { return LoadLibrary(); });
+ graph.Add("window", {}, []() { return CreateWindow(); }, CInitGraph::MAIN_THREAD);
+ bool ok = graph.Run(2);
+ \endcode
+ */
+class CInitGraph : private IRunnable
+{
+public:
+  using InitFunc = std::function<bool()>;
+
+  enum Affinity
+  {
+    ANY_THREAD,
+    MAIN_THREAD
+  };
+
+  explicit CInitGraph(std::string name);
+  ~CInitGraph() override;
+
+  /*!
+   \brief Add a step.
+   \param name unique name of the step.
+   \param dependencies names of the steps that have to succeed before this one starts.
+   \param func the step, returns false on failure.
+   \param affinity whether the step has to run on the thread calling Run.
+   */
+  void Add(std::string name, std::vector<std::string> dependencies, InitFunc func, Affinity affinity = ANY_THREAD);
+
+  /*!
+   \brief Run all steps and wait for them to finish.
+   \param workers number of additional threads, 0 runs everything on the calling thread.
+   \return false if a step failed or was skipped, or the dependencies are invalid.
+   */
+  bool Run(unsigned int workers);
+
+  /*!
+   \brief Names of the steps that failed or were skipped in the last Run.
+   */
+  std::vector<std::string> GetFailed() const;
+
+  /*!
+   \brief Whether a step depends on another one, directly or through other steps.
+   */
+  bool DependsOn(const std::string& name, const std::string& dependency) const;
+
+  /*!
+   \brief Whether a step has been added and has to run on the thread calling Run.
+   */
+  bool IsMainThreadStep(const std::string& name) const;
+
+private:
+  enum class State
+  {
+    PENDING,
+    RUNNING,
+    SUCCEEDED,
+    FAILED,
+    SKIPPED
+  };
+
+  struct Step
+  {
+    std::string name;
+    std::vector<std::string> dependencyNames;
+    InitFunc func;
+    Affinity affinity;
+    std::vector<size_t> dependents;
+    size_t waitingFor = 0;
+    State state = State::PENDING;
+  };
+
+  CInitGraph(const CInitGraph&) = delete;
+  CInitGraph& operator=(const CInitGraph&) = delete;
+
+  bool Resolve();
+
+  // implementation of IRunnable, worker thread loop
+  void Run() override;
+
+  /*!
+   \brief Process steps until everything is done.
+   \param mainThread whether main thread steps may be taken.
+   */
+  void Work(bool mainThread);
+
+  /*!
+   \brief Wait for a step that is ready to run.
+   \return the index of the step or -1 once all steps are done.
+   */
+  int TakeStep(bool mainThread);
+  void FinishStep(size_t index, bool success);
+  void Skip(size_t index);
+
+  const std::string m_name;
+  mutable CCriticalSection m_critSection;
+  XbmcThreads::ConditionVariable m_changed;
+  std::vector<Step> m_steps;
+  size_t m_finished = 0;
+};
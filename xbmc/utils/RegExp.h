@@ -101,6 +101,17 @@ public:
    */
   int RegFind(const std::string& str, unsigned int startoffset = 0, int maxNumberOfCharsToTest = -1)
   { return PrivateRegFind(str.length(), str.c_str(), startoffset, maxNumberOfCharsToTest); }
+  /**
+   * Find first match of regular expression in given characters, which don't need to be null terminated
+   * @param str         The characters to match against regular expression
+   * @param length      The number of characters
+   * @param startoffset The string offset to start matching
+   * @param maxNumberOfCharsToTest The maximum number of characters to test (match) in
+   *                               string. If set to -1 string checked up to the end.
+   * @return staring position of match in string, negative value in case of error or no match
+   */
+  int RegFind(const char* str, size_t length, unsigned int startoffset, int maxNumberOfCharsToTest)
+  { return PrivateRegFind(length, str, startoffset, maxNumberOfCharsToTest); }
   std::string GetReplaceString(const std::string& sReplaceExp) const;
   int GetFindLen() const
   {
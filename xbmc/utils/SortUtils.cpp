@@ -795,14 +795,26 @@ void SortUtils::Sort(const SortDescription &sortDescription, SortItems& items)
 }
 
 bool SortUtils::SortFromDataset(const SortDescription &sortDescription, const MediaType &mediaType, const std::unique_ptr<dbiplus::Dataset> &dataset, DatabaseResults &results)
+{
+  if (!DatabaseUtils::GetDatabaseResults(mediaType, GetSortFields(sortDescription.sortBy, mediaType), dataset, results))
+    return false;
+
+  SortDatabaseResults(sortDescription, results);
+
+  return true;
+}
+
+FieldList SortUtils::GetSortFields(SortBy sortBy, const MediaType &mediaType)
 {
   FieldList fields;
-  if (!DatabaseUtils::GetSelectFields(SortUtils::GetFieldsForSorting(sortDescription.sortBy), mediaType, fields))
+  if (!DatabaseUtils::GetSelectFields(SortUtils::GetFieldsForSorting(sortBy), mediaType, fields))
     fields.clear();
 
-  if (!DatabaseUtils::GetDatabaseResults(mediaType, fields, dataset, results))
-    return false;
+  return fields;
+}
 
+void SortUtils::SortDatabaseResults(const SortDescription &sortDescription, DatabaseResults &results)
+{
   SortDescription sorting = sortDescription;
   if (sortDescription.sortBy == SortByNone)
   {
@@ -811,8 +823,6 @@ bool SortUtils::SortFromDataset(const SortDescription &sortDescription, const Me
   }
 
   Sort(sorting, results);
-
-  return true;
 }
 
 const SortUtils::SortPreparator& SortUtils::getPreparator(SortBy sortBy)
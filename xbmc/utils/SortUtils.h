@@ -199,6 +199,18 @@ public:
   static void Sort(const SortDescription &sortDescription, DatabaseResults& items);
   static void Sort(const SortDescription &sortDescription, SortItems& items);
   static bool SortFromDataset(const SortDescription &sortDescription, const MediaType &mediaType, const std::unique_ptr<dbiplus::Dataset> &dataset, DatabaseResults &results);
+  /*! \brief Get the database fields needed to sort by a sort method, see DatabaseUtils::GetDatabaseResult().
+   \param sortBy the sort method.
+   \param mediaType the media type of the rows.
+   \return the fields, empty if the rows don't need any.
+   */
+  static FieldList GetSortFields(SortBy sortBy, const MediaType &mediaType);
+  /*! \brief Sort results read row by row from the database the way SortFromDataset() does.
+   Without a sort method the database order is kept and the limits have already been applied by the query.
+   \param sortDescription the sort method, order and limits.
+   \param results the results to sort and limit.
+   */
+  static void SortDatabaseResults(const SortDescription &sortDescription, DatabaseResults &results);
 
   static const Fields& GetFieldsForSorting(SortBy sortBy);
   static std::string RemoveArticles(const std::string &label);
@@ -0,0 +1,139 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "StartupProfiler.h"
+
+#include "filesystem/File.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "utils/JSONVariantWriter.h"
+#include "utils/Variant.h"
+#include "utils/log.h"
+
+#include <algorithm>
+
+namespace
+{
+// number of steps listed in the log
+const size_t SUMMARY_STEPS = 15;
+}
+
+CStartupProfiler::CScope::CScope(std::string name)
+  : m_name(std::move(name)), m_start(std::chrono::steady_clock::now())
+{
+}
+
+CStartupProfiler::CScope::~CScope()
+{
+  End();
+}
+
+void CStartupProfiler::CScope::End()
+{
+  if (m_ended)
+    return;
+
+  m_ended = true;
+  CStartupProfiler::GetInstance().AddEvent(std::move(m_name), m_start, std::chrono::steady_clock::now());
+}
+
+CStartupProfiler::CStartupProfiler() : m_start(std::chrono::steady_clock::now())
+{
+}
+
+CStartupProfiler& CStartupProfiler::GetInstance()
+{
+  static CStartupProfiler profiler;
+  return profiler;
+}
+
+void CStartupProfiler::AddEvent(std::string name,
+                                std::chrono::steady_clock::time_point start,
+                                std::chrono::steady_clock::time_point end)
+{
+  using namespace std::chrono;
+
+  Event event;
+  event.name = std::move(name);
+  event.threadId = CThread::GetCurrentThreadNativeId();
+  event.startUs = duration_cast<microseconds>(start - m_start).count();
+  event.durationUs = duration_cast<microseconds>(end - start).count();
+
+  CSingleLock lock(m_critSection);
+  if (!m_finished)
+    m_events.emplace_back(std::move(event));
+}
+
+std::vector<CStartupProfiler::Event> CStartupProfiler::GetEvents() const
+{
+  CSingleLock lock(m_critSection);
+  return m_events;
+}
+
+void CStartupProfiler::Finish(const std::string& traceFile)
+{
+  std::vector<Event> events;
+  {
+    CSingleLock lock(m_critSection);
+    if (m_finished)
+      return;
+
+    m_finished = true;
+    events.swap(m_events);
+  }
+
+  const int64_t totalUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                              std::chrono::steady_clock::now() - m_start).count();
+  CLog::Log(LOGNOTICE, "CStartupProfiler::%s - startup took %.3f s, slowest steps:", __FUNCTION__,
+            totalUs / 1000000.0);
+
+  std::vector<Event> slowest(events);
+  std::sort(slowest.begin(), slowest.end(),
+            [](const Event& a, const Event& b) { return a.durationUs > b.durationUs; });
+  if (slowest.size() > SUMMARY_STEPS)
+    slowest.resize(SUMMARY_STEPS);
+  for (const Event& event : slowest)
+    CLog::Log(LOGNOTICE, "CStartupProfiler::%s - %8.3f s  %s", __FUNCTION__,
+              event.durationUs / 1000000.0, event.name.c_str());
+
+  if (!traceFile.empty() && !WriteTrace(events, traceFile))
+    CLog::Log(LOGERROR, "CStartupProfiler::%s - failed to write %s", __FUNCTION__, traceFile.c_str());
+}
+
+bool CStartupProfiler::WriteTrace(const std::vector<Event>& events, const std::string& traceFile)
+{
+  CVariant traceEvents(CVariant::VariantTypeArray);
+  for (const Event& event : events)
+  {
+    CVariant traceEvent(CVariant::VariantTypeObject);
+    traceEvent["name"] = event.name;
+    traceEvent["cat"] = "startup";
+    traceEvent["ph"] = "X";
+    traceEvent["pid"] = 1;
+    traceEvent["tid"] = event.threadId;
+    traceEvent["ts"] = event.startUs;
+    traceEvent["dur"] = event.durationUs;
+    traceEvents.push_back(traceEvent);
+  }
+
+  CVariant trace(CVariant::VariantTypeObject);
+  trace["traceEvents"] = traceEvents;
+  trace["displayTimeUnit"] = "ms";
+
+  std::string json;
+  if (!CJSONVariantWriter::Write(trace, json, false))
+    return false;
+
+  XFILE::CFile file;
+  if (!file.OpenForWrite(traceFile, true))
+    return false;
+
+  const bool ret = file.Write(json.c_str(), json.size()) == static_cast<ssize_t>(json.size());
+  file.Close();
+  return ret;
+}
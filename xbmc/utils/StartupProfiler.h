@@ -0,0 +1,83 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "threads/CriticalSection.h"
+
+#include <chrono>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*!
+ \brief Records a timeline of the application startup.
+
+ Every initialization step of interest is wrapped in a CScope. Once the
+ application is up, Finish() logs the slowest steps and writes the timeline
+ in the Chrome trace event format, to be viewed in chrome://tracing or similar
+ tools. Nothing is recorded after Finish().
+ */
+class CStartupProfiler
+{
+public:
+  struct Event
+  {
+    std::string name;
+    uint64_t threadId;
+    int64_t startUs; // relative to the creation of the profiler
+    int64_t durationUs;
+  };
+
+  /*!
+   \brief Records the time between construction and destruction as one step.
+   */
+  class CScope
+  {
+  public:
+    explicit CScope(std::string name);
+    ~CScope();
+
+    /*!
+     \brief Record the step now instead of on destruction.
+     */
+    void End();
+
+  private:
+    CScope(const CScope&) = delete;
+    CScope& operator=(const CScope&) = delete;
+
+    std::string m_name;
+    std::chrono::steady_clock::time_point m_start;
+    bool m_ended = false;
+  };
+
+  static CStartupProfiler& GetInstance();
+
+  void AddEvent(std::string name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+  std::vector<Event> GetEvents() const;
+
+  /*!
+   \brief Stop recording, log a summary and write the trace file.
+   \param traceFile path of the trace file, nothing is written if empty.
+   */
+  void Finish(const std::string& traceFile);
+
+  static bool WriteTrace(const std::vector<Event>& events, const std::string& traceFile);
+
+private:
+  CStartupProfiler();
+  CStartupProfiler(const CStartupProfiler&) = delete;
+  CStartupProfiler& operator=(const CStartupProfiler&) = delete;
+
+  const std::chrono::steady_clock::time_point m_start;
+  mutable CCriticalSection m_critSection;
+  std::vector<Event> m_events;
+  bool m_finished = false;
+};
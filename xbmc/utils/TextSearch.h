@@ -26,6 +26,10 @@ public:
   bool Search(const std::string &strHaystack) const;
   bool IsValid(void) const;
 
+  const std::vector<std::string>& GetAndTerms() const { return m_AND; }
+  const std::vector<std::string>& GetOrTerms() const { return m_OR; }
+  const std::vector<std::string>& GetNotTerms() const { return m_NOT; }
+
 private:
   static void GetAndCutNextTerm(std::string &strSearchTerm, std::string &strNextTerm);
   void ExtractSearchTerms(const std::string &strSearchTerm, TextSearchDefault defaultSearchMode);
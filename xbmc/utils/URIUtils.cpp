@@ -16,6 +16,7 @@
 #include "pvr/channels/PVRChannelsPath.h"
 #include "settings/AdvancedSettings.h"
 #include "URL.h"
+#include "URLView.h"
 #include "utils/FileExtensionProvider.h"
 #include "ServiceBroker.h"
 #include "StringUtils.h"
@@ -35,6 +36,74 @@ using namespace XFILE;
 
 const CAdvancedSettings* URIUtils::m_advancedSettings = nullptr;
 
+namespace
+{
+// protocols of internet streams, after CURL translated them
+const char* const INTERNET_STREAM_PROTOCOLS[] = {"http", "https", "tcp", "udp", "rtp", "sdp", "mms", "mmst", "mmsh",
+                                                 "rtsp", "rtmp", "rtmpt", "rtmpe", "rtmpte", "rtmps", nullptr};
+
+// protocols that are internet streams for the strict check only
+//! @todo sftp special case has to be handled by vfs addon
+const char* const STRICT_INTERNET_STREAM_PROTOCOLS[] = {"ftp", "ftps", "dav", "davs", "sftp", nullptr};
+
+std::string GetExtensionOfFileName(const char* fileName, size_t size)
+{
+  for (size_t i = size; i > 0; i--)
+  {
+    const char c = fileName[i - 1];
+    if (c == '.')
+      return std::string(fileName + i - 1, size - i + 1);
+    if (c == '/' || c == '\\')
+      break;
+  }
+  return std::string();
+}
+
+bool HasExtensionOfFileName(const char* fileName, size_t size)
+{
+  for (size_t i = size; i > 0; i--)
+  {
+    const char c = fileName[i - 1];
+    if (c == '.')
+      return true;
+    if (c == '/' || c == '\\')
+      break;
+  }
+  return false;
+}
+
+bool HasExtensionOfFileName(const char* fileName, size_t size, const std::string& strExtensions)
+{
+  typedef std::reverse_iterator<const char*> ReverseIterator;
+  const ReverseIterator fileNameBegin(fileName + size);
+  const ReverseIterator fileNameEnd(fileName);
+
+  // Search backwards so that '.' can be used as a search terminator.
+  std::string::const_reverse_iterator itExtensions = strExtensions.rbegin();
+  while (itExtensions != strExtensions.rend())
+  {
+    // Iterate backwards over strFileName untill we hit a '.' or a mismatch
+    for (ReverseIterator itFileName = fileNameBegin;
+         itFileName != fileNameEnd && itExtensions != strExtensions.rend() &&
+         tolower(*itFileName) == *itExtensions;
+         ++itFileName, ++itExtensions)
+    {
+      if (*itExtensions == '.')
+        return true; // Match
+    }
+
+    // No match. Look for more extensions to try.
+    while (itExtensions != strExtensions.rend() && *itExtensions != '|')
+      ++itExtensions;
+
+    while (itExtensions != strExtensions.rend() && *itExtensions == '|')
+      ++itExtensions;
+  }
+
+  return false;
+}
+}
+
 void URIUtils::RegisterAdvancedSettings(const CAdvancedSettings& advancedSettings)
 {
   m_advancedSettings = &advancedSettings;
@@ -55,27 +124,22 @@ std::string URIUtils::GetExtension(const std::string& strFileName)
 {
   if (IsURL(strFileName))
   {
-    CURL url(strFileName);
-    return GetExtension(url.GetFileName());
+    const CURLView::Part fileName = CURLView(strFileName).GetFileName();
+    return GetExtensionOfFileName(fileName.data, fileName.size);
   }
 
-  size_t period = strFileName.find_last_of("./\\");
-  if (period == std::string::npos || strFileName[period] != '.')
-    return std::string();
-
-  return strFileName.substr(period);
+  return GetExtensionOfFileName(strFileName.data(), strFileName.size());
 }
 
 bool URIUtils::HasExtension(const std::string& strFileName)
 {
   if (IsURL(strFileName))
   {
-    CURL url(strFileName);
-    return HasExtension(url.GetFileName());
+    const CURLView::Part fileName = CURLView(strFileName).GetFileName();
+    return HasExtensionOfFileName(fileName.data, fileName.size);
   }
 
-  size_t iPeriod = strFileName.find_last_of("./\\");
-  return iPeriod != std::string::npos && strFileName[iPeriod] == '.';
+  return HasExtensionOfFileName(strFileName.data(), strFileName.size());
 }
 
 bool URIUtils::HasExtension(const CURL& url, const std::string& strExtensions)
@@ -87,33 +151,11 @@ bool URIUtils::HasExtension(const std::string& strFileName, const std::string& s
 {
   if (IsURL(strFileName))
   {
-    CURL url(strFileName);
-    return HasExtension(url.GetFileName(), strExtensions);
+    const CURLView::Part fileName = CURLView(strFileName).GetFileName();
+    return HasExtensionOfFileName(fileName.data, fileName.size, strExtensions);
   }
 
-  // Search backwards so that '.' can be used as a search terminator.
-  std::string::const_reverse_iterator itExtensions = strExtensions.rbegin();
-  while (itExtensions != strExtensions.rend())
-  {
-    // Iterate backwards over strFileName untill we hit a '.' or a mismatch
-    for (std::string::const_reverse_iterator itFileName = strFileName.rbegin();
-         itFileName != strFileName.rend() && itExtensions != strExtensions.rend() &&
-         tolower(*itFileName) == *itExtensions;
-         ++itFileName, ++itExtensions)
-    {
-      if (*itExtensions == '.')
-        return true; // Match
-    }
-
-    // No match. Look for more extensions to try.
-    while (itExtensions != strExtensions.rend() && *itExtensions != '|')
-      ++itExtensions;
-
-    while (itExtensions != strExtensions.rend() && *itExtensions == '|')
-      ++itExtensions;
-  }
-
-  return false;
+  return HasExtensionOfFileName(strFileName.data(), strFileName.size(), strExtensions);
 }
 
 void URIUtils::RemoveExtension(std::string& strFileName)
@@ -285,6 +327,24 @@ bool URIUtils::HasParentInHostname(const CURL& url)
           CServiceBroker::GetFileExtensionProvider().EncodedHostName(url.GetProtocol()));
 }
 
+bool URIUtils::HasParentInHostname(const CURLView& url)
+{
+  return url.IsProtocol("zip")
+      || url.IsProtocol("apk")
+      || url.IsProtocol("bluray")
+      || url.IsProtocol("udf")
+      || url.IsProtocol("xbt")
+      || (url.HasProtocol() && CServiceBroker::IsBinaryAddonCacheUp() &&
+          CServiceBroker::GetFileExtensionProvider().EncodedHostName(url.GetProtocol()));
+}
+
+bool URIUtils::HasEncodedHostname(const CURLView& url)
+{
+  return HasParentInHostname(url)
+      || url.IsProtocol("musicsearch")
+      || url.IsProtocol( "image");
+}
+
 bool URIUtils::HasEncodedHostname(const CURL& url)
 {
   return HasParentInHostname(url)
@@ -529,7 +589,8 @@ std::string URIUtils::SubstitutePath(const std::string& strPath, bool reverse /*
 
 bool URIUtils::IsProtocol(const std::string& url, const std::string &type)
 {
-  return StringUtils::StartsWithNoCase(url, type + "://");
+  return url.size() > type.size() + 2 && StringUtils::StartsWithNoCase(url, type) &&
+         url.compare(type.size(), 3, "://") == 0;
 }
 
 bool URIUtils::PathHasParent(std::string path, std::string parent, bool translate /* = false */)
@@ -591,7 +652,7 @@ bool URIUtils::IsRemote(const std::string& strFile)
     return false;
   }
 
-  CURL url(strFile);
+  const CURLView url(strFile);
   if(HasParentInHostname(url))
     return IsRemote(url.GetHostName());
 
@@ -660,7 +721,7 @@ bool URIUtils::IsOnLAN(const std::string& strPath)
   if(IsUPnP(strPath))
     return true;
 
-  CURL url(strPath);
+  const CURLView url(strPath);
   if (HasParentInHostname(url))
     return IsOnLAN(url.GetHostName());
 
@@ -726,18 +787,17 @@ bool URIUtils::IsMultiPath(const std::string& strPath)
 
 bool URIUtils::IsHD(const std::string& strFileName)
 {
-  CURL url(strFileName);
-
   if (IsStack(strFileName))
     return IsHD(CStackDirectory::GetFirstStackedFile(strFileName));
 
   if (IsSpecial(strFileName))
     return IsHD(CSpecialProtocol::TranslatePath(strFileName));
 
+  const CURLView url(strFileName);
   if (HasParentInHostname(url))
     return IsHD(url.GetHostName());
 
-  return url.GetProtocol().empty() || url.IsProtocol("file") || url.IsProtocol("win-lib");
+  return !url.HasProtocol() || url.IsProtocol("file") || url.IsProtocol("win-lib");
 }
 
 bool URIUtils::IsDVD(const std::string& strFile)
@@ -789,7 +849,7 @@ bool URIUtils::IsRAR(const std::string& strFile)
 
 bool URIUtils::IsInArchive(const std::string &strFile)
 {
-  CURL url(strFile);
+  const CURLView url(strFile);
 
   bool archiveProto = url.IsProtocol("archive") && !url.GetFileName().empty();
   return archiveProto || IsInZIP(strFile) || IsInRAR(strFile) || IsInAPK(strFile);
@@ -797,14 +857,14 @@ bool URIUtils::IsInArchive(const std::string &strFile)
 
 bool URIUtils::IsInAPK(const std::string& strFile)
 {
-  CURL url(strFile);
+  const CURLView url(strFile);
 
   return url.IsProtocol("apk") && !url.GetFileName().empty();
 }
 
 bool URIUtils::IsInZIP(const std::string& strFile)
 {
-  CURL url(strFile);
+  const CURLView url(strFile);
 
   if (url.GetFileName().empty())
     return false;
@@ -817,7 +877,7 @@ bool URIUtils::IsInZIP(const std::string& strFile)
 
 bool URIUtils::IsInRAR(const std::string& strFile)
 {
-  CURL url(strFile);
+  const CURLView url(strFile);
 
   if (url.GetFileName().empty())
     return false;
@@ -853,26 +913,22 @@ bool URIUtils::IsSpecial(const std::string& strFile)
 
 bool URIUtils::IsPlugin(const std::string& strFile)
 {
-  CURL url(strFile);
-  return url.IsProtocol("plugin");
+  return IsProtocol(strFile, "plugin");
 }
 
 bool URIUtils::IsScript(const std::string& strFile)
 {
-  CURL url(strFile);
-  return url.IsProtocol("script");
+  return IsProtocol(strFile, "script");
 }
 
 bool URIUtils::IsAddonsPath(const std::string& strFile)
 {
-  CURL url(strFile);
-  return url.IsProtocol("addons");
+  return IsProtocol(strFile, "addons");
 }
 
 bool URIUtils::IsSourcesPath(const std::string& strPath)
 {
-  CURL url(strPath);
-  return url.IsProtocol("sources");
+  return IsProtocol(strPath, "sources");
 }
 
 bool URIUtils::IsCDDA(const std::string& strFile)
@@ -893,7 +949,7 @@ bool URIUtils::IsSmb(const std::string& strFile)
   if (IsSpecial(strFile))
     return IsSmb(CSpecialProtocol::TranslatePath(strFile));
 
-  CURL url(strFile);
+  const CURLView url(strFile);
   if (HasParentInHostname(url))
     return IsSmb(url.GetHostName());
 
@@ -913,7 +969,7 @@ bool URIUtils::IsFTP(const std::string& strFile)
   if (IsSpecial(strFile))
     return IsFTP(CSpecialProtocol::TranslatePath(strFile));
 
-  CURL url(strFile);
+  const CURLView url(strFile);
   if (HasParentInHostname(url))
     return IsFTP(url.GetHostName());
 
@@ -929,7 +985,7 @@ bool URIUtils::IsHTTP(const std::string& strFile)
   if (IsSpecial(strFile))
     return IsHTTP(CSpecialProtocol::TranslatePath(strFile));
 
-  CURL url(strFile);
+  const CURLView url(strFile);
   if (HasParentInHostname(url))
     return IsHTTP(url.GetHostName());
 
@@ -993,7 +1049,7 @@ bool URIUtils::IsDAV(const std::string& strFile)
   if (IsSpecial(strFile))
     return IsDAV(CSpecialProtocol::TranslatePath(strFile));
 
-  CURL url(strFile);
+  const CURLView url(strFile);
   if (HasParentInHostname(url))
     return IsDAV(url.GetHostName());
 
@@ -1003,8 +1059,18 @@ bool URIUtils::IsDAV(const std::string& strFile)
 
 bool URIUtils::IsInternetStream(const std::string &path, bool bStrictCheck /* = false */)
 {
-  const CURL pathToUrl(path);
-  return IsInternetStream(pathToUrl, bStrictCheck);
+  const CURLView url(path);
+  if (!url.HasProtocol())
+    return false;
+
+  // there's nothing to stop internet streams from being stacked
+  if (url.IsProtocol("stack"))
+    return IsInternetStream(CStackDirectory::GetFirstStackedFile(path));
+
+  if (url.IsProtocolIn(STRICT_INTERNET_STREAM_PROTOCOLS))
+    return bStrictCheck;
+
+  return url.IsTranslatedProtocolIn(INTERNET_STREAM_PROTOCOLS);
 }
 
 bool URIUtils::IsInternetStream(const CURL& url, bool bStrictCheck /* = false */)
@@ -1016,25 +1082,10 @@ bool URIUtils::IsInternetStream(const CURL& url, bool bStrictCheck /* = false */
   if (url.IsProtocol("stack"))
     return IsInternetStream(CStackDirectory::GetFirstStackedFile(url.Get()));
 
-  // Special case these
-  //! @todo sftp special case has to be handled by vfs addon
-  if (url.IsProtocol("ftp") || url.IsProtocol("ftps")  ||
-      url.IsProtocol("dav") || url.IsProtocol("davs")  ||
-      url.IsProtocol("sftp"))
+  if (url.IsProtocolIn(STRICT_INTERNET_STREAM_PROTOCOLS))
     return bStrictCheck;
 
-  std::string protocol = url.GetTranslatedProtocol();
-  if (CURL::IsProtocolEqual(protocol, "http")  || CURL::IsProtocolEqual(protocol, "https")  ||
-      CURL::IsProtocolEqual(protocol, "tcp")   || CURL::IsProtocolEqual(protocol, "udp")    ||
-      CURL::IsProtocolEqual(protocol, "rtp")   || CURL::IsProtocolEqual(protocol, "sdp")    ||
-      CURL::IsProtocolEqual(protocol, "mms")   || CURL::IsProtocolEqual(protocol, "mmst")   ||
-      CURL::IsProtocolEqual(protocol, "mmsh")  || CURL::IsProtocolEqual(protocol, "rtsp")   ||
-      CURL::IsProtocolEqual(protocol, "rtmp")  || CURL::IsProtocolEqual(protocol, "rtmpt")  ||
-      CURL::IsProtocolEqual(protocol, "rtmpe") || CURL::IsProtocolEqual(protocol, "rtmpte") ||
-      CURL::IsProtocolEqual(protocol, "rtmps"))
-    return true;
-
-  return false;
+  return CURL::IsProtocolIn(url.GetTranslatedProtocol(), INTERNET_STREAM_PROTOCOLS);
 }
 
 bool URIUtils::IsUPnP(const std::string& strFile)
@@ -1076,7 +1127,7 @@ bool URIUtils::IsNfs(const std::string& strFile)
   if (IsSpecial(strFile))
     return IsNfs(CSpecialProtocol::TranslatePath(strFile));
 
-  CURL url(strFile);
+  const CURLView url(strFile);
   if (HasParentInHostname(url))
     return IsNfs(url.GetHostName());
 
@@ -1100,8 +1151,7 @@ bool URIUtils::IsAndroidApp(const std::string &path)
 
 bool URIUtils::IsLibraryFolder(const std::string& strFile)
 {
-  CURL url(strFile);
-  return url.IsProtocol("library");
+  return IsProtocol(strFile, "library");
 }
 
 bool URIUtils::IsLibraryContent(const std::string &strFile)
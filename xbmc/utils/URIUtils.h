@@ -12,6 +12,7 @@
 #include <vector>
 
 class CURL;
+class CURLView;
 class CAdvancedSettings;
 
 class URIUtils
@@ -191,7 +192,9 @@ public:
   }
 
   static bool HasParentInHostname(const CURL& url);
+  static bool HasParentInHostname(const CURLView& url);
   static bool HasEncodedHostname(const CURL& url);
+  static bool HasEncodedHostname(const CURLView& url);
   static bool HasEncodedFilename(const CURL& url);
 
   /*!
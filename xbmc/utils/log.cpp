@@ -14,8 +14,13 @@
 #include "threads/CriticalSection.h"
 #include "threads/SingleLock.h"
 #include "threads/Thread.h"
+#include "utils/AsyncLogWriter.h"
 #include "utils/StringUtils.h"
 
+#include <ctype.h>
+#include <deque>
+#include <string.h>
+
 #if defined(TARGET_POSIX)
 #include "platform/posix/utils/PosixInterfaceForCLog.h"
 typedef class CPosixInterfaceForCLog PlatformInterfaceForCLog;
@@ -34,6 +39,8 @@ static const char* const logLevelNames[] =
 
 namespace
 {
+void WriteLogRecords(const std::vector<CAsyncLogWriter::Record>& records, uint64_t dropped);
+
 class CLogGlobals
 {
 public:
@@ -45,9 +52,112 @@ public:
   int         m_logLevel = LOG_LEVEL_DEBUG;
   int         m_extraLogLevels = 0;
   CCriticalSection critSec;
+  CAsyncLogWriter m_writer{&WriteLogRecords};
 };
 
 static CLogGlobals g_logState;
+
+CAsyncLogWriter::Time GetLogTime()
+{
+  CAsyncLogWriter::Time time;
+  double millisecond;
+  g_logState.m_platform.GetCurrentLocalTime(time.year, time.month, time.day, time.hour, time.minute, time.second, millisecond);
+  time.millisecond = static_cast<int>(millisecond);
+  return time;
+}
+
+std::string FormatLogPrefix(int logLevel, uint64_t threadId, const CAsyncLogWriter::Time& time)
+{
+  static const char* prefixFormat = "%02d-%02d-%02d %02d:%02d:%02d.%03d T:%" PRIu64" %7s: ";
+
+  return StringUtils::Format(prefixFormat,
+                             time.year,
+                             time.month,
+                             time.day,
+                             time.hour,
+                             time.minute,
+                             time.second,
+                             time.millisecond,
+                             threadId,
+                             levelNames[logLevel]);
+}
+
+void AppendLogLine(std::deque<std::string>& storage,
+                   std::vector<std::pair<const char*, size_t>>& buffers,
+                   int logLevel,
+                   uint64_t threadId,
+                   const CAsyncLogWriter::Time& time,
+                   const char* line,
+                   size_t length)
+{
+  storage.push_back(FormatLogPrefix(logLevel, threadId, time));
+  buffers.emplace_back(storage.back().c_str(), storage.back().size());
+
+  if (memchr(line, '\n', length))
+  {
+    /* fixup newline alignment, number of spaces should equal prefix length */
+    storage.emplace_back(line, length);
+    StringUtils::Replace(storage.back(), "\n", "\n                                            ");
+    buffers.emplace_back(storage.back().c_str(), storage.back().size());
+  }
+  else
+    buffers.emplace_back(line, length);
+
+  buffers.emplace_back("\n", 1);
+}
+
+// sink of the async writer, works like CLog::LogString for a batch of messages
+void WriteLogRecords(const std::vector<CAsyncLogWriter::Record>& records, uint64_t dropped)
+{
+  CSingleLock waitLock(g_logState.critSec);
+
+  // the messages are written straight from the ring buffers, only prefixes are stored here
+  std::deque<std::string> storage;
+  std::vector<std::pair<const char*, size_t>> buffers;
+  buffers.reserve(records.size() * 3 + 6);
+
+  if (dropped)
+  {
+    const std::string line = StringUtils::Format("Log buffer full, %" PRIu64 " message(s) dropped.", dropped);
+    CLog::PrintDebugString(line);
+    AppendLogLine(storage, buffers, LOGWARNING, CThread::GetCurrentThreadNativeId(), GetLogTime(), line.c_str(), line.size());
+  }
+
+  for (const CAsyncLogWriter::Record& record : records)
+  {
+    size_t length = record.length;
+    while (length > 0 && isspace(static_cast<unsigned char>(record.message[length - 1])))
+      length--;
+    if (length == 0)
+      continue;
+
+    if (g_logState.m_repeatLogLevel == record.level &&
+        g_logState.m_repeatLine.compare(0, std::string::npos, record.message, length) == 0)
+    {
+      g_logState.m_repeatCount++;
+      continue;
+    }
+    else if (g_logState.m_repeatCount)
+    {
+      storage.push_back(StringUtils::Format("Previous line repeats %d times.",
+                                            g_logState.m_repeatCount));
+      const std::string& line = storage.back();
+      CLog::PrintDebugString(line);
+      AppendLogLine(storage, buffers, g_logState.m_repeatLogLevel, record.threadId, record.time, line.c_str(), line.size());
+      g_logState.m_repeatCount = 0;
+    }
+
+    g_logState.m_repeatLine.assign(record.message, length);
+    g_logState.m_repeatLogLevel = record.level;
+
+    CLog::PrintDebugString(g_logState.m_repeatLine);
+
+    AppendLogLine(storage, buffers, record.level, record.threadId, record.time, record.message, length);
+  }
+
+  if (!buffers.empty())
+    g_logState.m_platform.WriteBuffersToLog(buffers);
+}
 }
 
 CLog::CLog() = default;
@@ -56,6 +166,9 @@ CLog::~CLog() = default;
 
 void CLog::Close()
 {
+  // everything queued has to be written before the file goes away
+  g_logState.m_writer.Stop();
+
   CSingleLock waitLock(g_logState.critSec);
   g_logState.m_platform.CloseLogFile();
   g_logState.m_repeatLine.clear();
@@ -63,6 +176,15 @@ void CLog::Close()
 
 void CLog::LogString(int logLevel, std::string&& logString)
 {
+  if (g_logState.m_writer.Push(logLevel, CThread::GetCurrentThreadNativeId(), GetLogTime(), logString))
+  {
+    // make sure the last words before a crash make it to disk
+    if (logLevel >= LOGSEVERE)
+      g_logState.m_writer.Flush();
+    return;
+  }
+
+  // no log writer running, write on the calling thread
   CSingleLock waitLock(g_logState.critSec);
   std::string strData(logString);
   StringUtils::TrimRight(strData);
@@ -106,7 +228,11 @@ bool CLog::Init(const std::string& path)
 
   std::string appName = CCompileInfo::GetAppName();
   StringUtils::ToLower(appName);
-  return g_logState.m_platform.OpenLogFile(path + appName + ".log", path + appName + ".old.log");
+  if (!g_logState.m_platform.OpenLogFile(path + appName + ".log", path + appName + ".old.log"))
+    return false;
+
+  g_logState.m_writer.Start();
+  return true;
 }
 
 void CLog::MemDump(char *pData, int length)
@@ -142,10 +268,12 @@ void CLog::MemDump(char *pData, int length)
 
 void CLog::SetLogLevel(int level)
 {
-  CSingleLock waitLock(g_logState.critSec);
   if (level >= LOG_LEVEL_NONE && level <= LOG_LEVEL_MAX)
   {
-    g_logState.m_logLevel = level;
+    {
+      CSingleLock waitLock(g_logState.critSec);
+      g_logState.m_logLevel = level;
+    }
     CLog::Log(LOGNOTICE, "Log level changed to \"%s\"", logLevelNames[g_logState.m_logLevel + 1]);
   }
   else
@@ -188,26 +316,16 @@ void CLog::PrintDebugString(const std::string& line)
 
 bool CLog::WriteLogString(int logLevel, const std::string& logString)
 {
-  static const char* prefixFormat = "%02d-%02d-%02d %02d:%02d:%02d.%03d T:%" PRIu64" %7s: ";
-
   std::string strData(logString);
   /* fixup newline alignment, number of spaces should equal prefix length */
   StringUtils::Replace(strData, "\n", "\n                                            ");
 
-  int year, month, day, hour, minute, second;
-  double millisecond;
-  g_logState.m_platform.GetCurrentLocalTime(year, month, day, hour, minute, second, millisecond);
-
-  strData = StringUtils::Format(prefixFormat,
-                                  year,
-                                  month,
-                                  day,
-                                  hour,
-                                  minute,
-                                  second,
-                                  static_cast<int>(millisecond),
-                                  static_cast<uint64_t>(CThread::GetCurrentThreadNativeId()),
-                                  levelNames[logLevel]) + strData;
+  strData = FormatLogPrefix(logLevel, CThread::GetCurrentThreadNativeId(), GetLogTime()) + strData;
 
   return g_logState.m_platform.WriteStringToLog(strData);
 }
+
+uint64_t CLog::GetDroppedCount()
+{
+  return g_logState.m_writer.GetDroppedCount();
+}
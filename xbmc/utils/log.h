@@ -11,6 +11,7 @@
 #include "commons/ilog.h"
 #include "utils/StringUtils.h"
 
+#include <stdint.h>
 #include <string>
 #include <utility>
 
@@ -98,6 +99,11 @@ public:
   static void SetExtraLogLevels(int level);
   static bool IsLogLevelLogged(int loglevel);
 
+  /*!
+   \brief Number of messages dropped because a logging thread outran the log writer.
+   */
+  static uint64_t GetDroppedCount();
+
 protected:
   static void LogString(int logLevel, std::string&& logString);
   static void LogString(int logLevel, int component, std::string&& logString);
@@ -0,0 +1,153 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "commons/ilog.h"
+#include "threads/Event.h"
+#include "utils/AsyncLogWriter.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+CAsyncLogWriter::Time TestTime()
+{
+  return CAsyncLogWriter::Time{2020, 1, 1, 0, 0, 0, 0};
+}
+
+class CRecordingSink
+{
+public:
+  void Write(const std::vector<CAsyncLogWriter::Record>& records, uint64_t dropped)
+  {
+    m_batches++;
+    m_dropped += dropped;
+    for (const auto& record : records)
+    {
+      m_threadIds.push_back(record.threadId);
+      m_messages.emplace_back(record.message, record.length);
+    }
+    m_release.Wait();
+  }
+
+  CEvent m_release{true, true};
+  std::vector<uint64_t> m_threadIds;
+  std::vector<std::string> m_messages;
+  uint64_t m_dropped = 0;
+  int m_batches = 0;
+};
+}
+
+TEST(TestAsyncLogWriter, NotStarted)
+{
+  CRecordingSink sink;
+  CAsyncLogWriter writer([&sink](const std::vector<CAsyncLogWriter::Record>& records,
+                                 uint64_t dropped) { sink.Write(records, dropped); });
+
+  EXPECT_FALSE(writer.Push(LOGDEBUG, 1, TestTime(), "message"));
+  EXPECT_TRUE(sink.m_messages.empty());
+}
+
+TEST(TestAsyncLogWriter, WritesInOrder)
+{
+  CRecordingSink sink;
+  CAsyncLogWriter writer([&sink](const std::vector<CAsyncLogWriter::Record>& records,
+                                 uint64_t dropped) { sink.Write(records, dropped); });
+  writer.Start();
+
+  const int threadCount = 4;
+  const int messageCount = 500;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threadCount; t++)
+  {
+    threads.emplace_back([&writer, t]() {
+      for (int i = 0; i < messageCount; i++)
+        writer.Push(LOGDEBUG, t, TestTime(), std::to_string(i));
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  writer.Stop();
+
+  ASSERT_EQ(0u, writer.GetDroppedCount());
+  ASSERT_EQ(static_cast<size_t>(threadCount * messageCount), sink.m_messages.size());
+  EXPECT_EQ(sink.m_messages.size(), writer.GetWrittenCount());
+
+  // the messages of every thread arrive in the order they were logged
+  std::vector<int> next(threadCount, 0);
+  for (size_t i = 0; i < sink.m_messages.size(); i++)
+  {
+    const uint64_t thread = sink.m_threadIds[i];
+    EXPECT_EQ(std::to_string(next[thread]), sink.m_messages[i]);
+    next[thread]++;
+  }
+}
+
+TEST(TestAsyncLogWriter, WrapAround)
+{
+  CRecordingSink sink;
+  CAsyncLogWriter writer([&sink](const std::vector<CAsyncLogWriter::Record>& records,
+                                 uint64_t dropped) { sink.Write(records, dropped); },
+                         4096);
+  writer.Start();
+
+  // records of varying size so they end up split at the end of the ring
+  const std::string text(300, 'x');
+  for (int i = 0; i < 200; i++)
+  {
+    writer.Push(LOGERROR, 1, TestTime(), text.substr(0, i % 300));
+    writer.Flush();
+  }
+  writer.Stop();
+
+  ASSERT_EQ(200u, sink.m_messages.size());
+  for (int i = 0; i < 200; i++)
+    EXPECT_EQ(text.substr(0, i % 300), sink.m_messages[i]);
+}
+
+TEST(TestAsyncLogWriter, DropsWhenFull)
+{
+  CRecordingSink sink;
+  sink.m_release.Reset();
+  CAsyncLogWriter writer([&sink](const std::vector<CAsyncLogWriter::Record>& records,
+                                 uint64_t dropped) { sink.Write(records, dropped); },
+                         4096);
+  writer.Start();
+
+  // the sink blocks, so the ring fills up
+  const int messageCount = 1000;
+  for (int i = 0; i < messageCount; i++)
+    EXPECT_TRUE(writer.Push(LOGDEBUG, 1, TestTime(), "message"));
+
+  sink.m_release.Set();
+  writer.Stop();
+
+  EXPECT_GT(sink.m_dropped, 0u);
+  EXPECT_EQ(sink.m_dropped, writer.GetDroppedCount());
+  EXPECT_EQ(static_cast<size_t>(messageCount), sink.m_messages.size() + sink.m_dropped);
+}
+
+TEST(TestAsyncLogWriter, TruncatesLongMessages)
+{
+  CRecordingSink sink;
+  CAsyncLogWriter writer([&sink](const std::vector<CAsyncLogWriter::Record>& records,
+                                 uint64_t dropped) { sink.Write(records, dropped); },
+                         4096);
+  writer.Start();
+
+  writer.Push(LOGDEBUG, 1, TestTime(), std::string(10000, 'x'));
+  writer.Stop();
+
+  ASSERT_EQ(1u, sink.m_messages.size());
+  EXPECT_LT(sink.m_messages[0].size(), 4096u);
+  EXPECT_EQ(0u, writer.GetDroppedCount());
+}
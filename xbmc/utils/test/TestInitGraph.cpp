@@ -0,0 +1,197 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "AppParamParser.h"
+#include "ServiceManager.h"
+#include "utils/InitGraph.h"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+struct StepTrace
+{
+  int start = -1;
+  int end = -1;
+  std::thread::id thread;
+};
+
+class TestInitGraph : public testing::Test
+{
+protected:
+  void AddStep(CInitGraph& graph,
+               const std::string& name,
+               std::vector<std::string> dependencies,
+               bool success = true,
+               CInitGraph::Affinity affinity = CInitGraph::ANY_THREAD)
+  {
+    StepTrace* trace = &m_traces[name];
+    graph.Add(name, std::move(dependencies), [this, trace, success]() {
+      trace->start = m_clock++;
+      trace->thread = std::this_thread::get_id();
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      trace->end = m_clock++;
+      return success;
+    }, affinity);
+  }
+
+  std::atomic<int> m_clock{0};
+  std::map<std::string, StepTrace> m_traces;
+};
+}
+
+TEST_F(TestInitGraph, DependenciesFinishFirst)
+{
+  const std::map<std::string, std::vector<std::string>> steps = {
+    {"platform", {}},
+    {"database", {"platform"}},
+    {"addons", {"platform", "database"}},
+    {"addons.init", {"addons"}},
+    {"cache", {"addons.init"}},
+    {"pvr", {"addons", "cache"}},
+    {"favourites", {"platform"}},
+    {"weather", {"platform"}},
+  };
+
+  CInitGraph graph("test");
+  for (const auto& step : steps)
+    AddStep(graph, step.first, step.second);
+
+  EXPECT_TRUE(graph.Run(4));
+  EXPECT_TRUE(graph.GetFailed().empty());
+
+  for (const auto& step : steps)
+  {
+    const StepTrace& trace = m_traces[step.first];
+    ASSERT_GE(trace.start, 0) << step.first;
+    for (const std::string& dependency : step.second)
+      EXPECT_GT(trace.start, m_traces[dependency].end) << step.first << " started before " << dependency;
+  }
+}
+
+TEST_F(TestInitGraph, DependsOn)
+{
+  CInitGraph graph("test");
+  AddStep(graph, "a", {});
+  AddStep(graph, "b", {"a"});
+  AddStep(graph, "c", {"b"}, true, CInitGraph::MAIN_THREAD);
+
+  EXPECT_TRUE(graph.DependsOn("b", "a"));
+  EXPECT_TRUE(graph.DependsOn("c", "a"));
+  EXPECT_FALSE(graph.DependsOn("a", "c"));
+  EXPECT_FALSE(graph.DependsOn("missing", "a"));
+  EXPECT_TRUE(graph.IsMainThreadStep("c"));
+  EXPECT_FALSE(graph.IsMainThreadStep("b"));
+}
+
+TEST(TestServiceManagerInit, StageTwo)
+{
+  CServiceManager serviceManager;
+  CAppParamParser params;
+  CInitGraph graph("test");
+  serviceManager.AddStageTwoSteps(graph, params, "");
+
+  // the platform sets up the environment for everything else
+  for (const char* step : {"databasemanager", "binaryaddonmanager", "addonmanager", "vfsaddoncache",
+                           "pvrmanager", "datacachecore", "favouritesservice", "serviceaddons",
+                           "contextmenumanager", "gamecontrollermanager", "inputmanager",
+                           "peripherals", "gamerendermanager", "fileextensionprovider",
+                           "powermanager", "weathermanager"})
+    EXPECT_TRUE(graph.DependsOn(step, "platform")) << step;
+
+  // the PVR clients look up their add-ons on construction
+  EXPECT_TRUE(graph.DependsOn("pvrmanager", "addonmanager"));
+  EXPECT_TRUE(graph.DependsOn("pvrmanager", "binaryaddonmanager"));
+  EXPECT_TRUE(graph.DependsOn("pvrmanager", "vfsaddoncache"));
+  EXPECT_TRUE(graph.DependsOn("addonmanager", "databasemanager"));
+  EXPECT_TRUE(graph.DependsOn("binaryaddoncache", "addonmanager"));
+  EXPECT_TRUE(graph.DependsOn("fileextensionprovider", "binaryaddonmanager.init"));
+  EXPECT_TRUE(graph.DependsOn("peripherals", "inputmanager"));
+
+  for (const char* step : {"platform", "pvrmanager", "inputmanager", "peripherals", "powermanager"})
+    EXPECT_TRUE(graph.IsMainThreadStep(step)) << step;
+}
+
+TEST(TestServiceManagerInit, StageThree)
+{
+  CServiceManager serviceManager;
+  CInitGraph graph("test");
+  serviceManager.AddStageThreeSteps(graph, nullptr);
+
+  // initialized one after another on the main thread, as none of them is safe to run concurrently
+  EXPECT_TRUE(graph.DependsOn("gameservices", "peripherals.init"));
+  EXPECT_TRUE(graph.DependsOn("contextmenumanager.init", "gameservices"));
+  EXPECT_TRUE(graph.DependsOn("pvrmanager.init", "contextmenumanager.init"));
+  for (const char* step : {"peripherals.init", "gameservices", "contextmenumanager.init", "pvrmanager.init"})
+    EXPECT_TRUE(graph.IsMainThreadStep(step)) << step;
+}
+
+TEST_F(TestInitGraph, MainThreadSteps)
+{
+  CInitGraph graph("test");
+  AddStep(graph, "a", {});
+  AddStep(graph, "b", {"a"}, true, CInitGraph::MAIN_THREAD);
+  AddStep(graph, "c", {}, true, CInitGraph::MAIN_THREAD);
+  AddStep(graph, "d", {"b"});
+
+  EXPECT_TRUE(graph.Run(2));
+  EXPECT_EQ(std::this_thread::get_id(), m_traces["b"].thread);
+  EXPECT_EQ(std::this_thread::get_id(), m_traces["c"].thread);
+  EXPECT_GT(m_traces["d"].start, m_traces["b"].end);
+}
+
+TEST_F(TestInitGraph, NoWorkers)
+{
+  CInitGraph graph("test");
+  AddStep(graph, "a", {});
+  AddStep(graph, "b", {"a"});
+
+  EXPECT_TRUE(graph.Run(0));
+  EXPECT_EQ(std::this_thread::get_id(), m_traces["a"].thread);
+  EXPECT_EQ(std::this_thread::get_id(), m_traces["b"].thread);
+}
+
+TEST_F(TestInitGraph, FailureSkipsDependents)
+{
+  CInitGraph graph("test");
+  AddStep(graph, "a", {}, false);
+  AddStep(graph, "b", {"a"});
+  AddStep(graph, "c", {"b"});
+  AddStep(graph, "d", {});
+
+  EXPECT_FALSE(graph.Run(2));
+  EXPECT_EQ(-1, m_traces["b"].start);
+  EXPECT_EQ(-1, m_traces["c"].start);
+  EXPECT_GE(m_traces["d"].start, 0);
+
+  const std::vector<std::string> expected = {"a", "b", "c"};
+  EXPECT_EQ(expected, graph.GetFailed());
+}
+
+TEST_F(TestInitGraph, InvalidDependencies)
+{
+  CInitGraph unknown("test");
+  AddStep(unknown, "a", {"missing"});
+  EXPECT_FALSE(unknown.Run(2));
+  EXPECT_EQ(-1, m_traces["a"].start);
+
+  CInitGraph cycle("test");
+  AddStep(cycle, "b", {"d"});
+  AddStep(cycle, "c", {"b"});
+  AddStep(cycle, "d", {"c"});
+  AddStep(cycle, "e", {});
+  EXPECT_FALSE(cycle.Run(2));
+  EXPECT_EQ(-1, m_traces["e"].start);
+}
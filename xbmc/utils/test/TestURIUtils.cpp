@@ -302,6 +302,15 @@ TEST_F(TestURIUtils, IsInternetStream)
   CURL url2("https://path/to/file");
   EXPECT_TRUE(URIUtils::IsInternetStream(url1));
   EXPECT_TRUE(URIUtils::IsInternetStream(url2));
+
+  // the string overload parses with CURLView and has to agree with the CURL one
+  for (const char* path : {"http://path/to/file", "shout://path/to/file", "rss://path/to/file",
+                           "dav://path/to/file", "ftp://path/to/file", "sftp://path/to/file",
+                           "rtmp://path/to/file", "smb://path/to/file", "/path/to/file"})
+  {
+    EXPECT_EQ(URIUtils::IsInternetStream(CURL(path)), URIUtils::IsInternetStream(path)) << path;
+    EXPECT_EQ(URIUtils::IsInternetStream(CURL(path), true), URIUtils::IsInternetStream(path, true)) << path;
+  }
 }
 
 TEST_F(TestURIUtils, IsInZIP)
@@ -14,7 +14,11 @@
 #include "utils/StringUtils.h"
 #include "utils/log.h"
 
+#include <algorithm>
+#include <atomic>
 #include <stdlib.h>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -139,3 +143,53 @@ TEST_F(Testlog, SetLogLevel)
   CLog::Close();
   EXPECT_TRUE(XFILE::CFile::Delete(logfile));
 }
+
+TEST_F(Testlog, CallerLatency)
+{
+  std::string logfile;
+
+  std::string appName = CCompileInfo::GetAppName();
+  StringUtils::ToLower(appName);
+  logfile = CSpecialProtocol::TranslatePath("special://temp/") + appName + ".log";
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/").c_str()));
+
+  // time spent in CLog::Log by the logging threads, the writer does the disk I/O
+  const int messageCount = 2000;
+  for (int threadCount = 1; threadCount <= 32; threadCount *= 2)
+  {
+    std::atomic<int64_t> totalUs{0};
+    std::atomic<int64_t> maxUs{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++)
+    {
+      threads.emplace_back([&totalUs, &maxUs, t]() {
+        int64_t max = 0;
+        CTestStopwatch total;
+        CTestStopwatch call;
+        for (int i = 0; i < messageCount; i++)
+        {
+          call.Lap();
+          CLog::Log(LOGDEBUG, "latency test thread %d message %d", t, i);
+          max = std::max(max, call.Lap());
+        }
+        totalUs += total.Lap();
+        int64_t current = maxUs;
+        while (max > current && !maxUs.compare_exchange_weak(current, max))
+          ;
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+
+    RecordProperty(StringUtils::Format("threads_%d_mean_ns", threadCount),
+                   static_cast<int>(totalUs * 1000 / (threadCount * messageCount)));
+    RecordProperty(StringUtils::Format("threads_%d_max_us", threadCount),
+                   static_cast<int>(maxUs));
+  }
+
+  CLog::Close();
+  RecordProperty("dropped", static_cast<int>(CLog::GetDroppedCount()));
+
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+}
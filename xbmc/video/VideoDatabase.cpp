@@ -538,13 +538,11 @@ void CVideoDatabase::CreateViews()
 //********************************************************************************************************************************
 int CVideoDatabase::GetPathId(const std::string& strPath)
 {
-  std::string strSQL;
   try
   {
     int idPath=-1;
-    if (nullptr == m_pDB)
-      return -1;
-    if (nullptr == m_pDS)
+    const std::shared_ptr<Statement> statement = GetStatement("SELECT idPath FROM path WHERE strPath=?");
+    if (nullptr == statement)
       return -1;
 
     std::string strPath1(strPath);
@@ -553,17 +551,15 @@ int CVideoDatabase::GetPathId(const std::string& strPath)
 
     URIUtils::AddSlashAtEnd(strPath1);
 
-    strSQL=PrepareSQL("select idPath from path where strPath='%s'",strPath1.c_str());
-    m_pDS->query(strSQL);
-    if (!m_pDS->eof())
-      idPath = m_pDS->fv("path.idPath").get_asInt();
+    statement->bind(1, strPath1);
+    if (statement->step())
+      idPath = statement->getInt(0);
 
-    m_pDS->close();
     return idPath;
   }
   catch (...)
   {
-    CLog::Log(LOGERROR, "%s unable to getpath (%s)", __FUNCTION__, strSQL.c_str());
+    CLog::Log(LOGERROR, "%s unable to getpath (%s)", __FUNCTION__, strPath.c_str());
   }
   return -1;
 }
@@ -1110,15 +1106,14 @@ int CVideoDatabase::GetFileId(const std::string& strFilenameAndPath)
     int idPath = GetPathId(strPath);
     if (idPath >= 0)
     {
-      std::string strSQL;
-      strSQL=PrepareSQL("select idFile from files where strFileName='%s' and idPath=%i", strFileName.c_str(),idPath);
-      m_pDS->query(strSQL);
-      if (m_pDS->num_rows() > 0)
-      {
-        int idFile = m_pDS->fv("files.idFile").get_asInt();
-        m_pDS->close();
-        return idFile;
-      }
+      const std::shared_ptr<Statement> statement = GetStatement("SELECT idFile FROM files WHERE strFileName=? AND idPath=?");
+      if (nullptr == statement)
+        return -1;
+
+      statement->bind(1, strFileName);
+      statement->bind(2, idPath);
+      if (statement->step())
+        return statement->getInt(0);
     }
   }
   catch (...)
@@ -3863,27 +3858,29 @@ bool CVideoDatabase::GetStreamDetails(CVideoInfoTag& tag) const
   CStreamDetails& details = tag.m_streamDetails;
   details.Reset();
 
-  std::unique_ptr<Dataset> pDS(m_pDB->CreateDataset());
   try
   {
-    std::string strSQL = PrepareSQL("SELECT * FROM streamdetails WHERE idFile = %i", tag.m_iFileId);
-    pDS->query(strSQL);
+    // a statement of its own, as we're likely called in loops on the datasets
+    const std::shared_ptr<Statement> statement = GetStatement("SELECT * FROM streamdetails WHERE idFile=?");
+    if (nullptr == statement)
+      return false;
 
-    while (!pDS->eof())
+    statement->bind(1, tag.m_iFileId);
+    while (statement->step())
     {
-      CStreamDetail::StreamType e = (CStreamDetail::StreamType)pDS->fv(1).get_asInt();
+      CStreamDetail::StreamType e = (CStreamDetail::StreamType)statement->getInt(1);
       switch (e)
       {
       case CStreamDetail::VIDEO:
         {
           CStreamDetailVideo *p = new CStreamDetailVideo();
-          p->m_strCodec = pDS->fv(2).get_asString();
-          p->m_fAspect = pDS->fv(3).get_asFloat();
-          p->m_iWidth = pDS->fv(4).get_asInt();
-          p->m_iHeight = pDS->fv(5).get_asInt();
-          p->m_iDuration = pDS->fv(10).get_asInt();
-          p->m_strStereoMode = pDS->fv(11).get_asString();
-          p->m_strLanguage = pDS->fv(12).get_asString();
+          statement->getString(2, p->m_strCodec);
+          p->m_fAspect = static_cast<float>(statement->getDouble(3));
+          p->m_iWidth = statement->getInt(4);
+          p->m_iHeight = statement->getInt(5);
+          p->m_iDuration = statement->getInt(10);
+          statement->getString(11, p->m_strStereoMode);
+          statement->getString(12, p->m_strLanguage);
           details.AddStream(p);
           retVal = true;
           break;
@@ -3891,12 +3888,12 @@ bool CVideoDatabase::GetStreamDetails(CVideoInfoTag& tag) const
       case CStreamDetail::AUDIO:
         {
           CStreamDetailAudio *p = new CStreamDetailAudio();
-          p->m_strCodec = pDS->fv(6).get_asString();
-          if (pDS->fv(7).get_isNull())
+          statement->getString(6, p->m_strCodec);
+          if (statement->isNull(7))
             p->m_iChannels = -1;
           else
-            p->m_iChannels = pDS->fv(7).get_asInt();
-          p->m_strLanguage = pDS->fv(8).get_asString();
+            p->m_iChannels = statement->getInt(7);
+          statement->getString(8, p->m_strLanguage);
           details.AddStream(p);
           retVal = true;
           break;
@@ -3904,17 +3901,13 @@ bool CVideoDatabase::GetStreamDetails(CVideoInfoTag& tag) const
       case CStreamDetail::SUBTITLE:
         {
           CStreamDetailSubtitle *p = new CStreamDetailSubtitle();
-          p->m_strLanguage = pDS->fv(9).get_asString();
+          statement->getString(9, p->m_strLanguage);
           details.AddStream(p);
           retVal = true;
           break;
         }
       }
-
-      pDS->next();
     }
-
-    pDS->close();
   }
   catch (...)
   {
@@ -4594,19 +4587,16 @@ bool CVideoDatabase::GetArtForItem(int mediaId, const MediaType &mediaType, std:
 {
   try
   {
-    if (nullptr == m_pDB)
+    // a statement of its own, as we're likely called in loops on the datasets
+    const std::shared_ptr<Statement> statement = GetStatement("SELECT type,url FROM art WHERE media_id=? AND media_type=?");
+    if (nullptr == statement)
       return false;
-    if (nullptr == m_pDS2)
-      return false; // using dataset 2 as we're likely called in loops on dataset 1
 
-    std::string sql = PrepareSQL("SELECT type,url FROM art WHERE media_id=%i AND media_type='%s'", mediaId, mediaType.c_str());
-    m_pDS2->query(sql);
-    while (!m_pDS2->eof())
-    {
-      art.insert(make_pair(m_pDS2->fv(0).get_asString(), m_pDS2->fv(1).get_asString()));
-      m_pDS2->next();
-    }
-    m_pDS2->close();
+    statement->bind(1, mediaId);
+    statement->bind(2, mediaType);
+    while (statement->step())
+      art.insert(std::make_pair(statement->getString(0), statement->getString(1)));
+
     return !art.empty();
   }
   catch (...)
@@ -4618,8 +4608,23 @@ bool CVideoDatabase::GetArtForItem(int mediaId, const MediaType &mediaType, std:
 
 std::string CVideoDatabase::GetArtForItem(int mediaId, const MediaType &mediaType, const std::string &artType)
 {
-  std::string query = PrepareSQL("SELECT url FROM art WHERE media_id=%i AND media_type='%s' AND type='%s'", mediaId, mediaType.c_str(), artType.c_str());
-  return GetSingleValue(query, m_pDS2);
+  try
+  {
+    const std::shared_ptr<Statement> statement = GetStatement("SELECT url FROM art WHERE media_id=? AND media_type=? AND type=?");
+    if (nullptr == statement)
+      return "";
+
+    statement->bind(1, mediaId);
+    statement->bind(2, mediaType);
+    statement->bind(3, artType);
+    if (statement->step())
+      return statement->getString(0);
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s(%d, '%s', '%s') failed", __FUNCTION__, mediaId, mediaType.c_str(), artType.c_str());
+  }
+  return "";
 }
 
 bool CVideoDatabase::RemoveArtForItem(int mediaId, const MediaType &mediaType, const std::string &artType)
@@ -7275,30 +7280,58 @@ bool CVideoDatabase::GetMoviesByWhere(const std::string& strBaseDir, const Filte
 
     strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
-    int iRowsFound = RunQuery(strSQL);
-    if (iRowsFound <= 0)
-      return iRowsFound == 0;
+    // the rows are read one at a time and turned into movies right away, only a sorted and
+    // limited listing keeps them until it's known which of them are listed
+    std::unique_ptr<Statement> statement = PrepareStatement(strSQL);
+    if (!statement)
+      return false;
+
+    const bool keepRows = sortDescription.sortBy != SortByNone &&
+                          (sortDescription.limitStart > 0 || sortDescription.limitEnd > 0);
+    const FieldList sortFields = SortUtils::GetSortFields(sortDescription.sortBy, MediaTypeMovie);
+
+    unsigned int time = XbmcThreads::SystemClockMillis();
+    DatabaseResults results;
+    std::vector<CVideoInfoTag> movies;
+    std::vector<sql_record> rows;
+    sql_record record;
+    while (statement->step())
+    {
+      statement->getRecord(record);
+
+      DatabaseResult result;
+      if (!DatabaseUtils::GetDatabaseResult(MediaTypeMovie, sortFields, record, results.size(), result))
+        return false;
+      results.push_back(std::move(result));
+
+      if (keepRows)
+        rows.push_back(record);
+      else
+        movies.push_back(GetDetailsForMovie(&record, getDetails));
+    }
+    statement.reset();
+    CLog::Log(LOGDEBUG, LOGDATABASE, "%s took %d ms for %d items query: %s", __FUNCTION__,
+              XbmcThreads::SystemClockMillis() - time, static_cast<int>(results.size()), strSQL.c_str());
+
+    int iRowsFound = static_cast<int>(results.size());
+    if (iRowsFound == 0)
+      return true;
 
     // store the total value of items as a property
     if (total < iRowsFound)
       total = iRowsFound;
     items.SetProperty("total", total);
 
-    DatabaseResults results;
-    results.reserve(iRowsFound);
-
-    if (!SortUtils::SortFromDataset(sortDescription, MediaTypeMovie, m_pDS, results))
-      return false;
+    SortUtils::SortDatabaseResults(sortDescription, results);
 
     // get data from returned rows
     items.Reserve(results.size());
-    const query_data &data = m_pDS->get_result_set().records;
     for (const auto &i : results)
     {
       unsigned int targetRow = (unsigned int)i.at(FieldRow).asInteger();
-      const dbiplus::sql_record* const record = data.at(targetRow);
 
-      CVideoInfoTag movie = GetDetailsForMovie(record, getDetails);
+      CVideoInfoTag movie = keepRows ? GetDetailsForMovie(&rows.at(targetRow), getDetails)
+                                     : std::move(movies.at(targetRow));
       if (m_profileManager.GetMasterProfile().getLockMode() == LOCK_MODE_EVERYONE ||
           g_passwordManager.bMasterUser                                   ||
           g_passwordManager.IsDatabasePathUnlocked(movie.m_strPath, *CMediaSourceSettings::GetInstance().GetSources("video")))
@@ -7316,8 +7349,6 @@ bool CVideoDatabase::GetMoviesByWhere(const std::string& strBaseDir, const Filte
       }
     }
 
-    // cleanup
-    m_pDS->close();
     return true;
   }
   catch (...)
@@ -10586,7 +10617,9 @@ bool CVideoDatabase::GetFilter(CDbUrl &videoUrl, Filter &filter, SortDescription
        (xsp.GetType() == "episodes" && itemType == "tvshows"))
     {
       std::set<std::string> playlists;
-      filter.AppendWhere(xsp.GetWhereClause(*this, playlists));
+      const std::string xspWhere = xsp.GetWhereClause(*this, playlists);
+      ExplainFilter(CSmartPlaylist::GetView(xsp.GetType()), xspWhere);
+      filter.AppendWhere(xspWhere);
 
       if (xsp.GetLimit() > 0)
         sorting.limitEnd = xsp.GetLimit();
@@ -10610,7 +10643,9 @@ bool CVideoDatabase::GetFilter(CDbUrl &videoUrl, Filter &filter, SortDescription
     if (xspFilter.GetType() == itemType)
     {
       std::set<std::string> playlists;
-      filter.AppendWhere(xspFilter.GetWhereClause(*this, playlists));
+      const std::string xspWhere = xspFilter.GetWhereClause(*this, playlists);
+      ExplainFilter(CSmartPlaylist::GetView(xspFilter.GetType()), xspWhere);
+      filter.AppendWhere(xspWhere);
     }
     // remove the filter if it doesn't match the item type
     else
@@ -0,0 +1,227 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "VideoThumbExtractionService.h"
+
+#include "ServiceBroker.h"
+#include "URL.h"
+#include "cores/VideoPlayer/DVDFileInfo.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/Settings.h"
+#include "settings/SettingsComponent.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/CPUInfo.h"
+#include "utils/JobManager.h"
+#include "utils/log.h"
+#include "video/VideoThumbLoader.h"
+
+#include <algorithm>
+
+/*!
+ \brief Worker processing one batch of the thumb extraction service.
+ */
+class CVideoThumbExtractionJob : public CJob
+{
+public:
+  CVideoThumbExtractionJob(CVideoThumbExtractionService& service,
+                           std::unique_ptr<CDVDThumbDecoderCache> decoderCache)
+    : m_service(service), m_decoderCache(std::move(decoderCache))
+  {
+  }
+
+  const char* GetType() const override { return kJobTypeMediaFlags; }
+
+  bool DoWork() override
+  {
+    m_service.ProcessBatch(*this, *m_decoderCache);
+    return true;
+  }
+
+  std::unique_ptr<CDVDThumbDecoderCache> TakeDecoderCache() { return std::move(m_decoderCache); }
+
+private:
+  CVideoThumbExtractionService& m_service;
+  std::unique_ptr<CDVDThumbDecoderCache> m_decoderCache;
+};
+
+CVideoThumbExtractionService::~CVideoThumbExtractionService() = default;
+
+CVideoThumbExtractionService& CVideoThumbExtractionService::GetInstance()
+{
+  static CVideoThumbExtractionService s_instance;
+  return s_instance;
+}
+
+bool CVideoThumbExtractionService::Submit(CThumbExtractor* extractor, const void* owner, Callback callback)
+{
+  RequestPtr request = std::make_shared<Request>();
+  request->extractor.reset(extractor);
+  request->owner = owner;
+  request->callback = std::move(callback);
+
+  if (request->extractor->m_thumb)
+  {
+    const std::shared_ptr<CAdvancedSettings> advancedSettings = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings();
+    request->extractor->m_stripThumbs = advancedSettings->m_videoThumbExtractionStripFrames;
+    request->extractor->m_chapterThumbs = CServiceBroker::GetSettingsComponent()->GetSettings()->GetBool(CSettings::SETTING_MYVIDEOS_EXTRACTCHAPTERTHUMBS);
+  }
+
+  CSingleLock lock(m_critSection);
+
+  const auto isSame = [&request](const RequestPtr& other) {
+    return !other->cancelled && *other->extractor == request->extractor.get();
+  };
+  if (std::any_of(m_pending.begin(), m_pending.end(), isSame) ||
+      std::any_of(m_inProgress.begin(), m_inProgress.end(), isSame))
+    return false;
+
+  m_pending.push_back(request);
+  StartWorkers();
+  return true;
+}
+
+void CVideoThumbExtractionService::CancelRequests(const void* owner)
+{
+  // holding the callback section guarantees no callback of owner is running
+  CSingleLock callbackLock(m_callbackSection);
+  CSingleLock lock(m_critSection);
+
+  m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(),
+                                 [owner](const RequestPtr& request) { return request->owner == owner; }),
+                  m_pending.end());
+
+  for (const RequestPtr& request : m_inProgress)
+  {
+    if (request->owner == owner)
+      request->cancelled = true;
+  }
+}
+
+size_t CVideoThumbExtractionService::GetPendingCount() const
+{
+  CSingleLock lock(m_critSection);
+  return m_pending.size();
+}
+
+void CVideoThumbExtractionService::OnJobComplete(unsigned int jobID, bool success, CJob* job)
+{
+  OnWorkerDone(static_cast<CVideoThumbExtractionJob*>(job)->TakeDecoderCache());
+}
+
+void CVideoThumbExtractionService::OnWorkerDone(std::unique_ptr<CDVDThumbDecoderCache> decoderCache)
+{
+  CSingleLock lock(m_critSection);
+  m_workers--;
+
+  if (m_pending.empty())
+  {
+    // nothing left to do, don't keep decoders around while idle
+    m_idleDecoders.clear();
+    return;
+  }
+
+  m_idleDecoders.push_back(std::move(decoderCache));
+  StartWorkers();
+}
+
+void CVideoThumbExtractionService::StartWorkers()
+{
+  const unsigned int maxWorkers = GetMaxWorkers();
+  const unsigned int batchSize = std::max(1u, CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_videoThumbExtractionBatchSize);
+
+  // one worker per started batch, so small queues don't wake up idle workers
+  while (m_workers < maxWorkers && m_pending.size() > m_workers * batchSize)
+  {
+    std::unique_ptr<CDVDThumbDecoderCache> decoderCache;
+    if (!m_idleDecoders.empty())
+    {
+      decoderCache = std::move(m_idleDecoders.back());
+      m_idleDecoders.pop_back();
+    }
+    else
+      decoderCache.reset(new CDVDThumbDecoderCache());
+
+    m_workers++;
+    StartWorker(std::move(decoderCache));
+  }
+}
+
+void CVideoThumbExtractionService::StartWorker(std::unique_ptr<CDVDThumbDecoderCache> decoderCache)
+{
+  CJobManager::GetInstance().AddJob(new CVideoThumbExtractionJob(*this, std::move(decoderCache)), this, CJob::PRIORITY_LOW_PAUSABLE);
+}
+
+unsigned int CVideoThumbExtractionService::GetMaxWorkers() const
+{
+  const std::shared_ptr<CAdvancedSettings> advancedSettings = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings();
+
+  // software decoding is single threaded for thumbs, so a worker uses about one core
+  const unsigned int cpuLimit = g_cpuInfo.getCPUCount() * advancedSettings->m_videoThumbExtractionMaxCPUPercent / 100;
+
+  return std::max(1u, std::min(advancedSettings->m_videoThumbExtractionConcurrency, cpuLimit));
+}
+
+std::vector<CVideoThumbExtractionService::RequestPtr> CVideoThumbExtractionService::TakeBatch()
+{
+  const unsigned int batchSize = std::max(1u, CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_videoThumbExtractionBatchSize);
+
+  CSingleLock lock(m_critSection);
+
+  std::vector<RequestPtr> batch;
+  while (!m_pending.empty() && batch.size() < batchSize)
+  {
+    batch.push_back(m_pending.front());
+    m_inProgress.push_back(m_pending.front());
+    m_pending.pop_front();
+  }
+  return batch;
+}
+
+bool CVideoThumbExtractionService::Extract(CThumbExtractor& extractor, CDVDThumbDecoderCache& decoderCache)
+{
+  return extractor.Extract(&decoderCache);
+}
+
+void CVideoThumbExtractionService::ProcessBatch(CJob& job, CDVDThumbDecoderCache& decoderCache)
+{
+  const std::vector<RequestPtr> batch = TakeBatch();
+  const unsigned int reuseCount = decoderCache.GetReuseCount();
+  const unsigned int start = XbmcThreads::SystemClockMillis();
+
+  for (unsigned int i = 0; i < batch.size(); i++)
+  {
+    const RequestPtr& request = batch[i];
+    bool success = false;
+
+    bool cancelled;
+    {
+      CSingleLock lock(m_critSection);
+      cancelled = request->cancelled;
+    }
+
+    if (!cancelled && !job.ShouldCancel(i, batch.size()))
+      success = Extract(*request->extractor, decoderCache);
+
+    {
+      CSingleLock callbackLock(m_callbackSection);
+      {
+        CSingleLock lock(m_critSection);
+        cancelled = request->cancelled;
+        m_inProgress.erase(std::remove(m_inProgress.begin(), m_inProgress.end(), request), m_inProgress.end());
+      }
+
+      if (!cancelled && request->callback)
+        request->callback(*request->extractor, success);
+    }
+  }
+
+  CLog::Log(LOGDEBUG, "CVideoThumbExtractionService::%s - processed %u item(s) in %u ms, reused decoder %u time(s)",
+            __FUNCTION__, static_cast<unsigned int>(batch.size()), XbmcThreads::SystemClockMillis() - start,
+            decoderCache.GetReuseCount() - reuseCount);
+}
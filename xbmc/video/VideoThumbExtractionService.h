@@ -0,0 +1,149 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "threads/CriticalSection.h"
+#include "utils/Job.h"
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class CDVDThumbDecoderCache;
+class CThumbExtractor;
+
+/*!
+ \ingroup thumbs,jobs
+ \brief Background service extracting video thumbs in batches.
+
+ Requests are queued and handed out in batches to a bounded number of workers.
+ Each worker keeps its decoder open between files with the same codec parameters,
+ extracts the thumb, the chapter thumbs and the thumb strip of a file with a single
+ open and stores the results in the texture cache.
+
+ The number of workers is limited by the advancedsettings <videolibrary><thumbextraction>
+ concurrency and maxcpupercent values and workers run at the lowest, pausable priority.
+
+ \sa CThumbExtractor, CDVDFileInfo::ExtractThumbs
+ */
+class CVideoThumbExtractionService : public IJobCallback
+{
+public:
+  /*!
+   \brief Called on a worker thread once a request has been processed.
+   \param extractor the processed request.
+   \param success whether the extraction succeeded.
+   */
+  using Callback = std::function<void(CThumbExtractor& extractor, bool success)>;
+
+  ~CVideoThumbExtractionService() override;
+
+  /*!
+   \brief Gets the singleton instance of the thumb extraction service.
+   */
+  static CVideoThumbExtractionService& GetInstance();
+
+  /*!
+   \brief Queue a thumb extraction.
+
+   Chapter thumbs and the thumb strip are added to the request according to settings.
+   Requests equal to an already queued one are dropped.
+
+   \param extractor the request to process, ownership is taken.
+   \param owner identifies the submitter, used to cancel its requests.
+   \param callback called once the request has been processed, may be empty.
+   \return true if the request was queued.
+   \sa CancelRequests
+   */
+  bool Submit(CThumbExtractor* extractor, const void* owner, Callback callback);
+
+  /*!
+   \brief Drop all queued requests of an owner.
+
+   Once this returns no callback of the owner is running and none will be called.
+
+   \param owner the owner passed to Submit.
+   */
+  void CancelRequests(const void* owner);
+
+  /*!
+   \brief Number of requests waiting for a worker.
+   */
+  size_t GetPendingCount() const;
+
+  // implementation of IJobCallback
+  void OnJobComplete(unsigned int jobID, bool success, CJob* job) override;
+
+protected:
+  CVideoThumbExtractionService() = default;
+
+  /*!
+   \brief Start a worker processing batches with the given decoder cache.
+   \note m_critSection is held.
+   */
+  virtual void StartWorker(std::unique_ptr<CDVDThumbDecoderCache> decoderCache);
+
+  /*!
+   \brief Called once a worker is done, starts the next one if requests are left.
+   \param decoderCache the decoder cache of the worker.
+   */
+  void OnWorkerDone(std::unique_ptr<CDVDThumbDecoderCache> decoderCache);
+
+  /*!
+   \brief Maximum number of concurrent workers allowed by settings and CPU count.
+   */
+  virtual unsigned int GetMaxWorkers() const;
+
+  /*!
+   \brief Process one request with the decoder cache of the calling worker.
+   \return true on success.
+   */
+  virtual bool Extract(CThumbExtractor& extractor, CDVDThumbDecoderCache& decoderCache);
+
+  /*!
+   \brief Process a batch on the calling worker.
+   \param job the worker job, used to check for cancellation.
+   \param decoderCache the decoder cache of the worker.
+   */
+  void ProcessBatch(CJob& job, CDVDThumbDecoderCache& decoderCache);
+
+private:
+  friend class CVideoThumbExtractionJob;
+
+  struct Request
+  {
+    std::unique_ptr<CThumbExtractor> extractor;
+    const void* owner = nullptr;
+    Callback callback;
+    bool cancelled = false;
+  };
+  using RequestPtr = std::shared_ptr<Request>;
+
+  CVideoThumbExtractionService(const CVideoThumbExtractionService&) = delete;
+  CVideoThumbExtractionService const& operator=(CVideoThumbExtractionService const&) = delete;
+
+  /*!
+   \brief Start workers until the queue is drained or the worker limit is reached.
+   \note m_critSection must be held.
+   */
+  void StartWorkers();
+
+  /*!
+   \brief Take the next batch of requests.
+   */
+  std::vector<RequestPtr> TakeBatch();
+
+  mutable CCriticalSection m_critSection;
+  CCriticalSection m_callbackSection;
+  std::deque<RequestPtr> m_pending;
+  std::vector<RequestPtr> m_inProgress;
+  std::vector<std::unique_ptr<CDVDThumbDecoderCache>> m_idleDecoders;
+  unsigned int m_workers = 0;
+};
@@ -32,6 +32,7 @@
 #include "utils/log.h"
 #include "video/VideoDatabase.h"
 #include "video/VideoInfoTag.h"
+#include "video/VideoThumbExtractionService.h"
 #include "video/tags/VideoInfoTagLoaderFactory.h"
 
 #include <algorithm>
@@ -77,6 +78,11 @@ bool CThumbExtractor::operator==(const CJob* job) const
 }
 
 bool CThumbExtractor::DoWork()
+{
+  return Extract(nullptr);
+}
+
+bool CThumbExtractor::Extract(CDVDThumbDecoderCache* decoderCache)
 {
   if (m_item.IsLiveTV()
   // Due to a pvr addon api design flaw (no support for multiple concurrent streams
@@ -104,13 +110,37 @@ bool CThumbExtractor::DoWork()
   if (m_thumb)
   {
     CLog::Log(LOGDEBUG,"%s - trying to extract thumb from video file %s", __FUNCTION__, CURL::GetRedacted(m_item.GetPath()).c_str());
-    // construct the thumb cache file
-    CTextureDetails details;
-    details.file = CTextureCache::GetCacheFile(m_target) + ".jpg";
-    result = CDVDFileInfo::ExtractThumb(m_item, details, m_fillStreamDetails ? &m_item.GetVideoInfoTag()->m_streamDetails : nullptr, m_pos);
+    // construct the thumb cache files
+    std::vector<CDVDThumbTarget> targets(1);
+    targets[0].url = m_target;
+    targets[0].cacheFile = CTextureCache::GetCacheFile(m_target) + ".jpg";
+    targets[0].pos = m_pos;
+    for (unsigned int i = 0; i < m_stripThumbs; i++)
+    {
+      CDVDThumbTarget target;
+      target.url = CDVDFileInfo::GetStripThumbURL(m_item.GetPath(), i);
+      target.cacheFile = CTextureCache::GetCacheFile(target.url) + ".jpg";
+      target.fraction = static_cast<float>(i + 1) / (m_stripThumbs + 1);
+      targets.push_back(target);
+    }
+
+    CDVDFileInfo::ExtractThumbs(m_item, targets, m_fillStreamDetails ? &m_item.GetVideoInfoTag()->m_streamDetails : nullptr, decoderCache, m_chapterThumbs);
+
+    for (const CDVDThumbTarget& target : targets)
+    {
+      if (!target.extracted)
+        continue;
+
+      CTextureDetails details;
+      details.file = target.cacheFile;
+      details.width = target.width;
+      details.height = target.height;
+      CTextureCache::GetInstance().AddCachedTexture(target.url, details);
+    }
+
+    result = targets[0].extracted;
     if (result)
     {
-      CTextureCache::GetInstance().AddCachedTexture(m_target, details);
       m_item.SetProperty("HasAutoThumb", true);
       m_item.SetProperty("AutoThumbImage", m_target);
       m_item.SetArt("thumb", m_target);
@@ -182,6 +212,7 @@ CVideoThumbLoader::CVideoThumbLoader() :
 
 CVideoThumbLoader::~CVideoThumbLoader()
 {
+  CVideoThumbExtractionService::GetInstance().CancelRequests(this);
   StopThread();
   delete m_videoDatabase;
 }
@@ -465,7 +496,10 @@ bool CVideoThumbLoader::LoadItemLookup(CFileItem* pItem)
           SetupRarOptions(item,path);
 
         CThumbExtractor* extract = new CThumbExtractor(item, path, true, thumbURL);
-        AddJob(extract);
+        CVideoThumbExtractionService::GetInstance().Submit(extract, this, [this](CThumbExtractor& extractor, bool success) {
+          if (success)
+            OnThumbExtracted(extractor);
+        });
 
         m_videoDatabase->Close();
         return true;
@@ -668,19 +702,21 @@ bool CVideoThumbLoader::GetEmbeddedThumb(const std::string& path,
 void CVideoThumbLoader::OnJobComplete(unsigned int jobID, bool success, CJob* job)
 {
   if (success)
-  {
-    CThumbExtractor* loader = static_cast<CThumbExtractor*>(job);
-    loader->m_item.SetPath(loader->m_listpath);
-
-    if (m_pObserver)
-      m_pObserver->OnItemLoaded(&loader->m_item);
-    CFileItemPtr pItem(new CFileItem(loader->m_item));
-    CGUIMessage msg(GUI_MSG_NOTIFY_ALL, 0, 0, GUI_MSG_UPDATE_ITEM, 0, pItem);
-    CServiceBroker::GetGUI()->GetWindowManager().SendThreadMessage(msg);
-  }
+    OnThumbExtracted(*static_cast<CThumbExtractor*>(job));
   CJobQueue::OnJobComplete(jobID, success, job);
 }
 
+void CVideoThumbLoader::OnThumbExtracted(CThumbExtractor& extractor)
+{
+  extractor.m_item.SetPath(extractor.m_listpath);
+
+  if (m_pObserver)
+    m_pObserver->OnItemLoaded(&extractor.m_item);
+  CFileItemPtr pItem(new CFileItem(extractor.m_item));
+  CGUIMessage msg(GUI_MSG_NOTIFY_ALL, 0, 0, GUI_MSG_UPDATE_ITEM, 0, pItem);
+  CServiceBroker::GetGUI()->GetWindowManager().SendThreadMessage(msg);
+}
+
 void CVideoThumbLoader::DetectAndAddMissingItemData(CFileItem &item)
 {
   if (item.m_bIsFolder) return;
@@ -15,6 +15,7 @@
 #include <map>
 #include <vector>
 
+class CDVDThumbDecoderCache;
 class CStreamDetails;
 class CVideoDatabase;
 class EmbeddedArt;
@@ -41,6 +42,14 @@ public:
    */
   bool DoWork() override;
 
+  /*!
+   \brief Extract the thumb or the stream details, optionally reusing a decoder.
+   \param decoderCache decoder cache shared between extractions, may be nullptr.
+   \return true on success.
+   \sa CVideoThumbExtractionService
+   */
+  bool Extract(CDVDThumbDecoderCache* decoderCache);
+
   const char* GetType() const override
   {
     return kJobTypeMediaFlags;
@@ -54,6 +63,8 @@ public:
   bool       m_thumb; ///< extract thumb?
   int64_t    m_pos; ///< position to extract thumb from
   bool m_fillStreamDetails; ///< fill in stream details?
+  bool m_chapterThumbs = false; ///< also extract a thumb for every chapter?
+  unsigned int m_stripThumbs = 0; ///< number of evenly spaced frames to extract as thumb strip
 };
 
 class CVideoThumbLoader : public CThumbLoader, public CJobQueue
@@ -134,5 +145,10 @@ protected:
    */
   void DetectAndAddMissingItemData(CFileItem &item);
 
+  /*! \brief Updates the list item once a thumb has been extracted
+   \param extractor the completed extraction
+   */
+  void OnThumbExtracted(CThumbExtractor& extractor);
+
   const ArtMap& GetArtFromCache(const std::string &mediaType, const int id);
 };
@@ -0,0 +1,207 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "DatabaseManager.h"
+#include "FileItem.h"
+#include "ServiceBroker.h"
+#include "utils/SortUtils.h"
+#include "utils/StringUtils.h"
+#include "utils/Variant.h"
+#include "video/VideoDatabase.h"
+#include "video/VideoInfoTag.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+const int MOVIES = 500;
+
+/*!
+ \brief The video database filled with synthetic movies. Their titles are a permutation
+ of the movie ids, so that sorting by title reorders them, and every third one is watched.
+ */
+class CSyntheticVideoDatabase : public CVideoDatabase
+{
+public:
+  bool Fill()
+  {
+    for (int i = 1; i <= MOVIES; i++)
+    {
+      const std::string path = StringUtils::Format("special://temp/videodatabase/movie%i.mkv", i);
+
+      CVideoInfoTag details;
+      details.SetTitle(StringUtils::Format("Movie %i", i * 7919 % MOVIES));
+      details.SetPlot(StringUtils::Format("Plot of movie %i", i));
+      details.SetYear(1950 + i % 70);
+      if (SetDetailsForMovie(path, details, std::map<std::string, std::string>()) < 0)
+        return false;
+
+      if (i % 3 == 0)
+        SetPlayCount(CFileItem(path, false), 1);
+    }
+    return true;
+  }
+
+  void Empty()
+  {
+    ExecuteQuery("DELETE FROM movie");
+    ExecuteQuery("DELETE FROM files");
+    ExecuteQuery("DELETE FROM path");
+  }
+};
+
+SortDescription GetPage(SortBy sortBy, int start, int end)
+{
+  SortDescription sorting;
+  sorting.sortBy = sortBy;
+  sorting.sortOrder = SortOrderAscending;
+  sorting.limitStart = start;
+  sorting.limitEnd = end;
+  return sorting;
+}
+
+std::vector<std::string> GetPaths(const CFileItemList& items)
+{
+  std::vector<std::string> paths;
+  for (int i = 0; i < items.Size(); i++)
+    paths.emplace_back(items[i]->GetPath());
+  return paths;
+}
+} // unnamed namespace
+
+class TestVideoDatabase : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    // the database manager has to create the databases before they can be opened
+    CServiceBroker::GetDatabaseManager().Initialize();
+
+    CSyntheticVideoDatabase database;
+    ASSERT_TRUE(database.Open());
+    database.Empty();
+    ASSERT_TRUE(database.Fill());
+    database.Close();
+  }
+
+  static void TearDownTestCase()
+  {
+    CSyntheticVideoDatabase database;
+    if (database.Open())
+    {
+      database.Empty();
+      database.Close();
+    }
+  }
+
+  void SetUp() override { ASSERT_TRUE(m_database.Open()); }
+
+  void TearDown() override { m_database.Close(); }
+
+  bool GetMovies(const SortDescription& sorting, CFileItemList& items, int getDetails = VideoDbDetailsNone)
+  {
+    CDatabase::Filter filter;
+    return m_database.GetMoviesByWhere("videodb://movies/titles/", filter, items, sorting, getDetails);
+  }
+
+  // the listed movies are the same as the ones read by a lookup through a dataset
+  void ExpectSameAsLookup(const CFileItemList& items, int getDetails)
+  {
+    for (int i = 0; i < items.Size(); i++)
+    {
+      ASSERT_TRUE(items[i]->HasVideoInfoTag());
+      const CVideoInfoTag& movie = *items[i]->GetVideoInfoTag();
+
+      CVideoInfoTag expected;
+      ASSERT_TRUE(m_database.GetMovieInfo("", expected, movie.m_iDbId, getDetails));
+      EXPECT_EQ(expected.m_iDbId, movie.m_iDbId);
+      EXPECT_EQ(expected.m_iFileId, movie.m_iFileId);
+      EXPECT_EQ(expected.m_strTitle, movie.m_strTitle);
+      EXPECT_EQ(expected.m_strTitle, items[i]->GetLabel());
+      EXPECT_EQ(expected.m_strPlot, movie.m_strPlot);
+      EXPECT_EQ(expected.GetYear(), movie.GetYear());
+      EXPECT_EQ(expected.m_strFileNameAndPath, movie.m_strFileNameAndPath);
+      EXPECT_EQ(expected.m_strFileNameAndPath, items[i]->GetDynPath());
+      EXPECT_EQ(expected.m_strPath, movie.m_strPath);
+      EXPECT_EQ(expected.GetPlayCount(), movie.GetPlayCount());
+      EXPECT_EQ(expected.m_dateAdded, movie.m_dateAdded);
+      EXPECT_EQ(expected.GetResumePoint().timeInSeconds, movie.GetResumePoint().timeInSeconds);
+    }
+  }
+
+  CSyntheticVideoDatabase m_database;
+};
+
+TEST_F(TestVideoDatabase, UnsortedListingMatchesLookups)
+{
+  CFileItemList items;
+  ASSERT_TRUE(GetMovies(GetPage(SortByNone, 0, -1), items));
+  ASSERT_EQ(MOVIES, items.Size());
+  EXPECT_EQ(MOVIES, items.GetProperty("total").asInteger());
+  ExpectSameAsLookup(items, VideoDbDetailsNone);
+
+  int watched = 0;
+  for (int i = 0; i < items.Size(); i++)
+    watched += items[i]->GetVideoInfoTag()->GetPlayCount() > 0 ? 1 : 0;
+  EXPECT_EQ(MOVIES / 3, watched);
+}
+
+TEST_F(TestVideoDatabase, ListingWithDetailsMatchesLookups)
+{
+  CFileItemList items;
+  ASSERT_TRUE(GetMovies(GetPage(SortByTitle, 0, -1), items, VideoDbDetailsAll));
+  ASSERT_EQ(MOVIES, items.Size());
+  ExpectSameAsLookup(items, VideoDbDetailsAll);
+}
+
+TEST_F(TestVideoDatabase, UnsortedPageIsLimitedInDatabase)
+{
+  CFileItemList all;
+  ASSERT_TRUE(GetMovies(GetPage(SortByNone, 0, -1), all));
+
+  CFileItemList page;
+  ASSERT_TRUE(GetMovies(GetPage(SortByNone, 100, 150), page));
+  ASSERT_EQ(50, page.Size());
+  EXPECT_EQ(MOVIES, page.GetProperty("total").asInteger());
+
+  const std::vector<std::string> paths = GetPaths(all);
+  EXPECT_EQ(std::vector<std::string>(paths.begin() + 100, paths.begin() + 150), GetPaths(page));
+  ExpectSameAsLookup(page, VideoDbDetailsNone);
+}
+
+TEST_F(TestVideoDatabase, SortedPagesMatchSortedListing)
+{
+  CFileItemList all;
+  ASSERT_TRUE(GetMovies(GetPage(SortByTitle, 0, -1), all));
+  ASSERT_EQ(MOVIES, all.Size());
+
+  const int pageSize = 120;
+  std::vector<std::string> paths;
+  for (int start = 0; start < MOVIES; start += pageSize)
+  {
+    CFileItemList page;
+    ASSERT_TRUE(GetMovies(GetPage(SortByTitle, start, start + pageSize), page));
+    EXPECT_EQ(std::min(pageSize, MOVIES - start), page.Size());
+    EXPECT_EQ(MOVIES, page.GetProperty("total").asInteger());
+    ExpectSameAsLookup(page, VideoDbDetailsNone);
+
+    const std::vector<std::string> pagePaths = GetPaths(page);
+    paths.insert(paths.end(), pagePaths.begin(), pagePaths.end());
+  }
+  EXPECT_EQ(GetPaths(all), paths);
+
+  // the title order differs from the database order
+  CFileItemList unsorted;
+  ASSERT_TRUE(GetMovies(GetPage(SortByNone, 0, -1), unsorted));
+  EXPECT_NE(GetPaths(unsorted), paths);
+}
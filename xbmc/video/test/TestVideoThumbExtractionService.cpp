@@ -0,0 +1,227 @@
+/*
+ *  Copyright (C) 2020 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "FileItem.h"
+#include "ServiceBroker.h"
+#include "cores/VideoPlayer/DVDFileInfo.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/SettingsComponent.h"
+#include "video/VideoThumbExtractionService.h"
+#include "video/VideoThumbLoader.h"
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+const unsigned int BATCH_SIZE = 2;
+const unsigned int MAX_WORKERS = 2;
+
+/*!
+ \brief The job a worker runs as, never cancelled by a job manager.
+ */
+class CTestWorkerJob : public CJob
+{
+public:
+  bool DoWork() override { return true; }
+};
+
+/*!
+ \brief The extraction service with workers that run when told to and a stub extractor.
+ Files named "fail.mkv" fail to extract.
+ */
+class CTestThumbExtractionService : public CVideoThumbExtractionService
+{
+public:
+  CTestThumbExtractionService() = default;
+
+  // process the next batch on the oldest started worker
+  bool RunWorker()
+  {
+    if (m_workers.empty())
+      return false;
+
+    std::unique_ptr<CDVDThumbDecoderCache> decoderCache = std::move(m_workers.front());
+    m_workers.pop_front();
+
+    CTestWorkerJob job;
+    ProcessBatch(job, *decoderCache);
+    OnWorkerDone(std::move(decoderCache));
+    return true;
+  }
+
+  void RunAll()
+  {
+    while (RunWorker())
+      ;
+  }
+
+  size_t GetWorkerCount() const { return m_workers.size(); }
+
+  std::vector<std::string> extracted;
+  std::vector<const CDVDThumbDecoderCache*> decoderCaches;
+  std::function<void(CThumbExtractor& extractor)> onExtract;
+
+protected:
+  void StartWorker(std::unique_ptr<CDVDThumbDecoderCache> decoderCache) override
+  {
+    m_workers.push_back(std::move(decoderCache));
+  }
+
+  unsigned int GetMaxWorkers() const override { return MAX_WORKERS; }
+
+  bool Extract(CThumbExtractor& extractor, CDVDThumbDecoderCache& decoderCache) override
+  {
+    extracted.push_back(extractor.m_item.GetPath());
+    decoderCaches.push_back(&decoderCache);
+    if (onExtract)
+      onExtract(extractor);
+    return extractor.m_item.GetPath() != "fail.mkv";
+  }
+
+private:
+  std::deque<std::unique_ptr<CDVDThumbDecoderCache>> m_workers;
+};
+
+CThumbExtractor* CreateExtractor(const std::string& path, const std::string& target = "thumb")
+{
+  return new CThumbExtractor(CFileItem(path, false), path, true, target + "://" + path);
+}
+
+/*!
+ \brief Records the callbacks of an owner.
+ */
+struct Results
+{
+  CVideoThumbExtractionService::Callback GetCallback()
+  {
+    return [this](CThumbExtractor& extractor, bool success) {
+      (success ? succeeded : failed).push_back(extractor.m_item.GetPath());
+    };
+  }
+
+  std::vector<std::string> succeeded;
+  std::vector<std::string> failed;
+};
+} // unnamed namespace
+
+class TestVideoThumbExtractionService : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_batchSize = GetAdvancedSettings()->m_videoThumbExtractionBatchSize;
+    GetAdvancedSettings()->m_videoThumbExtractionBatchSize = BATCH_SIZE;
+  }
+
+  void TearDown() override
+  {
+    GetAdvancedSettings()->m_videoThumbExtractionBatchSize = m_batchSize;
+  }
+
+  static std::shared_ptr<CAdvancedSettings> GetAdvancedSettings()
+  {
+    return CServiceBroker::GetSettingsComponent()->GetAdvancedSettings();
+  }
+
+  CTestThumbExtractionService service;
+
+private:
+  unsigned int m_batchSize = 0;
+};
+
+TEST_F(TestVideoThumbExtractionService, QueuedRequestsAreProcessedInBatches)
+{
+  Results results;
+  for (const std::string path : {"a.mkv", "b.mkv", "fail.mkv", "d.mkv", "e.mkv"})
+    ASSERT_TRUE(service.Submit(CreateExtractor(path), &results, results.GetCallback()));
+
+  // a worker is started per batch, up to the limit
+  EXPECT_EQ(5u, service.GetPendingCount());
+  EXPECT_EQ(MAX_WORKERS, service.GetWorkerCount());
+
+  ASSERT_TRUE(service.RunWorker());
+  EXPECT_EQ(std::vector<std::string>({"a.mkv", "b.mkv"}), service.extracted);
+  EXPECT_EQ(3u, service.GetPendingCount());
+  EXPECT_EQ(MAX_WORKERS, service.GetWorkerCount());
+
+  service.RunAll();
+  EXPECT_EQ(std::vector<std::string>({"a.mkv", "b.mkv", "fail.mkv", "d.mkv", "e.mkv"}), service.extracted);
+  EXPECT_EQ(std::vector<std::string>({"a.mkv", "b.mkv", "d.mkv", "e.mkv"}), results.succeeded);
+  EXPECT_EQ(std::vector<std::string>({"fail.mkv"}), results.failed);
+  EXPECT_EQ(0u, service.GetPendingCount());
+  EXPECT_EQ(0u, service.GetWorkerCount());
+
+  // the decoder of a finished worker is handed on to the next one
+  EXPECT_EQ(service.decoderCaches[0], service.decoderCaches[4]);
+  EXPECT_NE(service.decoderCaches[0], service.decoderCaches[2]);
+}
+
+TEST_F(TestVideoThumbExtractionService, DuplicateRequestsAreDropped)
+{
+  Results results;
+  ASSERT_TRUE(service.Submit(CreateExtractor("a.mkv"), &results, results.GetCallback()));
+  EXPECT_FALSE(service.Submit(CreateExtractor("a.mkv"), &results, results.GetCallback()));
+
+  // the same file to another target is another request
+  EXPECT_TRUE(service.Submit(CreateExtractor("a.mkv", "chapter"), &results, results.GetCallback()));
+  EXPECT_EQ(2u, service.GetPendingCount());
+
+  // a request in progress isn't queued again either
+  bool queued = true;
+  service.onExtract = [this, &results, &queued](CThumbExtractor& extractor) {
+    if (extractor.m_target == "thumb://a.mkv")
+      queued = service.Submit(CreateExtractor("a.mkv"), &results, results.GetCallback());
+  };
+  service.RunAll();
+  EXPECT_FALSE(queued);
+  EXPECT_EQ(std::vector<std::string>({"a.mkv", "a.mkv"}), service.extracted);
+  EXPECT_EQ(2u, results.succeeded.size());
+
+  // once processed it can be requested again
+  service.onExtract = nullptr;
+  EXPECT_TRUE(service.Submit(CreateExtractor("a.mkv"), &results, results.GetCallback()));
+  service.RunAll();
+  EXPECT_EQ(3u, service.extracted.size());
+}
+
+TEST_F(TestVideoThumbExtractionService, CancelledRequestsAreNotProcessed)
+{
+  Results first, second;
+  ASSERT_TRUE(service.Submit(CreateExtractor("a1.mkv"), &first, first.GetCallback()));
+  ASSERT_TRUE(service.Submit(CreateExtractor("b1.mkv"), &second, second.GetCallback()));
+  ASSERT_TRUE(service.Submit(CreateExtractor("a2.mkv"), &first, first.GetCallback()));
+  ASSERT_TRUE(service.Submit(CreateExtractor("b2.mkv"), &second, second.GetCallback()));
+
+  // queued requests of the owner are dropped, the others stay
+  service.CancelRequests(&first);
+  EXPECT_EQ(2u, service.GetPendingCount());
+
+  // requests of the owner already taken by a worker are skipped and don't call back
+  service.onExtract = [this, &second](CThumbExtractor&) {
+    service.CancelRequests(&second);
+  };
+  service.RunAll();
+  EXPECT_EQ(std::vector<std::string>({"b1.mkv"}), service.extracted);
+  EXPECT_TRUE(first.succeeded.empty());
+  EXPECT_TRUE(second.succeeded.empty());
+  EXPECT_TRUE(second.failed.empty());
+
+  // a cancelled request doesn't keep the same request from being queued
+  service.onExtract = nullptr;
+  EXPECT_TRUE(service.Submit(CreateExtractor("a1.mkv"), &first, first.GetCallback()));
+  EXPECT_TRUE(service.Submit(CreateExtractor("b1.mkv"), &second, second.GetCallback()));
+  service.RunAll();
+  EXPECT_EQ(std::vector<std::string>({"a1.mkv"}), first.succeeded);
+  EXPECT_EQ(std::vector<std::string>({"b1.mkv"}), second.succeeded);
+}